@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/account_operation_publisher.hpp>
+
+#include <fc/thread/thread.hpp>
+
+namespace graphene { namespace app {
+
+account_operation_publisher::account_operation_publisher( graphene::chain::database& db )
+:_db(db)
+{
+   _applied_block_connection = _db.applied_block.connect( [this]( const signed_block& b ) {
+      on_applied_block( b );
+   } );
+}
+
+uint64_t account_operation_publisher::subscribe( const std::set<account_id_type>& accounts, callback_type callback )
+{
+   FC_ASSERT( !accounts.empty(), "At least one account must be subscribed" );
+   std::lock_guard<std::mutex> guard( _mutex );
+   const uint64_t id = ++_next_subscription_id;
+   for( const auto& account : accounts )
+      _subscriptions_by_account[account].insert( id );
+   _subscriptions[id] = { accounts, std::move( callback ) };
+   return id;
+}
+
+void account_operation_publisher::unsubscribe( uint64_t subscription_id )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   auto sub_itr = _subscriptions.find( subscription_id );
+   if( sub_itr == _subscriptions.end() )
+      return;
+   for( const auto& account : sub_itr->second.accounts )
+   {
+      auto account_itr = _subscriptions_by_account.find( account );
+      if( account_itr == _subscriptions_by_account.end() )
+         continue;
+      account_itr->second.erase( subscription_id );
+      if( account_itr->second.empty() )
+         _subscriptions_by_account.erase( account_itr );
+   }
+   _subscriptions.erase( sub_itr );
+}
+
+size_t account_operation_publisher::account_count()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _subscriptions_by_account.size();
+}
+
+/** note: this method cannot yield because it is called in the middle of
+ * apply a block.
+ */
+void account_operation_publisher::on_applied_block( const signed_block& block )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   if( _subscriptions_by_account.empty() )
+      return;
+
+   const auto& applied_ops = _db.get_applied_operations();
+   const auto& impacted = _db.get_applied_operations_impacted_accounts();
+
+   // positions of the operations of the block by subscription, every position is added once and in order
+   std::map< uint64_t, vector<size_t> > matches;
+   for( size_t i = 0; i < applied_ops.size() && i < impacted.size(); ++i )
+   {
+      if( !applied_ops[i].valid() )
+         continue;
+      for( const auto& account : impacted[i] )
+      {
+         auto account_itr = _subscriptions_by_account.find( account );
+         if( account_itr == _subscriptions_by_account.end() )
+            continue;
+         for( const uint64_t id : account_itr->second )
+         {
+            vector<size_t>& positions = matches[id];
+            if( positions.empty() || positions.back() != i )
+               positions.push_back( i );
+         }
+      }
+   }
+   if( matches.empty() )
+      return;
+
+   vector< optional<fc::variant> > serialized( applied_ops.size() );
+   vector< std::pair< fc::variant, callback_type > > notifications;
+   notifications.reserve( matches.size() );
+   for( const auto& item : matches )
+   {
+      fc::variants ops;
+      ops.reserve( item.second.size() );
+      for( const size_t i : item.second )
+      {
+         if( !serialized[i].valid() )
+            serialized[i] = fc::variant( *applied_ops[i], GRAPHENE_NET_MAX_NESTED_OBJECTS );
+         ops.push_back( *serialized[i] );
+      }
+      notifications.emplace_back( fc::variant( std::move( ops ) ), _subscriptions.at( item.first ).callback );
+   }
+
+   fc::async( [notifications](){
+      for( const auto& item : notifications )
+      {
+         try
+         {
+            item.second( item.first );
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Failed to send account operations: ${e}", ("e", e.to_detail_string()) );
+         }
+      }
+   } );
+}
+
+} } // graphene::app
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <cctype>
+#include <queue>
 
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
@@ -38,6 +39,7 @@
 
 #include <fc/crypto/base64.hpp>
 #include <fc/crypto/hex.hpp>
+#include <fc/io/raw.hpp>
 #include <fc/rpc/api_connection.hpp>
 #include <fc/thread/future.hpp>
 
@@ -91,10 +93,14 @@ namespace graphene { namespace app {
        if( api_name == "database_api" )
        {
           _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), &( _app.get_options() ) );
+          if( _app.get_options().api_call_stats )
+             instrument_api( *_database_api, api_name, _app.get_options().api_call_stats );
        }
        else if( api_name == "block_api" )
        {
           _block_api = std::make_shared< block_api >( std::ref( *_app.chain_database() ) );
+          if( _app.get_options().api_call_stats )
+             instrument_api( *_block_api, api_name, _app.get_options().api_call_stats );
        }
        else if( api_name == "network_broadcast_api" )
        {
@@ -103,6 +109,8 @@ namespace graphene { namespace app {
        else if( api_name == "history_api" )
        {
           _history_api = std::make_shared< history_api >( _app );
+          if( _app.get_options().api_call_stats )
+             instrument_api( *_history_api, api_name, _app.get_options().api_call_stats );
        }
        else if( api_name == "network_node_api" )
        {
@@ -148,6 +156,137 @@ namespace graphene { namespace app {
        return res;
     }
 
+    vector<optional<vector<char>>> block_api::get_packed_blocks(uint32_t block_num_from, uint32_t block_num_to)const
+    {
+       FC_ASSERT( block_num_to >= block_num_from );
+       const uint32_t last_irreversible_block_num = _db.get_dynamic_global_properties().last_irreversible_block_num;
+       vector<optional<vector<char>>> res;
+       res.reserve( block_num_to - block_num_from + 1 );
+       for( uint32_t block_num = block_num_from; block_num <= block_num_to; ++block_num )
+          res.push_back( get_packed_block( block_num, last_irreversible_block_num ) );
+       return res;
+    }
+
+    optional<vector<char>> block_api::get_packed_block( uint32_t block_num,
+                                                        uint32_t last_irreversible_block_num )const
+    {
+       // irreversible blocks are served as stored, without unpacking them
+       optional<vector<char>> packed;
+       if( block_num <= last_irreversible_block_num )
+          packed = _db.fetch_packed_block_by_number( block_num );
+       if( !packed.valid() )
+       {
+          optional<signed_block> block = _db.fetch_block_by_number( block_num );
+          if( block.valid() )
+             packed = fc::raw::pack( *block );
+       }
+       return packed;
+    }
+
+    constexpr uint32_t block_api::max_blocks_per_batch;
+    constexpr size_t block_api::max_block_streams;
+
+    uint64_t block_api::stream_blocks( std::function<void(const variant&)> callback,
+                                       uint32_t block_num_from, uint32_t block_num_to, uint32_t credit )
+    {
+       FC_ASSERT( block_num_from > 0 && block_num_to >= block_num_from );
+       FC_ASSERT( block_num_from >= _db.first_available_block_num(),
+                  "Block ${n} has been pruned from the block database", ("n", block_num_from) );
+       FC_ASSERT( _block_streams.size() < max_block_streams,
+                  "Can not stream more than ${n} ranges of blocks at a time", ("n", max_block_streams) );
+
+       const uint64_t stream_id = ++_next_stream_id;
+       block_stream& stream = _block_streams[stream_id];
+       stream.callback = callback;
+       stream.next_block_num = block_num_from;
+       stream.last_block_num = block_num_to;
+       stream.credit = credit;
+       // push after returning, so that the client knows the ID before the first notification
+       schedule_block_stream( stream_id );
+       return stream_id;
+    }
+
+    void block_api::add_block_stream_credit( uint64_t stream_id, uint32_t credit )
+    {
+       auto itr = _block_streams.find( stream_id );
+       FC_ASSERT( itr != _block_streams.end(), "Unknown block stream ${id}", ("id", stream_id) );
+       itr->second.credit = ( credit > std::numeric_limits<uint32_t>::max() - itr->second.credit )
+                            ? std::numeric_limits<uint32_t>::max() : itr->second.credit + credit;
+       schedule_block_stream( stream_id );
+    }
+
+    void block_api::cancel_block_stream( uint64_t stream_id )
+    {
+       _block_streams.erase( stream_id );
+    }
+
+    void block_api::schedule_block_stream( uint64_t stream_id )
+    {
+       auto itr = _block_streams.find( stream_id );
+       if( itr == _block_streams.end() || itr->second.is_pushing || itr->second.credit == 0 )
+          return;
+       itr->second.is_pushing = true;
+       // the session may be closed before the task runs, it must not keep the API alive
+       std::weak_ptr<block_api> weak_this = shared_from_this();
+       fc::async( [weak_this,stream_id]() {
+          auto capture_this = weak_this.lock();
+          if( capture_this )
+             capture_this->push_block_stream( stream_id );
+       } );
+    }
+
+    void block_api::push_block_stream( uint64_t stream_id )
+    {
+       auto itr = _block_streams.find( stream_id );
+       while( itr != _block_streams.end() && itr->second.credit > 0 )
+       {
+          block_stream& stream = itr->second;
+          const uint32_t last_irreversible_block_num
+                = _db.get_dynamic_global_properties().last_irreversible_block_num;
+
+          block_stream_batch batch;
+          batch.stream_id = stream_id;
+          batch.first_block_num = stream.next_block_num;
+          while( batch.blocks.size() < max_blocks_per_batch && stream.credit > 0
+                 && stream.next_block_num <= stream.last_block_num )
+          {
+             optional<vector<char>> packed = get_packed_block( stream.next_block_num, last_irreversible_block_num );
+             if( !packed.valid() )
+             {
+                // the head block has been reached
+                stream.last_block_num = stream.next_block_num - 1;
+                break;
+             }
+             batch.blocks.push_back( std::move( *packed ) );
+             ++stream.next_block_num;
+             --stream.credit;
+          }
+          batch.done = ( stream.next_block_num > stream.last_block_num );
+
+          auto callback = stream.callback;
+          if( batch.done )
+             _block_streams.erase( itr );
+          try
+          {
+             callback( fc::variant( batch, GRAPHENE_MAX_NESTED_OBJECTS ) );
+          }
+          catch( const fc::exception& e )
+          {
+             wlog( "Failed to push blocks of stream ${id}: ${e}", ("id", stream_id)("e", e.to_detail_string()) );
+             _block_streams.erase( stream_id );
+             return;
+          }
+          if( batch.done )
+             return;
+
+          // let other work run between the batches, the stream may be canceled meanwhile
+          fc::yield();
+          itr = _block_streams.find( stream_id );
+       }
+       if( itr != _block_streams.end() )
+          itr->second.is_pushing = false;
+    }
+
     network_broadcast_api::network_broadcast_api(application& a):_app(a)
     {
        _applied_block_connection = _app.chain_database()->applied_block.connect([this](const signed_block& b){ on_applied_block(b); });
@@ -177,11 +316,22 @@ namespace graphene { namespace app {
        }
     }
 
+    void network_broadcast_api::push_transaction( const precomputable_transaction& trx )
+    {
+       const auto& submissions = _app.get_options().transaction_submissions;
+       if( submissions )
+          submissions->submit( trx ).wait();
+       else
+       {
+          _app.chain_database()->precompute_parallel( trx ).wait();
+          _app.chain_database()->push_transaction( trx );
+       }
+    }
+
     void network_broadcast_api::broadcast_transaction(const precomputable_transaction& trx)
     {
        FC_ASSERT( _app.p2p_node() != nullptr, "Not connected to P2P network, can't broadcast!" );
-       _app.chain_database()->precompute_parallel( trx ).wait();
-       _app.chain_database()->push_transaction(trx);
+       push_transaction( trx );
        _app.p2p_node()->broadcast_transaction(trx);
     }
 
@@ -206,9 +356,17 @@ namespace graphene { namespace app {
     void network_broadcast_api::broadcast_transaction_with_callback(confirmation_callback cb, const precomputable_transaction& trx)
     {
        FC_ASSERT( _app.p2p_node() != nullptr, "Not connected to P2P network, can't broadcast!" );
-       _app.chain_database()->precompute_parallel( trx ).wait();
-       _callbacks[trx.id()] = cb;
-       _app.chain_database()->push_transaction(trx);
+       const transaction_id_type id = trx.id();
+       _callbacks[id] = cb;
+       try
+       {
+          push_transaction( trx );
+       }
+       catch( const fc::exception& )
+       {
+          _callbacks.erase( id );
+          throw;
+       }
        _app.p2p_node()->broadcast_transaction(trx);
     }
 
@@ -244,6 +402,48 @@ namespace graphene { namespace app {
        return {};
     }
 
+    fc::variant_object network_node_api::get_metrics() const
+    {
+       if( _app.p2p_node() != nullptr )
+          return _app.p2p_node()->network_get_metrics();
+       return {};
+    }
+
+    vector<api_method_statistics> network_node_api::get_api_call_statistics() const
+    {
+       if( _app.get_options().api_call_stats )
+          return _app.get_options().api_call_stats->get_statistics();
+       return {};
+    }
+
+    transaction_submission_metrics network_node_api::get_transaction_submission_metrics() const
+    {
+       if( _app.get_options().transaction_submissions )
+          return _app.get_options().transaction_submissions->get_metrics();
+       return {};
+    }
+
+    vector<block_production_record> network_node_api::get_block_production_metrics() const
+    {
+       if( _app.get_options().block_production )
+          return _app.get_options().block_production->get_records();
+       return {};
+    }
+
+    vector<net::block_trace> network_node_api::get_block_traces() const
+    {
+       if( _app.get_options().block_traces )
+          return _app.get_options().block_traces->get_traces();
+       return {};
+    }
+
+    fc::variant_object network_node_api::get_block_trace_events() const
+    {
+       if( _app.get_options().block_traces )
+          return _app.get_options().block_traces->get_chrome_trace();
+       return net::block_tracer( 0 ).get_chrome_trace();
+    }
+
     fc::variant_object network_node_api::get_advanced_node_parameters() const
     {
        FC_ASSERT( _app.p2p_node() != nullptr, "No P2P network!" );
@@ -371,33 +571,69 @@ namespace graphene { namespace app {
        if(_app.is_plugin_enabled("elasticsearch")) {
           auto es = _app.get_plugin<elasticsearch::elasticsearch_plugin>("elasticsearch");
           if(es.get()->get_running_mode() != elasticsearch::mode::only_save) {
-             if(!_app.elasticsearch_thread)
-                _app.elasticsearch_thread= std::make_shared<fc::thread>("elasticsearch");
-
-             return _app.elasticsearch_thread->async([&es, &account, &stop, &limit, &start]() {
-                return es->get_account_history(account, stop, limit, start);
-             }, "thread invoke for method " BOOST_PP_STRINGIZE(method_name)).wait();
+             // only this call waits for the query, the thread serves other requests meanwhile
+             return es->get_account_history_async(account, stop, limit, start).wait();
           }
        }
 
-       const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
-       const auto& by_op_idx = hist_idx.indices().get<by_op>();
-       auto index_start = by_op_idx.begin();
-       auto itr = by_op_idx.lower_bound(boost::make_tuple(account, start));
+       // The operation IDs grow with the sequence numbers of the account, so the most recent entry which is not
+       // after start is found by a binary search over the sequence numbers which are in memory
+       const auto& stats = account(db).statistics(db);
+       const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+       uint64_t low = stats.removed_ops + 1;
+       uint64_t high = stats.total_ops + 1;
+       while( low < high )
+       {
+          const uint64_t mid = low + ( high - low ) / 2;
+          auto mid_itr = by_seq_idx.find( boost::make_tuple( account, mid ) );
+          if( mid_itr != by_seq_idx.end() && mid_itr->operation_id.instance.value <= start.instance.value )
+             low = mid + 1;
+          else
+             high = mid;
+       }
 
-       while(itr != index_start && itr->account == account && itr->operation_id.instance.value > stop.instance.value && result.size() < limit)
+       auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, low - 1 ) );
+       const auto itr_begin = by_seq_idx.lower_bound( boost::make_tuple( account, 0 ) );
+       while( itr != itr_begin && result.size() < limit )
        {
-          if(itr->operation_id.instance.value <= start.instance.value)
-             result.push_back(itr->operation_id(db));
           --itr;
+          // when stop is 0, the operation with ID 0 is included
+          if( stop.instance.value != 0 && itr->operation_id.instance.value <= stop.instance.value )
+             break;
+          result.push_back( itr->operation_id(db) );
        }
-       if(stop.instance.value == 0 && result.size() < limit && itr->account == account) {
-         result.push_back(itr->operation_id(db));
+
+       // continue with the older operations which were removed from memory
+       const auto store = get_account_history_store();
+       if( store && result.size() < limit && stats.removed_ops > 0 )
+       {
+          for( uint64_t seq = store->find_stored_sequence( account, stats.removed_ops, start );
+               seq > 0 && result.size() < limit; --seq )
+          {
+             auto op = store->get_stored_operation( account, seq );
+             if( !op.valid() || ( op->id.instance() <= stop.instance.value && stop.instance.value != 0 ) )
+                break;
+             result.push_back( std::move( *op ) );
+          }
        }
 
        return result;
     }
 
+    vector<vector<char>> history_api::get_packed_account_history( const std::string account_id_or_name,
+                                                                  operation_history_id_type stop,
+                                                                  uint32_t limit,
+                                                                  operation_history_id_type start ) const
+    {
+       const vector<operation_history_object> history = get_account_history( account_id_or_name, stop, limit,
+                                                                              start );
+       vector<vector<char>> result;
+       result.reserve( history.size() );
+       for( const auto& op : history )
+          result.push_back( fc::raw::pack( op ) );
+       return result;
+    }
+
     vector<operation_history_object> history_api::get_account_history_operations( const std::string account_id_or_name,
                                                                        int64_t operation_type,
                                                                        operation_history_id_type start,
@@ -482,9 +718,124 @@ namespace graphene { namespace app {
           }
           while ( itr != itr_stop && result.size() < limit );
        }
+
+       // continue with the older operations which were removed from memory
+       const auto store = get_account_history_store();
+       if( store && start >= stop && stop <= stats.removed_ops && result.size() < limit )
+       {
+          const uint64_t lowest = std::max<uint64_t>( stop, 1 );
+          for( uint64_t seq = std::min( start, stats.removed_ops ); seq >= lowest && result.size() < limit; --seq )
+          {
+             auto op = store->get_stored_operation( account, seq );
+             if( !op.valid() )
+                break;
+             result.push_back( std::move( *op ) );
+          }
+       }
+       return result;
+    }
+
+    account_history_batch history_api::get_account_history_batch(
+          const vector<std::pair<std::string,uint64_t>>& cursors, uint32_t limit )const
+    {
+       FC_ASSERT( _app.chain_database() );
+       const auto& db = *_app.chain_database();
+
+       const auto configured_limit = _app.get_options().api_limit_get_relative_account_history;
+       FC_ASSERT( limit <= configured_limit,
+                  "limit can not be greater than ${configured_limit}",
+                  ("configured_limit", configured_limit) );
+       const auto configured_accounts_limit = _app.get_options().api_limit_get_account_history_batch;
+       FC_ASSERT( cursors.size() <= configured_accounts_limit,
+                  "Number of querying accounts can not be greater than ${configured_limit}",
+                  ("configured_limit", configured_accounts_limit) );
+
+       const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+       using seq_iterator = decltype( by_seq_idx.begin() );
+
+       account_history_batch result;
+       vector< std::pair<seq_iterator,seq_iterator> > ranges;
+       for( const auto& cursor : cursors )
+       {
+          account_history_progress progress;
+          try {
+             progress.account = database_api.get_account_id_from_string( cursor.first );
+          } catch( const fc::exception& ) { continue; }
+          progress.sequence = cursor.second;
+          result.accounts.push_back( progress );
+          ranges.emplace_back( by_seq_idx.lower_bound( boost::make_tuple( progress.account, cursor.second + 1 ) ),
+                               by_seq_idx.upper_bound( boost::make_tuple( progress.account ) ) );
+       }
+
+       // Merge the histories of the accounts by operation ID, the sequence numbers of an account grow with the IDs
+       using queue_entry = std::pair< operation_history_id_type, size_t >;
+       std::priority_queue< queue_entry, vector<queue_entry>, std::greater<queue_entry> > queue;
+       for( size_t i = 0; i < ranges.size(); ++i )
+       {
+          if( ranges[i].first != ranges[i].second )
+             queue.emplace( ranges[i].first->operation_id, i );
+       }
+
+       optional<operation_history_id_type> last_operation;
+       while( !queue.empty() )
+       {
+          const queue_entry next = queue.top();
+          const bool is_new_operation = !last_operation.valid() || *last_operation != next.first;
+          if( is_new_operation && result.operations.size() >= limit )
+             break;
+          queue.pop();
+
+          if( is_new_operation )
+          {
+             result.operations.push_back( next.first(db) );
+             last_operation = next.first;
+          }
+          auto& range = ranges[next.second];
+          auto& progress = result.accounts[next.second];
+          progress.operations.push_back( next.first );
+          progress.sequence = range.first->sequence;
+          if( ++range.first != range.second )
+             queue.emplace( range.first->operation_id, next.second );
+       }
+
+       while( !queue.empty() )
+       {
+          result.accounts[ queue.top().second ].complete = false;
+          queue.pop();
+       }
        return result;
     }
 
+    account_history::account_history_trim_metrics history_api::get_account_history_trim_metrics()const
+    {
+       FC_ASSERT( _app.is_plugin_enabled( "account_history" ), "Account history plugin is not enabled" );
+       return _app.get_plugin<account_history::account_history_plugin>( "account_history" )->get_trim_metrics();
+    }
+
+    elasticsearch::elasticsearch_query_metrics history_api::get_elasticsearch_query_metrics()const
+    {
+       FC_ASSERT( _app.is_plugin_enabled( "elasticsearch" ), "Elasticsearch plugin is not enabled" );
+       return _app.get_plugin<elasticsearch::elasticsearch_plugin>( "elasticsearch" )->get_query_metrics();
+    }
+
+    std::shared_ptr<account_history::account_history_plugin> history_api::get_account_history_store()const
+    {
+       if( !_app.is_plugin_enabled( "account_history" ) )
+          return nullptr;
+       auto plugin = _app.get_plugin<account_history::account_history_plugin>( "account_history" );
+       return plugin->has_account_history_store() ? plugin : nullptr;
+    }
+
+    vector<operation_history_object> history_api::get_block_operations( uint32_t block_num )const
+    {
+       FC_ASSERT( _app.chain_database() );
+       auto plugin = _app.get_plugin<block_operations::block_operations_plugin>( "block_operations" );
+       FC_ASSERT( plugin, "Block operations plugin is not enabled" );
+       auto ops = plugin->get_block_operations( block_num );
+       FC_ASSERT( ops.valid(), "Operations of block ${n} are not available", ("n", block_num) );
+       return std::move( *ops );
+    }
+
     flat_set<uint32_t> history_api::get_market_history_buckets()const
     {
        auto market_hist_plugin = _app.get_plugin<market_history_plugin>( "market_history" );
@@ -541,6 +892,17 @@ namespace graphene { namespace app {
        const auto& bidx = db.get_index_type<bucket_index>();
        const auto& by_key_idx = bidx.indices().get<by_key>();
 
+       if( market_hist_plugin->has_market_history_store() )
+       {
+          // the buckets which are older than the ones in memory are read from the store
+          fc::time_point_sec stored_end = end;
+          auto first_itr = by_key_idx.lower_bound( bucket_key( a, b, bucket_seconds, fc::time_point_sec() ) );
+          if( first_itr != by_key_idx.end() && first_itr->key.base == a && first_itr->key.quote == b
+                && first_itr->key.seconds == bucket_seconds && first_itr->key.open <= end )
+             stored_end = first_itr->key.open - 1;
+          result = market_hist_plugin->get_stored_buckets( a, b, bucket_seconds, start, stored_end, 200 );
+       }
+
        auto itr = by_key_idx.lower_bound( bucket_key( a, b, bucket_seconds, start ) );
        while( itr != by_key_idx.end() && itr->key.open <= end && result.size() < 200 )
        {
@@ -682,6 +1044,47 @@ namespace graphene { namespace app {
 
     } FC_CAPTURE_AND_RETHROW( (pool_id)(start)(stop)(olimit)(operation_type) ) }
 
+    vector<liquidity_pool_history_interval_object> history_api::get_liquidity_pool_history_intervals(
+               liquidity_pool_id_type pool_id,
+               optional<fc::time_point_sec> start,
+               optional<fc::time_point_sec> stop,
+               optional<uint32_t> olimit )const
+    { try {
+       auto market_hist_plugin = _app.get_plugin<market_history_plugin>( "market_history" );
+       FC_ASSERT( market_hist_plugin, "Market history plugin is not enabled." );
+
+       uint32_t limit = olimit.valid() ? *olimit : 101;
+
+       const auto configured_limit = _app.get_options().api_limit_get_liquidity_pool_history;
+       FC_ASSERT( limit <= configured_limit,
+                  "limit can not be greater than ${configured_limit}",
+                  ("configured_limit", configured_limit) );
+
+       FC_ASSERT( _app.chain_database(), "Internal error: the chain database is not availalbe" );
+
+       const auto& db = *_app.chain_database();
+
+       vector<liquidity_pool_history_interval_object> result;
+
+       const uint32_t seconds = market_hist_plugin->liquidity_pool_history_interval();
+       if( seconds == 0 || limit == 0 || ( start.valid() && stop.valid() && *start <= *stop ) ) // empty result
+          return result;
+
+       const auto& idx = db.get_index_type<liquidity_pool_history_interval_index>().indices().get<by_pool_open>();
+       auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, seconds, *start ) )
+                                : idx.lower_bound( boost::make_tuple( pool_id, seconds ) );
+       auto itr_stop = stop.valid() ? idx.lower_bound( boost::make_tuple( pool_id, seconds, *stop ) )
+                                    : idx.upper_bound( boost::make_tuple( pool_id, seconds ) );
+       while( itr != itr_stop && result.size() < limit )
+       {
+          result.push_back( *itr );
+          ++itr;
+       }
+
+       return result;
+
+    } FC_CAPTURE_AND_RETHROW( (pool_id)(start)(stop)(olimit) ) }
+
 
     crypto_api::crypto_api(){};
 
@@ -744,7 +1147,18 @@ namespace graphene { namespace app {
           _app(app),
           _db( *app.chain_database()),
           database_api( std::ref(*app.chain_database()), &(app.get_options())
-          ) { }
+          )
+    {
+       try
+       {
+          asset_holders_index = &_db.get_index_type< primary_index< account_balance_index > >()
+                .get_secondary_index< graphene::api_helper_indexes::asset_holders_index >();
+       }
+       catch( const fc::assert_exception& )
+       {
+          asset_holders_index = nullptr;
+       }
+    }
     asset_api::~asset_api() { }
 
     vector<account_asset_balance> asset_api::get_asset_holders( std::string asset, uint32_t start, uint32_t limit ) const
@@ -755,11 +1169,30 @@ namespace graphene { namespace app {
                   ("configured_limit", configured_limit) );
 
        asset_id_type asset_id = database_api.get_asset_id_from_string( asset );
-       const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-       auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
 
        vector<account_asset_balance> result;
 
+       auto add_holder = [this,&result]( account_id_type owner, share_type balance ) {
+          const auto account = _db.find(owner);
+
+          account_asset_balance aab;
+          aab.name       = account->name;
+          aab.account_id = account->id;
+          aab.amount     = balance.value;
+
+          result.push_back(aab);
+       };
+
+       if( asset_holders_index && asset_holders_index->is_populated() )
+       {
+          for( const auto& h : asset_holders_index->get_holders( asset_id, start, limit ) )
+             add_holder( h.owner, h.balance );
+          return result;
+       }
+
+       const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
+       auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
+
        uint32_t index = 0;
        for( const account_balance_object& bal : boost::make_iterator_range( range.first, range.second ) )
        {
@@ -772,47 +1205,33 @@ namespace graphene { namespace app {
           if( index++ < start )
              continue;
 
-          const auto account = _db.find(bal.owner);
-
-          account_asset_balance aab;
-          aab.name       = account->name;
-          aab.account_id = account->id;
-          aab.amount     = bal.balance.value;
-
-          result.push_back(aab);
+          add_holder( bal.owner, bal.balance );
        }
 
        return result;
     }
     // get number of asset holders.
     int asset_api::get_asset_holders_count( std::string asset ) const {
-       const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-       asset_id_type asset_id = database_api.get_asset_id_from_string( asset );
-       auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-
-       int count = boost::distance(range) - 1;
+       return count_asset_holders( database_api.get_asset_id_from_string( asset ) );
+    }
+    int asset_api::count_asset_holders( asset_id_type asset_id ) const {
+       if( asset_holders_index && asset_holders_index->is_populated() )
+          return static_cast<int>( asset_holders_index->get_holders_count( asset_id ) );
 
-       return count;
+       // the balances of an asset are sorted in descending order, the zero balances come last
+       const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
+       auto first = bal_idx.lower_bound( boost::make_tuple( asset_id ) );
+       auto zero = bal_idx.lower_bound( boost::make_tuple( asset_id, share_type(0) ) );
+       return static_cast<int>( std::distance( first, zero ) );
     }
     // function to get vector of system assets with holders count.
     vector<asset_holders> asset_api::get_all_asset_holders() const {
        vector<asset_holders> result;
-       vector<asset_id_type> total_assets;
        for( const asset_object& asset_obj : _db.get_index_type<asset_index>().indices() )
        {
-          const auto& dasset_obj = asset_obj.dynamic_asset_data_id(_db);
-
-          asset_id_type asset_id;
-          asset_id = dasset_obj.id;
-
-          const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-          auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-
-          int count = boost::distance(range) - 1;
-
           asset_holders ah;
-          ah.asset_id       = asset_id;
-          ah.count     = count;
+          ah.asset_id = asset_obj.get_id();
+          ah.count    = count_asset_holders( ah.asset_id );
 
           result.push_back(ah);
        }
@@ -841,11 +1260,11 @@ namespace graphene { namespace app {
 
       auto plugin = _app.get_plugin<graphene::grouped_orders::grouped_orders_plugin>( "grouped_orders" );
       FC_ASSERT( plugin );
-      const auto& limit_groups = plugin->limit_order_groups();
       vector< limit_order_group > result;
 
       asset_id_type base_asset_id = database_api.get_asset_id_from_string( base_asset );
       asset_id_type quote_asset_id = database_api.get_asset_id_from_string( quote_asset );
+      const auto& limit_groups = plugin->limit_order_groups( base_asset_id, quote_asset_id );
 
       price max_price = price::max( base_asset_id, quote_asset_id );
       price min_price = price::min( base_asset_id, quote_asset_id );
@@ -876,7 +1295,12 @@ namespace graphene { namespace app {
       const auto& by_account_catalog_idx = storage_index.indices().get<by_account_catalog_key>();
       auto range = by_account_catalog_idx.equal_range(make_tuple(account_id, catalog));
       for( const account_storage_object& aso : boost::make_iterator_range( range.first, range.second ) )
+      {
          results.push_back(aso);
+         // values which are stored out of line are only loaded here
+         if( aso.value_size > 0 )
+            results.back().value = plugin->get_value( aso );
+      }
       return results;
    }
 
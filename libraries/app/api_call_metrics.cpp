@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/api_call_metrics.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+api_call_metrics::running_scope::running_scope( api_call_metrics& metrics, const char* method,
+                                                fc::time_point queued_at )
+   : _metrics( metrics ), _method( method ), _started_at( fc::time_point::now() )
+{
+   std::lock_guard<std::mutex> guard( _metrics._mutex );
+   api_method_metrics& m = _metrics._methods[_method];
+   --m.queued;
+   ++m.running;
+   m.wait_microseconds += ( _started_at - queued_at ).count();
+}
+
+api_call_metrics::running_scope::~running_scope()
+{
+   const fc::microseconds run_time = fc::time_point::now() - _started_at;
+   std::lock_guard<std::mutex> guard( _metrics._mutex );
+   api_method_metrics& m = _metrics._methods[_method];
+   --m.running;
+   ++m.completed;
+   m.run_microseconds += run_time.count();
+}
+
+void api_call_metrics::on_queued( const char* method )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   api_method_metrics& m = _methods[method];
+   if( m.method.empty() )
+      m.method = method;
+   ++m.queued;
+}
+
+std::vector<api_method_metrics> api_call_metrics::get_metrics()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   std::vector<api_method_metrics> result;
+   result.reserve( _methods.size() );
+   for( const auto& entry : _methods )
+      result.push_back( entry.second );
+   return result;
+}
+
+api_call_statistics::api_call_statistics( fc::microseconds threshold )
+   : slow_call_threshold( threshold )
+{
+}
+
+void api_call_statistics::record( const std::string& method, fc::microseconds duration, uint64_t response_bytes,
+                                  bool failed )
+{
+   const uint64_t us = static_cast<uint64_t>( std::max<int64_t>( duration.count(), 0 ) );
+   if( slow_call_threshold.count() > 0 && duration >= slow_call_threshold )
+      wlog( "Slow API call ${m} took ${t} ms${f}", ("m",method)("t",us / 1000)("f",failed ? " and failed" : "") );
+
+   size_t bucket = 0;
+   while( bucket + 1 < histogram_buckets && ( us + 1 ) >> ( bucket + 1 ) != 0 )
+      ++bucket;
+
+   std::lock_guard<std::mutex> guard( _mutex );
+   method_data& data = _methods[method];
+   if( data.stats.method.empty() )
+      data.stats.method = method;
+   ++data.stats.calls;
+   if( failed )
+      ++data.stats.failures;
+   data.stats.total_microseconds += us;
+   data.stats.max_microseconds = std::max( data.stats.max_microseconds, us );
+   data.stats.total_response_bytes += response_bytes;
+   data.stats.max_response_bytes = std::max( data.stats.max_response_bytes, response_bytes );
+   ++data.histogram[bucket];
+}
+
+std::vector<api_method_statistics> api_call_statistics::get_statistics()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   std::vector<api_method_statistics> result;
+   result.reserve( _methods.size() );
+   for( const auto& entry : _methods )
+   {
+      const method_data& data = entry.second;
+      api_method_statistics stats = data.stats;
+      // the percentile is in the first bucket which reaches it, report the upper bound of that bucket
+      const auto percentile = [&data]( uint64_t permille ) {
+         const uint64_t rank = ( data.stats.calls * permille + 999 ) / 1000;
+         uint64_t count = 0;
+         for( size_t i = 0; i < histogram_buckets; ++i )
+         {
+            count += data.histogram[i];
+            if( count >= rank )
+               return std::min( ( uint64_t(1) << ( i + 1 ) ) - 2, data.stats.max_microseconds );
+         }
+         return data.stats.max_microseconds;
+      };
+      stats.p50_microseconds = percentile( 500 );
+      stats.p99_microseconds = percentile( 990 );
+      result.push_back( stats );
+   }
+   return result;
+}
+
+} } // graphene::app
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/api_response_cache.hpp>
+
+namespace graphene { namespace app {
+
+api_response_cache::api_response_cache( graphene::chain::database& db, size_t max_entries_per_block,
+                                        size_t max_immutable_entries_to_keep )
+   : max_entries( max_entries_per_block ), max_immutable_entries( max_immutable_entries_to_keep )
+{
+   _applied_block_connection = db.applied_block.connect( [this]( const graphene::chain::signed_block& ) {
+      clear();
+   });
+}
+
+void api_response_cache::clear()
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   _entries.clear();
+   ++_generation;
+}
+
+size_t api_response_cache::size()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _entries.size();
+}
+
+size_t api_response_cache::immutable_size()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _immutable_entries.size();
+}
+
+} } // graphene::app
@@ -21,14 +21,26 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
+#include <graphene/app/account_operation_publisher.hpp>
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_call_metrics.hpp>
+#include <graphene/app/api_response_cache.hpp>
 #include <graphene/app/application.hpp>
+#include <graphene/app/block_event_bus.hpp>
+#include <graphene/app/block_production_metrics.hpp>
+#include <graphene/app/http_get_server.hpp>
+#include <graphene/app/object_notification_cache.hpp>
+#include <graphene/app/order_book_cache.hpp>
+#include <graphene/app/order_book_delta_publisher.hpp>
 #include <graphene/app/plugin.hpp>
+#include <graphene/app/transaction_submission_queue.hpp>
 
 #include <graphene/chain/db_with.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
+#include <graphene/protocol/key_string_cache.hpp>
+#include <graphene/protocol/signature_cache.hpp>
 #include <graphene/protocol/types.hpp>
 
 #include <graphene/egenesis/egenesis.hpp>
@@ -36,7 +48,9 @@
 #include <graphene/net/core_messages.hpp>
 #include <graphene/net/exceptions.hpp>
 
+#include <graphene/utilities/download.hpp>
 #include <graphene/utilities/key_conversion.hpp>
+#include <graphene/utilities/thread_affinity.hpp>
 #include <graphene/chain/worker_evaluator.hpp>
 
 #include <fc/asio.hpp>
@@ -44,13 +58,17 @@
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
 #include <fc/crypto/base64.hpp>
+#include <fc/thread/thread.hpp>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/signals2.hpp>
 #include <boost/range/algorithm/reverse.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <condition_variable>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 
 #include <fc/log/file_appender.hpp>
 #include <fc/log/logger.hpp>
@@ -105,6 +123,41 @@ namespace detail {
       return initial_state;
    }
 
+   /// Pins every thread of the fc::asio pool. A task is posted per thread and each of them waits until all of
+   /// them started, so that no thread runs two of the tasks.
+   void pin_io_threads( const std::vector<uint32_t>& cpus )
+   {
+      // the pool and the number of its threads are set up on the first use
+      auto& io_service = fc::asio::default_io_service();
+      const uint32_t count = fc::asio::default_io_service_scope::get_num_threads();
+      std::mutex mutex;
+      std::condition_variable cv;
+      uint32_t started = 0;
+      uint32_t finished = 0;
+      optional<string> error;
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         io_service.post( [&]() {
+            std::unique_lock<std::mutex> lock( mutex );
+            try
+            {
+               utilities::pin_current_thread( cpus );
+            }
+            catch( const fc::exception& e )
+            {
+               error = e.to_string();
+            }
+            ++started;
+            cv.notify_all();
+            cv.wait( lock, [&]() { return started == count; } );
+            ++finished;
+            cv.notify_all();
+         } );
+      }
+      std::unique_lock<std::mutex> lock( mutex );
+      cv.wait( lock, [&]() { return finished == count; } );
+      FC_ASSERT( !error.valid(), "Unable to pin the I/O threads: ${e}", ("e",*error) );
+   }
 
 }
 
@@ -147,6 +200,26 @@ void application_impl::reset_p2p_node(const fc::path& data_dir)
       _p2p_network->add_seed_nodes(seeds);
    }
 
+   if( _options->count("p2p-io-threads") > 0 )
+      _p2p_network->set_network_io_thread_count( _options->at("p2p-io-threads").as<uint32_t>() );
+   if( _options->count("p2p-thread-cpus") > 0 )
+   {
+      const auto cpus = utilities::parse_cpu_set( _options->at("p2p-thread-cpus").as<string>() );
+      _p2p_network->run_in_network_threads( [cpus]() { utilities::pin_current_thread( cpus ); } );
+      ilog( "Pinned the P2P threads to CPUs ${c}", ("c",cpus) );
+   }
+
+   if( _app_options.block_traces )
+      _p2p_network->set_block_tracer( _app_options.block_traces );
+
+   fc::mutable_variant_object trx_batch_parameters;
+   if( _options->count("p2p-trx-batch-flush-interval-ms") > 0 )
+      trx_batch_parameters["trx_batch_flush_interval_ms"] = _options->at("p2p-trx-batch-flush-interval-ms").as<uint32_t>();
+   if( _options->count("p2p-trx-batch-max-size") > 0 )
+      trx_batch_parameters["max_trx_batch_size"] = _options->at("p2p-trx-batch-max-size").as<uint32_t>();
+   if( trx_batch_parameters.size() > 0 )
+      _p2p_network->set_advanced_node_parameters( trx_batch_parameters );
+
    if( _options->count("p2p-endpoint") > 0 )
       _p2p_network->listen_on_endpoint(fc::ip::endpoint::from_string(_options->at("p2p-endpoint").as<string>()), true);
    else
@@ -234,6 +307,17 @@ void application_impl::reset_websocket_tls_server()
    _websocket_tls_server->start_accept();
 } FC_CAPTURE_AND_RETHROW() }
 
+void application_impl::reset_http_get_server()
+{ try {
+   if( 0 == _options->count("http-get-endpoint") )
+      return;
+
+   _http_get_server = std::make_shared<http_get_server>( _self, _app_options.response_cache.get() );
+
+   ilog("Configured HTTP GET server to listen on ${ip}", ("ip",_options->at("http-get-endpoint").as<string>()));
+   _http_get_server->listen( fc::ip::endpoint::from_string(_options->at("http-get-endpoint").as<string>()) );
+} FC_CAPTURE_AND_RETHROW() }
+
 void application_impl::initialize(const fc::path& data_dir, shared_ptr<boost::program_options::variables_map> options)
 {
    _data_dir = data_dir;
@@ -244,6 +328,33 @@ void application_impl::initialize(const fc::path& data_dir, shared_ptr<boost::pr
       const uint16_t num_threads = _options->at("io-threads").as<uint16_t>();
       fc::asio::default_io_service_scope::set_num_threads(num_threads);
    }
+   if( _options->count("io-thread-cpus") > 0 )
+   {
+      const auto cpus = utilities::parse_cpu_set( _options->at("io-thread-cpus").as<string>() );
+      pin_io_threads( cpus );
+      ilog( "Pinned the I/O threads to CPUs ${c}", ("c",cpus) );
+   }
+   if( _options->count("chain-thread-cpus") > 0 )
+   {
+      const auto cpus = utilities::parse_cpu_set( _options->at("chain-thread-cpus").as<string>() );
+      utilities::pin_current_thread( cpus );
+      ilog( "Pinned the chain thread to CPUs ${c}", ("c",cpus) );
+   }
+   if( _options->count("precompute-threads") > 0 )
+   {
+      const uint16_t num_threads = _options->at("precompute-threads").as<uint16_t>();
+      std::vector< std::shared_ptr<fc::thread> > threads;
+      for( uint16_t i = 0; i < num_threads; ++i )
+         threads.push_back( std::make_shared<fc::thread>( "precompute_" + std::to_string( i ) ) );
+      if( _options->count("precompute-thread-cpus") > 0 && num_threads > 0 )
+      {
+         const auto cpus = utilities::parse_cpu_set( _options->at("precompute-thread-cpus").as<string>() );
+         for( const auto& thread : threads )
+            thread->async( [cpus]() { utilities::pin_current_thread( cpus ); } ).wait();
+         ilog( "Pinned the precompute threads to CPUs ${c}", ("c",cpus) );
+      }
+      _chain_db->set_precompute_threads( std::move( threads ) );
+   }
 
    if( _options->count("force-validate") > 0 )
    {
@@ -253,9 +364,95 @@ void application_impl::initialize(const fc::path& data_dir, shared_ptr<boost::pr
 
    if ( _options->count("enable-subscribe-to-all") > 0 )
       _app_options.enable_subscribe_to_all = _options->at( "enable-subscribe-to-all" ).as<bool>();
+   if ( _options->count("batch-notifications") > 0 )
+      _app_options.batch_notifications = _options->at( "batch-notifications" ).as<bool>();
 
    set_api_limit();
 
+   _app_options.notification_cache = std::make_shared<object_notification_cache>( *_chain_db );
+   _app_options.order_book_deltas = std::make_shared<order_book_delta_publisher>( *_chain_db );
+   _app_options.account_operations = std::make_shared<account_operation_publisher>( *_chain_db );
+   _app_options.block_production = std::make_shared<block_production_metrics>();
+   _app_options.block_events = std::make_shared<block_event_bus>( *_chain_db );
+
+   if( _options->count("api-read-threads") > 0 )
+   {
+      const uint16_t num_threads = _options->at("api-read-threads").as<uint16_t>();
+      for( uint16_t i = 0; i < num_threads; ++i )
+         _app_options.api_read_threads.push_back(
+               std::make_shared<fc::thread>( "api_read_" + std::to_string( i ) ) );
+      if( num_threads > 0 )
+         _app_options.api_read_metrics = std::make_shared<api_call_metrics>();
+      if( _options->count("api-read-thread-cpus") > 0 && num_threads > 0 )
+      {
+         const auto cpus = utilities::parse_cpu_set( _options->at("api-read-thread-cpus").as<string>() );
+         for( const auto& thread : _app_options.api_read_threads )
+            thread->async( [cpus]() { utilities::pin_current_thread( cpus ); } ).wait();
+         ilog( "Pinned the API read threads to CPUs ${c}", ("c",cpus) );
+      }
+   }
+
+   {
+      uint32_t cache_size = 0;
+      uint32_t immutable_cache_size = 0;
+      if( _options->count("api-response-cache-size") > 0 )
+         cache_size = _options->at("api-response-cache-size").as<uint32_t>();
+      if( _options->count("api-immutable-cache-size") > 0 )
+         immutable_cache_size = _options->at("api-immutable-cache-size").as<uint32_t>();
+      if( cache_size > 0 || immutable_cache_size > 0 )
+         _app_options.response_cache = std::make_shared<api_response_cache>( *_chain_db, cache_size,
+                                                                             immutable_cache_size );
+   }
+
+   {
+      bool collect_call_stats = false;
+      uint32_t slow_call_threshold_ms = 0;
+      if( _options->count("api-call-statistics") > 0 )
+         collect_call_stats = _options->at("api-call-statistics").as<bool>();
+      if( _options->count("api-slow-call-threshold-ms") > 0 )
+         slow_call_threshold_ms = _options->at("api-slow-call-threshold-ms").as<uint32_t>();
+      if( collect_call_stats || slow_call_threshold_ms > 0 )
+         _app_options.api_call_stats = std::make_shared<api_call_statistics>(
+                                             fc::milliseconds( slow_call_threshold_ms ) );
+   }
+
+   if( _options->count("api-order-book-cache-size") > 0 )
+   {
+      const uint32_t cache_size = _options->at("api-order-book-cache-size").as<uint32_t>();
+      if( cache_size > 0 )
+         _app_options.order_books = std::make_shared<order_book_cache>( cache_size );
+   }
+
+   if( _options->count("api-transaction-queue-size") > 0 )
+   {
+      const uint32_t queue_size = _options->at("api-transaction-queue-size").as<uint32_t>();
+      uint32_t batch_size = 50;
+      if( _options->count("api-transaction-batch-size") > 0 )
+         batch_size = _options->at("api-transaction-batch-size").as<uint32_t>();
+      if( queue_size > 0 )
+         _app_options.transaction_submissions = std::make_shared<transaction_submission_queue>( *_chain_db,
+                                                                                                 queue_size,
+                                                                                                 batch_size );
+   }
+
+   if( _options->count("block-trace-size") > 0 )
+   {
+      const uint32_t trace_size = _options->at("block-trace-size").as<uint32_t>();
+      if( trace_size > 0 )
+      {
+         _app_options.block_traces = std::make_shared<net::block_tracer>( trace_size );
+         // the first applied_block handler notes the start, the plugins are done when the notifications finished
+         _block_trace_applied_block_connection = _chain_db->applied_block.connect( [this]( const signed_block& ) {
+            _applied_block_start_time = fc::time_point::now();
+         }, boost::signals2::at_front );
+         _block_trace_notifications_finished_connection = _chain_db->block_notifications_finished.connect(
+               [this]( const signed_block& b ) {
+            _app_options.block_traces->add_span( b.id(), "applied_block_handlers", _applied_block_start_time,
+                                                 fc::time_point::now() );
+         } );
+      }
+   }
+
    if( is_plugin_enabled( "market_history" ) )
       _app_options.has_market_history_plugin = true;
    else
@@ -314,6 +511,10 @@ void application_impl::set_api_limit() {
       _app_options.api_limit_get_relative_account_history =
             _options->at("api-limit-get-relative-account-history").as<uint64_t>();
    }
+   if(_options->count("api-limit-get-account-history-batch") > 0){
+      _app_options.api_limit_get_account_history_batch =
+            _options->at("api-limit-get-account-history-batch").as<uint64_t>();
+   }
    if(_options->count("api-limit-get-account-history-by-operations") > 0){
       _app_options.api_limit_get_account_history_by_operations =
             _options->at("api-limit-get-account-history-by-operations").as<uint64_t>();
@@ -434,6 +635,22 @@ void application_impl::set_api_limit() {
       _app_options.api_limit_get_credit_offers =
             _options->at("api-limit-get-credit-offers").as<uint64_t>();
    }
+   if(_options->count("api-limit-get-signatures-batch") > 0) {
+      _app_options.api_limit_get_signatures_batch =
+            _options->at("api-limit-get-signatures-batch").as<uint64_t>();
+   }
+   if(_options->count("api-limit-get-object-fields") > 0) {
+      _app_options.api_limit_get_object_fields =
+            _options->at("api-limit-get-object-fields").as<uint64_t>();
+   }
+   if(_options->count("api-limit-get-tickers") > 0) {
+      _app_options.api_limit_get_tickers =
+            _options->at("api-limit-get-tickers").as<uint64_t>();
+   }
+   if(_options->count("api-limit-subscribe-to-account-operations") > 0) {
+      _app_options.api_limit_subscribe_to_account_operations =
+            _options->at("api-limit-subscribe-to-account-operations").as<uint64_t>();
+   }
 }
 
 graphene::chain::genesis_state_type application_impl::initialize_genesis_state() const
@@ -444,7 +661,8 @@ graphene::chain::genesis_state_type application_impl::initialize_genesis_state()
       {
          std::string genesis_str;
          fc::read_file_contents( _options->at("genesis-json").as<boost::filesystem::path>(), genesis_str );
-         auto genesis = fc::json::from_string( genesis_str ).as<graphene::chain::genesis_state_type>( 20 );
+         auto genesis = graphene::chain::genesis_state_type::from_variant_in_parallel(
+                              fc::json::from_string( genesis_str ), 20 );
          bool modified_genesis = false;
          if( _options->count("genesis-timestamp") > 0 )
          {
@@ -478,11 +696,27 @@ graphene::chain::genesis_state_type application_impl::initialize_genesis_state()
       }
       else
       {
+         std::string egenesis_binary;
+         graphene::egenesis::compute_egenesis_binary( egenesis_binary );
+         if( !egenesis_binary.empty() )
+         {
+            FC_ASSERT( graphene::egenesis::get_egenesis_binary_hash()
+                       == fc::sha256::hash( egenesis_binary.data(), egenesis_binary.size() ) );
+            std::pair< fc::sha256, graphene::chain::genesis_state_type > embedded;
+            fc::datastream<const char*> ds( egenesis_binary.data(), egenesis_binary.size() );
+            fc::raw::unpack( ds, embedded );
+            // the binary form was produced from the embedded JSON, which defines the chain ID
+            FC_ASSERT( embedded.first == graphene::egenesis::get_egenesis_json_hash() );
+            embedded.second.initial_chain_id = embedded.first;
+            return embedded.second;
+         }
+
          std::string egenesis_json;
          graphene::egenesis::compute_egenesis_json( egenesis_json );
          FC_ASSERT( egenesis_json != "" );
          FC_ASSERT( graphene::egenesis::get_egenesis_json_hash() == fc::sha256::hash( egenesis_json ) );
-         auto genesis = fc::json::from_string( egenesis_json ).as<graphene::chain::genesis_state_type>( 20 );
+         auto genesis = graphene::chain::genesis_state_type::from_variant_in_parallel(
+                              fc::json::from_string( egenesis_json ), 20 );
          genesis.initial_chain_id = fc::sha256::hash( egenesis_json );
          return genesis;
       }
@@ -509,14 +743,127 @@ void application_impl::open_chain_database() const
    }
    _chain_db->add_checkpoints( loaded_checkpoints );
 
+   if( _options->count("assume-valid-block") > 0 )
+   {
+      _chain_db->set_assume_valid_block( block_id_type( _options->at("assume-valid-block").as<string>() ) );
+   }
+
+   if( _options->count("max-pending-transactions") > 0 )
+   {
+      _chain_db->set_pending_transaction_limit( _options->at("max-pending-transactions").as<uint32_t>() );
+   }
+
    if( _options->count("enable-standby-votes-tracking") > 0 )
    {
       _chain_db->enable_standby_votes_tracking( _options->at("enable-standby-votes-tracking").as<bool>() );
    }
 
+   if( _options->count("enable-packed-undo-states") > 0 )
+   {
+      _chain_db->enable_packed_undo_states( _options->at("enable-packed-undo-states").as<bool>() );
+   }
+
+   if( _options->count("enable-incremental-flush") > 0 )
+   {
+      _chain_db->enable_incremental_flush( _options->at("enable-incremental-flush").as<bool>() );
+   }
+
+   if( _options->count("enable-incremental-vote-tally") > 0 )
+   {
+      const bool verify = ( _options->count("verify-incremental-vote-tally") > 0
+                            && _options->at("verify-incremental-vote-tally").as<bool>() );
+      _chain_db->enable_incremental_vote_tally( _options->at("enable-incremental-vote-tally").as<bool>(), verify );
+   }
+
+   if( _options->count("maintenance-profile-history") > 0 )
+   {
+      _chain_db->set_maintenance_profile_history( _options->at("maintenance-profile-history").as<uint32_t>() );
+   }
+
+   if( _options->count("store-recent-transactions") > 0 )
+   {
+      _chain_db->enable_recent_transaction_storage( _options->at("store-recent-transactions").as<bool>() );
+   }
+
+   if( _options->count("log-index-memory-usage") > 0 )
+   {
+      _chain_db->enable_index_memory_usage_logging( _options->at("log-index-memory-usage").as<bool>() );
+   }
+
+   if( _options->count("block-log-keep-blocks") > 0 )
+   {
+      _chain_db->set_block_log_pruning( _options->at("block-log-keep-blocks").as<uint32_t>() );
+   }
+
+   if( _options->count("fork-db-hot-window") > 0 )
+   {
+      _chain_db->set_fork_db_hot_window( _options->at("fork-db-hot-window").as<uint32_t>() );
+   }
+
+   if( _options->count("undo-memory-limit") > 0 )
+   {
+      _chain_db->set_undo_memory_limit( _options->at("undo-memory-limit").as<uint64_t>() * 1024 * 1024 );
+   }
+
+   if( _options->count("reindex-prefetch-blocks") > 0 )
+   {
+      _chain_db->set_reindex_prefetch_depth( _options->at("reindex-prefetch-blocks").as<uint32_t>() );
+   }
+
+   if( _options->count("block-write-queue") > 0 )
+   {
+      _chain_db->set_block_write_queue_size( _options->at("block-write-queue").as<uint32_t>() );
+   }
+
+   if( _options->count("signature-cache-size") > 0 )
+   {
+      graphene::protocol::signature_cache::instance().set_capacity(
+            _options->at("signature-cache-size").as<uint32_t>() );
+   }
+
+   if( _options->count("key-string-cache-size") > 0 )
+   {
+      graphene::protocol::key_string_cache::instance().set_capacity(
+            _options->at("key-string-cache-size").as<uint32_t>() );
+   }
+
+   {
+      graphene::chain::segmented_block_log::settings block_log_format;
+      if( _options->count("block-log-segment-size") > 0 )
+         block_log_format.blocks_per_segment = _options->at("block-log-segment-size").as<uint32_t>();
+      if( _options->count("block-log-compression") > 0 )
+         block_log_format.compress = _options->at("block-log-compression").as<bool>();
+      _chain_db->set_block_log_format( block_log_format );
+   }
+
    if( _options->count("replay-blockchain") > 0 || _options->count("revalidate-blockchain") > 0 )
       _chain_db->wipe( _data_dir / "blockchain", false );
 
+   if( _options->count("import-blocks") > 0 )
+   {
+      const string source = _options->at("import-blocks").as<string>();
+      const bool remote = boost::starts_with( source, "http://" ) || boost::starts_with( source, "https://" );
+      fc::path file( source );
+      if( remote )
+      {
+         file = _data_dir / "blockchain" / "import.blocks";
+         ilog( "Downloading blocks from ${u}", ("u",source) );
+         graphene::utilities::download_file( source, file );
+      }
+      {
+         std::ifstream in( file.generic_string(), std::ios::in | std::ios::binary );
+         FC_ASSERT( in, "Unable to open ${f}", ("f",file) );
+         _chain_db->import_blocks( _data_dir / "blockchain", in );
+      }
+      if( remote )
+         fc::remove( file );
+   }
+
+   if( _options->count("load-state-snapshot") > 0 )
+   {
+      _chain_db->set_state_snapshot( fc::path( _options->at("load-state-snapshot").as<string>() ) );
+   }
+
    try
    {
       // these flags are used in open() only, i. e. during replay
@@ -564,11 +911,13 @@ void application_impl::startup()
 
    startup_plugins();
 
-   if( enable_p2p_network && _active_plugins.find( "delayed_node" ) == _active_plugins.end() )
+   if( enable_p2p_network && _active_plugins.find( "delayed_node" ) == _active_plugins.end()
+         && _active_plugins.find( "history_follower" ) == _active_plugins.end() )
       reset_p2p_node(_data_dir);
 
    reset_websocket_server();
    reset_websocket_tls_server();
+   reset_http_get_server();
 } FC_LOG_AND_RETHROW() }
 
 optional< api_access_info > application_impl::get_api_access_info(const string& username)const
@@ -617,8 +966,7 @@ bool application_impl::has_item(const net::item_id& id)
  *
  * @throws exception if error validating the item, otherwise the item is safe to broadcast on.
  */
-bool application_impl::handle_block(const graphene::net::block_message& blk_msg, bool sync_mode,
-                          std::vector<graphene::net::message_hash_type>& contained_transaction_msg_ids)
+bool application_impl::handle_block(const graphene::net::block_message& blk_msg, bool sync_mode)
 { try {
 
    auto latency = fc::time_point::now() - blk_msg.block.timestamp;
@@ -626,7 +974,7 @@ bool application_impl::handle_block(const graphene::net::block_message& blk_msg,
    {
       const auto& witness = blk_msg.block.witness(*_chain_db);
       const auto& witness_account = witness.witness_account(*_chain_db);
-      auto last_irr = _chain_db->get_dynamic_global_properties().last_irreversible_block_num;
+      auto last_irr = _chain_db->get_head_state()->last_irreversible_block_num;
       ilog("Got block: #${n} ${bid} time: ${t} transaction(s): ${x} "
            "latency: ${l} ms from: ${w}  irreversible: ${i} (-${d})",
            ("t",blk_msg.block.timestamp)
@@ -644,9 +992,12 @@ bool application_impl::handle_block(const graphene::net::block_message& blk_msg,
    try {
       const uint32_t skip = (_is_block_producer || _force_validate) ?
                                database::skip_nothing : database::skip_transaction_signatures;
-      bool result = valve.do_serial( [this,&blk_msg,skip] () {
+      net::block_tracer* const tracer = _app_options.block_traces.get();
+      bool result = valve.do_serial( [this,&blk_msg,skip,tracer] () {
+         net::block_trace_scope trace( tracer, blk_msg.block_id, "precompute_parallel" );
          _chain_db->precompute_parallel( blk_msg.block, skip ).wait();
-      }, [this,&blk_msg,skip] () {
+      }, [this,&blk_msg,skip,tracer] () {
+         net::block_trace_scope trace( tracer, blk_msg.block_id, "push_block" );
          // TODO: in the case where this block is valid but on a fork that's too old for us to switch to,
          // you can help the network code out by throwing a block_older_than_undo_history exception.
          // when the net code sees that, it will stop trying to push blocks from that chain, but
@@ -654,23 +1005,6 @@ bool application_impl::handle_block(const graphene::net::block_message& blk_msg,
          return _chain_db->push_block( blk_msg.block, skip );
       });
 
-      // the block was accepted, so we now know all of the transactions contained in the block
-      if (!sync_mode)
-      {
-         // if we're not in sync mode, there's a chance we will be seeing some transactions
-         // included in blocks before we see the free-floating transaction itself.  If that
-         // happens, there's no reason to fetch the transactions, so  construct a list of the
-         // transaction message ids we no longer need.
-         // during sync, it is unlikely that we'll see any old
-         contained_transaction_msg_ids.reserve( contained_transaction_msg_ids.size()
-                                                    + blk_msg.block.transactions.size() );
-         for (const processed_transaction& ptrx : blk_msg.block.transactions)
-         {
-            graphene::net::trx_message transaction_message(ptrx);
-            contained_transaction_msg_ids.emplace_back(graphene::net::message(transaction_message).id());
-         }
-      }
-
       return result;
    } catch ( const graphene::chain::unlinkable_block_exception& e ) {
       // translate to a graphene::net exception
@@ -734,7 +1068,8 @@ std::vector<item_hash_t> application_impl::get_block_ids(const std::vector<item_
 { try {
    vector<block_id_type> result;
    remaining_item_count = 0;
-   if( _chain_db->head_block_num() == 0 )
+   const uint32_t head_block_num = _chain_db->get_head_state()->block_num;
+   if( head_block_num == 0 )
       return result;
 
    result.reserve(limit);
@@ -764,14 +1099,18 @@ std::vector<item_hash_t> application_impl::get_block_ids(const std::vector<item_
        FC_THROW_EXCEPTION( graphene::net::peer_is_on_an_unreachable_fork,
                            "Unable to provide a list of blocks starting at any of the blocks in peer's synopsis" );
    }
+   // the peer is told that we have no blocks for it, so that it fetches them from other nodes
+   if( std::max( block_header::num_from_id(last_known_block_id), 1u ) < _chain_db->first_available_block_num() )
+     FC_THROW_EXCEPTION( graphene::net::peer_is_on_an_unreachable_fork,
+                         "The blocks after the peer's synopsis have been pruned" );
    for( uint32_t num = block_header::num_from_id(last_known_block_id);
-        num <= _chain_db->head_block_num() && result.size() < limit;
+        num <= head_block_num && result.size() < limit;
         ++num )
       if( num > 0 )
          result.push_back(_chain_db->get_block_id_for_num(num));
 
-   if( !result.empty() && block_header::num_from_id(result.back()) < _chain_db->head_block_num() )
-      remaining_item_count = _chain_db->head_block_num() - block_header::num_from_id(result.back());
+   if( !result.empty() && block_header::num_from_id(result.back()) < head_block_num )
+      remaining_item_count = head_block_num - block_header::num_from_id(result.back());
 
    return result;
 } FC_CAPTURE_AND_RETHROW( (blockchain_synopsis)(remaining_item_count)(limit) ) }
@@ -784,17 +1123,39 @@ message application_impl::get_item(const item_id& id)
   // ilog("Request for item ${id}", ("id", id));
    if( id.item_type == graphene::net::block_message_type )
    {
-      auto opt_block = _chain_db->fetch_block_by_id(id.item_hash);
-      if( !opt_block )
+      // the stored block is relayed as it is, it is not unpacked only to be packed again
+      auto packed_block = _chain_db->fetch_packed_block_by_id(id.item_hash);
+      if( !packed_block && block_header::num_from_id(id.item_hash) < _chain_db->first_available_block_num() )
+         FC_THROW_EXCEPTION( fc::key_not_found_exception, "Block ${id} has been pruned", ("id", id.item_hash) );
+      if( !packed_block )
          elog("Couldn't find block ${id} -- corresponding ID in our chain is ${id2}",
               ("id", id.item_hash)("id2", _chain_db->get_block_id_for_num(block_header::num_from_id(id.item_hash))));
-      FC_ASSERT( opt_block.valid() );
-      // ilog("Serving up block #${num}", ("num", opt_block->block_num()));
-      return block_message(std::move(*opt_block));
+      FC_ASSERT( packed_block.valid() );
+      // ilog("Serving up block #${num}", ("num", block_header::num_from_id(id.item_hash)));
+      return block_message::pack_message( *packed_block, id.item_hash );
    }
    return trx_message( _chain_db->get_recent_transaction( id.item_hash ) );
 } FC_CAPTURE_AND_RETHROW( (id) ) }
 
+std::vector<std::vector<char>> application_impl::get_packed_blocks( uint32_t first_block_num, uint32_t count,
+                                                                     size_t max_total_size )
+{ try {
+   std::vector<std::vector<char>> result;
+   size_t total_size = 0;
+   const uint32_t head_block_num = _chain_db->get_head_state()->block_num;
+   for( uint32_t block_num = std::max<uint32_t>( first_block_num, 1 );
+        block_num <= head_block_num && result.size() < count;
+        ++block_num )
+   {
+      optional<std::vector<char>> packed_block = _chain_db->fetch_packed_block_by_number( block_num );
+      if( !packed_block.valid() || total_size + packed_block->size() > max_total_size )
+         break;
+      total_size += packed_block->size();
+      result.push_back( std::move( *packed_block ) );
+   }
+   return result;
+} FC_CAPTURE_AND_RETHROW( (first_block_num)(count)(max_total_size) ) }
+
 chain_id_type application_impl::get_chain_id() const
 {
    return _chain_db->get_chain_id();
@@ -944,7 +1305,7 @@ std::vector<item_hash_t> application_impl::get_blockchain_synopsis(const item_ha
     else
     {
       // no reference point specified, summarize the whole block chain
-      high_block_num = _chain_db->head_block_num();
+      high_block_num = _chain_db->get_head_state()->block_num;
       non_fork_high_block_num = high_block_num;
       if (high_block_num == 0)
         return synopsis; // we have no blocks
@@ -1016,7 +1377,7 @@ fc::time_point_sec application_impl::get_block_time(const item_hash_t& block_id)
 
 item_hash_t application_impl::get_head_block_id() const
 {
-   return _chain_db->head_block_id();
+   return _chain_db->get_head_state()->block_id;
 }
 
 uint32_t application_impl::estimate_last_known_fork_from_git_revision_timestamp(uint32_t unix_timestamp) const
@@ -1042,11 +1403,22 @@ void application_impl::shutdown()
       _websocket_tls_server.reset();
    if( _websocket_server )
       _websocket_server.reset();
+   if( _http_get_server )
+      _http_get_server.reset();
    // TODO wait until all connections are closed and messages handled?
+   _app_options.api_read_threads.clear();
+   _app_options.response_cache.reset();
+   _app_options.notification_cache.reset();
+   _app_options.order_book_deltas.reset();
+   _app_options.account_operations.reset();
+   _app_options.order_books.reset();
+   _app_options.transaction_submissions.reset();
 
    // plugins E.G. witness_plugin may send data to p2p network, so shutdown them first
    ilog( "Shutting down plugins" );
    shutdown_plugins();
+   // the plugins removed their consumers, the remaining ones stop after consuming their queued events
+   _app_options.block_events.reset();
 
    if( _p2p_network )
    {
@@ -1136,19 +1508,32 @@ void application::set_program_options(boost::program_options::options_descriptio
    const auto& default_opts = application_options::get_default();
    configuration_file_options.add_options()
          ("enable-p2p-network", bpo::value<bool>()->implicit_value(true),
-          "Whether to enable P2P network. Note: if delayed_node plugin is enabled, "
+          "Whether to enable P2P network. Note: if delayed_node or history_follower plugin is enabled, "
           "this option will be ignored and P2P network will always be disabled.")
          ("p2p-endpoint", bpo::value<string>(), "Endpoint for P2P node to listen on")
+         ("p2p-io-threads", bpo::value<uint32_t>(),
+          "Number of threads which handle socket I/O, encryption and message framing of P2P connections, "
+          "0 to do it all in the P2P thread (default: 0)")
+         ("p2p-trx-batch-flush-interval-ms", bpo::value<uint32_t>(),
+          "Milliseconds to collect transactions requested by a peer before sending them in one message (default: 5)")
+         ("p2p-trx-batch-max-size", bpo::value<uint32_t>(),
+          "Maximum number of transactions sent to a peer in one message, 0 or 1 to disable batching (default: 100)")
          ("seed-node,s", bpo::value<vector<string>>()->composing(),
           "P2P nodes to connect to on startup (may specify multiple times)")
          ("seed-nodes", bpo::value<string>()->composing(),
           "JSON array of P2P nodes to connect to on startup")
          ("checkpoint,c", bpo::value<vector<string>>()->composing(),
           "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
+         ("assume-valid-block", bpo::value<string>(),
+          "ID of a trusted block, it and its ancestors are applied without checking signatures, TaPoS, block sizes "
+          "and merkle roots, and no other block is accepted at its number")
          ("rpc-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8090"),
           "Endpoint for websocket RPC to listen on")
          ("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8089"),
           "Endpoint for TLS websocket RPC to listen on")
+         ("http-get-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8091"),
+          "Endpoint for plain HTTP GET requests of irreversible blocks and operations to listen on, "
+          "the responses may be cached by proxies")
          ("server-pem,p", bpo::value<string>()->implicit_value("server.pem"),
           "The TLS certificate file for this server")
          ("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate")
@@ -1161,11 +1546,109 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
          ("io-threads", bpo::value<uint16_t>()->implicit_value(0),
           "Number of IO threads, default to 0 for auto-configuration")
+         ("precompute-threads", bpo::value<uint16_t>()->default_value(0),
+          "Number of threads which precompute the stateless checks of blocks and transactions, most of all the "
+          "recovery of signatures, 0 to do it in the IO threads")
+         ("chain-thread-cpus", bpo::value<string>(),
+          "CPUs to run the chain thread on, a comma separated list of CPU numbers, ranges like 0-3 and NUMA "
+          "nodes like node:1 (default: any)")
+         ("io-thread-cpus", bpo::value<string>(),
+          "CPUs to run the IO threads on, in the format of chain-thread-cpus (default: any)")
+         ("precompute-thread-cpus", bpo::value<string>(),
+          "CPUs to run the precompute threads on, in the format of chain-thread-cpus (default: any)")
+         ("p2p-thread-cpus", bpo::value<string>(),
+          "CPUs to run the P2P thread and the P2P IO threads on, in the format of chain-thread-cpus (default: any)")
+         ("api-read-thread-cpus", bpo::value<string>(),
+          "CPUs to run the API read threads on, in the format of chain-thread-cpus (default: any)")
+         ("api-read-threads", bpo::value<uint16_t>()->default_value(0),
+          "Number of threads which execute heavy read-only database API calls, such as get_full_accounts or "
+          "get_top_markets, concurrently with block processing, 0 to execute them in the main thread")
+         ("api-response-cache-size", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of results of read-only database API calls which only depend on the head block, "
+          "such as get_order_book or get_ticker, which are cached until the next block and shared by all "
+          "clients, 0 to disable the cache. Cached results do not reflect transactions received after they "
+          "were computed")
+         ("api-immutable-cache-size", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of results of database API calls which never change, such as get_block "
+          "for irreversible blocks, which are cached and shared by all clients, 0 to disable the cache")
+         ("api-call-statistics", bpo::value<bool>()->implicit_value(true),
+          "Whether to collect the number, execution time and result size of the calls of every method of "
+          "database_api, history_api and block_api, see network_node_api.get_api_call_statistics")
+         ("api-slow-call-threshold-ms", bpo::value<uint32_t>()->default_value(0),
+          "Log the calls of database_api, history_api and block_api which take at least this many milliseconds, "
+          "0 to disable")
+         ("api-order-book-cache-size", bpo::value<uint32_t>()->default_value(500),
+          "Maximum number of markets whose order books are cached for get_order_book, get_ticker and "
+          "get_top_markets until an order of the market changes, 0 to disable the cache. "
+          "It requires the api_helper_indexes plugin")
+         ("api-transaction-queue-size", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of transactions received by network_broadcast_api which are being validated or wait "
+          "to be pushed to the database, further transactions are rejected until the queue drains, "
+          "0 to validate and push every transaction synchronously")
+         ("api-transaction-batch-size", bpo::value<uint32_t>()->default_value(50),
+          "Maximum number of queued transactions which are pushed to the database at once, "
+          "see api-transaction-queue-size")
+         ("max-pending-transactions", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of pending transactions, when it is reached a new transaction is only accepted if its "
+          "fee per byte, divided by the number of pending transactions of its fee payer, exceeds that of the "
+          "lowest pending ones, which are evicted. 0 for no limit")
+         ("block-trace-size", bpo::value<uint32_t>()->default_value(0),
+          "Number of recently received blocks whose time spent in every stage, from the P2P socket to the "
+          "re-broadcast, is kept for network_node_api::get_block_traces, 0 to disable tracing")
          ("enable-subscribe-to-all", bpo::value<bool>()->implicit_value(true),
           "Whether allow API clients to subscribe to universal object creation and removal events")
+         ("batch-notifications", bpo::value<bool>()->implicit_value(true),
+          "Whether to send the object notifications of a subscription which are caused by one block, i.e. its new, "
+          "changed and removed objects, in one message, and likewise the order notifications of a market")
          ("enable-standby-votes-tracking", bpo::value<bool>()->implicit_value(true),
           "Whether to enable tracking of votes of standby witnesses and committee members. "
           "Set it to true to provide accurate data to API clients, set to false for slightly better performance.")
+         ("enable-packed-undo-states", bpo::value<bool>()->implicit_value(true),
+          "Whether to keep serialized pre-images of modified objects in undo states instead of full copies. "
+          "Set it to true to reduce memory usage and allocations, set to false for slightly faster undo.")
+         ("enable-incremental-flush", bpo::value<bool>()->implicit_value(true),
+          "Whether to only write the objects that have changed since the last time when saving the object database "
+          "to disk. Set it to true for faster restarts, set to false to always write a complete copy.")
+         ("enable-incremental-vote-tally", bpo::value<bool>()->implicit_value(true),
+          "Whether to update the vote tally of the previous maintenance interval with the accounts which have "
+          "changed instead of tallying all votes from scratch. Set it to true for faster maintenance blocks.")
+         ("verify-incremental-vote-tally", bpo::value<bool>()->implicit_value(true),
+          "Whether to verify the incremental vote tally against a tally from scratch, "
+          "only used together with enable-incremental-vote-tally")
+         ("maintenance-profile-history", bpo::value<uint32_t>()->default_value(16),
+          "The number of recent maintenances whose cost by phase is kept for the get_maintenance_profiles API")
+         ("store-recent-transactions", bpo::value<bool>()->implicit_value(true),
+          "Whether to keep a copy of every unexpired transaction for the get_recent_transaction_by_id API. "
+          "Set it to false to save memory, duplicate transactions are detected either way.")
+         ("log-index-memory-usage", bpo::value<bool>()->implicit_value(true),
+          "Whether to log the estimated memory usage of every object index at each maintenance interval")
+         ("block-log-segment-size", bpo::value<uint32_t>()->default_value(0),
+          "The number of blocks per file when a new block database is created, at least 10000. "
+          "0 stores all blocks in a single file. An existing block database keeps its format.")
+         ("block-log-compression", bpo::value<bool>()->implicit_value(true),
+          "Whether to compress new blocks in a segmented block database with zstd")
+         ("block-log-keep-blocks", bpo::value<uint32_t>()->default_value(0),
+          "If not 0, remove blocks from a segmented block database once they are irreversible and older than "
+          "this many blocks. Whole segments are removed, so up to one more segment is kept. "
+          "Nodes which prune can not serve old blocks to peers and can not replay.")
+         ("fork-db-hot-window", bpo::value<uint32_t>()->default_value(0),
+          "If not 0, the fork database keeps the transactions of only this many recent blocks in memory and reads "
+          "older ones from the block database when switching forks")
+         ("undo-memory-limit", bpo::value<uint64_t>()->default_value(0),
+          "If not 0, the approximate number of MiB the undo states of reversible blocks may use. Above it the "
+          "oldest states keep packed pre-images instead of object copies. States needed to switch forks are "
+          "never dropped, so the limit can be exceeded while blocks do not become irreversible.")
+         ("reindex-prefetch-blocks", bpo::value<uint32_t>()->default_value(200),
+          "The maximum number of blocks which are read from disk ahead of the block being applied during a replay")
+         ("block-write-queue", bpo::value<uint32_t>()->default_value(0),
+          "If not 0, new blocks are written to the block database by a background thread, which may fall behind "
+          "by up to this many blocks. 0 writes every block before it is relayed.")
+         ("signature-cache-size", bpo::value<uint32_t>()->default_value(100000),
+          "The maximum number of public keys recovered from transaction signatures which are kept for transactions "
+          "seen again, e.g. received through the API or from peers and later in a block. 0 disables the cache.")
+         ("key-string-cache-size", bpo::value<uint32_t>()->default_value(20000),
+          "The maximum number of public keys whose base58 forms are kept for API responses and requests which use "
+          "them again, in each direction. 0 disables the cache.")
          ("api-limit-get-account-history-operations",
           bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_account_history_operations),
           "For history_api::get_account_history_operations to set max limit value")
@@ -1178,6 +1661,9 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("api-limit-get-relative-account-history",
           bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_relative_account_history),
           "For history_api::get_relative_account_history to set max limit value")
+         ("api-limit-get-account-history-batch",
+          bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_account_history_batch),
+          "For history_api::get_account_history_batch to set max number of accounts")
          ("api-limit-get-account-history-by-operations",
           bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_account_history_by_operations),
           "For history_api::get_account_history_by_operations to set max limit value")
@@ -1201,7 +1687,8 @@ void application::set_program_options(boost::program_options::options_descriptio
           "For database_api_impl::get_top_voters to set max limit value")
          ("api-limit-get-call-orders",
           bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_call_orders),
-          "For database_api_impl::get_call_orders and get_call_orders_by_account to set max limit value")
+          "For database_api_impl::get_call_orders, get_call_orders_by_account and get_margin_call_risk "
+          "to set max limit value")
          ("api-limit-get-settle-orders",
           bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_settle_orders),
           "For database_api_impl::get_settle_orders and get_settle_orders_by_account to set max limit value")
@@ -1268,12 +1755,31 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("api-limit-get-credit-offers",
           bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_credit_offers),
           "Set maximum limit value for database APIs which query for credit offers or credit deals")
+         ("api-limit-get-signatures-batch",
+          bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_signatures_batch),
+          "Set maximum number of transactions for database APIs which evaluate signatures in batches")
+         ("api-limit-get-object-fields",
+          bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_object_fields),
+          "Set maximum number of objects for database_api::get_object_fields")
+         ("api-limit-get-tickers",
+          bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_tickers),
+          "Set maximum number of markets for database_api::get_tickers")
+         ("api-limit-subscribe-to-account-operations",
+          bpo::value<uint64_t>()->default_value(default_opts.api_limit_subscribe_to_account_operations),
+          "Set maximum number of accounts for database_api::subscribe_to_account_operations")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
          ("replay-blockchain", "Rebuild object graph by replaying all blocks without validation")
          ("revalidate-blockchain", "Rebuild object graph by replaying all blocks with full validation")
          ("resync-blockchain", "Delete all blocks and re-sync with network from scratch")
+         ("load-state-snapshot", bpo::value<string>(),
+          "Replace the local state with a binary snapshot created by the snapshot plugin, then continue syncing. "
+          "Plugins which keep their own objects need a snapshot from a node with the same plugins.")
+         ("import-blocks", bpo::value<string>(),
+          "Fill an empty block database with the blocks of a file or http(s) URL, e.g. the 'blocks' file of another "
+          "node, then replay them or continue from load-state-snapshot. Use with resync-blockchain on a node "
+          "which has blocks.")
          ("force-validate", "Force validation of all transactions during normal operation")
          ("genesis-timestamp", bpo::value<uint32_t>(),
           "Replace timestamp from genesis.json with current time plus this many seconds (experts only!)")
@@ -5,6 +5,7 @@
 
 #include <graphene/app/application.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/http_get_server.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/protocol/types.hpp>
 #include <graphene/net/message.hpp>
@@ -28,6 +29,8 @@ class application_impl : public net::node_delegate, public std::enable_shared_fr
 
       void reset_websocket_tls_server();
 
+      void reset_http_get_server();
+
       explicit application_impl(application& self)
          : _self(self),
            _chain_db(std::make_shared<chain::database>())
@@ -57,13 +60,11 @@ class application_impl : public net::node_delegate, public std::enable_shared_fr
        *
        * @param blk_msg the message which contains the block
        * @param sync_mode true if the message was fetched through the sync process, false during normal operation
-       * @param contained_transaction_msg_ids container for the transactions to write back into
        * @returns true if this message caused the blockchain to switch forks, false if it did not
        *
        * @throws exception if error validating the item, otherwise the item is safe to broadcast on.
        */
-      bool handle_block(const graphene::net::block_message& blk_msg, bool sync_mode,
-                        std::vector<graphene::net::message_hash_type>& contained_transaction_msg_ids) override;
+      bool handle_block(const graphene::net::block_message& blk_msg, bool sync_mode) override;
 
       void handle_transaction(const graphene::net::trx_message& transaction_message) override;
 
@@ -90,6 +91,9 @@ class application_impl : public net::node_delegate, public std::enable_shared_fr
        */
       graphene::net::message get_item(const graphene::net::item_id& id) override;
 
+      std::vector<std::vector<char>> get_packed_blocks( uint32_t first_block_num, uint32_t count,
+                                                        size_t max_total_size ) override;
+
       graphene::chain::chain_id_type get_chain_id()const override;
 
       /**
@@ -218,12 +222,18 @@ class application_impl : public net::node_delegate, public std::enable_shared_fr
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+      std::shared_ptr<http_get_server>                 _http_get_server;
 
       std::map<string, std::shared_ptr<abstract_plugin>> _active_plugins;
       std::map<string, std::shared_ptr<abstract_plugin>> _available_plugins;
 
       bool _is_finished_syncing = false;
 
+      /// When the applied_block signal of the block being applied started, for the block tracer
+      fc::time_point _applied_block_start_time;
+      boost::signals2::scoped_connection _block_trace_applied_block_connection;
+      boost::signals2::scoped_connection _block_trace_notifications_finished_connection;
+
       fc::serial_valve valve;
    };
 
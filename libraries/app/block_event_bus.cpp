@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/block_event_bus.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+struct block_event_bus::consumer
+{
+   consumer( const string& name, consumer_type callback, uint32_t max_queue_size, bool with_objects )
+   : callback( std::move( callback ) ), max_queue_size( max_queue_size ), with_objects( with_objects ),
+     thread( std::make_unique<fc::thread>( name ) )
+   {
+      metrics.name = name;
+      metrics.max_queue_size = max_queue_size;
+   }
+
+   /// Consumes the queued events, runs in the thread of the consumer
+   void consume()
+   {
+      while( true )
+      {
+         std::shared_ptr<const block_event> event;
+         {
+            std::lock_guard<std::mutex> guard( mutex );
+            if( queue.empty() )
+            {
+               scheduled = false;
+               return;
+            }
+            event = queue.front();
+         }
+         bool ok = false;
+         try
+         {
+            callback( *event );
+            ok = true;
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "Block event consumer ${c} failed on block ${b}: ${e}",
+                  ("c",metrics.name)("b",event->block.block_num())("e",e.to_detail_string()) );
+         }
+         catch( const std::exception& e )
+         {
+            elog( "Block event consumer ${c} failed on block ${b}: ${e}",
+                  ("c",metrics.name)("b",event->block.block_num())("e",e.what()) );
+         }
+         {
+            std::lock_guard<std::mutex> guard( mutex );
+            queue.pop_front();
+            if( ok )
+               ++metrics.consumed;
+            else
+               ++metrics.failed;
+         }
+         space_available.notify_all();
+      }
+   }
+
+   /// Queues the event, waits while the queue is full
+   void push( const std::shared_ptr<const block_event>& event )
+   {
+      std::unique_lock<std::mutex> lock( mutex );
+      if( queue.size() >= max_queue_size )
+      {
+         const fc::time_point start = fc::time_point::now();
+         space_available.wait( lock, [this]() { return queue.size() < max_queue_size; } );
+         ++metrics.publisher_waits;
+         metrics.publisher_wait_microseconds += ( fc::time_point::now() - start ).count();
+      }
+      if( stopped )
+         return;
+      queue.push_back( event );
+      if( !scheduled )
+      {
+         scheduled = true;
+         thread->async( [this]() { consume(); }, "block_event_bus::consume" );
+      }
+   }
+
+   /// Waits until the queue is empty, then refuses further events
+   void stop()
+   {
+      std::unique_lock<std::mutex> lock( mutex );
+      space_available.wait( lock, [this]() { return queue.empty(); } );
+      stopped = true;
+   }
+
+   const consumer_type                               callback;
+   const uint32_t                                    max_queue_size;
+   const bool                                        with_objects;
+
+   std::mutex                                        mutex;
+   std::condition_variable                           space_available;
+   std::deque< std::shared_ptr<const block_event> >  queue;
+   bool                                              scheduled = false;
+   bool                                              stopped = false;
+   block_event_consumer_metrics                      metrics;
+
+   std::unique_ptr<fc::thread>                       thread;
+};
+
+block_event_bus::block_event_bus( graphene::chain::database& db ) : _db( db )
+{
+   _applied_block_connection = db.applied_block.connect( [this]( const signed_block& b ) {
+      on_applied_block( b );
+   } );
+   _new_connection = db.new_objects.connect( [this]( const vector<object_id_type>& ids, const auto& ) {
+      on_objects( &block_event::new_objects, ids, nullptr );
+   } );
+   _change_connection = db.changed_objects.connect( [this]( const vector<object_id_type>& ids, const auto& ) {
+      on_objects( &block_event::changed_objects, ids, nullptr );
+   } );
+   _removed_connection = db.removed_objects.connect( [this]( const vector<object_id_type>& ids,
+                                                             const vector<const graphene::db::object*>& objs,
+                                                             const auto& ) {
+      on_objects( &block_event::removed_objects, ids, &objs );
+   } );
+   _finished_connection = db.block_notifications_finished.connect( [this]( const signed_block& ) {
+      on_block_notifications_finished();
+   } );
+}
+
+block_event_bus::~block_event_bus()
+{
+   vector<uint64_t> ids;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      for( const auto& item : _consumers )
+         ids.push_back( item.first );
+   }
+   for( uint64_t id : ids )
+      remove_consumer( id );
+}
+
+uint64_t block_event_bus::add_consumer( const string& name, consumer_type callback, uint32_t max_queue_size,
+                                        bool with_objects )
+{
+   FC_ASSERT( max_queue_size > 0, "The queue of a consumer must hold at least one event" );
+   auto c = std::make_shared<consumer>( name, std::move( callback ), max_queue_size, with_objects );
+   std::lock_guard<std::mutex> guard( _mutex );
+   const uint64_t id = ++_next_consumer_id;
+   _consumers[id] = c;
+   return id;
+}
+
+void block_event_bus::remove_consumer( uint64_t consumer_id )
+{
+   std::shared_ptr<consumer> c;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      auto itr = _consumers.find( consumer_id );
+      if( itr == _consumers.end() )
+         return;
+      c = itr->second;
+      _consumers.erase( itr );
+   }
+   // a publication which is in progress may still hold the consumer
+   c->stop();
+   c->thread->quit();
+}
+
+vector<block_event_consumer_metrics> block_event_bus::get_metrics()const
+{
+   vector< std::shared_ptr<consumer> > consumers;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      for( const auto& item : _consumers )
+         consumers.push_back( item.second );
+   }
+   vector<block_event_consumer_metrics> result;
+   result.reserve( consumers.size() );
+   for( const auto& c : consumers )
+   {
+      std::lock_guard<std::mutex> guard( c->mutex );
+      result.push_back( c->metrics );
+      result.back().queued = static_cast<uint32_t>( c->queue.size() );
+   }
+   return result;
+}
+
+void block_event_bus::on_applied_block( const signed_block& block )
+{
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      if( _consumers.empty() )
+      {
+         _current.reset();
+         return;
+      }
+      _current_with_objects = std::any_of( _consumers.begin(), _consumers.end(), []( const auto& item ) {
+         return item.second->with_objects;
+      } );
+   }
+   // the applied operations are cleared after this notification, so they are copied now
+   _current = std::make_shared<block_event>();
+   _current->block = block;
+   _current->operations = _db.get_applied_operations();
+}
+
+void block_event_bus::on_objects( object_list block_event::* list, const vector<object_id_type>& ids,
+                                  const vector<const graphene::db::object*>* objs )
+{
+   if( !_current || !_current_with_objects )
+      return;
+   object_list& objects = (*_current).*list;
+   objects.reserve( objects.size() + ids.size() );
+   for( size_t i = 0; i < ids.size(); ++i )
+   {
+      // objects which were removed later in the block are only reported as removed
+      const graphene::db::object* obj = ( objs != nullptr ) ? (*objs)[i] : _db.find_object( ids[i] );
+      if( obj != nullptr )
+         objects.emplace_back( obj->clone() );
+   }
+}
+
+void block_event_bus::on_block_notifications_finished()
+{
+   if( !_current )
+      return;
+   std::shared_ptr<const block_event> event = std::move( _current );
+   _current.reset();
+
+   vector< std::shared_ptr<consumer> > consumers;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      for( const auto& item : _consumers )
+         consumers.push_back( item.second );
+   }
+   for( const auto& c : consumers )
+      c->push( event );
+}
+
+} } // graphene::app
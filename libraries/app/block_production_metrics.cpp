@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/block_production_metrics.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+void block_production_metrics::add_record( const block_production_record& record )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   _records.push_front( record );
+   if( _records.size() > max_records )
+      _records.pop_back();
+}
+
+block_production_record* block_production_metrics::find( const protocol::block_id_type& block_id )
+{
+   for( auto& record : _records )
+   {
+      if( record.block_id == block_id )
+         return &record;
+   }
+   return nullptr;
+}
+
+void block_production_metrics::set_broadcast_time( const protocol::block_id_type& block_id,
+                                                   fc::microseconds duration )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   block_production_record* record = find( block_id );
+   if( record != nullptr )
+      record->broadcast_microseconds = duration.count();
+}
+
+void block_production_metrics::set_first_request_time( const protocol::block_id_type& block_id,
+                                                       fc::microseconds delay )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   block_production_record* record = find( block_id );
+   if( record != nullptr )
+      record->first_request_microseconds = std::max<int64_t>( 0, delay.count() );
+}
+
+std::vector<block_production_record> block_production_metrics::get_records()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return std::vector<block_production_record>( _records.begin(), _records.end() );
+}
+
+} } // graphene::app
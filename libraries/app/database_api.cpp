@@ -32,9 +32,12 @@
 
 #include <fc/crypto/hex.hpp>
 #include <fc/rpc/api_connection.hpp>
+#include <fc/thread/parallel.hpp>
 
 #include <boost/range/iterator_range.hpp>
 
+#include <algorithm>
+#include <numeric>
 #include <cctype>
 
 template class fc::api<graphene::app::database_api>;
@@ -87,18 +90,85 @@ database_api_impl::database_api_impl( graphene::chain::database& db, const appli
 
    try
    {
-      asset_in_liquidity_pools_index = &_db.get_index_type< primary_index< liquidity_pool_index > >()
+      call_orders_by_collateral_ratio_index = &_db.get_index_type< primary_index< call_order_index > >()
+            .get_secondary_index<graphene::api_helper_indexes::call_orders_by_collateral_ratio_index>();
+   }
+   catch( const fc::assert_exception& )
+   {
+      call_orders_by_collateral_ratio_index = nullptr;
+   }
+
+   try
+   {
+      asset_in_liquidity_pools_index
+            = &_db.get_index_type< primary_index< liquidity_pool_index, 10, flat_direct_index > >()
             .get_secondary_index<graphene::api_helper_indexes::asset_in_liquidity_pools_index>();
    }
    catch( const fc::assert_exception& )
    {
       asset_in_liquidity_pools_index = nullptr;
    }
+
+   try
+   {
+      credit_offers_by_collateral_index = &_db.get_index_type< primary_index< credit_offer_index > >()
+            .get_secondary_index<graphene::api_helper_indexes::credit_offers_by_collateral_index>();
+   }
+   catch( const fc::assert_exception& )
+   {
+      credit_offers_by_collateral_index = nullptr;
+   }
+
+   try
+   {
+      order_book_versions_index = &_db.get_index_type< primary_index< limit_order_index > >()
+            .get_secondary_index<graphene::api_helper_indexes::order_book_versions_index>();
+   }
+   catch( const fc::assert_exception& )
+   {
+      order_book_versions_index = nullptr;
+   }
+
+   try
+   {
+      account_name_trigram_index = &_db.get_index_type< primary_index< account_index, 20 > >()
+            .get_secondary_index<graphene::api_helper_indexes::name_trigram_index>();
+      asset_symbol_trigram_index = &_db.get_index_type< primary_index< asset_index, 13 > >()
+            .get_secondary_index<graphene::api_helper_indexes::name_trigram_index>();
+   }
+   catch( const fc::assert_exception& )
+   {
+      account_name_trigram_index = nullptr;
+      asset_symbol_trigram_index = nullptr;
+   }
+
+   try
+   {
+      vesting_balances_by_owner_index = &_db.get_index_type< primary_index< vesting_balance_index > >()
+            .get_secondary_index<graphene::api_helper_indexes::vesting_balances_by_owner_index>();
+      htlc_expirations_index = &_db.get_index_type< primary_index< htlc_index > >()
+            .get_secondary_index<graphene::api_helper_indexes::expirations_by_account_index>();
+      withdraw_permission_expirations_index = &_db.get_index_type< primary_index< withdraw_permission_index > >()
+            .get_secondary_index<graphene::api_helper_indexes::expirations_by_account_index>();
+   }
+   catch( const fc::assert_exception& )
+   {
+      vesting_balances_by_owner_index = nullptr;
+      htlc_expirations_index = nullptr;
+      withdraw_permission_expirations_index = nullptr;
+   }
 }
 
 database_api_impl::~database_api_impl()
 {
    dlog("freeing database api ${x}", ("x",int64_t(this)) );
+   unsubscribe_from_accounts();
+   unsubscribe_from_account_operations();
+   if( _app_options && _app_options->order_book_deltas )
+   {
+      for( const auto& item : _order_book_delta_subscriptions )
+         _app_options->order_book_deltas->unsubscribe( item.second );
+   }
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -116,19 +186,98 @@ fc::variants database_api_impl::get_objects( const vector<object_id_type>& ids,
 {
    bool to_subscribe = get_whether_to_subscribe( subscribe );
 
+   const vector<const object*> objects = find_objects( ids );
+
    fc::variants result;
    result.reserve(ids.size());
 
-   std::transform(ids.begin(), ids.end(), std::back_inserter(result),
-                  [this,to_subscribe](object_id_type id) -> fc::variant {
-      if(auto obj = _db.find_object(id))
+   for( size_t i = 0; i < ids.size(); ++i )
+   {
+      const object_id_type id = ids[i];
+      if( objects[i] != nullptr )
       {
          if( to_subscribe && !id.is<operation_history_id_type>() && !id.is<account_transaction_history_id_type>() )
             this->subscribe_to_item( id );
-         return obj->to_variant();
+         result.push_back( objects[i]->to_variant() );
       }
-      return {};
+      else
+         result.emplace_back();
+   }
+
+   return result;
+}
+
+fc::variants database_api::get_object_fields( const vector<object_id_type>& ids,
+                                              const flat_set<string>& fields )const
+{
+   return my->run_read_only( "get_object_fields", [this,&ids,&fields]() {
+      return my->get_object_fields( ids, fields );
    });
+}
+
+fc::variants database_api_impl::get_object_fields( const vector<object_id_type>& ids,
+                                                   const flat_set<string>& fields )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_get_object_fields;
+   FC_ASSERT( ids.size() <= configured_limit,
+              "Number of querying objects can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   const vector<const object*> objects = find_objects( ids );
+
+   fc::variants result;
+   result.reserve(ids.size());
+
+   for( const object* obj : objects )
+   {
+      if( obj == nullptr )
+      {
+         result.emplace_back();
+         continue;
+      }
+      fc::variant full = obj->to_variant();
+      if( fields.empty() || !full.is_object() )
+      {
+         result.push_back( std::move( full ) );
+         continue;
+      }
+      const fc::variant_object& vo = full.get_object();
+      fc::mutable_variant_object selected;
+      for( const string& field : fields )
+      {
+         auto itr = vo.find( field );
+         if( itr != vo.end() )
+            selected( field, itr->value() );
+      }
+      result.push_back( fc::variant( std::move( selected ) ) );
+   }
+
+   return result;
+}
+
+vector<const object*> database_api_impl::find_objects( const vector<object_id_type>& ids )const
+{
+   vector<const object*> result( ids.size(), nullptr );
+
+   vector<size_t> order( ids.size() );
+   std::iota( order.begin(), order.end(), 0 );
+   std::sort( order.begin(), order.end(), [&ids]( size_t a, size_t b ) { return ids[a] < ids[b]; } );
+
+   const graphene::db::index* idx = nullptr;
+   uint8_t space_id = 0;
+   uint8_t type_id = 0;
+   for( size_t i : order )
+   {
+      const object_id_type id = ids[i];
+      if( idx == nullptr || id.space() != space_id || id.type() != type_id )
+      {
+         space_id = id.space();
+         type_id = id.type();
+         idx = &_db.get_index( space_id, type_id );
+      }
+      result[i] = idx->find( id );
+   }
 
    return result;
 }
@@ -188,6 +337,51 @@ void database_api_impl::set_block_applied_callback( std::function<void(const var
    _block_applied_callback = cb;
 }
 
+void database_api::subscribe_to_account_operations( std::function<void(const variant&)> callback,
+                                                    const vector<std::string>& account_names_or_ids )
+{
+   my->subscribe_to_account_operations( callback, account_names_or_ids );
+}
+
+void database_api_impl::subscribe_to_account_operations( std::function<void(const variant&)> callback,
+                                                         const vector<std::string>& account_names_or_ids )
+{
+   FC_ASSERT( _app_options && _app_options->account_operations, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_subscribe_to_account_operations;
+   FC_ASSERT( !account_names_or_ids.empty() && account_names_or_ids.size() <= configured_limit,
+              "Number of accounts must be positive and can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   std::set<account_id_type> accounts;
+   for( const std::string& account_name_or_id : account_names_or_ids )
+      accounts.insert( get_account_from_string( account_name_or_id )->get_id() );
+
+   unsubscribe_from_account_operations();
+
+   // the publisher is shared by all sessions, it must not keep this one alive
+   std::weak_ptr<database_api_impl> weak_this = shared_from_this();
+   _account_operations_subscription = _app_options->account_operations->subscribe( accounts,
+         [weak_this,callback]( const variant& ops ) {
+            auto capture_this = weak_this.lock();
+            if( capture_this && capture_this->_account_operations_subscription.valid() )
+               callback( ops );
+         } );
+}
+
+void database_api::unsubscribe_from_account_operations()
+{
+   my->unsubscribe_from_account_operations();
+}
+
+void database_api_impl::unsubscribe_from_account_operations()
+{
+   if( !_account_operations_subscription.valid() )
+      return;
+   if( _app_options && _app_options->account_operations )
+      _app_options->account_operations->unsubscribe( *_account_operations_subscription );
+   _account_operations_subscription.reset();
+}
+
 void database_api::cancel_all_subscriptions()
 {
    my->cancel_all_subscriptions(true, true);
@@ -199,10 +393,19 @@ void database_api_impl::cancel_all_subscriptions( bool reset_callback, bool rese
       _subscribe_callback = std::function<void(const fc::variant&)>();
 
    if ( reset_market_subscriptions )
+   {
       _market_subscriptions.clear();
+      if( _app_options && _app_options->order_book_deltas )
+      {
+         for( const auto& item : _order_book_delta_subscriptions )
+            _app_options->order_book_deltas->unsubscribe( item.second );
+      }
+      _order_book_delta_subscriptions.clear();
+   }
 
    _notify_remove_create = false;
-   _subscribed_accounts.clear();
+   unsubscribe_from_accounts();
+   unsubscribe_from_account_operations();
    static fc::bloom_parameters param(10000, 1.0/100, 1024*8*8*2);
    _subscribe_filter = fc::bloom_filter(param);
 }
@@ -243,7 +446,12 @@ map<uint32_t, optional<block_header>> database_api_impl::get_block_header_batch(
 
 optional<signed_block> database_api::get_block(uint32_t block_num)const
 {
-   return my->get_block( block_num );
+   // irreversible blocks never change
+   if( block_num > my->_db.get_dynamic_global_properties().last_irreversible_block_num )
+      return my->get_block( block_num );
+   return my->get_cached_immutable<optional<signed_block>>( "get_block", { block_num }, [this,block_num]() {
+      return my->get_block( block_num );
+   } );
 }
 
 optional<signed_block> database_api_impl::get_block(uint32_t block_num)const
@@ -301,7 +509,7 @@ global_property_object database_api_impl::get_global_properties()const
 
 fc::variant_object database_api::get_config()const
 {
-   return my->get_config();
+   return my->get_cached<fc::variant_object>( "get_config", {}, [this]() { return my->get_config(); } );
 }
 
 fc::variant_object database_api_impl::get_config()const
@@ -321,7 +529,9 @@ chain_id_type database_api_impl::get_chain_id()const
 
 dynamic_global_property_object database_api::get_dynamic_global_properties()const
 {
-   return my->get_dynamic_global_properties();
+   return my->get_cached<dynamic_global_property_object>( "get_dynamic_global_properties", {}, [this]() {
+      return my->get_dynamic_global_properties();
+   } );
 }
 
 dynamic_global_property_object database_api_impl::get_dynamic_global_properties()const
@@ -329,6 +539,39 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
    return _db.get(dynamic_global_property_id_type());
 }
 
+head_state database_api::get_head_state()const
+{
+   return *my->_db.get_head_state();
+}
+
+vector<graphene::db::index_memory_usage> database_api::get_index_memory_usage()const
+{
+   return my->get_index_memory_usage();
+}
+
+vector<graphene::db::index_memory_usage> database_api_impl::get_index_memory_usage()const
+{
+   return _db.get_memory_usage();
+}
+
+vector<maintenance_profile> database_api::get_maintenance_profiles()const
+{
+   return my->get_maintenance_profiles();
+}
+
+vector<api_method_metrics> database_api::get_api_read_metrics()const
+{
+   if( nullptr == my->_app_options || !my->_app_options->api_read_metrics )
+      return {};
+   return my->_app_options->api_read_metrics->get_metrics();
+}
+
+vector<maintenance_profile> database_api_impl::get_maintenance_profiles()const
+{
+   const auto& profiles = _db.get_maintenance_profiles();
+   return vector<maintenance_profile>( profiles.begin(), profiles.end() );
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Keys                                                             //
@@ -357,19 +600,21 @@ vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<
    const auto& idx = _db.get_index_type<account_index>();
    const auto& aidx = dynamic_cast<const base_primary_index&>(idx);
    const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
+   check_populated( refs );
 
-   vector< flat_set<account_id_type> > final_result;
-   final_result.reserve(keys.size());
+   vector< flat_set<account_id_type> > final_result( keys.size() );
+   refs.account_to_key_memberships.get_accounts( keys, final_result );
 
-   for( auto& key : keys )
+   for( size_t i = 0; i < keys.size(); ++i )
    {
+      const public_key_type& key = keys[i];
       address a1( pts_address(key, false, 56) );
       address a2( pts_address(key, true, 56) );
       address a3( pts_address(key, false, 0)  );
       address a4( pts_address(key, true, 0)  );
       address a5( key );
 
-      flat_set<account_id_type> result;
+      flat_set<account_id_type>& result = final_result[i];
 
       for( auto& a : {a1,a2,a3,a4,a5} )
       {
@@ -383,14 +628,6 @@ vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<
              }
           }
       }
-
-      auto itr = refs.account_to_key_memberships.find(key);
-      if( itr != refs.account_to_key_memberships.end() )
-      {
-         result.reserve( result.size() + itr->second.size() );
-         for( auto item : itr->second ) result.insert(item);
-      }
-      final_result.emplace_back( std::move(result) );
    }
 
    return final_result;
@@ -424,10 +661,8 @@ bool database_api_impl::is_public_key_registered(string public_key) const
     const auto& idx = _db.get_index_type<account_index>();
     const auto& aidx = dynamic_cast<const base_primary_index&>(idx);
     const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
-    auto itr = refs.account_to_key_memberships.find(key);
-    bool is_known = itr != refs.account_to_key_memberships.end();
-
-    return is_known;
+    check_populated( refs );
+    return refs.account_to_key_memberships.contains(key);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -468,7 +703,12 @@ vector<optional<account_object>> database_api_impl::get_accounts( const vector<s
 std::map<string,full_account> database_api::get_full_accounts( const vector<string>& names_or_ids,
                                                                optional<bool> subscribe )
 {
-   return my->get_full_accounts( names_or_ids, subscribe );
+   // subscriptions modify the session, so only calls which do not subscribe may run concurrently
+   if( my->get_whether_to_subscribe( subscribe ) )
+      return my->get_full_accounts( names_or_ids, subscribe );
+   return my->run_read_only( "get_full_accounts", [this,&names_or_ids]() {
+      return my->get_full_accounts( names_or_ids, false );
+   } );
 }
 
 vector<account_statistics_object> database_api::get_top_voters(uint32_t limit)const
@@ -498,48 +738,29 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
       if( to_subscribe )
       {
          if(_subscribed_accounts.size() < 100) {
-            _subscribed_accounts.insert( account->get_id() );
+            subscribe_to_account( account->get_id() );
             subscribe_to_item( account->id );
          }
       }
 
       full_account acnt;
-      acnt.account = *account;
-      acnt.statistics = account->statistics(_db);
-      acnt.registrar_name = account->registrar(_db).name;
-      acnt.referrer_name = account->referrer(_db).name;
-      acnt.lifetime_referrer_name = account->lifetime_referrer(_db).name;
-      acnt.votes = lookup_vote_ids( vector<vote_id_type>( account->options.votes.begin(),
-                                                          account->options.votes.end() ) );
-
-      if (account->cashback_vb)
-      {
-         acnt.cashback_balance = account->cashback_balance(_db);
-      }
+      fill_full_account_header( *account, acnt );
 
       size_t api_limit_get_full_accounts_lists = static_cast<size_t>(
                 _app_options->api_limit_get_full_accounts_lists );
 
       // Add the account's proposals (if the data is available)
-      if( _app_options && _app_options->has_api_helper_indexes_plugin )
+      if( can_get_proposals_by_approver() )
       {
-         const auto& proposal_idx = _db.get_index_type< primary_index< proposal_index > >();
-         const auto& proposals_by_account = proposal_idx.get_secondary_index<
-                                                  graphene::chain::required_approval_index>();
-
-         auto required_approvals_itr = proposals_by_account._account_to_proposals.find( account->id );
-         if( required_approvals_itr != proposals_by_account._account_to_proposals.end() )
+         const auto proposal_ids = get_proposals_by_approver( account->id );
+         acnt.proposals.reserve( std::min( proposal_ids.size(), api_limit_get_full_accounts_lists ) );
+         for( auto proposal_id : proposal_ids )
          {
-            acnt.proposals.reserve( std::min(required_approvals_itr->second.size(),
-                                             api_limit_get_full_accounts_lists) );
-            for( auto proposal_id : required_approvals_itr->second )
-            {
-               if(acnt.proposals.size() >= api_limit_get_full_accounts_lists) {
-                  acnt.more_data_available.proposals = true;
-                  break;
-               }
-               acnt.proposals.push_back(proposal_id(_db));
+            if(acnt.proposals.size() >= api_limit_get_full_accounts_lists) {
+               acnt.more_data_available.proposals = true;
+               break;
             }
+            acnt.proposals.push_back(proposal_id(_db));
          }
       }
 
@@ -655,6 +876,226 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
    return results;
 }
 
+void database_api_impl::fill_full_account_header( const account_object& account, full_account& acnt )const
+{
+   acnt.account = account;
+   acnt.statistics = account.statistics(_db);
+   acnt.registrar_name = account.registrar(_db).name;
+   acnt.referrer_name = account.referrer(_db).name;
+   acnt.lifetime_referrer_name = account.lifetime_referrer(_db).name;
+   acnt.votes = lookup_vote_ids( vector<vote_id_type>( account.options.votes.begin(),
+                                                       account.options.votes.end() ) );
+
+   if (account.cashback_vb)
+   {
+      acnt.cashback_balance = account.cashback_balance(_db);
+   }
+
+   if( vesting_balances_by_owner_index && vesting_balances_by_owner_index->is_populated() )
+   {
+      const auto& totals = vesting_balances_by_owner_index->get_totals( account.get_id() );
+      acnt.vesting_balance_totals.reserve( totals.size() );
+      for( const auto& total : totals )
+         acnt.vesting_balance_totals.emplace_back( total.second, total.first );
+   }
+}
+
+bool database_api_impl::can_get_proposals_by_approver()const
+{
+   if( !_app_options || !_app_options->has_api_helper_indexes_plugin )
+      return false;
+   const auto& aidx = dynamic_cast<const base_primary_index&>( _db.get_index_type<account_index>() );
+   return _db.get_index_type< primary_index< proposal_index > >()
+             .get_secondary_index< graphene::chain::required_approval_index >().is_populated()
+          && aidx.get_secondary_index<graphene::chain::account_member_index>().is_populated();
+}
+
+void database_api_impl::check_populated( const secondary_index& idx )
+{
+   FC_ASSERT( idx.is_populated(),
+              "The helper index needed by this call is still warming up on this server, please try again later." );
+}
+
+set<proposal_id_type> database_api_impl::get_proposals_by_approver( account_id_type account )const
+{
+   const auto& proposals_by_account = _db.get_index_type< primary_index< proposal_index > >()
+                                         .get_secondary_index< graphene::chain::required_approval_index >();
+   const auto& aidx = dynamic_cast<const base_primary_index&>( _db.get_index_type<account_index>() );
+   const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
+   check_populated( proposals_by_account );
+   check_populated( refs );
+   const uint8_t max_depth = _db.get_global_properties().parameters.max_authority_depth;
+
+   // The account can approve the proposals of the accounts whose authorities contain it, directly or through
+   // nested authorities, so walk up the memberships level by level
+   set<proposal_id_type> result;
+   flat_set<account_id_type> visited { account };
+   vector<account_id_type> current { account };
+   for( uint8_t depth = 0; !current.empty(); ++depth )
+   {
+      vector<account_id_type> next;
+      for( const account_id_type& a : current )
+      {
+         auto approvals_itr = proposals_by_account._account_to_proposals.find( a );
+         if( approvals_itr != proposals_by_account._account_to_proposals.end() )
+            result.insert( approvals_itr->second.begin(), approvals_itr->second.end() );
+         if( depth >= max_depth )
+            continue;
+         auto refs_itr = refs.account_to_account_memberships.find( a );
+         if( refs_itr == refs.account_to_account_memberships.end() )
+            continue;
+         for( const account_id_type& parent : refs_itr->second )
+         {
+            if( visited.insert( parent ).second )
+               next.push_back( parent );
+         }
+      }
+      current = std::move( next );
+   }
+   return result;
+}
+
+full_account_page database_api::get_full_account_page( const std::string& account_name_or_id,
+                                                       const full_account_query& query )const
+{
+   return my->run_read_only( "get_full_account_page", [this,&account_name_or_id,&query]() {
+      return my->get_full_account_page( account_name_or_id, query );
+   } );
+}
+
+full_account_page database_api_impl::get_full_account_page( const std::string& account_name_or_id,
+                                                            const full_account_query& query )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_get_full_accounts_lists;
+   FC_ASSERT( query.limit > 0 && query.limit <= configured_limit,
+              "limit must be positive and can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   static const std::set<string> known_sections = { "balances", "vesting_balances", "limit_orders", "call_orders",
+                                                    "settle_orders", "proposals", "assets", "withdraws_from",
+                                                    "withdraws_to", "htlcs_from", "htlcs_to" };
+   for( const auto& section : query.sections )
+      FC_ASSERT( known_sections.count( section.first ) > 0, "Unknown section ${s}", ("s", section.first) );
+
+   const account_object* account = get_account_from_string( account_name_or_id );
+   const account_id_type account_id = account->get_id();
+
+   full_account_page result;
+   fill_full_account_header( *account, result.account );
+
+   const uint32_t limit = query.limit;
+   // Copies the entries of [itr, end) until the limit is reached, then notes where the next page starts
+   auto add_page = [&result,limit]( const char* section, auto itr, auto end, auto& out,
+                                    auto position_of, auto value_of ) {
+      for( ; itr != end; ++itr )
+      {
+         if( out.size() >= limit )
+         {
+            result.next_start[section] = position_of( *itr );
+            return;
+         }
+         out.emplace_back( value_of( *itr ) );
+      }
+   };
+   auto get_start = [&query]( const char* section ) {
+      auto itr = query.sections.find( section );
+      return itr == query.sections.end() ? nullptr : &itr->second;
+   };
+   auto id_of = []( const auto& o ) { return object_id_type( o.id ); };
+   auto copy_of = []( const auto& o ) -> const auto& { return o; };
+   // For the indexes which are sorted by account, then by object ID
+   auto add_page_by_id = [&]( const char* section, const auto& idx, auto& out, auto value_of ) {
+      const auto* start = get_start( section );
+      if( start == nullptr )
+         return;
+      auto range = idx.equal_range( account_id );
+      auto itr = start->valid() ? idx.lower_bound( boost::make_tuple( account_id, **start ) ) : range.first;
+      add_page( section, itr, range.second, out, id_of, value_of );
+   };
+
+   // The balances are sorted by asset type, which is their position
+   if( const auto* start = get_start( "balances" ) )
+   {
+      const auto& balances = _db.get_index_type< primary_index< account_balance_index > >().
+            get_secondary_index< balances_by_account_index >().get_account_balances( account_id );
+      auto itr = start->valid() ? balances.lower_bound( asset_id_type( **start ) ) : balances.begin();
+      add_page( "balances", itr, balances.end(), result.account.balances,
+                []( const auto& item ) { return object_id_type( item.first ); },
+                []( const auto& item ) -> const account_balance_object& { return *item.second; } );
+   }
+
+   // The vesting balances of an account are not sorted by ID in the index of the chain, an account does not have
+   // many of them, so they are sorted here if the api_helper_indexes plugin is not enabled
+   if( const auto* start = get_start( "vesting_balances" ) )
+   {
+      if( vesting_balances_by_owner_index && vesting_balances_by_owner_index->is_populated() )
+      {
+         const auto& balance_ids = vesting_balances_by_owner_index->get_vesting_balances( account_id );
+         auto itr = start->valid() ? balance_ids.lower_bound( vesting_balance_id_type( **start ) )
+                                   : balance_ids.begin();
+         add_page( "vesting_balances", itr, balance_ids.end(), result.account.vesting_balances,
+                   []( const vesting_balance_id_type& id ) { return object_id_type( id ); },
+                   [this]( const vesting_balance_id_type& id ) -> const vesting_balance_object& {
+                      return id(_db);
+                   } );
+      }
+      else
+      {
+         auto vesting_range = _db.get_index_type<vesting_balance_index>().indices().get<by_account>()
+                                 .equal_range( account_id );
+         std::map< object_id_type, const vesting_balance_object* > vesting_balances;
+         for( auto itr = vesting_range.first; itr != vesting_range.second; ++itr )
+            vesting_balances[ itr->id ] = &(*itr);
+         auto itr = start->valid() ? vesting_balances.lower_bound( **start ) : vesting_balances.begin();
+         add_page( "vesting_balances", itr, vesting_balances.end(), result.account.vesting_balances,
+                   []( const auto& item ) { return item.first; },
+                   []( const auto& item ) -> const vesting_balance_object& { return *item.second; } );
+      }
+   }
+
+   add_page_by_id( "limit_orders", _db.get_index_type<limit_order_index>().indices().get<by_account>(),
+                   result.account.limit_orders, copy_of );
+
+   // The call orders of an account are sorted by debt asset, which is their position
+   if( const auto* start = get_start( "call_orders" ) )
+   {
+      const auto& idx = _db.get_index_type<call_order_index>().indices().get<by_account>();
+      auto range = idx.equal_range( account_id );
+      auto itr = start->valid() ? idx.lower_bound( boost::make_tuple( account_id, asset_id_type( **start ) ) )
+                                : range.first;
+      add_page( "call_orders", itr, range.second, result.account.call_orders,
+                []( const call_order_object& o ) { return object_id_type( o.debt_type() ); }, copy_of );
+   }
+
+   add_page_by_id( "settle_orders", _db.get_index_type<force_settlement_index>().indices().get<by_account>(),
+                   result.account.settle_orders, copy_of );
+
+   if( const auto* start = get_start( "proposals" ) )
+   {
+      FC_ASSERT( _app_options->has_api_helper_indexes_plugin,
+                 "api_helper_indexes plugin is not enabled on this server." );
+      const auto proposal_ids = get_proposals_by_approver( account_id );
+      auto itr = start->valid() ? proposal_ids.lower_bound( proposal_id_type( **start ) ) : proposal_ids.begin();
+      add_page( "proposals", itr, proposal_ids.end(), result.account.proposals,
+                []( const proposal_id_type& id ) { return object_id_type( id ); },
+                [this]( const proposal_id_type& id ) -> const proposal_object& { return id(_db); } );
+   }
+
+   add_page_by_id( "assets", _db.get_index_type<asset_index>().indices().get<by_issuer>(),
+                   result.account.assets, []( const asset_object& a ) { return a.get_id(); } );
+
+   const auto& withdraw_indices = _db.get_index_type<withdraw_permission_index>().indices();
+   add_page_by_id( "withdraws_from", withdraw_indices.get<by_from>(), result.account.withdraws_from, copy_of );
+   add_page_by_id( "withdraws_to", withdraw_indices.get<by_authorized>(), result.account.withdraws_to, copy_of );
+
+   const auto& htlc_indices = _db.get_index_type<htlc_index>().indices();
+   add_page_by_id( "htlcs_from", htlc_indices.get<by_from_id>(), result.account.htlcs_from, copy_of );
+   add_page_by_id( "htlcs_to", htlc_indices.get<by_to_id>(), result.account.htlcs_to, copy_of );
+
+   return result;
+}
+
 vector<account_statistics_object> database_api_impl::get_top_voters(uint32_t limit)const
 {
    FC_ASSERT( _app_options, "Internal error" );
@@ -704,6 +1145,7 @@ vector<account_id_type> database_api_impl::get_account_references( const std::st
    const auto& idx = _db.get_index_type<account_index>();
    const auto& aidx = dynamic_cast<const base_primary_index&>(idx);
    const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
+   check_populated( refs );
    const account_id_type account_id = get_account_from_string(account_id_or_name)->id;
    auto itr = refs.account_to_account_memberships.find(account_id);
    vector<account_id_type> result;
@@ -762,6 +1204,56 @@ map<string,account_id_type> database_api_impl::lookup_accounts( const string& lo
    return result;
 }
 
+map<string,account_id_type> database_api::search_accounts( const string& text, uint32_t limit,
+                                                           optional<bool> match_substrings )const
+{
+   return my->run_read_only( "search_accounts", [this,&text,limit,&match_substrings]() {
+      return my->search_accounts( text, limit, match_substrings );
+   } );
+}
+
+map<string,account_id_type> database_api_impl::search_accounts( const string& text, uint32_t limit,
+                                                                optional<bool> match_substrings )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_lookup_accounts;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   // account names are in lower case
+   string name = text;
+   std::transform( name.begin(), name.end(), name.begin(), []( unsigned char c ) { return std::tolower( c ); } );
+
+   map<string,account_id_type> result;
+   if( limit == 0 )
+      return result;
+
+   if( match_substrings.valid() && *match_substrings )
+   {
+      FC_ASSERT( account_name_trigram_index, "api_helper_indexes plugin is not enabled on this server." );
+      check_populated( *account_name_trigram_index );
+      FC_ASSERT( name.size() >= graphene::api_helper_indexes::name_trigram_index::min_search_length,
+                 "The text to search for must have at least ${n} characters",
+                 ("n", graphene::api_helper_indexes::name_trigram_index::min_search_length) );
+      const auto get_name = [this]( uint64_t instance ) -> const string& {
+         return account_id_type( instance )( _db ).name;
+      };
+      for( uint64_t instance : account_name_trigram_index->find( name, limit, get_name ) )
+         result.emplace( account_id_type( instance )( _db ).name, account_id_type( instance ) );
+      return result;
+   }
+
+   const auto& accounts_by_name = _db.get_index_type<account_index>().indices().get<by_name>();
+   for( auto itr = accounts_by_name.lower_bound( name );
+        limit > 0 && itr != accounts_by_name.end() && 0 == itr->name.compare( 0, name.size(), name );
+        ++itr, --limit )
+   {
+      result.emplace( itr->name, itr->get_id() );
+   }
+   return result;
+}
+
 uint64_t database_api::get_account_count()const
 {
    return my->get_account_count();
@@ -884,6 +1376,33 @@ vector<vesting_balance_object> database_api_impl::get_vesting_balances( const st
    FC_CAPTURE_AND_RETHROW( (account_id_or_name) );
 }
 
+vector<optional<asset>> database_api::get_vesting_balance_withdrawals(
+      const vector<vesting_balance_id_type>& ids )const
+{
+   return my->get_vesting_balance_withdrawals( ids );
+}
+
+vector<optional<asset>> database_api_impl::get_vesting_balance_withdrawals(
+      const vector<vesting_balance_id_type>& ids )const
+{
+   try
+   {
+      vector<optional<asset>> result;
+      result.reserve( ids.size() );
+      const auto now = _db.head_block_time();
+      for( const auto& id : ids )
+      {
+         const vesting_balance_object* vbo = _db.find( id );
+         if( vbo != nullptr )
+            result.emplace_back( vbo->get_allowed_withdraw( now ) );
+         else
+            result.emplace_back();
+      }
+      return result;
+   }
+   FC_CAPTURE_AND_RETHROW( (ids) );
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Assets                                                           //
@@ -923,7 +1442,9 @@ vector<optional<extended_asset_object>> database_api_impl::get_assets(
 
 vector<extended_asset_object> database_api::list_assets(const string& lower_bound_symbol, uint32_t limit)const
 {
-   return my->list_assets( lower_bound_symbol, limit );
+   return my->run_read_only( "list_assets", [this,&lower_bound_symbol,limit]() {
+      return my->list_assets( lower_bound_symbol, limit );
+   } );
 }
 
 vector<extended_asset_object> database_api_impl::list_assets(const string& lower_bound_symbol, uint32_t limit)const
@@ -946,6 +1467,55 @@ vector<extended_asset_object> database_api_impl::list_assets(const string& lower
    return result;
 }
 
+vector<extended_asset_object> database_api::search_assets( const string& text, uint32_t limit,
+                                                           optional<bool> match_substrings )const
+{
+   return my->run_read_only( "search_assets", [this,&text,limit,&match_substrings]() {
+      return my->search_assets( text, limit, match_substrings );
+   } );
+}
+
+vector<extended_asset_object> database_api_impl::search_assets( const string& text, uint32_t limit,
+                                                                optional<bool> match_substrings )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_get_assets;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   // asset symbols are in upper case
+   string symbol = text;
+   std::transform( symbol.begin(), symbol.end(), symbol.begin(), []( unsigned char c ) { return std::toupper( c ); } );
+
+   vector<extended_asset_object> result;
+   if( match_substrings.valid() && *match_substrings )
+   {
+      FC_ASSERT( asset_symbol_trigram_index, "api_helper_indexes plugin is not enabled on this server." );
+      check_populated( *asset_symbol_trigram_index );
+      FC_ASSERT( symbol.size() >= graphene::api_helper_indexes::name_trigram_index::min_search_length,
+                 "The text to search for must have at least ${n} characters",
+                 ("n", graphene::api_helper_indexes::name_trigram_index::min_search_length) );
+      const auto get_symbol = [this]( uint64_t instance ) -> const string& {
+         return asset_id_type( instance )( _db ).symbol;
+      };
+      const auto instances = asset_symbol_trigram_index->find( symbol, limit, get_symbol );
+      result.reserve( instances.size() );
+      for( uint64_t instance : instances )
+         result.emplace_back( extend_asset( asset_id_type( instance )( _db ) ) );
+      return result;
+   }
+
+   const auto& assets_by_symbol = _db.get_index_type<asset_index>().indices().get<by_symbol>();
+   for( auto itr = assets_by_symbol.lower_bound( symbol );
+        limit > 0 && itr != assets_by_symbol.end() && 0 == itr->symbol.compare( 0, symbol.size(), symbol );
+        ++itr, --limit )
+   {
+      result.emplace_back( extend_asset( *itr ) );
+   }
+   return result;
+}
+
 uint64_t database_api::get_asset_count()const
 {
    return my->get_asset_count();
@@ -1099,8 +1669,8 @@ vector<limit_order_object> database_api_impl::get_account_limit_orders(
    }
 
    const auto& index_by_account = _db.get_index_type<limit_order_index>().indices().get<by_account_price>();
-   limit_order_multi_index_type::index<by_account_price>::type::const_iterator lower_itr;
-   limit_order_multi_index_type::index<by_account_price>::type::const_iterator upper_itr;
+   limit_order_index::index_type::index<by_account_price>::type::const_iterator lower_itr;
+   limit_order_index::index_type::index<by_account_price>::type::const_iterator upper_itr;
 
    // if both order_id and price are invalid, query the first page
    if ( !ostart_id.valid() && !ostart_price.valid() )
@@ -1295,6 +1865,85 @@ vector<call_order_object> database_api_impl::get_margin_positions( const std::st
    } FC_CAPTURE_AND_RETHROW( (account_id_or_name) )
 }
 
+margin_call_risk database_api::get_margin_call_risk( const std::string& asset_symbol_or_id,
+                                                    const optional<price>& settlement_price,
+                                                    const optional<uint32_t>& limit )const
+{
+   return my->get_margin_call_risk( asset_symbol_or_id, settlement_price, limit );
+}
+
+margin_call_risk database_api_impl::get_margin_call_risk( const std::string& asset_symbol_or_id,
+                                                         const optional<price>& settlement_price,
+                                                         const optional<uint32_t>& olimit )const
+{ try {
+   // api_helper_indexes plugin is required for accessing the secondary index
+   FC_ASSERT( _app_options && _app_options->has_api_helper_indexes_plugin,
+              "api_helper_indexes plugin is not enabled on this server." );
+
+   uint64_t limit = olimit.valid() ? *olimit : application_options::get_default().api_limit_get_call_orders;
+   const auto configured_limit = _app_options->api_limit_get_call_orders;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   const asset_object* mia = get_asset_from_string( asset_symbol_or_id );
+   FC_ASSERT( mia->is_market_issued(), "The asset is not a market-issued asset" );
+   const asset_bitasset_data_object& bitasset = mia->bitasset_data( _db );
+   const asset_id_type backing_asset = bitasset.options.short_backing_asset;
+
+   FC_ASSERT( call_orders_by_collateral_ratio_index, "Internal error" );
+   check_populated( *call_orders_by_collateral_ratio_index );
+
+   margin_call_risk result;
+   if( settlement_price.valid() )
+   {
+      FC_ASSERT( settlement_price->base.asset_id == mia->get_id() && settlement_price->quote.asset_id == backing_asset,
+                 "The settlement price must be expressed in the asset per its backing asset" );
+      settlement_price->validate();
+      price_feed feed = bitasset.current_feed;
+      feed.settlement_price = *settlement_price;
+      result.settlement_price = feed.settlement_price;
+      result.maintenance_collateralization = feed.maintenance_collateralization();
+   }
+   else
+   {
+      result.settlement_price = bitasset.current_feed.settlement_price;
+      result.maintenance_collateralization = bitasset.current_maintenance_collateralization;
+   }
+   // Without a feed no position is margin called
+   if( result.maintenance_collateralization.is_null() )
+      return result;
+
+   // The by_collateral index sorts the positions of the MPA by collateral ratio, the least collateralized first
+   const auto& call_index = _db.get_index_type<call_order_index>().indices().get<by_collateral>();
+   const auto call_begin = call_index.lower_bound( price::min( backing_asset, mia->get_id() ) );
+   const auto call_end = call_index.upper_bound( result.maintenance_collateralization );
+
+   result.positions.reserve( limit );
+   for( auto itr = call_begin; itr != call_end && result.positions.size() < limit; ++itr )
+      result.positions.push_back( *itr );
+
+   // Sum up the buckets below the one of the threshold, then the called positions in that bucket
+   using bucket_index = graphene::api_helper_indexes::call_orders_by_collateral_ratio_index;
+   const int32_t threshold_bucket = bucket_index::get_bucket( result.maintenance_collateralization.base.amount,
+                                                              result.maintenance_collateralization.quote.amount );
+   const auto totals = call_orders_by_collateral_ratio_index->get_totals_below( mia->get_id(), threshold_bucket );
+   result.position_count = totals.count;
+   result.total_debt = totals.debt;
+   result.total_collateral = totals.collateral;
+   for( auto itr = call_end; itr != call_begin; )
+   {
+      --itr;
+      if( bucket_index::get_bucket( itr->collateral, itr->debt ) < threshold_bucket )
+         break;
+      ++result.position_count;
+      result.total_debt += itr->debt;
+      result.total_collateral += itr->collateral;
+   }
+
+   return result;
+} FC_CAPTURE_AND_RETHROW( (asset_symbol_or_id)(settlement_price)(olimit) ) }
+
 vector<collateral_bid_object> database_api::get_collateral_bids( const std::string& asset,
                                                                  uint32_t limit, uint32_t start )const
 {
@@ -1357,9 +2006,69 @@ void database_api_impl::unsubscribe_from_market(const std::string& a, const std:
    _market_subscriptions.erase(std::make_pair(asset_a_id,asset_b_id));
 }
 
+void database_api::subscribe_to_order_book_deltas( std::function<void(const variant&)> callback,
+                                                   const std::string& base, const std::string& quote,
+                                                   uint32_t depth )
+{
+   my->subscribe_to_order_book_deltas( callback, base, quote, depth );
+}
+
+void database_api_impl::subscribe_to_order_book_deltas( std::function<void(const variant&)> callback,
+                                                        const std::string& base, const std::string& quote,
+                                                        uint32_t depth )
+{
+   FC_ASSERT( _app_options && _app_options->order_book_deltas, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_get_order_book;
+   FC_ASSERT( depth > 0 && depth <= configured_limit,
+              "depth must be positive and can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   auto base_id = get_asset_from_string(base)->id;
+   auto quote_id = get_asset_from_string(quote)->id;
+   FC_ASSERT( base_id != quote_id );
+
+   const auto market = std::make_pair( base_id, quote_id );
+   auto itr = _order_book_delta_subscriptions.find( market );
+   if( itr != _order_book_delta_subscriptions.end() )
+   {
+      _app_options->order_book_deltas->unsubscribe( itr->second );
+      _order_book_delta_subscriptions.erase( itr );
+   }
+
+   // the publisher is shared by all sessions, it must not keep this one alive
+   std::weak_ptr<database_api_impl> weak_this = shared_from_this();
+   auto id = _app_options->order_book_deltas->subscribe( base_id, quote_id, depth,
+         [weak_this,market,callback]( const variant& delta ) {
+            auto capture_this = weak_this.lock();
+            if( capture_this && capture_this->_order_book_delta_subscriptions.count( market ) > 0 )
+               callback( delta );
+         } );
+   _order_book_delta_subscriptions[ market ] = id;
+}
+
+void database_api::unsubscribe_from_order_book_deltas( const std::string& base, const std::string& quote )
+{
+   my->unsubscribe_from_order_book_deltas( base, quote );
+}
+
+void database_api_impl::unsubscribe_from_order_book_deltas( const std::string& base, const std::string& quote )
+{
+   auto base_id = get_asset_from_string(base)->id;
+   auto quote_id = get_asset_from_string(quote)->id;
+
+   auto itr = _order_book_delta_subscriptions.find( std::make_pair( base_id, quote_id ) );
+   if( itr == _order_book_delta_subscriptions.end() )
+      return;
+   if( _app_options && _app_options->order_book_deltas )
+      _app_options->order_book_deltas->unsubscribe( itr->second );
+   _order_book_delta_subscriptions.erase( itr );
+}
+
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
 {
-    return my->get_ticker( base, quote );
+    return my->get_cached<market_ticker>( "get_ticker", { base, quote }, [this,&base,&quote]() {
+       return my->get_ticker( base, quote );
+    } );
 }
 
 market_ticker database_api_impl::get_ticker( const string& base, const string& quote, bool skip_order_book )const
@@ -1371,8 +2080,14 @@ market_ticker database_api_impl::get_ticker( const string& base, const string& q
    FC_ASSERT( assets[0], "Invalid base asset symbol: ${s}", ("s",base) );
    FC_ASSERT( assets[1], "Invalid quote asset symbol: ${s}", ("s",quote) );
 
-   auto base_id = assets[0]->id;
-   auto quote_id = assets[1]->id;
+   return get_ticker( *assets[0], *assets[1], skip_order_book );
+}
+
+market_ticker database_api_impl::get_ticker( const asset_object& base, const asset_object& quote,
+                                             bool skip_order_book )const
+{
+   auto base_id = base.get_id();
+   auto quote_id = quote.get_id();
    if( base_id > quote_id ) std::swap( base_id, quote_id );
    const auto& ticker_idx = _db.get_index_type<market_ticker_index>().indices().get<by_market>();
    auto itr = ticker_idx.find( std::make_tuple( base_id, quote_id ) );
@@ -1382,18 +2097,53 @@ market_ticker database_api_impl::get_ticker( const string& base, const string& q
       order_book orders;
       if (!skip_order_book)
       {
-         orders = get_order_book(assets[0]->symbol, assets[1]->symbol, 1);
+         orders = get_order_book(base.symbol, quote.symbol, 1);
       }
-      return market_ticker(*itr, now, *assets[0], *assets[1], orders);
+      return market_ticker(*itr, now, base, quote, orders);
    }
    // if no ticker is found for this market we return an empty ticker
-   market_ticker empty_result(now, *assets[0], *assets[1]);
+   market_ticker empty_result(now, base, quote);
    return empty_result;
 }
 
+vector<market_ticker> database_api::get_tickers( const vector<std::pair<string, string>>& markets )const
+{
+   return my->get_cached<vector<market_ticker>>( "get_tickers", { markets }, [this,&markets]() {
+      return my->run_read_only( "get_tickers", [this,&markets]() { return my->get_tickers( markets ); } );
+   } );
+}
+
+vector<market_ticker> database_api_impl::get_tickers( const vector<std::pair<string, string>>& markets )const
+{
+   FC_ASSERT( _app_options && _app_options->has_market_history_plugin, "Market history plugin is not enabled." );
+
+   const auto configured_limit = _app_options->api_limit_get_tickers;
+   FC_ASSERT( markets.size() <= configured_limit,
+              "Number of markets can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   // markets often share an asset, look up each asset once
+   std::map<string, const asset_object*> assets;
+   auto find_asset = [this,&assets]( const string& symbol_or_id ) {
+      auto itr = assets.find( symbol_or_id );
+      if( itr == assets.end() )
+         itr = assets.emplace( symbol_or_id, get_asset_from_string( symbol_or_id, false ) ).first;
+      FC_ASSERT( itr->second, "Invalid asset symbol: ${s}", ("s",symbol_or_id) );
+      return itr->second;
+   };
+
+   vector<market_ticker> result;
+   result.reserve( markets.size() );
+   for( const auto& market : markets )
+      result.push_back( get_ticker( *find_asset( market.first ), *find_asset( market.second ), false ) );
+   return result;
+}
+
 market_volume database_api::get_24_volume( const string& base, const string& quote )const
 {
-    return my->get_24_volume( base, quote );
+    return my->get_cached<market_volume>( "get_24_volume", { base, quote }, [this,&base,&quote]() {
+       return my->get_24_volume( base, quote );
+    } );
 }
 
 market_volume database_api_impl::get_24_volume( const string& base, const string& quote )const
@@ -1412,7 +2162,11 @@ market_volume database_api_impl::get_24_volume( const string& base, const string
 
 order_book database_api::get_order_book( const string& base, const string& quote, unsigned limit )const
 {
-   return my->get_order_book( base, quote, limit);
+   return my->get_cached<order_book>( "get_order_book", { base, quote, limit }, [this,&base,&quote,limit]() {
+      return my->run_read_only( "get_order_book", [this,&base,&quote,limit]() {
+         return my->get_order_book( base, quote, limit );
+      } );
+   } );
 }
 
 order_book database_api_impl::get_order_book( const string& base, const string& quote, unsigned limit )const
@@ -1431,8 +2185,36 @@ order_book database_api_impl::get_order_book( const string& base, const string&
    FC_ASSERT( assets[0], "Invalid base asset symbol: ${s}", ("s",base) );
    FC_ASSERT( assets[1], "Invalid quote asset symbol: ${s}", ("s",quote) );
 
-   auto base_id = assets[0]->id;
-   auto quote_id = assets[1]->id;
+   // the cached books hold as many orders as a call may ask for
+   const uint32_t cached_depth = static_cast<uint32_t>( std::min( configured_limit,
+                                                                  _app_options->api_limit_get_limit_orders ) );
+   if( _app_options->order_books && order_book_versions_index && order_book_versions_index->is_populated()
+       && limit <= cached_depth )
+   {
+      const auto market = std::make_pair( assets[0]->get_id(), assets[1]->get_id() );
+      const auto book = _app_options->order_books->get( market,
+                                                        order_book_versions_index->get_version( market.first,
+                                                                                                market.second ),
+                                                        [this,&assets,cached_depth]() {
+         return compute_order_book( *assets[0], *assets[1], cached_depth );
+      } );
+      result.bids.assign( book->bids.begin(), book->bids.begin() + std::min<size_t>( limit, book->bids.size() ) );
+      result.asks.assign( book->asks.begin(), book->asks.begin() + std::min<size_t>( limit, book->asks.size() ) );
+      return result;
+   }
+
+   order_book book = compute_order_book( *assets[0], *assets[1], limit );
+   result.bids = std::move( book.bids );
+   result.asks = std::move( book.asks );
+   return result;
+}
+
+order_book database_api_impl::compute_order_book( const asset_object& base, const asset_object& quote,
+                                                  uint32_t limit )const
+{
+   order_book result;
+   const asset_id_type base_id = base.get_id();
+   const asset_id_type quote_id = quote.get_id();
    auto orders = get_limit_orders( base_id, quote_id, limit );
 
    for( const auto& o : orders )
@@ -1440,21 +2222,21 @@ order_book database_api_impl::get_order_book( const string& base, const string&
       if( o.sell_price.base.asset_id == base_id )
       {
          order ord;
-         ord.price = price_to_string( o.sell_price, *assets[0], *assets[1] );
-         ord.quote = assets[1]->amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
-                                                              * o.sell_price.quote.amount.value
-                                                              / o.sell_price.base.amount.value ) );
-         ord.base = assets[0]->amount_to_string( o.for_sale );
+         ord.price = price_to_string( o.sell_price, base, quote );
+         ord.quote = quote.amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
+                                                         * o.sell_price.quote.amount.value
+                                                         / o.sell_price.base.amount.value ) );
+         ord.base = base.amount_to_string( o.for_sale );
          result.bids.push_back( ord );
       }
       else
       {
          order ord;
-         ord.price = price_to_string( o.sell_price, *assets[0], *assets[1] );
-         ord.quote = assets[1]->amount_to_string( o.for_sale );
-         ord.base = assets[0]->amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
-                                                             * o.sell_price.quote.amount.value
-                                                             / o.sell_price.base.amount.value ) );
+         ord.price = price_to_string( o.sell_price, base, quote );
+         ord.quote = quote.amount_to_string( o.for_sale );
+         ord.base = base.amount_to_string( share_type( fc::uint128_t( o.for_sale.value )
+                                                       * o.sell_price.quote.amount.value
+                                                       / o.sell_price.base.amount.value ) );
          result.asks.push_back( ord );
       }
    }
@@ -1464,7 +2246,9 @@ order_book database_api_impl::get_order_book( const string& base, const string&
 
 vector<market_ticker> database_api::get_top_markets(uint32_t limit)const
 {
-   return my->get_top_markets(limit);
+   return my->get_cached<vector<market_ticker>>( "get_top_markets", { limit }, [this,limit]() {
+      return my->run_read_only( "get_top_markets", [this,limit]() { return my->get_top_markets( limit ); } );
+   } );
 }
 
 vector<market_ticker> database_api_impl::get_top_markets(uint32_t limit)const
@@ -1501,7 +2285,9 @@ vector<market_trade> database_api::get_trade_history( const string& base,
                                                       fc::time_point_sec stop,
                                                       unsigned limit )const
 {
-   return my->get_trade_history( base, quote, start, stop, limit );
+   return my->run_read_only( "get_trade_history", [this,&base,&quote,start,stop,limit]() {
+      return my->get_trade_history( base, quote, start, stop, limit );
+   } );
 }
 
 vector<market_trade> database_api_impl::get_trade_history( const string& base,
@@ -1847,6 +2633,7 @@ vector<extended_liquidity_pool_object> database_api_impl::get_liquidity_pools_by
    asset_id_type aid = get_asset_from_string(asset_symbol_or_id)->id;
 
    FC_ASSERT( asset_in_liquidity_pools_index, "Internal error" );
+   check_populated( *asset_in_liquidity_pools_index );
    const auto& pools = asset_in_liquidity_pools_index->get_liquidity_pools_by_asset( aid );
 
    liquidity_pool_id_type start_id = ostart_id.valid() ? *ostart_id : liquidity_pool_id_type();
@@ -2064,6 +2851,39 @@ vector<extended_liquidity_pool_object> database_api_impl::get_liquidity_pools_by
    return results;
 }
 
+vector<liquidity_pool_exchange_quote> database_api::get_liquidity_pool_exchange_quotes(
+            liquidity_pool_id_type pool_id,
+            const vector<asset>& amounts_to_sell )const
+{
+   return my->get_liquidity_pool_exchange_quotes( pool_id, amounts_to_sell );
+}
+
+vector<liquidity_pool_exchange_quote> database_api_impl::get_liquidity_pool_exchange_quotes(
+            liquidity_pool_id_type pool_id,
+            const vector<asset>& amounts_to_sell )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_get_liquidity_pools;
+   FC_ASSERT( amounts_to_sell.size() <= configured_limit,
+              "Number of amounts to sell can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   const liquidity_pool_object& pool = pool_id(_db);
+   const asset_object& asset_a = pool.asset_a(_db);
+   const asset_object& asset_b = pool.asset_b(_db);
+
+   vector<liquidity_pool_exchange_quote> results;
+   results.reserve( amounts_to_sell.size() );
+   for( const asset& amount_to_sell : amounts_to_sell )
+   {
+      const bool sell_a = ( amount_to_sell.asset_id == pool.asset_a );
+      results.emplace_back( _db.quote_liquidity_pool_exchange( pool, amount_to_sell,
+                                                               sell_a ? asset_a : asset_b,
+                                                               sell_a ? asset_b : asset_a ) );
+   }
+   return results;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // SameT Funds                                                      //
@@ -2151,6 +2971,53 @@ vector<credit_offer_object> database_api::get_credit_offers_by_asset(
                                   idx, limit, start_id, asset_type );
 }
 
+vector<credit_offer_object> database_api::get_best_credit_offers(
+            const std::string& asset_symbol_or_id,
+            const std::string& collateral_symbol_or_id,
+            const optional<uint32_t>& limit )const
+{
+   return my->get_best_credit_offers( asset_symbol_or_id, collateral_symbol_or_id, limit );
+}
+
+vector<credit_offer_object> database_api_impl::get_best_credit_offers(
+            const std::string& asset_symbol_or_id,
+            const std::string& collateral_symbol_or_id,
+            const optional<uint32_t>& olimit )const
+{
+   // api_helper_indexes plugin is required for accessing the secondary index
+   FC_ASSERT( _app_options && _app_options->has_api_helper_indexes_plugin,
+              "api_helper_indexes plugin is not enabled on this server." );
+
+   uint64_t limit = olimit.valid() ? *olimit : application_options::get_default().api_limit_get_credit_offers;
+   const auto configured_limit = _app_options->api_limit_get_credit_offers;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   asset_id_type asset_type = get_asset_from_string(asset_symbol_or_id)->id;
+   asset_id_type collateral_type = get_asset_from_string(collateral_symbol_or_id)->id;
+
+   FC_ASSERT( credit_offers_by_collateral_index, "Internal error" );
+   check_populated( *credit_offers_by_collateral_index );
+   const auto& offers = credit_offers_by_collateral_index->get_offers();
+
+   // the keys of a pair of assets start with the lowest fee rate and the highest balance
+   auto itr = offers.lower_bound( std::make_tuple( asset_type, collateral_type, uint32_t(0),
+                                                   share_type(-GRAPHENE_MAX_SHARE_SUPPLY),
+                                                   credit_offer_id_type() ) );
+
+   vector<credit_offer_object> results;
+   results.reserve( limit );
+   for( ; itr != offers.end() && results.size() < limit; ++itr )
+   {
+      if( std::get<0>( *itr ) != asset_type || std::get<1>( *itr ) != collateral_type )
+         break;
+      results.emplace_back( std::get<4>( *itr )(_db) );
+   }
+
+   return results;
+}
+
 vector<credit_deal_object> database_api::list_credit_deals(
             const optional<uint32_t>& limit,
             const optional<credit_deal_id_type>& start_id )const
@@ -2314,6 +3181,21 @@ uint64_t database_api_impl::get_witness_count()const
    return _db.get_index_type<witness_index>().indices().size();
 }
 
+vector<witness_schedule_slot> database_api::get_witness_schedule( uint32_t limit )const
+{
+   return my->get_witness_schedule( limit );
+}
+
+vector<witness_schedule_slot> database_api_impl::get_witness_schedule( uint32_t limit )const
+{
+   const auto max_limit = _db.get_witness_schedule_object().current_shuffled_witnesses.size();
+   FC_ASSERT( limit <= max_limit,
+              "limit can not be greater than ${max_limit}",
+              ("max_limit", max_limit) );
+
+   return _db.get_scheduled_slots( limit );
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Committee members                                                //
@@ -2589,14 +3471,23 @@ set<public_key_type> database_api::get_required_signatures( const signed_transac
 
 set<public_key_type> database_api_impl::get_required_signatures( const signed_transaction& trx,
                                                             const flat_set<public_key_type>& available_keys )const
+{
+   authority_cache cache;
+   return get_required_signatures( trx, available_keys, cache );
+}
+
+set<public_key_type> database_api_impl::get_required_signatures( const signed_transaction& trx,
+                                                            const flat_set<public_key_type>& available_keys,
+                                                            authority_cache& cache )const
 {
    auto chain_time = _db.head_block_time();
    bool allow_non_immediate_owner = ( chain_time >= HARDFORK_CORE_584_TIME );
    bool ignore_custom_op_reqd_auths = MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( chain_time );
+   auto get_active = [this, &cache]( account_id_type id ){ return get_cached_authority( id, false, cache ).auth; };
+   auto get_owner = [this, &cache]( account_id_type id ){ return get_cached_authority( id, true, cache ).auth; };
    auto result = trx.get_required_signatures( _db.get_chain_id(),
                                        available_keys,
-                                       [&]( account_id_type id ){ return &id(_db).active; },
-                                       [&]( account_id_type id ){ return &id(_db).owner; },
+                                       get_active, get_owner,
                                        allow_non_immediate_owner,
                                        ignore_custom_op_reqd_auths,
                                        _db.get_global_properties().parameters.max_authority_depth );
@@ -2613,28 +3504,31 @@ set<address> database_api::get_potential_address_signatures( const signed_transa
 }
 
 set<public_key_type> database_api_impl::get_potential_signatures( const signed_transaction& trx )const
+{
+   authority_cache cache;
+   return get_potential_signatures( trx, cache );
+}
+
+set<public_key_type> database_api_impl::get_potential_signatures( const signed_transaction& trx,
+                                                                 authority_cache& cache )const
 {
    auto chain_time = _db.head_block_time();
    bool allow_non_immediate_owner = ( chain_time >= HARDFORK_CORE_584_TIME );
    bool ignore_custom_op_reqd_auths = MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( chain_time );
 
    set<public_key_type> result;
-   auto get_active = [this, &result]( account_id_type id ){
-      const auto& auth = id( _db ).active;
-      for( const auto& k : auth.get_keys() )
-         result.insert( k );
-      return &auth;
-   };
-   auto get_owner = [this, &result]( account_id_type id ){
-      const auto& auth = id( _db ).owner;
-      for( const auto& k : auth.get_keys() )
-         result.insert( k );
-      return &auth;
+   auto collect_keys = [this, &result, &cache]( account_id_type id, bool owner ){
+      auto& entry = get_cached_authority( id, owner, cache );
+      if( !entry.keys.valid() )
+         entry.keys = entry.auth->get_keys();
+      result.insert( entry.keys->begin(), entry.keys->end() );
+      return entry.auth;
    };
 
    trx.get_required_signatures( _db.get_chain_id(),
                                 flat_set<public_key_type>(),
-                                get_active, get_owner,
+                                [&collect_keys]( account_id_type id ){ return collect_keys( id, false ); },
+                                [&collect_keys]( account_id_type id ){ return collect_keys( id, true ); },
                                 allow_non_immediate_owner,
                                 ignore_custom_op_reqd_auths,
                                 _db.get_global_properties().parameters.max_authority_depth );
@@ -2651,6 +3545,101 @@ set<public_key_type> database_api_impl::get_potential_signatures( const signed_t
    return result;
 }
 
+database_api_impl::authority_cache::entry& database_api_impl::get_cached_authority( account_id_type id,
+                                                                                    bool owner,
+                                                                                    authority_cache& cache )const
+{
+   auto& entries = ( owner ? cache.owner : cache.active );
+   auto itr = entries.find( id );
+   if( itr == entries.end() )
+   {
+      const account_object& account = id( _db );
+      itr = entries.emplace( id, authority_cache::entry() ).first;
+      itr->second.auth = ( owner ? &account.owner : &account.active );
+   }
+   return itr->second;
+}
+
+vector<set<public_key_type>> database_api::get_required_signatures_batch( const vector<signed_transaction>& trxs,
+                                                      const flat_set<public_key_type>& available_keys )const
+{
+   return my->run_read_only( "get_required_signatures_batch", [this,&trxs,&available_keys]() {
+      return my->get_required_signatures_batch( trxs, available_keys );
+   });
+}
+
+vector<set<public_key_type>> database_api_impl::get_required_signatures_batch(
+                                                      const vector<signed_transaction>& trxs,
+                                                      const flat_set<public_key_type>& available_keys )const
+{
+   const vector<precomputable_transaction> ptrxs = recover_signature_keys( trxs );
+   authority_cache cache;
+   vector<set<public_key_type>> result;
+   result.reserve( ptrxs.size() );
+   for( const auto& trx : ptrxs )
+      result.push_back( get_required_signatures( trx, available_keys, cache ) );
+   return result;
+}
+
+vector<set<public_key_type>> database_api::get_potential_signatures_batch(
+                                                      const vector<signed_transaction>& trxs )const
+{
+   return my->run_read_only( "get_potential_signatures_batch", [this,&trxs]() {
+      return my->get_potential_signatures_batch( trxs );
+   });
+}
+
+vector<set<public_key_type>> database_api_impl::get_potential_signatures_batch(
+                                                      const vector<signed_transaction>& trxs )const
+{
+   const vector<precomputable_transaction> ptrxs = recover_signature_keys( trxs );
+   authority_cache cache;
+   vector<set<public_key_type>> result;
+   result.reserve( ptrxs.size() );
+   for( const auto& trx : ptrxs )
+      result.push_back( get_potential_signatures( trx, cache ) );
+   return result;
+}
+
+vector<precomputable_transaction> database_api_impl::recover_signature_keys(
+                                                      const vector<signed_transaction>& trxs )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_get_signatures_batch;
+   FC_ASSERT( trxs.size() <= configured_limit,
+              "Number of transactions can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   vector<precomputable_transaction> result( trxs.begin(), trxs.end() );
+   const size_t chunks = std::min<size_t>( fc::asio::default_io_service_scope::get_num_threads(), result.size() );
+   if( chunks <= 1 )
+      return result;
+
+   // The authorities are evaluated sequentially afterwards, only the recovery of the keys which does not touch
+   // the database state is done in the thread pool
+   const chain_id_type& chain_id = _db.get_chain_id();
+   std::vector<fc::future<void>> workers;
+   workers.reserve( chunks );
+   for( size_t chunk = 0; chunk < chunks; ++chunk )
+   {
+      const size_t first = result.size() * chunk / chunks;
+      const size_t last = result.size() * ( chunk + 1 ) / chunks;
+      workers.push_back( fc::do_parallel( [&result,&chain_id,first,last]() {
+         for( size_t i = first; i < last; ++i )
+         {
+            try {
+               result[i].get_signature_keys( chain_id );
+            } catch( const fc::exception& ) {
+               // the invalid signature is reported when the transaction is evaluated
+            }
+         }
+      }) );
+   }
+   for( auto& worker : workers )
+      worker.wait();
+   return result;
+}
+
 set<address> database_api_impl::get_potential_address_signatures( const signed_transaction& trx )const
 {
    auto chain_time = _db.head_block_time();
@@ -2688,9 +3677,10 @@ bool database_api::verify_authority( const signed_transaction& trx )const
 bool database_api_impl::verify_authority( const signed_transaction& trx )const
 {
    bool allow_non_immediate_owner = ( _db.head_block_time() >= HARDFORK_CORE_584_TIME );
+   authority_cache cache;
    trx.verify_authority( _db.get_chain_id(),
-                         [this]( account_id_type id ){ return &id(_db).active; },
-                         [this]( account_id_type id ){ return &id(_db).owner; },
+                         [this,&cache]( account_id_type id ){ return get_cached_authority( id, false, cache ).auth; },
+                         [this,&cache]( account_id_type id ){ return get_cached_authority( id, true, cache ).auth; },
                          [this]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
                            return _db.get_viable_custom_authorities(id, op, rejects); },
                          allow_non_immediate_owner,
@@ -2842,20 +3832,14 @@ vector<proposal_object> database_api_impl::get_proposed_transactions( const std:
    FC_ASSERT( _app_options && _app_options->has_api_helper_indexes_plugin,
               "api_helper_indexes plugin is not enabled on this server." );
 
-   const auto& proposal_idx = _db.get_index_type< primary_index< proposal_index > >();
-   const auto& proposals_by_account = proposal_idx.get_secondary_index<graphene::chain::required_approval_index>();
-
    vector<proposal_object> result;
    const account_id_type id = get_account_from_string(account_id_or_name)->id;
 
-   auto required_approvals_itr = proposals_by_account._account_to_proposals.find( id );
-   if( required_approvals_itr != proposals_by_account._account_to_proposals.end() )
+   const auto proposal_ids = get_proposals_by_approver( id );
+   result.reserve( proposal_ids.size() );
+   for( auto proposal_id : proposal_ids )
    {
-      result.reserve( required_approvals_itr->second.size() );
-      for( auto proposal_id : required_approvals_itr->second )
-      {
-         result.push_back( proposal_id(_db) );
-      }
+      result.push_back( proposal_id(_db) );
    }
    return result;
 }
@@ -2960,6 +3944,39 @@ vector<withdraw_permission_object> database_api_impl::get_withdraw_permissions_b
    return result;
 }
 
+vector<withdraw_permission_object> database_api::get_withdraw_permissions_by_expiration(
+                                      const std::string account_id_or_name,
+                                      fc::time_point_sec start,
+                                      uint32_t limit )const
+{
+   return my->get_withdraw_permissions_by_expiration( account_id_or_name, start, limit );
+}
+
+vector<withdraw_permission_object> database_api_impl::get_withdraw_permissions_by_expiration(
+                                      const std::string account_id_or_name,
+                                      fc::time_point_sec start,
+                                      uint32_t limit )const
+{
+   // api_helper_indexes plugin is required for accessing the secondary index
+   FC_ASSERT( _app_options && _app_options->has_api_helper_indexes_plugin,
+              "api_helper_indexes plugin is not enabled on this server." );
+
+   const auto configured_limit = _app_options->api_limit_get_withdraw_permissions_by_giver;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   FC_ASSERT( withdraw_permission_expirations_index, "Internal error" );
+   check_populated( *withdraw_permission_expirations_index );
+   const account_id_type account = get_account_from_string(account_id_or_name)->id;
+   vector<withdraw_permission_object> result;
+   const auto ids = withdraw_permission_expirations_index->find( account, start, limit );
+   result.reserve( ids.size() );
+   for( const auto& id : ids )
+      result.push_back( withdraw_permission_id_type( id )(_db) );
+   return result;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 //  HTLC                                                            //
@@ -3065,6 +4082,35 @@ vector<htlc_object> database_api_impl::list_htlcs(const htlc_id_type start, uint
    return result;
 }
 
+vector<htlc_object> database_api::get_htlcs_by_expiration( const std::string account_id_or_name,
+                                                           fc::time_point_sec start, uint32_t limit )const
+{
+   return my->get_htlcs_by_expiration( account_id_or_name, start, limit );
+}
+
+vector<htlc_object> database_api_impl::get_htlcs_by_expiration( const std::string account_id_or_name,
+                                                                fc::time_point_sec start, uint32_t limit ) const
+{
+   // api_helper_indexes plugin is required for accessing the secondary index
+   FC_ASSERT( _app_options && _app_options->has_api_helper_indexes_plugin,
+              "api_helper_indexes plugin is not enabled on this server." );
+
+   const auto configured_limit = _app_options->api_limit_get_htlc_by;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   FC_ASSERT( htlc_expirations_index, "Internal error" );
+   check_populated( *htlc_expirations_index );
+   const account_id_type account = get_account_from_string(account_id_or_name)->id;
+   vector<htlc_object> result;
+   const auto ids = htlc_expirations_index->find( account, start, limit );
+   result.reserve( ids.size() );
+   for( const auto& id : ids )
+      result.push_back( htlc_id_type( id )(_db) );
+   return result;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Tickets                                                          //
@@ -3279,8 +4325,27 @@ bool database_api_impl::is_impacted_account( const flat_set<account_id_type>& ac
    });
 }
 
+void database_api_impl::subscribe_to_account( account_id_type account )
+{
+   if( _subscribed_accounts.insert( account ).second )
+      _db.subscribe_impacted_account( account );
+}
+
+void database_api_impl::unsubscribe_from_accounts()
+{
+   for( const auto& account : _subscribed_accounts )
+      _db.unsubscribe_impacted_account( account );
+   _subscribed_accounts.clear();
+}
+
 void database_api_impl::broadcast_updates( const vector<variant>& updates )
 {
+   if( !updates.empty() && _subscribe_callback && _app_options && _app_options->batch_notifications )
+   {
+      _pending_updates.insert( _pending_updates.end(), updates.begin(), updates.end() );
+      schedule_notifications();
+      return;
+   }
    if( !updates.empty() && _subscribe_callback ) {
       auto capture_this = shared_from_this();
       fc::async([capture_this,updates](){
@@ -3292,6 +4357,16 @@ void database_api_impl::broadcast_updates( const vector<variant>& updates )
 
 void database_api_impl::broadcast_market_updates( const market_queue_type& queue)
 {
+   if( !queue.empty() && _app_options && _app_options->batch_notifications )
+   {
+      for( const auto& item : queue )
+      {
+         auto& pending = _pending_market_updates[ item.first ];
+         pending.insert( pending.end(), item.second.begin(), item.second.end() );
+      }
+      schedule_notifications();
+      return;
+   }
    if( !queue.empty() )
    {
       auto capture_this = shared_from_this();
@@ -3306,20 +4381,39 @@ void database_api_impl::broadcast_market_updates( const market_queue_type& queue
    }
 }
 
+void database_api_impl::schedule_notifications()
+{
+   // The signals of a block are delivered one after another without yielding, so a single task scheduled by the
+   // first of them sends what all of them collected
+   if( _notification_flush_scheduled )
+      return;
+   _notification_flush_scheduled = true;
+   auto capture_this = shared_from_this();
+   fc::async([capture_this, this](){
+      _notification_flush_scheduled = false;
+      vector<variant> updates;
+      std::swap( updates, _pending_updates );
+      market_queue_type markets;
+      std::swap( markets, _pending_market_updates );
+      if( !updates.empty() && _subscribe_callback )
+         _subscribe_callback( fc::variant(updates) );
+      for( const auto& item : markets )
+      {
+         auto sub = _market_subscriptions.find(item.first);
+         if( sub != _market_subscriptions.end() )
+            sub->second( fc::variant(item.second) );
+      }
+   });
+}
+
 void database_api_impl::on_objects_removed( const vector<object_id_type>& ids,
                                             const vector<const object*>& objs,
                                             const flat_set<account_id_type>& impacted_accounts )
 {
+   // the removed objects are reported in the same order as their ids
    handle_object_changed(_notify_remove_create, false, ids, impacted_accounts,
-      [objs](object_id_type id) -> const object* {
-         auto it = std::find_if(
-               objs.begin(), objs.end(),
-               [id](const object* o) {return o != nullptr && o->id == id;});
-
-         if (it != objs.end())
-            return *it;
-
-         return nullptr;
+      [&objs](size_t index) -> const object* {
+         return index < objs.size() ? objs[index] : nullptr;
       }
    );
 }
@@ -3328,7 +4422,7 @@ void database_api_impl::on_objects_new( const vector<object_id_type>& ids,
                                         const flat_set<account_id_type>& impacted_accounts )
 {
    handle_object_changed(_notify_remove_create, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
+      [this,&ids](size_t index) { return _db.find_object( ids[index] ); }
    );
 }
 
@@ -3336,7 +4430,7 @@ void database_api_impl::on_objects_changed( const vector<object_id_type>& ids,
                                             const flat_set<account_id_type>& impacted_accounts )
 {
    handle_object_changed(false, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
+      [this,&ids](size_t index) { return _db.find_object( ids[index] ); }
    );
 }
 
@@ -3344,22 +4438,25 @@ void database_api_impl::handle_object_changed( bool force_notify,
                                                bool full_object,
                                                const vector<object_id_type>& ids,
                                                const flat_set<account_id_type>& impacted_accounts,
-                                               std::function<const object*(object_id_type id)> find_object )
+                                               std::function<const object*(size_t index)> find_object )
 {
    if( _subscribe_callback )
    {
       vector<variant> updates;
+      // the impacted accounts are the same for all objects of the batch
+      const bool notify_all = force_notify || is_impacted_account(impacted_accounts);
 
-      for(auto id : ids)
+      for( size_t i = 0; i < ids.size(); ++i )
       {
-         if( force_notify || is_subscribed_to_item(id) || is_impacted_account(impacted_accounts) )
+         const object_id_type id = ids[i];
+         if( notify_all || is_subscribed_to_item(id) )
          {
             if( full_object )
             {
-               auto obj = find_object(id);
+               auto obj = find_object(i);
                if( obj )
                {
-                  updates.emplace_back( obj->to_variant() );
+                  updates.emplace_back( notification_variant( *obj ) );
                }
             }
             else
@@ -3377,19 +4474,20 @@ void database_api_impl::handle_object_changed( bool force_notify,
    {
       market_queue_type broadcast_queue;
 
-      for(auto id : ids)
+      for( size_t i = 0; i < ids.size(); ++i )
       {
+         const object_id_type id = ids[i];
          if( id.is<call_order_object>() )
          {
-            enqueue_if_subscribed_to_market<call_order_object>( find_object(id), broadcast_queue, full_object );
+            enqueue_if_subscribed_to_market<call_order_object>( find_object(i), broadcast_queue, full_object );
          }
          else if( id.is<limit_order_object>() )
          {
-            enqueue_if_subscribed_to_market<limit_order_object>( find_object(id), broadcast_queue, full_object );
+            enqueue_if_subscribed_to_market<limit_order_object>( find_object(i), broadcast_queue, full_object );
          }
          else if( id.is<force_settlement_object>() )
          {
-            enqueue_if_subscribed_to_market<force_settlement_object>( find_object(id), broadcast_queue,
+            enqueue_if_subscribed_to_market<force_settlement_object>( find_object(i), broadcast_queue,
                                                                       full_object );
          }
       }
@@ -22,9 +22,17 @@
  * THE SOFTWARE.
  */
 
+#include <graphene/app/account_operation_publisher.hpp>
+#include <graphene/app/api_call_metrics.hpp>
+#include <graphene/app/api_response_cache.hpp>
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/object_notification_cache.hpp>
+#include <graphene/app/order_book_cache.hpp>
+#include <graphene/app/order_book_delta_publisher.hpp>
 
 #include <fc/bloom_filter.hpp>
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
 
@@ -41,12 +49,16 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
       // Objects
       fc::variants get_objects( const vector<object_id_type>& ids, optional<bool> subscribe )const;
+      fc::variants get_object_fields( const vector<object_id_type>& ids, const flat_set<string>& fields )const;
 
       // Subscriptions
       void set_subscribe_callback( std::function<void(const variant&)> cb, bool notify_remove_create );
       void set_auto_subscription( bool enable );
       void set_pending_transaction_callback( std::function<void(const variant&)> cb );
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
+      void subscribe_to_account_operations( std::function<void(const variant&)> callback,
+                                            const vector<std::string>& account_names_or_ids );
+      void unsubscribe_from_account_operations();
       void cancel_all_subscriptions(bool reset_callback, bool reset_market_subscriptions);
 
       // Blocks and transactions
@@ -61,6 +73,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       fc::variant_object get_config()const;
       chain_id_type get_chain_id()const;
       dynamic_global_property_object get_dynamic_global_properties()const;
+      vector<graphene::db::index_memory_usage> get_index_memory_usage()const;
+      vector<maintenance_profile> get_maintenance_profiles()const;
 
       // Keys
       vector<flat_set<account_id_type>> get_key_references( vector<public_key_type> key )const;
@@ -72,6 +86,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
                                                      optional<bool> subscribe )const;
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids,
                                                        optional<bool> subscribe );
+      full_account_page get_full_account_page( const std::string& account_name_or_id,
+                                               const full_account_query& query )const;
       vector<account_statistics_object> get_top_voters(uint32_t limit)const;
       optional<account_object> get_account_by_name( string name )const;
       vector<account_id_type> get_account_references( const std::string account_id_or_name )const;
@@ -79,6 +95,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       map<string,account_id_type> lookup_accounts( const string& lower_bound_name,
                                                    uint32_t limit,
                                                    optional<bool> subscribe )const;
+      map<string,account_id_type> search_accounts( const string& text, uint32_t limit,
+                                                   optional<bool> match_substrings )const;
       uint64_t get_account_count()const;
 
       // Balances
@@ -88,6 +106,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<balance_object> get_balance_objects( const vector<address>& addrs )const;
       vector<asset> get_vested_balances( const vector<balance_id_type>& objs )const;
       vector<vesting_balance_object> get_vesting_balances( const std::string account_id_or_name )const;
+      vector<optional<asset>> get_vesting_balance_withdrawals( const vector<vesting_balance_id_type>& ids )const;
 
       // Assets
       uint64_t get_asset_count()const;
@@ -95,6 +114,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<optional<extended_asset_object>> get_assets( const vector<std::string>& asset_symbols_or_ids,
                                                           optional<bool> subscribe )const;
       vector<extended_asset_object>           list_assets(const string& lower_bound_symbol, uint32_t limit)const;
+      vector<extended_asset_object>           search_assets( const string& text, uint32_t limit,
+                                                             optional<bool> match_substrings )const;
       vector<optional<extended_asset_object>> lookup_asset_symbols(const vector<string>& symbols_or_ids)const;
       vector<extended_asset_object>           get_assets_by_issuer(const std::string& issuer_name_or_id,
                                                                    asset_id_type start, uint32_t limit)const;
@@ -118,19 +139,31 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
                                                                       force_settlement_id_type start,
                                                                       uint32_t limit)const;
       vector<call_order_object>          get_margin_positions( const std::string account_id_or_name )const;
+      margin_call_risk                   get_margin_call_risk( const std::string& asset_symbol_or_id,
+                                                               const optional<price>& settlement_price,
+                                                               const optional<uint32_t>& olimit )const;
       vector<collateral_bid_object>      get_collateral_bids( const std::string& asset,
                                                               uint32_t limit, uint32_t start)const;
 
       void subscribe_to_market( std::function<void(const variant&)> callback,
                                 const std::string& a, const std::string& b );
       void unsubscribe_from_market(const std::string& a, const std::string& b);
+      void subscribe_to_order_book_deltas( std::function<void(const variant&)> callback,
+                                           const std::string& base, const std::string& quote, uint32_t depth );
+      void unsubscribe_from_order_book_deltas( const std::string& base, const std::string& quote );
 
+      vector<market_ticker>              get_tickers( const vector<std::pair<string, string>>& markets )const;
       market_ticker                      get_ticker( const string& base, const string& quote,
                                                      bool skip_order_book = false )const;
+      market_ticker                      get_ticker( const asset_object& base, const asset_object& quote,
+                                                     bool skip_order_book )const;
       market_volume                      get_24_volume( const string& base, const string& quote )const;
       order_book                         get_order_book( const string& base, const string& quote,
                                                          unsigned limit = 50 )const;
       vector<market_ticker>              get_top_markets( uint32_t limit )const;
+      /// Lists up to @p limit orders of each side of the book, the names of the assets are not set
+      order_book                         compute_order_book( const asset_object& base, const asset_object& quote,
+                                                             uint32_t limit )const;
       vector<market_trade>               get_trade_history( const string& base, const string& quote,
                                                             fc::time_point_sec start, fc::time_point_sec stop,
                                                             unsigned limit = 100 )const;
@@ -177,12 +210,22 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
             optional<uint32_t> limit = 101,
             optional<asset_id_type> start_id = optional<asset_id_type>(),
             optional<bool> with_statistics = false )const;
+      vector<liquidity_pool_exchange_quote> get_liquidity_pool_exchange_quotes(
+            liquidity_pool_id_type pool_id,
+            const vector<asset>& amounts_to_sell )const;
+
+      // Credit offers
+      vector<credit_offer_object> get_best_credit_offers(
+            const std::string& asset_symbol_or_id,
+            const std::string& collateral_symbol_or_id,
+            const optional<uint32_t>& limit = 101 )const;
 
       // Witnesses
       vector<optional<witness_object>> get_witnesses(const vector<witness_id_type>& witness_ids)const;
       fc::optional<witness_object> get_witness_by_account(const std::string account_id_or_name)const;
       map<string, witness_id_type> lookup_witness_accounts(const string& lower_bound_name, uint32_t limit)const;
       uint64_t get_witness_count()const;
+      vector<witness_schedule_slot> get_witness_schedule(uint32_t limit)const;
 
       // Committee members
       vector<optional<committee_member_object>> get_committee_members(
@@ -208,6 +251,9 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       set<public_key_type> get_required_signatures( const signed_transaction& trx,
                                                     const flat_set<public_key_type>& available_keys )const;
       set<public_key_type> get_potential_signatures( const signed_transaction& trx )const;
+      vector<set<public_key_type>> get_required_signatures_batch( const vector<signed_transaction>& trxs,
+                                                      const flat_set<public_key_type>& available_keys )const;
+      vector<set<public_key_type>> get_potential_signatures_batch( const vector<signed_transaction>& trxs )const;
       set<address> get_potential_address_signatures( const signed_transaction& trx )const;
       bool verify_authority( const signed_transaction& trx )const;
       bool verify_account_authority( const string& account_name_or_id,
@@ -229,6 +275,10 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<withdraw_permission_object> get_withdraw_permissions_by_recipient( const std::string account_id_or_name,
                                                                                 withdraw_permission_id_type start,
                                                                                 uint32_t limit )const;
+      vector<withdraw_permission_object> get_withdraw_permissions_by_expiration(
+                                            const std::string account_id_or_name,
+                                            fc::time_point_sec start,
+                                            uint32_t limit )const;
 
       // HTLC
       optional<htlc_object> get_htlc( htlc_id_type id, optional<bool> subscribe ) const;
@@ -237,6 +287,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<htlc_object> get_htlc_by_to( const std::string account_id_or_name,
                                           htlc_id_type start, uint32_t limit) const;
       vector<htlc_object> list_htlcs(const htlc_id_type lower_bound_id, uint32_t limit) const;
+      vector<htlc_object> get_htlcs_by_expiration( const std::string account_id_or_name,
+                                                   fc::time_point_sec start, uint32_t limit ) const;
 
       // Tickets
       vector<ticket_object> list_tickets(
@@ -249,6 +301,63 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
    //private:
 
+      ////////////////////////////////////////////////
+      // Objects
+      ////////////////////////////////////////////////
+
+      /// Finds the objects of the given IDs, in the order of the IDs, with null where an object does not exist.
+      /// The IDs are grouped by index, so that every index is looked up once and probed in the order of instances.
+      vector<const object*> find_objects( const vector<object_id_type>& ids )const;
+
+      ////////////////////////////////////////////////
+      // Concurrency
+      ////////////////////////////////////////////////
+
+      /// Runs a read-only call of the given method in one of the API read threads under a read lock of the
+      /// database state, or in the calling thread if there are no API read threads.
+      /// The call must not modify any member variable, e.g. by subscribing to objects.
+      template<typename CALL>
+      auto run_read_only( const char* method, CALL&& call )const -> decltype( call() )
+      {
+         if( nullptr == _app_options || _app_options->api_read_threads.empty() )
+            return call();
+         const auto& threads = _app_options->api_read_threads;
+         fc::thread& thread = *threads[ _next_read_thread++ % threads.size() ];
+         api_call_metrics* metrics = _app_options->api_read_metrics.get();
+         const fc::time_point queued_at = fc::time_point::now();
+         if( metrics )
+            metrics->on_queued( method );
+         return thread.async( [this,&call,method,metrics,queued_at]() {
+            auto lock = _db.lock_state_for_reading();
+            std::unique_ptr<api_call_metrics::running_scope> running;
+            if( metrics )
+               running = std::make_unique<api_call_metrics::running_scope>( *metrics, method, queued_at );
+            return call();
+         }, "read-only database API call" ).wait();
+      }
+
+      /// Returns the result of a call from the response cache of the node if it is enabled, otherwise calls it.
+      /// The result must only depend on the method, the parameters and the head block.
+      template<typename RESULT, typename CALL>
+      RESULT get_cached( const char* method, const fc::variants& params, CALL&& call )const
+      {
+         if( nullptr == _app_options || !_app_options->response_cache )
+            return call();
+         return _app_options->response_cache->get<RESULT>( method + fc::json::to_string( fc::variant( params ) ),
+                                                           std::forward<CALL>( call ) );
+      }
+
+      /// Same as @ref get_cached, for calls whose results never change
+      template<typename RESULT, typename CALL>
+      RESULT get_cached_immutable( const char* method, const fc::variants& params, CALL&& call )const
+      {
+         if( nullptr == _app_options || !_app_options->response_cache )
+            return call();
+         return _app_options->response_cache->get_immutable<RESULT>(
+                                               method + fc::json::to_string( fc::variant( params ) ),
+                                               std::forward<CALL>( call ) );
+      }
+
       ////////////////////////////////////////////////
       // Accounts
       ////////////////////////////////////////////////
@@ -265,7 +374,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       {
          asset_id_type id = a.id;
          extended_asset_object result = extended_asset_object( std::forward<ASSET>( a ) );
-         if( amount_in_collateral_index )
+         if( amount_in_collateral_index && amount_in_collateral_index->is_populated() )
          {
             result.total_in_collateral = amount_in_collateral_index->get_amount_in_collateral( id );
             if( result.bitasset_data_id.valid() )
@@ -288,6 +397,31 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<limit_order_object> get_limit_orders( const asset_id_type a, const asset_id_type b,
                                                    const uint32_t limit )const;
 
+      ////////////////////////////////////////////////
+      // Authority / validation
+      ////////////////////////////////////////////////
+
+      /// The authorities of the accounts which are visited while evaluating the signatures of transactions.
+      /// Nested authorities are visited again for every reference, the lookups are done once per call.
+      struct authority_cache
+      {
+         struct entry
+         {
+            const authority*                  auth = nullptr;
+            optional<vector<public_key_type>> keys; ///< filled when the keys are needed first
+         };
+         std::map<account_id_type, entry> active;
+         std::map<account_id_type, entry> owner;
+      };
+      authority_cache::entry& get_cached_authority( account_id_type id, bool owner, authority_cache& cache )const;
+
+      set<public_key_type> get_required_signatures( const signed_transaction& trx,
+                                                    const flat_set<public_key_type>& available_keys,
+                                                    authority_cache& cache )const;
+      set<public_key_type> get_potential_signatures( const signed_transaction& trx, authority_cache& cache )const;
+      /// Converts the transactions and recovers the keys of their signatures in parallel
+      vector<precomputable_transaction> recover_signature_keys( const vector<signed_transaction>& trxs )const;
+
       ////////////////////////////////////////////////
       // Liquidity pools
       ////////////////////////////////////////////////
@@ -448,6 +582,10 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
       // for full-account subscription
       bool is_impacted_account( const flat_set<account_id_type>& accounts );
+      /// Adds the account to @ref _subscribed_accounts and lets the database report whether changes impact it
+      void subscribe_to_account( account_id_type account );
+      /// Empties @ref _subscribed_accounts, see @ref graphene::chain::database::unsubscribe_impacted_account
+      void unsubscribe_from_accounts();
 
       // for market subscription
       template<typename T>
@@ -476,17 +614,27 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
          auto sub = _market_subscriptions.find( market );
          if( sub != _market_subscriptions.end() ) {
-            queue[market].emplace_back( full_object ? obj->to_variant() : fc::variant(obj->id, 1) );
+            queue[market].emplace_back( full_object ? notification_variant( *obj ) : fc::variant(obj->id, 1) );
          }
       }
 
+      /// @return the variant of an object reported by the object change signals, shared with other sessions
+      fc::variant notification_variant( const object& obj )const
+      {
+         if( nullptr != _app_options && _app_options->notification_cache )
+            return _app_options->notification_cache->get( obj );
+         return obj.to_variant();
+      }
+
       void broadcast_updates( const vector<variant>& updates );
       void broadcast_market_updates( const market_queue_type& queue);
+      /// Sends the collected notifications in a task of their own, see application_options::batch_notifications
+      void schedule_notifications();
       void handle_object_changed( bool force_notify,
                                   bool full_object,
                                   const vector<object_id_type>& ids,
                                   const flat_set<account_id_type>& impacted_accounts,
-                                  std::function<const object*(object_id_type id)> find_object );
+                                  std::function<const object*(size_t index)> find_object );
 
       /** called every time a block is applied to report the objects that were changed */
       void on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
@@ -495,6 +643,17 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
                               const flat_set<account_id_type>& impacted_accounts);
       void on_applied_block();
 
+      /// Fills the account, its statistics, the names of its referrers, its votes and its cashback balance
+      void fill_full_account_header( const account_object& account, full_account& acnt )const;
+      /// @return the proposals which the account can approve, also through the authorities of other accounts
+      /// @note requires the api_helper_indexes plugin
+      std::set<proposal_id_type> get_proposals_by_approver( account_id_type account )const;
+      /// @return whether the api_helper_indexes plugin is enabled and its indexes used by
+      ///         @ref get_proposals_by_approver are populated
+      bool can_get_proposals_by_approver()const;
+      /// Throws if the helper index is still being populated in the background by the api_helper_indexes plugin
+      static void check_populated( const secondary_index& idx );
+
       ////////////////////////////////////////////////
       // Member variables
       ////////////////////////////////////////////////
@@ -509,6 +668,12 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       std::function<void(const fc::variant&)> _pending_trx_callback;
       std::function<void(const fc::variant&)> _block_applied_callback;
 
+      /// The notifications which wait to be sent by @ref schedule_notifications,
+      /// only used if application_options::batch_notifications is set
+      vector<variant>   _pending_updates;
+      market_queue_type _pending_market_updates;
+      bool              _notification_flush_scheduled = false;
+
       boost::signals2::scoped_connection _new_connection;
       boost::signals2::scoped_connection _change_connection;
       boost::signals2::scoped_connection _removed_connection;
@@ -516,12 +681,27 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       boost::signals2::scoped_connection _pending_trx_connection;
 
       map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> > _market_subscriptions;
+      /// Subscription IDs in application_options::order_book_deltas, by base and quote asset
+      map< pair<asset_id_type,asset_id_type>, uint64_t > _order_book_delta_subscriptions;
+      /// Subscription ID in application_options::account_operations
+      optional<uint64_t> _account_operations_subscription;
 
       graphene::chain::database& _db;
       const application_options* _app_options = nullptr;
+      /// Round-robin index into application_options::api_read_threads
+      mutable size_t _next_read_thread = 0;
 
       const graphene::api_helper_indexes::amount_in_collateral_index* amount_in_collateral_index;
+      const graphene::api_helper_indexes::call_orders_by_collateral_ratio_index*
+                                                            call_orders_by_collateral_ratio_index;
       const graphene::api_helper_indexes::asset_in_liquidity_pools_index* asset_in_liquidity_pools_index;
+      const graphene::api_helper_indexes::credit_offers_by_collateral_index* credit_offers_by_collateral_index;
+      const graphene::api_helper_indexes::order_book_versions_index* order_book_versions_index;
+      const graphene::api_helper_indexes::name_trigram_index* account_name_trigram_index;
+      const graphene::api_helper_indexes::name_trigram_index* asset_symbol_trigram_index;
+      const graphene::api_helper_indexes::vesting_balances_by_owner_index* vesting_balances_by_owner_index;
+      const graphene::api_helper_indexes::expirations_by_account_index* htlc_expirations_index;
+      const graphene::api_helper_indexes::expirations_by_account_index* withdraw_permission_expirations_index;
 };
 
 } } // graphene::app
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/http_get_server.hpp>
+
+#include <graphene/app/api_response_cache.hpp>
+#include <graphene/app/application.hpp>
+#include <graphene/block_operations/block_operations_plugin.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/json.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <limits>
+
+namespace graphene { namespace app {
+
+namespace {
+
+   fc::optional<uint32_t> parse_block_num( const std::string& s )
+   {
+      if( s.empty() || s.size() > 10 || !std::all_of( s.begin(), s.end(), []( char c ){ return std::isdigit( c ); } ) )
+         return {};
+      const uint64_t num = std::stoull( s );
+      if( num == 0 || num > std::numeric_limits<uint32_t>::max() )
+         return {};
+      return static_cast<uint32_t>( num );
+   }
+
+   /// @return whether the value of an If-None-Match header matches the ETag, using the weak comparison of RFC 7232
+   bool etag_matches( const std::string& if_none_match, const std::string& etag )
+   {
+      std::vector<std::string> tags;
+      boost::split( tags, if_none_match, boost::is_any_of( "," ) );
+      for( auto& tag : tags )
+      {
+         boost::trim( tag );
+         if( boost::starts_with( tag, "W/" ) )
+            tag.erase( 0, 2 );
+         if( tag == "*" || tag == etag )
+            return true;
+      }
+      return false;
+   }
+
+}
+
+http_get_server::http_get_server( const application& app, api_response_cache* cache )
+   : _app( app ), _cache( cache )
+{
+}
+
+void http_get_server::listen( const fc::ip::endpoint& ep )
+{
+   _server.on_request( [this]( const fc::http::request& req, const fc::http::server::response& resp ) {
+      response result;
+      if( req.method == "GET" )
+         result = handle_get( req.path, req.get_header( "If-None-Match" ) );
+      else
+      {
+         result.status = 405;
+         result.headers.emplace_back( "Allow", "GET" );
+      }
+      resp.set_status( static_cast<fc::http::reply::status_code>( result.status ) );
+      for( const auto& header : result.headers )
+         resp.add_header( header.first, header.second );
+      resp.set_length( result.body.size() );
+      resp.write( result.body.data(), result.body.size() );
+   });
+   _server.listen( ep );
+}
+
+http_get_server::response http_get_server::handle_get( const std::string& path, const std::string& if_none_match )const
+{
+   response result;
+   fc::optional<cached_body> body;
+   try
+   {
+      body = find_body( path.substr( 0, path.find( '?' ) ) );
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "Failed to serve ${p}: ${e}", ("p",path)("e",e.to_detail_string()) );
+      result.status = 500;
+   }
+   if( !body )
+   {
+      result.headers.emplace_back( "Cache-Control", "no-store" );
+      return result;
+   }
+
+   result.headers.emplace_back( "ETag", body->etag );
+   result.headers.emplace_back( "Cache-Control", "public, max-age=31536000, immutable" );
+   if( !if_none_match.empty() && etag_matches( if_none_match, body->etag ) )
+   {
+      result.status = 304;
+      return result;
+   }
+   result.status = 200;
+   result.headers.emplace_back( "Content-Type", "application/json" );
+   result.body = std::move( body->json );
+   return result;
+}
+
+fc::optional<http_get_server::cached_body> http_get_server::find_body( const std::string& path )const
+{
+   const auto separator = path.find( '/', 1 );
+   if( path.empty() || path[0] != '/' || separator == std::string::npos )
+      return {};
+   const std::string kind = path.substr( 1, separator - 1 );
+   const std::string arg = path.substr( separator + 1 );
+
+   const auto& db = *_app.chain_database();
+   const uint32_t last_irreversible = db.get_dynamic_global_properties().last_irreversible_block_num;
+
+   auto serialize = []( const fc::variant& v ) {
+      cached_body result;
+      result.json = fc::json::to_string( v );
+      result.etag = "\"" + fc::sha256::hash( result.json ).str() + "\"";
+      return fc::optional<cached_body>( std::move( result ) );
+   };
+   // must only be used for the data of irreversible blocks, which never changes
+   auto cached = [this,&path]( const std::function<fc::optional<cached_body>()>& make ) {
+      if( nullptr == _cache )
+         return make();
+      return _cache->get_immutable< fc::optional<cached_body> >( "GET " + path, make );
+   };
+
+   if( kind == "block" || kind == "block_header" || kind == "block_operations" )
+   {
+      const auto block_num = parse_block_num( arg );
+      if( !block_num || *block_num > last_irreversible )
+         return {};
+      const uint32_t num = *block_num;
+      return cached( [this,&db,&kind,&serialize,num]() -> fc::optional<cached_body> {
+         if( kind == "block_operations" )
+         {
+            auto plugin = _app.get_plugin<block_operations::block_operations_plugin>( "block_operations" );
+            if( !plugin )
+               return {};
+            auto ops = plugin->get_block_operations( num );
+            if( !ops )
+               return {};
+            return serialize( fc::variant( *ops, GRAPHENE_MAX_NESTED_OBJECTS ) );
+         }
+         auto block = db.fetch_block_by_number( num );
+         if( !block )
+            return {};
+         if( kind == "block" )
+            return serialize( fc::variant( *block, GRAPHENE_MAX_NESTED_OBJECTS ) );
+         return serialize( fc::variant( static_cast<const chain::block_header&>( *block ),
+                                        GRAPHENE_MAX_NESTED_OBJECTS ) );
+      });
+   }
+
+   if( kind == "operation" )
+   {
+      if( !_app.is_plugin_enabled( "account_history" ) )
+         return {};
+      graphene::db::object_id_type id;
+      try
+      {
+         id = fc::variant( arg, 1 ).as<graphene::db::object_id_type>( 1 );
+      }
+      catch( const fc::exception& )
+      {
+         return {};
+      }
+      if( !id.is<chain::operation_history_id_type>() )
+         return {};
+      const auto* op = db.find( chain::operation_history_id_type( id ) );
+      if( op == nullptr || op->block_num > last_irreversible )
+         return {};
+      return cached( [op,&serialize]() {
+         return serialize( fc::variant( *op, GRAPHENE_MAX_NESTED_OBJECTS ) );
+      });
+   }
+
+   return {};
+}
+
+} } // graphene::app
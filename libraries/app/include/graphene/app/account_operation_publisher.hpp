@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/api_objects.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace graphene { namespace app {
+
+   /**
+    * @class account_operation_publisher
+    * @brief Pushes the new operations of subscribed accounts to their subscribers once per block
+    *
+    * After each applied block the publisher walks the real and virtual operations of the block with the accounts
+    * impacted by them and routes each operation to the subscriptions of these accounts through an index by account
+    * ID, so that the cost per block does not depend on the number of subscriptions which are not impacted. Every
+    * operation is serialized once, no matter how many subscriptions receive it. A subscription receives the
+    * operations of a block which impact at least one of its accounts in the order they were applied.
+    */
+   class account_operation_publisher
+   {
+      public:
+         using callback_type = std::function<void(const fc::variant&)>;
+
+         explicit account_operation_publisher( graphene::chain::database& db );
+
+         /// @return the ID of the new subscription
+         uint64_t subscribe( const std::set<account_id_type>& accounts, callback_type callback );
+         void unsubscribe( uint64_t subscription_id );
+
+         /// @return the number of distinct accounts which are subscribed
+         size_t account_count()const;
+
+      private:
+         struct subscription
+         {
+            std::set<account_id_type> accounts;
+            callback_type             callback;
+         };
+
+         void on_applied_block( const signed_block& block );
+
+         graphene::chain::database&                        _db;
+         mutable std::mutex                                _mutex;
+         uint64_t                                          _next_subscription_id = 0;
+         std::map< uint64_t, subscription >                _subscriptions;
+         std::map< account_id_type, std::set<uint64_t> >   _subscriptions_by_account;
+
+         boost::signals2::scoped_connection                _applied_block_connection;
+   };
+
+} } // graphene::app
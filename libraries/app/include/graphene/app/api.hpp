@@ -23,14 +23,18 @@
  */
 #pragma once
 
+#include <graphene/app/block_production_metrics.hpp>
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/transaction_submission_queue.hpp>
 
 #include <graphene/protocol/types.hpp>
 #include <graphene/protocol/confidential.hpp>
 
+#include <graphene/account_history/account_history_plugin.hpp>
 #include <graphene/market_history/market_history_plugin.hpp>
 #include <graphene/grouped_orders/grouped_orders_plugin.hpp>
 #include <graphene/custom_operations/custom_operations_plugin.hpp>
+#include <graphene/block_operations/block_operations_plugin.hpp>
 
 #include <graphene/elasticsearch/elasticsearch_plugin.hpp>
 
@@ -97,6 +101,22 @@ namespace graphene { namespace app {
       vector<operation_history_object> operation_history_objs;
    };
 
+   /// The new operations of one account in an @ref account_history_batch
+   struct account_history_progress
+   {
+      account_id_type                   account;
+      /// sequence number of the last listed operation of the account, the cursor to pass to the next call
+      uint64_t                          sequence = 0;
+      bool                              complete = true; ///< false if there are more new operations of the account
+      vector<operation_history_id_type> operations;      ///< IDs of the listed operations, oldest first
+   };
+
+   struct account_history_batch
+   {
+      vector<account_history_progress> accounts;   ///< in the order of the request, unknown accounts are left out
+      vector<operation_history_object> operations; ///< the listed operations of all accounts, oldest first, once each
+   };
+
    /**
     * @brief summary data of a group of limit orders
     */
@@ -140,6 +160,17 @@ namespace graphene { namespace app {
             operation_history_id_type start = operation_history_id_type()
          )const;
 
+         /**
+          * @brief Same as @ref get_account_history, but every operation history object is serialized with fc::raw,
+          *        which is much smaller and cheaper to process than JSON
+          */
+         vector<vector<char>> get_packed_account_history(
+            const std::string account_name_or_id,
+            operation_history_id_type stop = operation_history_id_type(),
+            uint32_t limit = 100,
+            operation_history_id_type start = operation_history_id_type()
+         )const;
+
          /**
           * @brief Get operations relevant to the specified account filtering by operation type
           * @param account_name_or_id The account name or ID whose history should be queried
@@ -191,6 +222,49 @@ namespace graphene { namespace app {
                                                                         uint32_t limit = 100,
                                                                         uint64_t start = 0) const;
 
+         /**
+          * @brief Get the new operations of many accounts at once
+          * @param cursors Pairs of the name or ID of an account and the sequence number of the last operation of the
+          *                account which the caller has seen, 0 to start with the first operation of the account
+          * @param limit Maximum number of distinct operations to retrieve, the maximum limit can be configured with
+          *              the "api-limit-get-relative-account-history" option
+          * @return The operations which follow the cursors, from oldest to most recent over all accounts, and the
+          *         cursors to pass in the next call
+          *
+          * The number of accounts is limited by the "api-limit-get-account-history-batch" option. An operation which
+          * is relevant to several of the accounts is listed once. If the limit is reached, the accounts which have
+          * more new operations are marked as incomplete.
+          */
+         account_history_batch get_account_history_batch( const vector<std::pair<std::string,uint64_t>>& cursors,
+                                                          uint32_t limit = 100 )const;
+
+         /**
+          * @brief Get the operations applied by a block, including virtual operations and operation results
+          * @param block_num Height of the block
+          * @return The operations of the block in the order they were applied
+          *
+          * This API requires the "block_operations" plugin. Blocks which were applied before the plugin was enabled
+          * are not available.
+          */
+         vector<operation_history_object> get_block_operations( uint32_t block_num )const;
+
+         /**
+          * @brief Get the backlog of the deferred trimming of account histories
+          * @return The accounts and operations which wait to be removed from memory, and the number of removed ones
+          *
+          * This API requires the "account_history" plugin. The backlog is only used if the
+          * "account-history-trim-batch-size" option is set.
+          */
+         account_history::account_history_trim_metrics get_account_history_trim_metrics()const;
+
+         /**
+          * @brief Get the latencies of the queries of account histories which are sent to Elastic Search
+          * @return The number of queries in flight and completed, and the time they waited and took to run
+          *
+          * This API requires the "elasticsearch" plugin.
+          */
+         elasticsearch::elasticsearch_query_metrics get_elasticsearch_query_metrics()const;
+
          /**
           * @brief Get details of order executions occurred most recently in a trading pair
           * @param a Asset symbol or ID in a trading pair
@@ -279,7 +353,35 @@ namespace graphene { namespace app {
                optional<uint32_t> limit = 101,
                optional<int64_t> operation_type = optional<int64_t>() )const;
 
+         /**
+          * @brief Get the aggregated history of a liquidity pool, which is older than its detailed history
+          * @param pool_id ID of the liquidity pool to query
+          * @param start A UNIX timestamp. Optional.
+          *              If specified, only the intervals which started not later than this time will be returned.
+          * @param stop  A UNIX timestamp. Optional.
+          *              If specified, only the intervals which started later than this time will be returned.
+          * @param limit Maximum quantity of intervals to retrieve.
+          *              Optional. If not specified, at most 101 records will be returned.
+          * @return aggregates of the operations of the liquidity pool per interval, ordered by time, most recent
+          *         first. Empty unless the "liquidity-pool-history-compaction-interval" option is set.
+          *
+          * @note
+          * 1. The time must be UTC. The range is (stop, start].
+          * 2. The operations which are still in the detailed history returned by @ref get_liquidity_pool_history
+          *    are not included in the intervals.
+          * 3. Can only omit one or more arguments in the end of the list, but not one or more in the middle.
+          *    If need to not specify an individual argument, can specify \c null in the place.
+          */
+         vector<liquidity_pool_history_interval_object> get_liquidity_pool_history_intervals(
+               liquidity_pool_id_type pool_id,
+               optional<fc::time_point_sec> start = optional<fc::time_point_sec>(),
+               optional<fc::time_point_sec> stop = optional<fc::time_point_sec>(),
+               optional<uint32_t> limit = 101 )const;
+
       private:
+           /// @return the account history plugin if it keeps removed operations in its on-disk store, otherwise null
+           std::shared_ptr<account_history::account_history_plugin> get_account_history_store()const;
+
            application& _app;
            graphene::app::database_api database_api;
    };
@@ -287,7 +389,19 @@ namespace graphene { namespace app {
    /**
     * @brief Block api
     */
-   class block_api
+   /// A notification of a stream of blocks, see @ref block_api::stream_blocks
+   struct block_stream_batch
+   {
+      uint64_t             stream_id = 0;
+      uint32_t             first_block_num = 0; ///< the number of the first block of the batch
+      vector<vector<char>> blocks;              ///< consecutive blocks, each one serialized with fc::raw
+      bool                 done = false;        ///< whether this is the last notification of the stream
+   };
+
+   /**
+    * @brief The block_api class implements the RPC API for reading blocks
+    */
+   class block_api : public std::enable_shared_from_this<block_api>
    {
    public:
       block_api(graphene::chain::database& db);
@@ -301,8 +415,65 @@ namespace graphene { namespace app {
           */
       vector<optional<signed_block>> get_blocks(uint32_t block_num_from, uint32_t block_num_to)const;
 
+      /**
+          * @brief Get signed blocks in their binary form, which is much smaller and cheaper to process than JSON
+          * @param block_num_from The lowest block number
+          * @param block_num_to The highest block number
+          * @return A list of blocks from block_num_from till block_num_to, each one serialized with fc::raw,
+          *         or null if the block is unknown
+          */
+      vector<optional<vector<char>>> get_packed_blocks(uint32_t block_num_from, uint32_t block_num_to)const;
+
+      /**
+          * @brief Push a range of blocks in their binary form as a series of notifications
+          * @param callback Callback method which is called with a @ref block_stream_batch for each batch of blocks
+          * @param block_num_from The lowest block number, it must not have been pruned from the block database
+          * @param block_num_to The highest block number, the stream ends early at the head block
+          * @param credit The number of blocks which may be pushed before more are requested with
+          *               @ref add_block_stream_credit
+          * @return The ID of the stream
+          *
+          * Blocks are only pushed while the stream has credit left, so that a client which can not keep up is not
+          * flooded. The last notification of a stream has its done flag set.
+          */
+      uint64_t stream_blocks( std::function<void(const variant&)> callback,
+                              uint32_t block_num_from, uint32_t block_num_to, uint32_t credit );
+
+      /**
+          * @brief Allow a stream to push more blocks
+          * @param stream_id ID of the stream as returned by @ref stream_blocks
+          * @param credit The number of additional blocks
+          */
+      void add_block_stream_credit( uint64_t stream_id, uint32_t credit );
+
+      /**
+          * @brief Stop a stream of blocks
+          * @param stream_id ID of the stream as returned by @ref stream_blocks
+          */
+      void cancel_block_stream( uint64_t stream_id );
+
+      /// The maximum number of blocks in one notification of a stream
+      static constexpr uint32_t max_blocks_per_batch = 100;
+      /// The maximum number of streams of an API session at a time
+      static constexpr size_t max_block_streams = 8;
+
    private:
+      struct block_stream
+      {
+         std::function<void(const variant&)> callback;
+         uint32_t next_block_num = 0;
+         uint32_t last_block_num = 0;
+         uint32_t credit = 0;
+         bool     is_pushing = false;
+      };
+
+      optional<vector<char>> get_packed_block( uint32_t block_num, uint32_t last_irreversible_block_num )const;
+      void schedule_block_stream( uint64_t stream_id );
+      void push_block_stream( uint64_t stream_id );
+
       graphene::chain::database& _db;
+      uint64_t _next_stream_id = 0;
+      std::map<uint64_t, block_stream> _block_streams;
    };
 
 
@@ -330,6 +501,10 @@ namespace graphene { namespace app {
           *
           * The transaction will be checked for validity in the local database prior to broadcasting. If it fails to
           * apply locally, an error will be thrown and the transaction will not be broadcast.
+          *
+          * If the api-transaction-queue-size option is set, the transaction is checked and its signatures are
+          * recovered outside of the main thread, then it is pushed to the database together with other queued
+          * transactions. It is rejected at once if the queue is full.
           */
          void broadcast_transaction(const precomputable_transaction& trx);
 
@@ -364,6 +539,9 @@ namespace graphene { namespace app {
           */
          void on_applied_block( const signed_block& b );
       private:
+         /// Pushes the transaction to the local database directly or through the transaction submission queue
+         void push_transaction( const precomputable_transaction& trx );
+
          boost::signals2::scoped_connection             _applied_block_connection;
          map<transaction_id_type,confirmation_callback> _callbacks;
          application&                                   _app;
@@ -411,6 +589,53 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Get counters for diagnosing slow peers
+          * @return for each connected peer the messages and bytes exchanged by message type, the send queue,
+          *         inventory sizes, fetch latencies and block propagation delays, and a histogram of the
+          *         propagation delays of the blocks accepted during normal operation
+          */
+         fc::variant_object get_metrics() const;
+
+         /**
+          * @brief Get the number, execution time and result size of the calls of every method of database_api,
+          *        history_api and block_api
+          * @return the statistics of every method which was called, ordered by API and method name, empty if
+          *         the api-call-statistics and api-slow-call-threshold-ms options are not set
+          */
+         vector<api_method_statistics> get_api_call_statistics() const;
+
+         /**
+          * @brief Get the counters of the transaction submission queue of network_broadcast_api
+          * @return the queue depth and the numbers of accepted and rejected transactions, all zero if the
+          *         api-transaction-queue-size option is not set
+          */
+         transaction_submission_metrics get_transaction_submission_metrics() const;
+
+         /**
+          * @brief Get the timing of the blocks recently produced by the witnesses of this node
+          * @return for each block, newest first, when its production started relative to the slot time, the time
+          *         spent selecting the transactions, computing the merkle root, signing, applying and broadcasting
+          *         it, and the delay until the first peer requested it
+          */
+         vector<block_production_record> get_block_production_metrics() const;
+
+         /**
+          * @brief Get the stages of the handling of the recently received blocks
+          * @return for each block, newest first, the start and duration of the reading of its message, its
+          *         processing by the P2P node, the call of the application, the precomputation, push_block, the
+          *         applied_block handlers of the plugins and the re-broadcast, empty if the block-trace-size
+          *         option is not set
+          */
+         vector<net::block_trace> get_block_traces() const;
+
+         /**
+          * @brief Get the same stages as @ref get_block_traces in the Chrome trace event format
+          * @return an object which can be saved as a JSON file and loaded in chrome://tracing or Perfetto,
+          *         with one row per block
+          */
+         fc::variant_object get_block_trace_events() const;
+
       private:
          application& _app;
    };
@@ -527,7 +752,7 @@ namespace graphene { namespace app {
          /**
           * @brief Get asset holders count for a specific asset
           * @param asset The specific asset id or symbol
-          * @return Holders count for the specified asset
+          * @return The number of accounts with a non-zero balance of the specified asset
           */
          int get_asset_holders_count( std::string asset )const;
 
@@ -538,9 +763,13 @@ namespace graphene { namespace app {
          vector<asset_holders> get_all_asset_holders() const;
 
       private:
+         int count_asset_holders( asset_id_type asset_id )const;
+
          graphene::app::application& _app;
          graphene::chain::database& _db;
          graphene::app::database_api database_api;
+         /// Ranked holders of the assets, null if the api_helper_indexes plugin is not enabled
+         const graphene::api_helper_indexes::asset_holders_index* asset_holders_index = nullptr;
    };
 
    /**
@@ -688,6 +917,12 @@ FC_REFLECT( graphene::app::verify_range_proof_rewind_result,
         (success)(min_val)(max_val)(value_out)(blind_out)(message_out) )
 FC_REFLECT( graphene::app::history_operation_detail,
             (total_count)(operation_history_objs) )
+FC_REFLECT( graphene::app::account_history_progress,
+            (account)(sequence)(complete)(operations) )
+FC_REFLECT( graphene::app::account_history_batch,
+            (accounts)(operations) )
+FC_REFLECT( graphene::app::block_stream_batch,
+            (stream_id)(first_block_num)(blocks)(done) )
 FC_REFLECT( graphene::app::limit_order_group,
             (min_price)(max_price)(total_for_sale) )
 //FC_REFLECT_TYPENAME( fc::ecc::compact_signature )
@@ -698,17 +933,27 @@ FC_REFLECT( graphene::app::asset_holders, (asset_id)(count) )
 
 FC_API(graphene::app::history_api,
        (get_account_history)
+       (get_packed_account_history)
        (get_account_history_by_operations)
        (get_account_history_operations)
        (get_relative_account_history)
+       (get_account_history_batch)
+       (get_block_operations)
+       (get_account_history_trim_metrics)
+       (get_elasticsearch_query_metrics)
        (get_fill_order_history)
        (get_market_history)
        (get_market_history_buckets)
        (get_liquidity_pool_history)
        (get_liquidity_pool_history_by_sequence)
+       (get_liquidity_pool_history_intervals)
      )
 FC_API(graphene::app::block_api,
        (get_blocks)
+       (get_packed_blocks)
+       (stream_blocks)
+       (add_block_stream_credit)
+       (cancel_block_stream)
      )
 FC_API(graphene::app::network_broadcast_api,
        (broadcast_transaction)
@@ -723,6 +968,12 @@ FC_API(graphene::app::network_node_api,
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (get_metrics)
+       (get_api_call_statistics)
+       (get_transaction_submission_metrics)
+       (get_block_production_metrics)
+       (get_block_traces)
+       (get_block_trace_events)
      )
 FC_API(graphene::app::crypto_api,
        (blind)
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/api.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   /// Statistics of the calls of one database API method which are executed in the API read threads
+   struct api_method_metrics
+   {
+      std::string method;
+      /// calls which wait for a read thread or for the read lock of the database state
+      uint32_t    queued            = 0;
+      /// calls which are being executed
+      uint32_t    running           = 0;
+      /// calls which are done, successfully or not
+      uint64_t    completed         = 0;
+      /// time spent by the completed calls waiting, respectively being executed
+      uint64_t    wait_microseconds = 0;
+      uint64_t    run_microseconds  = 0;
+   };
+
+   /**
+    * @class api_call_metrics
+    * @brief Queue depths and latencies of the database API calls which are executed in the API read threads
+    *
+    * The metrics are shared by all API sessions and may be updated by several threads at once.
+    */
+   class api_call_metrics
+   {
+      public:
+         /// Counts a call as running while it exists, the call must have been counted as queued before
+         class running_scope
+         {
+            public:
+               running_scope( api_call_metrics& metrics, const char* method, fc::time_point queued_at );
+               ~running_scope();
+            private:
+               api_call_metrics& _metrics;
+               const char*       _method;
+               fc::time_point    _started_at;
+         };
+
+         void on_queued( const char* method );
+
+         /// @return the metrics of every method which was called, ordered by method name
+         std::vector<api_method_metrics> get_metrics()const;
+
+      private:
+         mutable std::mutex                          _mutex;
+         std::map< std::string, api_method_metrics > _methods;
+   };
+
+   /// Statistics of all calls of one API method
+   struct api_method_statistics
+   {
+      /// the name of the API and the method, e.g. database_api.get_objects
+      std::string method;
+      uint64_t    calls                = 0;
+      /// calls which threw an exception
+      uint64_t    failures             = 0;
+      /// execution times, the percentiles are upper bounds taken from a histogram with power of 2 buckets
+      uint64_t    total_microseconds   = 0;
+      uint64_t    p50_microseconds     = 0;
+      uint64_t    p99_microseconds     = 0;
+      uint64_t    max_microseconds     = 0;
+      /// sizes of the results of successful calls when packed with fc::raw, the JSON responses are larger
+      uint64_t    total_response_bytes = 0;
+      uint64_t    max_response_bytes   = 0;
+   };
+
+   /**
+    * @class api_call_statistics
+    * @brief Number, execution time and result size of the calls of every method of the instrumented APIs
+    *
+    * Calls which take at least the slow call threshold are logged, if it is not zero. The time spent serializing
+    * the results to JSON and sending them is not included.
+    *
+    * The statistics are shared by all API sessions and may be updated by several threads at once.
+    */
+   class api_call_statistics
+   {
+      public:
+         explicit api_call_statistics( fc::microseconds slow_call_threshold );
+
+         void record( const std::string& method, fc::microseconds duration, uint64_t response_bytes, bool failed );
+
+         /// @return the statistics of every method which was called, ordered by method name
+         std::vector<api_method_statistics> get_statistics()const;
+
+         const fc::microseconds slow_call_threshold;
+
+      private:
+         static constexpr size_t histogram_buckets = 40;
+         struct method_data
+         {
+            api_method_statistics                     stats;
+            /// bucket i counts the calls which took [2^i - 1, 2^(i+1) - 1) microseconds
+            std::array< uint64_t, histogram_buckets > histogram {};
+         };
+
+         mutable std::mutex                   _mutex;
+         std::map< std::string, method_data > _methods;
+   };
+
+   namespace detail {
+
+      struct instrumenting_api_visitor
+      {
+         std::shared_ptr<api_call_statistics> statistics;
+         std::string                          api_name;
+
+         template<typename R, typename... Args>
+         void operator()( const char* name, std::function<R(Args...)>& memb )const
+         {
+            std::function<R(Args...)> inner = memb;
+            auto stats = statistics;
+            std::string method = api_name + "." + name;
+            memb = [inner,stats,method]( Args... args ) -> R {
+               const fc::time_point start = fc::time_point::now();
+               try {
+                  R result = inner( std::forward<Args>( args )... );
+                  stats->record( method, fc::time_point::now() - start, fc::raw::pack_size( result ), false );
+                  return result;
+               } catch( ... ) {
+                  stats->record( method, fc::time_point::now() - start, 0, true );
+                  throw;
+               }
+            };
+         }
+
+         template<typename... Args>
+         void operator()( const char* name, std::function<void(Args...)>& memb )const
+         {
+            std::function<void(Args...)> inner = memb;
+            auto stats = statistics;
+            std::string method = api_name + "." + name;
+            memb = [inner,stats,method]( Args... args ) {
+               const fc::time_point start = fc::time_point::now();
+               try {
+                  inner( std::forward<Args>( args )... );
+                  stats->record( method, fc::time_point::now() - start, 0, false );
+               } catch( ... ) {
+                  stats->record( method, fc::time_point::now() - start, 0, true );
+                  throw;
+               }
+            };
+         }
+      };
+
+   } // detail
+
+   /// Replaces every method of the API with one which records its calls in the statistics
+   template<typename API>
+   void instrument_api( fc::api<API>& api, const std::string& api_name,
+                        const std::shared_ptr<api_call_statistics>& statistics )
+   {
+      api->visit( detail::instrumenting_api_visitor{ statistics, api_name } );
+   }
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::api_method_metrics,
+            (method)(queued)(running)(completed)(wait_microseconds)(run_microseconds) )
+FC_REFLECT( graphene::app::api_method_statistics,
+            (method)(calls)(failures)(total_microseconds)(p50_microseconds)(p99_microseconds)(max_microseconds)
+            (total_response_bytes)(max_response_bytes) )
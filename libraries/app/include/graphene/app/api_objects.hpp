@@ -67,6 +67,8 @@ namespace graphene { namespace app {
       optional<vesting_balance_object> cashback_balance;
       vector<account_balance_object>   balances;
       vector<vesting_balance_object>   vesting_balances;
+      /// The total amount of the vesting balances by asset, only if the api_helper_indexes plugin is enabled
+      vector<asset>                    vesting_balance_totals;
       vector<limit_order_object>       limit_orders;
       vector<call_order_object>        call_orders;
       vector<force_settlement_object>  settle_orders;
@@ -79,6 +81,21 @@ namespace graphene { namespace app {
       more_data                        more_data_available;
    };
 
+   /// The sections of an account which get_full_account_page returns, and where each of them starts
+   struct full_account_query
+   {
+      /// The sections by the names of the fields of full_account, e.g. "balances" or "limit_orders", each with
+      /// the position to start at as returned in full_account_page::next_start, or null to start at the first entry
+      flat_map< string, optional<object_id_type> > sections;
+      uint32_t                                     limit = 100; ///< maximum number of entries of each section
+   };
+
+   struct full_account_page
+   {
+      full_account                       account;    ///< the account with the selected sections only
+      flat_map< string, object_id_type > next_start; ///< where the next page of each unfinished section starts
+   };
+
    struct order
    {
       string                     price;
@@ -94,6 +111,18 @@ namespace graphene { namespace app {
      vector< order >             asks;
    };
 
+   /// The changes of the top levels of an order book and the trades of its market in one block
+   struct order_book_delta
+   {
+      uint32_t                     block_num = 0;
+      string                       base;
+      string                       quote;
+      bool                         is_snapshot = false; ///< whether the levels are the whole top of the book
+      vector< order >              bids;  ///< levels which changed, zero amounts mean the level is gone
+      vector< order >              asks;  ///< levels which changed, zero amounts mean the level is gone
+      vector< fill_order_operation > fills;
+   };
+
    struct market_ticker
    {
       time_point_sec             time;
@@ -162,6 +191,17 @@ namespace graphene { namespace app {
       optional<liquidity_pool_ticker_object> statistics;
    };
 
+   /// The positions of an MPA which would be margin called at a feed price
+   struct margin_call_risk
+   {
+      price                       settlement_price;              ///< the feed price which was assumed
+      price                       maintenance_collateralization; ///< positions at or below it are margin called
+      uint32_t                    position_count = 0;
+      share_type                  total_debt;
+      share_type                  total_collateral;
+      vector< call_order_object > positions; ///< up to the limit, the least collateralized first
+   };
+
 } }
 
 FC_REFLECT( graphene::app::more_data,
@@ -179,6 +219,7 @@ FC_REFLECT( graphene::app::full_account,
             (cashback_balance)
             (balances)
             (vesting_balances)
+            (vesting_balance_totals)
             (limit_orders)
             (call_orders)
             (settle_orders)
@@ -191,8 +232,12 @@ FC_REFLECT( graphene::app::full_account,
             (more_data_available)
           )
 
+FC_REFLECT( graphene::app::full_account_query, (sections)(limit) )
+FC_REFLECT( graphene::app::full_account_page, (account)(next_start) )
+
 FC_REFLECT( graphene::app::order, (price)(quote)(base) )
 FC_REFLECT( graphene::app::order_book, (base)(quote)(bids)(asks) )
+FC_REFLECT( graphene::app::order_book_delta, (block_num)(base)(quote)(is_snapshot)(bids)(asks)(fills) )
 FC_REFLECT( graphene::app::market_ticker,
             (time)(base)(quote)(latest)(lowest_ask)(lowest_ask_base_size)(lowest_ask_quote_size)
             (highest_bid)(highest_bid_base_size)(highest_bid_quote_size)(percent_change)(base_volume)(quote_volume)(mto_id) )
@@ -206,3 +251,5 @@ FC_REFLECT_DERIVED( graphene::app::extended_asset_object, (graphene::chain::asse
 FC_REFLECT_DERIVED( graphene::app::extended_liquidity_pool_object, (graphene::chain::liquidity_pool_object),
                     (statistics) )
 
+FC_REFLECT( graphene::app::margin_call_risk,
+            (settlement_price)(maintenance_collateralization)(position_count)(total_debt)(total_collateral)(positions) )
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace graphene { namespace app {
+
+   /**
+    * @class api_response_cache
+    * @brief Results of read-only API calls which only depend on the head block, shared by all API sessions
+    *
+    * The cache is emptied whenever a block is applied, so a cached result does not reflect transactions which
+    * were pushed after it was computed and before the next block. Results are cached until @ref max_entries
+    * entries are stored, further results are computed but not stored until the next block.
+    *
+    * Results which never change, e.g. irreversible blocks, are kept in a second part of the cache across blocks.
+    * When it holds @ref max_immutable_entries results, the oldest one is dropped to make room for a new one.
+    *
+    * The cache may be used by several threads at once.
+    */
+   class api_response_cache
+   {
+      public:
+         api_response_cache( graphene::chain::database& db, size_t max_entries_per_block,
+                             size_t max_immutable_entries_to_keep );
+
+         /**
+          * @param key identifies the call and its parameters, all calls with the same key must return RESULT
+          * @param call computes the result if it is not cached
+          * @return the cached result of the call
+          */
+         template<typename RESULT, typename CALL>
+         RESULT get( const std::string& key, CALL&& call )
+         {
+            uint64_t generation;
+            {
+               std::lock_guard<std::mutex> guard( _mutex );
+               auto itr = _entries.find( key );
+               if( itr != _entries.end() )
+                  return *std::static_pointer_cast<const RESULT>( itr->second );
+               generation = _generation;
+            }
+            auto result = std::make_shared<const RESULT>( call() );
+            std::lock_guard<std::mutex> guard( _mutex );
+            // do not store results which were computed before the last block
+            if( generation == _generation && _entries.size() < max_entries )
+               _entries.emplace( key, result );
+            return *result;
+         }
+
+         /// Same as @ref get, but for calls whose results never change, they are kept across blocks
+         template<typename RESULT, typename CALL>
+         RESULT get_immutable( const std::string& key, CALL&& call )
+         {
+            {
+               std::lock_guard<std::mutex> guard( _mutex );
+               auto itr = _immutable_entries.find( key );
+               if( itr != _immutable_entries.end() )
+                  return *std::static_pointer_cast<const RESULT>( itr->second );
+            }
+            auto result = std::make_shared<const RESULT>( call() );
+            if( 0 == max_immutable_entries )
+               return *result;
+            std::lock_guard<std::mutex> guard( _mutex );
+            if( _immutable_entries.emplace( key, result ).second )
+            {
+               _immutable_keys.push_back( key );
+               if( _immutable_keys.size() > max_immutable_entries )
+               {
+                  _immutable_entries.erase( _immutable_keys.front() );
+                  _immutable_keys.pop_front();
+               }
+            }
+            return *result;
+         }
+
+         /// Removes all entries which depend on the head block
+         void clear();
+
+         /// @return the number of cached results which depend on the head block
+         size_t size()const;
+         /// @return the number of cached results which never change
+         size_t immutable_size()const;
+
+         const size_t max_entries;
+         const size_t max_immutable_entries;
+
+      private:
+         mutable std::mutex                                   _mutex;
+         std::map< std::string, std::shared_ptr<const void> > _entries;
+         /// Incremented whenever the cache is emptied
+         uint64_t                                             _generation = 0;
+         std::map< std::string, std::shared_ptr<const void> > _immutable_entries;
+         /// The keys of @ref _immutable_entries in insertion order
+         std::deque< std::string >                            _immutable_keys;
+         boost::signals2::scoped_connection                   _applied_block_connection;
+   };
+
+} } // graphene::app
@@ -35,10 +35,23 @@ namespace graphene { namespace app {
 
    class abstract_plugin;
 
+   class api_call_metrics;
+   class api_call_statistics;
+   class account_operation_publisher;
+   class api_response_cache;
+   class block_event_bus;
+   class block_production_metrics;
+   class object_notification_cache;
+   class order_book_cache;
+   class order_book_delta_publisher;
+   class transaction_submission_queue;
+
    class application_options
    {
       public:
          bool enable_subscribe_to_all = false;
+         /// Whether the object and market notifications of a session which are due at the same time are sent as one
+         bool batch_notifications = false;
 
          bool has_api_helper_indexes_plugin = false;
          bool has_market_history_plugin = false;
@@ -47,6 +60,7 @@ namespace graphene { namespace app {
          uint64_t api_limit_get_account_history = 100;
          uint64_t api_limit_get_grouped_limit_orders = 101;
          uint64_t api_limit_get_relative_account_history = 100;
+         uint64_t api_limit_get_account_history_batch = 1000;
          uint64_t api_limit_get_account_history_by_operations = 100;
          uint64_t api_limit_get_asset_holders = 100;
          uint64_t api_limit_get_key_references = 100;
@@ -77,6 +91,35 @@ namespace graphene { namespace app {
          uint64_t api_limit_get_liquidity_pool_history = 101;
          uint64_t api_limit_get_samet_funds = 101;
          uint64_t api_limit_get_credit_offers = 101;
+         uint64_t api_limit_get_signatures_batch = 100;
+         uint64_t api_limit_get_object_fields = 1000;
+         uint64_t api_limit_get_tickers = 500;
+         uint64_t api_limit_subscribe_to_account_operations = 1000;
+
+         /// Threads which execute heavy read-only database API calls, if empty they are executed in the main thread
+         std::vector<std::shared_ptr<fc::thread>> api_read_threads;
+         /// Queue depths and latencies of the calls executed in the API read threads, null if there are none
+         std::shared_ptr<api_call_metrics> api_read_metrics;
+         /// Statistics of the calls of database_api, history_api and block_api, null if they are not collected
+         std::shared_ptr<api_call_statistics> api_call_stats;
+         /// Objects reported by the object change signals, serialized once for all subscribed API sessions
+         std::shared_ptr<object_notification_cache> notification_cache;
+         /// Order books of recently queried markets, null if they are not cached
+         std::shared_ptr<order_book_cache> order_books;
+         /// Changes of subscribed order books, computed once per block for all subscribed API sessions
+         std::shared_ptr<order_book_delta_publisher> order_book_deltas;
+         /// New operations of subscribed accounts, routed and serialized once per block for all API sessions
+         std::shared_ptr<account_operation_publisher> account_operations;
+         /// Results of read-only database API calls shared by all API sessions, null if caching is disabled
+         std::shared_ptr<api_response_cache> response_cache;
+         /// Transactions received by network_broadcast_api, null if they are pushed to the database synchronously
+         std::shared_ptr<transaction_submission_queue> transaction_submissions;
+         /// Timing of the blocks recently produced by the witnesses of this node
+         std::shared_ptr<block_production_metrics> block_production;
+         /// Stages of the handling of the recently received blocks, null if they are not traced
+         std::shared_ptr<net::block_tracer> block_traces;
+         /// Applied blocks with their operations and object changes, for plugins which consume them asynchronously
+         std::shared_ptr<block_event_bus> block_events;
 
          static const application_options& get_default()
          {
@@ -152,8 +195,6 @@ namespace graphene { namespace app {
 
          bool is_plugin_enabled(const string& name) const;
 
-         std::shared_ptr<fc::thread> elasticsearch_thread;
-
    private:
          /// Add an available plugin
          void add_available_plugin( std::shared_ptr<abstract_plugin> p ) const;
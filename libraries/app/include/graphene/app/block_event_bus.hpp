@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace graphene { namespace app {
+
+   /// The data of an applied block as published by a @ref block_event_bus, it is not modified after publication
+   struct block_event
+   {
+      signed_block                                          block;
+      /// The operations of the block, as returned by @ref graphene::chain::database::get_applied_operations
+      vector< optional< operation_history_object > >        operations;
+      /// Copies of the objects which were created or changed by the block as they are after it, and of the objects
+      /// which were removed by it. They are only filled if a consumer of the bus asked for them, and stay empty while
+      /// the chain is replayed since object changes are not reported then.
+      vector< std::shared_ptr<const graphene::db::object> > new_objects;
+      vector< std::shared_ptr<const graphene::db::object> > changed_objects;
+      vector< std::shared_ptr<const graphene::db::object> > removed_objects;
+   };
+
+   /// Counters of a consumer of a @ref block_event_bus
+   struct block_event_consumer_metrics
+   {
+      string   name;
+      /// events which are being consumed or wait to be consumed
+      uint32_t queued                      = 0;
+      uint32_t max_queue_size              = 0;
+      uint64_t consumed                    = 0;
+      /// events whose consumer threw an exception
+      uint64_t failed                      = 0;
+      /// number of times the chain thread waited because the queue was full, and the total time it waited
+      uint64_t publisher_waits             = 0;
+      int64_t  publisher_wait_microseconds = 0;
+   };
+
+   /**
+    * @class block_event_bus
+    * @brief Publishes every applied block with its operations and object changes to consumers on their own threads
+    *
+    * The synchronous signals of the database make the block processing wait for the slowest observer. Observers
+    * which do not modify the database can consume a @ref block_event instead, which is collected from the signals of
+    * a block and published once all of them were emitted. Each consumer has a thread and a bounded queue of events.
+    * When the queue of a consumer is full the chain thread waits for it, so that a slow consumer applies
+    * back-pressure instead of falling behind without bounds. Consumers must therefore not wait for the chain thread.
+    *
+    * Events are published in the order the blocks are applied. A block which is applied again after a chain
+    * reorganization is published again, consumers keep the last event of a block number.
+    *
+    * Consumers may be added and removed by any thread.
+    */
+   class block_event_bus
+   {
+      public:
+         using consumer_type = std::function<void(const block_event&)>;
+
+         explicit block_event_bus( graphene::chain::database& db );
+         ~block_event_bus();
+
+         /**
+          * @param name the name of the consumer and of its thread
+          * @param consumer called in the thread of the consumer for every published event
+          * @param max_queue_size the number of events which may wait for the consumer, at least 1
+          * @param with_objects whether the consumer needs the objects of the events
+          * @return the ID of the consumer
+          */
+         uint64_t add_consumer( const string& name, consumer_type consumer, uint32_t max_queue_size,
+                                bool with_objects );
+         /// Waits until the queued events of the consumer were consumed, then removes it
+         void remove_consumer( uint64_t consumer_id );
+
+         vector<block_event_consumer_metrics> get_metrics()const;
+
+      private:
+         struct consumer;
+         using object_list = vector< std::shared_ptr<const graphene::db::object> >;
+
+         void on_applied_block( const signed_block& block );
+         void on_objects( object_list block_event::* list, const vector<object_id_type>& ids,
+                          const vector<const graphene::db::object*>* objs );
+         void on_block_notifications_finished();
+
+         graphene::chain::database&                        _db;
+         mutable std::mutex                                _mutex;
+         std::map< uint64_t, std::shared_ptr<consumer> >   _consumers;
+         uint64_t                                          _next_consumer_id = 0;
+         /// the event of the block whose notifications are being emitted, only used by the chain thread
+         std::shared_ptr<block_event>                      _current;
+         bool                                              _current_with_objects = false;
+
+         boost::signals2::scoped_connection                _applied_block_connection;
+         boost::signals2::scoped_connection                _new_connection;
+         boost::signals2::scoped_connection                _change_connection;
+         boost::signals2::scoped_connection                _removed_connection;
+         boost::signals2::scoped_connection                _finished_connection;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::block_event_consumer_metrics,
+            (name)(queued)(max_queue_size)(consumed)(failed)(publisher_waits)(publisher_wait_microseconds) )
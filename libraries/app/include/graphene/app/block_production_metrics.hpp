@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   /// Timing of the production of one block by a witness of this node
+   struct block_production_record
+   {
+      uint32_t                     block_num = 0;
+      protocol::block_id_type      block_id;
+      fc::time_point_sec           slot_time;
+      /// time between the slot time and the start of the production, negative if it started early
+      int64_t                      wakeup_drift_microseconds = 0;
+      /// selecting and applying the pending transactions, zero if they were prepared in advance
+      uint64_t                     select_transactions_microseconds = 0;
+      uint64_t                     merkle_root_microseconds = 0;
+      uint64_t                     sign_microseconds = 0;
+      /// applying the new block
+      uint64_t                     push_block_microseconds = 0;
+      bool                         candidate_used = false;
+      uint32_t                     transactions = 0;
+      /// time spent handing the block to the P2P node, zero until it is done
+      uint64_t                     broadcast_microseconds = 0;
+      /// time between the broadcast and the first request of the block by a peer, unset until a peer requested it
+      fc::optional<uint64_t>       first_request_microseconds;
+   };
+
+   /**
+    * @class block_production_metrics
+    * @brief The timing of the blocks recently produced by the witnesses of this node
+    *
+    * The records are added by the witness plugin and may be read by several threads at once.
+    */
+   class block_production_metrics
+   {
+      public:
+         static constexpr size_t max_records = 100;
+
+         void add_record( const block_production_record& record );
+         void set_broadcast_time( const protocol::block_id_type& block_id, fc::microseconds duration );
+         void set_first_request_time( const protocol::block_id_type& block_id, fc::microseconds delay );
+
+         /// @return the recently produced blocks, newest first
+         std::vector<block_production_record> get_records()const;
+
+      private:
+         block_production_record* find( const protocol::block_id_type& block_id );
+
+         mutable std::mutex                    _mutex;
+         std::deque<block_production_record>   _records;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::block_production_record,
+            (block_num)(block_id)(slot_time)(wakeup_drift_microseconds)(select_transactions_microseconds)
+            (merkle_root_microseconds)(sign_microseconds)(push_block_microseconds)(candidate_used)(transactions)
+            (broadcast_microseconds)(first_request_microseconds) )
@@ -23,6 +23,7 @@
  */
 #pragma once
 
+#include <graphene/app/api_call_metrics.hpp>
 #include <graphene/app/api_objects.hpp>
 
 #include <graphene/protocol/types.hpp>
@@ -39,6 +40,7 @@
 #include <graphene/chain/ticket_object.hpp>
 #include <graphene/chain/worker_object.hpp>
 #include <graphene/chain/witness_object.hpp>
+#include <graphene/chain/witness_schedule_object.hpp>
 
 #include <fc/api.hpp>
 #include <fc/variant_object.hpp>
@@ -92,6 +94,19 @@ class database_api
       fc::variants get_objects( const vector<object_id_type>& ids,
                                 optional<bool> subscribe = optional<bool>() )const;
 
+      /**
+       * @brief Get selected fields of the objects corresponding to the provided IDs
+       * @param ids IDs of the objects to retrieve, the number of IDs is limited by the
+       *            "api-limit-get-object-fields" option
+       * @param fields Names of the top-level fields to return, e.g. "id" and "name", all fields if empty
+       * @return The selected fields of the objects retrieved, in the order they are mentioned in ids
+       *
+       * If any of the provided IDs does not map to an object, a null variant is returned in its position.
+       * Fields which the object does not have are omitted.
+       * This function doesn't subscribe.
+       */
+      fc::variants get_object_fields( const vector<object_id_type>& ids, const flat_set<string>& fields )const;
+
       ///////////////////
       // Subscriptions //
       ///////////////////
@@ -141,10 +156,27 @@ class database_api
        * @param cb The callback handle to register
        */
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
+      /**
+       * @brief Request the new operations of a set of accounts as they are applied
+       * @param callback Callback method which is called once per block with the operations of the block which
+       *                 impact at least one of the accounts
+       * @param account_names_or_ids names or IDs of the accounts, the maximum number can be configured with the
+       *                             "api-limit-subscribe-to-account-operations" option
+       *
+       * Callback will be passed a variant containing a vector<operation_history_object> with the real and virtual
+       * operations in the order they were applied, the history fields which are assigned by the account history
+       * plugin are not set. A session has one such subscription, subscribing again replaces it.
+       */
+      void subscribe_to_account_operations( std::function<void(const variant&)> callback,
+                                            const vector<std::string>& account_names_or_ids );
+      /**
+       * @brief Stop receiving the operations of the accounts subscribed with @ref subscribe_to_account_operations
+       */
+      void unsubscribe_from_account_operations();
       /**
        * @brief Stop receiving any notifications
        *
-       * This unsubscribes from all subscribed markets and objects.
+       * This unsubscribes from all subscribed markets, accounts and objects.
        */
       void cancel_all_subscriptions();
 
@@ -220,6 +252,41 @@ class database_api
        */
       dynamic_global_property_object get_dynamic_global_properties()const;
 
+      /**
+       * @brief Get a summary of the head of the chain
+       * @return the head block, the last irreversible block and the state of the witness schedule
+       *
+       * The summary is published by the node after every block, so unlike the other calls this one does not wait
+       * for the block which is being applied.
+       */
+      head_state get_head_state()const;
+
+      /**
+       * @brief Get an estimate of the memory used by each object index of the node
+       * @return the object count and the estimated memory usage in bytes of every index, ordered by space and type
+       *
+       * The figures cover the objects and the container nodes of the indexes, the secondary indexes which report
+       * their size, and the pre-images kept in undo states. Memory owned by members of the objects, e.g. the
+       * content of strings and vectors, is not included.
+       */
+      vector<graphene::db::index_memory_usage> get_index_memory_usage()const;
+
+      /**
+       * @brief Get the cost of each phase of the latest maintenances processed by the node
+       * @return the maintenance profiles, the latest last
+       *
+       * The numbers of objects visited and modified by a phase are the same on all nodes, the time spent depends
+       * on the node. The number of profiles kept is set by the maintenance-profile-history option.
+       */
+      vector<maintenance_profile> get_maintenance_profiles()const;
+
+      /**
+       * @brief Get the queue depths and latencies of the calls executed in the API read threads of the node
+       * @return the metrics of every method which was called, ordered by method name, empty if the node has
+       *         no API read threads, see the api-read-threads option
+       */
+      vector<api_method_metrics> get_api_read_metrics()const;
+
       //////////
       // Keys //
       //////////
@@ -282,6 +349,22 @@ class database_api
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids,
                                                        optional<bool> subscribe = optional<bool>() );
 
+      /**
+       * @brief Fetch pages of selected lists of objects relevant to an account
+       * @param account_name_or_id name or ID of the account
+       * @param query the lists to fetch, by the names of the fields of @ref full_account, each with the position to
+       *              start at, and the maximum number of entries of each list; the limit can be configured with the
+       *              "api-limit-get-full-accounts-lists" option
+       * @return The account with the selected lists, and for each list which has more entries, the position where
+       *         its next page starts
+       *
+       * Unlike @ref get_full_accounts this function only collects the requested lists and lets clients continue
+       * truncated lists. It does not subscribe to the account. The positions are object IDs, except for the
+       * balances and the call orders, whose positions are the IDs of their assets.
+       */
+      full_account_page get_full_account_page( const std::string& account_name_or_id,
+                                               const full_account_query& query )const;
+
       /**
        * @brief Returns vector of voting power sorted by reverse vp_active
        * @param limit Max number of results
@@ -328,6 +411,19 @@ class database_api
                                                    uint32_t limit,
                                                    optional<bool> subscribe = optional<bool>() )const;
 
+      /**
+       * @brief Find registered accounts by a part of their names, e.g. for autocompletion
+       * @param text The start of the names, or any part of them if @p match_substrings is true, ignoring case
+       * @param limit Maximum number of results to return, it is limited by the "api-limit-lookup-accounts" option
+       * @param match_substrings @a true to find the names which contain @p text, which requires the
+       *                         api_helper_indexes plugin and at least 3 characters; @a false or @a null to find
+       *                         the names which start with it
+       * @return Map of account names to corresponding IDs, of the first names in alphabetical order which start
+       *         with the text, or of the oldest accounts whose names contain it
+       */
+      map<string,account_id_type> search_accounts( const string& text, uint32_t limit,
+                                                   optional<bool> match_substrings = optional<bool>() )const;
+
       //////////////
       // Balances //
       //////////////
@@ -366,6 +462,14 @@ class database_api
        */
       vector<vesting_balance_object> get_vesting_balances( const std::string account_name_or_id )const;
 
+      /**
+       * @brief Calculate how much of each of the given vesting balances can be withdrawn at current head block time
+       * @param ids a list of vesting balance object IDs
+       * @return a list with the amount each vesting balance allows to withdraw,
+       *         or null for the IDs of vesting balances which do not exist
+       */
+      vector<optional<asset>> get_vesting_balance_withdrawals( const vector<vesting_balance_id_type>& ids )const;
+
       /**
        * @brief Get the total number of accounts registered with the blockchain
        */
@@ -403,6 +507,19 @@ class database_api
        */
       vector<extended_asset_object> list_assets(const string& lower_bound_symbol, uint32_t limit)const;
 
+      /**
+       * @brief Find assets by a part of their symbols, e.g. for autocompletion
+       * @param text The start of the symbols, or any part of them if @p match_substrings is true, ignoring case
+       * @param limit Maximum number of assets to fetch, it is limited by the "api-limit-get-assets" option
+       * @param match_substrings @a true to find the symbols which contain @p text, which requires the
+       *                         api_helper_indexes plugin and at least 3 characters; @a false or @a null to find
+       *                         the symbols which start with it
+       * @return The first assets in alphabetical order whose symbols start with the text, or the oldest assets
+       *         whose symbols contain it
+       */
+      vector<extended_asset_object> search_assets( const string& text, uint32_t limit,
+                                                   optional<bool> match_substrings = optional<bool>() )const;
+
       /**
        * @brief Get a list of assets by symbol names or IDs
        * @param symbols_or_ids symbol names or IDs of the assets to retrieve
@@ -545,6 +662,22 @@ class database_api
        */
       vector<call_order_object> get_margin_positions( const std::string account_name_or_id )const;
 
+      /**
+       * @brief Get the margin positions of an MPA which would be margin called at a feed price
+       * @param asset_symbol_or_id symbol name or ID of the MPA
+       * @param settlement_price the assumed settlement price of the feed, in the MPA per its backing asset,
+       *                         null to use the current feed
+       * @param limit Maximum number of positions to retrieve, the counts and totals cover all of them
+       * @return The number of the positions which would be margin called, their total debt and collateral, and
+       *         the least collateralized of them
+       *
+       * @note This API call requires the @a api_helper_indexes plugin. The maintenance collateral ratio of the
+       *       current feed applies.
+       */
+      margin_call_risk get_margin_call_risk( const std::string& asset_symbol_or_id,
+                                             const optional<price>& settlement_price,
+                                             const optional<uint32_t>& limit = 101 )const;
+
       /**
        * @brief Request notification when the active orders in the market between two assets changes
        * @param callback Callback method which is called when the market changes
@@ -564,6 +697,29 @@ class database_api
        */
       void unsubscribe_from_market( const std::string& a, const std::string& b );
 
+      /**
+       * @brief Request the changes of the top levels of an order book and the trades of its market once per block
+       * @param callback Callback method which is called with an @ref order_book_delta after each block which changed
+       *                 the top levels or filled orders of the market
+       * @param base symbol name or ID of the base asset
+       * @param quote symbol name or ID of the quote asset
+       * @param depth the number of price levels of each side of the book to track, the maximum limit can be
+       *              configured with the "api-limit-get-order-book" option
+       *
+       * The first delta after subscribing is a snapshot of the top levels. A later delta only contains the levels
+       * whose amounts changed, a level with zero amounts is gone or dropped out of the top levels. A session
+       * subscribes with one depth per market, subscribing again replaces the previous subscription.
+       */
+      void subscribe_to_order_book_deltas( std::function<void(const variant&)> callback,
+                                           const std::string& base, const std::string& quote, uint32_t depth );
+
+      /**
+       * @brief Unsubscribe from the deltas of an order book
+       * @param base symbol name or ID of the base asset
+       * @param quote symbol name or ID of the quote asset
+       */
+      void unsubscribe_from_order_book_deltas( const std::string& base, const std::string& quote );
+
       /**
        * @brief Returns the ticker for the market assetA:assetB
        * @param base symbol name or ID of the base asset
@@ -572,6 +728,14 @@ class database_api
        */
       market_ticker get_ticker( const string& base, const string& quote )const;
 
+      /**
+       * @brief Returns the tickers of many markets at once
+       * @param markets pairs of the symbol names or IDs of the base and the quote asset of the markets,
+       *                the number of markets is limited by the "api-limit-get-tickers" option
+       * @return The market tickers for the past 24 hours, in the order of @p markets
+       */
+      vector<market_ticker> get_tickers( const vector<std::pair<string, string>>& markets )const;
+
       /**
        * @brief Returns the 24 hour volume for the market assetA:assetB
        * @param base symbol name or ID of the base asset
@@ -787,6 +951,22 @@ class database_api
             optional<asset_id_type> start_id = optional<asset_id_type>(),
             optional<bool> with_statistics = false )const;
 
+      /**
+       * @brief Calculate what selling amounts to a liquidity pool would pay and receive
+       * @param pool_id ID of the liquidity pool
+       * @param amounts_to_sell the amounts to sell, each in asset A or B of the pool
+       * @return the results of the exchanges, in the order of @p amounts_to_sell
+       *
+       * @note
+       * 1. every exchange is calculated against the current state of the pool, independent of the others
+       * 2. whether the seller is authorized to hold the assets, and whether the market is whitelisted or
+       *    blacklisted, is not checked
+       * 3. the number of amounts can not be greater than the configured limit of the liquidity pool queries
+       */
+      vector<liquidity_pool_exchange_quote> get_liquidity_pool_exchange_quotes(
+            liquidity_pool_id_type pool_id,
+            const vector<asset>& amounts_to_sell )const;
+
 
       /////////////////////
       /// SameT Funds
@@ -900,6 +1080,24 @@ class database_api
             const optional<uint32_t>& limit = 101,
             const optional<credit_offer_id_type>& start_id = optional<credit_offer_id_type>() )const;
 
+      /**
+       * @brief Get the best enabled credit offers which lend an asset and accept a collateral asset
+       * @param asset_symbol_or_id symbol or ID of the asset type to borrow
+       * @param collateral_symbol_or_id symbol or ID of the collateral asset
+       * @param limit  The limitation of items each query can fetch, not greater than a configured value
+       * @return The credit offers, sorted by fee rate, then by current balance in descending order
+       *
+       * @note
+       * 1. if @p asset_symbol_or_id or @p collateral_symbol_or_id cannot be tied to an asset,
+       *    an error will be returned
+       * 2. @p limit can be omitted or be null, if so the default value 101 will be used
+       * 3. This API requires the api_helper_indexes plugin to be enabled on the server
+       */
+      vector<credit_offer_object> get_best_credit_offers(
+            const std::string& asset_symbol_or_id,
+            const std::string& collateral_symbol_or_id,
+            const optional<uint32_t>& limit = 101 )const;
+
       /**
        * @brief Get a list of credit deals
        * @param limit  The limitation of items each query can fetch, not greater than a configured value
@@ -1040,6 +1238,15 @@ class database_api
        */
       uint64_t get_witness_count()const;
 
+      /**
+       * @brief Get the upcoming block production slots
+       * @param limit Maximum number of slots to return -- must not exceed the number of scheduled witnesses
+       * @return The next slots with their times and scheduled witnesses, starting with the next slot
+       *
+       * The witnesses are taken from the current shuffle, which changes when a new round starts.
+       */
+      vector<witness_schedule_slot> get_witness_schedule(uint32_t limit)const;
+
       ///////////////////////
       // Committee members //
       ///////////////////////
@@ -1158,6 +1365,27 @@ class database_api
        */
       set<public_key_type> get_potential_signatures( const signed_transaction& trx )const;
 
+      /**
+       *  Same as @ref get_required_signatures for many transactions at once. The signatures of the transactions
+       *  are recovered in parallel, and the authorities of accounts are looked up once for all transactions.
+       *
+       *  @param trxs the transactions to be signed, the number of transactions is limited by the
+       *              "api-limit-get-signatures-batch" option
+       *  @param available_keys a set of public keys
+       *  @return for each of @p trxs, a subset of @p available_keys that could sign for the transaction
+       */
+      vector<set<public_key_type>> get_required_signatures_batch( const vector<signed_transaction>& trxs,
+                                                      const flat_set<public_key_type>& available_keys )const;
+
+      /**
+       *  Same as @ref get_potential_signatures for many transactions at once.
+       *
+       *  @param trxs the transactions to be signed, the number of transactions is limited by the
+       *              "api-limit-get-signatures-batch" option
+       *  @return for each of @p trxs, a set of public keys that could possibly sign for the transaction
+       */
+      vector<set<public_key_type>> get_potential_signatures_batch( const vector<signed_transaction>& trxs )const;
+
       /**
        *  This method will return the set of all addresses that could possibly sign for a given transaction.
        *
@@ -1207,7 +1435,10 @@ class database_api
        * @brief return a set of proposed transactions (aka proposals) that the specified account
        *        can add approval to or remove approval from
        * @param account_name_or_id The name or ID of an account
-       * @return a set of proposed transactions that the specified account can act on
+       * @return a set of proposed transactions that the specified account can act on, also through the
+       *         authorities of other accounts up to the maximum authority depth
+       *
+       * @note This API will throw an exception if the api_helper_indexes plugin is not enabled
        */
       vector<proposal_object> get_proposed_transactions( const std::string account_name_or_id )const;
 
@@ -1250,6 +1481,21 @@ class database_api
                                                                                 withdraw_permission_id_type start,
                                                                                 uint32_t limit )const;
 
+      /**
+       *  @brief Get the withdraw permission objects of an account in order of expiration
+       *  @param account_name_or_id Account name or ID of the giver or the recipient
+       *  @param start Withdraw permission objects which expire before this time will be skipped in results
+       *  @param limit Maximum number of objects to retrieve, not greater than the limit of
+       *               get_withdraw_permissions_by_giver
+       *  @return Withdraw permission objects for the account, the first to expire first
+       *
+       *  @note This API will throw an exception if the api_helper_indexes plugin is not enabled
+       */
+      vector<withdraw_permission_object> get_withdraw_permissions_by_expiration(
+                                            const std::string account_name_or_id,
+                                            fc::time_point_sec start,
+                                            uint32_t limit )const;
+
       //////////
       // HTLC //
       //////////
@@ -1294,6 +1540,19 @@ class database_api
       */
       vector<htlc_object> list_htlcs(const htlc_id_type start, uint32_t limit) const;
 
+      /**
+       *  @brief Get the HTLC objects of an account in order of expiration
+       *  @param account_name_or_id Account name or ID of the sender or the receiver
+       *  @param start HTLC objects which expire before this time will be skipped in results
+       *  @param limit Maximum number of objects to retrieve
+       *  @return HTLC objects for the account, the first to expire first
+       *
+       *  @note This API will throw an exception if the api_helper_indexes plugin is not enabled
+       */
+      vector<htlc_object> get_htlcs_by_expiration( const std::string account_name_or_id,
+                                                   fc::time_point_sec start,
+                                                   uint32_t limit ) const;
+
 
       /////////////
       // Tickets //
@@ -1343,12 +1602,15 @@ extern template class fc::api<graphene::app::database_api>;
 FC_API(graphene::app::database_api,
    // Objects
    (get_objects)
+   (get_object_fields)
 
    // Subscriptions
    (set_subscribe_callback)
    (set_auto_subscription)
    (set_pending_transaction_callback)
    (set_block_applied_callback)
+   (subscribe_to_account_operations)
+   (unsubscribe_from_account_operations)
    (cancel_all_subscriptions)
 
    // Blocks and transactions
@@ -1364,6 +1626,10 @@ FC_API(graphene::app::database_api,
    (get_config)
    (get_chain_id)
    (get_dynamic_global_properties)
+   (get_head_state)
+   (get_index_memory_usage)
+   (get_maintenance_profiles)
+   (get_api_read_metrics)
 
    // Keys
    (get_key_references)
@@ -1373,11 +1639,13 @@ FC_API(graphene::app::database_api,
    (get_account_id_from_string)
    (get_accounts)
    (get_full_accounts)
+   (get_full_account_page)
    (get_top_voters)
    (get_account_by_name)
    (get_account_references)
    (lookup_account_names)
    (lookup_accounts)
+   (search_accounts)
    (get_account_count)
 
    // Balances
@@ -1386,10 +1654,12 @@ FC_API(graphene::app::database_api,
    (get_balance_objects)
    (get_vested_balances)
    (get_vesting_balances)
+   (get_vesting_balance_withdrawals)
 
    // Assets
    (get_assets)
    (list_assets)
+   (search_assets)
    (lookup_asset_symbols)
    (get_asset_count)
    (get_assets_by_issuer)
@@ -1405,10 +1675,14 @@ FC_API(graphene::app::database_api,
    (get_settle_orders)
    (get_settle_orders_by_account)
    (get_margin_positions)
+   (get_margin_call_risk)
    (get_collateral_bids)
    (subscribe_to_market)
    (unsubscribe_from_market)
+   (subscribe_to_order_book_deltas)
+   (unsubscribe_from_order_book_deltas)
    (get_ticker)
+   (get_tickers)
    (get_24_volume)
    (get_top_markets)
    (get_trade_history)
@@ -1423,6 +1697,7 @@ FC_API(graphene::app::database_api,
    (get_liquidity_pools)
    (get_liquidity_pools_by_share_asset)
    (get_liquidity_pools_by_owner)
+   (get_liquidity_pool_exchange_quotes)
 
    // SameT Funds
    (list_samet_funds)
@@ -1433,6 +1708,7 @@ FC_API(graphene::app::database_api,
    (list_credit_offers)
    (get_credit_offers_by_owner)
    (get_credit_offers_by_asset)
+   (get_best_credit_offers)
    (list_credit_deals)
    (get_credit_deals_by_offer_id)
    (get_credit_deals_by_offer_owner)
@@ -1445,6 +1721,7 @@ FC_API(graphene::app::database_api,
    (get_witness_by_account)
    (lookup_witness_accounts)
    (get_witness_count)
+   (get_witness_schedule)
 
    // Committee members
    (get_committee_members)
@@ -1465,6 +1742,8 @@ FC_API(graphene::app::database_api,
    (get_transaction_hex_without_sig)
    (get_required_signatures)
    (get_potential_signatures)
+   (get_required_signatures_batch)
+   (get_potential_signatures_batch)
    (get_potential_address_signatures)
    (verify_authority)
    (verify_account_authority)
@@ -1480,12 +1759,14 @@ FC_API(graphene::app::database_api,
    // Withdrawals
    (get_withdraw_permissions_by_giver)
    (get_withdraw_permissions_by_recipient)
+   (get_withdraw_permissions_by_expiration)
 
    // HTLC
    (get_htlc)
    (get_htlc_by_from)
    (get_htlc_by_to)
    (list_htlcs)
+   (get_htlcs_by_expiration)
 
    // Tickets
    (list_tickets)
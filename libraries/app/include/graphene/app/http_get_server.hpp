@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/network/http/server.hpp>
+#include <fc/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   class application;
+   class api_response_cache;
+
+   /**
+    * @class http_get_server
+    * @brief Serves chain data which never changes over plain HTTP GET requests, so that it can be cached by reverse
+    * proxies and CDNs
+    *
+    * The paths are
+    *  - /block/<num>             the block with the given number,
+    *  - /block_header/<num>      the header of that block,
+    *  - /block_operations/<num>  the operations applied by that block, requires the block_operations plugin,
+    *  - /operation/<id>          the operation history object with the given ID, e.g. 1.11.42, as long as it is
+    *                             kept in memory by the account_history plugin.
+    *
+    * Only data of irreversible blocks is served. The body of a response is JSON in the format of the corresponding
+    * API call, it has a strong ETag and may be cached forever. A request with a matching If-None-Match header gets
+    * a 304 response without a body. Data which is not irreversible or not available gets a 404 response which must
+    * not be cached.
+    *
+    * Bodies are serialized once and kept in the part of the response cache of the node for immutable results,
+    * if the cache is enabled.
+    */
+   class http_get_server
+   {
+      public:
+         struct response
+         {
+            uint16_t                                             status = 404;
+            std::vector< std::pair<std::string, std::string> >   headers;
+            std::string                                          body;
+         };
+
+         http_get_server( const application& app, api_response_cache* cache );
+
+         void listen( const fc::ip::endpoint& ep );
+
+         /**
+          * @param path the path of the request, a query string is ignored
+          * @param if_none_match the value of the If-None-Match header of the request, empty if there is none
+          * @return the response to a GET request
+          */
+         response handle_get( const std::string& path, const std::string& if_none_match )const;
+
+      private:
+         struct cached_body
+         {
+            std::string   json;
+            std::string   etag;
+         };
+
+         /// @return the serialized data of the path, or null if it is not irreversible or not available
+         fc::optional<cached_body> find_body( const std::string& path )const;
+
+         const application&   _app;
+         api_response_cache*  _cache;
+         fc::http::server     _server;
+   };
+
+} } // graphene::app
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <map>
+
+namespace graphene { namespace app {
+
+   /**
+    * @class object_notification_cache
+    * @brief The serialized objects of one emission of the object change signals of the database
+    *
+    * Every API session which is subscribed to an object converts it to a variant when it is reported as new,
+    * changed or removed. The cache lets all sessions share one conversion per object. It is emptied before every
+    * emission of @ref graphene::chain::database::new_objects, @ref graphene::chain::database::changed_objects
+    * and @ref graphene::chain::database::removed_objects.
+    *
+    * It must only be used by the handlers of these signals.
+    */
+   class object_notification_cache
+   {
+      public:
+         explicit object_notification_cache( graphene::chain::database& db );
+
+         /// @return the variant of the object, which is only computed by the first call in an emission
+         const fc::variant& get( const graphene::db::object& obj );
+
+      private:
+         std::map< graphene::db::object_id_type, fc::variant > _variants;
+
+         boost::signals2::scoped_connection _new_connection;
+         boost::signals2::scoped_connection _change_connection;
+         boost::signals2::scoped_connection _removed_connection;
+   };
+
+} } // graphene::app
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/api_objects.hpp>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace graphene { namespace app {
+
+   /**
+    * @class order_book_cache
+    * @brief The top levels of the order books of recently queried markets, shared by all API sessions
+    *
+    * A book is stored with the version of its market taken from the order_book_versions_index of the
+    * api_helper_indexes plugin. It is recomputed when it is queried with another version, i.e. only after an order
+    * of the market changed, so that cached books always reflect the current state of the database including
+    * pending transactions. When books of @ref max_markets markets are stored, the book which was stored first is
+    * dropped to make room for a new one.
+    *
+    * The cache may be used by several threads at once.
+    */
+   class order_book_cache
+   {
+      public:
+         using market_type = std::pair< asset_id_type, asset_id_type >;
+
+         explicit order_book_cache( size_t max_markets );
+
+         /**
+          * @param market the base and the quote asset of the book
+          * @param version the current version of the market
+          * @param compute computes the book if it is not cached with the version
+          * @return the book of the market
+          */
+         std::shared_ptr<const order_book> get( const market_type& market, uint64_t version,
+                                                const std::function<order_book()>& compute );
+
+         /// @return the number of markets whose books are stored
+         size_t size()const;
+
+         const size_t max_markets;
+
+      private:
+         struct entry
+         {
+            uint64_t                          version = 0;
+            std::shared_ptr<const order_book> book;
+         };
+
+         mutable std::mutex              _mutex;
+         std::map< market_type, entry >  _entries;
+         /// The keys of @ref _entries in insertion order
+         std::deque< market_type >       _markets;
+   };
+
+} } // graphene::app
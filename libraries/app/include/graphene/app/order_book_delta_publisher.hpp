@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/api_objects.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace graphene { namespace app {
+
+   /**
+    * @class order_book_delta_publisher
+    * @brief Pushes the changes of subscribed order books to their subscribers once per block
+    *
+    * For every subscribed market and depth the publisher aggregates the top levels of both sides of the book after
+    * each applied block, compares them with the levels sent after the previous block and pushes an
+    * @ref order_book_delta with the changed levels and the fills of the block to all subscribers. The delta is
+    * computed and serialized once per market, no matter how many sessions subscribed to it. The first delta after
+    * a subscription of a market is a snapshot of its top levels.
+    *
+    * Levels are identified by their price string, a level of the previous delta which is gone or dropped out of the
+    * top levels is sent with zero amounts.
+    */
+   class order_book_delta_publisher
+   {
+      public:
+         using callback_type = std::function<void(const fc::variant&)>;
+
+         explicit order_book_delta_publisher( graphene::chain::database& db );
+
+         /// @return the ID of the new subscription
+         uint64_t subscribe( asset_id_type base, asset_id_type quote, uint32_t depth, callback_type callback );
+         void unsubscribe( uint64_t subscription_id );
+
+         /// @return the number of distinct markets and depths which are tracked
+         size_t market_count()const;
+
+      private:
+         struct level
+         {
+            share_type base;
+            share_type quote;
+         };
+         using level_map = std::map< string, level >;
+         using market_key = std::tuple< asset_id_type, asset_id_type, uint32_t >;
+
+         struct market_state
+         {
+            bool                                published = false;
+            level_map                           bids;
+            level_map                           asks;
+            std::map< uint64_t, callback_type > subscribers;
+         };
+
+         void on_applied_block( const signed_block& block );
+         level_map get_levels( const asset_object& sell, const asset_object& receive, uint32_t depth,
+                               bool is_bid )const;
+
+         graphene::chain::database&           _db;
+         mutable std::mutex                   _mutex;
+         uint64_t                             _next_subscription_id = 0;
+         std::map< market_key, market_state > _markets;
+         std::map< uint64_t, market_key >     _subscriptions;
+
+         boost::signals2::scoped_connection   _applied_block_connection;
+   };
+
+} } // graphene::app
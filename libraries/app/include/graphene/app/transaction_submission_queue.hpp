@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/thread/future.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace graphene { namespace app {
+
+   /// Counters of the transactions submitted through a @ref transaction_submission_queue
+   struct transaction_submission_metrics
+   {
+      /// transactions which are being validated or wait to be pushed to the database
+      uint32_t queued              = 0;
+      uint32_t max_queue_size      = 0;
+      /// transactions which were pushed to the database successfully
+      uint64_t accepted            = 0;
+      /// transactions which were rejected because the queue was full
+      uint64_t rejected_queue_full = 0;
+      /// transactions which failed the checks done before they are queued
+      uint64_t rejected_invalid    = 0;
+      /// transactions which could not be pushed to the database
+      uint64_t rejected_by_chain   = 0;
+      /// number of times queued transactions were pushed to the database
+      uint64_t batches             = 0;
+   };
+
+   /**
+    * @class transaction_submission_queue
+    * @brief A bounded queue of the transactions received by the network broadcast API
+    *
+    * The checks of a transaction which do not depend on the database state, i.e. its size, expiration and TaPoS
+    * reference against the recently applied blocks, are done by the submitting thread with the values taken from
+    * the last applied block. The transaction is validated and its signatures are recovered in the thread pool of
+    * the database, then it is queued. The queued transactions are pushed to the database in batches in the thread
+    * which created the queue, so that a burst of submissions does not make every caller wait for the database in
+    * turn. Transactions which are submitted while the queue is full are rejected at once.
+    *
+    * The queue may be used by several threads at once.
+    */
+   class transaction_submission_queue : public std::enable_shared_from_this<transaction_submission_queue>
+   {
+      public:
+         transaction_submission_queue( graphene::chain::database& db, uint32_t max_queue_size,
+                                       uint32_t max_batch_size );
+
+         /**
+          * Checks and queues the transaction
+          * @return a future which is ready when the transaction was pushed to the database, or which holds the
+          *         exception thrown by the database
+          */
+         fc::future<void> submit( const precomputable_transaction& trx );
+
+         transaction_submission_metrics get_metrics()const;
+
+         const uint32_t max_queue_size;
+         const uint32_t max_batch_size;
+
+      private:
+         /// the number of recently applied blocks which TaPoS references are checked against, divides 2^16
+         static constexpr size_t recent_blocks = 1024;
+
+         struct recent_block
+         {
+            uint32_t block_num = 0;
+            uint32_t prefix    = 0;
+         };
+
+         struct queued_transaction
+         {
+            precomputable_transaction trx;
+            fc::promise<void>::ptr    pushed;
+         };
+
+         void on_applied_block( const signed_block& block );
+         void check_stateless( const precomputable_transaction& trx )const;
+         void on_rejected( uint64_t transaction_submission_metrics::* counter );
+         void push_batch();
+
+         graphene::chain::database&             _db;
+         fc::thread&                            _push_thread;
+         mutable std::mutex                     _mutex;
+         transaction_submission_metrics         _metrics;
+         std::deque< queued_transaction >       _queue;
+         bool                                   _push_scheduled = false;
+
+         // values of the last applied block
+         uint32_t                               _head_block_num = 0;
+         fc::time_point_sec                     _head_block_time;
+         uint32_t                               _maximum_transaction_size = 0;
+         uint32_t                               _maximum_time_until_expiration = 0;
+         std::array< recent_block, recent_blocks > _recent_blocks {};
+
+         boost::signals2::scoped_connection     _applied_block_connection;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::transaction_submission_metrics,
+            (queued)(max_queue_size)(accepted)(rejected_queue_full)(rejected_invalid)(rejected_by_chain)(batches) )
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/object_notification_cache.hpp>
+
+namespace graphene { namespace app {
+
+object_notification_cache::object_notification_cache( graphene::chain::database& db )
+{
+   // connect in front of the API sessions, so that the cache is emptied before they are notified
+   _new_connection = db.new_objects.connect( [this]( const auto&, const auto& ) {
+      _variants.clear();
+   }, boost::signals2::at_front );
+   _change_connection = db.changed_objects.connect( [this]( const auto&, const auto& ) {
+      _variants.clear();
+   }, boost::signals2::at_front );
+   _removed_connection = db.removed_objects.connect( [this]( const auto&, const auto&, const auto& ) {
+      _variants.clear();
+   }, boost::signals2::at_front );
+}
+
+const fc::variant& object_notification_cache::get( const graphene::db::object& obj )
+{
+   auto itr = _variants.find( obj.id );
+   if( itr == _variants.end() )
+      itr = _variants.emplace( obj.id, obj.to_variant() ).first;
+   return itr->second;
+}
+
+} } // graphene::app
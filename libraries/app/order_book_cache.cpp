@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/order_book_cache.hpp>
+
+namespace graphene { namespace app {
+
+order_book_cache::order_book_cache( size_t max_markets )
+:max_markets(max_markets)
+{
+   FC_ASSERT( max_markets > 0, "The cache size must be positive" );
+}
+
+std::shared_ptr<const order_book> order_book_cache::get( const market_type& market, uint64_t version,
+                                                         const std::function<order_book()>& compute )
+{
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      auto itr = _entries.find( market );
+      if( itr != _entries.end() && itr->second.version == version )
+         return itr->second.book;
+   }
+
+   auto book = std::make_shared<const order_book>( compute() );
+   std::lock_guard<std::mutex> guard( _mutex );
+   auto itr = _entries.find( market );
+   if( itr == _entries.end() )
+   {
+      _entries.emplace( market, entry{ version, book } );
+      _markets.push_back( market );
+      if( _markets.size() > max_markets )
+      {
+         _entries.erase( _markets.front() );
+         _markets.pop_front();
+      }
+   }
+   // a book of an older version which was computed by another thread in the meantime is only a cache miss
+   else
+      itr->second = entry{ version, book };
+   return book;
+}
+
+size_t order_book_cache::size()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _entries.size();
+}
+
+} } // graphene::app
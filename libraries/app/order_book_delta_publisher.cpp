@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/order_book_delta_publisher.hpp>
+#include <graphene/app/util.hpp>
+
+#include <fc/thread/thread.hpp>
+
+namespace graphene { namespace app {
+
+order_book_delta_publisher::order_book_delta_publisher( graphene::chain::database& db )
+:_db(db)
+{
+   _applied_block_connection = _db.applied_block.connect( [this]( const signed_block& b ) {
+      on_applied_block( b );
+   } );
+}
+
+uint64_t order_book_delta_publisher::subscribe( asset_id_type base, asset_id_type quote, uint32_t depth,
+                                                callback_type callback )
+{
+   FC_ASSERT( base != quote, "The base and the quote asset must differ" );
+   FC_ASSERT( depth > 0, "The depth must be positive" );
+   std::lock_guard<std::mutex> guard( _mutex );
+   const uint64_t id = ++_next_subscription_id;
+   const market_key key = std::make_tuple( base, quote, depth );
+   _markets[key].subscribers[id] = std::move( callback );
+   _subscriptions[id] = key;
+   return id;
+}
+
+void order_book_delta_publisher::unsubscribe( uint64_t subscription_id )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   auto sub_itr = _subscriptions.find( subscription_id );
+   if( sub_itr == _subscriptions.end() )
+      return;
+   auto market_itr = _markets.find( sub_itr->second );
+   _subscriptions.erase( sub_itr );
+   if( market_itr == _markets.end() )
+      return;
+   market_itr->second.subscribers.erase( subscription_id );
+   if( market_itr->second.subscribers.empty() )
+      _markets.erase( market_itr );
+}
+
+size_t order_book_delta_publisher::market_count()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _markets.size();
+}
+
+order_book_delta_publisher::level_map order_book_delta_publisher::get_levels( const asset_object& base,
+                                                                              const asset_object& quote,
+                                                                              uint32_t depth, bool is_bid )const
+{
+   const auto& all_levels = _db.get_index_type< primary_index< limit_order_index > >()
+                               .get_secondary_index< limit_order_price_level_index >().get_levels();
+   const asset_id_type sell_id = is_bid ? base.get_id() : quote.get_id();
+   const asset_id_type receive_id = is_bid ? quote.get_id() : base.get_id();
+
+   level_map result;
+   auto itr = all_levels.lower_bound( price::max( sell_id, receive_id ) );
+   auto end = all_levels.upper_bound( price::min( sell_id, receive_id ) );
+   for( ; itr != end; ++itr )
+   {
+      const price& p = itr->first;
+      const share_type for_sale = itr->second.for_sale;
+      const share_type to_receive = share_type( fc::uint128_t( for_sale.value ) * p.quote.amount.value
+                                                / p.base.amount.value );
+      // distinct prices may be shown as the same string, they are one level for the subscribers
+      const string price_string = price_to_string( p, base, quote );
+      auto level_itr = result.find( price_string );
+      if( level_itr == result.end() )
+      {
+         if( result.size() >= depth )
+            break;
+         level_itr = result.emplace( price_string, level() ).first;
+      }
+      level& l = level_itr->second;
+      l.base  += is_bid ? for_sale : to_receive;
+      l.quote += is_bid ? to_receive : for_sale;
+   }
+   return result;
+}
+
+/** note: this method cannot yield because it is called in the middle of
+ * apply a block.
+ */
+void order_book_delta_publisher::on_applied_block( const signed_block& block )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   if( _markets.empty() )
+      return;
+
+   std::map< std::pair<asset_id_type,asset_id_type>, vector<fill_order_operation> > fills;
+   for( const optional< operation_history_object >& o_op : _db.get_applied_operations() )
+   {
+      if( o_op.valid() && o_op->op.is_type<fill_order_operation>() )
+      {
+         const auto& fill = o_op->op.get<fill_order_operation>();
+         fills[ fill.get_market() ].push_back( fill );
+      }
+   }
+
+   vector< std::pair< fc::variant, vector<callback_type> > > notifications;
+   for( auto& item : _markets )
+   {
+      const asset_object& base = std::get<0>( item.first )( _db );
+      const asset_object& quote = std::get<1>( item.first )( _db );
+      const uint32_t depth = std::get<2>( item.first );
+      market_state& state = item.second;
+
+      level_map bids = get_levels( base, quote, depth, true );
+      level_map asks = get_levels( base, quote, depth, false );
+
+      order_book_delta delta;
+      delta.block_num = block.block_num();
+      delta.base = base.symbol;
+      delta.quote = quote.symbol;
+      delta.is_snapshot = !state.published;
+
+      auto add_changes = [&base,&quote]( const level_map& before, const level_map& after, vector<order>& out ) {
+         for( const auto& l : after )
+         {
+            auto old_itr = before.find( l.first );
+            if( old_itr != before.end() && old_itr->second.base == l.second.base
+                  && old_itr->second.quote == l.second.quote )
+               continue;
+            out.push_back( { l.first, quote.amount_to_string( l.second.quote ),
+                             base.amount_to_string( l.second.base ) } );
+         }
+         for( const auto& l : before )
+         {
+            if( after.find( l.first ) == after.end() )
+               out.push_back( { l.first, quote.amount_to_string( share_type(0) ),
+                                base.amount_to_string( share_type(0) ) } );
+         }
+      };
+      add_changes( state.bids, bids, delta.bids );
+      add_changes( state.asks, asks, delta.asks );
+
+      auto market = base.get_id() < quote.get_id() ? std::make_pair( base.get_id(), quote.get_id() )
+                                                   : std::make_pair( quote.get_id(), base.get_id() );
+      auto fill_itr = fills.find( market );
+      if( fill_itr != fills.end() )
+         delta.fills = fill_itr->second;
+
+      state.bids = std::move( bids );
+      state.asks = std::move( asks );
+      if( state.published && delta.bids.empty() && delta.asks.empty() && delta.fills.empty() )
+         continue;
+      state.published = true;
+
+      vector<callback_type> callbacks;
+      callbacks.reserve( state.subscribers.size() );
+      for( const auto& sub : state.subscribers )
+         callbacks.push_back( sub.second );
+      notifications.emplace_back( fc::variant( delta, GRAPHENE_NET_MAX_NESTED_OBJECTS ), std::move( callbacks ) );
+   }
+
+   if( notifications.empty() )
+      return;
+   fc::async( [notifications](){
+      for( const auto& item : notifications )
+      {
+         for( const auto& callback : item.second )
+         {
+            try
+            {
+               callback( item.first );
+            }
+            catch( const fc::exception& e )
+            {
+               wlog( "Failed to send an order book delta: ${e}", ("e", e.to_detail_string()) );
+            }
+         }
+      }
+   } );
+}
+
+} } // graphene::app
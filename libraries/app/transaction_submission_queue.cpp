@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/transaction_submission_queue.hpp>
+
+#include <graphene/chain/global_property_object.hpp>
+#include <graphene/chain/hardfork.hpp>
+
+#include <fc/thread/thread.hpp>
+
+namespace graphene { namespace app {
+
+transaction_submission_queue::transaction_submission_queue( graphene::chain::database& db,
+                                                            uint32_t max_queue_size, uint32_t max_batch_size )
+:max_queue_size(max_queue_size), max_batch_size(max_batch_size), _db(db), _push_thread(fc::thread::current())
+{
+   FC_ASSERT( max_queue_size > 0, "The queue size must be positive" );
+   FC_ASSERT( max_batch_size > 0, "The batch size must be positive" );
+   _metrics.max_queue_size = max_queue_size;
+   _applied_block_connection = _db.applied_block.connect( [this]( const signed_block& b ) {
+      on_applied_block( b );
+   } );
+}
+
+void transaction_submission_queue::on_applied_block( const signed_block& block )
+{
+   const auto& params = _db.get_global_properties().parameters;
+   const block_id_type id = block.id();
+   const uint32_t block_num = block.block_num();
+   std::lock_guard<std::mutex> guard( _mutex );
+   _head_block_num = block_num;
+   _head_block_time = block.timestamp;
+   _maximum_transaction_size = params.maximum_transaction_size;
+   _maximum_time_until_expiration = params.maximum_time_until_expiration;
+   recent_block& recent = _recent_blocks[ block_num % recent_blocks ];
+   recent.block_num = block_num;
+   recent.prefix = id._hash[1].value();
+}
+
+void transaction_submission_queue::check_stateless( const precomputable_transaction& trx )const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   // nothing is known about the chain before the first block is applied, leave the checks to the database
+   if( 0 == _head_block_num )
+      return;
+
+   FC_ASSERT( trx.expiration <= _head_block_time + _maximum_time_until_expiration,
+              "Transaction expires too late",
+              ("trx.expiration",trx.expiration)("now",_head_block_time)
+              ("max_til_exp",_maximum_time_until_expiration) );
+   FC_ASSERT( _head_block_time <= trx.expiration, "Transaction is expired",
+              ("now",_head_block_time)("trx.exp",trx.expiration) );
+   FC_ASSERT( _head_block_time <= HARDFORK_CORE_1573_TIME
+              || trx.get_packed_size() <= _maximum_transaction_size,
+              "Transaction exceeds maximum transaction size." );
+
+   // a reference to a block which is not among the recent blocks is checked by the database
+   const recent_block& recent = _recent_blocks[ trx.ref_block_num % recent_blocks ];
+   if( recent.block_num != 0 && ( recent.block_num & 0xffff ) == trx.ref_block_num )
+      FC_ASSERT( trx.ref_block_prefix == recent.prefix, "Transaction references a block of another fork",
+                 ("ref_block_num",trx.ref_block_num)("ref_block_prefix",trx.ref_block_prefix) );
+}
+
+void transaction_submission_queue::on_rejected( uint64_t transaction_submission_metrics::* counter )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   --_metrics.queued;
+   ++( _metrics.*counter );
+}
+
+fc::future<void> transaction_submission_queue::submit( const precomputable_transaction& trx )
+{
+   bool is_full = false;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      is_full = ( _metrics.queued >= max_queue_size );
+      if( is_full )
+         ++_metrics.rejected_queue_full;
+      else
+         ++_metrics.queued;
+   }
+   FC_ASSERT( !is_full, "Too many transactions are waiting to be processed, please try again later" );
+
+   try
+   {
+      check_stateless( trx );
+      _db.precompute_parallel( trx ).wait();
+   }
+   catch( ... )
+   {
+      on_rejected( &transaction_submission_metrics::rejected_invalid );
+      throw;
+   }
+
+   fc::promise<void>::ptr pushed = fc::promise<void>::create( "graphene::app::transaction_submission_queue" );
+   bool schedule = false;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      _queue.push_back( queued_transaction{ trx, pushed } );
+      schedule = !_push_scheduled;
+      _push_scheduled = true;
+   }
+   if( schedule )
+   {
+      auto self = shared_from_this();
+      _push_thread.async( [self]() { self->push_batch(); }, "transaction_submission_queue::push_batch" );
+   }
+   return fc::future<void>( pushed );
+}
+
+void transaction_submission_queue::push_batch()
+{
+   std::vector< queued_transaction > batch;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      const size_t count = std::min<size_t>( _queue.size(), max_batch_size );
+      batch.reserve( count );
+      for( size_t i = 0; i < count; ++i )
+      {
+         batch.push_back( std::move( _queue.front() ) );
+         _queue.pop_front();
+      }
+      ++_metrics.batches;
+   }
+
+   for( queued_transaction& queued : batch )
+   {
+      try
+      {
+         _db.push_transaction( queued.trx );
+      }
+      catch( const fc::exception& e )
+      {
+         on_rejected( &transaction_submission_metrics::rejected_by_chain );
+         queued.pushed->set_exception( e.dynamic_copy_exception() );
+         continue;
+      }
+      {
+         std::lock_guard<std::mutex> guard( _mutex );
+         --_metrics.queued;
+         ++_metrics.accepted;
+      }
+      queued.pushed->set_value();
+   }
+
+   // let the other tasks of this thread run before the next batch
+   bool schedule = false;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      schedule = !_queue.empty();
+      _push_scheduled = schedule;
+   }
+   if( schedule )
+   {
+      auto self = shared_from_this();
+      _push_thread.async( [self]() { self->push_batch(); }, "transaction_submission_queue::push_batch" );
+   }
+}
+
+transaction_submission_metrics transaction_submission_queue::get_metrics()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _metrics;
+}
+
+} } // graphene::app
@@ -23,6 +23,7 @@
  */
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/vesting_balance_object.hpp>
 
 #include <fc/io/raw.hpp>
 #include <fc/uint128.hpp>
@@ -50,7 +51,7 @@ void account_balance_object::adjust_balance(const asset& delta)
       maintenance_flag = true;
 }
 
-void account_statistics_object::process_fees(const account_object& a, database& d) const
+void account_statistics_object::process_fees(const account_object& a, database& d, fee_payout_batch* batch) const
 {
    if( pending_fees > 0 || pending_vested_fees > 0 )
    {
@@ -69,9 +70,12 @@ void account_statistics_object::process_fees(const account_object& a, database&
          share_type lifetime_cut = cut_fee(core_fee_total, account.lifetime_referrer_fee_percentage);
          share_type referral = core_fee_total - network_cut - lifetime_cut;
 
-         d.modify( d.get_core_dynamic_data(), [network_cut](asset_dynamic_data_object& addo) {
-            addo.accumulated_fees += network_cut;
-         });
+         if( batch != nullptr )
+            batch->add_network_fees( network_cut );
+         else
+            d.modify( d.get_core_dynamic_data(), [network_cut](asset_dynamic_data_object& addo) {
+               addo.accumulated_fees += network_cut;
+            });
 
          // Potential optimization: Skip some of this math and object lookups by special casing on the account type.
          // For example, if the account is a lifetime member, we can skip all this and just deposit the referral to
@@ -79,9 +83,15 @@ void account_statistics_object::process_fees(const account_object& a, database&
          share_type referrer_cut = cut_fee(referral, account.referrer_rewards_percentage);
          share_type registrar_cut = referral - referrer_cut;
 
-         d.deposit_cashback(d.get(account.lifetime_referrer), lifetime_cut, require_vesting);
-         d.deposit_cashback(d.get(account.referrer), referrer_cut, require_vesting);
-         d.deposit_cashback(d.get(account.registrar), registrar_cut, require_vesting);
+         auto deposit_cashback = [&d,batch,require_vesting](account_id_type to, share_type amount) {
+            if( batch != nullptr )
+               batch->deposit_cashback(d, d.get(to), amount, require_vesting);
+            else
+               d.deposit_cashback(d.get(to), amount, require_vesting);
+         };
+         deposit_cashback(account.lifetime_referrer, lifetime_cut);
+         deposit_cashback(account.referrer, referrer_cut);
+         deposit_cashback(account.registrar, registrar_cut);
 
          assert( referrer_cut + registrar_cut + network_cut + lifetime_cut == core_fee_total );
       };
@@ -97,6 +107,56 @@ void account_statistics_object::process_fees(const account_object& a, database&
    }
 }
 
+void fee_payout_batch::deposit_cashback( database& d, const account_object& acct, share_type amount,
+                                         bool require_vesting )
+{
+   if( amount == 0 )
+      return;
+
+   // Same conditions for reusing the vesting balance as in database::deposit_lazy_vesting()
+   if( acct.cashback_vb.valid() )
+   {
+      const vesting_balance_object& vbo = (*acct.cashback_vb)(d);
+      if( vbo.owner == acct.id && vbo.policy.is_type< cdd_vesting_policy >()
+            && vbo.policy.get< cdd_vesting_policy >().vesting_seconds
+                  == d.get_global_properties().parameters.cashback_vesting_period_seconds )
+      {
+         cashback_deposit& deposit = _deposits[ *acct.cashback_vb ];
+         if( require_vesting )
+            deposit.vesting += amount;
+         else
+            deposit.vested += amount;
+         return;
+      }
+   }
+
+   d.deposit_cashback( acct, amount, require_vesting );
+}
+
+void fee_payout_batch::apply( database& d )
+{
+   // All deposits happen at the same time, so summing them up does not change the coin seconds earned
+   const time_point_sec now = d.head_block_time();
+   for( const auto& item : _deposits )
+   {
+      d.modify( item.first(d), [&item,&now]( vesting_balance_object& vbo ) {
+         if( item.second.vesting > 0 )
+            vbo.deposit( now, asset( item.second.vesting ) );
+         if( item.second.vested > 0 )
+            vbo.deposit_vested( now, asset( item.second.vested ) );
+      });
+   }
+   _deposits.clear();
+
+   if( _network_fees > 0 )
+   {
+      d.modify( d.get_core_dynamic_data(), [this]( asset_dynamic_data_object& addo ) {
+         addo.accumulated_fees += _network_fees;
+      });
+      _network_fees = 0;
+   }
+}
+
 void account_statistics_object::pay_fee( share_type core_fee, share_type cashback_vesting_threshold )
 {
    if( core_fee > cashback_vesting_threshold )
@@ -105,6 +165,89 @@ void account_statistics_object::pay_fee( share_type core_fee, share_type cashbac
       pending_vested_fees += core_fee;
 }
 
+void account_key_references::insert( const public_key_type& key, account_id_type account )
+{
+   auto result = _refs.emplace( key.key_data, entry() );
+   entry& e = result.first->second;
+   if( result.second )
+      e.single = account;
+   else if( e.others )
+      e.others->insert( account );
+   else if( e.single != account )
+   {
+      e.others.reset( new flat_set<account_id_type>{ e.single, account } );
+      e.single = account_id_type();
+   }
+}
+
+void account_key_references::erase( const public_key_type& key, account_id_type account )
+{
+   auto itr = _refs.find( key.key_data );
+   if( itr == _refs.end() )
+      return;
+   entry& e = itr->second;
+   if( !e.others )
+   {
+      if( e.single == account )
+         _refs.erase( itr );
+      return;
+   }
+   e.others->erase( account );
+   if( e.others->size() == 1 )
+   {
+      e.single = *e.others->begin();
+      e.others.reset();
+   }
+}
+
+void account_key_references::get_accounts( const public_key_type& key, flat_set<account_id_type>& result )const
+{
+   auto itr = _refs.find( key.key_data );
+   if( itr == _refs.end() )
+      return;
+   const entry& e = itr->second;
+   if( !e.others )
+      result.insert( e.single );
+   else if( result.empty() )
+      result = *e.others;
+   else
+      result.insert( e.others->begin(), e.others->end() );
+}
+
+void account_key_references::get_accounts( const vector<public_key_type>& keys,
+                                           vector< flat_set<account_id_type> >& results )const
+{
+   FC_ASSERT( keys.size() == results.size(), "One result per key is required" );
+   // Look up each distinct key once, wallets tend to send the same key several times
+   flat_map< key_data, size_t > first_occurrence;
+   first_occurrence.reserve( keys.size() );
+   for( size_t i = 0; i < keys.size(); ++i )
+   {
+      auto inserted = first_occurrence.emplace( keys[i].key_data, i );
+      if( inserted.second )
+         get_accounts( keys[i], results[i] );
+      else
+      {
+         const auto& found = results[inserted.first->second];
+         results[i].insert( found.begin(), found.end() );
+      }
+   }
+}
+
+size_t account_key_references::memory_usage()const
+{
+   // a node of an unordered map holds the value, the next pointer and the cached hash, the buckets hold one pointer
+   size_t result = _refs.size() * ( sizeof( std::pair<const key_data, entry> ) + 2 * sizeof(void*) )
+                   + _refs.bucket_count() * sizeof(void*);
+   for( const auto& item : _refs )
+   {
+      if( item.second.others )
+         result += sizeof( flat_set<account_id_type> )
+                   + item.second.others->capacity() * sizeof( account_id_type );
+   }
+   return result;
+}
+
 set<account_id_type> account_member_index::get_account_members(const account_object& a)const
 {
    set<account_id_type> result;
@@ -146,7 +289,7 @@ void account_member_index::object_inserted(const object& obj)
 
     auto key_members = get_key_members(a);
     for( auto item : key_members )
-       account_to_key_memberships[item].insert(obj.id);
+       account_to_key_memberships.insert( item, a.get_id() );
 
     auto address_members = get_address_members(a);
     for( auto item : address_members )
@@ -160,7 +303,7 @@ void account_member_index::object_removed(const object& obj)
 
     auto key_members = get_key_members(a);
     for( auto item : key_members )
-       account_to_key_memberships[item].erase( obj.id );
+       account_to_key_memberships.erase( item, a.get_id() );
 
     auto address_members = get_address_members(a);
     for( auto item : address_members )
@@ -216,7 +359,7 @@ void account_member_index::object_modified(const object& after)
                            std::inserter(removed, removed.end()));
 
        for( auto itr = removed.begin(); itr != removed.end(); ++itr )
-          account_to_key_memberships[*itr].erase(after.id);
+          account_to_key_memberships.erase( *itr, a.get_id() );
 
        vector<public_key_type> added; added.reserve(after_key_members.size());
        std::set_difference(after_key_members.begin(), after_key_members.end(),
@@ -224,7 +367,7 @@ void account_member_index::object_modified(const object& after)
                            std::inserter(added, added.end()));
 
        for( auto itr = added.begin(); itr != added.end(); ++itr )
-          account_to_key_memberships[*itr].insert(after.id);
+          account_to_key_memberships.insert( *itr, a.get_id() );
     }
 
     {
@@ -249,26 +392,45 @@ void account_member_index::object_modified(const object& after)
 
 }
 
-const uint8_t  balances_by_account_index::bits = 20;
-const uint64_t balances_by_account_index::mask = (1ULL << balances_by_account_index::bits) - 1;
+size_t account_member_index::memory_usage()const
+{
+   // a node of an ordered map holds the value, three pointers and the color
+   const size_t node_overhead = 4 * sizeof(void*);
+   size_t result = account_to_key_memberships.memory_usage();
+   for( const auto& item : account_to_account_memberships )
+      result += sizeof( item ) + node_overhead + item.second.size() * ( sizeof( account_id_type ) + node_overhead );
+   for( const auto& item : account_to_address_memberships )
+      result += sizeof( item ) + node_overhead + item.second.size() * ( sizeof( account_id_type ) + node_overhead );
+   return result;
+}
 
 void balances_by_account_index::object_inserted( const object& obj )
 {
    const auto& abo = dynamic_cast< const account_balance_object& >( obj );
-   while( balances.size() < (abo.owner.instance.value >> bits) + 1 )
+   const uint64_t instance = abo.owner.instance.value;
+   if( abo.asset_type == asset_id_type() )
    {
-      balances.reserve( (abo.owner.instance.value >> bits) + 1 );
-      balances.resize( balances.size() + 1 );
-      balances.back().resize( 1ULL << bits );
+      if( core_balances.size() <= instance )
+         core_balances.resize( instance + 1, nullptr );
+      core_balances[instance] = &abo;
+      return;
    }
-   balances[abo.owner.instance.value >> bits][abo.owner.instance.value & mask][abo.asset_type] = &abo;
+   if( other_balances.size() <= instance )
+      other_balances.resize( instance + 1 );
+   other_balances[instance][abo.asset_type] = &abo;
 }
 
 void balances_by_account_index::object_removed( const object& obj )
 {
    const auto& abo = dynamic_cast< const account_balance_object& >( obj );
-   if( balances.size() < (abo.owner.instance.value >> bits) + 1 ) return;
-   balances[abo.owner.instance.value >> bits][abo.owner.instance.value & mask].erase( abo.asset_type );
+   const uint64_t instance = abo.owner.instance.value;
+   if( abo.asset_type == asset_id_type() )
+   {
+      if( instance < core_balances.size() )
+         core_balances[instance] = nullptr;
+   }
+   else if( instance < other_balances.size() )
+      other_balances[instance].erase( abo.asset_type );
 }
 
 void balances_by_account_index::about_to_modify( const object& before )
@@ -282,23 +444,142 @@ void balances_by_account_index::object_modified( const object& after  )
    ids_being_modified.pop();
 }
 
-const map< asset_id_type, const account_balance_object* >& balances_by_account_index::get_account_balances( const account_id_type& acct )const
+balances_by_account_index::balance_map balances_by_account_index::get_account_balances(
+      const account_id_type& acct )const
 {
-   static const map< asset_id_type, const account_balance_object* > _empty;
-
-   if( balances.size() < (acct.instance.value >> bits) + 1 ) return _empty;
-   return balances[acct.instance.value >> bits][acct.instance.value & mask];
+   const uint64_t instance = acct.instance.value;
+   balance_map result;
+   if( instance < other_balances.size() )
+      result = other_balances[instance];
+   if( instance < core_balances.size() && core_balances[instance] != nullptr )
+      result.emplace_hint( result.begin(), asset_id_type(), core_balances[instance] );
+   return result;
 }
 
-const account_balance_object* balances_by_account_index::get_account_balance( const account_id_type& acct, const asset_id_type& asset )const
+const account_balance_object* balances_by_account_index::get_account_balance( const account_id_type& acct,
+                                                                              const asset_id_type& asset )const
 {
-   if( balances.size() < (acct.instance.value >> bits) + 1 ) return nullptr;
-   const auto& mine = balances[acct.instance.value >> bits][acct.instance.value & mask];
+   const uint64_t instance = acct.instance.value;
+   if( asset == asset_id_type() )
+      return instance < core_balances.size() ? core_balances[instance] : nullptr;
+   if( instance >= other_balances.size() )
+      return nullptr;
+   const auto& mine = other_balances[instance];
    const auto itr = mine.find( asset );
    if( mine.end() == itr ) return nullptr;
    return itr->second;
 }
 
+size_t balances_by_account_index::memory_usage()const
+{
+   size_t result = core_balances.capacity() * sizeof( const account_balance_object* )
+                 + other_balances.capacity() * sizeof( balance_map );
+   for( const auto& account_balances : other_balances )
+      result += account_balances.capacity() * sizeof( balance_map::value_type );
+   return result;
+}
+
+void vote_tally_contribution::clear()
+{
+   votes.clear();
+   witness_count_offset = 0;
+   witness_count_stake = 0;
+   committee_count_offset = 0;
+   committee_count_stake = 0;
+   total_voting_stake = {};
+   opinion_account_stats = nullptr;
+   vp_all = 0;
+   vp_active = 0;
+   vp_committee = 0;
+   vp_witness = 0;
+   vp_worker = 0;
+}
+
+void vote_tally_buffer::add( const vote_tally_buffer& other )
+{
+   for( size_t i = 0; i < votes.size(); ++i )
+      votes[i] += other.votes[i];
+   for( size_t i = 0; i < witness_counts.size(); ++i )
+      witness_counts[i] += other.witness_counts[i];
+   for( size_t i = 0; i < committee_counts.size(); ++i )
+      committee_counts[i] += other.committee_counts[i];
+   total_voting_stake[0] += other.total_voting_stake[0];
+   total_voting_stake[1] += other.total_voting_stake[1];
+}
+
+void vote_tally_buffer::add( const vote_tally_contribution& c )
+{
+   for( const auto& vote : c.votes )
+      votes[vote.first] += vote.second;
+   witness_counts[c.witness_count_offset] += c.witness_count_stake;
+   committee_counts[c.committee_count_offset] += c.committee_count_stake;
+   total_voting_stake[0] += c.total_voting_stake[0];
+   total_voting_stake[1] += c.total_voting_stake[1];
+}
+
+void vote_tally_buffer::subtract( const vote_tally_contribution& c )
+{
+   for( const auto& vote : c.votes )
+      votes[vote.first] -= vote.second;
+   witness_counts[c.witness_count_offset] -= c.witness_count_stake;
+   committee_counts[c.committee_count_offset] -= c.committee_count_stake;
+   total_voting_stake[0] -= c.total_voting_stake[0];
+   total_voting_stake[1] -= c.total_voting_stake[1];
+}
+
+void vote_tally_cache::object_inserted( const object& obj )
+{
+   _last_changes[ obj.id.instance() ] = ++_change_sequence;
+}
+
+void vote_tally_cache::object_removed( const object& obj )
+{
+   _last_changes[ obj.id.instance() ] = ++_change_sequence;
+}
+
+void vote_tally_cache::object_modified( const object& after )
+{
+   _last_changes[ after.id.instance() ] = ++_change_sequence;
+}
+
+uint64_t vote_tally_cache::last_change( account_id_type account )const
+{
+   const auto itr = _last_changes.find( account.instance.value );
+   return ( itr == _last_changes.end() ) ? 0 : itr->second;
+}
+
+void vote_tally_cache::forget_changes( uint64_t up_to )
+{
+   for( auto itr = _last_changes.begin(); itr != _last_changes.end(); )
+   {
+      if( itr->second <= up_to )
+         itr = _last_changes.erase( itr );
+      else
+         ++itr;
+   }
+}
+
+void vote_tally_cache::reset()
+{
+   entries.clear();
+   totals = vote_tally_buffer();
+   initialized = false;
+}
+
+size_t vote_tally_cache::memory_usage()const
+{
+   // a node of an unordered map holds the value and the next pointer, the buckets hold one pointer each
+   size_t result = entries.size() * ( sizeof( std::pair<const uint64_t, entry> ) + sizeof(void*) )
+                   + entries.bucket_count() * sizeof(void*);
+   for( const auto& item : entries )
+      result += item.second.votes.capacity() * sizeof( std::pair<uint32_t, uint64_t> );
+   result += _last_changes.size() * ( sizeof( std::pair<const uint64_t, uint64_t> ) + sizeof(void*) )
+             + _last_changes.bucket_count() * sizeof(void*);
+   result += ( totals.votes.capacity() + totals.witness_counts.capacity() + totals.committee_counts.capacity() )
+             * sizeof(uint64_t);
+   return result;
+}
+
 } } // graphene::chain
 
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::account_object,
@@ -1439,11 +1439,8 @@ void_result asset_publish_feeds_evaluator::do_apply(const asset_publish_feed_ope
    auto old_feed = bad.current_feed;
    auto old_median_feed = bad.median_feed;
    // Store medians for this asset
-   d.modify( bad , [&o,&head_time](asset_bitasset_data_object& a) {
-      a.feeds[o.publisher] = make_pair( head_time, price_feed_with_icr( o.feed,
-                                                      o.extensions.value.initial_collateral_ratio ) );
-   });
-   d.update_bitasset_current_feed( bad );
+   d.publish_bitasset_feed( bad, o.publisher,
+                            price_feed_with_icr( o.feed, o.extensions.value.initial_collateral_ratio ) );
 
    bool after_core_hardfork_2582 = HARDFORK_CORE_2582_PASSED( head_time ); // Price feed issues
 
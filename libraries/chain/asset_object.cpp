@@ -50,6 +50,7 @@ void asset_bitasset_data_object::update_median_feeds( time_point_sec current_tim
    bool after_core_hardfork_1270 = ( next_maintenance_time > HARDFORK_CORE_1270_TIME ); // call price caching issue
    current_feed_publication_time = current_time;
    vector<std::reference_wrapper<const price_feed_with_icr>> effective_feeds;
+   effective_feeds.reserve( feeds.size() );
    // find feeds that were alive at current_time
    for( const pair<account_id_type, pair<time_point_sec,price_feed_with_icr>>& f : feeds )
    {
@@ -219,6 +220,44 @@ string asset_object::amount_to_string(share_type amount) const
    return result;
 }
 
+void resolved_asset_index::object_inserted( const object& obj )
+{
+   object_modified( obj );
+}
+
+void resolved_asset_index::object_removed( const object& obj )
+{
+   const auto instance = obj.id.instance();
+   if( instance < _assets.size() )
+      _assets[instance] = resolved_asset();
+}
+
+void resolved_asset_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const asset_object*>(&after) );
+   const asset_object& a = static_cast<const asset_object&>(after);
+   const auto instance = a.id.instance();
+   if( instance >= _assets.size() )
+      _assets.resize( instance + 1 );
+   resolved_asset& entry = _assets[instance];
+   entry.asset = &a;
+   entry.dynamic_data = _db.find( a.dynamic_asset_data_id );
+   entry.bitasset_data = a.bitasset_data_id.valid() ? _db.find( *a.bitasset_data_id ) : nullptr;
+}
+
+const resolved_asset* resolved_asset_index::find( asset_id_type id )const
+{
+   const auto instance = id.instance.value;
+   if( instance >= _assets.size() )
+      return nullptr;
+   const resolved_asset& entry = _assets[instance];
+   // The data objects could be missing if they were not in place yet when the asset was inserted
+   if( nullptr == entry.asset || nullptr == entry.dynamic_data
+         || entry.asset->bitasset_data_id.valid() != ( nullptr != entry.bitasset_data ) )
+      return nullptr;
+   return &entry;
+}
+
 } } // namespace graphene::chain
 
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::asset_dynamic_data_object, (graphene::db::object),
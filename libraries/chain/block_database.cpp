@@ -22,10 +22,14 @@
  * THE SOFTWARE.
  */
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/mapped_file_view.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
 #include <fc/io/raw.hpp>
 #include <boost/endian/buffers.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace graphene { namespace chain {
 
 struct index_entry
@@ -43,8 +47,21 @@ FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
-void block_database::open( const fc::path& dbdir )
+block_database::block_database() = default;
+
+block_database::~block_database()
+{
+   stop_writer();
+}
+
+void block_database::open( const fc::path& dbdir, const segmented_block_log::settings& new_format )
 { try {
+   if( segmented_block_log::exists( dbdir )
+         || ( new_format.blocks_per_segment > 0 && !fc::exists( dbdir / "index" ) ) )
+   {
+      _segmented = std::make_unique<segmented_block_log>( dbdir, new_format );
+      return;
+   }
    fc::create_directories(dbdir);
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
@@ -60,25 +77,260 @@ void block_database::open( const fc::path& dbdir )
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
      _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
    }
+   _index_view = std::make_unique<mapped_file_view>( _index_filename );
+   _blocks_view = std::make_unique<mapped_file_view>( dbdir / "blocks" );
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
 bool block_database::is_open()const
 {
-  return _blocks.is_open();
+  return _segmented || _blocks.is_open();
 }
 
 void block_database::close()
 {
+  stop_writer();
+  if( _segmented )
+  {
+     _segmented.reset();
+     return;
+  }
+  _index_view.reset();
+  _blocks_view.reset();
   _blocks.close();
   _block_num_to_pos.close();
 }
 
 void block_database::flush()
 {
+  {
+     std::unique_lock<std::mutex> lock( _write_mutex );
+     wait_for_writer( lock );
+  }
+  flush_files();
+}
+
+void block_database::flush_files()
+{
+  if( _segmented )
+  {
+     _segmented->flush();
+     return;
+  }
   _blocks.flush();
   _block_num_to_pos.flush();
 }
 
+void block_database::set_write_queue_size( uint32_t blocks )
+{
+   if( blocks == 0 )
+   {
+      {
+         std::unique_lock<std::mutex> lock( _write_mutex );
+         wait_for_writer( lock );
+      }
+      stop_writer();
+   }
+   _write_queue_size = blocks;
+}
+
+void block_database::request_flush( uint32_t block_num )
+{
+   if( _write_queue_size == 0 || block_num == 0 )
+      return;
+   {
+      std::lock_guard<std::mutex> lock( _write_mutex );
+      if( _write_error || block_num <= _flush_up_to )
+         return;
+      _flush_up_to = block_num;
+      start_writer();
+   }
+   _write_ready.notify_one();
+}
+
+void block_database::wait_for_writer( std::unique_lock<std::mutex>& lock )
+{
+   _write_done.wait( lock, [this]() {
+      return _write_error || ( _queued.empty() && !_writer_busy && _flush_up_to == 0 && _prune_first_kept == 0 );
+   } );
+   if( _write_error )
+      std::rethrow_exception( _write_error );
+}
+
+void block_database::start_writer()
+{
+   if( !_writer.joinable() )
+      _writer = std::thread( [this]() { write_queued_blocks(); } );
+}
+
+void block_database::stop_writer()
+{
+   if( !_writer.joinable() )
+      return;
+   {
+      std::lock_guard<std::mutex> lock( _write_mutex );
+      _stop_writer = true;
+   }
+   _write_ready.notify_one();
+   _writer.join();
+
+   std::lock_guard<std::mutex> lock( _write_mutex );
+   if( _write_error )
+   {
+      try {
+         std::rethrow_exception( _write_error );
+      } catch( const fc::exception& e ) {
+         elog( "Failed to write to the block database: ${e}", ("e",e.to_detail_string()) );
+      } catch( const std::exception& e ) {
+         elog( "Failed to write to the block database: ${e}", ("e",e.what()) );
+      }
+   }
+   if( !_queued.empty() )
+      elog( "${n} blocks have not been written to the block database", ("n",_queued.size()) );
+   _queued.clear();
+   _queued_count.store( 0, std::memory_order_release );
+   _stop_writer = false;
+   _flush_up_to = 0;
+   _prune_first_kept = 0;
+   _write_error = nullptr;
+}
+
+void block_database::write_queued_blocks()
+{
+   std::unique_lock<std::mutex> lock( _write_mutex );
+   while( true )
+   {
+      _write_ready.wait( lock, [this]() {
+         return _stop_writer || !_queued.empty() || _flush_up_to > 0 || _prune_first_kept > 0;
+      } );
+
+      // flush as soon as the requested blocks are written, prune before writing more
+      const bool flush_now = _flush_up_to > 0 && ( _queued.empty() || _queued.begin()->first > _flush_up_to );
+      const uint32_t prune_first_kept = flush_now ? 0 : _prune_first_kept;
+      optional<queued_block> next;
+      uint32_t next_num = 0;
+      if( flush_now )
+         _flush_up_to = 0;
+      else if( prune_first_kept > 0 )
+         _prune_first_kept = 0;
+      else if( !_queued.empty() )
+      {
+         next_num = _queued.begin()->first;
+         next = _queued.begin()->second;
+      }
+      else // stopped and nothing left to do
+         return;
+
+      _writer_busy = true;
+      lock.unlock();
+      std::exception_ptr error;
+      try
+      {
+         if( flush_now )
+            flush_files();
+         else if( prune_first_kept > 0 )
+            prune_blocks( prune_first_kept );
+         else
+            write_block( next->id, *next->block );
+      }
+      catch( ... )
+      {
+         error = std::current_exception();
+      }
+      lock.lock();
+      _writer_busy = false;
+
+      if( error )
+      {
+         // the unwritten blocks stay available for lookups
+         _write_error = error;
+         _write_done.notify_all();
+         return;
+      }
+      if( next.valid() )
+      {
+         // the block may have been replaced while it was written
+         auto itr = _queued.find( next_num );
+         if( itr != _queued.end() && itr->second.block == next->block )
+         {
+            _queued.erase( itr );
+            _queued_count.store( _queued.size(), std::memory_order_release );
+         }
+      }
+      _write_done.notify_all();
+   }
+}
+
+optional<block_database::queued_block> block_database::find_queued( uint32_t block_num )const
+{
+   if( _queued_count.load( std::memory_order_acquire ) == 0 )
+      return {};
+   std::lock_guard<std::mutex> lock( _write_mutex );
+   auto itr = _queued.find( block_num );
+   if( itr == _queued.end() )
+      return {};
+   return itr->second;
+}
+
+bool block_database::read_index_entry( uint32_t block_num, index_entry& e )const
+{
+   FC_ASSERT( _index_view, "The block database is not open" );
+   const uint64_t index_pos = sizeof(e) * uint64_t(block_num);
+   while( true )
+   {
+      const uint64_t writes = _index_writes.load( std::memory_order_acquire );
+      if( writes % 2 == 0 )
+      {
+         if( !_index_view->read( index_pos, sizeof(e), (char*)&e ) )
+            return false;
+         std::atomic_thread_fence( std::memory_order_acquire );
+         if( _index_writes.load( std::memory_order_relaxed ) == writes )
+            return true;
+      }
+      std::this_thread::yield();
+   }
+}
+
+void block_database::write_index_entry( uint32_t block_num, const index_entry& e )
+{
+   const uint64_t index_pos = sizeof(e) * uint64_t(block_num);
+   _index_writes.fetch_add( 1 );
+   try {
+      _block_num_to_pos.seekp( index_pos );
+      _block_num_to_pos.write( (const char*)&e, sizeof(e) );
+      _block_num_to_pos.flush();
+      _index_view->resize( std::max( _index_view->size(), index_pos + sizeof(e) ) );
+   } catch( ... ) {
+      _index_writes.fetch_add( 1 );
+      throw;
+   }
+   _index_writes.fetch_add( 1 );
+}
+
+void block_database::read_block( const index_entry& e, signed_block& result )const
+{
+   const char* data = _blocks_view->data( e.block_pos.value(), e.block_size.value() );
+   if( data != nullptr )
+      result.unpack_from( data, e.block_size.value() );
+   else // beyond the end of the file or crossing a segment boundary
+   {
+      vector<char> buffer( e.block_size.value() );
+      FC_ASSERT( _blocks_view->read( e.block_pos.value(), buffer.size(), buffer.data() ),
+                 "Block ${id} is beyond the end of the block file", ("id",e.block_id) );
+      result.unpack_from( buffer.data(), buffer.size() );
+   }
+   FC_ASSERT( result.id() == e.block_id );
+   _last_read_end.store( e.block_pos.value() + e.block_size.value(), std::memory_order_relaxed );
+}
+
+vector<char> block_database::read_packed_block( const index_entry& e )const
+{
+   vector<char> result( e.block_size.value() );
+   FC_ASSERT( _blocks_view->read( e.block_pos.value(), result.size(), result.data() ),
+              "Block ${id} is beyond the end of the block file", ("id",e.block_id) );
+   _last_read_end.store( e.block_pos.value() + e.block_size.value(), std::memory_order_relaxed );
+   return result;
+}
+
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
    block_id_type id = _id;
@@ -87,7 +339,30 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
-   _block_num_to_pos.seekp( sizeof( index_entry ) * int64_t(block_header::num_from_id(id)) );
+   if( _write_queue_size == 0 )
+   {
+      write_block( id, b );
+      return;
+   }
+   {
+      std::unique_lock<std::mutex> lock( _write_mutex );
+      _write_done.wait( lock, [this]() { return _write_error || _queued.size() < _write_queue_size; } );
+      if( _write_error )
+         std::rethrow_exception( _write_error );
+      _queued[ block_header::num_from_id( id ) ] = queued_block{ id, std::make_shared<const signed_block>( b ) };
+      _queued_count.store( _queued.size(), std::memory_order_release );
+      start_writer();
+   }
+   _write_ready.notify_one();
+}
+
+void block_database::write_block( const block_id_type& id, const signed_block& b )
+{
+   if( _segmented )
+   {
+      _segmented->store( id, b );
+      return;
+   }
    index_entry e;
    _blocks.seekp( 0, _blocks.end );
    auto vec = fc::raw::pack( b );
@@ -95,25 +370,31 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
    e.block_size = vec.size();
    e.block_id   = id;
    _blocks.write( vec.data(), vec.size() );
-   _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   // the data must be in the file before readers can find it through the index
+   _blocks.flush();
+   _blocks_view->resize( e.block_pos.value() + vec.size() );
+   write_index_entry( block_header::num_from_id(id), e );
 }
 
 void block_database::remove( const block_id_type& id )
 { try {
+   {
+      std::unique_lock<std::mutex> lock( _write_mutex );
+      wait_for_writer( lock );
+   }
+   if( _segmented )
+   {
+      _segmented->remove( id );
+      return;
+   }
    index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   if( !read_index_entry( block_header::num_from_id(id), e ) )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
    if( e.block_id == id )
    {
       e.block_size = 0;
-      _block_num_to_pos.seekp( sizeof(e) * int64_t(block_header::num_from_id(id)) );
-      _block_num_to_pos.write( (char*)&e, sizeof(e) );
+      write_index_entry( block_header::num_from_id(id), e );
    }
 } FC_CAPTURE_AND_RETHROW( (id) ) }
 
@@ -121,14 +402,15 @@ bool block_database::contains( const block_id_type& id )const
 {
    if( id == block_id_type() )
       return false;
+   optional<queued_block> queued = find_queued( block_header::num_from_id(id) );
+   if( queued.valid() )
+      return queued->id == id;
+   if( _segmented )
+      return _segmented->contains( id );
 
    index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() < int64_t(index_pos + sizeof(e)) )
+   if( !read_index_entry( block_header::num_from_id(id), e ) )
       return false;
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
    return e.block_id == id && e.block_size.value() > 0;
 }
@@ -136,40 +418,43 @@ bool block_database::contains( const block_id_type& id )const
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
+   optional<queued_block> queued = find_queued( block_num );
+   if( queued.valid() )
+      return queued->id;
    index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_num);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   optional<block_id_type> segmented_id;
+   if( _segmented )
+      segmented_id = _segmented->fetch_block_id( block_num );
+   if( segmented_id.valid() )
+      e.block_id = *segmented_id;
+   else if( _segmented || !read_index_entry( block_num, e ) )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
    FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
    return e.block_id;
 }
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
+   optional<queued_block> queued = find_queued( block_header::num_from_id(id) );
+   if( queued.valid() )
+   {
+      if( queued->id != id )
+         return {};
+      return *queued->block;
+   }
+   if( _segmented )
+      return _segmented->fetch_optional( id );
    try
    {
       index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
+      if( !read_index_entry( block_header::num_from_id(id), e ) )
          return {};
 
-      _block_num_to_pos.seekg( index_pos );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
       if( e.block_id != id ) return optional<signed_block>();
 
-      vector<char> data( e.block_size.value() );
-      _blocks.seekg( e.block_pos.value() );
-      if (e.block_size.value())
-         _blocks.read( data.data(), e.block_size.value() );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
+      signed_block result;
+      read_block( e, result );
       return result;
    }
    catch (const fc::exception&)
@@ -183,23 +468,54 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
 
 optional<signed_block> block_database::fetch_by_number( uint32_t block_num )const
 {
+   signed_block result;
+   if( !fetch_by_number( block_num, result ) )
+      return optional<signed_block>();
+   return result;
+}
+
+bool block_database::fetch_by_number( uint32_t block_num, signed_block& result )const
+{
+   optional<queued_block> queued = find_queued( block_num );
+   if( queued.valid() )
+   {
+      result = *queued->block;
+      return true;
+   }
+   if( _segmented )
+      return _segmented->fetch_by_number( block_num, result );
    try
    {
       index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_num);
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
+      if( !read_index_entry( block_num, e ) )
+         return false;
 
-      _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
+      read_block( e, result );
+      return true;
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return false;
+}
 
-      vector<char> data( e.block_size.value() );
-      _blocks.seekg( e.block_pos.value() );
-      _blocks.read( data.data(), e.block_size.value() );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+optional<vector<char>> block_database::fetch_packed_by_number( uint32_t block_num )const
+{
+   optional<queued_block> queued = find_queued( block_num );
+   if( queued.valid() )
+      return fc::raw::pack( *queued->block );
+   if( _segmented )
+      return _segmented->fetch_packed_by_number( block_num );
+   try
+   {
+      index_entry e;
+      if( !read_index_entry( block_num, e ) || e.block_size.value() == 0 )
+         return {};
+
+      return read_packed_block( e );
    }
    catch (const fc::exception&)
    {
@@ -207,7 +523,7 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    catch (const std::exception&)
    {
    }
-   return optional<signed_block>();
+   return {};
 }
 
 optional<index_entry> block_database::last_index_entry()const {
@@ -215,33 +531,23 @@ optional<index_entry> block_database::last_index_entry()const {
    {
       index_entry e;
 
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      std::streampos pos = _block_num_to_pos.tellg();
-      if( pos < long(sizeof(index_entry)) )
+      uint64_t pos = _index_view->size();
+      if( pos < sizeof(index_entry) )
          return optional<index_entry>();
 
       pos -= pos % sizeof(index_entry);
 
-      _blocks.seekg( 0, _block_num_to_pos.end );
-      const std::streampos blocks_size = _blocks.tellg();
+      const uint64_t blocks_size = _blocks_view->size();
       while( pos > 0 )
       {
          pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
-         if( _block_num_to_pos.gcount() == sizeof(e) && e.block_size.value() > 0
-                && int64_t(e.block_pos.value() + e.block_size.value()) <= blocks_size )
+         if( _index_view->read( pos, sizeof(e), (char*)&e ) && e.block_size.value() > 0
+                && e.block_pos.value() + e.block_size.value() <= blocks_size )
             try
             {
-               vector<char> data( e.block_size.value() );
-               _blocks.seekg( e.block_pos.value() );
-               _blocks.read( data.data(), e.block_size.value() );
-               if( _blocks.gcount() == long(e.block_size.value()) )
-               {
-                  const signed_block block = fc::raw::unpack<signed_block>(data);
-                  if( block.id() == e.block_id )
-                     return e;
-               }
+               signed_block block;
+               read_block( e, block );
+               return e;
             }
             catch (const fc::exception&)
             {
@@ -249,6 +555,8 @@ optional<index_entry> block_database::last_index_entry()const {
             catch (const std::exception&)
             {
             }
+         // readers must not touch the truncated part of the mapping
+         _index_view->resize( pos );
          fc::resize_file( _index_filename, pos );
       }
    }
@@ -263,27 +571,73 @@ optional<index_entry> block_database::last_index_entry()const {
 
 optional<signed_block> block_database::last()const
 {
-   optional<index_entry> entry = last_index_entry();
-   if( entry.valid() ) return fetch_by_number( block_header::num_from_id(entry->block_id) );
+   optional<block_id_type> id = last_id();
+   if( id.valid() ) return fetch_by_number( block_header::num_from_id(*id) );
    return optional<signed_block>();
 }
 
 optional<block_id_type> block_database::last_id()const
 {
-   optional<index_entry> entry = last_index_entry();
-   if( entry.valid() ) return entry->block_id;
-   return optional<block_id_type>();
+   optional<block_id_type> result;
+   if( _segmented )
+      result = _segmented->last_id();
+   else
+   {
+      optional<index_entry> entry = last_index_entry();
+      if( entry.valid() ) result = entry->block_id;
+   }
+   if( _queued_count.load( std::memory_order_acquire ) > 0 )
+   {
+      std::lock_guard<std::mutex> lock( _write_mutex );
+      if( !_queued.empty()
+            && ( !result.valid() || _queued.rbegin()->first > block_header::num_from_id(*result) ) )
+         result = _queued.rbegin()->second.id;
+   }
+   return result;
 }
 
 size_t block_database::blocks_current_position()const
 {
-   return (size_t)_blocks.tellg();
+   if( _segmented )
+      return (size_t)_segmented->blocks_current_position();
+   return (size_t)_last_read_end.load( std::memory_order_relaxed );
+}
+
+void block_database::prune( uint32_t first_kept_block )
+{
+   FC_ASSERT( _segmented, "Only segmented block databases can be pruned" );
+   if( _write_queue_size == 0 )
+   {
+      prune_blocks( first_kept_block );
+      return;
+   }
+   {
+      std::lock_guard<std::mutex> lock( _write_mutex );
+      if( _write_error )
+         std::rethrow_exception( _write_error );
+      if( first_kept_block <= _prune_first_kept )
+         return;
+      _prune_first_kept = first_kept_block;
+      start_writer();
+   }
+   _write_ready.notify_one();
+}
+
+void block_database::prune_blocks( uint32_t first_kept_block )
+{
+   _segmented->prune( first_kept_block );
+}
+
+uint32_t block_database::first_block_num()const
+{
+   return _segmented ? _segmented->first_block_num() : 1;
 }
 
 size_t block_database::total_block_size()const
 {
-   _blocks.seekg( 0, _blocks.end );
-   return (size_t)_blocks.tellg();
+   if( _segmented )
+      return (size_t)_segmented->total_block_size();
+   return (size_t)_blocks_view->size();
 }
 
 } }
@@ -38,6 +38,12 @@ asset database::get_balance(account_id_type owner, asset_id_type asset_id) const
    auto abo = index.get_account_balance( owner, asset_id );
    if( !abo )
       return asset(0, asset_id);
+   if( !_pending_balance_deltas.empty() )
+   {
+      const auto itr = _pending_balance_deltas.find( std::make_pair( owner, asset_id ) );
+      if( itr != _pending_balance_deltas.end() )
+         return asset( abo->balance + itr->second.delta, asset_id );
+   }
    return abo->get_balance();
 }
 
@@ -71,6 +77,14 @@ void database::adjust_balance(account_id_type account, asset delta )
          if( b.asset_type == asset_id_type() ) // CORE asset
             b.maintenance_flag = true;
       });
+   } else if( _buffer_balance_deltas ) {
+      auto& pending = _pending_balance_deltas[ std::make_pair( account, delta.asset_id ) ];
+      pending.balance = abo;
+      const asset balance( abo->balance + pending.delta, delta.asset_id );
+      if( delta.amount < 0 )
+         FC_ASSERT( balance >= -delta, "Insufficient Balance: ${a}'s balance of ${b} is less than required ${r}",
+                    ("a",account(*this).name)("b",to_pretty_string(balance))("r",to_pretty_string(-delta)));
+      pending.delta += delta.amount;
    } else {
       if( delta.amount < 0 )
          FC_ASSERT( abo->get_balance() >= -delta, "Insufficient Balance: ${a}'s balance of ${b} is less than required ${r}",
@@ -82,6 +96,23 @@ void database::adjust_balance(account_id_type account, asset delta )
 
 } FC_CAPTURE_AND_RETHROW( (account)(delta) ) }
 
+void database::flush_balance_deltas()
+{
+   // cleared first, so that a failure does not leave deltas behind which have partly been applied
+   auto pending = std::move( _pending_balance_deltas );
+   _pending_balance_deltas.clear();
+   for( const auto& item : pending )
+   {
+      // the balance is unchanged and so are the votes which depend on it, no need to flag it for maintenance
+      if( item.second.delta == 0 )
+         continue;
+      const asset delta( item.second.delta, item.first.second );
+      modify( *item.second.balance, [&delta]( account_balance_object& b ) {
+         b.adjust_balance( delta );
+      });
+   }
+}
+
 namespace detail {
 
    /**
@@ -25,8 +25,12 @@
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/db_with.hpp>
 #include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/impacted.hpp>
 
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/block_summary_object.hpp>
+#include <graphene/chain/custom_authority_object.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 
@@ -42,9 +46,106 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/thread/parallel.hpp>
+#include <fc/thread/thread.hpp>
 
 namespace graphene { namespace chain {
 
+namespace {
+
+/// Adds the time until it is stopped or destroyed to a counter of an apply profile, does nothing without a counter
+class apply_profile_timer
+{
+   public:
+      explicit apply_profile_timer( uint64_t* microseconds )
+         : _microseconds( microseconds ),
+           _start( microseconds != nullptr ? fc::time_point::now() : fc::time_point() ) {}
+      apply_profile_timer( apply_profile* profile, uint64_t apply_profile::* counter )
+         : apply_profile_timer( profile != nullptr ? &( profile->*counter ) : nullptr ) {}
+      apply_profile_timer( const apply_profile_timer& ) = delete;
+      apply_profile_timer& operator=( const apply_profile_timer& ) = delete;
+      ~apply_profile_timer() { stop(); }
+
+      void stop()
+      {
+         if( _microseconds == nullptr )
+            return;
+         *_microseconds += ( fc::time_point::now() - _start ).count();
+         _microseconds = nullptr;
+      }
+
+   private:
+      uint64_t*      _microseconds;
+      fc::time_point _start;
+};
+
+/**
+ * @return the number of commitments the validation of the confidential operations of the transaction sums up, each
+ *         of them costs about as much as recovering a signature
+ */
+size_t confidential_commitment_count( const transaction& trx )
+{
+   size_t result = 0;
+   for( const auto& op : trx.operations )
+   {
+      if( op.is_type<transfer_to_blind_operation>() )
+         result += op.get<transfer_to_blind_operation>().outputs.size() + 1;
+      else if( op.is_type<blind_transfer_operation>() )
+      {
+         const auto& blind = op.get<blind_transfer_operation>();
+         result += blind.inputs.size() + blind.outputs.size();
+      }
+      else if( op.is_type<transfer_from_blind_operation>() )
+         result += op.get<transfer_from_blind_operation>().inputs.size() + 1;
+   }
+   return result;
+}
+
+/// Gets the fee and the fee payer of an operation
+struct operation_fee_visitor
+{
+   typedef void result_type;
+
+   asset           fee;
+   account_id_type payer;
+
+   template<typename Op>
+   void operator()( const Op& op )
+   {
+      fee = op.fee;
+      payer = op.fee_payer();
+   }
+};
+
+} // anonymous namespace
+
+class database::state_write_scope {
+public:
+   explicit state_write_scope( database& db ) : _db( db )
+   {
+      if( 0 == _db._state_write_depth )
+         _db._state_mutex.lock();
+      ++_db._state_write_depth;
+   }
+   ~state_write_scope()
+   {
+      if( 0 == --_db._state_write_depth )
+         _db._state_mutex.unlock();
+   }
+private:
+   database& _db;
+};
+
+boost::shared_lock<boost::shared_mutex> database::lock_state_for_reading()const
+{
+   return boost::shared_lock<boost::shared_mutex>( _state_mutex );
+}
+
+void database::with_state_write_lock( const std::function<void()>& f )
+{
+   state_write_scope write_scope( *this );
+   f();
+}
+
 bool database::is_known_block( const block_id_type& id )const
 {
    return _fork_db.is_known_block(id) || _block_id_to_block.contains(id);
@@ -68,7 +169,7 @@ block_id_type  database::get_block_id_for_num( uint32_t block_num )const
 optional<signed_block> database::fetch_block_by_id( const block_id_type& id )const
 {
    auto b = _fork_db.fetch_block( id );
-   if( !b )
+   if( !b || !b->has_body )
       return _block_id_to_block.fetch_optional(id);
    return b->data;
 }
@@ -76,18 +177,39 @@ optional<signed_block> database::fetch_block_by_id( const block_id_type& id )con
 optional<signed_block> database::fetch_block_by_number( uint32_t num )const
 {
    auto results = _fork_db.fetch_block_by_number(num);
-   if( results.size() == 1 )
+   if( results.size() == 1 && results[0]->has_body )
       return results[0]->data;
    else
       return _block_id_to_block.fetch_by_number(num);
 }
 
+optional<vector<char>> database::fetch_packed_block_by_number( uint32_t num )const
+{
+   return _block_id_to_block.fetch_packed_by_number( num );
+}
+
+optional<vector<char>> database::fetch_packed_block_by_id( const block_id_type& id )const
+{
+   auto b = _fork_db.fetch_block( id );
+   if( b && b->has_body )
+      return fc::raw::pack( b->data );
+   if( !_block_id_to_block.contains( id ) )
+      return {};
+   return _block_id_to_block.fetch_packed_by_number( block_header::num_from_id( id ) );
+}
+
+uint32_t database::first_available_block_num()const
+{
+   return _block_id_to_block.first_block_num();
+}
+
 const signed_transaction& database::get_recent_transaction(const transaction_id_type& trx_id) const
 {
    auto& index = get_index_type<transaction_index>().indices().get<by_trx_id>();
    auto itr = index.find(trx_id);
    FC_ASSERT(itr != index.end());
-   return itr->trx;
+   FC_ASSERT( itr->trx.valid(), "Recent transactions are not stored" );
+   return *itr->trx;
 }
 
 std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of_fork) const
@@ -117,6 +239,7 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
 bool database::push_block(const signed_block& new_block, uint32_t skip)
 {
 //   idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   state_write_scope write_scope( *this );
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -153,6 +276,17 @@ bool database::_push_block(const signed_block& new_block)
       {
          wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
          auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
+         // the blocks of the current branch are needed to pop them and maybe to switch back
+         for( const auto& item : branches.second )
+            fork_block_body( *item );
+
+         // recover the signatures of the whole new branch in parallel, starting with the oldest block,
+         // while the current branch is popped
+         detail::block_precomputations precomputed;
+         for( auto ritr = branches.first.rbegin(); ritr != branches.first.rend(); ++ritr )
+         {
+            precomputed.add( (*ritr)->id, start_precompute( fork_block_body( **ritr ), skip ) );
+         }
 
          // pop blocks until we hit the forked block
          while( head_block_id() != branches.second.back()->data.previous )
@@ -167,6 +301,7 @@ bool database::_push_block(const signed_block& new_block)
                ilog( "pushing block from fork #${n} ${id}", ("n",(*ritr)->data.block_num())("id",(*ritr)->id) );
                optional<fc::exception> except;
                try {
+                  precomputed.wait( (*ritr)->id );
                   undo_database::session session = _undo_db.start_undo_session();
                   apply_block( (*ritr)->data, skip );
                   update_witnesses( **ritr );
@@ -224,9 +359,36 @@ bool database::_push_block(const signed_block& new_block)
       throw;
    }
 
+   prune_block_log();
+   // irreversible blocks are the durability points of the block database
+   _block_id_to_block.request_flush( get_dynamic_global_properties().last_irreversible_block_num );
+   _fork_db.release_bodies( [this]( const block_id_type& id ) { return _block_id_to_block.contains( id ); } );
+
    return false;
 } FC_CAPTURE_AND_RETHROW( (new_block) ) }
 
+void database::prune_block_log()
+{
+   if( _block_log_keep_blocks == 0 || head_block_num() < _block_log_keep_blocks )
+      return;
+   // reversible blocks are needed to switch forks
+   const uint32_t first_kept_block = std::min( head_block_num() - _block_log_keep_blocks + 1,
+                                               get_dynamic_global_properties().last_irreversible_block_num );
+   _block_id_to_block.prune( first_kept_block );
+}
+
+const signed_block& database::fork_block_body( fork_item& item )const
+{
+   if( !item.has_body )
+   {
+      optional<signed_block> body = _block_id_to_block.fetch_optional( item.id );
+      FC_ASSERT( body.valid(), "The transactions of block ${id} are not available", ("id",item.id) );
+      item.data = std::move( *body );
+      item.has_body = true;
+   }
+   return item.data;
+}
+
 void database::verify_signing_witness( const signed_block& new_block, const fork_item& fork_entry )const
 {
    FC_ASSERT( new_block.timestamp >= fork_entry.next_block_time );
@@ -268,15 +430,113 @@ void database::update_witnesses( fork_item& fork_entry )const
 processed_transaction database::push_transaction( const precomputable_transaction& trx, uint32_t skip )
 { try {
    // see https://github.com/bitshares/bitshares-core/issues/1573
-   FC_ASSERT( fc::raw::pack_size( trx ) < (1024 * 1024), "Transaction exceeds maximum transaction size." );
+   FC_ASSERT( trx.get_packed_size() + fc::raw::pack_size( trx.signatures ) < (1024 * 1024),
+              "Transaction exceeds maximum transaction size." );
+   state_write_scope write_scope( *this );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
-      result = _push_transaction( trx );
+      if( 0 == _max_pending_transactions || _pending_tx.size() < _max_pending_transactions )
+         result = _push_transaction( trx );
+      else
+         result = _push_transaction_into_full_pool( trx );
    } );
    return result;
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
 
+std::pair<double, account_id_type> database::get_transaction_fee_rate( const transaction& trx )const
+{
+   share_type core_fees = 0;
+   optional<account_id_type> payer;
+   for( const auto& op : trx.operations )
+   {
+      operation_fee_visitor v;
+      op.visit( v );
+      if( !payer.valid() )
+         payer = v.payer;
+      if( v.fee.asset_id == asset_id_type() )
+         core_fees += v.fee.amount;
+      else
+      {
+         // the fee asset of a transaction which is not validated yet may not exist
+         const asset_object* fee_asset = find( v.fee.asset_id );
+         if( fee_asset != nullptr )
+            core_fees += ( v.fee * fee_asset->options.core_exchange_rate ).amount;
+      }
+   }
+   return std::make_pair( double( core_fees.value ) / std::max<size_t>( 1, fc::raw::pack_size( trx ) ),
+                          payer.valid() ? *payer : account_id_type() );
+}
+
+processed_transaction database::_push_transaction_into_full_pool( const precomputable_transaction& trx )
+{
+   // The priority is the fee rate divided by the number of pending transactions of the fee payer including the
+   // new one, so that an account can not crowd out the others by paying slightly more than them
+   vector< std::pair<double, account_id_type> > fee_rates;
+   fee_rates.reserve( _pending_tx.size() );
+   flat_map<account_id_type, uint32_t> payer_counts;
+   for( const auto& tx : _pending_tx )
+   {
+      fee_rates.push_back( get_transaction_fee_rate( tx ) );
+      ++payer_counts[fee_rates.back().second];
+   }
+   vector< std::pair<double, size_t> > priorities;
+   priorities.reserve( fee_rates.size() );
+   for( size_t i = 0; i < fee_rates.size(); ++i )
+      priorities.emplace_back( fee_rates[i].first / payer_counts[fee_rates[i].second], i );
+
+   const auto fee_rate = get_transaction_fee_rate( trx );
+   const auto payer_itr = payer_counts.find( fee_rate.second );
+   const double priority = fee_rate.first / ( 1 + ( payer_itr != payer_counts.end() ? payer_itr->second : 0 ) );
+
+   // Rebuilding the pool reapplies the remaining transactions, so a batch of them is evicted at once
+   const size_t batch_size = std::min( priorities.size(), std::max<size_t>( 1, _max_pending_transactions / 16 ) );
+   std::partial_sort( priorities.begin(), priorities.begin() + batch_size, priorities.end() );
+   vector<bool> evicted( _pending_tx.size(), false );
+   size_t eviction_count = 0;
+   for( ; eviction_count < batch_size && priorities[eviction_count].first < priority; ++eviction_count )
+      evicted[priorities[eviction_count].second] = true;
+   if( 0 == eviction_count )
+      FC_THROW_EXCEPTION( pending_transaction_pool_full,
+                          "The priority ${p} of the transaction does not exceed the lowest pending one",
+                          ("p",priority)("pending",_pending_tx.size()) );
+
+   // Apply the transaction first, so that an invalid one does not evict anything
+   processed_transaction result = _push_transaction( trx );
+
+   vector<processed_transaction> kept;
+   kept.reserve( _pending_tx.size() - eviction_count );
+   for( size_t i = 0; i < _pending_tx.size(); ++i )
+   {
+      if( i >= evicted.size() || !evicted[i] )
+         kept.push_back( std::move( _pending_tx[i] ) );
+   }
+   dlog( "Evicted ${n} low priority pending transactions", ("n",eviction_count) );
+   detail::without_pending_transactions( *this, std::move( kept ), [](){} );
+   return result;
+}
+
+uint64_t database::transfer_authority_change_count()const
+{
+   return get_index_type<account_index>().change_count()
+        + get_index_type<custom_authority_index>().change_count()
+        + get_index<global_property_object>().change_count();
+}
+
+bool database::is_plain_transfer_transaction( const transaction& trx )const
+{
+   const auto& custom_auths = get_index_type<custom_authority_index>().indices().get<by_account_custom>();
+   for( const auto& op : trx.operations )
+   {
+      if( !op.is_type<transfer_operation>() )
+         return false;
+      const account_id_type from = op.get<transfer_operation>().from;
+      if( custom_auths.find( from ) != custom_auths.end() )
+         return false;
+   }
+   return true;
+}
+
 processed_transaction database::_push_transaction( const precomputable_transaction& trx )
 {
    // If this is the first transaction pushed after applying a block, start a new undo session.
@@ -289,13 +549,17 @@ processed_transaction database::_push_transaction( const precomputable_transacti
    // _apply_transaction fails.  If we make it to merge(), we
    // apply the changes.
 
+   // Changes are reported to API-only secondary indexes once the transaction is done.
+   secondary_index_batch sindex_batch( *this );
    auto temp_session = _undo_db.start_undo_session();
    auto processed_trx = _apply_transaction( trx );
    _pending_tx.push_back(processed_trx);
+   ++_pending_tx_version;
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
    temp_session.merge();
+   sindex_batch.end();
 
    // notify anyone listening to pending transactions
    notify_on_pending_transaction( trx );
@@ -304,10 +568,30 @@ processed_transaction database::_push_transaction( const precomputable_transacti
 
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
+   state_write_scope write_scope( *this );
    auto session = _undo_db.start_undo_session();
    return _apply_transaction( trx );
 }
 
+/// Writes the balance changes collected so far and lets the operations of a proposal collect their own, so that
+/// they are undone together with the proposal if it fails
+class balance_delta_suspension {
+public:
+   balance_delta_suspension( bool& buffering, const std::function<void()>& flush )
+      : orig_value(buffering), flag(buffering)
+   {
+      if( orig_value )
+      {
+         flush();
+         flag = false;
+      }
+   }
+   ~balance_delta_suspension() { flag = orig_value; }
+private:
+   const bool orig_value;
+   bool& flag;
+};
+
 class push_proposal_nesting_guard {
 public:
    push_proposal_nesting_guard( uint32_t& nesting_counter, const database& db )
@@ -338,6 +622,7 @@ processed_transaction database::push_proposal(const proposal_object& proposal)
 
    try {
       push_proposal_nesting_guard guard( _push_proposal_nesting_depth, *this );
+      balance_delta_suspension suspension( _buffer_balance_deltas, [this]() { flush_balance_deltas(); } );
       if( _undo_db.size() >= _undo_db.max_size() )
          _undo_db.set_max_size( _undo_db.size() + 1 );
       auto session = _undo_db.start_undo_session(true);
@@ -362,6 +647,7 @@ processed_transaction database::push_proposal(const proposal_object& proposal)
       {
          _applied_ops.resize( old_applied_ops_size );
       }
+      _applied_ops_impacted_accounts_valid = false;
       wlog( "${e}", ("e",e.to_detail_string() ) );
       throw;
    }
@@ -377,6 +663,7 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 { try {
+   state_write_scope write_scope( *this );
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -409,6 +696,9 @@ signed_block database::_generate_block(
    // the value of the "when" variable is known, which means we need to
    // re-apply pending transactions in this method.
    //
+   // A candidate prepared by prepare_block_candidate() on top of the same
+   // head block and pending transactions is used as is instead.
+   //
 
    // pop pending state (reset to head block state)
    _pending_tx_session.reset();
@@ -424,6 +714,69 @@ signed_block database::_generate_block(
       FC_ASSERT( witness_id(*this).signing_key == block_signing_private_key.get_public_key() );
    }
 
+   signed_block pending_block;
+   merkle_accumulator merkle;
+   block_generation_timings timings;
+   fc::time_point step_start = fc::time_point::now();
+
+   if( is_block_candidate_current( witness_id, skip ) )
+   {
+      // the pending transactions have been applied with the same skip flags on top of the same head block
+      // already, their results would not differ at this point
+      pending_block.transactions = std::move( _block_candidate->transactions );
+      merkle = std::move( _block_candidate->merkle );
+      timings.candidate_used = true;
+   }
+   else
+      pending_block.transactions = _select_block_transactions( witness_id, _pending_tx, nullptr, nullptr, merkle );
+   _block_candidate.reset();
+   ++_pending_tx_version;
+
+   _pending_tx_session.reset();
+
+   // We have temporarily broken the invariant that
+   // _pending_tx_session is the result of applying _pending_tx, as
+   // _pending_tx now consists of the set of postponed transactions.
+   // However, the push_block() call below will re-create the
+   // _pending_tx_session.
+
+   fc::time_point step_end = fc::time_point::now();
+   if( !timings.candidate_used )
+      timings.select_transactions = step_end - step_start;
+   step_start = step_end;
+
+   pending_block.previous = head_block_id();
+   pending_block.timestamp = when;
+   // the digests were accumulated while the transactions were selected
+   pending_block.set_merkle_root( merkle );
+   pending_block.witness = witness_id;
+
+   step_end = fc::time_point::now();
+   timings.merkle_root = step_end - step_start;
+   step_start = step_end;
+
+   if( 0 == (skip & skip_witness_signature) )
+      pending_block.sign( block_signing_private_key );
+
+   step_end = fc::time_point::now();
+   timings.sign = step_end - step_start;
+   step_start = step_end;
+
+   push_block( pending_block, skip | skip_transaction_signatures ); // skip authority check when pushing self-generated blocks
+
+   timings.push_block = fc::time_point::now() - step_start;
+   _last_block_generation_timings = timings;
+
+   return pending_block;
+} FC_CAPTURE_AND_RETHROW( (witness_id) ) }
+
+vector<processed_transaction> database::_select_block_transactions(
+   witness_id_type witness_id,
+   const vector<processed_transaction>& transactions,
+   vector<processed_transaction>* applied,
+   vector<processed_transaction>* postponed,
+   merkle_accumulator& merkle )
+{
    static const size_t max_partial_block_header_size = fc::raw::pack_size( signed_block_header() )
                                                        - fc::raw::pack_size( witness_id_type() ) // witness_id
                                                        + 3; // max space to store size of transactions (out of block header),
@@ -432,12 +785,13 @@ signed_block database::_generate_block(
    auto maximum_block_size = get_global_properties().parameters.maximum_block_size;
    size_t total_block_size = max_block_header_size;
 
-   signed_block pending_block;
+   vector<processed_transaction> result;
 
+   _pending_tx_session.reset();
    _pending_tx_session = _undo_db.start_undo_session();
 
    uint64_t postponed_tx_count = 0;
-   for( const processed_transaction& tx : _pending_tx )
+   for( const processed_transaction& tx : transactions )
    {
       size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
 
@@ -445,6 +799,8 @@ signed_block database::_generate_block(
       if( new_total_size > maximum_block_size )
       {
          postponed_tx_count++;
+         if( postponed != nullptr )
+            postponed->push_back( tx );
          continue;
       }
 
@@ -452,6 +808,8 @@ signed_block database::_generate_block(
       {
          auto temp_session = _undo_db.start_undo_session();
          processed_transaction ptx = _apply_transaction( tx );
+         if( applied != nullptr )
+            applied->push_back( ptx );
          // Clear results to save disk space and network bandwidth.
          // This may break client applications which rely on the results.
          ptx.operation_results.clear();
@@ -464,13 +822,18 @@ signed_block database::_generate_block(
          if( new_total_size > maximum_block_size )
          {
             postponed_tx_count++;
+            if( applied != nullptr )
+               applied->pop_back();
+            if( postponed != nullptr )
+               postponed->push_back( tx );
             continue;
          }
 
          temp_session.merge();
 
          total_block_size = new_total_size;
-         pending_block.transactions.push_back( ptx );
+         merkle.append( ptx.merkle_digest() );
+         result.push_back( std::move( ptx ) );
       }
       catch ( const fc::exception& e )
       {
@@ -483,26 +846,47 @@ signed_block database::_generate_block(
    {
       wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
    }
+   return result;
+}
 
-   _pending_tx_session.reset();
-
-   // We have temporarily broken the invariant that
-   // _pending_tx_session is the result of applying _pending_tx, as
-   // _pending_tx now consists of the set of postponed transactions.
-   // However, the push_block() call below will re-create the
-   // _pending_tx_session.
-
-   pending_block.previous = head_block_id();
-   pending_block.timestamp = when;
-   pending_block.transaction_merkle_root = pending_block.calculate_merkle_root();
-   pending_block.witness = witness_id;
-
-   if( 0 == (skip & skip_witness_signature) )
-      pending_block.sign( block_signing_private_key );
-
-   push_block( pending_block, skip | skip_transaction_signatures ); // skip authority check when pushing self-generated blocks
+bool database::is_block_candidate_current( witness_id_type witness_id, uint32_t skip )const
+{
+   return _block_candidate.valid() && _block_candidate->previous == head_block_id()
+          && _block_candidate->witness == witness_id && _block_candidate->skip == skip
+          && _block_candidate->pending_version == _pending_tx_version;
+}
 
-   return pending_block;
+bool database::prepare_block_candidate( witness_id_type witness_id, uint32_t skip )
+{ try {
+   state_write_scope write_scope( *this );
+   if( is_block_candidate_current( witness_id, skip ) )
+      return false;
+   detail::with_skip_flags( *this, skip, [&]()
+   {
+      block_candidate candidate;
+      candidate.previous = head_block_id();
+      candidate.witness = witness_id;
+      candidate.skip = skip;
+
+      vector<processed_transaction> pending = std::move( _pending_tx );
+      _pending_tx.clear();
+      vector<processed_transaction> postponed;
+      candidate.transactions = _select_block_transactions( witness_id, pending, &_pending_tx, &postponed,
+                                                           candidate.merkle );
+
+      // The pending session now holds the transactions of the candidate, which are the first pending
+      // transactions. The postponed ones follow them, as they would after the next block.
+      for( const processed_transaction& tx : postponed )
+      {
+         try {
+            _push_transaction( tx );
+         } catch ( const fc::exception& ) { // ignore invalid transactions
+         }
+      }
+      candidate.pending_version = ++_pending_tx_version;
+      _block_candidate = std::move( candidate );
+   } );
+   return true;
 } FC_CAPTURE_AND_RETHROW( (witness_id) ) }
 
 /**
@@ -511,6 +895,7 @@ signed_block database::_generate_block(
  */
 void database::pop_block()
 { try {
+   state_write_scope write_scope( *this );
    _pending_tx_session.reset();
    auto fork_db_head = _fork_db.head();
    FC_ASSERT( fork_db_head, "Trying to pop() from empty fork database!?" );
@@ -522,18 +907,38 @@ void database::pop_block()
       FC_ASSERT( fork_db_head, "Trying to pop() block that's not in fork database!?" );
    }
    pop_undo();
-   _popped_tx.insert( _popped_tx.begin(), fork_db_head->data.transactions.begin(), fork_db_head->data.transactions.end() );
+   publish_head_state();
+   const signed_block& popped = fork_block_body( *fork_db_head );
+   _popped_tx.insert( _popped_tx.begin(), popped.transactions.begin(), popped.transactions.end() );
 } FC_CAPTURE_AND_RETHROW() }
 
+void database::publish_head_state()
+{
+   const dynamic_global_property_object& dgp = get_dynamic_global_properties();
+   auto state = std::make_shared<head_state>();
+   state->block_num = dgp.head_block_number;
+   state->block_id = dgp.head_block_id;
+   state->time = dgp.time;
+   state->last_irreversible_block_num = dgp.last_irreversible_block_num;
+   state->current_witness = dgp.current_witness;
+   state->active_witness_count = get_global_properties().active_witnesses.size();
+   state->witness_participation = witness_participation_rate();
+   state->next_maintenance_time = dgp.next_maintenance_time;
+   std::atomic_store( &_head_state, std::shared_ptr<const head_state>( std::move( state ) ) );
+}
+
 void database::clear_pending()
 { try {
+   state_write_scope write_scope( *this );
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
    _pending_tx_session.reset();
+   ++_pending_tx_version;
 } FC_CAPTURE_AND_RETHROW() }
 
 uint32_t database::push_applied_operation( const operation& op )
 {
+   _applied_ops_impacted_accounts_valid = false;
    _applied_ops.emplace_back(op);
    operation_history_object& oh = *(_applied_ops.back());
    oh.block_num    = _current_block_num;
@@ -558,6 +963,24 @@ const vector<optional< operation_history_object > >& database::get_applied_opera
    return _applied_ops;
 }
 
+const vector< flat_set<account_id_type> >& database::get_applied_operations_impacted_accounts()const
+{
+   if( !_applied_ops_impacted_accounts_valid )
+   {
+      const bool ignore_custom_op_reqd_auths = MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( head_block_time() );
+      _applied_ops_impacted_accounts.resize( _applied_ops.size() );
+      for( size_t i = 0; i < _applied_ops.size(); ++i )
+      {
+         flat_set<account_id_type>& accounts = _applied_ops_impacted_accounts[i];
+         accounts.clear();
+         if( _applied_ops[i].valid() )
+            operation_get_impacted_accounts( _applied_ops[i]->op, accounts, ignore_custom_op_reqd_auths );
+      }
+      _applied_ops_impacted_accounts_valid = true;
+   }
+   return _applied_ops_impacted_accounts;
+}
+
 //////////////////// private methods ////////////////////
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
@@ -572,6 +995,14 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
       if( _checkpoints.rbegin()->first >= block_num )
          skip = ~0;// WE CAN SKIP ALMOST EVERYTHING
    }
+   if( _assume_valid_block != block_id_type() && block_num == block_header::num_from_id( _assume_valid_block ) )
+   {
+      FC_ASSERT( next_block.id() == _assume_valid_block, "Block did not match the assume-valid block",
+                 ("assume_valid_block",_assume_valid_block)("block_id",next_block.id()) );
+      ilog( "Reached the assume-valid block ${n} ${id}, validating all later blocks",
+            ("n",block_num)("id",_assume_valid_block) );
+   }
+   skip = add_assume_valid_skip_flags( block_num, skip );
 
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -585,10 +1016,11 @@ void database::_apply_block( const signed_block& next_block )
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = get_node_properties().skip_flags;
    _applied_ops.clear();
+   _applied_ops_impacted_accounts_valid = false;
 
    if( 0 == (skip & skip_block_size_check) )
    {
-      FC_ASSERT( fc::raw::pack_size(next_block) <= get_global_properties().parameters.maximum_block_size );
+      FC_ASSERT( next_block.get_packed_size() <= get_global_properties().parameters.maximum_block_size );
    }
 
    FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(),
@@ -613,7 +1045,16 @@ void database::_apply_block( const signed_block& next_block )
 
    _issue_453_affected_assets.clear();
 
+   // Changes are reported to API-only secondary indexes once per block, before plugins are notified.
+   secondary_index_batch sindex_batch( *this );
+
    signed_block processed_block( next_block ); // make a copy
+   if( _apply_profile != nullptr )
+   {
+      ++_apply_profile->blocks;
+      _apply_profile->transactions += processed_block.transactions.size();
+   }
+   apply_profile_timer transactions_timer( _apply_profile, &apply_profile::transaction_microseconds );
    for( auto& trx : processed_block.transactions )
    {
       /* We do not need to push the undo state for each transaction
@@ -625,6 +1066,7 @@ void database::_apply_block( const signed_block& next_block )
       trx.operation_results = apply_transaction( trx, skip ).operation_results;
       ++_current_trx_in_block;
    }
+   transactions_timer.stop();
 
    _current_op_in_trx    = 0;
    _current_virtual_op   = 0;
@@ -638,18 +1080,14 @@ void database::_apply_block( const signed_block& next_block )
 
    // Are we at the maintenance interval?
    if( maint_needed )
+   {
+      apply_profile_timer timer( _apply_profile, &apply_profile::maintenance_microseconds );
       perform_chain_maintenance( next_block );
+   }
 
    create_block_summary(next_block);
-   clear_expired_transactions();
-   clear_expired_proposals();
-   clear_expired_orders();
-   clear_expired_force_settlements();
-   clear_expired_htlcs();
-   update_expired_feeds();       // this will update expired feeds and some core exchange rates
-   update_core_exchange_rates(); // this will update remaining core exchange rates
-   update_withdraw_permissions();
-   update_credit_offers_and_deals();
+   // Most blocks have nothing to expire, only the sweeps which have something to do run
+   apply_expiration_sweeps();
 
    // n.b., update_maintenance_flag() happens this late
    // because get_slot_time() / get_slot_at_time() is needed above
@@ -661,13 +1099,95 @@ void database::_apply_block( const signed_block& next_block )
    if( !_node_property_object.debug_updates.empty() )
       apply_debug_updates();
 
+   sindex_batch.end();
+   publish_head_state();
+
    // notify observers that the block has been applied
+   apply_profile_timer handlers_timer( _apply_profile, &apply_profile::signal_handler_microseconds );
    notify_applied_block( processed_block ); //emit
    _applied_ops.clear();
+   _applied_ops_impacted_accounts_valid = false;
 
    notify_changed_objects();
+   notify_block_notifications_finished( processed_block );
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
 
+void database::apply_replicated_block( const signed_block& block, const vector<operation_history_object>& operations,
+                                       const vector<replicated_object_change>& changes )
+{ try {
+   state_write_scope write_scope( *this );
+   clear_pending();
+   while( head_block_num() >= block.block_num() )
+   {
+      ilog( "popping block #${n} ${id}", ("n",head_block_num())("id",head_block_id()) );
+      pop_block();
+   }
+   // the transactions of the popped blocks are not applied here
+   _popped_tx.clear();
+   FC_ASSERT( block.previous == head_block_id(), "Block ${n} does not link to the head block ${id}",
+              ("n",block.block_num())("id",head_block_id()) );
+
+   _fork_db.push_block( block );
+   try {
+      auto session = _undo_db.start_undo_session();
+      {
+         secondary_index_batch sindex_batch( *this );
+         for( const auto& change : changes )
+         {
+            index& idx = get_mutable_index( change.id );
+            const object* existing = idx.find( change.id );
+            if( change.data.empty() )
+            {
+               if( existing != nullptr )
+                  idx.remove( *existing );
+            }
+            else if( existing != nullptr )
+               idx.modify( *existing, [&idx,&change]( object& obj ) { idx.object_from_packed( change.data, obj ); } );
+            else
+            {
+               // the object is created with the id it has on the other node
+               const object_id_type next_id = idx.get_next_id();
+               idx.set_next_id( change.id );
+               idx.create( [&idx,&change]( object& obj ) { idx.object_from_packed( change.data, obj ); } );
+               if( next_id.instance() > change.id.instance() )
+                  idx.set_next_id( next_id );
+            }
+         }
+         sindex_batch.end();
+      }
+      FC_ASSERT( head_block_id() == block.id(), "The changes lead to block ${id}", ("id",head_block_id()) );
+
+      const dynamic_global_property_object& dgp = get_dynamic_global_properties();
+      _undo_db.set_max_size( dgp.head_block_number - dgp.last_irreversible_block_num + 1 );
+      _fork_db.set_max_size( dgp.head_block_number - dgp.last_irreversible_block_num + 1 );
+      _block_id_to_block.store( block.id(), block );
+      publish_head_state();
+
+      _current_block_num = block.block_num();
+      _applied_ops.clear();
+      _applied_ops.reserve( operations.size() );
+      for( const auto& op : operations )
+         _applied_ops.emplace_back( op );
+      _applied_ops_impacted_accounts_valid = false;
+      notify_applied_block( block );
+      _applied_ops.clear();
+      _applied_ops_impacted_accounts_valid = false;
+
+      notify_changed_objects();
+      notify_block_notifications_finished( block );
+      session.commit();
+   } catch ( const fc::exception& e ) {
+      elog( "Failed to apply the changes of block ${n}: ${e}", ("n",block.block_num())("e",e.to_detail_string()) );
+      _fork_db.remove( block.id() );
+      publish_head_state();
+      throw;
+   }
+
+   prune_block_log();
+   _block_id_to_block.request_flush( get_dynamic_global_properties().last_irreversible_block_num );
+   _fork_db.release_bodies( [this]( const block_id_type& id ) { return _block_id_to_block.contains( id ); } );
+} FC_CAPTURE_AND_RETHROW( (block.block_num())(block.id()) ) }
+
 /**
  * @note if a @c processed_transaction is passed in, it is cast into @c signed_transaction here.
  *       It also means that the @c operation_results field is ignored by consensus, although it
@@ -708,7 +1228,7 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
       auto get_active = [this]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [this]( account_id_type id ) { return &id(*this).owner;  };
       auto get_custom = [this]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
-         return get_viable_custom_authorities(id, op, rejects);
+         return get_viable_custom_authorities_cached(id, op, rejects);
       };
 
       trx.verify_authority(chain_id, get_active, get_owner, get_custom, allow_non_immediate_owner,
@@ -722,10 +1242,8 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       if( 0 == (skip & skip_tapos_check) )
       {
-         const auto& tapos_block_summary = block_summary_id_type( trx.ref_block_num )(*this);
-
          //Verify TaPoS block summary has correct ID prefix, and that this block's time is not past the expiration
-         FC_ASSERT( trx.ref_block_prefix == tapos_block_summary.block_id._hash[1].value() );
+         FC_ASSERT( trx.ref_block_prefix == _tapos_prefix_index->get_prefix( trx.ref_block_num ) );
       }
 
       fc::time_point_sec now = head_block_time();
@@ -742,16 +1260,21 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    //Insert transaction into unique transactions database.
    if( 0 == (skip & skip_transaction_dupe_check) )
    {
-      create<transaction_history_object>([&trx](transaction_history_object& transaction) {
+      create<transaction_history_object>([this,&trx](transaction_history_object& transaction) {
          transaction.trx_id = trx.id();
-         transaction.trx = trx;
+         transaction.expiration = trx.expiration;
+         if( _store_recent_transactions )
+            transaction.trx = trx;
       });
    }
 
    eval_state.operation_results.reserve(trx.operations.size());
 
    //Finally process the operations
-   processed_transaction ptrx(trx);
+   // keep the serialization and the other cached results of a precomputable transaction
+   const auto* precomputed = dynamic_cast<const precomputable_transaction*>( &trx );
+   processed_transaction ptrx = ( precomputed != nullptr ) ? processed_transaction( *precomputed )
+                                                           : processed_transaction( trx );
    _current_op_in_trx = 0;
    for( const auto& op : ptrx.operations )
    {
@@ -775,10 +1298,40 @@ operation_result database::apply_operation(transaction_evaluation_state& eval_st
    uint64_t u_which = uint64_t( i_which );
    FC_ASSERT( i_which >= 0, "Negative operation tag in operation ${op}", ("op",op) );
    FC_ASSERT( u_which < _operation_evaluators.size(), "No registered evaluator for operation ${op}", ("op",op) );
-   unique_ptr<op_evaluator>& eval = _operation_evaluators[ u_which ];
+   const operation_evaluate_function eval = _operation_evaluators[ u_which ];
    FC_ASSERT( eval, "No registered evaluator for operation ${op}", ("op",op) );
    auto op_id = push_applied_operation( op );
-   auto result = eval->evaluate( eval_state, op, true );
+   uint64_t* op_microseconds = nullptr;
+   if( _apply_profile != nullptr )
+   {
+      // sized once, so that the counter stays in place while a proposal applies nested operations
+      if( _apply_profile->operations.size() < _operation_evaluators.size() )
+         _apply_profile->operations.resize( _operation_evaluators.size() );
+      operation_apply_profile& op_profile = _apply_profile->operations[u_which];
+      ++op_profile.count;
+      op_microseconds = &op_profile.microseconds;
+   }
+   apply_profile_timer timer( op_microseconds );
+   // the outermost operation collects the balance changes and writes each changed balance once
+   const bool buffer_balances = !_buffer_balance_deltas;
+   _buffer_balance_deltas = true;
+   operation_result result;
+   try {
+      result = eval( eval_state, op, true );
+      if( buffer_balances )
+      {
+         _buffer_balance_deltas = false;
+         flush_balance_deltas();
+      }
+   } catch( ... ) {
+      // the changes are discarded with the undo session of the failed transaction
+      if( buffer_balances )
+      {
+         _buffer_balance_deltas = false;
+         _pending_balance_deltas.clear();
+      }
+      throw;
+   }
    set_applied_operation_result( op_id, result );
    return result;
 } FC_CAPTURE_AND_RETHROW( (op) ) }
@@ -825,6 +1378,13 @@ bool database::before_last_checkpoint()const
    return (_checkpoints.size() > 0) && (_checkpoints.rbegin()->first >= head_block_num());
 }
 
+uint32_t database::add_assume_valid_skip_flags( uint32_t block_num, uint32_t skip )const
+{
+   if( _assume_valid_block != block_id_type() && block_num <= block_header::num_from_id( _assume_valid_block ) )
+      return skip | assume_valid_skip_flags;
+   return skip;
+}
+
 
 static const uint32_t skip_expensive = database::skip_transaction_signatures | database::skip_witness_signature
                                        | database::skip_merkle_check | database::skip_transaction_dupe_check;
@@ -834,7 +1394,12 @@ void database::_precompute_parallel( const Trx* trx, const size_t count, const u
 {
    for( size_t i = 0; i < count; ++i, ++trx )
    {
-      trx->validate(); // TODO - parallelize wrt confidential operations
+      trx->validate(); // includes the checks of the commitments of confidential operations
+      for( const auto& op : trx->operations )
+      {
+         if( op.is_type<htlc_redeem_operation>() )
+            op.get<htlc_redeem_operation>().precompute_preimage_digests();
+      }
       if( 0 == (skip & skip_block_size_check) )
          trx->get_packed_size();
       if( 0 == (skip&skip_transaction_dupe_check) )
@@ -844,32 +1409,73 @@ void database::_precompute_parallel( const Trx* trx, const size_t count, const u
    }
 }
 
-fc::future<void> database::precompute_parallel( const signed_block& block, const uint32_t skip )const
-{ try {
+std::vector<fc::future<void>> database::start_precompute( const signed_block& block, const uint32_t requested_skip,
+                                                          const bool pipelined )const
+{
+   const uint32_t skip = add_assume_valid_skip_flags( block.block_num(), requested_skip );
    std::vector<fc::future<void>> workers;
+   // the id is cached in the block, it must not be computed concurrently later
+   block.id();
    if( !block.transactions.empty() )
    {
-      if( (skip & skip_expensive) == skip_expensive )
+      if( (skip & skip_expensive) == skip_expensive && !pipelined )
+      {
          _precompute_parallel( &block.transactions[0], block.transactions.size(), skip );
+         if( 0 == (skip&skip_merkle_check) )
+            block.calculate_merkle_root();
+      }
       else
       {
-         uint32_t chunks = fc::asio::default_io_service_scope::get_num_threads();
-         uint32_t chunk_size = ( block.transactions.size() + chunks - 1 ) / chunks;
-         workers.reserve( chunks + 1 );
-         for( size_t base = 0; base < block.transactions.size(); base += chunk_size )
-            workers.push_back( fc::do_parallel( [this,&block,base,chunk_size,skip] () {
-               _precompute_parallel( &block.transactions[base],
-                                     base + chunk_size < block.transactions.size() ? chunk_size : block.transactions.size() - base,
-                                     skip );
+         uint32_t chunks = precompute_thread_count();
+         workers.reserve( chunks + 3 );
+         // The stateless checks are done here, so that an invalid block is rejected before it is queued for
+         // the chain thread, which is left with the checks against the state
+         if( 0 == (skip&skip_merkle_check) )
+            workers.push_back( run_precompute_task( [&block] () {
+               FC_ASSERT( block.transaction_merkle_root == block.calculate_merkle_root(),
+                          "Merkle root of block ${id} does not match its transactions",
+                          ("id",block.id())("transaction_merkle_root",block.transaction_merkle_root)
+                          ("calc",block.calculate_merkle_root()) );
+            } ) );
+         // the limit is part of the state, only the size is computed here
+         if( 0 == (skip&skip_block_size_check) )
+            workers.push_back( run_precompute_task( [&block] () { block.get_packed_size(); } ) );
+         // Recovering the signatures and validating confidential transfers dominate the work, so the chunks hold
+         // about the same number of signatures and commitments rather than of transactions. Transactions with
+         // many of them would leave the other workers idle.
+         const bool check_signatures = ( 0 == (skip&skip_transaction_signatures) );
+         const auto weight_of = [check_signatures]( const precomputable_transaction& trx ) {
+            return 1 + ( check_signatures ? trx.signatures.size() : 0 ) + confidential_commitment_count( trx );
+         };
+         uint64_t total_weight = 0;
+         for( const auto& trx : block.transactions )
+            total_weight += weight_of( trx );
+         const uint64_t chunk_weight = ( total_weight + chunks - 1 ) / chunks;
+         size_t base = 0;
+         uint64_t weight = 0;
+         for( size_t i = 0; i < block.transactions.size(); ++i )
+         {
+            weight += weight_of( block.transactions[i] );
+            if( weight < chunk_weight && i + 1 < block.transactions.size() )
+               continue;
+            const size_t count = i + 1 - base;
+            workers.push_back( run_precompute_task( [this,&block,base,count,skip] () {
+               _precompute_parallel( &block.transactions[base], count, skip );
             }) );
+            base = i + 1;
+            weight = 0;
+         }
       }
    }
 
    if( 0 == (skip&skip_witness_signature) )
-      workers.push_back( fc::do_parallel( [&block] () { block.signee(); } ) );
-   if( 0 == (skip&skip_merkle_check) )
-      block.calculate_merkle_root();
-   block.id();
+      workers.push_back( run_precompute_task( [&block] () { block.signee(); } ) );
+   return workers;
+}
+
+fc::future<void> database::precompute_parallel( const signed_block& block, const uint32_t skip )const
+{ try {
+   std::vector<fc::future<void>> workers = start_precompute( block, skip );
 
    if( workers.empty() )
       return fc::future< void >( fc::promise< void >::create( true ) );
@@ -883,9 +1489,30 @@ fc::future<void> database::precompute_parallel( const signed_block& block, const
 
 fc::future<void> database::precompute_parallel( const precomputable_transaction& trx )const
 {
-   return fc::do_parallel([this,&trx] () {
+   return run_precompute_task([this,&trx] () {
       _precompute_parallel( &trx, 1, skip_nothing );
    });
 }
 
+void database::set_precompute_threads( std::vector< std::shared_ptr<fc::thread> > threads )
+{
+   _precompute_threads = std::move( threads );
+   _next_precompute_thread = 0;
+}
+
+fc::future<void> database::run_precompute_task( std::function<void()> task )const
+{
+   if( _precompute_threads.empty() )
+      return fc::do_parallel( std::move( task ) );
+   const size_t next = _next_precompute_thread++ % _precompute_threads.size();
+   return _precompute_threads[next]->async( std::move( task ), "precompute" );
+}
+
+uint32_t database::precompute_thread_count()const
+{
+   if( _precompute_threads.empty() )
+      return fc::asio::default_io_service_scope::get_num_threads();
+   return static_cast<uint32_t>( _precompute_threads.size() );
+}
+
 } }
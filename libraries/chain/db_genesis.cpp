@@ -56,6 +56,8 @@ void database::init_genesis(const genesis_state_type& genesis_state)
              "initial_active_witnesses is larger than the number of candidate witnesses.");
 
    _undo_db.disable();
+   // API-only secondary indexes are built once all the initial objects are in place
+   secondary_index_batch sindex_batch( *this );
    struct auth_inhibitor {
       explicit auth_inhibitor(database& db) : db(db), old_flags(db.node_properties().skip_flags)
       { db.node_properties().skip_flags |= skip_transaction_signatures; }
@@ -312,12 +314,17 @@ void database::init_genesis(const genesis_state_type& genesis_state)
    };
 
    // Helper function to get asset ID by symbol
+   // Note: consecutive balances are usually in the same asset, so the last result is reused
    const auto& assets_by_symbol = get_index_type<asset_index>().indices().get<by_symbol>();
-   const auto get_asset_id = [&assets_by_symbol](const string& symbol) {
+   const asset_object* last_found_asset = nullptr;
+   const auto get_asset_id = [&assets_by_symbol,&last_found_asset](const string& symbol) {
+      if( last_found_asset != nullptr && last_found_asset->symbol == symbol )
+         return last_found_asset->get_id();
       auto itr = assets_by_symbol.find(symbol);
       FC_ASSERT(itr != assets_by_symbol.end(),
                 "Unable to find asset '${sym}'. Did you forget to add a record for it to initial_assets?",
                 ("sym", symbol));
+      last_found_asset = &(*itr);
       return itr->get_id();
    };
 
@@ -527,6 +534,7 @@ void database::init_genesis(const genesis_state_type& genesis_state)
    // Enable fees
    modify(get_global_properties(), [&genesis_state](global_property_object& p) {
       p.parameters.get_mutable_fees() = genesis_state.initial_parameters.get_current_fees();
+      p.parameters.get_mutable_fees().update_index();
    });
 
    // Create witness scheduler
@@ -568,6 +576,7 @@ void database::init_genesis(const genesis_state_type& genesis_state)
 
    //debug_dump(); // for debug
 
+   sindex_batch.end();
    _undo_db.enable();
 } FC_CAPTURE_AND_RETHROW() }
 
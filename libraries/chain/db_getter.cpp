@@ -34,6 +34,32 @@
 
 namespace graphene { namespace chain {
 
+namespace {
+
+/// Evaluates the predicates of valid custom authorities against op, see database::get_viable_custom_authorities
+template<typename Auths>
+vector<authority> match_custom_authorities( const Auths& valid_auths, const operation& op,
+                                            rejected_predicate_map* rejected_authorities )
+{
+   vector<authority> results;
+   for( const auto& item : valid_auths ) {
+      const custom_authority_object& cust_auth = item.get();
+      try {
+         auto result = cust_auth.get_predicate()(op);
+         if (result.success)
+            results.emplace_back(cust_auth.auth);
+         else if (rejected_authorities != nullptr)
+            rejected_authorities->insert(std::make_pair(cust_auth.id, std::move(result)));
+      } catch (fc::exception& e) {
+         if (rejected_authorities != nullptr)
+            rejected_authorities->insert(std::make_pair(cust_auth.id, std::move(e)));
+      }
+   }
+   return results;
+}
+
+} // anonymous namespace
+
 const asset_object& database::get_core_asset() const
 {
    return *_p_core_asset_obj;
@@ -44,6 +70,19 @@ const asset_dynamic_data_object& database::get_core_dynamic_data() const
    return *_p_core_dynamic_data_obj;
 }
 
+resolved_asset database::get_resolved_asset( asset_id_type id )const
+{
+   const resolved_asset* cached = _resolved_asset_index->find( id );
+   if( cached != nullptr )
+      return *cached;
+   resolved_asset result;
+   result.asset = &id(*this);
+   result.dynamic_data = &result.asset->dynamic_data(*this);
+   if( result.asset->bitasset_data_id.valid() )
+      result.bitasset_data = &result.asset->bitasset_data(*this);
+   return result;
+}
+
 const global_property_object& database::get_global_properties()const
 {
    return *_p_global_prop_obj;
@@ -110,21 +149,46 @@ vector<authority> database::get_viable_custom_authorities(
    vector<std::reference_wrapper<const custom_authority_object>> valid_auths;
    std::copy_if(range.first, range.second, std::back_inserter(valid_auths), is_valid);
 
-   vector<authority> results;
-   for (const auto& cust_auth : valid_auths) {
-      try {
-         auto result = cust_auth.get().get_predicate()(op);
-         if (result.success)
-            results.emplace_back(cust_auth.get().auth);
-         else if (rejected_authorities != nullptr)
-            rejected_authorities->insert(std::make_pair(cust_auth.get().id, std::move(result)));
-      } catch (fc::exception& e) {
-         if (rejected_authorities != nullptr)
-            rejected_authorities->insert(std::make_pair(cust_auth.get().id, std::move(e)));
-      }
+   return match_custom_authorities( valid_auths, op, rejected_authorities );
+}
+
+vector<authority> database::get_viable_custom_authorities_cached(
+      account_id_type account, const operation &op,
+      rejected_predicate_map* rejected_authorities) const
+{
+   const auto& cust_auth_idx = get_index_type<custom_authority_index>();
+   const auto now = head_block_time();
+   // validity depends on the time, creating, updating, removing or expiring an authority changes the index
+   if( now != _custom_authority_cache_time || cust_auth_idx.change_count() != _custom_authority_cache_changes
+         || _custom_authority_cache.size() >= 10000 )
+   {
+      _custom_authority_cache.clear();
+      _custom_authority_cache_time = now;
+      _custom_authority_cache_changes = cust_auth_idx.change_count();
    }
 
-   return results;
+   auto itr = _custom_authority_cache.find( std::make_pair( account, op.which() ) );
+   if( itr == _custom_authority_cache.end() )
+   {
+      const auto& index = cust_auth_idx.indices().get<by_account_custom>();
+      auto range = index.equal_range(boost::make_tuple(account, unsigned_int(op.which()), true));
+      auto is_valid = [now]( const custom_authority_object& auth ) { return auth.is_valid( now ); };
+      vector<std::reference_wrapper<const custom_authority_object>> valid_auths;
+      std::copy_if( range.first, range.second, std::back_inserter( valid_auths ), is_valid );
+      itr = _custom_authority_cache.emplace( std::make_pair( account, op.which() ), std::move( valid_auths ) ).first;
+   }
+
+   return match_custom_authorities( itr->second, op, rejected_authorities );
+}
+
+const market_hardfork_era& database::get_market_hardfork_era()const
+{
+   const auto head_time = head_block_time();
+   const auto maint_time = get_dynamic_global_properties().next_maintenance_time;
+   if( !_market_hardfork_era.valid() || _market_hardfork_era->head_time != head_time
+         || _market_hardfork_era->maint_time != maint_time )
+      _market_hardfork_era = market_hardfork_era( head_time, maint_time );
+   return *_market_hardfork_era;
 }
 
 uint32_t database::last_non_undoable_block_num() const
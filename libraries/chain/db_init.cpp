@@ -153,13 +153,16 @@ void database::initialize_indexes()
    _undo_db.set_max_size( GRAPHENE_MIN_UNDO_HISTORY );
 
    //Protocol object indexes
-   add_index< primary_index<asset_index, 13> >(); // 8192 assets per chunk
+   auto asset_idx = add_index< primary_index<asset_index, 13> >(); // 8192 assets per chunk
+   _resolved_asset_index = asset_idx->add_secondary_index<resolved_asset_index>( this );
    add_index< primary_index<force_settlement_index> >();
 
-   add_index< primary_index<account_index, 20> >(); // ~1 million accounts per chunk
+   auto acnt_index = add_index< primary_index<account_index, 20> >(); // ~1 million accounts per chunk
+   _vote_tally_cache = acnt_index->add_secondary_index<vote_tally_cache>();
    add_index< primary_index<committee_member_index, 8> >(); // 256 members per chunk
    add_index< primary_index<witness_index, 10> >(); // 1024 witnesses per chunk
-   add_index< primary_index<limit_order_index > >();
+   auto limit_order_idx = add_index< primary_index<limit_order_index > >();
+   limit_order_idx->add_secondary_index<limit_order_price_level_index>();
    add_index< primary_index<call_order_index > >();
    add_index< primary_index<proposal_index > >();
    add_index< primary_index<withdraw_permission_index > >();
@@ -170,7 +173,7 @@ void database::initialize_indexes()
    add_index< primary_index< htlc_index> >();
    add_index< primary_index< custom_authority_index> >();
    add_index< primary_index<ticket_index> >();
-   add_index< primary_index<liquidity_pool_index> >();
+   add_index< primary_index<liquidity_pool_index, 10, flat_direct_index> >(); // 1024 pools per chunk
    add_index< primary_index<samet_fund_index> >();
    add_index< primary_index<credit_offer_index> >();
    add_index< primary_index<credit_deal_index> >();
@@ -186,7 +189,8 @@ void database::initialize_indexes()
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
    add_index< primary_index<account_stats_index,                       20 > >(); // 1 Mi
    add_index< primary_index<simple_index<asset_dynamic_data_object       >> >();
-   add_index< primary_index<simple_index<block_summary_object            >> >();
+   auto block_summary_idx = add_index< primary_index<simple_index<block_summary_object> > >();
+   _tapos_prefix_index = block_summary_idx->add_secondary_index<tapos_prefix_index>();
    add_index< primary_index<simple_index<chain_property_object          > > >();
    add_index< primary_index<simple_index<witness_schedule_object        > > >();
    add_index< primary_index<simple_index<budget_record_object           > > >();
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 
+#include <fc/thread/parallel.hpp>
 #include <fc/uint128.hpp>
 
 #include <graphene/protocol/market.hpp>
@@ -74,29 +75,82 @@ vector<std::reference_wrapper<const typename Index::object_type>> database::sort
    return refs;
 }
 
+/// Adds a phase to a maintenance profile and measures the time and the object changes until it is finished
+class maintenance_phase_timer
+{
+   public:
+      maintenance_phase_timer( const database& db, maintenance_profile& profile, const char* name,
+                               uint64_t objects_visited = 0 )
+         : _db( db ), _profile( profile ), _phase( profile.phases.size() ),
+           _changes_before( db.change_count() ), _start( fc::time_point::now() )
+      {
+         _profile.phases.emplace_back();
+         _profile.phases.back().name = name;
+         _profile.phases.back().objects_visited = objects_visited;
+      }
+      maintenance_phase_timer( const maintenance_phase_timer& ) = delete;
+      maintenance_phase_timer& operator=( const maintenance_phase_timer& ) = delete;
+      ~maintenance_phase_timer()
+      {
+         maintenance_phase_profile& phase = _profile.phases[_phase];
+         phase.microseconds = ( fc::time_point::now() - _start ).count();
+         phase.objects_modified = _db.change_count() - _changes_before;
+      }
+
+   private:
+      const database&      _db;
+      maintenance_profile& _profile;
+      const size_t         _phase;
+      const uint64_t       _changes_before;
+      const fc::time_point _start;
+};
+
 template<class Type>
-void database::perform_account_maintenance(Type tally_helper)
+void database::perform_account_maintenance(Type& tally_helper, maintenance_profile& profile)
 {
-   const auto& bal_idx = get_index_type< account_balance_index >().indices().get< by_maintenance_flag >();
-   if( bal_idx.begin() != bal_idx.end() )
    {
-      auto bal_itr = bal_idx.rbegin();
-      while( bal_itr->maintenance_flag )
+      maintenance_phase_timer timer( *this, profile, "account_balances" );
+      const auto& bal_idx = get_index_type< account_balance_index >().indices().get< by_maintenance_flag >();
+      if( bal_idx.begin() != bal_idx.end() )
       {
-         const account_balance_object& bal_obj = *bal_itr;
+         auto bal_itr = bal_idx.rbegin();
+         while( bal_itr->maintenance_flag )
+         {
+            const account_balance_object& bal_obj = *bal_itr;
 
-         modify( get_account_stats_by_owner( bal_obj.owner ), [&bal_obj](account_statistics_object& aso) {
-            aso.core_in_balance = bal_obj.balance;
-         });
+            modify( get_account_stats_by_owner( bal_obj.owner ), [&bal_obj](account_statistics_object& aso) {
+               aso.core_in_balance = bal_obj.balance;
+            });
 
-         modify( bal_obj, []( account_balance_object& abo ) {
-            abo.maintenance_flag = false;
-         });
+            modify( bal_obj, []( account_balance_object& abo ) {
+               abo.maintenance_flag = false;
+            });
 
-         bal_itr = bal_idx.rbegin();
+            ++profile.phases.back().objects_visited;
+            bal_itr = bal_idx.rbegin();
+         }
       }
    }
 
+   // The tally and the fee processing are interleaved, the time and the changes of the tally are what is left
+   // after subtracting those of the fee processing
+   maintenance_phase_profile tally_phase;
+   tally_phase.name = "vote_tally";
+   maintenance_phase_profile fees_phase;
+   fees_phase.name = "process_fees";
+   const fc::time_point walk_start = fc::time_point::now();
+   const uint64_t walk_changes_before = change_count();
+
+   // When the tally does not depend on the fees processed here, the voting accounts are collected and tallied
+   // by worker threads afterwards
+   const bool tally_in_parallel = tally_helper.can_tally_in_parallel();
+   vector< std::pair<const account_object*, const account_statistics_object*> > voting_accounts;
+
+   // Since the tally no longer reads the cashback balances, the payouts which do not create objects can wait until
+   // all fees are processed, then each balance is modified once
+   const bool batch_fee_payouts = HARDFORK_CORE_2262_PASSED( head_block_time() );
+   fee_payout_batch fee_batch;
+
    const auto& stats_idx = get_index_type< account_stats_index >().indices().get< by_maintenance_seq >();
    auto stats_itr = stats_idx.lower_bound( true );
 
@@ -107,12 +161,42 @@ void database::perform_account_maintenance(Type tally_helper)
       ++stats_itr;
 
       if( acc_stat.has_some_core_voting() )
-         tally_helper( acc_obj, acc_stat );
+      {
+         ++tally_phase.objects_visited;
+         if( tally_in_parallel )
+            voting_accounts.emplace_back( &acc_obj, &acc_stat );
+         else
+            tally_helper( acc_obj, acc_stat );
+      }
 
       if( acc_stat.has_pending_fees() )
-         acc_stat.process_fees( acc_obj, *this );
+      {
+         ++fees_phase.objects_visited;
+         const fc::time_point fees_start = fc::time_point::now();
+         const uint64_t fees_changes_before = change_count();
+         acc_stat.process_fees( acc_obj, *this, batch_fee_payouts ? &fee_batch : nullptr );
+         fees_phase.microseconds += ( fc::time_point::now() - fees_start ).count();
+         fees_phase.objects_modified += change_count() - fees_changes_before;
+      }
+   }
+
+   if( batch_fee_payouts )
+   {
+      const fc::time_point fees_start = fc::time_point::now();
+      const uint64_t fees_changes_before = change_count();
+      fee_batch.apply( *this );
+      fees_phase.microseconds += ( fc::time_point::now() - fees_start ).count();
+      fees_phase.objects_modified += change_count() - fees_changes_before;
    }
 
+   if( tally_in_parallel )
+      tally_helper.tally_in_parallel( voting_accounts );
+   tally_helper.store();
+
+   tally_phase.microseconds = ( fc::time_point::now() - walk_start ).count() - fees_phase.microseconds;
+   tally_phase.objects_modified = change_count() - walk_changes_before - fees_phase.objects_modified;
+   profile.phases.push_back( std::move( tally_phase ) );
+   profile.phases.push_back( std::move( fees_phase ) );
 }
 
 /// @brief A visitor for @ref worker_type which calls pay_worker on the worker within
@@ -1216,6 +1300,20 @@ namespace detail {
          stake_to_subtract /= GRAPHENE_100_PERCENT;
          return stake - static_cast<uint64_t>(stake_to_subtract);
       }
+
+      /// @return the earliest time from which get_recalced_voting_stake returns a different result for the
+      ///         last vote time, or the maximum time if it never does
+      time_point_sec get_recalc_expiration( const time_point_sec last_vote_time,
+                                            const vote_recalc_times& recalc_times ) const
+      {
+         if( last_vote_time > recalc_times.full_power_time )
+            return last_vote_time + full_power_seconds;
+         if( last_vote_time <= recalc_times.zero_power_time )
+            return time_point_sec::maximum();
+         uint32_t diff = recalc_times.full_power_time.sec_since_epoch() - last_vote_time.sec_since_epoch();
+         uint32_t steps_to_subtract = diff / seconds_per_step + 1;
+         return last_vote_time + ( full_power_seconds + steps_to_subtract * seconds_per_step );
+      }
    };
 
    const vote_recalc_options& vote_recalc_options::witness()
@@ -1246,8 +1344,21 @@ void database::perform_chain_maintenance( const signed_block& next_block )
    const auto& dgpo = get_dynamic_global_properties();
    auto last_vote_tally_time = head_block_time();
 
-   distribute_fba_balances(*this);
-   create_buyback_orders(*this);
+   const fc::time_point maintenance_start = fc::time_point::now();
+   maintenance_profile profile;
+   profile.block_num = next_block.block_num();
+   profile.timestamp = next_block.timestamp;
+
+   {
+      maintenance_phase_timer timer( *this, profile, "distribute_fba_balances",
+                                     get_index<fba_accumulator_object>().object_count() );
+      distribute_fba_balances(*this);
+   }
+   {
+      maintenance_phase_timer timer( *this, profile, "create_buyback_orders",
+                                     get_index<buyback_object>().object_count() );
+      create_buyback_orders(*this);
+   }
 
    struct vote_tally_helper {
       database& d;
@@ -1261,23 +1372,27 @@ void database::perform_chain_maintenance( const signed_block& next_block )
       const size_t vid_committee = static_cast<size_t>( vote_id_type::committee ); // 0
       const size_t vid_witness = static_cast<size_t>( vote_id_type::witness ); // 1
       const size_t vid_worker = static_cast<size_t>( vote_id_type::worker ); // 2
+      /// Accounts tallied per worker thread at least, smaller tallies are not worth the overhead of threads
+      const size_t min_accounts_per_thread = 1000;
 
       optional<detail::vote_recalc_times> witness_recalc_times;
       optional<detail::vote_recalc_times> committee_recalc_times;
       optional<detail::vote_recalc_times> worker_recalc_times;
       optional<detail::vote_recalc_times> delegator_recalc_times;
 
+      vote_tally_buffer totals;
+      /// The tally of the previous maintenance interval if it is updated instead of tallying from scratch
+      vote_tally_cache* cache = nullptr;
+      /// The account change sequence of the cache when this tally started
+      uint64_t cache_changes_before = 0;
+      vote_tally_cache::entry scratch;
+
       explicit vote_tally_helper( database& db )
          : d(db), props( d.get_global_properties() ), dprops( d.get_dynamic_global_properties() ),
            now( d.head_block_time() ), hf2103_passed( HARDFORK_CORE_2103_PASSED( now ) ),
            hf2262_passed( HARDFORK_CORE_2262_PASSED( now ) ),
            pob_activated( dprops.total_pob > 0 || dprops.total_inactive > 0 )
       {
-         d._vote_tally_buffer.resize( props.next_available_vote_id, 0 );
-         d._witness_count_histogram_buffer.resize( (props.parameters.maximum_witness_count / two) + 1, 0 );
-         d._committee_count_histogram_buffer.resize( (props.parameters.maximum_committee_count / two) + 1, 0 );
-         d._total_voting_stake[vid_committee] = 0;
-         d._total_voting_stake[vid_witness] = 0;
          if( hf2103_passed )
          {
             witness_recalc_times   = detail::vote_recalc_options::witness().get_vote_recalc_times( now );
@@ -1285,13 +1400,273 @@ void database::perform_chain_maintenance( const signed_block& next_block )
             worker_recalc_times    = detail::vote_recalc_options::worker().get_vote_recalc_times( now );
             delegator_recalc_times = detail::vote_recalc_options::delegator().get_vote_recalc_times( now );
          }
+         // Before core-2262 the tally reads the cashback balances, whose changes the cache does not track
+         if( d._incremental_vote_tally && hf2262_passed )
+            start_incremental_tally();
+         else
+         {
+            d._vote_tally_cache->reset();
+            totals = new_tally_buffer();
+         }
+      }
+
+      vote_tally_buffer new_tally_buffer()const
+      {
+         vote_tally_buffer result;
+         result.votes.resize( props.next_available_vote_id, 0 );
+         result.witness_counts.resize( (props.parameters.maximum_witness_count / two) + 1, 0 );
+         result.committee_counts.resize( (props.parameters.maximum_committee_count / two) + 1, 0 );
+         return result;
+      }
+
+      void start_incremental_tally()
+      {
+         cache = d._vote_tally_cache;
+         ++cache->tally_epoch;
+         cache_changes_before = cache->change_sequence();
+         // the parameters the contributions were computed with
+         if( !cache->initialized
+               || cache->maximum_witness_count != props.parameters.maximum_witness_count
+               || cache->maximum_committee_count != props.parameters.maximum_committee_count
+               || cache->count_non_member_votes != props.parameters.count_non_member_votes
+               || cache->pob_activated != pob_activated
+               || cache->totals.votes.size() > props.next_available_vote_id )
+         {
+            cache->reset();
+            cache->totals = new_tally_buffer();
+            cache->initialized = true;
+            cache->maximum_witness_count = props.parameters.maximum_witness_count;
+            cache->maximum_committee_count = props.parameters.maximum_committee_count;
+            cache->count_non_member_votes = props.parameters.count_non_member_votes;
+            cache->pob_activated = pob_activated;
+         }
+         else
+            cache->totals.votes.resize( props.next_available_vote_id, 0 );
+      }
+
+      /**
+       * Before core-2262 the tally reads the cashback balances of the accounts, which change when the fees of
+       * other accounts are processed, so the accounts have to be tallied one by one in maintenance order.
+       * The incremental tally is done one by one too.
+       */
+      bool can_tally_in_parallel()const
+      {
+         return hf2262_passed && cache == nullptr && fc::asio::default_io_service_scope::get_num_threads() > 1;
       }
 
       void operator()( const account_object& stake_account, const account_statistics_object& stats )
       {
+         if( cache == nullptr )
+         {
+            if( tally( stake_account, stats, scratch ) )
+            {
+               totals.add( scratch );
+               add_voting_power( scratch );
+            }
+            return;
+         }
+
+         vote_tally_cache::entry& e = cache->entries[ stake_account.id.instance() ];
+         if( !is_current( e, stake_account, stats ) )
+         {
+            cache->totals.subtract( e );
+            tally( stake_account, stats, e );
+            e.computed_at = cache->change_sequence();
+            cache->totals.add( e );
+         }
+         else if( d._verify_vote_tally )
+         {
+            tally( stake_account, stats, scratch );
+            if( !same_contribution( e, scratch ) )
+            {
+               elog( "The incremental vote tally of account ${a} differs from a full tally at ${t}, "
+                     "using the full tally", ("a", stake_account.id)("t", now) );
+               cache->totals.subtract( e );
+               tally( stake_account, stats, e );
+               e.computed_at = cache->change_sequence();
+               cache->totals.add( e );
+            }
+         }
+         e.tally_epoch = cache->tally_epoch;
+
+         if( e.opinion_account_stats != nullptr )
+            add_voting_power( e );
+      }
+
+      /// @return whether the contribution of the account in the cache would be computed the same now
+      bool is_current( const vote_tally_cache::entry& e, const account_object& stake_account,
+                       const account_statistics_object& stats )const
+      {
+         if( e.computed_at == 0 || now >= e.valid_until )
+            return false;
+         if( e.vote_buffer_size != 0 && e.vote_buffer_size != props.next_available_vote_id )
+            return false;
+         if( cache->last_change( stake_account.id ) > e.computed_at )
+            return false;
+         if( stats.total_core_in_orders != e.total_core_in_orders || stats.core_in_balance != e.core_in_balance
+               || stats.total_core_pol != e.total_core_pol || stats.total_pol_value != e.total_pol_value
+               || stats.total_core_pob != e.total_core_pob || stats.total_pob_value != e.total_pob_value
+               || stats.total_core_inactive != e.total_core_inactive || stats.last_vote_time != e.last_vote_time )
+            return false;
+         // Without voting power the opinion account was not looked at
+         if( e.opinion_account_stats == nullptr )
+            return true;
+         // The opinion account has to be checked before its statistics, which may have been removed with it
+         if( e.opinion_account != stake_account.id && cache->last_change( e.opinion_account ) > e.computed_at )
+            return false;
+         return ( e.opinion_account_stats->last_vote_time == e.opinion_last_vote_time );
+      }
+
+      static bool same_contribution( const vote_tally_contribution& a, const vote_tally_contribution& b )
+      {
+         return a.votes == b.votes
+               && a.witness_count_offset == b.witness_count_offset && a.witness_count_stake == b.witness_count_stake
+               && a.committee_count_offset == b.committee_count_offset
+               && a.committee_count_stake == b.committee_count_stake
+               && a.total_voting_stake == b.total_voting_stake
+               && a.opinion_account_stats == b.opinion_account_stats
+               && a.vp_all == b.vp_all && a.vp_active == b.vp_active && a.vp_committee == b.vp_committee
+               && a.vp_witness == b.vp_witness && a.vp_worker == b.vp_worker;
+      }
+
+      /**
+       * Tallies the accounts with worker threads, each with a private buffer. The buffers are summed up and the
+       * voting power is stored in the order of the accounts afterwards, so the result does not depend on the
+       * number of threads.
+       */
+      void tally_in_parallel( const vector< std::pair<const account_object*, const account_statistics_object*> >&
+                                    accounts )
+      {
+         const size_t chunks = std::min<size_t>( fc::asio::default_io_service_scope::get_num_threads(),
+                                                 accounts.size() / min_accounts_per_thread );
+         if( chunks <= 1 )
+         {
+            for( const auto& account : accounts )
+               (*this)( *account.first, *account.second );
+            return;
+         }
+
+         // the votes are not needed for storing the voting power, so they are not kept
+         vector<vote_tally_contribution> results( accounts.size() );
+         vector<vote_tally_buffer> buffers( chunks, new_tally_buffer() );
+         const size_t chunk_size = ( accounts.size() + chunks - 1 ) / chunks;
+         std::vector<fc::future<void>> workers;
+         workers.reserve( chunks );
+         for( size_t chunk = 0; chunk < chunks; ++chunk )
+         {
+            const size_t first = chunk * chunk_size;
+            const size_t last = std::min( first + chunk_size, accounts.size() );
+            workers.push_back( fc::do_parallel( [this,&accounts,&results,&buffers,chunk,first,last] () {
+               vote_tally_cache::entry c;
+               for( size_t i = first; i < last; ++i )
+               {
+                  if( tally( *accounts[i].first, *accounts[i].second, c ) )
+                  {
+                     buffers[chunk].add( c );
+                     c.votes.clear();
+                     results[i] = c;
+                  }
+               }
+            }) );
+         }
+         // all workers must be done before the buffers go out of scope, even if one of them failed
+         std::exception_ptr failure;
+         for( auto& worker : workers )
+         {
+            try {
+               worker.wait();
+            } catch( ... ) {
+               if( !failure )
+                  failure = std::current_exception();
+            }
+         }
+         if( failure )
+            std::rethrow_exception( failure );
+
+         for( const vote_tally_contribution& c : results )
+         {
+            if( c.opinion_account_stats != nullptr )
+               add_voting_power( c );
+         }
+         for( const vote_tally_buffer& buffer : buffers )
+            totals.add( buffer );
+      }
+
+      /// Stores the tally in the buffers of the database
+      void store()
+      {
+         if( cache == nullptr )
+         {
+            d._vote_tally_buffer = std::move( totals.votes );
+            d._witness_count_histogram_buffer = std::move( totals.witness_counts );
+            d._committee_count_histogram_buffer = std::move( totals.committee_counts );
+            d._total_voting_stake = totals.total_voting_stake;
+            return;
+         }
+
+         // drop the accounts which are no longer voting
+         for( auto itr = cache->entries.begin(); itr != cache->entries.end(); )
+         {
+            if( itr->second.tally_epoch != cache->tally_epoch )
+            {
+               cache->totals.subtract( itr->second );
+               itr = cache->entries.erase( itr );
+            }
+            else
+               ++itr;
+         }
+         // the changes before this tally are reflected in the entries now
+         cache->forget_changes( cache_changes_before );
+
+         if( d._verify_vote_tally )
+         {
+            vote_tally_buffer sum = new_tally_buffer();
+            for( const auto& item : cache->entries )
+               sum.add( item.second );
+            if( sum.votes != cache->totals.votes || sum.witness_counts != cache->totals.witness_counts
+                  || sum.committee_counts != cache->totals.committee_counts
+                  || sum.total_voting_stake != cache->totals.total_voting_stake )
+            {
+               elog( "The incremental vote tally totals differ from the sum of all accounts at ${t}, "
+                     "using the sum", ("t", now) );
+               cache->totals = std::move( sum );
+            }
+         }
+
+         d._vote_tally_buffer = cache->totals.votes;
+         d._witness_count_histogram_buffer = cache->totals.witness_counts;
+         d._committee_count_histogram_buffer = cache->totals.committee_counts;
+         d._total_voting_stake = cache->totals.total_voting_stake;
+      }
+
+      /**
+       * Computes what the stake of an account adds to the tally, does not modify the database.
+       * @param e receives the contribution and what it was computed from
+       * @return true if the account votes, i.e. the voting power in @p e needs to be added to the opinion account
+       */
+      bool tally( const account_object& stake_account, const account_statistics_object& stats,
+                  vote_tally_cache::entry& e )const
+      {
+         e.clear();
+         e.opinion_account = stake_account.id;
+         e.valid_until = time_point_sec::maximum();
+         e.vote_buffer_size = 0;
+         e.total_core_in_orders = stats.total_core_in_orders;
+         e.core_in_balance = stats.core_in_balance;
+         e.total_core_pol = stats.total_core_pol;
+         e.total_pol_value = stats.total_pol_value;
+         e.total_core_pob = stats.total_core_pob;
+         e.total_pob_value = stats.total_pob_value;
+         e.total_core_inactive = stats.total_core_inactive;
+         e.last_vote_time = stats.last_vote_time;
+
          // PoB activation
          if( pob_activated && stats.total_core_pob == 0 && stats.total_core_inactive == 0 )
-            return;
+            return false;
+
+         if( !props.parameters.count_non_member_votes && stake_account.is_member( now )
+               && !stake_account.is_lifetime_member() )
+            e.valid_until = stake_account.membership_expiration_date + 1;
 
          if( props.parameters.count_non_member_votes || stake_account.is_member( now ) )
          {
@@ -1301,6 +1676,7 @@ void database::perform_chain_maintenance( const signed_block& next_block )
             bool directly_voting = ( stake_account.options.voting_account == GRAPHENE_PROXY_TO_SELF_ACCOUNT );
             const account_object& opinion_account = ( directly_voting ? stake_account
                                                       : d.get(stake_account.options.voting_account) );
+            e.opinion_account = opinion_account.id;
 
             std::array<uint64_t,3> voting_stake; // 0=committee, 1=witness, 2=worker, as in vote_id_type::vote_type
             uint64_t num_committee_voting_stake; // number of committee members
@@ -1365,9 +1741,10 @@ void database::perform_chain_maintenance( const signed_block& next_block )
 
             // Shortcut
             if( 0 == voting_stake[vid_worker] )
-               return;
+               return false;
 
             const auto& opinion_account_stats = ( directly_voting ? stats : opinion_account.statistics( d ) );
+            e.opinion_last_vote_time = opinion_account_stats.last_vote_time;
 
             // Recalculate votes
             if( !hf2103_passed )
@@ -1390,6 +1767,9 @@ void database::perform_chain_maintenance( const signed_block& next_block )
                   voting_stake[vid_worker] = detail::vote_recalc_options::delegator().get_recalced_voting_stake(
                      voting_stake[vid_worker], stats.last_vote_time, *delegator_recalc_times );
                   vp_active = voting_stake[vid_worker];
+                  e.valid_until = std::min( e.valid_until,
+                        detail::vote_recalc_options::delegator().get_recalc_expiration(
+                           stats.last_vote_time, *delegator_recalc_times ) );
                }
                voting_stake[vid_witness] = detail::vote_recalc_options::witness().get_recalced_voting_stake(
                   voting_stake[vid_worker], opinion_account_stats.last_vote_time, *witness_recalc_times );
@@ -1403,63 +1783,84 @@ void database::perform_chain_maintenance( const signed_block& next_block )
                voting_stake[vid_worker] = detail::vote_recalc_options::worker().get_recalced_voting_stake(
                   voting_stake[vid_worker], opinion_account_stats.last_vote_time, *worker_recalc_times );
                vp_worker = voting_stake[vid_worker];
+               e.valid_until = std::min( { e.valid_until,
+                     detail::vote_recalc_options::witness().get_recalc_expiration(
+                        opinion_account_stats.last_vote_time, *witness_recalc_times ),
+                     detail::vote_recalc_options::committee().get_recalc_expiration(
+                        opinion_account_stats.last_vote_time, *committee_recalc_times ),
+                     detail::vote_recalc_options::worker().get_recalc_expiration(
+                        opinion_account_stats.last_vote_time, *worker_recalc_times ) } );
             }
 
-            // update voting power
-            d.modify( opinion_account_stats, [vp_all,vp_active,vp_committee,vp_witness,vp_worker,this]
-                                             ( account_statistics_object& update_stats ) {
-               if (update_stats.vote_tally_time != now)
-               {
-                  update_stats.vp_all = vp_all;
-                  update_stats.vp_active = vp_active;
-                  update_stats.vp_committee = vp_committee;
-                  update_stats.vp_witness = vp_witness;
-                  update_stats.vp_worker = vp_worker;
-                  update_stats.vote_tally_time = now;
-               }
-               else
-               {
-                  update_stats.vp_all += vp_all;
-                  update_stats.vp_active += vp_active;
-                  update_stats.vp_committee += vp_committee;
-                  update_stats.vp_witness += vp_witness;
-                  update_stats.vp_worker += vp_worker;
-               }
-            });
+            e.vp_all = vp_all;
+            e.vp_active = vp_active;
+            e.vp_committee = vp_committee;
+            e.vp_witness = vp_witness;
+            e.vp_worker = vp_worker;
 
+            const uint32_t vote_buffer_size = props.next_available_vote_id;
             for( vote_id_type id : opinion_account.options.votes )
             {
                uint32_t offset = id.instance();
                uint32_t type = std::min( id.type(), vote_id_type::vote_type::worker ); // cap the data
                // if they somehow managed to specify an illegal offset, ignore it.
-               if( offset < d._vote_tally_buffer.size() )
-                  d._vote_tally_buffer[offset] += voting_stake[type];
+               if( offset < vote_buffer_size )
+                  e.votes.emplace_back( offset, voting_stake[type] );
+               else
+                  e.vote_buffer_size = vote_buffer_size;
             }
 
             // votes for a number greater than maximum_witness_count are skipped here
             if( voting_stake[vid_witness] > 0
                   && opinion_account.options.num_witness <= props.parameters.maximum_witness_count )
             {
-               uint16_t offset = opinion_account.options.num_witness / two;
-               d._witness_count_histogram_buffer[offset] += voting_stake[vid_witness];
+               e.witness_count_offset = opinion_account.options.num_witness / two;
+               e.witness_count_stake = voting_stake[vid_witness];
             }
             // votes for a number greater than maximum_committee_count are skipped here
             if( num_committee_voting_stake > 0
                   && opinion_account.options.num_committee <= props.parameters.maximum_committee_count )
             {
-               uint16_t offset = opinion_account.options.num_committee / two;
-               d._committee_count_histogram_buffer[offset] += num_committee_voting_stake;
+               e.committee_count_offset = opinion_account.options.num_committee / two;
+               e.committee_count_stake = num_committee_voting_stake;
             }
 
-            d._total_voting_stake[vid_committee] += num_committee_voting_stake;
-            d._total_voting_stake[vid_witness] += voting_stake[vid_witness];
+            e.total_voting_stake[vid_committee] = num_committee_voting_stake;
+            e.total_voting_stake[vid_witness] = voting_stake[vid_witness];
+
+            e.opinion_account_stats = &opinion_account_stats;
+            return true;
          }
+         return false;
+      }
+
+      void add_voting_power( const vote_tally_contribution& c )
+      {
+         d.modify( *c.opinion_account_stats, [&c,this]( account_statistics_object& update_stats ) {
+            if (update_stats.vote_tally_time != now)
+            {
+               update_stats.vp_all = c.vp_all;
+               update_stats.vp_active = c.vp_active;
+               update_stats.vp_committee = c.vp_committee;
+               update_stats.vp_witness = c.vp_witness;
+               update_stats.vp_worker = c.vp_worker;
+               update_stats.vote_tally_time = now;
+            }
+            else
+            {
+               update_stats.vp_all += c.vp_all;
+               update_stats.vp_active += c.vp_active;
+               update_stats.vp_committee += c.vp_committee;
+               update_stats.vp_witness += c.vp_witness;
+               update_stats.vp_worker += c.vp_worker;
+            }
+         });
       }
    };
 
    vote_tally_helper tally_helper(*this);
 
-   perform_account_maintenance( tally_helper );
+   perform_account_maintenance( tally_helper, profile );
 
    struct clear_canary {
       explicit clear_canary(vector<uint64_t>& target): target(target){}
@@ -1472,10 +1873,26 @@ void database::perform_chain_maintenance( const signed_block& next_block )
    clear_canary b(_committee_count_histogram_buffer);
    clear_canary c(_vote_tally_buffer);
 
-   update_top_n_authorities(*this);
-   update_active_witnesses();
-   update_active_committee_members();
-   update_worker_votes();
+   {
+      maintenance_phase_timer timer( *this, profile, "update_top_n_authorities",
+                                     get_index<special_authority_object>().object_count() );
+      update_top_n_authorities(*this);
+   }
+   {
+      maintenance_phase_timer timer( *this, profile, "update_active_witnesses",
+                                     get_index<witness_object>().object_count() );
+      update_active_witnesses();
+   }
+   {
+      maintenance_phase_timer timer( *this, profile, "update_active_committee_members",
+                                     get_index<committee_member_object>().object_count() );
+      update_active_committee_members();
+   }
+   {
+      maintenance_phase_timer timer( *this, profile, "update_worker_votes",
+                                     get_index<worker_object>().object_count() );
+      update_worker_votes();
+   }
 
    modify(gpo, [&dgpo](global_property_object& p) {
       // Remove scaling of account registration fee
@@ -1487,6 +1904,7 @@ void database::perform_chain_maintenance( const signed_block& next_block )
       {
          p.parameters = std::move(*p.pending_parameters);
          p.pending_parameters.reset();
+         p.parameters.get_mutable_fees().update_index();
       }
    });
 
@@ -1586,12 +2004,59 @@ void database::perform_chain_maintenance( const signed_block& next_block )
       match_call_orders(*this);
    }
 
-   process_bitassets();
-   delete_expired_custom_auths(*this);
+   {
+      maintenance_phase_timer timer( *this, profile, "process_bitassets",
+                                     get_index<asset_bitasset_data_object>().object_count() );
+      process_bitassets();
+   }
+   {
+      maintenance_phase_timer timer( *this, profile, "delete_expired_custom_auths",
+                                     get_index<custom_authority_object>().object_count() );
+      delete_expired_custom_auths(*this);
+   }
 
    // process_budget needs to run at the bottom because
    //   it needs to know the next_maintenance_time
-   process_budget();
+   {
+      maintenance_phase_timer timer( *this, profile, "process_budget", get_index<worker_object>().object_count() );
+      process_budget();
+   }
+
+   profile.microseconds = ( fc::time_point::now() - maintenance_start ).count();
+   string breakdown;
+   for( const auto& phase : profile.phases )
+   {
+      if( !breakdown.empty() )
+         breakdown += ", ";
+      breakdown += phase.name + " " + std::to_string( phase.microseconds ) + " us "
+                   + std::to_string( phase.objects_visited ) + " visited "
+                   + std::to_string( phase.objects_modified ) + " modified";
+   }
+   ilog( "Maintenance at block ${n} took ${t} us: ${b}", ("n",profile.block_num)("t",profile.microseconds)
+         ("b",breakdown) );
+   if( _maintenance_profile_history > 0 )
+   {
+      _maintenance_profiles.push_back( std::move( profile ) );
+      while( _maintenance_profiles.size() > _maintenance_profile_history )
+         _maintenance_profiles.pop_front();
+   }
+
+   if( _log_index_memory_usage )
+   {
+      for( const auto& usage : get_memory_usage() )
+         ilog( "Index ${s}.${t}: ${n} objects, ${o} bytes, ${p} bytes reserved in the node pool, "
+               "${x} bytes in secondary indexes, ${u} bytes in undo states",
+               ("s",usage.space_id)("t",usage.type_id)("n",usage.object_count)("o",usage.object_bytes)
+               ("p",usage.pool_reserved_bytes)("x",usage.secondary_index_bytes)("u",usage.undo_bytes) );
+      const auto fork_usage = get_fork_database_usage();
+      ilog( "Fork database: ${n} blocks, ${b} of them with transactions, ${s} bytes",
+            ("n",fork_usage.item_count)("b",fork_usage.body_count)("s",fork_usage.bytes) );
+      const auto undo_usage = get_undo_database_usage();
+      ilog( "Undo states: ${n} blocks, ${c} of them packed, ${s} bytes, ${l} bytes for the head block, "
+            "${m} bytes for the largest block",
+            ("n",undo_usage.states)("c",undo_usage.compacted_states)("s",undo_usage.bytes)
+            ("l",undo_usage.last_state_bytes)("m",undo_usage.largest_state_bytes) );
+   }
 }
 
 } }
@@ -23,24 +23,165 @@
  */
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/db_with.hpp>
 
+#include <graphene/chain/account_object.hpp>
 #include <graphene/chain/chain_property_object.hpp>
+#include <graphene/chain/custom_authority_object.hpp>
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/special_authority_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
+#include <graphene/chain/state_snapshot.hpp>
 
 #include <graphene/protocol/fee_schedule.hpp>
 
+#include <fc/interprocess/file_mapping.hpp>
 #include <fc/io/fstream.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/thread/parallel.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <queue>
-#include <tuple>
+#include <thread>
+#include <vector>
 
 namespace graphene { namespace chain {
 
+namespace {
+
+/**
+ * Reads and unpacks blocks from the block database on a separate thread, so that disk reads and
+ * deserialization overlap with applying the blocks. At most @c depth blocks are kept in the queue.
+ * The reader stops after the last block or at the first block which does not exist.
+ *
+ * Blocks which have been applied can be handed back with @ref recycle, the reader unpacks later blocks into them so
+ * that the vectors of transactions, operations and signatures are reused instead of allocated for every block.
+ */
+class block_prefetcher
+{
+   public:
+      struct entry
+      {
+         /// The position in the block database before reading the block, for progress reports
+         size_t                       position = 0;
+         /// The block, empty if it does not exist
+         fc::optional< signed_block > block;
+      };
+
+      block_prefetcher( const block_database& blocks, uint32_t first_block_num, uint32_t last_block_num,
+                        uint32_t depth )
+         : _blocks( blocks ), _depth( depth )
+      {
+         _thread = std::thread( [this,first_block_num,last_block_num]() { run( first_block_num, last_block_num ); } );
+      }
+
+      ~block_prefetcher() { stop(); }
+
+      /// Wait for the next block, @return false if there are no more blocks
+      bool next( entry& result )
+      {
+         std::unique_lock< std::mutex > lock( _mutex );
+         _cv.wait( lock, [this]() { return !_queue.empty() || _done; } );
+         if( _queue.empty() )
+         {
+            if( _error )
+               std::rethrow_exception( _error );
+            return false;
+         }
+         result = std::move( _queue.front() );
+         _queue.pop_front();
+         _cv.notify_all();
+         return true;
+      }
+
+      /// Hand back a block which is no longer needed, to be overwritten by a later one
+      void recycle( signed_block&& block )
+      {
+         std::lock_guard< std::mutex > lock( _mutex );
+         if( _spare.size() < _depth )
+            _spare.push_back( std::move( block ) );
+      }
+
+      /// Stop reading and wait for the reader thread to finish
+      void stop()
+      {
+         {
+            std::lock_guard< std::mutex > lock( _mutex );
+            _stopped = true;
+         }
+         _cv.notify_all();
+         if( _thread.joinable() )
+            _thread.join();
+      }
+
+   private:
+      void run( uint32_t first_block_num, uint32_t last_block_num )
+      {
+         try
+         {
+            for( uint32_t block_num = first_block_num; block_num <= last_block_num; ++block_num )
+            {
+               {
+                  std::unique_lock< std::mutex > lock( _mutex );
+                  _cv.wait( lock, [this]() { return _queue.size() < _depth || _stopped; } );
+                  if( _stopped )
+                     break;
+               }
+               entry e;
+               e.position = _blocks.blocks_current_position();
+               e.block = signed_block();
+               {
+                  std::lock_guard< std::mutex > lock( _mutex );
+                  if( !_spare.empty() )
+                  {
+                     *e.block = std::move( _spare.back() );
+                     _spare.pop_back();
+                  }
+               }
+               if( !_blocks.fetch_by_number( block_num, *e.block ) )
+                  e.block.reset();
+               const bool gap = !e.block.valid();
+               {
+                  std::lock_guard< std::mutex > lock( _mutex );
+                  _queue.push_back( std::move( e ) );
+               }
+               _cv.notify_all();
+               if( gap )
+                  break;
+            }
+         }
+         catch( ... )
+         {
+            std::lock_guard< std::mutex > lock( _mutex );
+            _error = std::current_exception();
+         }
+         {
+            std::lock_guard< std::mutex > lock( _mutex );
+            _done = true;
+         }
+         _cv.notify_all();
+      }
+
+      const block_database&       _blocks;
+      const size_t                _depth;
+      std::mutex                  _mutex;
+      std::condition_variable     _cv;
+      std::deque< entry >         _queue;
+      std::vector< signed_block > _spare;
+      bool                        _stopped = false;
+      bool                        _done = false;
+      std::exception_ptr          _error;
+      std::thread                 _thread;
+};
+
+} // anonymous namespace
+
 database::database()
 {
    initialize_indexes();
@@ -62,6 +203,10 @@ void database::reindex( fc::path data_dir )
    }
    if( last_block->block_num() <= head_block_num()) return;
 
+   FC_ASSERT( head_block_num() + 1 >= _block_id_to_block.first_block_num(),
+              "Unable to replay from block ${n}, the block database has been pruned up to block ${f}. "
+              "Please resync.", ("n",head_block_num() + 1)("f",_block_id_to_block.first_block_num()) );
+
    ilog( "reindexing blockchain" );
    auto start = fc::time_point::now();
    const auto last_block_num = last_block->block_num();
@@ -80,24 +225,32 @@ void database::reindex( fc::path data_dir )
 
    size_t total_block_size = _block_id_to_block.total_block_size();
    const auto& gpo = get_global_properties();
-   std::queue< std::tuple< size_t, signed_block, fc::future< void > > > blocks;
-   uint32_t next_block_num = head_block_num() + 1;
-   uint32_t i = next_block_num;
-   while( next_block_num <= last_block_num || !blocks.empty() )
+   std::queue< std::pair< size_t, signed_block > > blocks;
+   // the blocks are prepared by workers while earlier ones are applied, this must be destroyed before the queue
+   detail::block_precomputations precomputed;
+   uint32_t i = head_block_num() + 1;
+   block_prefetcher reader( _block_id_to_block, i, last_block_num, _reindex_prefetch_depth );
+   bool reading = true;
+   while( reading || !blocks.empty() )
    {
-      if( next_block_num <= last_block_num && blocks.size() < 20 )
+      if( reading && blocks.size() < 20 )
       {
-         const size_t processed_block_size = _block_id_to_block.blocks_current_position();
-         fc::optional< signed_block > block = _block_id_to_block.fetch_by_number( next_block_num++ );
-         if( block.valid() )
+         block_prefetcher::entry next;
+         if( !reader.next( next ) )
+            reading = false;
+         else if( next.block.valid() )
          {
-            if( block->timestamp >= last_block->timestamp - gpo.parameters.maximum_time_until_expiration )
+            if( next.block->timestamp >= last_block->timestamp - gpo.parameters.maximum_time_until_expiration )
                skip &= (uint32_t)(~skip_transaction_dupe_check);
-            blocks.emplace( processed_block_size, std::move(*block), fc::future<void>() );
-            std::get<2>(blocks.back()) = precompute_parallel( std::get<1>(blocks.back()), skip );
+            blocks.emplace( next.position, std::move(*next.block) );
+            const signed_block& block = blocks.back().second;
+            precomputed.add( block.id(), start_precompute( block, skip, true ) );
          }
          else
          {
+            // the reader has stopped at the gap, it must not run while blocks are removed
+            reader.stop();
+            reading = false;
             wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
             uint32_t dropped_count = 0;
             while( true )
@@ -113,19 +266,18 @@ void database::reindex( fc::path data_dir )
                dropped_count++;
             }
             wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
-            next_block_num = last_block_num + 1; // don't load more blocks
          }
       }
       else
       {
-         std::get<2>(blocks.front()).wait();
-         const signed_block& block = std::get<1>(blocks.front());
+         const signed_block& block = blocks.front().second;
+         precomputed.wait( block.id() );
 
          if( i % 10000 == 0 )
          {
             std::stringstream bysize;
             std::stringstream bynum;
-            size_t current_pos = std::get<0>(blocks.front());
+            size_t current_pos = blocks.front().first;
             if( current_pos > total_block_size )
                total_block_size = current_pos;
             bysize << std::fixed << std::setprecision(5) << double(current_pos) / total_block_size * 100;
@@ -153,6 +305,7 @@ void database::reindex( fc::path data_dir )
             _undo_db.enable();
             push_block( block, skip );
          }
+         reader.recycle( std::move( blocks.front().second ) );
          blocks.pop();
          i++;
       }
@@ -180,6 +333,14 @@ void database::open(
 {
    try
    {
+      // the indexes are recreated, so their change counts start over
+      for( auto& sweep : _expiration_sweeps )
+         sweep.next_due.reset();
+      _custom_authority_cache.clear();
+      _call_check_memos.clear();
+      // the objects are loaded without notifying the secondary indexes
+      _vote_tally_cache->reset();
+
       bool wipe_object_db = false;
       if( !fc::exists( data_dir / "db_version" ) )
          wipe_object_db = true;
@@ -198,9 +359,18 @@ void database::open(
           version_file.close();
       }
 
+      // the snapshot replaces the local state
+      if( _state_snapshot.valid() )
+         object_database::wipe( data_dir );
+
       object_database::open(data_dir);
 
-      _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
+      _block_id_to_block.open(data_dir / "database" / "block_num_to_block", _block_log_format);
+      FC_ASSERT( _block_log_keep_blocks == 0 || _block_id_to_block.is_segmented(),
+                 "Pruning requires a segmented block database, please set block-log-segment-size and resync" );
+
+      if( _state_snapshot.valid() )
+         load_state_snapshot( *_state_snapshot );
 
       if( !find(global_property_id_type()) )
          init_genesis(genesis_loader());
@@ -212,6 +382,21 @@ void database::open(
          _p_chain_property_obj = &get( chain_property_id_type() );
          _p_dyn_global_prop_obj = &get( dynamic_global_property_id_type() );
          _p_witness_schedule_obj = &get( witness_schedule_id_type() );
+         // the fee lookup index is not part of the saved state
+         modify( *_p_global_prop_obj, []( global_property_object& p ) {
+            p.parameters.get_mutable_fees().update_index();
+         });
+         // compile the predicates of the custom authorities before API threads evaluate them
+         for( const auto& cust_auth : get_index_type<custom_authority_index>().indices() )
+         {
+            try {
+               cust_auth.update_predicate_cache();
+            } catch( const fc::exception& e ) {
+               // leave the cache empty, the error is reported by the evaluations of the authority
+               wlog( "Unable to compile the restrictions of custom authority ${id}: ${e}",
+                     ("id", cust_auth.id)("e", e.to_detail_string()) );
+            }
+         }
       }
 
       fc::optional<block_id_type> last_block = _block_id_to_block.last_id();
@@ -222,11 +407,211 @@ void database::open(
                     ("last_block->id", last_block)("head_block_id",head_block_num()) );
          reindex( data_dir );
       }
+      publish_head_state();
       _opened = true;
    }
    FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
 }
 
+void database::save_state_snapshot( const fc::path& file )const
+{ try {
+   state_snapshot_header header;
+   header.chain_id = get_chain_id();
+   const uint32_t first_block_num = std::max( get_dynamic_global_properties().last_irreversible_block_num, 1u );
+   for( uint32_t block_num = first_block_num; block_num <= head_block_num(); ++block_num )
+   {
+      optional<signed_block> block = fetch_block_by_number( block_num );
+      FC_ASSERT( block.valid(), "Block ${n} is not available", ("n",block_num) );
+      FC_ASSERT( header.blocks.empty() || block->previous == header.blocks.back().id(),
+                 "Block ${n} does not belong to the current chain", ("n",block_num) );
+      header.blocks.push_back( std::move( *block ) );
+   }
+   FC_ASSERT( !header.blocks.empty() && header.blocks.back().id() == head_block_id(),
+              "The head block is not available" );
+
+   ilog( "Writing a state snapshot at block ${n} to ${f}", ("n",head_block_num())("f",file) );
+   const fc::path tmp_file = file.generic_string() + ".tmp";
+   {
+      std::ofstream out( tmp_file.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc );
+      FC_ASSERT( out, "Unable to open ${f}", ("f",tmp_file) );
+      fc::raw::pack( out, header );
+      save_snapshot( out );
+      out.close();
+      FC_ASSERT( out, "Failed to write ${f}", ("f",tmp_file) );
+   }
+   fc::rename( tmp_file, file );
+   ilog( "Done writing the state snapshot" );
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+void database::load_state_snapshot( const fc::path& file )
+{ try {
+   ilog( "Loading the state from snapshot ${f}", ("f",file) );
+   fc::file_mapping fm( file.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(file) );
+   fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+
+   state_snapshot_header header;
+   fc::raw::unpack( ds, header );
+   FC_ASSERT( header.format == state_snapshot_header::current_format,
+              "Unsupported snapshot format ${v}", ("v",header.format) );
+   FC_ASSERT( !header.blocks.empty(), "The snapshot has no head block" );
+   for( size_t i = 1; i < header.blocks.size(); ++i )
+      FC_ASSERT( header.blocks[i].previous == header.blocks[i-1].id(), "The blocks of the snapshot are not linked" );
+   const signed_block& head = header.blocks.back();
+
+   load_snapshot( ds );
+
+   FC_ASSERT( find( chain_property_id_type() ) != nullptr && find( dynamic_global_property_id_type() ) != nullptr,
+              "The snapshot has no chain state" );
+   FC_ASSERT( get( chain_property_id_type() ).chain_id == header.chain_id,
+              "The snapshot belongs to chain ${c}", ("c",get( chain_property_id_type() ).chain_id) );
+   FC_ASSERT( get( dynamic_global_property_id_type() ).head_block_id == head.id(),
+              "The state of the snapshot does not belong to its head block ${id}", ("id",head.id()) );
+
+   // the state is trusted from here on, the blocks are needed to serve peers and to continue the chain
+   for( const auto& block : header.blocks )
+   {
+      if( _block_id_to_block.contains( block.id() ) )
+         continue;
+      FC_ASSERT( !_block_id_to_block.fetch_by_number( block.block_num() ).valid(),
+                 "The block database holds another block ${n}, please resync", ("n",block.block_num()) );
+      _block_id_to_block.store( block.id(), block );
+   }
+   _fork_db.start_block( head );
+
+   // without the snapshot a restart has to find the new state on disk
+   object_database::flush();
+   _block_id_to_block.flush();
+   ilog( "Loaded the state at block ${n}", ("n",head.block_num()) );
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+namespace {
+
+/**
+ * Reads up to @p count blocks into @p batch, which is cleared first.
+ * @return false if the end of the stream has been reached
+ */
+bool read_import_batch( std::istream& in, vector<signed_block>& batch, size_t count )
+{
+   batch.clear();
+   while( batch.size() < count )
+   {
+      if( in.peek() == std::istream::traits_type::eof() )
+         return false;
+      batch.emplace_back();
+      fc::raw::unpack( in, batch.back() );
+      FC_ASSERT( in.good(), "The block log is truncated" );
+   }
+   return true;
+}
+
+/// Starts computing the ids of the blocks and checking their merkle roots, in one chunk per thread
+std::vector<fc::future<void>> start_import_verification( const vector<signed_block>& batch )
+{
+   std::vector<fc::future<void>> workers;
+   const size_t threads = std::max<size_t>( 1, fc::asio::default_io_service_scope::get_num_threads() );
+   const size_t chunk_size = ( batch.size() + threads - 1 ) / threads;
+   for( size_t begin = 0; begin < batch.size(); begin += chunk_size )
+   {
+      const size_t end = std::min( begin + chunk_size, batch.size() );
+      workers.push_back( fc::do_parallel( [&batch,begin,end] () {
+         for( size_t i = begin; i < end; ++i )
+         {
+            const signed_block& block = batch[i];
+            // the id is cached in the block
+            block.id();
+            FC_ASSERT( block.transaction_merkle_root == block.calculate_merkle_root(),
+                       "Merkle root of block ${n} does not match its transactions", ("n",block.block_num()) );
+         }
+      } ) );
+   }
+   return workers;
+}
+
+} // anonymous namespace
+
+uint32_t database::import_blocks( const fc::path& data_dir, std::istream& in )
+{ try {
+   FC_ASSERT( !_opened, "Blocks can only be imported before the database is opened" );
+   // the blocks are applied by open(), starting from scratch
+   object_database::wipe( data_dir );
+
+   _block_id_to_block.open( data_dir / "database" / "block_num_to_block", _block_log_format );
+   FC_ASSERT( !_block_id_to_block.last_id().valid(),
+              "The block database is not empty, please resync before importing blocks" );
+
+   ilog( "Importing blocks" );
+   const auto start = fc::time_point::now();
+   constexpr size_t batch_size = 1000;
+   // the ids of the imported chain by block number - 1
+   std::vector<block_id_type> chain;
+   vector<signed_block> batch;
+   vector<signed_block> next_batch;
+   bool more = read_import_batch( in, next_batch, batch_size );
+   while( !next_batch.empty() )
+   {
+      std::swap( batch, next_batch );
+      std::vector<fc::future<void>> workers = start_import_verification( batch );
+      // the next batch is read while this one is verified
+      std::exception_ptr failure;
+      try {
+         if( more )
+            more = read_import_batch( in, next_batch, batch_size );
+         else
+            next_batch.clear();
+      } catch( ... ) {
+         failure = std::current_exception();
+      }
+      // all workers must be done before the batch is modified, even if one of them failed
+      for( auto& worker : workers )
+      {
+         try {
+            worker.wait();
+         } catch( ... ) {
+            if( !failure )
+               failure = std::current_exception();
+         }
+      }
+      if( failure )
+         std::rethrow_exception( failure );
+
+      for( const signed_block& block : batch )
+      {
+         const uint32_t block_num = block.block_num();
+         FC_ASSERT( block_num <= chain.size() + 1,
+                    "Block ${n} does not follow block ${h}", ("n",block_num)("h",chain.size()) );
+         const block_id_type expected_previous = ( block_num == 1 ? block_id_type() : chain[block_num - 2] );
+         FC_ASSERT( block.previous == expected_previous,
+                    "Block ${n} does not link to the imported block ${p}", ("n",block_num)("p",expected_previous) );
+         // a block of a fork replaces the blocks from its number on, like in the blocks file
+         while( chain.size() >= block_num )
+         {
+            _block_id_to_block.remove( chain.back() );
+            chain.pop_back();
+         }
+         _block_id_to_block.store( block.id(), block );
+         chain.push_back( block.id() );
+         if( block_num % 100000 == 0 )
+            ilog( "   [by number: ${n}]", ("n",block_num) );
+      }
+   }
+
+   for( const auto& checkpoint : _checkpoints )
+   {
+      if( checkpoint.first > chain.size() )
+         break;
+      FC_ASSERT( chain[checkpoint.first - 1] == checkpoint.second,
+                 "Block ${n} does not match the checkpoint ${id}", ("n",checkpoint.first)("id",checkpoint.second) );
+   }
+
+   _block_id_to_block.flush();
+   _block_id_to_block.close();
+   const auto end = fc::time_point::now();
+   ilog( "Done importing ${n} blocks, elapsed time: ${t} sec",
+         ("n",chain.size())("t",double((end-start).count())/1000000.0) );
+   return chain.size();
+} FC_CAPTURE_AND_RETHROW( (data_dir) ) }
+
 void database::close(bool rewind)
 {
    if (!_opened)
@@ -262,6 +647,10 @@ void database::close(bool rewind)
    // DB state (issue #336).
    clear_pending();
 
+   // the blocks up to the head block must be on disk before the state which refers to them
+   if( _block_id_to_block.is_open() )
+      _block_id_to_block.flush();
+
    ilog( "Writing object database to disk at block ${i}, please DO NOT kill the program", ("i", head_block_num()) );
    object_database::flush();
    ilog( "Done writing object database to disk" );
@@ -27,6 +27,7 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/liquidity_pool_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/is_authorized_asset.hpp>
 
@@ -59,9 +60,9 @@ bool database::check_for_blackswan( const asset_object& mia, bool enable_black_s
 
     asset_id_type debt_asset_id = bitasset.asset_id;
 
-    auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-    bool before_core_hardfork_1270 = ( maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
-    bool after_core_hardfork_2481 = HARDFORK_CORE_2481_PASSED( maint_time ); // Match settle orders with margin calls
+    const auto& hf = get_market_hardfork_era();
+    bool before_core_hardfork_1270 = hf.before_core_hardfork_1270; // call price caching issue
+    bool after_core_hardfork_2481 = hf.after_core_hardfork_2481; // Match settle orders with margin calls
 
     // After core-2481 hard fork, if there are force-settlements, match call orders with them first
     if( after_core_hardfork_2481 )
@@ -118,7 +119,7 @@ bool database::check_for_blackswan( const asset_object& mia, bool enable_black_s
           highest = bitasset.median_feed.max_short_squeeze_price();
        else if( !before_core_hardfork_1270 )
           highest = bitasset.current_feed.max_short_squeeze_price();
-       else if( maint_time > HARDFORK_CORE_338_TIME )
+       else if( !hf.before_core_hardfork_338 )
           highest = bitasset.current_feed.max_short_squeeze_price_before_hf_1270();
        // else do nothing
 
@@ -203,7 +204,7 @@ bool database::check_for_blackswan( const asset_object& mia, bool enable_black_s
           //     settle for less after GS, so they are incentivized to settle before GS which helps avoid GS.
           globally_settle_asset(mia, ~least_collateral, true );
        }
-       else if( maint_time > HARDFORK_CORE_338_TIME && ~least_collateral <= settle_price )
+       else if( !hf.before_core_hardfork_338 && ~least_collateral <= settle_price )
           // global settle at feed price if possible
           globally_settle_asset(mia, settle_price );
        else
@@ -274,7 +275,13 @@ void database::globally_settle_asset_impl( const asset_object& mia,
          is_margin_call = true;
    }
    asset margin_call_fee( 0, bitasset.options.short_backing_asset );
+   asset total_margin_call_fee( 0, bitasset.options.short_backing_asset );
+   const bool is_core_collateral = ( bitasset.options.short_backing_asset == asset_id_type() );
 
+   // Every call order is closed completely.  Instead of calling fill_call_order() for each of them, which adjusts
+   // the order before removing it and looks up the assets again, the payouts are computed here, the orders are
+   // removed as they are and the margin call fees are accumulated once.  The balance changes, the virtual
+   // operations and their order are the same.
    asset pays;
    while( call_itr != call_end )
    {
@@ -310,11 +317,25 @@ void database::globally_settle_asset_impl( const asset_object& mia,
          collateral_gathered += pays;
       }
 
+      total_margin_call_fee += margin_call_fee;
+
+      adjust_balance( order.borrower, order.get_collateral() - pays );
+      if( is_core_collateral )
+      {
+         modify( get_account_stats_by_owner( order.borrower ), [&order]( account_statistics_object& b ){
+            b.total_core_in_orders -= order.collateral;
+         });
+      }
+
       // call order is maker
-      FC_ASSERT( fill_call_order( order, pays, order_debt, fund_receives_price, true, margin_call_fee, false ),
-                 "Internal error: unable to close margin call ${o}", ("o", order) );
+      push_applied_operation( fill_order_operation( order.id, order.borrower, pays, order_debt,
+                                                    margin_call_fee, fund_receives_price, true ) );
+      remove( order );
    }
 
+   // BSIP74: Accumulate the collateral-denominated fee
+   mia.accumulate_fee( *this, total_margin_call_fee );
+
    // Move the individual settlement order to the GS fund
    const limit_order_object* limit_ptr = find_settled_debt_order( bitasset.asset_id );
    if( limit_ptr )
@@ -548,7 +569,7 @@ void database::cancel_limit_order( const limit_order_object& order, bool create_
                fee128 /= order.deferred_fee.value;
                share_type cancel_fee_amount = static_cast<int64_t>(fee128);
                // cancel_fee should be positive, pay it to asset's accumulated_fees
-               fee_asset_dyn_data = &deferred_paid_fee.asset_id(*this).dynamic_asset_data_id(*this);
+               fee_asset_dyn_data = get_resolved_asset( deferred_paid_fee.asset_id ).dynamic_data;
                modify( *fee_asset_dyn_data, [&cancel_fee_amount](asset_dynamic_data_object& addo) {
                   addo.accumulated_fees += cancel_fee_amount;
                });
@@ -586,7 +607,7 @@ void database::cancel_limit_order( const limit_order_object& order, bool create_
       adjust_balance(order.seller, deferred_paid_fee);
       // be here, must have: fee_asset != CORE
       if( !fee_asset_dyn_data )
-         fee_asset_dyn_data = &deferred_paid_fee.asset_id(*this).dynamic_asset_data_id(*this);
+         fee_asset_dyn_data = get_resolved_asset( deferred_paid_fee.asset_id ).dynamic_data;
       modify( *fee_asset_dyn_data, [&](asset_dynamic_data_object& addo) {
          addo.fee_pool += deferred_fee;
       });
@@ -745,8 +766,8 @@ bool database::apply_order(const limit_order_object& new_order_object)
    // 5. the call order's collateral ratio is below or equals to MCR
    // 6. the limit order provided a good price
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_1270 = ( maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
+   const auto& hf = get_market_hardfork_era();
+   bool before_core_hardfork_1270 = hf.before_core_hardfork_1270; // call price caching issue
 
    bool to_check_call_orders = false;
    const asset_object& sell_asset = sell_asset_id( *this );
@@ -1017,8 +1038,8 @@ database::match_result_type database::match_limit_normal_limit( const limit_orde
    asset maker_pays;
    asset maker_receives;
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
+   const auto& hf = get_market_hardfork_era();
+   bool before_core_hardfork_342 = hf.before_core_hardfork_342; // better rounding
 
    bool cull_taker = false;
    if( taker_for_sale <= ( maker_for_sale * match_price ) ) // rounding down here should be fine
@@ -1027,7 +1048,7 @@ database::match_result_type database::match_limit_normal_limit( const limit_orde
 
       // Be here, it's possible that taker is paying something for nothing due to partially filled in last loop.
       // In this case, we see it as filled and cancel it later
-      if( taker_receives.amount == 0 && maint_time > HARDFORK_CORE_184_TIME )
+      if( taker_receives.amount == 0 && !hf.before_core_hardfork_184 )
          return match_result_type::only_taker_filled;
 
       if( before_core_hardfork_342 )
@@ -1118,7 +1139,7 @@ database::match_result_type database::match_limit_settled_debt( const limit_orde
    bool taker_filled = fill_limit_order( taker, call_receives, order_receives, cull_taker, match_price, false );
 
    // Reduce current supply
-   const asset_dynamic_data_object& mia_ddo = call_receives.asset_id(*this).dynamic_asset_data_id(*this);
+   const asset_dynamic_data_object& mia_ddo = *get_resolved_asset( call_receives.asset_id ).dynamic_data;
    modify( mia_ddo, [&call_receives]( asset_dynamic_data_object& ao ){
       ao.current_supply -= call_receives.amount;
    });
@@ -1156,12 +1177,11 @@ database::match_result_type database::match( const limit_order_object& bid, cons
 
    bool cull_taker = false;
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_1270 = ( maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
-   bool after_core_hardfork_2481 = HARDFORK_CORE_2481_PASSED( maint_time ); // Match settle orders with margin calls
+   const auto& hf = get_market_hardfork_era();
+   bool before_core_hardfork_1270 = hf.before_core_hardfork_1270; // call price caching issue
+   bool after_core_hardfork_2481 = hf.after_core_hardfork_2481; // Match settle orders with margin calls
 
-   auto head_time = head_block_time();
-   bool after_core_hardfork_2582 = HARDFORK_CORE_2582_PASSED( head_time ); // Price feed issues
+   bool after_core_hardfork_2582 = hf.after_core_hardfork_2582; // Price feed issues
 
    const auto& feed_price = after_core_hardfork_2582 ? bitasset.median_feed.settlement_price
                                                      : bitasset.current_feed.settlement_price;
@@ -1267,8 +1287,8 @@ asset database::match_impl( const force_settlement_object& settle,
    FC_ASSERT(call.get_debt().asset_id == settle.balance.asset_id );
    FC_ASSERT(call.debt > 0 && call.collateral > 0 && settle.balance.amount > 0);
 
-   auto maint_time = get_dynamic_global_properties().next_maintenance_time;
-   bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
+   const auto& hf = get_market_hardfork_era();
+   bool before_core_hardfork_342 = hf.before_core_hardfork_342; // better rounding
 
    auto settle_for_sale = std::min(settle.balance, max_settlement);
    auto call_debt = call.get_debt();
@@ -1292,7 +1312,7 @@ asset database::match_impl( const force_settlement_object& settle,
 
    // Be here, the call order may be paying nothing.
    bool cull_settle_order = false; // whether need to cancel dust settle order
-   if( maint_time > HARDFORK_CORE_184_TIME && call_pays.amount == 0 )
+   if( !hf.before_core_hardfork_184 && call_pays.amount == 0 )
    {
       if( call_receives == call_debt ) // the call order is smaller than or equal to the settle order
       {
@@ -1519,7 +1539,7 @@ bool database::fill_limit_order( const limit_order_object& order, const asset& p
          }
       }
 
-      const auto& fee_asset_dyn_data = order.deferred_paid_fee.asset_id(*this).dynamic_asset_data_id(*this);
+      const auto& fee_asset_dyn_data = *get_resolved_asset( order.deferred_paid_fee.asset_id ).dynamic_data;
       modify( fee_asset_dyn_data, [deferred_paid_fee,fee_pool_refund](asset_dynamic_data_object& addo) {
          addo.accumulated_fees += deferred_paid_fee;
          addo.fee_pool += fee_pool_refund;
@@ -1585,10 +1605,10 @@ bool database::fill_call_order( const call_order_object& order, const asset& pay
    FC_ASSERT( order.collateral_type() == pays.asset_id );
    FC_ASSERT( order.collateral >= pays.amount );
 
-   // TODO pass in mia and bitasset_data for better performance
-   const asset_object& mia = receives.asset_id(*this);
+   const resolved_asset resolved_mia = get_resolved_asset( receives.asset_id );
+   const asset_object& mia = *resolved_mia.asset;
    FC_ASSERT( mia.is_market_issued() );
-   const asset_bitasset_data_object& bitasset = mia.bitasset_data(*this);
+   const asset_bitasset_data_object& bitasset = *resolved_mia.bitasset_data;
 
    optional<asset> collateral_freed;
    // adjust the order
@@ -1745,9 +1765,62 @@ bool database::fill_settle_order( const force_settlement_object& settle, const a
 bool database::check_call_orders( const asset_object& mia, bool enable_black_swan, bool for_new_limit_order,
                                   const asset_bitasset_data_object* bitasset_ptr,
                                   bool mute_exceptions, bool skip_matching_settle_orders )
+{
+   // The result only depends on the head block, the hard fork states, the arguments and the objects in the
+   // indexes summed up by call_check_change_count(). When none of them has changed since the last call which
+   // did nothing, this call would do nothing either.
+   // Note: the change counts are per index, so any change in a market of another asset forces a re-check too
+   const auto& dyn_prop = get_dynamic_global_properties();
+   const uint8_t flags = ( enable_black_swan ? 1 : 0 ) | ( for_new_limit_order ? 2 : 0 )
+                       | ( mute_exceptions ? 4 : 0 ) | ( skip_matching_settle_orders ? 8 : 0 );
+   const uint64_t changes_before = call_check_change_count();
+
+   auto memo_itr = _call_check_memos.find( mia.get_id() );
+   if( memo_itr != _call_check_memos.end() )
+   {
+      const call_check_memo& memo = memo_itr->second;
+      if( memo.head_block_num == dyn_prop.head_block_number && memo.head_time == dyn_prop.time
+            && memo.maint_time == dyn_prop.next_maintenance_time && memo.change_count == changes_before
+            && memo.flags == flags )
+         return false;
+   }
+
+   bool result = check_call_orders_impl( mia, enable_black_swan, for_new_limit_order, bitasset_ptr,
+                                         mute_exceptions, skip_matching_settle_orders );
+
+   // Only remember the calls which changed nothing, otherwise the next call may still have something to do
+   if( !result && call_check_change_count() == changes_before )
+   {
+      call_check_memo& memo = _call_check_memos[ mia.get_id() ];
+      memo.head_block_num = dyn_prop.head_block_number;
+      memo.head_time = dyn_prop.time;
+      memo.maint_time = dyn_prop.next_maintenance_time;
+      memo.change_count = changes_before;
+      memo.flags = flags;
+   }
+   else
+      _call_check_memos.erase( mia.get_id() );
+
+   return result;
+}
+
+uint64_t database::call_check_change_count()const
+{
+   return get_index_type<call_order_index>().change_count()
+        + get_index_type<limit_order_index>().change_count()
+        + get_index_type<force_settlement_index>().change_count()
+        + get_index_type<asset_index>().change_count()
+        + get_index_type<asset_bitasset_data_index>().change_count()
+        + get_index<asset_dynamic_data_object>().change_count();
+}
+
+bool database::check_call_orders_impl( const asset_object& mia, bool enable_black_swan, bool for_new_limit_order,
+                                       const asset_bitasset_data_object* bitasset_ptr,
+                                       bool mute_exceptions, bool skip_matching_settle_orders )
 { try {
     const auto& dyn_prop = get_dynamic_global_properties();
     auto maint_time = dyn_prop.next_maintenance_time;
+    const auto& hf = get_market_hardfork_era();
     if( for_new_limit_order )
        FC_ASSERT( maint_time <= HARDFORK_CORE_625_TIME ); // `for_new_limit_order` is only true before HF 338 / 625
 
@@ -1778,8 +1851,8 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
     const limit_order_index& limit_index = get_index_type<limit_order_index>();
     const auto& limit_price_index = limit_index.indices().get<by_price>();
 
-    bool before_core_hardfork_1270 = ( maint_time <= HARDFORK_CORE_1270_TIME ); // call price caching issue
-    bool after_core_hardfork_2481 = HARDFORK_CORE_2481_PASSED( maint_time ); // Match settle orders with margin calls
+    bool before_core_hardfork_1270 = hf.before_core_hardfork_1270; // call price caching issue
+    bool after_core_hardfork_2481 = hf.after_core_hardfork_2481; // Match settle orders with margin calls
 
     // Looking for limit orders selling the most USD for the least CORE.
     auto max_price = price::max( bitasset.asset_id, bitasset.options.short_backing_asset );
@@ -1825,19 +1898,18 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
     bool filled_limit = false;
     bool margin_called = false;         // toggles true once/if we actually execute a margin call
 
-    auto head_time = head_block_time();
     auto head_num = head_block_num();
 
-    bool before_hardfork_615 = ( head_time < HARDFORK_615_TIME );
-    bool after_hardfork_436 = ( head_time > HARDFORK_436_TIME );
+    bool before_hardfork_615 = hf.before_hardfork_615;
+    bool after_hardfork_436 = hf.after_hardfork_436;
 
-    bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
-    bool before_core_hardfork_343 = ( maint_time <= HARDFORK_CORE_343_TIME ); // update call_price on partial fill
-    bool before_core_hardfork_453 = ( maint_time <= HARDFORK_CORE_453_TIME ); // multiple matching issue
-    bool before_core_hardfork_606 = ( maint_time <= HARDFORK_CORE_606_TIME ); // feed always trigger call
-    bool before_core_hardfork_834 = ( maint_time <= HARDFORK_CORE_834_TIME ); // target collateral ratio option
+    bool before_core_hardfork_342 = hf.before_core_hardfork_342; // better rounding
+    bool before_core_hardfork_343 = hf.before_core_hardfork_343; // update call_price on partial fill
+    bool before_core_hardfork_453 = hf.before_core_hardfork_453; // multiple matching issue
+    bool before_core_hardfork_606 = hf.before_core_hardfork_606; // feed always trigger call
+    bool before_core_hardfork_834 = hf.before_core_hardfork_834; // target collateral ratio option
 
-    bool after_core_hardfork_2582 = HARDFORK_CORE_2582_PASSED( head_time ); // Price feed issues
+    bool after_core_hardfork_2582 = hf.after_core_hardfork_2582; // Price feed issues
 
     auto has_call_order = [ before_core_hardfork_1270,
                             &call_collateral_itr,&call_collateral_end,
@@ -2295,7 +2367,7 @@ asset database::pay_market_fees(const account_object* seller, const asset_object
 
       if( issuer_fees.amount > reward.amount )
       {
-         const auto& recv_dyn_data = recv_asset.dynamic_asset_data_id(*this);
+         const auto& recv_dyn_data = *get_resolved_asset( recv_asset.get_id() ).dynamic_data;
          modify( recv_dyn_data, [&issuer_fees, &reward]( asset_dynamic_data_object& obj ){
             obj.accumulated_fees += issuer_fees.amount - reward.amount;
          });
@@ -2333,4 +2405,47 @@ asset database::pay_force_settle_fees(const asset_object& collecting_asset, cons
    return settle_fee;
 }
 
+liquidity_pool_exchange_quote database::quote_liquidity_pool_exchange( const liquidity_pool_object& pool,
+                                                                       const asset& amount_to_sell,
+                                                                       const asset_object& pool_receives_asset,
+                                                                       const asset_object& pool_pays_asset )const
+{
+   FC_ASSERT( pool.balance_a > 0 && pool.balance_b > 0, "The pool has not been initialized" );
+   const bool sell_a = ( amount_to_sell.asset_id == pool.asset_a );
+   FC_ASSERT( ( sell_a && pool_receives_asset.get_id() == pool.asset_a && pool_pays_asset.get_id() == pool.asset_b )
+              || ( amount_to_sell.asset_id == pool.asset_b && pool_receives_asset.get_id() == pool.asset_b
+                   && pool_pays_asset.get_id() == pool.asset_a ),
+              "Asset type mismatch" );
+
+   liquidity_pool_exchange_quote result;
+
+   result.maker_market_fee = calculate_market_fee( pool_receives_asset, amount_to_sell, true );
+   FC_ASSERT( result.maker_market_fee < amount_to_sell,
+              "Aborting since the maker market fee of the selling asset is too high" );
+   result.pool_receives = amount_to_sell - result.maker_market_fee;
+
+   const share_type old_receives_balance = ( sell_a ? pool.balance_a : pool.balance_b );
+   const share_type old_pays_balance = ( sell_a ? pool.balance_b : pool.balance_a );
+   share_type new_receives_balance = old_receives_balance + result.pool_receives.amount;
+   // round up
+   fc::uint128_t new_pays_balance = ( pool.virtual_value + new_receives_balance.value - 1 )
+                                    / new_receives_balance.value;
+   FC_ASSERT( new_pays_balance <= fc::uint128_t( old_pays_balance.value ), "Internal error" );
+   fc::uint128_t delta = fc::uint128_t( old_pays_balance.value ) - new_pays_balance;
+
+   fc::uint128_t pool_taker_fee = delta * pool.taker_fee_percent / GRAPHENE_100_PERCENT;
+   FC_ASSERT( pool_taker_fee <= delta, "Taker fee percent of the pool is too high" );
+
+   result.pool_pays = asset( static_cast<int64_t>( delta - pool_taker_fee ), pool_pays_asset.get_id() );
+
+   result.taker_market_fee = calculate_market_fee( pool_pays_asset, result.pool_pays, false );
+   FC_ASSERT( result.taker_market_fee <= result.pool_pays,
+              "Market fee should not be greater than the amount to receive" );
+   result.account_receives = result.pool_pays - result.taker_market_fee;
+
+   result.pool_taker_fee = asset( static_cast<int64_t>( pool_taker_fee ), pool_pays_asset.get_id() );
+
+   return result;
+}
+
 } }
@@ -24,6 +24,12 @@
 #include <graphene/chain/impacted.hpp>
 #include <graphene/chain/hardfork.hpp>
 
+#include <fc/thread/parallel.hpp>
+
+#include <array>
+#include <exception>
+#include <utility>
+
 using namespace fc;
 namespace graphene { namespace chain { namespace detail {
 
@@ -385,14 +391,35 @@ struct get_impacted_account_visitor
    }
 };
 
+using impacted_accounts_extractor = void (*)( const operation&, flat_set<account_id_type>&, bool );
+
+template<typename Op>
+void extract_impacted_accounts( const operation& op, flat_set<account_id_type>& result,
+      bool ignore_custom_op_required_auths )
+{
+  get_impacted_account_visitor vtor( result, ignore_custom_op_required_auths );
+  vtor( op.get<Op>() );
+}
+
+template<size_t... Tags>
+constexpr std::array<impacted_accounts_extractor, sizeof...(Tags)>
+make_impacted_accounts_extractors( std::index_sequence<Tags...> )
+{
+  return {{ &extract_impacted_accounts< fc::typelist::at<operation::list, Tags> >... }};
+}
+
+/// The extraction function of every operation type, indexed by the tag, so that an operation is dispatched with
+/// one indirect call instead of a visit
+static constexpr auto impacted_accounts_extractors
+      = make_impacted_accounts_extractors( std::make_index_sequence<operation::count()>() );
+
 } // namespace detail
 
 // Declared in impacted.hpp
 void operation_get_impacted_accounts( const operation& op, flat_set<account_id_type>& result,
       bool ignore_custom_op_required_auths )
 {
-  detail::get_impacted_account_visitor vtor( result, ignore_custom_op_required_auths );
-  op.visit( vtor );
+  detail::impacted_accounts_extractors[op.which()]( op, result, ignore_custom_op_required_auths );
 }
 
 // Declared in impacted.hpp, although only used in this file
@@ -403,6 +430,79 @@ void transaction_get_impacted_accs( const transaction& tx, flat_set<account_id_t
     operation_get_impacted_accounts( op, result, ignore_custom_op_required_auths );
 }
 
+// Declared in impacted.hpp
+transaction_conflict_set transaction_get_conflict_set( const transaction& tx )
+{
+  transaction_conflict_set result;
+  for( const auto& op : tx.operations )
+  {
+    // Transfers only read the asset they transfer, but the fee pool of the asset they pay the fee in is modified
+    // unless it is CORE
+    if( op.is_type<transfer_operation>() )
+    {
+      const auto& fee = op.get<transfer_operation>().fee;
+      if( fee.asset_id != asset_id_type() )
+        result.assets.insert( fee.asset_id );
+    }
+    else if( op.is_type<override_transfer_operation>() )
+    {
+      const auto& fee = op.get<override_transfer_operation>().fee;
+      if( fee.asset_id != asset_id_type() )
+        result.assets.insert( fee.asset_id );
+    }
+    else
+    {
+      // the effects of other operations, e.g. matching orders or changing votes, can reach beyond the accounts
+      // and assets they name
+      result.conflicts_with_all = true;
+    }
+    operation_get_impacted_accounts( op, result.accounts, true );
+  }
+  return result;
+}
+
+// Declared in impacted.hpp
+std::vector<uint32_t> schedule_transaction_waves( const std::vector<transaction_conflict_set>& sets )
+{
+  std::vector<uint32_t> result;
+  result.reserve( sets.size() );
+  // the number of waves which transactions touching an account or an asset have to come after
+  flat_map<account_id_type, uint32_t> account_waves;
+  flat_map<asset_id_type, uint32_t> asset_waves;
+  uint32_t wave_count = 0;   // the number of waves used so far
+  uint32_t barrier_waves = 0; // the number of waves up to the last transaction which conflicts with all
+  for( const auto& set : sets )
+  {
+    uint32_t wave = barrier_waves;
+    if( set.conflicts_with_all )
+      wave = wave_count;
+    else
+    {
+      for( const auto& account : set.accounts )
+      {
+        auto itr = account_waves.find( account );
+        if( itr != account_waves.end() )
+          wave = std::max( wave, itr->second );
+      }
+      for( const auto& asset_id : set.assets )
+      {
+        auto itr = asset_waves.find( asset_id );
+        if( itr != asset_waves.end() )
+          wave = std::max( wave, itr->second );
+      }
+    }
+    result.push_back( wave );
+    wave_count = std::max( wave_count, wave + 1 );
+    if( set.conflicts_with_all )
+      barrier_waves = wave + 1;
+    for( const auto& account : set.accounts )
+      account_waves[account] = wave + 1;
+    for( const auto& asset_id : set.assets )
+      asset_waves[asset_id] = wave + 1;
+  }
+  return result;
+}
+
 static void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accounts,
                             bool ignore_custom_op_required_auths ) {
    FC_ASSERT( obj != nullptr, "Internal error: get_relevant_accounts called with nullptr" ); // This should not happen
@@ -526,8 +626,9 @@ static void get_relevant_accounts( const object* obj, flat_set<account_id_type>&
               break;
            } case impl_transaction_history_object_type:{
               const auto* aobj = dynamic_cast<const transaction_history_object*>(obj);
-              transaction_get_impacted_accs( aobj->trx, accounts,
-                                             ignore_custom_op_required_auths );
+              if( aobj->trx.valid() )
+                 transaction_get_impacted_accs( *aobj->trx, accounts,
+                                                ignore_custom_op_required_auths );
               break;
            } case impl_blinded_balance_object_type:{
               const auto* aobj = dynamic_cast<const blinded_balance_object*>(obj);
@@ -577,47 +678,157 @@ void database::notify_on_pending_transaction( const signed_transaction& tx )
    GRAPHENE_TRY_NOTIFY( on_pending_transaction, tx )
 }
 
+void database::notify_block_notifications_finished( const signed_block& block )
+{
+   GRAPHENE_TRY_NOTIFY( block_notifications_finished, block )
+}
+
+/**
+ * @return the accounts of @p subscribed which are relevant to any of the objects, see @ref get_relevant_accounts.
+ * Many objects are processed in chunks by worker threads. A chunk is not processed further once all subscribed
+ * accounts were found in it.
+ */
+static flat_set<account_id_type> get_subscribed_relevant_accounts( const vector<const object*>& objs,
+                                                                   const flat_set<account_id_type>& subscribed,
+                                                                   bool ignore_custom_op_required_auths )
+{
+   constexpr size_t min_chunk_size = 256;
+   const auto collect = [&objs,&subscribed,ignore_custom_op_required_auths]( size_t begin, size_t end,
+                                                                             flat_set<account_id_type>& found ) {
+      flat_set<account_id_type> accounts;
+      for( size_t i = begin; i < end && found.size() < subscribed.size(); ++i )
+      {
+         accounts.clear();
+         get_relevant_accounts( objs[i], accounts, ignore_custom_op_required_auths );
+         for( const auto& account : accounts )
+         {
+            if( subscribed.find( account ) != subscribed.end() )
+               found.insert( account );
+         }
+      }
+   };
+
+   flat_set<account_id_type> result;
+   const size_t threads = fc::asio::default_io_service_scope::get_num_threads();
+   if( threads < 2 || objs.size() < 2 * min_chunk_size )
+   {
+      collect( 0, objs.size(), result );
+      return result;
+   }
+
+   const size_t chunk_size = std::max( min_chunk_size, ( objs.size() + threads - 1 ) / threads );
+   vector<flat_set<account_id_type>> partial_results( ( objs.size() + chunk_size - 1 ) / chunk_size );
+   std::vector<fc::future<void>> workers;
+   for( size_t chunk = 0; chunk < partial_results.size(); ++chunk )
+   {
+      const size_t begin = chunk * chunk_size;
+      const size_t end = std::min( begin + chunk_size, objs.size() );
+      workers.push_back( fc::do_parallel( [&collect,&partial_results,chunk,begin,end] () {
+         collect( begin, end, partial_results[chunk] );
+      } ) );
+   }
+   // all workers must be done before the objects go away, even if one of them failed
+   std::exception_ptr failure;
+   for( auto& worker : workers )
+   {
+      try {
+         worker.wait();
+      } catch( ... ) {
+         if( !failure )
+            failure = std::current_exception();
+      }
+   }
+   if( failure )
+      std::rethrow_exception( failure );
+   for( const auto& partial : partial_results )
+      result.insert( partial.begin(), partial.end() );
+   return result;
+}
+
+void database::subscribe_impacted_account( account_id_type account )
+{
+   std::lock_guard<std::mutex> guard( _impacted_account_mutex );
+   if( _impacted_account_subscriptions[account]++ > 0 )
+      return;
+   auto accounts = std::make_shared<flat_set<account_id_type>>();
+   for( const auto& item : _impacted_account_subscriptions )
+      accounts->insert( item.first );
+   std::atomic_store( &_subscribed_impacted_accounts, std::shared_ptr<const flat_set<account_id_type>>( accounts ) );
+}
+
+void database::unsubscribe_impacted_account( account_id_type account )
+{
+   std::lock_guard<std::mutex> guard( _impacted_account_mutex );
+   auto itr = _impacted_account_subscriptions.find( account );
+   if( itr == _impacted_account_subscriptions.end() || --itr->second > 0 )
+      return;
+   _impacted_account_subscriptions.erase( itr );
+   std::shared_ptr<const flat_set<account_id_type>> accounts;
+   if( !_impacted_account_subscriptions.empty() )
+   {
+      auto remaining = std::make_shared<flat_set<account_id_type>>();
+      for( const auto& item : _impacted_account_subscriptions )
+         remaining->insert( item.first );
+      accounts = remaining;
+   }
+   std::atomic_store( &_subscribed_impacted_accounts, accounts );
+}
+
 void database::notify_changed_objects()
 { try {
    if( _undo_db.enabled() )
    {
       const auto& head_undo = _undo_db.head();
-      auto chain_time = head_block_time();
+      const bool ignore_custom_op_reqd_auths = MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( head_block_time() );
+      // the impacted accounts are only computed for the accounts which somebody asked for
+      const auto subscribed = std::atomic_load( &_subscribed_impacted_accounts );
+      const auto impacted_accounts = [&subscribed,ignore_custom_op_reqd_auths]( const vector<const object*>& objs ) {
+         if( subscribed == nullptr )
+            return flat_set<account_id_type>();
+         return get_subscribed_relevant_accounts( objs, *subscribed, ignore_custom_op_reqd_auths );
+      };
+      vector<const object*> objs;
 
       // New
       if( !new_objects.empty() )
       {
         vector<object_id_type> new_ids;
         new_ids.reserve(head_undo.new_ids.size());
-        flat_set<account_id_type> new_accounts_impacted;
+        objs.clear();
         for( const auto& item : head_undo.new_ids )
         {
           new_ids.push_back(item);
           auto* obj = find_object(item);
           if(obj != nullptr)
-            get_relevant_accounts(obj, new_accounts_impacted,
-                                  MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time));
+            objs.push_back(obj);
         }
 
         if( new_ids.size() )
-           GRAPHENE_TRY_NOTIFY( new_objects, new_ids, new_accounts_impacted)
+           GRAPHENE_TRY_NOTIFY( new_objects, new_ids, impacted_accounts(objs) )
       }
 
       // Changed
       if( !changed_objects.empty() )
       {
         vector<object_id_type> changed_ids;
-        changed_ids.reserve(head_undo.old_values.size());
-        flat_set<account_id_type> changed_accounts_impacted;
+        changed_ids.reserve(head_undo.old_values.size() + head_undo.old_packed_values.size());
+        objs.clear();
         for( const auto& item : head_undo.old_values )
         {
           changed_ids.push_back(item.first);
-          get_relevant_accounts(item.second.get(), changed_accounts_impacted,
-                                MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time));
+          objs.push_back(item.second.get());
+        }
+        // Packed pre-images are not unpacked here, the current value of the object is used instead
+        for( const auto& item : head_undo.old_packed_values )
+        {
+          changed_ids.push_back(item.first);
+          auto* obj = find_object(item.first);
+          if(obj != nullptr)
+            objs.push_back(obj);
         }
 
         if( changed_ids.size() )
-           GRAPHENE_TRY_NOTIFY( changed_objects, changed_ids, changed_accounts_impacted)
+           GRAPHENE_TRY_NOTIFY( changed_objects, changed_ids, impacted_accounts(objs) )
       }
 
       // Removed
@@ -627,18 +838,14 @@ void database::notify_changed_objects()
         removed_ids.reserve( head_undo.removed.size() );
         vector<const object*> removed;
         removed.reserve( head_undo.removed.size() );
-        flat_set<account_id_type> removed_accounts_impacted;
         for( const auto& item : head_undo.removed )
         {
           removed_ids.emplace_back( item.first );
-          auto* obj = item.second.get();
-          removed.emplace_back( obj );
-          get_relevant_accounts(obj, removed_accounts_impacted,
-                                MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time));
+          removed.emplace_back( item.second.get() );
         }
 
         if( removed_ids.size() )
-           GRAPHENE_TRY_NOTIFY( removed_objects, removed_ids, removed, removed_accounts_impacted )
+           GRAPHENE_TRY_NOTIFY( removed_objects, removed_ids, removed, impacted_accounts(removed) )
       }
    }
 } catch( const graphene::chain::plugin_exception& e ) {
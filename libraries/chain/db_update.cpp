@@ -148,7 +148,7 @@ void database::clear_expired_transactions()
    auto& transaction_idx = static_cast<transaction_index&>(get_mutable_index(implementation_ids,
                                                                              impl_transaction_history_object_type));
    const auto& dedupe_index = transaction_idx.indices().get<by_expiration>();
-   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.begin()->trx.expiration) )
+   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.begin()->expiration) )
       transaction_idx.remove(*dedupe_index.begin());
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -222,6 +222,21 @@ static optional<price> get_derived_current_feed_price( const database& db,
    return result;
 }
 
+// Helper function to update median_feed and derive current_feed from it.
+static void update_median_and_current_feed( const database& db, asset_bitasset_data_object& abdo )
+{
+   using bsrm_type = bitasset_options::black_swan_response_type;
+   const auto bsrm = abdo.get_black_swan_response_method();
+   abdo.update_median_feeds( db.head_block_time(), db.get_dynamic_global_properties().next_maintenance_time );
+   abdo.current_feed = abdo.median_feed;
+   if( bsrm_type::no_settlement == bsrm || bsrm_type::individual_settlement_to_fund == bsrm )
+   {
+      const auto new_current_feed_price = get_derived_current_feed_price( db, abdo );
+      if( new_current_feed_price.valid() )
+         abdo.current_feed.settlement_price = *new_current_feed_price;
+   }
+}
+
 void database::update_bitasset_current_feed( const asset_bitasset_data_object& bitasset, bool skip_median_update )
 {
    // For better performance, if nothing to update, we return
@@ -246,23 +261,26 @@ void database::update_bitasset_current_feed( const asset_bitasset_data_object& b
    }
 
    // We need to update the database
-   modify( bitasset, [this, skip_median_update, &new_current_feed_price, &bsrm]
-                     ( asset_bitasset_data_object& abdo )
+   modify( bitasset, [this, skip_median_update, &new_current_feed_price]( asset_bitasset_data_object& abdo )
    {
       if( !skip_median_update )
-      {
-         const auto& head_time = head_block_time();
-         const auto& maint_time = get_dynamic_global_properties().next_maintenance_time;
-         abdo.update_median_feeds( head_time, maint_time );
-         abdo.current_feed = abdo.median_feed;
-         if( bsrm_type::no_settlement == bsrm || bsrm_type::individual_settlement_to_fund == bsrm )
-            new_current_feed_price = get_derived_current_feed_price( *this, abdo );
-      }
-      if( new_current_feed_price.valid() )
+         update_median_and_current_feed( *this, abdo );
+      else if( new_current_feed_price.valid() )
          abdo.current_feed.settlement_price = *new_current_feed_price;
    } );
 }
 
+void database::publish_bitasset_feed( const asset_bitasset_data_object& bitasset, account_id_type publisher,
+                                      const price_feed_with_icr& feed )
+{
+   // Storing the feed and updating the median separately would back up the object with all its feeds twice
+   modify( bitasset, [this, &publisher, &feed]( asset_bitasset_data_object& abdo )
+   {
+      abdo.feeds[publisher] = make_pair( head_block_time(), feed );
+      update_median_and_current_feed( *this, abdo );
+   } );
+}
+
 void database::clear_expired_orders()
 { try {
          //Cancel expired limit orders
@@ -312,44 +330,68 @@ void database::clear_expired_force_settlements()
    const bool before_core_hardfork_184 = ( maint_time <= HARDFORK_CORE_184_TIME ); // something-for-nothing
    const bool before_core_hardfork_342 = ( maint_time <= HARDFORK_CORE_342_TIME ); // better rounding
 
-   asset_id_type current_asset = settlement_index.begin()->settlement_asset_id();
-   const asset_object* mia_object_ptr = &get(current_asset);
-   const asset_bitasset_data_object* mia_ptr = &mia_object_ptr->bitasset_data(*this);
+   // State of the asset whose settle orders are being processed.
+   // The volume limit and the fill price are calculated at most once per asset, and the settled volume is
+   // accumulated here and written to the bitasset data object once when we are done with the asset.
+   struct asset_settlement_state
+   {
+      asset_id_type                     asset_id;
+      const asset_object*               mia_object = nullptr;
+      const asset_bitasset_data_object* mia = nullptr;
+      optional<asset>                   max_settlement_volume;
+      optional<price>                   settlement_fill_price;
+      share_type                        settled_volume;
+      bool                              finished = false;
+   } current;
+
+   auto load_asset = [&current, this]( asset_id_type asset_id ) {
+      current.asset_id = asset_id;
+      current.mia_object = &get(asset_id);
+      current.mia = &current.mia_object->bitasset_data(*this);
+      current.max_settlement_volume.reset();
+      current.settlement_fill_price.reset();
+      current.settled_volume = current.mia->force_settled_volume;
+      current.finished = false;
+   };
 
-   asset max_settlement_volume;
-   price settlement_fill_price;
-   price settlement_price;
-   bool current_asset_finished = false;
+   auto store_settled_volume = [&current, this] {
+      if( current.mia->force_settled_volume != current.settled_volume )
+      {
+         modify( *current.mia, [&current]( asset_bitasset_data_object& b ) {
+            b.force_settled_volume = current.settled_volume;
+         });
+      }
+   };
 
-   auto next_asset = [&current_asset, &mia_object_ptr, &mia_ptr, &current_asset_finished, &settlement_index, this] {
-      const auto bound = settlement_index.upper_bound(current_asset);
+   auto next_asset = [&current, &settlement_index, &load_asset, &store_settled_volume] {
+      store_settled_volume();
+      const auto bound = settlement_index.upper_bound(current.asset_id);
       if( bound == settlement_index.end() )
          return false;
-      current_asset = bound->settlement_asset_id();
-      mia_object_ptr = &get(current_asset);
-      mia_ptr = &mia_object_ptr->bitasset_data(*this);
-      current_asset_finished = false;
+      load_asset( bound->settlement_asset_id() );
       return true;
    };
 
+   load_asset( settlement_index.begin()->settlement_asset_id() );
+
+   price settlement_price;
+
    // At each iteration, we either consume the current order and remove it, or we move to the next asset
-   for( auto itr = settlement_index.lower_bound(current_asset);
+   for( auto itr = settlement_index.lower_bound(current.asset_id);
         itr != settlement_index.end();
-        itr = settlement_index.lower_bound(current_asset) )
+        itr = settlement_index.lower_bound(current.asset_id) )
    {
       const force_settlement_object& settle_order = *itr;
       auto settle_order_id = settle_order.id;
 
-      if( current_asset != settle_order.settlement_asset_id() )
+      if( current.asset_id != settle_order.settlement_asset_id() )
       {
-         current_asset = settle_order.settlement_asset_id();
-         mia_object_ptr = &get(current_asset);
-         mia_ptr = &mia_object_ptr->bitasset_data(*this);
-         // Note: we did not reset current_asset_finished to false here, it is OK,
-         //       because current_asset should not have changed if current_asset_finished is true
+         // All settle orders of the current asset have been consumed
+         store_settled_volume();
+         load_asset( settle_order.settlement_asset_id() );
       }
-      const asset_object& mia_object = *mia_object_ptr;
-      const asset_bitasset_data_object& mia = *mia_ptr;
+      const asset_object& mia_object = *current.mia_object;
+      const asset_bitasset_data_object& mia = *current.mia;
 
       if( mia.has_settlement() )
       {
@@ -382,22 +424,24 @@ void database::clear_expired_force_settlements()
       }
       // Note: although current supply would decrease during filling the settle orders,
       //       we always calculate with the initial value
-      if( max_settlement_volume.asset_id != current_asset )
-         max_settlement_volume = mia_object.amount( mia.max_force_settlement_volume(
-                                                           mia_object.dynamic_data(*this).current_supply ) );
-      // When current_asset_finished is true, this would be the 2nd time processing the same order.
+      if( !current.max_settlement_volume.valid() )
+         current.max_settlement_volume = mia_object.amount( mia.max_force_settlement_volume(
+                                                                  mia_object.dynamic_data(*this).current_supply ) );
+      const asset& max_settlement_volume = *current.max_settlement_volume;
+      // When current.finished is true, this would be the 2nd time processing the same order.
       // In this case, we move to the next asset.
-      if( mia.force_settled_volume >= max_settlement_volume.amount || current_asset_finished )
+      if( current.settled_volume >= max_settlement_volume.amount || current.finished )
       {
          if( next_asset() )
             continue;
          break;
       }
 
-      if( settlement_fill_price.base.asset_id != current_asset ) // only calculate once per asset
-         settlement_fill_price = mia.current_feed.settlement_price
+      if( !current.settlement_fill_price.valid() ) // only calculate once per asset
+         current.settlement_fill_price = mia.current_feed.settlement_price
                                  / ratio_type( GRAPHENE_100_PERCENT - mia.options.force_settlement_offset_percent,
                                                GRAPHENE_100_PERCENT );
+      const price& settlement_fill_price = *current.settlement_fill_price;
 
       if( before_core_hardfork_342 )
       {
@@ -409,10 +453,10 @@ void database::clear_expired_force_settlements()
          assert(receives <= settle_order.balance * mia.current_feed.settlement_price);
          settlement_price = pays / receives;
       }
-      else if( settlement_price.base.asset_id != current_asset ) // only calculate once per asset
+      else
          settlement_price = settlement_fill_price;
 
-      asset settled = mia_object.amount(mia.force_settled_volume);
+      asset settled = mia_object.amount(current.settled_volume);
       // Match against the least collateralized short until the settlement is finished or we reach max settlements
       while( settled < max_settlement_volume && find_object(settle_order_id) )
       {
@@ -440,7 +484,7 @@ void database::clear_expired_force_settlements()
             if( !before_core_hardfork_184 && new_settled.amount == 0 ) // unable to fill this settle order
             {
                // current asset is finished when the settle order hasn't been cancelled
-               current_asset_finished = ( nullptr != find_object( settle_order_id ) );
+               current.finished = ( nullptr != find_object( settle_order_id ) );
                break;
             }
             settled += new_settled;
@@ -464,13 +508,9 @@ void database::clear_expired_force_settlements()
             break;
          }
       }
-      if( mia.force_settled_volume != settled.amount )
-      {
-         modify(mia, [&settled](asset_bitasset_data_object& b) {
-            b.force_settled_volume = settled.amount;
-         });
-      }
+      current.settled_volume = settled.amount;
    }
+   store_settled_volume();
 } FC_CAPTURE_AND_RETHROW() }
 
 void database::update_expired_feeds()
@@ -600,6 +640,18 @@ generic_operation_result database::process_tickets()
    const auto maint_time = get_dynamic_global_properties().next_maintenance_time;
    ticket_version version = ( HARDFORK_CORE_2262_PASSED(maint_time) ? ticket_v2 : ticket_v1 );
 
+   // The changes of the ticket totals of the accounts, applied once per account after all due tickets are
+   // processed, since an account often has many tickets which are updated at the same time
+   struct ticket_totals_delta
+   {
+      share_type core_inactive;
+      share_type core_pob;
+      share_type core_pol;
+      share_type pob_value;
+      share_type pol_value;
+   };
+   flat_map<account_id_type, ticket_totals_delta> account_deltas;
+
    generic_operation_result result;
    share_type total_delta_pob;
    share_type total_delta_inactive;
@@ -607,15 +659,13 @@ generic_operation_result database::process_tickets()
    while( !idx.empty() && idx.begin()->next_auto_update_time <= head_block_time() )
    {
       const ticket_object& ticket = *idx.begin();
-      const auto& stat = get_account_stats_by_owner( ticket.account );
+      ticket_totals_delta& account_delta = account_deltas[ticket.account];
       if( ticket.status == withdrawing && ticket.current_type == liquid )
       {
          adjust_balance( ticket.account, ticket.amount );
          // Note: amount.asset_id is checked when creating the ticket, so no check here
-         modify( stat, [&ticket](account_statistics_object& aso) {
-            aso.total_core_pol -= ticket.amount.amount;
-            aso.total_pol_value -= ticket.value;
-         });
+         account_delta.core_pol -= ticket.amount.amount;
+         account_delta.pol_value -= ticket.value;
          result.removed_objects.insert( ticket.id );
          remove( ticket );
       }
@@ -628,55 +678,55 @@ generic_operation_result database::process_tickets()
          });
          result.updated_objects.insert( ticket.id );
 
-         share_type delta_inactive_amount;
-         share_type delta_forever_amount;
-         share_type delta_forever_value;
-         share_type delta_other_amount;
-         share_type delta_other_value;
-
          if( old_type == lock_forever ) // It implies that the new type is lock_forever too
          {
             if( ticket.value == 0 )
             {
                total_delta_pob -= ticket.amount.amount;
                total_delta_inactive += ticket.amount.amount;
-               delta_inactive_amount = ticket.amount.amount;
-               delta_forever_amount = -ticket.amount.amount;
+               account_delta.core_inactive += ticket.amount.amount;
+               account_delta.core_pob -= ticket.amount.amount;
             }
-            delta_forever_value = ticket.value - old_value;
+            account_delta.pob_value += ticket.value - old_value;
          }
          else // old_type != lock_forever
          {
             if( ticket.current_type == lock_forever )
             {
                total_delta_pob += ticket.amount.amount;
-               delta_forever_amount = ticket.amount.amount;
-               delta_forever_value = ticket.value;
-               delta_other_amount = -ticket.amount.amount;
-               delta_other_value = -old_value;
+               account_delta.core_pob += ticket.amount.amount;
+               account_delta.pob_value += ticket.value;
+               account_delta.core_pol -= ticket.amount.amount;
+               account_delta.pol_value -= old_value;
             }
             else // ticket.current_type != lock_forever
             {
-               delta_other_value = ticket.value - old_value;
+               account_delta.pol_value += ticket.value - old_value;
             }
          }
-
-         // Note: amount.asset_id is checked when creating the ticket, so no check here
-         modify( stat, [delta_inactive_amount,delta_forever_amount,delta_forever_value,
-                        delta_other_amount,delta_other_value](account_statistics_object& aso) {
-            aso.total_core_inactive += delta_inactive_amount;
-            aso.total_core_pob += delta_forever_amount;
-            aso.total_core_pol += delta_other_amount;
-            aso.total_pob_value += delta_forever_value;
-            aso.total_pol_value += delta_other_value;
-         });
-
       }
       // TODO if a lock_forever ticket lost all the value, remove it
    }
 
    // TODO merge stable tickets with the same account and the same type
 
+   // Update account statistics
+   // Note: amount.asset_id is checked when creating the ticket, so no check here
+   for( const auto& item : account_deltas )
+   {
+      const ticket_totals_delta& delta = item.second;
+      if( delta.core_inactive == 0 && delta.core_pob == 0 && delta.core_pol == 0
+            && delta.pob_value == 0 && delta.pol_value == 0 )
+         continue;
+      modify( get_account_stats_by_owner( item.first ), [&delta](account_statistics_object& aso) {
+         aso.total_core_inactive += delta.core_inactive;
+         aso.total_core_pob += delta.core_pob;
+         aso.total_core_pol += delta.core_pol;
+         aso.total_pob_value += delta.pob_value;
+         aso.total_pol_value += delta.pol_value;
+      });
+   }
+
    // Update global data
    if( total_delta_pob != 0 || total_delta_inactive != 0 )
    {
@@ -760,4 +810,189 @@ void database::update_credit_offers_and_deals()
    }
 }
 
+
+void database::apply_expiration_sweeps()
+{
+   for( size_t i = 0; i < expiration_sweep_count; ++i )
+   {
+      const auto sweep = static_cast<expiration_sweep_type>( i );
+      if( !expiration_sweep_due( sweep ) )
+      {
+         ++_expiration_sweeps[i].skips;
+         continue;
+      }
+      ++_expiration_sweeps[i].runs;
+      switch( sweep )
+      {
+         case expiration_sweep_type::transactions:
+            clear_expired_transactions();
+            break;
+         case expiration_sweep_type::proposals:
+            clear_expired_proposals();
+            break;
+         case expiration_sweep_type::limit_orders:
+            clear_expired_orders();
+            break;
+         case expiration_sweep_type::force_settlements:
+            clear_expired_force_settlements();
+            break;
+         case expiration_sweep_type::htlcs:
+            clear_expired_htlcs();
+            break;
+         case expiration_sweep_type::feeds:
+            update_expired_feeds();       // this will update expired feeds and some core exchange rates
+            update_core_exchange_rates(); // this will update remaining core exchange rates
+            break;
+         case expiration_sweep_type::withdraw_permissions:
+            update_withdraw_permissions();
+            break;
+         case expiration_sweep_type::credit_offers_and_deals:
+            update_credit_offers_and_deals();
+            break;
+      }
+   }
+   update_expiration_sweep_schedule();
+}
+
+uint64_t database::expiration_sweep_change_count( expiration_sweep_type sweep )const
+{
+   switch( sweep )
+   {
+      case expiration_sweep_type::transactions:
+         return get_index_type<transaction_index>().change_count();
+      case expiration_sweep_type::proposals:
+         return get_index_type<proposal_index>().change_count();
+      case expiration_sweep_type::limit_orders:
+         return get_index_type<limit_order_index>().change_count();
+      case expiration_sweep_type::force_settlements:
+         // a global settlement cancels the force settlements of the asset at once
+         return get_index_type<force_settlement_index>().change_count()
+              + get_index_type<asset_bitasset_data_index>().change_count();
+      case expiration_sweep_type::htlcs:
+         return get_index_type<htlc_index>().change_count();
+      case expiration_sweep_type::feeds:
+         return get_index_type<asset_bitasset_data_index>().change_count();
+      case expiration_sweep_type::withdraw_permissions:
+         return get_index_type<withdraw_permission_index>().change_count();
+      case expiration_sweep_type::credit_offers_and_deals:
+         return get_index_type<credit_offer_index>().change_count()
+              + get_index_type<credit_deal_index>().change_count();
+   }
+   FC_THROW_EXCEPTION( fc::assert_exception, "Unknown expiration sweep ${s}", ("s", static_cast<uint32_t>(sweep)) );
+}
+
+bool database::expiration_sweep_due( expiration_sweep_type sweep )const
+{
+   const expiration_sweep_state& state = _expiration_sweeps[ static_cast<size_t>( sweep ) ];
+   if( !state.next_due.valid() || expiration_sweep_change_count( sweep ) != state.change_count )
+      return true;
+   return *state.next_due <= head_block_time();
+}
+
+void database::update_expiration_sweep_schedule()
+{
+   for( size_t i = 0; i < expiration_sweep_count; ++i )
+   {
+      const auto sweep = static_cast<expiration_sweep_type>( i );
+      expiration_sweep_state& state = _expiration_sweeps[i];
+      const auto change_count = expiration_sweep_change_count( sweep );
+      if( state.next_due.valid() && change_count == state.change_count )
+         continue;
+      state.next_due = next_expiration_sweep_time( sweep );
+      state.change_count = change_count;
+   }
+}
+
+fc::time_point_sec database::next_expiration_sweep_time( expiration_sweep_type sweep )const
+{
+   // Every index is ordered by the time its sweep processes it, so the first object of each is enough
+   fc::time_point_sec next = fc::time_point_sec::maximum();
+   const auto consider = [&next]( const fc::time_point_sec& t ) { next = std::min( next, t ); };
+
+   switch( sweep )
+   {
+      case expiration_sweep_type::transactions:
+      {
+         const auto& trx_idx = get_index_type<transaction_index>().indices().get<by_expiration>();
+         if( !trx_idx.empty() )
+         {
+            // transactions are removed after, not at, their expiration
+            const auto expiration = trx_idx.begin()->expiration;
+            consider( expiration < fc::time_point_sec::maximum() ? expiration + 1 : expiration );
+         }
+         break;
+      }
+      case expiration_sweep_type::proposals:
+      {
+         const auto& proposal_idx = get_index_type<proposal_index>().indices().get<by_expiration>();
+         if( !proposal_idx.empty() )
+            consider( proposal_idx.begin()->expiration_time );
+         break;
+      }
+      case expiration_sweep_type::limit_orders:
+      {
+         const auto& limit_idx = get_index_type<limit_order_index>().indices().get<by_expiration>();
+         if( !limit_idx.empty() )
+            consider( limit_idx.begin()->expiration );
+         break;
+      }
+      case expiration_sweep_type::force_settlements:
+      {
+         // The index is ordered by asset first, so the earliest order of every asset is looked at
+         const auto& settle_idx = get_index_type<force_settlement_index>().indices().get<by_expiration>();
+         for( auto itr = settle_idx.begin(); itr != settle_idx.end();
+              itr = settle_idx.upper_bound( itr->settlement_asset_id() ) )
+         {
+            if( itr->settlement_asset_id()( *this ).bitasset_data( *this ).has_settlement() )
+               consider( fc::time_point_sec::min() );
+            consider( itr->settlement_date );
+         }
+         break;
+      }
+      case expiration_sweep_type::htlcs:
+      {
+         const auto& htlc_idx = get_index_type<htlc_index>().indices().get<by_expiration>();
+         if( !htlc_idx.empty() )
+            consider( htlc_idx.begin()->conditions.time_lock.expiration );
+         break;
+      }
+      case expiration_sweep_type::feeds:
+      {
+         // Before the hard fork, update_expired_feeds may have work to do without any expired feed
+         if( head_block_time() < HARDFORK_615_TIME )
+            return fc::time_point_sec::min();
+
+         const auto& feed_idx = get_index_type<asset_bitasset_data_index>().indices().get<by_feed_expiration>();
+         if( !feed_idx.empty() )
+            consider( feed_idx.begin()->feed_expiration_time() );
+
+         const auto& cer_idx = get_index_type<asset_bitasset_data_index>().indices().get<by_cer_update>();
+         if( !cer_idx.empty() && cer_idx.rbegin()->need_to_update_cer() )
+            consider( fc::time_point_sec::min() );
+         break;
+      }
+      case expiration_sweep_type::withdraw_permissions:
+      {
+         const auto& permit_idx = get_index_type<withdraw_permission_index>().indices().get<by_expiration>();
+         if( !permit_idx.empty() )
+            consider( permit_idx.begin()->expiration );
+         break;
+      }
+      case expiration_sweep_type::credit_offers_and_deals:
+      {
+         const auto& offer_idx = get_index_type<credit_offer_index>().indices().get<by_auto_disable_time>();
+         auto offer_itr = offer_idx.lower_bound( true );
+         if( offer_itr != offer_idx.end() )
+            consider( offer_itr->auto_disable_time );
+
+         const auto& deal_idx = get_index_type<credit_deal_index>().indices().get<by_latest_repay_time>();
+         if( !deal_idx.empty() )
+            consider( deal_idx.begin()->latest_repay_time );
+         break;
+      }
+   }
+
+   return next;
+}
+
 } }
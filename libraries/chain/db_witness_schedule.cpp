@@ -79,6 +79,29 @@ uint32_t database::get_slot_at_time(fc::time_point_sec when)const
    return (when - first_slot_time).to_seconds() / block_interval() + 1;
 }
 
+vector<witness_schedule_slot> database::get_scheduled_slots( uint32_t count )const
+{
+   vector<witness_schedule_slot> result;
+   if( count == 0 )
+      return result;
+   result.reserve( count );
+
+   const auto interval = block_interval();
+   const fc::time_point_sec first_slot_time = get_slot_time( 1 );
+   const uint64_t current_aslot = get_dynamic_global_properties().current_aslot;
+   const auto& witnesses = get_witness_schedule_object().current_shuffled_witnesses;
+
+   for( uint32_t slot_num = 1; slot_num <= count; ++slot_num )
+   {
+      witness_schedule_slot slot;
+      slot.slot_num = slot_num;
+      slot.time = first_slot_time + ( slot_num - 1 ) * interval;
+      slot.witness = witnesses[ ( current_aslot + slot_num ) % witnesses.size() ];
+      result.push_back( slot );
+   }
+   return result;
+}
+
 uint32_t database::update_witness_missed_blocks( const signed_block& b )
 {
    uint32_t missed_blocks = get_slot_at_time( b.timestamp );
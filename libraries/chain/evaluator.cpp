@@ -53,11 +53,32 @@ database& generic_evaluator::db()const { return trx_state->db(); }
       const database& d = db();
       fee_from_account = fee;
       FC_ASSERT( fee.amount >= 0 );
-      fee_paying_account = &account_id(d);
-      fee_paying_account_statistics = &fee_paying_account->statistics(d);
+      // Accounts and assets are never removed, so the objects found for an earlier operation stay valid
+      if( trx_state->last_fee_paying_account != nullptr && trx_state->last_fee_paying_account->id == account_id )
+      {
+         fee_paying_account = trx_state->last_fee_paying_account;
+         fee_paying_account_statistics = trx_state->last_fee_paying_account_statistics;
+      }
+      else
+      {
+         fee_paying_account = &account_id(d);
+         fee_paying_account_statistics = &fee_paying_account->statistics(d);
+         trx_state->last_fee_paying_account = fee_paying_account;
+         trx_state->last_fee_paying_account_statistics = fee_paying_account_statistics;
+      }
 
-      fee_asset = &fee.asset_id(d);
-      fee_asset_dyn_data = &fee_asset->dynamic_asset_data_id(d);
+      if( trx_state->last_fee_asset != nullptr && trx_state->last_fee_asset->id == fee.asset_id )
+      {
+         fee_asset = trx_state->last_fee_asset;
+         fee_asset_dyn_data = trx_state->last_fee_asset_dyn_data;
+      }
+      else
+      {
+         fee_asset = &fee.asset_id(d);
+         fee_asset_dyn_data = &fee_asset->dynamic_asset_data_id(d);
+         trx_state->last_fee_asset = fee_asset;
+         trx_state->last_fee_asset_dyn_data = fee_asset_dyn_data;
+      }
 
       FC_ASSERT( is_authorized_asset( d, *fee_paying_account, *fee_asset ), 
             "Account ${acct} '${name}' attempted to pay fee by using asset ${a} '${sym}', "
@@ -24,6 +24,8 @@
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/exceptions.hpp>
 
+#include <fc/io/raw.hpp>
+
 namespace graphene { namespace chain {
 fork_database::fork_database()
 {
@@ -32,6 +34,7 @@ void fork_database::reset()
 {
    _head.reset();
    _index.clear();
+   _released_num = 0;
 }
 
 void fork_database::pop_block()
@@ -114,6 +117,39 @@ void fork_database::set_max_size( uint32_t s )
    }
 }
 
+void fork_database::release_bodies( const std::function< bool( const block_id_type& ) >& is_stored )
+{
+   if( _hot_window == 0 || !_head || _head->num <= _hot_window )
+      return;
+   const uint32_t last_num = _head->num - _hot_window;
+   auto& num_idx = _index.get<block_num>();
+   for( auto itr = num_idx.upper_bound( _released_num ); itr != num_idx.end() && (*itr)->num <= last_num; ++itr )
+   {
+      fork_item& item = **itr;
+      if( item.has_body && is_stored( item.id ) )
+      {
+         vector<processed_transaction>().swap( item.data.transactions );
+         item.has_body = false;
+      }
+   }
+   _released_num = std::max( _released_num, last_num );
+}
+
+fork_database_usage fork_database::memory_usage()const
+{
+   fork_database_usage result;
+   for( const auto& item : _index )
+   {
+      ++result.item_count;
+      if( item->has_body )
+         ++result.body_count;
+      result.bytes += sizeof( fork_item ) + fc::raw::pack_size( item->data );
+      if( item->scheduled_witnesses )
+         result.bytes += item->scheduled_witnesses->size() * sizeof( pair< witness_id_type, public_key_type > );
+   }
+   return result;
+}
+
 bool fork_database::is_known_block(const block_id_type& id)const
 {
    auto& index = _index.get<block_id>();
@@ -26,6 +26,11 @@
 #include <graphene/protocol/fee_schedule.hpp>
 
 #include <fc/io/raw.hpp>
+#include <fc/thread/parallel.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
 
 namespace graphene { namespace chain {
 
@@ -43,6 +48,77 @@ void genesis_state_type::override_witness_signing_keys( const std::string& new_k
    }
 }
 
+namespace {
+
+/// Converts the elements of @p vars into @p result, in chunks on several threads if there are many of them
+template<typename T>
+void from_variants_in_parallel( const fc::variants& vars, vector<T>& result, uint32_t max_depth )
+{
+   constexpr size_t min_chunk_size = 10000;
+   result.resize( vars.size() );
+   const size_t threads = std::max( 1u, std::thread::hardware_concurrency() );
+   const size_t chunk_size = std::max( min_chunk_size, ( vars.size() + threads - 1 ) / threads );
+   if( vars.size() <= chunk_size )
+   {
+      for( size_t i = 0; i < vars.size(); ++i )
+         fc::from_variant( vars[i], result[i], max_depth );
+      return;
+   }
+
+   std::vector<fc::future<void>> tasks;
+   for( size_t begin = 0; begin < vars.size(); begin += chunk_size )
+   {
+      const size_t end = std::min( begin + chunk_size, vars.size() );
+      tasks.push_back( fc::do_parallel( [&vars,&result,begin,end,max_depth] () {
+         for( size_t i = begin; i < end; ++i )
+            fc::from_variant( vars[i], result[i], max_depth );
+      } ) );
+   }
+   // all tasks must be done before the result goes out of scope, even if one of them failed
+   std::exception_ptr failure;
+   for( auto& task : tasks )
+   {
+      try {
+         task.wait();
+      } catch( ... ) {
+         if( !failure )
+            failure = std::current_exception();
+      }
+   }
+   if( failure )
+      std::rethrow_exception( failure );
+}
+
+} // anonymous namespace
+
+genesis_state_type genesis_state_type::from_variant_in_parallel( const fc::variant& var, uint32_t max_depth )
+{ try {
+   FC_ASSERT( max_depth > 2, "Recursion depth exceeded" );
+   const fc::variant_object& obj = var.get_object();
+
+   // Convert everything but the long lists as usual
+   static const std::vector<std::string> bulk_keys { "initial_accounts", "initial_balances",
+                                                     "initial_vesting_balances" };
+   fc::mutable_variant_object rest;
+   for( const auto& entry : obj )
+   {
+      if( std::find( bulk_keys.begin(), bulk_keys.end(), entry.key() ) == bulk_keys.end() )
+         rest( entry.key(), entry.value() );
+   }
+   genesis_state_type result = fc::variant( std::move( rest ) ).as<genesis_state_type>( max_depth );
+
+   // The elements are two levels below the genesis object
+   const uint32_t element_depth = max_depth - 2;
+   if( obj.contains( "initial_accounts" ) )
+      from_variants_in_parallel( obj["initial_accounts"].get_array(), result.initial_accounts, element_depth );
+   if( obj.contains( "initial_balances" ) )
+      from_variants_in_parallel( obj["initial_balances"].get_array(), result.initial_balances, element_depth );
+   if( obj.contains( "initial_vesting_balances" ) )
+      from_variants_in_parallel( obj["initial_vesting_balances"].get_array(), result.initial_vesting_balances,
+                                 element_depth );
+   return result;
+} FC_CAPTURE_AND_RETHROW() }
+
 } } // graphene::chain
 
 FC_REFLECT_DERIVED_NO_TYPENAME(graphene::chain::genesis_state_type::initial_account_type, BOOST_PP_SEQ_NIL,
@@ -121,31 +121,13 @@ namespace graphene {
          } FC_CAPTURE_AND_RETHROW( (o) )
       }
 
-      class htlc_redeem_visitor
-      {
-      //private:
-         const std::vector<char>& data;
-      public:
-         typedef bool result_type;
-
-         htlc_redeem_visitor( const std::vector<char>& preimage )
-            : data( preimage ) {}
-
-         template<typename T>
-         bool operator()( const T& preimage_hash )const
-         {
-            return T::hash( (const char*)data.data(), (uint32_t) data.size() ) == preimage_hash;
-         }
-      };
-
       void_result htlc_redeem_evaluator::do_evaluate(const htlc_redeem_operation& o)
       {
          auto& d = db();
          htlc_obj = &d.get<htlc_object>(o.htlc_id);
          detail::check_htlc_redeem_hf_bsip64(d.head_block_time(), o, htlc_obj);
 
-         const htlc_redeem_visitor vtor( o.preimage );
-         FC_ASSERT( htlc_obj->conditions.hash_lock.preimage_hash.visit( vtor ), 
+         FC_ASSERT( o.preimage_matches( htlc_obj->conditions.hash_lock.preimage_hash ),
                "Provided preimage does not generate correct hash.");
 
          return void_result();
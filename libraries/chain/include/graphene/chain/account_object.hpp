@@ -29,10 +29,17 @@
 
 #include <boost/multi_index/composite_key.hpp>
 
+#include <array>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
 namespace graphene { namespace chain {
    class database;
    class account_object;
    class vesting_balance_object;
+   class fee_payout_batch;
 
    /**
     * @class account_statistics_object
@@ -139,8 +146,11 @@ namespace graphene { namespace chain {
          /// Whether need to process this account during the maintenance interval
          inline bool need_maintenance() const { return has_some_core_voting() || has_pending_fees(); }
 
-         /// @brief Split up and pay out @ref pending_fees and @ref pending_vested_fees
-         void process_fees(const account_object& a, database& d) const;
+         /**
+          * @brief Split up and pay out @ref pending_fees and @ref pending_vested_fees
+          * @param batch if not null, the payouts which can wait are added to it instead of being paid out now
+          */
+         void process_fees(const account_object& a, database& d, fee_payout_batch* batch = nullptr) const;
 
          /**
           * Core fees are paid into the account_statistics_object by this method
@@ -325,6 +335,52 @@ namespace graphene { namespace chain {
          account_id_type get_id()const { return id; }
    };
 
+   /**
+    *  @brief A hashed map from public keys to the accounts which reference them
+    *
+    *  Keys are stored as their raw 33-byte compressed form.  Most keys are referenced by one account only, which is
+    *  kept inline in the entry, a set is only allocated when a second account references the key.
+    */
+   class account_key_references
+   {
+      public:
+         typedef fc::ecc::public_key_data key_data;
+
+         void insert( const public_key_type& key, account_id_type account );
+         void erase( const public_key_type& key, account_id_type account );
+
+         bool contains( const public_key_type& key )const { return _refs.find( key.key_data ) != _refs.end(); }
+         /// Add the accounts which reference the key to @p result
+         void get_accounts( const public_key_type& key, flat_set<account_id_type>& result )const;
+         /// Batched version of @ref get_accounts, adds the accounts referencing each key to the matching result
+         void get_accounts( const vector<public_key_type>& keys, vector< flat_set<account_id_type> >& results )const;
+
+         size_t size()const { return _refs.size(); }
+         size_t memory_usage()const;
+
+      private:
+         /// The compressed keys start with a parity byte followed by the x coordinate, which is uniformly distributed
+         struct key_hash
+         {
+            size_t operator()( const key_data& k )const noexcept
+            {
+               size_t result;
+               std::memcpy( &result, k.begin() + 1, sizeof(result) );
+               return result;
+            }
+         };
+
+         struct entry
+         {
+            /// The only referencing account, unused when @ref others is set
+            account_id_type                              single;
+            /// All referencing accounts, only allocated for keys which are referenced by several accounts
+            std::unique_ptr< flat_set<account_id_type> > others;
+         };
+
+         std::unordered_map< key_data, entry, key_hash > _refs;
+   };
+
    /**
     *  @brief This secondary index will allow a reverse lookup of all accounts that a particular key or account
     *  is an potential signing authority.
@@ -336,11 +392,13 @@ namespace graphene { namespace chain {
          virtual void object_removed( const object& obj ) override;
          virtual void about_to_modify( const object& before ) override;
          virtual void object_modified( const object& after  ) override;
-
+         /** only used by the API */
+         virtual bool is_deferrable()const override { return true; }
+         virtual size_t memory_usage()const override;
 
          /** given an account or key, map it to the set of accounts that reference it in an active or owner authority */
          map< account_id_type, set<account_id_type> >                    account_to_account_memberships;
-         map< public_key_type, set<account_id_type>, pubkey_comparator > account_to_key_memberships;
+         account_key_references                                          account_to_key_memberships;
          /** some accounts use address authorities in the genesis block */
          map< address, set<account_id_type> >                            account_to_address_memberships;
 
@@ -359,6 +417,9 @@ namespace graphene { namespace chain {
    /**
     *  @brief This secondary index will allow fast access to the balance objects
     *         that belonging to an account.
+    *
+    *  Every account has a CORE balance, these are kept in a vector indexed by the instance of the account. The
+    *  balances of other assets are kept in a sorted vector per account.
     */
    class balances_by_account_index : public secondary_index
    {
@@ -368,18 +429,168 @@ namespace graphene { namespace chain {
          virtual void about_to_modify( const object& before ) override;
          virtual void object_modified( const object& after  ) override;
 
-         const map< asset_id_type, const account_balance_object* >& get_account_balances( const account_id_type& acct )const;
+         typedef flat_map< asset_id_type, const account_balance_object* > balance_map;
+
+         /** @return all balances of the account sorted by asset, this is a copy */
+         balance_map get_account_balances( const account_id_type& acct )const;
          const account_balance_object* get_account_balance( const account_id_type& acct, const asset_id_type& asset )const;
 
-      private:
-         static const uint8_t  bits;
-         static const uint64_t mask;
+         virtual size_t memory_usage()const override;
 
-         /** Maps each account to its balance objects */
-         vector< vector< map< asset_id_type, const account_balance_object* > > > balances;
+      private:
+         /** The CORE balance of each account, by the instance of the account */
+         vector< const account_balance_object* > core_balances;
+         /** The balances of other assets of each account, by the instance of the account */
+         vector< balance_map > other_balances;
          std::stack< object_id_type > ids_being_modified;
    };
 
+   /**
+    *  @brief What the stake of one account adds to the vote tally of a maintenance interval
+    */
+   struct vote_tally_contribution
+   {
+      /// The offsets in the vote tally buffer and the stake added to each of them
+      vector< std::pair<uint32_t, uint64_t> > votes;
+      /// The offsets in the witness and committee count histograms and the stake added to them
+      ///@{
+      uint16_t witness_count_offset = 0;
+      uint64_t witness_count_stake = 0;
+      uint16_t committee_count_offset = 0;
+      uint64_t committee_count_stake = 0;
+      ///@}
+      std::array<uint64_t,2> total_voting_stake {}; ///< 0=committee, 1=witness, as in vote_id_type::vote_type
+
+      /// The statistics of the opinion account to add the voting power to, null if the account does not vote
+      const account_statistics_object* opinion_account_stats = nullptr;
+      /// The voting power added to the statistics of the opinion account, see @ref account_statistics_object
+      ///@{
+      uint64_t vp_all = 0;
+      uint64_t vp_active = 0;
+      uint64_t vp_committee = 0;
+      uint64_t vp_witness = 0;
+      uint64_t vp_worker = 0;
+      ///@}
+
+      void clear();
+   };
+
+   /**
+    *  @brief The sums of a vote tally: of all voting accounts or of a part of them
+    */
+   struct vote_tally_buffer
+   {
+      vector<uint64_t>       votes;
+      vector<uint64_t>       witness_counts;
+      vector<uint64_t>       committee_counts;
+      std::array<uint64_t,2> total_voting_stake {}; ///< 0=committee, 1=witness, as in vote_id_type::vote_type
+
+      void add( const vote_tally_buffer& other );
+      void add( const vote_tally_contribution& c );
+      void subtract( const vote_tally_contribution& c );
+   };
+
+   /**
+    *  @brief Keeps the vote tally contributions of all voting accounts between maintenance intervals
+    *
+    *  With incremental vote tallying the contribution of an account is only computed again when the account, its
+    *  opinion account or the stake or vote times in their statistics have changed, or when vote decay or the end
+    *  of a membership changes the result, see @ref database::enable_incremental_vote_tally.
+    *
+    *  This index only records which accounts have changed, the tally itself is done in the maintenance.
+    */
+   class vote_tally_cache : public secondary_index
+   {
+      public:
+         /// A vote tally contribution and what it was computed from
+         struct entry : vote_tally_contribution
+         {
+            account_id_type opinion_account;
+            uint64_t        computed_at = 0;  ///< the change sequence when computed, 0 if never
+            time_point_sec  valid_until;      ///< the first maintenance time when the result may change
+            uint32_t        vote_buffer_size = 0; ///< the vote tally buffer size if some votes did not fit, else 0
+            uint64_t        tally_epoch = 0;  ///< the last tally which found this account voting
+
+            /// The stake and vote times read from the statistics
+            ///@{
+            share_type      total_core_in_orders;
+            share_type      core_in_balance;
+            share_type      total_core_pol;
+            share_type      total_pol_value;
+            share_type      total_core_pob;
+            share_type      total_pob_value;
+            share_type      total_core_inactive;
+            time_point_sec  last_vote_time;
+            time_point_sec  opinion_last_vote_time;
+            ///@}
+         };
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after ) override;
+
+         /// @return the change sequence of the last change of the account, 0 if none is recorded
+         uint64_t last_change( account_id_type account )const;
+         /// @return the sequence number of the latest change
+         uint64_t change_sequence()const { return _change_sequence; }
+         /// Forgets the changes up to the given sequence, which must have been accounted for in all entries
+         void forget_changes( uint64_t up_to );
+
+         /// Drops the tally, for example if the parameters it was computed with have changed
+         void reset();
+
+         virtual size_t memory_usage()const override;
+
+         /// The contributions by stake account instance
+         std::unordered_map< uint64_t, entry > entries;
+         /// The sums of all @ref entries
+         vote_tally_buffer totals;
+         /// Whether @ref totals is valid, and the parameters it was computed with
+         ///@{
+         bool     initialized = false;
+         uint64_t tally_epoch = 0;
+         uint16_t maximum_witness_count = 0;
+         uint16_t maximum_committee_count = 0;
+         bool     count_non_member_votes = false;
+         bool     pob_activated = false;
+         ///@}
+
+      private:
+         std::unordered_map< uint64_t, uint64_t > _last_changes;
+         uint64_t                                 _change_sequence = 0;
+   };
+
+   /**
+    *  @brief Collects the fee payouts of a maintenance interval to apply them together
+    *
+    *  The network cuts only change the dynamic data of the core asset, cashback to an existing vesting balance
+    *  only changes that balance, so they are summed up and applied with one modification per object by
+    *  @ref apply. Cashback which needs a new vesting balance, or which goes to the reserve, is paid out
+    *  immediately, so the balances are created in the same order as without the batch.
+    *
+    *  Nothing may read the balances in between, see @ref account_statistics_object::process_fees.
+    */
+   class fee_payout_batch
+   {
+      public:
+         /// Adds a network cut of the fees
+         void add_network_fees( share_type amount ) { _network_fees += amount; }
+         /// Pays out cashback to an account, now or with @ref apply
+         void deposit_cashback( database& d, const account_object& acct, share_type amount, bool require_vesting );
+         /// Applies and clears the collected payouts
+         void apply( database& d );
+
+      private:
+         struct cashback_deposit
+         {
+            share_type vesting;
+            share_type vested;
+         };
+
+         share_type                                           _network_fees;
+         std::map< vesting_balance_id_type, cashback_deposit > _deposits;
+   };
+
    struct by_asset_balance;
    struct by_maintenance_flag;
    /**
@@ -410,7 +621,7 @@ namespace graphene { namespace chain {
    /**
     * @ingroup object_index
     */
-   typedef generic_index<account_balance_object, account_balance_object_multi_index_type> account_balance_index;
+   typedef generic_index<account_balance_object, account_balance_object_multi_index_type, true> account_balance_index;
 
    struct by_name;
 
@@ -428,7 +639,7 @@ namespace graphene { namespace chain {
    /**
     * @ingroup object_index
     */
-   typedef generic_index<account_object, account_multi_index_type> account_index;
+   typedef generic_index<account_object, account_multi_index_type, true> account_index;
 
    struct by_maintenance_seq;
    struct by_voting_power_active;
@@ -464,7 +675,7 @@ namespace graphene { namespace chain {
    /**
     * @ingroup object_index
     */
-   typedef generic_index<account_statistics_object, account_stats_multi_index_type> account_stats_index;
+   typedef generic_index<account_statistics_object, account_stats_multi_index_type, true> account_stats_index;
 
 }}
 
@@ -472,6 +683,13 @@ MAP_OBJECT_ID_TO_TYPE(graphene::chain::account_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::account_balance_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::account_statistics_object)
 
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::account_object,
+                            graphene::db::primary_index< graphene::chain::account_index, 20 >)
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::account_balance_object,
+                            graphene::db::primary_index< graphene::chain::account_balance_index >)
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::account_statistics_object,
+                            graphene::db::primary_index< graphene::chain::account_stats_index, 20 >)
+
 FC_REFLECT_TYPENAME( graphene::chain::account_object )
 FC_REFLECT_TYPENAME( graphene::chain::account_balance_object )
 FC_REFLECT_TYPENAME( graphene::chain::account_statistics_object )
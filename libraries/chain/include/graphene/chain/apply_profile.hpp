@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/types.hpp>
+
+namespace graphene { namespace chain {
+
+   /// Time spent evaluating operations of one type, see @ref apply_profile
+   struct operation_apply_profile
+   {
+      uint64_t count        = 0;
+      /// wall clock time, including the operations a proposal executes
+      uint64_t microseconds = 0;
+   };
+
+   /**
+    * Wall clock time spent in the parts of block application, summed up over all blocks applied while the profile
+    * is set with @ref database::set_apply_profile. The caller can add the parts which happen outside of
+    * apply_block, such as signature precomputation.
+    */
+   struct apply_profile
+   {
+      uint64_t                        blocks                       = 0;
+      uint64_t                        transactions                 = 0;
+      /// time spent applying the transactions of the blocks, including the evaluation of their operations
+      uint64_t                        transaction_microseconds     = 0;
+      uint64_t                        maintenance_microseconds     = 0;
+      /// time spent in the handlers of the applied_block, changed_objects and block_notifications_finished signals
+      uint64_t                        signal_handler_microseconds  = 0;
+      uint64_t                        signature_microseconds       = 0;
+      uint64_t                        undo_microseconds            = 0;
+      /// indexed by the tag of the operation
+      vector<operation_apply_profile> operations;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::operation_apply_profile, (count)(microseconds) )
+FC_REFLECT( graphene::chain::apply_profile, (blocks)(transactions)(transaction_microseconds)
+            (maintenance_microseconds)(signal_handler_microseconds)(signature_microseconds)(undo_microseconds)
+            (operations) )
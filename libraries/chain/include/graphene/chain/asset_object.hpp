@@ -24,6 +24,7 @@
 #pragma once
 #include <graphene/chain/types.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/simple_index.hpp>
 #include <graphene/protocol/asset_ops.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
@@ -40,6 +41,7 @@
 
 namespace graphene { namespace chain {
    class asset_bitasset_data_object;
+   class database;
 
    /**
     *  @brief tracks the asset information that changes frequently
@@ -467,12 +469,53 @@ namespace graphene { namespace chain {
    >;
    using asset_index = generic_index< asset_object, asset_object_multi_index_type >;
 
+   /// An asset together with its dynamic data and its bitasset data, see @ref database::get_resolved_asset
+   struct resolved_asset
+   {
+      const asset_object*               asset = nullptr;
+      const asset_dynamic_data_object*  dynamic_data = nullptr;
+      /// null if the asset is not market issued
+      const asset_bitasset_data_object* bitasset_data = nullptr;
+   };
+
+   /**
+    *  @brief This secondary index keeps the dynamic data and bitasset data objects of each asset resolved
+    *
+    *  The entries are kept in a vector indexed by the instance of the asset, and are refreshed whenever the asset
+    *  is inserted or modified, thus also when undoing changes.
+    */
+   class resolved_asset_index : public secondary_index
+   {
+      public:
+         explicit resolved_asset_index( const database* db ) : _db( *db ) {}
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /// @return the resolved asset, or null if the asset or one of its data objects was not found
+         const resolved_asset* find( asset_id_type id )const;
+
+         virtual size_t memory_usage()const override { return _assets.capacity() * sizeof(resolved_asset); }
+
+      private:
+         const database&          _db;
+         vector< resolved_asset > _assets;
+   };
+
 } } // graphene::chain
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::asset_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::asset_dynamic_data_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::asset_bitasset_data_object)
 
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::asset_object,
+                            graphene::db::primary_index< graphene::chain::asset_index, 13 >)
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::asset_dynamic_data_object,
+      graphene::db::primary_index< graphene::db::simple_index< graphene::chain::asset_dynamic_data_object > >)
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::asset_bitasset_data_object,
+                            graphene::db::primary_index< graphene::chain::asset_bitasset_data_index, 13 >)
+
 FC_REFLECT_DERIVED( graphene::chain::price_feed_with_icr, (graphene::protocol::price_feed),
                     (initial_collateral_ratio) )
 
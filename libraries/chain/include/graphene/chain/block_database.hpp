@@ -22,38 +22,159 @@
  * THE SOFTWARE.
  */
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <graphene/chain/segmented_block_log.hpp>
 #include <graphene/protocol/block.hpp>
 
 #include <fc/filesystem.hpp>
 
 namespace graphene { namespace chain {
    struct index_entry;
+   class mapped_file_view;
    using namespace graphene::protocol;
 
+   /**
+    * Blocks are appended to the "blocks" file, the "index" file holds one fixed-size entry per block number.
+    * Alternatively, blocks are kept in a @ref segmented_block_log.
+    *
+    * All modifications must be done by a single thread. Lookups can be done concurrently from any thread while
+    * blocks are being stored, they read both files through read-only memory mappings without taking locks.
+    *
+    * Optionally, blocks are written behind by a background thread, see @ref set_write_queue_size. Queued blocks
+    * can be looked up like stored ones.
+    */
    class block_database 
    {
       public:
-         void open( const fc::path& dbdir );
+         block_database();
+         ~block_database();
+
+         /**
+          * Opens the block database in dbdir, which keeps the format it has been created with. If there is no
+          * block database in dbdir yet, a segmented one is created if new_format.blocks_per_segment is not 0.
+          */
+         void open( const fc::path& dbdir,
+                    const segmented_block_log::settings& new_format = segmented_block_log::settings() );
          bool is_open()const;
+         /** Waits until all queued blocks are written, then flushes the files */
          void flush();
          void close();
 
+         /**
+          * Sets the number of blocks which may be queued for the background writer, 0 writes blocks synchronously.
+          * When the queue is full, @ref store waits for the writer. An error of the writer is rethrown by the next
+          * modification or @ref flush.
+          */
+         void set_write_queue_size( uint32_t blocks );
+         /**
+          * Asks the background writer to flush the files once the blocks up to block_num are written, without
+          * waiting for it. Does nothing if blocks are written synchronously, they are flushed as they are stored.
+          */
+         void request_flush( uint32_t block_num );
+
          void store( const block_id_type& id, const signed_block& b );
+         /** Waits until all queued blocks are written, then removes the block */
          void remove( const block_id_type& id );
 
          bool                   contains( const block_id_type& id )const;
          block_id_type          fetch_block_id( uint32_t block_num )const;
          optional<signed_block> fetch_optional( const block_id_type& id )const;
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
+         /**
+          * Unpacks the block into @p result, reusing the containers of its old contents, which saves most allocations
+          * when many blocks are read into the same object. @return false if the block does not exist
+          */
+         bool                   fetch_by_number( uint32_t block_num, signed_block& result )const;
+         /** @return the serialized block, copied from the file without unpacking it */
+         optional<vector<char>> fetch_packed_by_number( uint32_t block_num )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
+         /** @return the position after the most recently read block in the blocks file, used for progress reports */
          size_t                 blocks_current_position()const;
          size_t                 total_block_size()const;
+
+         /** @return true if the blocks are kept in a @ref segmented_block_log, which allows pruning */
+         bool                   is_segmented()const { return _segmented != nullptr; }
+         /**
+          * Removes old blocks from a segmented block database, see @ref segmented_block_log::prune. With a background
+          * writer, the blocks are removed by the writer after the blocks queued before.
+          */
+         void                   prune( uint32_t first_kept_block );
+         /** @return the lowest block number which has not been pruned */
+         uint32_t               first_block_num()const;
       private:
          optional<index_entry> last_index_entry()const;
+         /** @return false if there is no entry for block_num */
+         bool read_index_entry( uint32_t block_num, index_entry& e )const;
+         void write_index_entry( uint32_t block_num, const index_entry& e );
+         /** Unpacks the block e refers to into @p result, throws if the data does not match the entry */
+         void read_block( const index_entry& e, signed_block& result )const;
+         /** @return the serialized block e refers to */
+         vector<char> read_packed_block( const index_entry& e )const;
+
+         /// The synchronous versions of @ref store, @ref flush and @ref prune
+         /// @{
+         void write_block( const block_id_type& id, const signed_block& b );
+         void flush_files();
+         void prune_blocks( uint32_t first_kept_block );
+         /// @}
+
+         struct queued_block
+         {
+            block_id_type                        id;
+            std::shared_ptr<const signed_block>  block;
+         };
+         /** @return the queued block with the given number, if any */
+         optional<queued_block> find_queued( uint32_t block_num )const;
+         /** The loop of the background writer */
+         void write_queued_blocks();
+         /** Waits until the background writer is idle and its queue is empty, rethrows its error if any */
+         void wait_for_writer( std::unique_lock<std::mutex>& lock );
+         /** Starts the background writer if it is not running, must be called with _write_mutex locked */
+         void start_writer();
+         /** Lets the background writer finish the queue and waits for it to exit */
+         void stop_writer();
+
          fc::path _index_filename;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+
+         std::unique_ptr<mapped_file_view> _blocks_view;
+         std::unique_ptr<mapped_file_view> _index_view;
+         /// Incremented before and after an index entry is overwritten, so that readers can detect torn reads
+         std::atomic<uint64_t>             _index_writes { 0 };
+         mutable std::atomic<uint64_t>     _last_read_end { 0 };
+
+         /// if set, all blocks are stored in this log instead of the files above
+         std::unique_ptr<segmented_block_log> _segmented;
+
+         /// The background writer, all members below are protected by _write_mutex
+         /// @{
+         uint32_t                                _write_queue_size = 0;
+         std::thread                             _writer;
+         mutable std::mutex                      _write_mutex;
+         /// Notifies the writer about new work
+         std::condition_variable                 _write_ready;
+         /// Notifies waiting modifications about progress of the writer
+         std::condition_variable                 _write_done;
+         /// The blocks which are not written yet by block number, a later block replaces an earlier one
+         std::map< uint32_t, queued_block >      _queued;
+         /// Mirrors _queued.size() so that lookups can skip the mutex when nothing is queued
+         std::atomic<size_t>                     _queued_count { 0 };
+         bool                                    _writer_busy = false;
+         bool                                    _stop_writer = false;
+         /// The last block to write before flushing, 0 if no flush is requested
+         uint32_t                                _flush_up_to = 0;
+         /// The first block to keep after pruning, 0 if no pruning is requested
+         uint32_t                                _prune_first_kept = 0;
+         std::exception_ptr                      _write_error;
+         /// @}
    };
 } }
@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <graphene/chain/types.hpp>
+#include <graphene/db/index.hpp>
 #include <graphene/db/object.hpp>
 
 namespace graphene { namespace chain {
@@ -46,6 +47,32 @@ namespace graphene { namespace chain {
          block_id_type      block_id;
    };
 
+   /**
+    *  @brief Keeps the TaPoS reference prefixes of the block summaries in a flat array
+    *
+    *  The prefix of the block summary with instance N is at offset N, so checking the TaPoS reference of a
+    *  transaction is a single array access. Since the array is updated through the index notifications, it
+    *  also follows the block summaries when blocks are popped or the database is loaded from disk.
+    */
+   class tapos_prefix_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** @return the prefix of the block summary whose instance is @p ref_block_num */
+         uint32_t get_prefix( uint16_t ref_block_num )const
+         {
+            return ref_block_num < _prefixes.size() ? _prefixes[ref_block_num] : 0;
+         }
+
+         virtual size_t memory_usage()const override { return _prefixes.capacity() * sizeof(uint32_t); }
+
+      private:
+         vector< uint32_t > _prefixes;
+   };
+
 } }
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::block_summary_object)
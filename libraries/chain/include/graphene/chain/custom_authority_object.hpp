@@ -29,6 +29,8 @@
 #include <graphene/chain/types.hpp>
 #include <boost/multi_index/composite_key.hpp>
 
+#include <memory>
+
 namespace graphene { namespace chain {
 
    /**
@@ -37,9 +39,9 @@ namespace graphene { namespace chain {
     *
     */
    class custom_authority_object : public abstract_object<custom_authority_object> {
-      /// Unreflected field to store a cache of the predicate function
+      /// Unreflected field to store a cache of the predicate function, shared by the copies of the object
       /// Note that this cache can be modified when the object is const!
-      mutable optional<restriction_predicate_function> predicate_cache;
+      mutable std::shared_ptr<const restriction_predicate_function> predicate_cache;
 
    public:
       static constexpr uint8_t space_id = protocol_ids;
@@ -65,15 +67,18 @@ namespace graphene { namespace chain {
          return rs;
       }
       /// Get predicate, from cache if possible, and update cache if not (modifies const object!)
-      restriction_predicate_function get_predicate() const {
-         if (!predicate_cache.valid())
+      /// The cache is filled when the object is created or updated, and when the database is opened, so that it
+      /// is not modified during the concurrent evaluations of API threads.
+      const restriction_predicate_function& get_predicate() const {
+         if (!predicate_cache)
             update_predicate_cache();
 
          return *predicate_cache;
       }
       /// Regenerate predicate function and update predicate cache
       void update_predicate_cache() const {
-         predicate_cache = get_restriction_predicate(get_restrictions(), operation_type);
+         predicate_cache = std::make_shared<const restriction_predicate_function>(
+                                 get_restriction_predicate(get_restrictions(), operation_type));
       }
       /// Clear the cache of the predicate function
       void clear_predicate_cache() { predicate_cache.reset(); }
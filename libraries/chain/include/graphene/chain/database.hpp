@@ -33,6 +33,11 @@
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/expiration_sweep.hpp>
+#include <graphene/chain/hardfork_visitor.hpp>
+#include <graphene/chain/apply_profile.hpp>
+#include <graphene/chain/head_state.hpp>
+#include <graphene/chain/maintenance_profile.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -41,28 +46,64 @@
 
 #include <fc/log/logger.hpp>
 
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 
+namespace fc { class thread; }
 namespace graphene { namespace protocol { struct predicate_result; } }
 
 namespace graphene { namespace chain {
    using graphene::db::abstract_object;
    using graphene::db::object;
-   class op_evaluator;
    class transaction_evaluation_state;
+   class vote_tally_cache;
+   class tapos_prefix_index;
+   template<typename T>
+   operation_result evaluate_operation( transaction_evaluation_state& eval_state, const operation& op, bool apply );
    class proposal_object;
    class operation_history_object;
    class chain_property_object;
    class witness_schedule_object;
+   struct witness_schedule_slot;
    class witness_object;
    class force_settlement_object;
    class limit_order_object;
    class collateral_bid_object;
    class call_order_object;
+   class custom_authority_object;
+   class liquidity_pool_object;
+   struct liquidity_pool_exchange_quote;
 
    struct budget_record;
    enum class vesting_balance_type;
 
+   /// Time spent in the steps of the last @ref database::generate_block call
+   struct block_generation_timings
+   {
+      /// selecting and applying the pending transactions, zero if a prepared candidate was used
+      fc::microseconds   select_transactions;
+      fc::microseconds   merkle_root;
+      fc::microseconds   sign;
+      /// applying the new block
+      fc::microseconds   push_block;
+      bool               candidate_used = false;
+   };
+
+   /// A change of an object by a block which has been applied by another node, see
+   /// @ref database::apply_replicated_block
+   struct replicated_object_change
+   {
+      object_id_type     id;
+      /// the object after the change serialized with fc::raw, empty if the object has been removed
+      vector<char>       data;
+   };
+
    /**
     *   @class database
     *   @brief tracks the blockchain state in an extensible manner
@@ -125,6 +166,32 @@ namespace graphene { namespace chain {
          void wipe(const fc::path& data_dir, bool include_blocks);
          void close(bool rewind = true);
 
+         /**
+          * @brief Write the current state to a file which can be loaded instead of replaying the blockchain
+          * @param file the path of the snapshot, it is replaced atomically
+          *
+          * The snapshot holds all objects and the blocks from the last irreversible block up to the head block.
+          * A new node which loads it (see @ref set_state_snapshot) can not undo the head block.
+          */
+         void save_state_snapshot( const fc::path& file )const;
+
+         /**
+          * @brief Fill an empty block database with the blocks of a block log, so that @ref open replays them
+          * @param data_dir the path to store the database, as passed to @ref open
+          * @param in serialized blocks starting at block 1, such as the "blocks" file of a block database. Like in
+          *           that file, a later block replaces an earlier one with the same number.
+          * @return the number of the last imported block
+          *
+          * Must be called before @ref open, the object database is wiped. The ids and merkle roots of the blocks
+          * are verified on worker threads, their links and the checkpoints in order. The blocks are applied by
+          * @ref open, starting from the genesis state or from the snapshot set with @ref set_state_snapshot.
+          */
+         uint32_t import_blocks( const fc::path& data_dir, std::istream& in );
+      private:
+         /// Replace the objects and the head of the fork database with the state of a snapshot, see @ref open
+         void load_state_snapshot( const fc::path& file );
+      public:
+
          //////////////////// db_witness_schedule.cpp ////////////////////
 
          /**
@@ -163,6 +230,12 @@ namespace graphene { namespace chain {
           */
          uint32_t get_slot_at_time(fc::time_point_sec when)const;
 
+         /**
+          * Get the next count slots with their times and scheduled witnesses, i.e. the results of
+          * get_slot_time() and get_scheduled_witness() for slot_num 1 to count, computed in one pass.
+          */
+         vector<witness_schedule_slot> get_scheduled_slots( uint32_t count )const;
+
          /**
           *  Calculate the percent of block production slots that were missed in the
           *  past 128 blocks, not including the current block.
@@ -179,6 +252,8 @@ namespace graphene { namespace chain {
          const chain_id_type&                   get_chain_id()const;
          const asset_object&                    get_core_asset()const;
          const asset_dynamic_data_object&       get_core_dynamic_data()const;
+         /// @return the asset with the given ID together with its dynamic data and bitasset data
+         resolved_asset                         get_resolved_asset( asset_id_type id )const;
          const chain_property_object&           get_chain_properties()const;
          const global_property_object&          get_global_properties()const;
          const dynamic_global_property_object&  get_dynamic_global_properties()const;
@@ -208,6 +283,9 @@ namespace graphene { namespace chain {
                  account_id_type account, const operation& op,
                  rejected_predicate_map* rejected_authorities = nullptr )const;
 
+         /// @return the states of the hard forks checked by the market engine at the head block
+         const market_hardfork_era& get_market_hardfork_era()const;
+
          uint32_t last_non_undoable_block_num() const;
 
          /// Find the limit order which is the individual settlement fund of the specified asset
@@ -235,7 +313,7 @@ namespace graphene { namespace chain {
          void register_evaluator()
          {
             _operation_evaluators[operation::tag<typename EvaluatorType::operation_type>::value]
-                  = std::make_unique<op_evaluator_impl<EvaluatorType>>();
+                  = &evaluate_operation<EvaluatorType>;
          }
          ///@}
 
@@ -256,6 +334,9 @@ namespace graphene { namespace chain {
           * @brief Adjust a particular account's balance in a given asset by a delta
           * @param account ID of account whose balance should be adjusted
           * @param delta Asset ID and amount to adjust balance by
+          *
+          * While an operation is applied, changes of existing balance objects are summed up per account and asset
+          * and written once when the operation ends, see @ref apply_operation. @ref get_balance includes them.
           */
          void adjust_balance(account_id_type account, asset delta);
 
@@ -412,6 +493,13 @@ namespace graphene { namespace chain {
          };
 
       private:
+         /// Does the work of @ref check_call_orders, which skips it when nothing it depends on has changed
+         bool check_call_orders_impl( const asset_object& mia, bool enable_black_swan, bool for_new_limit_order,
+                                      const asset_bitasset_data_object* bitasset_ptr,
+                                      bool mute_exceptions, bool skip_matching_settle_orders );
+         /// @return the sum of the change counts of the indexes which @ref check_call_orders depends on
+         uint64_t call_check_change_count()const;
+
          match_result_type match( const limit_order_object& taker, const limit_order_object& maker,
                                   const price& trade_price );
          match_result_type match_limit_normal_limit( const limit_order_object& taker, const limit_order_object& maker,
@@ -531,6 +619,17 @@ namespace graphene { namespace chain {
          asset pay_market_fees(const account_object* seller, const asset_object& recv_asset, const asset& receives,
                                const bool& is_maker, const optional<asset>& calculated_market_fees = {});
          asset pay_force_settle_fees(const asset_object& collecting_asset, const asset& collat_receives);
+         /**
+          * @brief Calculate what selling an amount to a liquidity pool pays and receives, without changing anything
+          * @param pool the liquidity pool
+          * @param amount_to_sell the amount to sell, in asset A or B of the pool
+          * @param pool_receives_asset the asset of @p amount_to_sell (passed in to avoid a lookup)
+          * @param pool_pays_asset the other asset of the pool (passed in to avoid a lookup)
+          */
+         liquidity_pool_exchange_quote quote_liquidity_pool_exchange( const liquidity_pool_object& pool,
+                                                                      const asset& amount_to_sell,
+                                                                      const asset_object& pool_receives_asset,
+                                                                      const asset_object& pool_pays_asset )const;
          /// @}
          ///@}
 
@@ -545,6 +644,16 @@ namespace graphene { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
+         /// @return the serialized block of the main chain as it is stored in the block database, without unpacking it
+         optional<vector<char>>     fetch_packed_block_by_number( uint32_t num )const;
+         /**
+          * @return the serialized block, like @ref fetch_block_by_id. Blocks of the block database are copied as they
+          * are stored, without unpacking them.
+          */
+         optional<vector<char>>     fetch_packed_block_by_id( const block_id_type& id )const;
+         /// @return the lowest block number which has not been pruned from the block database
+         uint32_t                   first_available_block_num()const;
+         /// @return an unexpired transaction, throws if it is not known or recent transactions are not stored
          const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
@@ -552,13 +661,51 @@ namespace graphene { namespace chain {
          const flat_map<uint32_t,block_id_type> get_checkpoints()const { return _checkpoints; }
          bool before_last_checkpoint()const;
 
+         /**
+          * Trust the block with the given id and its ancestors: blocks up to its number are applied without the
+          * stateless checks in @ref assume_valid_skip_flags, and only this block is accepted at its number.
+          * Their state is still built by applying them. An empty id disables this.
+          */
+         void                       set_assume_valid_block( const block_id_type& id ) { _assume_valid_block = id; }
+         const block_id_type&       get_assume_valid_block()const { return _assume_valid_block; }
+         /// The checks which are skipped for the blocks up to the assume-valid block
+         static constexpr uint32_t  assume_valid_skip_flags = skip_witness_signature | skip_transaction_signatures
+                                                              | skip_block_size_check | skip_tapos_check
+                                                              | skip_merkle_check;
+
+         /**
+          * Limit the number of pending transactions, 0 means no limit. When the pool is full, a new transaction is
+          * only accepted if its priority exceeds the lowest pending one, and a batch of the pending transactions with
+          * a lower priority is evicted. The priority is the fee per byte in CORE, divided by the number of pending
+          * transactions of the fee payer. Otherwise @ref push_transaction throws @ref pending_transaction_pool_full.
+          */
+         void     set_pending_transaction_limit( uint32_t limit ) { _max_pending_transactions = limit; }
+         uint32_t get_pending_transaction_limit()const { return _max_pending_transactions; }
+
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const precomputable_transaction& trx, uint32_t skip = skip_nothing );
       private:
+         /// @return the fees of the transaction in CORE per packed byte and the fee payer of its first operation,
+         ///         fees in other assets are converted with their core exchange rates
+         std::pair<double, account_id_type> get_transaction_fee_rate( const transaction& trx )const;
+         /// Pushes a transaction while the pool is at its limit, see @ref set_pending_transaction_limit
+         processed_transaction _push_transaction_into_full_pool( const precomputable_transaction& trx );
          bool _push_block( const signed_block& b );
+         /// @return skip, extended by @ref assume_valid_skip_flags if block_num is covered by the assume-valid block
+         uint32_t add_assume_valid_skip_flags( uint32_t block_num, uint32_t skip )const;
+         /// Removes old blocks from the block database if pruning is enabled
+         void prune_block_log();
+         /// @return the complete block of item, its transactions are read from the block database if necessary
+         const signed_block& fork_block_body( fork_item& item )const;
       public:
          // It is public because it is used in pending_transactions_restorer in db_with.hpp
          processed_transaction _push_transaction( const precomputable_transaction& trx );
+         /// @return the sum of the change counts of the objects the authority checks of transfers depend on,
+         ///         it is public because it is used in pending_transactions_restorer in db_with.hpp
+         uint64_t transfer_authority_change_count()const;
+         /// @return whether the transaction only transfers from accounts without custom authorities,
+         ///         it is public because it is used in pending_transactions_restorer in db_with.hpp
+         bool is_plain_transfer_transaction( const transaction& trx )const;
          ///@throws fc::exception if the proposed transaction fails to apply.
          processed_transaction push_proposal( const proposal_object& proposal );
 
@@ -568,17 +715,63 @@ namespace graphene { namespace chain {
             const fc::ecc::private_key& block_signing_private_key,
             uint32_t skip
             );
+         /**
+          *  Applies the pending transactions on top of the head block in advance and keeps those which fit into
+          *  the next block of @p witness_id, so @ref generate_block only has to sign them if the head block and
+          *  the pending transactions are unchanged by then. The pending transactions are reordered like after
+          *  the next block, the ones which do not fit follow the others.
+          *
+          *  @param skip the skip flags which will be passed to @ref generate_block
+          *  @return true if the candidate has been rebuilt, false if the existing one is still current
+          */
+         bool prepare_block_candidate( witness_id_type witness_id, uint32_t skip );
+
+         /// @return the time spent in the steps of the last successful @ref generate_block call
+         const block_generation_timings& get_last_block_generation_timings()const
+         { return _last_block_generation_timings; }
+
       private:
          signed_block _generate_block(
             const fc::time_point_sec when,
             witness_id_type witness_id,
             const fc::ecc::private_key& block_signing_private_key
             );
+         /**
+          *  Applies @p transactions in a new pending session and returns the ones which fit into a block of
+          *  @p witness_id, with their results cleared. Transactions which fail are left out.
+          *
+          *  @param applied receives the included transactions with their results if not null
+          *  @param postponed receives the transactions which do not fit into the block if not null
+          *  @param merkle receives the merkle digests of the included transactions
+          */
+         vector<processed_transaction> _select_block_transactions(
+            witness_id_type witness_id,
+            const vector<processed_transaction>& transactions,
+            vector<processed_transaction>* applied,
+            vector<processed_transaction>* postponed,
+            merkle_accumulator& merkle );
+         bool is_block_candidate_current( witness_id_type witness_id, uint32_t skip )const;
 
       public:
          void pop_block();
          void clear_pending();
 
+         /**
+          *  Locks the state of the database for reading from a thread which does not modify it, e.g. to serve
+          *  API calls concurrently with block processing. The calls which modify the database, i.e. push_block,
+          *  push_transaction, generate_block, pop_block, clear_pending and validate_transaction, wait until
+          *  all readers are done, and new readers wait while one of them is pending.
+          *
+          *  Must not be called by the thread which modifies the database, it would deadlock.
+          */
+         boost::shared_lock<boost::shared_mutex> lock_state_for_reading()const;
+
+         /**
+          *  Runs @p f with the state of the database locked like the calls which modify it, for plugins which
+          *  update their secondary indexes outside of block processing. Must be called by the modifying thread.
+          */
+         void with_state_write_lock( const std::function<void()>& f );
+
          /**
           *  This method is used to track appied operations during the evaluation of a block, these
           *  operations should include any operation actually included in a transaction as well
@@ -591,6 +784,12 @@ namespace graphene { namespace chain {
          uint32_t  push_applied_operation( const operation& op );
          void      set_applied_operation_result( uint32_t op_id, const operation_result& r );
          const vector<optional< operation_history_object > >& get_applied_operations()const;
+         /**
+          * @return the accounts impacted by each operation of @ref get_applied_operations, at the same positions, as
+          * @ref operation_get_impacted_accounts finds them. They are computed on the first call after operations
+          * were applied and shared by all callers of the block, e.g. the plugins. Must not be called concurrently.
+          */
+         const vector< flat_set<account_id_type> >& get_applied_operations_impacted_accounts()const;
 
          /**
           *  This signal is emitted after all operations and virtual operation for a
@@ -626,6 +825,21 @@ namespace graphene { namespace chain {
          fc::signal<void(const vector<object_id_type>&,
                          const vector<const object*>&, const flat_set<account_id_type>&)>  removed_objects;
 
+         /**
+          * Registers an account whose involvement in object changes observers need to know. The impacted accounts
+          * reported by @ref new_objects, @ref changed_objects and @ref removed_objects are restricted to the
+          * registered accounts, and not computed at all while none is registered. Registrations are counted, each
+          * must be matched by a call of @ref unsubscribe_impacted_account. Can be called by any thread.
+          */
+         void subscribe_impacted_account( account_id_type account );
+         void unsubscribe_impacted_account( account_id_type account );
+
+         /**
+          *  Emitted after the applied_block signal and the object change signals of a block, i.e. once every
+          *  observer was notified of the block.
+          */
+         fc::signal<void(const signed_block&)>           block_notifications_finished;
+
          ///@{
          /**
           *  This method validates transactions without adding it to the pending state.
@@ -661,9 +875,25 @@ namespace graphene { namespace chain {
           *         precomputations applied
           */
          fc::future<void> precompute_parallel( const precomputable_transaction& trx )const;
+
+         /** Sets the threads which do the expensive part of @ref precompute_parallel, most of all the recovery of
+          *  the signatures of transactions. Without them the work is done in the fc::asio I/O thread pool, which
+          *  also handles the network I/O. Must not be called while precomputations are running.
+          */
+         void set_precompute_threads( std::vector< std::shared_ptr<fc::thread> > threads );
       private:
          template<typename Trx>
          void _precompute_parallel( const Trx* trx, const size_t count, const uint32_t skip )const;
+         /// Runs the task in the next thread of @ref set_precompute_threads, or in the fc::asio pool if there is none
+         fc::future<void> run_precompute_task( std::function<void()> task )const;
+         /// @return the number of threads which run the tasks of @ref run_precompute_task
+         uint32_t precompute_thread_count()const;
+         /** Starts the parallel part of @ref precompute_parallel for a block without waiting for it.
+          *  The transactions and the block must not be used until all of the returned futures have resolved.
+          *  If pipelined is set, cheap precomputations are done by a worker too instead of the calling thread.
+          */
+         std::vector<fc::future<void>> start_precompute( const signed_block& block, const uint32_t skip,
+                                                         const bool pipelined = false )const;
 
       protected:
          // Mark pop_undo() as protected -- we do not want outside calling pop_undo(),
@@ -672,7 +902,14 @@ namespace graphene { namespace chain {
 
       private:
          optional<undo_database::session>       _pending_tx_session;
-         vector< unique_ptr<op_evaluator> >     _operation_evaluators;
+         /// Holds @ref _state_mutex exclusively, nested scopes in the modifying thread share the lock
+         class state_write_scope;
+         mutable boost::shared_mutex            _state_mutex;
+         uint32_t                               _state_write_depth = 0;
+         /// The evaluation functions indexed by operation type, null for operations without evaluator
+         using operation_evaluate_function = operation_result (*)( transaction_evaluation_state&, const operation&,
+                                                                   bool );
+         vector< operation_evaluate_function >  _operation_evaluators;
 
          template<class Index>
          vector<std::reference_wrapper<const typename Index::object_type>> sort_votable_objects(size_t count)const;
@@ -683,6 +920,20 @@ namespace graphene { namespace chain {
          processed_transaction apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op );
 
+         /**
+          *  Applies a block which has been applied by another node by writing the objects it changed there, instead
+          *  of evaluating its transactions. Then the block is announced with the given operations like an applied
+          *  block, so that plugins which only follow the operations and objects, like account_history and
+          *  market_history, maintain their indexes. Blocks from the number of @p block on are popped first, e.g.
+          *  when the other node has switched forks.
+          *
+          *  @param changes the changed objects of the protocol and implementation spaces, an object which was
+          *                 created and removed in the block may be only reported as removed
+          */
+         void                  apply_replicated_block( const signed_block& block,
+                                                       const vector<operation_history_object>& operations,
+                                                       const vector<replicated_object_change>& changes );
+
       private:
          void                  _apply_block( const signed_block& next_block );
          processed_transaction _apply_transaction( const signed_transaction& trx );
@@ -702,6 +953,7 @@ namespace graphene { namespace chain {
          void notify_applied_block( const signed_block& block );
          void notify_on_pending_transaction( const signed_transaction& tx );
          void notify_changed_objects();
+         void notify_block_notifications_finished( const signed_block& block );
 
          //////////////////// db_update.cpp ////////////////////
       public:
@@ -711,10 +963,17 @@ namespace graphene { namespace chain {
          /// @param skip_median_update Whether to skip updating @ref asset_bitasset_data_object::median_feed
          void update_bitasset_current_feed( const asset_bitasset_data_object& bitasset,
                                             bool skip_median_update = false );
+         /// Store the feed of a producer and update @ref asset_bitasset_data_object::median_feed and
+         /// @ref asset_bitasset_data_object::current_feed with it, like @ref update_bitasset_current_feed does,
+         /// in one modification of the bitasset object
+         void publish_bitasset_feed( const asset_bitasset_data_object& bitasset, account_id_type publisher,
+                                     const price_feed_with_icr& feed );
       private:
          void update_global_dynamic_data( const signed_block& b, const uint32_t missed_blocks );
          void update_signing_witness(const witness_object& signing_witness, const signed_block& new_block);
          void update_last_irreversible_block();
+         /// Replaces the head state returned by @ref get_head_state with the current one
+         void publish_head_state();
          void clear_expired_transactions();
          void clear_expired_proposals();
          void clear_expired_orders();
@@ -725,6 +984,24 @@ namespace graphene { namespace chain {
          void update_withdraw_permissions();
          void update_credit_offers_and_deals();
          void clear_expired_htlcs();
+         /**
+          * Like @ref get_viable_custom_authorities, but the custom authorities which are valid for the account and
+          * the operation type are cached until the head block time or any custom authority changes, so that the
+          * transactions of a block share the lookups. Must only be called by the thread which applies blocks.
+          */
+         vector<authority> get_viable_custom_authorities_cached(
+                 account_id_type account, const operation& op, rejected_predicate_map* rejected_authorities )const;
+         /// Runs the expiration sweeps of @ref _apply_block which may have something to do, in their usual order
+         void apply_expiration_sweeps();
+         /// @return whether the expiration sweep may have something to do
+         bool expiration_sweep_due( expiration_sweep_type sweep )const;
+         /// Records when the expiration sweeps will have something to do next, see @ref expiration_sweep_due
+         void update_expiration_sweep_schedule();
+         /// @return the sum of the change counts of the indexes processed by the expiration sweep
+         uint64_t expiration_sweep_change_count( expiration_sweep_type sweep )const;
+         /// @return the earliest block time at which the expiration sweep has something to do, given the current
+         ///         state of the indexes it processes
+         fc::time_point_sec next_expiration_sweep_time( expiration_sweep_type sweep )const;
 
          ///Steps performed only at maintenance intervals
          ///@{
@@ -742,11 +1019,32 @@ namespace graphene { namespace chain {
          void process_bitassets();
 
          template<class Type>
-         void perform_account_maintenance( Type tally_helper );
+         void perform_account_maintenance( Type& tally_helper, maintenance_profile& profile );
          ///@}
          ///@}
 
          vector< processed_transaction >        _pending_tx;
+         /// The limit of _pending_tx, see @ref set_pending_transaction_limit
+         uint32_t                               _max_pending_transactions = 0;
+
+         /// See @ref set_precompute_threads, the next one is picked round-robin
+         std::vector< std::shared_ptr<fc::thread> > _precompute_threads;
+         mutable std::atomic<size_t>            _next_precompute_thread { 0 };
+         /// Changed whenever _pending_tx or _pending_tx_session changes
+         uint64_t                               _pending_tx_version = 0;
+
+         /// The transactions of the next block prepared by @ref prepare_block_candidate
+         struct block_candidate
+         {
+            block_id_type                   previous;
+            witness_id_type                 witness;
+            uint32_t                        skip = 0;
+            uint64_t                        pending_version = 0;
+            vector<processed_transaction>   transactions;
+            merkle_accumulator              merkle;
+         };
+         optional< block_candidate >           _block_candidate;
+         block_generation_timings               _last_block_generation_timings;
          fork_database                          _fork_db;
 
          /**
@@ -767,6 +1065,9 @@ namespace graphene { namespace chain {
           * emited.
           */
          vector<optional<operation_history_object> >  _applied_ops;
+         /// see @ref get_applied_operations_impacted_accounts, the sets are reused from block to block
+         mutable vector< flat_set<account_id_type> >  _applied_ops_impacted_accounts;
+         mutable bool                                  _applied_ops_impacted_accounts_valid = false;
 
          uint32_t                          _current_block_num    = 0;
          uint16_t                          _current_trx_in_block = 0;
@@ -779,7 +1080,34 @@ namespace graphene { namespace chain {
          std::array<uint64_t,2>            _total_voting_stake; // 0=committee, 1=witness,
                                                                 // as in vote_id_type::vote_type
 
+         apply_profile*                    _apply_profile = nullptr;
+
+         /// Only accessed with std::atomic_load and std::atomic_store, see @ref get_head_state
+         std::shared_ptr<const head_state> _head_state = std::make_shared<const head_state>();
+
+         /// The registrations of @ref subscribe_impacted_account by account, protected by the mutex
+         std::map<account_id_type,uint32_t>                 _impacted_account_subscriptions;
+         std::mutex                                         _impacted_account_mutex;
+         /// The registered accounts for @ref notify_changed_objects, replaced with std::atomic_store on changes
+         std::shared_ptr<const flat_set<account_id_type>>   _subscribed_impacted_accounts;
+
+         /// The profiles of the latest maintenances, the latest last, see @ref get_maintenance_profiles
+         std::deque<maintenance_profile>   _maintenance_profiles;
+         uint32_t                          _maintenance_profile_history = 16;
+
+         /// The vote tally kept between maintenance intervals, see @ref enable_incremental_vote_tally
+         vote_tally_cache*                 _vote_tally_cache = nullptr;
+         bool                              _incremental_vote_tally = false;
+         bool                              _verify_vote_tally = false;
+
+         /// The assets with their data objects, see @ref get_resolved_asset
+         const resolved_asset_index*       _resolved_asset_index = nullptr;
+
+         /// The TaPoS reference prefixes of the block summaries, checked when applying transactions
+         const tapos_prefix_index*         _tapos_prefix_index = nullptr;
+
          flat_map<uint32_t,block_id_type>  _checkpoints;
+         block_id_type                     _assume_valid_block;
 
          node_property_object              _node_property_object;
 
@@ -787,6 +1115,21 @@ namespace graphene { namespace chain {
          /// Set it to true to provide accurate data to API clients, set to false to have better performance.
          bool                              _track_standby_votes = true;
 
+         /// Whether to log the memory usage of all indexes at every maintenance interval
+         bool                              _log_index_memory_usage = false;
+
+         /// Whether to keep a copy of every unexpired transaction for @ref get_recent_transaction
+         bool                              _store_recent_transactions = true;
+
+         /// The format of a newly created block database
+         segmented_block_log::settings     _block_log_format;
+         /// The number of recent blocks to keep in the block database, 0 disables pruning
+         uint32_t                          _block_log_keep_blocks = 0;
+         /// The maximum number of blocks read ahead of the block being applied during a replay
+         uint32_t                          _reindex_prefetch_depth = 200;
+         /// The state snapshot which replaces the object database at @ref open
+         optional<fc::path>                _state_snapshot;
+
          /**
           * Whether database is successfully opened or not.
           *
@@ -799,9 +1142,46 @@ namespace graphene { namespace chain {
          // Counts nested proposal updates
          uint32_t                          _push_proposal_nesting_depth = 0;
 
+         /// A change of an existing balance which is written when the current operation ends
+         struct pending_balance_delta
+         {
+            const account_balance_object* balance = nullptr;
+            share_type                    delta   = 0;
+         };
+         /// Whether @ref adjust_balance collects the changes of existing balances in @ref _pending_balance_deltas
+         bool                              _buffer_balance_deltas = false;
+         /// The balance changes of the current operation by account and asset
+         flat_map< std::pair<account_id_type, asset_id_type>, pending_balance_delta > _pending_balance_deltas;
+         /// Writes and clears @ref _pending_balance_deltas
+         void                              flush_balance_deltas();
+
          /// Tracks assets affected by bitshares-core issue #453 before hard fork #615 in one block
          flat_set<asset_id_type>           _issue_453_affected_assets;
 
+         /// The valid custom authorities by account and operation type, see @ref get_viable_custom_authorities_cached
+         mutable std::map< std::pair<account_id_type, int64_t>,
+                           vector<std::reference_wrapper<const custom_authority_object>> > _custom_authority_cache;
+         /// The head block time and the change count of the custom authority index the cache was filled at
+         mutable fc::time_point_sec        _custom_authority_cache_time;
+         mutable uint64_t                  _custom_authority_cache_changes = 0;
+
+         /// Cached by @ref get_market_hardfork_era
+         mutable optional<market_hardfork_era> _market_hardfork_era;
+
+         /// The state in which @ref check_call_orders last found nothing to do for an asset
+         struct call_check_memo
+         {
+            uint32_t           head_block_num = 0;
+            fc::time_point_sec head_time;
+            fc::time_point_sec maint_time;
+            uint64_t           change_count = 0;
+            uint8_t            flags = 0;
+         };
+         flat_map<asset_id_type, call_check_memo> _call_check_memos;
+
+         /// The schedules of the expiration sweeps, by @ref expiration_sweep_type
+         expiration_sweep_states           _expiration_sweeps;
+
          /// Pointers to core asset object and global objects who will have immutable addresses after created
          ///@{
          const asset_object*                    _p_core_asset_obj          = nullptr;
@@ -814,6 +1194,67 @@ namespace graphene { namespace chain {
       public:
          /// Enable or disable tracking of votes of standby witnesses and committee members
          inline void enable_standby_votes_tracking(bool enable)  { _track_standby_votes = enable; }
+         inline bool is_standby_votes_tracking_enabled()const  { return _track_standby_votes; }
+         /**
+          * Enable or disable updating the vote tally of the previous maintenance interval instead of tallying all
+          * votes from scratch. Only the accounts which have changed are tallied again. If @p verify is set, all
+          * accounts are tallied from scratch too, differences are logged and the full tally is used.
+          */
+         inline void enable_incremental_vote_tally( bool enable, bool verify = false )
+         {
+            _incremental_vote_tally = enable;
+            _verify_vote_tally = verify;
+         }
+         /// Enable or disable storing serialized pre-images instead of object copies in undo states
+         inline void enable_packed_undo_states(bool enable)  { _undo_db.set_packed_mode( enable ); }
+         /// Limit the memory of the undo states of reversible blocks, see @ref undo_database::set_max_bytes
+         inline void set_undo_memory_limit( uint64_t bytes )  { _undo_db.set_max_bytes( bytes ); }
+         /// @return the estimated memory held by the undo states of reversible blocks
+         inline graphene::db::undo_database_usage get_undo_database_usage()const  { return _undo_db.get_usage(); }
+         /// Enable or disable logging the memory usage of all indexes at every maintenance interval
+         inline void enable_index_memory_usage_logging(bool enable)  { _log_index_memory_usage = enable; }
+         /**
+          * Enable or disable keeping a copy of every unexpired transaction for @ref get_recent_transaction. The
+          * detection of duplicate transactions only needs their IDs. Transactions which have been stored already
+          * are kept until they expire.
+          */
+         inline void enable_recent_transaction_storage(bool enable)  { _store_recent_transactions = enable; }
+         /// Set the format of the block database if it is created by @ref open, see @ref block_database::open
+         inline void set_block_log_format( const segmented_block_log::settings& format )  { _block_log_format = format; }
+         /// Keep only about this many recent blocks and all reversible ones in the block database, 0 keeps all
+         inline void set_block_log_pruning( uint32_t keep_blocks )  { _block_log_keep_blocks = keep_blocks; }
+         /// Set the maximum number of blocks which are read and unpacked ahead during a replay, at least 1
+         inline void set_reindex_prefetch_depth( uint32_t depth )  { _reindex_prefetch_depth = std::max( depth, 1u ); }
+         /// Let @ref open load the state from a file written by @ref save_state_snapshot instead of the local one
+         inline void set_state_snapshot( const fc::path& file )  { _state_snapshot = file; }
+         /// Keep the transactions of only this many recent blocks in the fork database, 0 keeps all
+         inline void set_fork_db_hot_window( uint32_t blocks )  { _fork_db.set_hot_window( blocks ); }
+         /// Write new blocks to the block database in the background, see @ref block_database::set_write_queue_size
+         inline void set_block_write_queue_size( uint32_t blocks )  { _block_id_to_block.set_write_queue_size( blocks ); }
+         /// Keep the profiles of this many recent maintenances, see @ref get_maintenance_profiles
+         inline void set_maintenance_profile_history( uint32_t count )
+         {
+            _maintenance_profile_history = count;
+            while( _maintenance_profiles.size() > count )
+               _maintenance_profiles.pop_front();
+         }
+         /// @return the time spent and the objects visited and changed by each phase of the latest maintenances
+         inline const std::deque<maintenance_profile>& get_maintenance_profiles()const
+         {
+            return _maintenance_profiles;
+         }
+         /// Makes the blocks applied from now on add their timings to @p profile, nullptr stops profiling.
+         /// The profile must outlive its use.
+         inline void set_apply_profile( apply_profile* profile )  { _apply_profile = profile; }
+         /// @return when each expiration sweep has something to do next and how often it ran or was skipped
+         inline const expiration_sweep_states& get_expiration_sweeps()const  { return _expiration_sweeps; }
+         /// @return the estimated memory used by the blocks in the fork database
+         inline fork_database_usage get_fork_database_usage()const  { return _fork_db.memory_usage(); }
+         /**
+          * @return the head of the chain as of the latest applied or popped block. Unlike the other getters this
+          * can be called from any thread without @ref lock_state_for_reading, the returned state does not change.
+          */
+         inline std::shared_ptr<const head_state> get_head_state()const  { return std::atomic_load( &_head_state ); }
    };
 
 } }
@@ -25,6 +25,9 @@
 
 #include <graphene/chain/database.hpp>
 
+#include <exception>
+#include <map>
+
 /*
  * This file provides with() functions which modify the database
  * temporarily, then restore it.  These functions are mostly internal
@@ -72,6 +75,7 @@ struct pending_transactions_restorer
       : _db(db), _pending_transactions( std::move(pending_transactions) )
    {
       _db.clear_pending();
+      _authority_changes = _db.transfer_authority_change_count();
    }
 
    ~pending_transactions_restorer()
@@ -86,12 +90,29 @@ struct pending_transactions_restorer
          }
       }
       _db._popped_tx.clear();
+      // The pending transactions have passed the authority checks already. As long as no account, custom authority
+      // or chain parameter has changed since then, the checks of plain transfers would pass again.
+      // Other transactions may have changed authorities, even if they fail now, so the shortcut ends at the first.
+      bool reuse_authority_checks = true;
+      const fc::time_point_sec now = _db.head_block_time();
       for( const processed_transaction& tx : _pending_transactions )
       {
+         // expired transactions are dropped without applying them
+         if( tx.expiration < now )
+            continue;
          try
          {
             if( !_db.is_known_transaction( tx.id() ) ) {
-               _db._push_transaction( tx );
+               reuse_authority_checks = reuse_authority_checks && _db.is_plain_transfer_transaction( tx );
+               if( reuse_authority_checks && _db.transfer_authority_change_count() == _authority_changes )
+               {
+                  node_property_object& npo = _db.node_properties();
+                  skip_flags_restorer restorer( npo, npo.skip_flags );
+                  npo.skip_flags |= database::skip_transaction_signatures;
+                  _db._push_transaction( tx );
+               }
+               else
+                  _db._push_transaction( tx );
             }
          }
          catch( const fc::exception& )
@@ -102,6 +123,63 @@ struct pending_transactions_restorer
 
    database& _db;
    std::vector< processed_transaction > _pending_transactions;
+   /// The change count of the objects the authority checks of transfers depend on at the head block before
+   uint64_t _authority_changes = 0;
+};
+
+/**
+ * The running precomputations of blocks, see database::start_precompute. All of them are waited for when this
+ * goes out of scope, so that no worker is left using a block which is gone.
+ */
+class block_precomputations
+{
+   public:
+      block_precomputations() = default;
+      block_precomputations( const block_precomputations& ) = delete;
+      block_precomputations& operator=( const block_precomputations& ) = delete;
+
+      ~block_precomputations()
+      {
+         for( auto& workers : _blocks )
+            for( auto& worker : workers.second )
+            {
+               try {
+                  worker.wait();
+               } catch( ... ) {
+                  // the block is not applied anyway
+               }
+            }
+      }
+
+      void add( const block_id_type& id, std::vector< fc::future<void> >&& workers )
+      {
+         _blocks[id] = std::move( workers );
+      }
+
+      /// Waits until the block is ready to be applied, rethrows the first failure of its workers
+      void wait( const block_id_type& id )
+      {
+         const auto itr = _blocks.find( id );
+         if( itr == _blocks.end() )
+            return;
+         std::vector< fc::future<void> > workers = std::move( itr->second );
+         _blocks.erase( itr );
+         std::exception_ptr failure;
+         for( auto& worker : workers )
+         {
+            try {
+               worker.wait();
+            } catch( ... ) {
+               if( !failure )
+                  failure = std::current_exception();
+            }
+         }
+         if( failure )
+            std::rethrow_exception( failure );
+      }
+
+   private:
+      std::map< block_id_type, std::vector< fc::future<void> > > _blocks;
 };
 
 /**
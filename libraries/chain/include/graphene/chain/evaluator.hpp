@@ -120,23 +120,16 @@ namespace graphene { namespace chain {
       transaction_evaluation_state*    trx_state;
    };
 
-   class op_evaluator
-   {
-   public:
-      virtual ~op_evaluator(){}
-      virtual operation_result evaluate(transaction_evaluation_state& eval_state, const operation& op, bool apply) = 0;
-   };
-
+   /**
+    * Evaluates and optionally applies an operation with a new evaluator of type T on the stack, see
+    * @ref database::register_evaluator
+    */
    template<typename T>
-   class op_evaluator_impl : public op_evaluator
+   operation_result evaluate_operation( transaction_evaluation_state& eval_state, const operation& op, bool apply )
    {
-   public:
-      virtual operation_result evaluate(transaction_evaluation_state& eval_state, const operation& op, bool apply = true) override
-      {
-         T eval;
-         return eval.start_evaluate(eval_state, op, apply);
-      }
-   };
+      T eval;
+      return eval.start_evaluate( eval_state, op, apply );
+   }
 
    template<typename DerivedEvaluator>
    class evaluator : public generic_evaluator
@@ -144,6 +137,16 @@ namespace graphene { namespace chain {
    public:
       virtual int get_type()const override { return operation::tag<typename DerivedEvaluator::operation_type>::value; }
 
+      /// Same as @ref generic_evaluator::start_evaluate, but without virtual calls of evaluate() and apply()
+      virtual operation_result start_evaluate( transaction_evaluation_state& eval_state, const operation& op,
+                                               bool apply ) override
+      { try {
+         trx_state = &eval_state;
+         auto result = evaluator::evaluate( op );
+         if( apply ) result = evaluator::apply( op );
+         return result;
+      } FC_CAPTURE_AND_RETHROW() }
+
       virtual operation_result evaluate(const operation& o) final override
       {
          auto* eval = static_cast<DerivedEvaluator*>(this);
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/types.hpp>
+
+#include <array>
+
+namespace graphene { namespace chain {
+
+   /// The sweeps of expired objects after each block, in the order in which they run
+   enum class expiration_sweep_type : uint8_t
+   {
+      transactions,
+      proposals,
+      limit_orders,
+      force_settlements,
+      htlcs,
+      feeds,                  ///< expired price feeds and core exchange rates
+      withdraw_permissions,
+      credit_offers_and_deals
+   };
+   constexpr size_t expiration_sweep_count = static_cast<size_t>( expiration_sweep_type::credit_offers_and_deals ) + 1;
+
+   /// When an expiration sweep has something to do next and how often it ran, see @ref database::get_expiration_sweeps
+   struct expiration_sweep_state
+   {
+      /// The earliest block time at which the sweep has something to do, unknown if invalid.
+      /// It is only valid while the change count of the indexes processed by the sweep equals @ref change_count.
+      optional<time_point_sec> next_due;
+      uint64_t                 change_count = 0;
+      /// the number of blocks in which the sweep ran
+      uint64_t                 runs = 0;
+      /// the number of blocks in which the sweep was skipped
+      uint64_t                 skips = 0;
+   };
+
+   typedef std::array< expiration_sweep_state, expiration_sweep_count > expiration_sweep_states;
+
+} } // graphene::chain
+
+FC_REFLECT_ENUM( graphene::chain::expiration_sweep_type,
+                 (transactions)(proposals)(limit_orders)(force_settlements)(htlcs)(feeds)(withdraw_permissions)
+                 (credit_offers_and_deals) )
+FC_REFLECT( graphene::chain::expiration_sweep_state, (next_due)(change_count)(runs)(skips) )
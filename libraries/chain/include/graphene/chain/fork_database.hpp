@@ -33,6 +33,8 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 
+#include <functional>
+
 namespace graphene { namespace chain {
    using boost::multi_index_container;
    using namespace boost::multi_index;
@@ -48,6 +50,8 @@ namespace graphene { namespace chain {
       uint32_t              num;    // initialized in ctor
       block_id_type         id;
       signed_block          data;
+      /// false if the transactions have been dropped from data, see @ref fork_database::set_hot_window
+      bool                  has_body = true;
 
       // contains witness block signing keys scheduled *after* the block has been applied
       shared_ptr< vector< pair< witness_id_type, public_key_type > > > scheduled_witnesses;
@@ -56,6 +60,15 @@ namespace graphene { namespace chain {
    };
    typedef shared_ptr<fork_item> item_ptr;
 
+   /// The estimated memory used by the blocks of the fork database
+   struct fork_database_usage
+   {
+      uint32_t item_count = 0;
+      /// number of items which hold the transactions of their block
+      uint32_t body_count = 0;
+      uint64_t bytes      = 0;
+   };
+
 
    /**
     *  As long as blocks are pushed in order the fork
@@ -110,14 +123,32 @@ namespace graphene { namespace chain {
 
          void set_max_size( uint32_t s );
 
+         /**
+          * Only the items of the most recent blocks keep their transactions, older ones are reduced to the block
+          * header by @ref release_bodies. 0 keeps all transactions.
+          */
+         void set_hot_window( uint32_t blocks ) { _hot_window = blocks; }
+         /**
+          * Drops the transactions of the items which are older than the hot window, if is_stored tells that the
+          * block can be read from elsewhere. Every item is considered once, when it leaves the hot window.
+          */
+         void release_bodies( const std::function< bool( const block_id_type& ) >& is_stored );
+
+         fork_database_usage memory_usage()const;
+
       private:
          /** @return a pointer to the newly pushed item */
          void _push_block(const item_ptr& b );
          void _push_next(const item_ptr& newly_inserted);
 
          uint32_t                 _max_size = 1024;
+         uint32_t                 _hot_window = 0;
+         /// all items up to this block number have been considered by @ref release_bodies
+         uint32_t                 _released_num = 0;
 
          fork_multi_index_type    _index;
          shared_ptr<fork_item>    _head;
    };
 } } // graphene::chain
+
+FC_REFLECT( graphene::chain::fork_database_usage, (item_count)(body_count)(bytes) )
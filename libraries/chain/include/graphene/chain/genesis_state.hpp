@@ -128,6 +128,12 @@ struct genesis_state_type {
    /// Method to override initial witness signing keys for debug
    void override_witness_signing_keys( const std::string& new_key );
 
+   /**
+    * Converts a parsed genesis JSON document, same as @c var.as<genesis_state_type>( max_depth ), but the lists
+    * of initial accounts, balances and vesting balances are converted on several threads.
+    */
+   static genesis_state_type from_variant_in_parallel( const fc::variant& var, uint32_t max_depth );
+
 };
 
 } } // namespace graphene::chain
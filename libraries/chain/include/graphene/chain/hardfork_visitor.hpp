@@ -110,4 +110,52 @@ struct hardfork_visitor {
    }
 };
 
+/**
+ * @brief The states of the hard forks which are checked while matching and filling orders
+ *
+ * Most of them are checked against the next maintenance time, some against the head block time. Both only change
+ * between blocks, so the states are evaluated once per block instead of at every match, see
+ * database::get_market_hardfork_era.
+ */
+struct market_hardfork_era {
+   fc::time_point_sec head_time;
+   fc::time_point_sec maint_time;
+
+   /// Checked against the head block time
+   /// @{
+   bool before_hardfork_615;
+   bool after_hardfork_436;
+   bool after_core_hardfork_2582; ///< Price feed issues
+   /// @}
+
+   /// Checked against the next maintenance time
+   /// @{
+   bool before_core_hardfork_184;  ///< Dust orders
+   bool before_core_hardfork_338;  ///< Margin calls at the swan price
+   bool before_core_hardfork_342;  ///< Better rounding
+   bool before_core_hardfork_343;  ///< Update call_price on partial fill
+   bool before_core_hardfork_453;  ///< Multiple matching issue
+   bool before_core_hardfork_606;  ///< Feed always trigger call
+   bool before_core_hardfork_834;  ///< Target collateral ratio option
+   bool before_core_hardfork_1270; ///< Call price caching issue
+   bool after_core_hardfork_2481;  ///< Match settle orders with margin calls
+   /// @}
+
+   market_hardfork_era( const fc::time_point_sec& head, const fc::time_point_sec& maint )
+   : head_time( head ), maint_time( maint ),
+     before_hardfork_615( head < HARDFORK_615_TIME ),
+     after_hardfork_436( head > HARDFORK_436_TIME ),
+     after_core_hardfork_2582( HARDFORK_CORE_2582_PASSED( head ) ),
+     before_core_hardfork_184( maint <= HARDFORK_CORE_184_TIME ),
+     before_core_hardfork_338( maint <= HARDFORK_CORE_338_TIME ),
+     before_core_hardfork_342( maint <= HARDFORK_CORE_342_TIME ),
+     before_core_hardfork_343( maint <= HARDFORK_CORE_343_TIME ),
+     before_core_hardfork_453( maint <= HARDFORK_CORE_453_TIME ),
+     before_core_hardfork_606( maint <= HARDFORK_CORE_606_TIME ),
+     before_core_hardfork_834( maint <= HARDFORK_CORE_834_TIME ),
+     before_core_hardfork_1270( maint <= HARDFORK_CORE_1270_TIME ),
+     after_core_hardfork_2481( HARDFORK_CORE_2481_PASSED( maint ) )
+   {}
+};
+
 } } // namespace graphene::chain
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/types.hpp>
+
+namespace graphene { namespace chain {
+
+   /**
+    * An immutable summary of the head of the chain, published by the database after every applied or popped
+    * block, see @ref database::get_head_state. Threads which only need the head can read it without locking the
+    * state of the database.
+    */
+   struct head_state
+   {
+      uint32_t        block_num = 0;
+      block_id_type   block_id;
+      time_point_sec  time;
+      uint32_t        last_irreversible_block_num = 0;
+      /// the witness who signed the head block
+      witness_id_type current_witness;
+      uint32_t        active_witness_count = 0;
+      /// in GRAPHENE_100_PERCENT, of the latest 128 slots
+      uint32_t        witness_participation = 0;
+      time_point_sec  next_maintenance_time;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::head_state,
+            (block_num)(block_id)(time)(last_irreversible_block_num)(current_witness)(active_witness_count)
+            (witness_participation)(next_maintenance_time) )
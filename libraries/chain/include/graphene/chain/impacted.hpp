@@ -38,4 +38,27 @@ void transaction_get_impacted_accounts( const graphene::chain::transaction& tx,
                                         fc::flat_set<graphene::chain::account_id_type>& result,
                                         bool ignore_custom_operation_required_auths );
 
+/**
+ * The accounts and assets a transaction may modify, used to find transactions which could be applied independently
+ * of each other. Only transfers, whose effects are limited to the accounts returned by
+ * @ref operation_get_impacted_accounts and to the asset they pay the fee in, are analyzed, any other operation
+ * conflicts with every transaction.
+ */
+struct transaction_conflict_set
+{
+   fc::flat_set<graphene::chain::account_id_type> accounts;
+   fc::flat_set<graphene::chain::asset_id_type>   assets;
+   bool                                           conflicts_with_all = false;
+};
+
+transaction_conflict_set transaction_get_conflict_set( const graphene::chain::transaction& tx );
+
+/**
+ * Assigns the transactions to waves: transactions of the same wave have disjoint conflict sets, and every
+ * transaction is in a later wave than all earlier transactions it conflicts with, so applying the waves in order
+ * and the transactions of a wave in any order has the same effect on the touched objects as applying them in order.
+ * @return the wave of each transaction, counting from 0
+ */
+std::vector<uint32_t> schedule_transaction_waves( const std::vector<transaction_conflict_set>& sets );
+
 } } // graphene::app
@@ -62,6 +62,20 @@ class liquidity_pool_object : public abstract_object<liquidity_pool_object>
       }
 };
 
+/**
+ *  @brief What selling an amount to a liquidity pool pays and receives,
+ *         see @ref database::quote_liquidity_pool_exchange
+ */
+struct liquidity_pool_exchange_quote
+{
+   asset maker_market_fee;  ///< Market fee of the asset which the pool receives
+   asset pool_receives;     ///< The amount sold minus the maker market fee
+   asset pool_pays;         ///< What the pool pays, after its taker fee
+   asset pool_taker_fee;    ///< Taker fee of the pool
+   asset taker_market_fee;  ///< Market fee of the asset which the pool pays
+   asset account_receives;  ///< What the seller receives
+};
+
 struct by_share_asset;
 struct by_asset_a;
 struct by_asset_b;
@@ -106,6 +120,8 @@ typedef generic_index<liquidity_pool_object, liquidity_pool_multi_index_type> li
 } } // graphene::chain
 
 MAP_OBJECT_ID_TO_TYPE( graphene::chain::liquidity_pool_object )
+MAP_OBJECT_TO_PRIMARY_INDEX( graphene::chain::liquidity_pool_object,
+      graphene::db::primary_index< graphene::chain::liquidity_pool_index, 10, graphene::db::flat_direct_index > )
 
 // Note: this is left here but not moved to a cpp file due to the extended_liquidity_pool_object struct in API.
 FC_REFLECT_DERIVED( graphene::chain::liquidity_pool_object, (graphene::db::object),
@@ -119,4 +135,7 @@ FC_REFLECT_DERIVED( graphene::chain::liquidity_pool_object, (graphene::db::objec
                     (virtual_value)
                   )
 
+FC_REFLECT( graphene::chain::liquidity_pool_exchange_quote,
+            (maker_market_fee)(pool_receives)(pool_pays)(pool_taker_fee)(taker_market_fee)(account_receives) )
+
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::liquidity_pool_object )
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/types.hpp>
+
+namespace graphene { namespace chain {
+
+   /// What one phase of a maintenance cost, see @ref maintenance_profile
+   struct maintenance_phase_profile
+   {
+      string   name;
+      /// wall clock time spent, not deterministic
+      uint64_t microseconds     = 0;
+      /// objects looked at by the phase, deterministic
+      uint64_t objects_visited  = 0;
+      /// objects added, modified or removed by the phase, deterministic
+      uint64_t objects_modified = 0;
+   };
+
+   /// The cost of a maintenance by phase, see @ref database::get_maintenance_profiles
+   struct maintenance_profile
+   {
+      uint32_t                          block_num = 0;
+      time_point_sec                    timestamp;
+      /// wall clock time spent for the whole maintenance, including the parts which are not in a phase
+      uint64_t                          microseconds = 0;
+      vector<maintenance_phase_profile> phases;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::maintenance_phase_profile, (name)(microseconds)(objects_visited)(objects_modified) )
+FC_REFLECT( graphene::chain::maintenance_profile, (block_num)(timestamp)(microseconds)(phases) )
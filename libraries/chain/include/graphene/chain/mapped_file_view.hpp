@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /**
+    * A read-only view of a file which is appended to while it is being read. The file is mapped in regions of
+    * a fixed size which stay in place until the view is destroyed, so that readers never have to wait for the
+    * writer. The writer publishes the readable size only after the data has been written to the file.
+    */
+   class mapped_file_view
+   {
+      public:
+         /**
+          * @param region_size the granularity in which the file is mapped
+          * @param max_regions the maximum size of the file in regions
+          */
+         explicit mapped_file_view( const fc::path& file, uint64_t region_size = 256 * 1024 * 1024,
+                                    size_t max_regions = 16 * 1024 )
+         : _path( file ),
+           _file( file.generic_string().c_str(), fc::read_only ),
+           _region_size( region_size ),
+           _max_regions( max_regions ),
+           _region_addresses( new std::atomic<const char*>[max_regions] )
+         {
+            for( size_t i = 0; i < max_regions; ++i )
+               _region_addresses[i].store( nullptr, std::memory_order_relaxed );
+            resize( fc::file_size( file ) );
+         }
+
+         /** Called by the writer after the file has been extended or truncated to new_size */
+         void resize( uint64_t new_size )
+         {
+            const uint64_t needed = ( new_size + _region_size - 1 ) / _region_size;
+            FC_ASSERT( needed <= _max_regions, "${f} is too large to be mapped", ("f",_path) );
+            while( _regions.size() < needed )
+            {
+               _regions.emplace_back( std::make_unique<fc::mapped_region>( _file, fc::read_only,
+                                                                           _regions.size() * _region_size,
+                                                                           _region_size ) );
+               _region_addresses[ _regions.size() - 1 ].store(
+                     static_cast<const char*>( _regions.back()->get_address() ), std::memory_order_release );
+            }
+            _size.store( new_size, std::memory_order_release );
+         }
+
+         uint64_t size()const { return _size.load( std::memory_order_acquire ); }
+
+         /** @return a pointer to the data at pos, or nullptr if it is not readable or not contiguous in memory */
+         const char* data( uint64_t pos, uint64_t len )const
+         {
+            if( pos + len > size() || ( len > 0 && pos / _region_size != ( pos + len - 1 ) / _region_size ) )
+               return nullptr;
+            const char* base = _region_addresses[ pos / _region_size ].load( std::memory_order_acquire );
+            return base != nullptr ? base + pos % _region_size : nullptr;
+         }
+
+         /** Copies len bytes at pos to out, @return false if they are not readable */
+         bool read( uint64_t pos, uint64_t len, char* out )const
+         {
+            if( pos + len > size() )
+               return false;
+            while( len > 0 )
+            {
+               const uint64_t offset = pos % _region_size;
+               const uint64_t count = std::min( len, _region_size - offset );
+               const char* base = _region_addresses[ pos / _region_size ].load( std::memory_order_acquire );
+               std::memcpy( out, base + offset, count );
+               pos += count;
+               out += count;
+               len -= count;
+            }
+            return true;
+         }
+
+      private:
+         const fc::path                                        _path;
+         fc::file_mapping                                      _file;
+         const uint64_t                                        _region_size;
+         const size_t                                          _max_regions;
+         /// only accessed by the writer
+         std::vector< std::unique_ptr<fc::mapped_region> >     _regions;
+         std::unique_ptr< std::atomic<const char*>[] >         _region_addresses;
+         std::atomic<uint64_t>                                 _size { 0 };
+   };
+
+} } // graphene::chain
@@ -52,6 +52,9 @@ namespace graphene { namespace chain {
          virtual void pay_fee() override;
 
       private:
+         /// Rejects a fill-or-kill order early if the orders on the book could not fill it
+         void check_fill_or_kill_liquidity( const limit_order_create_operation& op )const;
+
          share_type                          _deferred_fee  = 0;
          asset                               _deferred_paid_fee;
          const account_object*               _seller        = nullptr;
@@ -29,6 +29,11 @@
 
 #include <boost/multi_index/composite_key.hpp>
 
+#include <fc/uint128.hpp>
+
+#include <map>
+#include <stack>
+
 namespace graphene { namespace chain {
 
 using namespace graphene::db;
@@ -48,12 +53,14 @@ class limit_order_object : public abstract_object<limit_order_object>
       static constexpr uint8_t type_id  = limit_order_object_type;
 
       time_point_sec   expiration;
+      bool             is_settled_debt = false; ///< Whether this order is an individual settlement fund
       account_id_type  seller;
-      share_type       for_sale; ///< asset id is sell_price.base.asset_id
-      price            sell_price;
       share_type       deferred_fee; ///< fee converted to CORE
       asset            deferred_paid_fee; ///< originally paid fee
-      bool             is_settled_debt = false; ///< Whether this order is an individual settlement fund
+      // The members read while walking an order book come last, next to the links of the by_price index which
+      // is the last index of limit_order_multi_index_type, so that a step of a walk touches fewer cache lines
+      share_type       for_sale; ///< asset id is sell_price.base.asset_id
+      price            sell_price;
 
       pair<asset_id_type,asset_id_type> get_market()const
       {
@@ -83,13 +90,6 @@ typedef multi_index_container<
             member< object, object_id_type, &object::id>
          >
       >,
-      ordered_unique< tag<by_price>,
-         composite_key< limit_order_object,
-            member< limit_order_object, price, &limit_order_object::sell_price>,
-            member< object, object_id_type, &object::id>
-         >,
-         composite_key_compare< std::greater<price>, std::less<object_id_type> >
-      >,
       ordered_unique< tag<by_is_settled_debt>,
          composite_key< limit_order_object,
             member< limit_order_object, bool, &limit_order_object::is_settled_debt >,
@@ -112,11 +112,57 @@ typedef multi_index_container<
             member<object, object_id_type, &object::id>
          >,
          composite_key_compare<std::less<account_id_type>, std::greater<price>, std::less<object_id_type>>
+      >,
+      // the index used for matching is the last one, its links are stored right after the object in a node
+      ordered_unique< tag<by_price>,
+         composite_key< limit_order_object,
+            member< limit_order_object, price, &limit_order_object::sell_price>,
+            member< object, object_id_type, &object::id>
+         >,
+         composite_key_compare< std::greater<price>, std::less<object_id_type> >
       >
    >
 > limit_order_multi_index_type;
 
-typedef generic_index<limit_order_object, limit_order_multi_index_type> limit_order_index;
+typedef generic_index<limit_order_object, limit_order_multi_index_type, true> limit_order_index;
+
+/**
+ *  @brief This secondary index aggregates the limit orders of each price, i.e. the levels of the order books.
+ *
+ *  The levels are sorted like the by_price index of the limit orders, the queue of orders of a level is the matching
+ *  range of that index. The index is used when evaluating operations, it must not be deferred.
+ */
+class limit_order_price_level_index : public secondary_index
+{
+   public:
+      struct price_level
+      {
+         share_type for_sale;        ///< the sum of the amounts for sale of the orders at this price
+         uint32_t   order_count = 0; ///< the number of orders at this price
+      };
+      using level_map = std::map< price, price_level, std::greater<price> >;
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      virtual size_t memory_usage()const override;
+
+      const level_map& get_levels()const { return _levels; }
+
+      /**
+       *  @return an upper bound of the amount of the receiving asset of @p taker_price which the orders on the book
+       *          can take from a taker selling at that price. Stops adding up levels once @p enough is reached.
+       */
+      fc::uint128_t max_amount_to_take( const price& taker_price, const fc::uint128_t& enough )const;
+
+   private:
+      void add_order( const price& p, share_type for_sale, int32_t count );
+
+      level_map _levels;
+      std::stack< std::pair< price, share_type > > _orders_being_modified;
+};
 
 /**
  * @class call_order_object
@@ -139,12 +185,14 @@ class call_order_object : public abstract_object<call_order_object>
       price collateralization()const { return get_collateral() / get_debt(); }
 
       account_id_type  borrower;
+      optional<uint16_t> target_collateral_ratio; ///< maximum CR to maintain when selling collateral on margin call
+
+      // The members which make up the collateralization come last, next to the links of the by_collateral index,
+      // see limit_order_object
       share_type       collateral;  ///< call_price.base.asset_id, access via get_collateral
       share_type       debt;        ///< call_price.quote.asset_id, access via get_debt
       price            call_price;  ///< Collateral / Debt
 
-      optional<uint16_t> target_collateral_ratio; ///< maximum CR to maintain when selling collateral on margin call
-
       pair<asset_id_type,asset_id_type> get_market()const
       {
          auto tmp = std::make_pair( call_price.base.asset_id, call_price.quote.asset_id );
@@ -231,6 +279,7 @@ typedef multi_index_container<
             const_mem_fun< call_order_object, asset_id_type, &call_order_object::debt_type>
          >
       >,
+      // the index used for margin calls is the last one, its links are stored right after the object in a node
       ordered_unique< tag<by_collateral>,
          composite_key< call_order_object,
             const_mem_fun< call_order_object, price, &call_order_object::collateralization >,
@@ -283,7 +332,7 @@ typedef multi_index_container<
    >
 > collateral_bid_object_multi_index_type;
 
-typedef generic_index<call_order_object, call_order_multi_index_type>                      call_order_index;
+typedef generic_index<call_order_object, call_order_multi_index_type, true>                call_order_index;
 typedef generic_index<force_settlement_object, force_settlement_object_multi_index_type>   force_settlement_index;
 typedef generic_index<collateral_bid_object, collateral_bid_object_multi_index_type>       collateral_bid_index;
 
@@ -294,6 +343,13 @@ MAP_OBJECT_ID_TO_TYPE(graphene::chain::call_order_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::force_settlement_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::collateral_bid_object)
 
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::limit_order_object,
+                            graphene::db::primary_index< graphene::chain::limit_order_index >)
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::call_order_object,
+                            graphene::db::primary_index< graphene::chain::call_order_index >)
+MAP_OBJECT_TO_PRIMARY_INDEX(graphene::chain::force_settlement_object,
+                            graphene::db::primary_index< graphene::chain::force_settlement_index >)
+
 FC_REFLECT_TYPENAME( graphene::chain::limit_order_object )
 FC_REFLECT_TYPENAME( graphene::chain::call_order_object )
 FC_REFLECT_TYPENAME( graphene::chain::force_settlement_object )
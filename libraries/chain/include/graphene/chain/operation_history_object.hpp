@@ -108,7 +108,6 @@ namespace graphene { namespace chain {
    typedef generic_index<operation_history_object, operation_history_multi_index_type> operation_history_index;
 
    struct by_seq;
-   struct by_op;
    struct by_opid;
 
    typedef multi_index_container<
@@ -121,12 +120,6 @@ namespace graphene { namespace chain {
                member< account_transaction_history_object, uint64_t, &account_transaction_history_object::sequence>
             >
          >,
-         ordered_unique< tag<by_op>,
-            composite_key< account_transaction_history_object,
-               member< account_transaction_history_object, account_id_type, &account_transaction_history_object::account>,
-               member< account_transaction_history_object, operation_history_id_type, &account_transaction_history_object::operation_id>
-            >
-         >,
          ordered_non_unique< tag<by_opid>,
             member< account_transaction_history_object, operation_history_id_type, &account_transaction_history_object::operation_id>
          >
@@ -75,6 +75,8 @@ class required_approval_index : public secondary_index
       virtual void object_removed( const object& obj ) override;
       virtual void about_to_modify( const object& before ) override;
       virtual void object_modified( const object& after  ) override;
+      /** only used by the API */
+      virtual bool is_deferrable()const override { return true; }
 
       map<account_id_type, set<proposal_id_type> > _account_to_proposals;
 
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/protocol/block.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+
+namespace graphene { namespace chain {
+   struct segment_entry;
+   using namespace graphene::protocol;
+
+   /**
+    * @brief Stores blocks in segments holding a fixed range of block numbers each
+    *
+    * Every segment consists of a data file with the blocks of the segment, which can be compressed one by one,
+    * and an index file with one entry per block number of the segment. Segments are only written while the head
+    * block is in their range (or when a fork is switched across the boundary), so older segments can be archived,
+    * served as plain files or removed.
+    *
+    * Like @ref block_database, modifications must be done by a single thread, lookups can be done concurrently
+    * from any thread.
+    */
+   class segmented_block_log
+   {
+      public:
+         struct settings
+         {
+            /// the number of block numbers per segment, 0 selects the single-file format of @ref block_database
+            uint32_t blocks_per_segment = 0;
+            /// whether new blocks are stored compressed with zstd, requires a build with zstd
+            bool     compress           = false;
+         };
+
+         static constexpr uint32_t min_blocks_per_segment = 10000;
+
+         /** @return true if dir holds a segmented block log */
+         static bool exists( const fc::path& dir );
+         /** @return true if this build supports compressed blocks */
+         static bool compression_supported();
+
+         /**
+          * Opens the log in dir. A new log is created with the given settings, an existing one keeps the number
+          * of blocks per segment it has been created with.
+          */
+         segmented_block_log( const fc::path& dir, const settings& s );
+         ~segmented_block_log();
+
+         const settings& get_settings()const { return _settings; }
+
+         void flush();
+
+         void store( const block_id_type& id, const signed_block& b );
+         void remove( const block_id_type& id );
+
+         bool                    contains( const block_id_type& id )const;
+         optional<block_id_type> fetch_block_id( uint32_t block_num )const;
+         optional<signed_block>  fetch_optional( const block_id_type& id )const;
+         optional<signed_block>  fetch_by_number( uint32_t block_num )const;
+         /** Unpacks the block into @p result, reusing its containers, @return false if the block is not available */
+         bool                    fetch_by_number( uint32_t block_num, signed_block& result )const;
+         /** @return the serialized block, decompressed but not unpacked */
+         optional<vector<char>>  fetch_packed_by_number( uint32_t block_num )const;
+         /** Drops damaged entries at the end of the log, like @ref block_database::last_id */
+         optional<block_id_type> last_id();
+
+         /**
+          * Removes all segments which only hold blocks before first_kept_block. Readers can still use a removed
+          * segment until the next call or until the log is closed, only then its files are deleted.
+          */
+         void                    prune( uint32_t first_kept_block );
+         /** @return the lowest block number which has not been pruned */
+         uint32_t                first_block_num()const;
+
+         /** @return the total size of the data files of all segments */
+         uint64_t                total_block_size()const;
+         /**
+          * @return the total size of the data files up to the most recently read block, used for progress reports
+          * @note must only be called by one thread at a time
+          */
+         uint64_t                blocks_current_position()const;
+
+      private:
+         struct segment;
+
+         const segment* find_segment( uint32_t number )const;
+         segment&       writable_segment( uint32_t number );
+         /** closes the segments removed by the previous @ref prune and deletes their files */
+         void           release_retired_segments();
+
+         /** @return false if there is no entry for block_num */
+         bool read_entry( uint32_t block_num, segment_entry& e )const;
+         void write_entry( uint32_t block_num, const segment_entry& e );
+         void read_block( uint32_t block_num, const segment_entry& e, signed_block& result )const;
+         vector<char> read_packed_block( uint32_t block_num, const segment_entry& e )const;
+
+         const fc::path                                  _dir;
+         settings                                        _settings;
+         size_t                                          _max_segments = 0;
+         /// all segments by number, for the readers
+         std::unique_ptr< std::atomic<segment*>[] >      _segments;
+         /// owns the segments, only accessed by the writer
+         std::map< uint32_t, std::unique_ptr<segment> >  _owned_segments;
+         /// pruned segments which might still be in use by readers
+         vector< std::unique_ptr<segment> >              _retired_segments;
+         std::atomic<uint32_t>                           _first_segment { 0 };
+         /// Incremented before and after an index entry is overwritten, so that readers can detect torn reads
+         std::atomic<uint64_t>                           _index_writes { 0 };
+
+         /// the segment and position of the end of the most recently read block
+         mutable std::atomic<uint64_t>                   _last_read_segment { 0 };
+         mutable std::atomic<uint64_t>                   _last_read_end { 0 };
+         /// total size of the data files before _progress_segment, see @ref blocks_current_position
+         mutable uint64_t                                _progress_segment = 0;
+         mutable uint64_t                                _progress_offset = 0;
+   };
+} }
+
+FC_REFLECT( graphene::chain::segmented_block_log::settings, (blocks_per_segment)(compress) )
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/block.hpp>
+
+namespace graphene { namespace chain {
+
+   /**
+    * The start of a state snapshot file, see @ref database::save_state_snapshot. It is followed by the objects
+    * of the object database, see @ref graphene::db::object_database::save_snapshot.
+    */
+   struct state_snapshot_header
+   {
+      static constexpr uint32_t current_format = 1;
+
+      uint32_t                     format = current_format;
+      chain_id_type                chain_id;
+      /// the blocks from the last irreversible block up to the head block of the saved state, in order
+      std::vector< signed_block >  blocks;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::state_snapshot_header, (format)(chain_id)(blocks) )
@@ -28,6 +28,10 @@ namespace graphene {
 namespace protocol { class signed_transaction; }
 namespace chain {
    class database;
+   class account_object;
+   class account_statistics_object;
+   class asset_object;
+   class asset_dynamic_data_object;
    using protocol::signed_transaction;
 
    /**
@@ -49,5 +53,14 @@ namespace chain {
          bool                             _is_proposed_trx = false;
          bool                             skip_fee = false;
          bool                             skip_fee_schedule_check = false;
+
+         /// The fee paying objects of the last evaluated operation, reused by the next operation of the
+         /// transaction if it pays its fee from the same account with the same asset
+         ///@{
+         const account_object*            last_fee_paying_account = nullptr;
+         const account_statistics_object* last_fee_paying_account_statistics = nullptr;
+         const asset_object*              last_fee_asset = nullptr;
+         const asset_dynamic_data_object* last_fee_asset_dyn_data = nullptr;
+         ///@}
    };
 } } // namespace graphene::chain
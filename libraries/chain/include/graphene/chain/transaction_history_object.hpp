@@ -40,6 +40,10 @@ namespace graphene { namespace chain {
     * The purpose of this object is to enable the detection of duplicate transactions. When a transaction is included
     * in a block a transaction_history_object is added. At the end of block processing all transaction_history_objects that
     * have expired can be removed from the index.
+    *
+    * Only the ID and the expiration are needed for that. The transaction itself is only kept for
+    * @ref database::get_recent_transaction if the database stores recent transactions, see
+    * @ref database::enable_recent_transaction_storage.
     */
    class transaction_history_object : public abstract_object<transaction_history_object>
    {
@@ -47,10 +51,11 @@ namespace graphene { namespace chain {
          static constexpr uint8_t space_id = implementation_ids;
          static constexpr uint8_t type_id  = impl_transaction_history_object_type;
 
-         signed_transaction  trx;
-         transaction_id_type trx_id;
+         transaction_id_type           trx_id;
+         time_point_sec                expiration;
+         optional<signed_transaction>  trx;
 
-         time_point_sec get_expiration()const { return trx.expiration; }
+         time_point_sec get_expiration()const { return expiration; }
    };
 
    struct by_expiration;
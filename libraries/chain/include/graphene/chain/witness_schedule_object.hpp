@@ -36,10 +36,20 @@ class witness_schedule_object : public graphene::db::abstract_object<witness_sch
       vector< witness_id_type > current_shuffled_witnesses;
 };
 
+/// A block production slot, see @ref database::get_scheduled_slots
+struct witness_schedule_slot
+{
+   uint32_t           slot_num = 0;
+   fc::time_point_sec time;
+   witness_id_type    witness;
+};
+
 } }
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::witness_schedule_object)
 
 FC_REFLECT_TYPENAME( graphene::chain::witness_schedule_object )
 
+FC_REFLECT( graphene::chain::witness_schedule_slot, (slot_num)(time)(witness) )
+
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::witness_schedule_object )
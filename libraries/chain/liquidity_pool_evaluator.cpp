@@ -355,46 +355,28 @@ void_result liquidity_pool_exchange_evaluator::do_evaluate(const liquidity_pool_
       }
    }
 
-   _pool_receives_asset = ( op.amount_to_sell.asset_id == _pool->asset_a ? &asset_obj_a : &asset_obj_b );
-
-   _maker_market_fee = d.calculate_market_fee( *_pool_receives_asset, op.amount_to_sell, true );
-   FC_ASSERT( _maker_market_fee < op.amount_to_sell,
-              "Aborting since the maker market fee of the selling asset is too high" );
-   _pool_receives = op.amount_to_sell - _maker_market_fee;
-
-   fc::uint128_t delta;
    if( op.amount_to_sell.asset_id == _pool->asset_a )
    {
-      share_type new_balance_a = _pool->balance_a + _pool_receives.amount;
-      // round up
-      fc::uint128_t new_balance_b = ( _pool->virtual_value + new_balance_a.value - 1 ) / new_balance_a.value;
-      FC_ASSERT( new_balance_b <= _pool->balance_b, "Internal error" );
-      delta = fc::uint128_t( _pool->balance_b.value ) - new_balance_b;
+      _pool_receives_asset = &asset_obj_a;
       _pool_pays_asset = &asset_obj_b;
    }
    else
    {
-      share_type new_balance_b = _pool->balance_b + _pool_receives.amount;
-      // round up
-      fc::uint128_t new_balance_a = ( _pool->virtual_value + new_balance_b.value - 1 ) / new_balance_b.value;
-      FC_ASSERT( new_balance_a <= _pool->balance_a, "Internal error" );
-      delta = fc::uint128_t( _pool->balance_a.value ) - new_balance_a;
+      _pool_receives_asset = &asset_obj_b;
       _pool_pays_asset = &asset_obj_a;
    }
 
-   fc::uint128_t pool_taker_fee = delta * _pool->taker_fee_percent / GRAPHENE_100_PERCENT;
-   FC_ASSERT( pool_taker_fee <= delta, "Taker fee percent of the pool is too high" );
-
-   _pool_pays = asset( static_cast<int64_t>( delta - pool_taker_fee ), op.min_to_receive.asset_id );
-
-   _taker_market_fee = d.calculate_market_fee( *_pool_pays_asset, _pool_pays, false );
-   FC_ASSERT( _taker_market_fee <= _pool_pays, "Market fee should not be greater than the amount to receive" );
-   _account_receives = _pool_pays - _taker_market_fee;
+   const auto quote = d.quote_liquidity_pool_exchange( *_pool, op.amount_to_sell,
+                                                       *_pool_receives_asset, *_pool_pays_asset );
+   _maker_market_fee = quote.maker_market_fee;
+   _pool_receives = quote.pool_receives;
+   _pool_pays = quote.pool_pays;
+   _pool_taker_fee = quote.pool_taker_fee;
+   _taker_market_fee = quote.taker_market_fee;
+   _account_receives = quote.account_receives;
 
    FC_ASSERT( _account_receives.amount >= op.min_to_receive.amount, "Unable to exchange at expected price" );
 
-   _pool_taker_fee = asset( static_cast<int64_t>( pool_taker_fee ), op.min_to_receive.asset_id );
-
    return void_result();
 } FC_CAPTURE_AND_RETHROW( (op) ) }
 
@@ -100,8 +100,37 @@ void limit_order_create_evaluator::pay_fee()
    }
 }
 
+void limit_order_create_evaluator::check_fill_or_kill_liquidity( const limit_order_create_operation& op )const
+{
+   const database& d = db();
+   if( d.get_dynamic_global_properties().next_maintenance_time <= HARDFORK_CORE_625_TIME )
+      return;
+   // Call orders and settled debt can only take the order if it is selling a MPA for its backing asset
+   if( _sell_asset->is_market_issued()
+         && _sell_asset->bitasset_data(d).options.short_backing_asset == _receive_asset->get_id() )
+      return;
+
+   // Otherwise only limit orders can fill it. The order counts as filled if what remains of it is worth less than
+   // one unit of the receiving asset at its price, so it can not be filled if
+   //   what_the_book_can_take <= amount_to_sell - amount_to_sell / min_to_receive
+   const fc::uint128_t to_sell = op.amount_to_sell.amount.value;
+   const fc::uint128_t to_receive = op.min_to_receive.amount.value;
+   const auto& levels = d.get_index_type< primary_index< limit_order_index > >()
+                         .get_secondary_index< limit_order_price_level_index >();
+   const fc::uint128_t can_take = levels.max_amount_to_take( op.get_price(), to_sell );
+   if( can_take >= to_sell )
+      return;
+   GRAPHENE_ASSERT( can_take * to_receive + to_sell > to_sell * to_receive,
+                    limit_order_create_kill_unfilled,
+                    "Killing limit order ${op} due to unable to fill",
+                    ("op",op) );
+}
+
 object_id_type limit_order_create_evaluator::do_apply(const limit_order_create_operation& op) const
 { try {
+   if( op.fill_or_kill )
+      check_fill_or_kill_liquidity( op );
+
    if( op.amount_to_sell.asset_id == asset_id_type() )
    {
       db().modify( _seller->statistics(db()), [&op](account_statistics_object& bal) {
@@ -306,6 +306,74 @@ share_type call_order_object::get_max_debt_to_cover( price match_price,
 
 } FC_CAPTURE_AND_RETHROW( (*this)(feed_price)(match_price)(maintenance_collateral_ratio) ) }
 
+void limit_order_price_level_index::add_order( const price& p, share_type for_sale, int32_t count )
+{
+   auto itr = _levels.find( p );
+   if( itr == _levels.end() )
+      itr = _levels.emplace( p, price_level() ).first;
+   itr->second.for_sale += for_sale;
+   itr->second.order_count += count;
+   if( 0 == itr->second.order_count )
+      _levels.erase( itr );
+}
+
+void limit_order_price_level_index::object_inserted( const object& obj )
+{
+   const auto& order = static_cast< const limit_order_object& >( obj );
+   add_order( order.sell_price, order.for_sale, 1 );
+}
+
+void limit_order_price_level_index::object_removed( const object& obj )
+{
+   const auto& order = static_cast< const limit_order_object& >( obj );
+   add_order( order.sell_price, -order.for_sale, -1 );
+}
+
+void limit_order_price_level_index::about_to_modify( const object& before )
+{
+   const auto& order = static_cast< const limit_order_object& >( before );
+   _orders_being_modified.emplace( order.sell_price, order.for_sale );
+}
+
+void limit_order_price_level_index::object_modified( const object& after )
+{
+   const auto& order = static_cast< const limit_order_object& >( after );
+   const auto& before = _orders_being_modified.top();
+   if( before.first == order.sell_price )
+      add_order( order.sell_price, order.for_sale - before.second, 0 );
+   else
+   {
+      add_order( before.first, -before.second, -1 );
+      add_order( order.sell_price, order.for_sale, 1 );
+   }
+   _orders_being_modified.pop();
+}
+
+fc::uint128_t limit_order_price_level_index::max_amount_to_take( const price& taker_price,
+                                                                 const fc::uint128_t& enough )const
+{
+   // the makers sell at their prices or better for the taker
+   const price max_price = ~taker_price;
+   auto itr = _levels.lower_bound( max_price.max() );
+   const auto end = _levels.upper_bound( max_price );
+   fc::uint128_t result = 0;
+   for( ; itr != end && result < enough; ++itr )
+   {
+      // every order of the level takes its amount for sale times its price, rounded up
+      result += fc::uint128_t( itr->second.for_sale.value ) * itr->first.quote.amount.value
+                   / itr->first.base.amount.value
+                + itr->second.order_count;
+   }
+   return result;
+}
+
+size_t limit_order_price_level_index::memory_usage()const
+{
+   // a node of a map holds the value, three pointers and the color
+   const size_t node_size = sizeof( level_map::value_type ) + 4 * sizeof(void*);
+   return _levels.size() * node_size;
+}
+
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::limit_order_object,
                     (graphene::db::object),
                     (expiration)(seller)(for_sale)(sell_price)(deferred_fee)(deferred_paid_fee)
@@ -0,0 +1,519 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/segmented_block_log.hpp>
+#include <graphene/chain/mapped_file_view.hpp>
+#include <graphene/protocol/fee_schedule.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+
+#include <boost/endian/buffers.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+#ifdef GRAPHENE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace graphene { namespace chain {
+
+struct segment_entry
+{
+   segment_entry() {
+      block_pos = 0;
+      block_size = 0;
+      raw_size = 0;
+   }
+   /// position in the data file of the segment
+   boost::endian::little_uint64_buf_t block_pos;
+   /// stored size of the block, 0 if there is no block
+   boost::endian::little_uint32_buf_t block_size;
+   /// size of the packed block if it is stored compressed, 0 if it is stored as is
+   boost::endian::little_uint32_buf_t raw_size;
+   block_id_type                      block_id;
+};
+
+namespace {
+   const char* const settings_filename = "segments.json";
+   const int         compression_level = 3;
+   /// data files are mapped in regions of this size
+   const uint64_t    data_region_size  = 64 * 1024 * 1024;
+   const size_t      max_data_regions  = 1024;
+
+   vector<char> compress_block( const vector<char>& raw )
+   {
+#ifdef GRAPHENE_HAVE_ZSTD
+      vector<char> result( ZSTD_compressBound( raw.size() ) );
+      const size_t size = ZSTD_compress( result.data(), result.size(), raw.data(), raw.size(), compression_level );
+      FC_ASSERT( !ZSTD_isError( size ), "Failed to compress block: ${e}", ("e",ZSTD_getErrorName( size )) );
+      result.resize( size );
+      return result;
+#else
+      FC_THROW( "Compressed block logs are not supported by this build" );
+#endif
+   }
+
+   vector<char> decompress_block( const char* data, size_t size, size_t raw_size )
+   {
+#ifdef GRAPHENE_HAVE_ZSTD
+      vector<char> result( raw_size );
+      const size_t result_size = ZSTD_decompress( result.data(), result.size(), data, size );
+      FC_ASSERT( !ZSTD_isError( result_size ) && result_size == raw_size, "Failed to decompress block" );
+      return result;
+#else
+      FC_THROW( "Compressed block logs are not supported by this build" );
+#endif
+   }
+
+   std::string segment_name( uint32_t number )
+   {
+      std::ostringstream name;
+      name << std::setw(10) << std::setfill('0') << number;
+      return name.str();
+   }
+
+   void open_file( std::fstream& stream, const fc::path& file )
+   {
+      stream.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+      auto mode = std::fstream::binary | std::fstream::in | std::fstream::out;
+      if( !fc::exists( file ) )
+         mode |= std::fstream::trunc;
+      stream.open( file.generic_string().c_str(), mode );
+   }
+}
+
+struct segmented_block_log::segment
+{
+   segment( const fc::path& dir, uint32_t num, uint32_t blocks_per_segment )
+   : number( num ),
+     data_path( dir / ( segment_name( num ) + ".blocks" ) ),
+     index_path( dir / ( segment_name( num ) + ".index" ) )
+   {
+      open_file( data, data_path );
+      open_file( index, index_path );
+      data_view = std::make_unique<mapped_file_view>( data_path, data_region_size, max_data_regions );
+      index_view = std::make_unique<mapped_file_view>( index_path, uint64_t(blocks_per_segment) * sizeof(segment_entry),
+                                                       1 );
+   }
+
+   const uint32_t                     number;
+   const fc::path                     data_path;
+   const fc::path                     index_path;
+   std::fstream                       data;
+   std::fstream                       index;
+   std::unique_ptr<mapped_file_view>  data_view;
+   std::unique_ptr<mapped_file_view>  index_view;
+};
+
+bool segmented_block_log::exists( const fc::path& dir )
+{
+   return fc::exists( dir / settings_filename );
+}
+
+bool segmented_block_log::compression_supported()
+{
+#ifdef GRAPHENE_HAVE_ZSTD
+   return true;
+#else
+   return false;
+#endif
+}
+
+segmented_block_log::segmented_block_log( const fc::path& dir, const settings& s )
+: _dir( dir ), _settings( s )
+{ try {
+   fc::create_directories( _dir );
+   if( exists( _dir ) )
+   {
+      const bool compress = _settings.compress;
+      _settings = fc::json::from_file( _dir / settings_filename ).as<settings>( 2 );
+      // compression only affects blocks stored from now on, so it can be changed at any time
+      _settings.compress = compress;
+   }
+   FC_ASSERT( _settings.blocks_per_segment >= min_blocks_per_segment,
+              "A segment must hold at least ${n} blocks", ("n",min_blocks_per_segment) );
+   FC_ASSERT( !_settings.compress || compression_supported(), "Compressed block logs are not supported by this build" );
+   fc::json::save_to_file( _settings, _dir / settings_filename );
+
+   _max_segments = size_t( std::numeric_limits<uint32_t>::max() / _settings.blocks_per_segment ) + 1;
+   _segments.reset( new std::atomic<segment*>[_max_segments] );
+   for( size_t i = 0; i < _max_segments; ++i )
+      _segments[i].store( nullptr, std::memory_order_relaxed );
+
+   for( fc::directory_iterator itr( _dir ), end; itr != end; ++itr )
+   {
+      const fc::path file = *itr;
+      if( file.extension() != ".index" )
+         continue;
+      const auto number = uint32_t( std::stoul( file.stem().string() ) );
+      FC_ASSERT( number < _max_segments, "Unexpected segment ${f}", ("f",file) );
+      writable_segment( number );
+   }
+   if( !_owned_segments.empty() )
+      _first_segment.store( _owned_segments.begin()->first );
+} FC_CAPTURE_AND_RETHROW( (dir) ) }
+
+segmented_block_log::~segmented_block_log()
+{
+   try {
+      release_retired_segments();
+   } catch( const fc::exception& e ) {
+      wlog( "Failed to delete pruned block log segments: ${e}", ("e",e.to_detail_string()) );
+   }
+}
+
+void segmented_block_log::flush()
+{
+   for( auto& item : _owned_segments )
+   {
+      item.second->data.flush();
+      item.second->index.flush();
+   }
+}
+
+const segmented_block_log::segment* segmented_block_log::find_segment( uint32_t number )const
+{
+   if( number >= _max_segments )
+      return nullptr;
+   return _segments[number].load( std::memory_order_acquire );
+}
+
+segmented_block_log::segment& segmented_block_log::writable_segment( uint32_t number )
+{
+   auto& result = _owned_segments[number];
+   if( !result )
+   {
+      result = std::make_unique<segment>( _dir, number, _settings.blocks_per_segment );
+      _segments[number].store( result.get(), std::memory_order_release );
+   }
+   return *result;
+}
+
+bool segmented_block_log::read_entry( uint32_t block_num, segment_entry& e )const
+{
+   const segment* seg = find_segment( block_num / _settings.blocks_per_segment );
+   if( seg == nullptr )
+      return false;
+   const uint64_t index_pos = sizeof(e) * uint64_t( block_num % _settings.blocks_per_segment );
+   while( true )
+   {
+      const uint64_t writes = _index_writes.load( std::memory_order_acquire );
+      if( writes % 2 == 0 )
+      {
+         if( !seg->index_view->read( index_pos, sizeof(e), (char*)&e ) )
+            return false;
+         std::atomic_thread_fence( std::memory_order_acquire );
+         if( _index_writes.load( std::memory_order_relaxed ) == writes )
+            return true;
+      }
+      std::this_thread::yield();
+   }
+}
+
+void segmented_block_log::write_entry( uint32_t block_num, const segment_entry& e )
+{
+   segment& seg = writable_segment( block_num / _settings.blocks_per_segment );
+   const uint64_t index_pos = sizeof(e) * uint64_t( block_num % _settings.blocks_per_segment );
+   _index_writes.fetch_add( 1 );
+   try {
+      seg.index.seekp( index_pos );
+      seg.index.write( (const char*)&e, sizeof(e) );
+      seg.index.flush();
+      seg.index_view->resize( std::max( seg.index_view->size(), index_pos + sizeof(e) ) );
+   } catch( ... ) {
+      _index_writes.fetch_add( 1 );
+      throw;
+   }
+   _index_writes.fetch_add( 1 );
+}
+
+void segmented_block_log::read_block( uint32_t block_num, const segment_entry& e, signed_block& result )const
+{
+   const uint32_t number = block_num / _settings.blocks_per_segment;
+   const segment* seg = find_segment( number );
+   FC_ASSERT( seg != nullptr, "Block ${n} is not available", ("n",block_num) );
+
+   const uint64_t pos = e.block_pos.value();
+   const uint32_t size = e.block_size.value();
+   vector<char> buffer;
+   const char* data = seg->data_view->data( pos, size );
+   if( data == nullptr ) // beyond the end of the file or crossing a region boundary
+   {
+      buffer.resize( size );
+      FC_ASSERT( seg->data_view->read( pos, size, buffer.data() ),
+                 "Block ${id} is beyond the end of its segment", ("id",e.block_id) );
+      data = buffer.data();
+   }
+   if( e.raw_size.value() > 0 )
+   {
+      buffer = decompress_block( data, size, e.raw_size.value() );
+      data = buffer.data();
+   }
+
+   result.unpack_from( data, e.raw_size.value() > 0 ? e.raw_size.value() : size );
+   FC_ASSERT( result.id() == e.block_id );
+   _last_read_segment.store( number, std::memory_order_relaxed );
+   _last_read_end.store( pos + size, std::memory_order_relaxed );
+}
+
+vector<char> segmented_block_log::read_packed_block( uint32_t block_num, const segment_entry& e )const
+{
+   const uint32_t number = block_num / _settings.blocks_per_segment;
+   const segment* seg = find_segment( number );
+   FC_ASSERT( seg != nullptr, "Block ${n} is not available", ("n",block_num) );
+
+   const uint64_t pos = e.block_pos.value();
+   const uint32_t size = e.block_size.value();
+   vector<char> result( size );
+   FC_ASSERT( seg->data_view->read( pos, size, result.data() ),
+              "Block ${id} is beyond the end of its segment", ("id",e.block_id) );
+   if( e.raw_size.value() > 0 )
+      result = decompress_block( result.data(), size, e.raw_size.value() );
+   _last_read_segment.store( number, std::memory_order_relaxed );
+   _last_read_end.store( pos + size, std::memory_order_relaxed );
+   return result;
+}
+
+void segmented_block_log::store( const block_id_type& id, const signed_block& b )
+{
+   const uint32_t block_num = block_header::num_from_id( id );
+   segment& seg = writable_segment( block_num / _settings.blocks_per_segment );
+
+   segment_entry e;
+   vector<char> data = fc::raw::pack( b );
+   if( _settings.compress )
+   {
+      vector<char> compressed = compress_block( data );
+      if( compressed.size() < data.size() )
+      {
+         e.raw_size = data.size();
+         data = std::move( compressed );
+      }
+   }
+   seg.data.seekp( 0, seg.data.end );
+   e.block_pos  = seg.data.tellp();
+   e.block_size = data.size();
+   e.block_id   = id;
+   seg.data.write( data.data(), data.size() );
+   // the data must be in the file before readers can find it through the index
+   seg.data.flush();
+   seg.data_view->resize( e.block_pos.value() + data.size() );
+   write_entry( block_num, e );
+}
+
+void segmented_block_log::remove( const block_id_type& id )
+{
+   segment_entry e;
+   if( !read_entry( block_header::num_from_id(id), e ) )
+      FC_THROW_EXCEPTION( fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id) );
+
+   if( e.block_id == id )
+   {
+      e.block_size = 0;
+      write_entry( block_header::num_from_id(id), e );
+   }
+}
+
+bool segmented_block_log::contains( const block_id_type& id )const
+{
+   segment_entry e;
+   return read_entry( block_header::num_from_id(id), e ) && e.block_id == id && e.block_size.value() > 0;
+}
+
+optional<block_id_type> segmented_block_log::fetch_block_id( uint32_t block_num )const
+{
+   segment_entry e;
+   if( !read_entry( block_num, e ) )
+      return {};
+   return e.block_id;
+}
+
+optional<signed_block> segmented_block_log::fetch_optional( const block_id_type& id )const
+{
+   try
+   {
+      segment_entry e;
+      if( !read_entry( block_header::num_from_id(id), e ) || e.block_id != id )
+         return {};
+      signed_block result;
+      read_block( block_header::num_from_id(id), e, result );
+      return result;
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return {};
+}
+
+optional<vector<char>> segmented_block_log::fetch_packed_by_number( uint32_t block_num )const
+{
+   try
+   {
+      segment_entry e;
+      if( !read_entry( block_num, e ) || e.block_size.value() == 0 )
+         return {};
+      return read_packed_block( block_num, e );
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return {};
+}
+
+optional<signed_block> segmented_block_log::fetch_by_number( uint32_t block_num )const
+{
+   signed_block result;
+   if( !fetch_by_number( block_num, result ) )
+      return {};
+   return result;
+}
+
+bool segmented_block_log::fetch_by_number( uint32_t block_num, signed_block& result )const
+{
+   try
+   {
+      segment_entry e;
+      if( !read_entry( block_num, e ) )
+         return false;
+      read_block( block_num, e, result );
+      return true;
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return false;
+}
+
+optional<block_id_type> segmented_block_log::last_id()
+{
+   // segments which become empty are kept, readers might still be looking into them
+   for( auto itr = _owned_segments.rbegin(); itr != _owned_segments.rend(); ++itr )
+   {
+      segment& seg = *itr->second;
+      uint64_t pos = seg.index_view->size();
+      pos -= pos % sizeof(segment_entry);
+      while( pos > 0 )
+      {
+         pos -= sizeof(segment_entry);
+         const uint32_t block_num = seg.number * _settings.blocks_per_segment + uint32_t( pos / sizeof(segment_entry) );
+         segment_entry e;
+         if( seg.index_view->read( pos, sizeof(e), (char*)&e ) && e.block_size.value() > 0 )
+            try
+            {
+               signed_block block;
+               read_block( block_num, e, block );
+               return e.block_id;
+            }
+            catch (const fc::exception&)
+            {
+            }
+            catch (const std::exception&)
+            {
+            }
+         // readers must not touch the truncated part of the mapping
+         seg.index_view->resize( pos );
+         fc::resize_file( seg.index_path, pos );
+      }
+   }
+   return {};
+}
+
+void segmented_block_log::prune( uint32_t first_kept_block )
+{
+   const uint32_t first_kept_segment = first_kept_block / _settings.blocks_per_segment;
+   if( _owned_segments.empty() || _owned_segments.begin()->first >= first_kept_segment )
+      return;
+   release_retired_segments();
+   // a reader which finds the first segment has to see the new first block number
+   _first_segment.store( first_kept_segment );
+   while( !_owned_segments.empty() && _owned_segments.begin()->first < first_kept_segment )
+   {
+      _segments[ _owned_segments.begin()->first ].store( nullptr, std::memory_order_release );
+      _retired_segments.push_back( std::move( _owned_segments.begin()->second ) );
+      _owned_segments.erase( _owned_segments.begin() );
+   }
+   ilog( "Pruned the block log up to block ${n}", ("n",first_kept_segment * _settings.blocks_per_segment) );
+}
+
+void segmented_block_log::release_retired_segments()
+{
+   for( auto& seg : _retired_segments )
+   {
+      const fc::path data_path = seg->data_path;
+      const fc::path index_path = seg->index_path;
+      seg.reset();
+      fc::remove( data_path );
+      fc::remove( index_path );
+   }
+   _retired_segments.clear();
+}
+
+uint32_t segmented_block_log::first_block_num()const
+{
+   return std::max( 1u, _first_segment.load() * _settings.blocks_per_segment );
+}
+
+uint64_t segmented_block_log::total_block_size()const
+{
+   uint64_t result = 0;
+   for( size_t number = 0; number < _max_segments; ++number )
+   {
+      const segment* seg = find_segment( number );
+      if( seg != nullptr )
+         result += seg->data_view->size();
+   }
+   return result;
+}
+
+uint64_t segmented_block_log::blocks_current_position()const
+{
+   const uint64_t number = _last_read_segment.load( std::memory_order_relaxed );
+   if( number != _progress_segment )
+   {
+      _progress_segment = number;
+      _progress_offset = 0;
+      for( uint64_t i = 0; i < number; ++i )
+      {
+         const segment* seg = find_segment( i );
+         if( seg != nullptr )
+            _progress_offset += seg->data_view->size();
+      }
+   }
+   return _progress_offset + _last_read_end.load( std::memory_order_relaxed );
+}
+
+} }
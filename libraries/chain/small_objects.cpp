@@ -48,6 +48,32 @@
 
 #include <fc/io/raw.hpp>
 
+namespace graphene { namespace chain {
+
+void tapos_prefix_index::object_inserted( const object& obj )
+{
+   object_modified( obj );
+}
+
+void tapos_prefix_index::object_removed( const object& obj )
+{
+   const auto instance = obj.id.instance();
+   if( instance < _prefixes.size() )
+      _prefixes[instance] = 0;
+}
+
+void tapos_prefix_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const block_summary_object*>(&after) );
+   const block_summary_object& summary = static_cast<const block_summary_object&>(after);
+   const auto instance = summary.id.instance();
+   if( instance >= _prefixes.size() )
+      _prefixes.resize( instance + 1 );
+   _prefixes[instance] = summary.block_id._hash[1].value();
+}
+
+} } // graphene::chain
+
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::balance_object, (graphene::db::object),
                     (owner)(balance)(vesting_policy)(last_claim_date) )
 
@@ -150,7 +176,8 @@ FC_REFLECT_DERIVED_NO_TYPENAME(
    (account)
 )
 
-FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::transaction_history_object, (graphene::db::object), (trx)(trx_id) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::transaction_history_object, (graphene::db::object),
+                                (trx_id)(expiration)(trx) )
 
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::withdraw_permission_object, (graphene::db::object),
                     (withdraw_from_account)
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/db/index.hpp>
+
+namespace graphene { namespace db {
+
+   /**
+    * @class background_populated_index
+    * @brief A secondary index which is filled with the existing objects of its primary index a few at a time
+    *
+    * The objects are added in the order of their IDs by @ref populate, which is meant to be called repeatedly
+    * by a background task while the node is already running. Until then the wrapped index is only notified
+    * about the objects which it has already been given: a change to any other object is ignored, and the object
+    * is added in its current state when the population reaches it. So the index always contains exactly the
+    * objects with an ID below the population cursor, and all objects once @ref is_populated returns true.
+    *
+    * The class derives from the wrapped index, so @ref base_primary_index::get_secondary_index still finds it
+    * by the type of the wrapped index.
+    *
+    * @note @ref populate must not be called while a secondary index batch is active, otherwise the deferred
+    *       notifications of the batch would not match the objects which were added meanwhile.
+    */
+   template<typename IndexType, typename SecondaryIndexType>
+   class background_populated_index : public SecondaryIndexType
+   {
+      public:
+         template<typename... Args>
+         explicit background_populated_index( const IndexType* primary, Args... args )
+            : SecondaryIndexType( args... ), _primary( primary ) {}
+
+         void object_inserted( const object& obj ) override
+         {
+            if( is_added( obj ) )
+               SecondaryIndexType::object_inserted( obj );
+         }
+         void object_removed( const object& obj ) override
+         {
+            if( is_added( obj ) )
+               SecondaryIndexType::object_removed( obj );
+         }
+         void about_to_modify( const object& before ) override
+         {
+            if( is_added( before ) )
+               SecondaryIndexType::about_to_modify( before );
+         }
+         void object_modified( const object& after ) override
+         {
+            if( is_added( after ) )
+               SecondaryIndexType::object_modified( after );
+         }
+
+         bool is_populated()const override { return _populated; }
+
+         /**
+          * Adds up to @p max_objects of the objects which are not in the index yet
+          * @return true if the index contains all objects now
+          */
+         bool populate( size_t max_objects )
+         {
+            if( _populated )
+               return true;
+            const auto& objects = _primary->indices();
+            auto itr = objects.lower_bound( _cursor );
+            for( ; itr != objects.end() && max_objects > 0; ++itr, --max_objects )
+               SecondaryIndexType::object_inserted( *itr );
+            if( itr == objects.end() )
+               _populated = true;
+            else
+               _cursor = itr->id;
+            return _populated;
+         }
+
+      private:
+         bool is_added( const object& obj )const { return _populated || obj.id < _cursor; }
+
+         const IndexType* _primary;
+         /// the ID of the first object which has not been added yet
+         object_id_type   _cursor;
+         bool             _populated = false;
+   };
+
+} } // graphene::db
@@ -23,10 +23,14 @@
  */
 #pragma once
 #include <graphene/db/index.hpp>
+#include <graphene/db/node_pool.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/mpl/size.hpp>
+
+#include <type_traits>
 
 namespace graphene { namespace db {
 
@@ -34,18 +38,42 @@ namespace graphene { namespace db {
    using namespace boost::multi_index;
 
    struct by_id;
+
+   namespace detail {
+      /// The multi_index_container with the same values and indices as MultiIndexType and another allocator
+      template<typename MultiIndexType, typename Allocator>
+      struct with_allocator;
+
+      template<typename Value, typename IndexSpecifierList, typename OldAllocator, typename Allocator>
+      struct with_allocator< multi_index_container<Value, IndexSpecifierList, OldAllocator>, Allocator >
+      {
+         typedef multi_index_container<Value, IndexSpecifierList, Allocator> type;
+      };
+   }
+
    /**
     *  Almost all objects can be tracked and managed via a boost::multi_index container that uses
     *  an unordered_unique key on the object ID.  This template class adapts the generic index interface
     *  to work with arbitrary boost multi_index containers on the same type.
+    *
+    *  If PooledNodes is true, the nodes of the container are taken from a @ref slab_pool owned by the index, so
+    *  that the objects are packed together in memory instead of being scattered over the heap.  The index_type
+    *  then differs from MultiIndexType in its allocator, its iterators can not be mixed with those of
+    *  MultiIndexType.
     */
-   template<typename ObjectType, typename MultiIndexType>
+   template<typename ObjectType, typename MultiIndexType, bool PooledNodes = false>
    class generic_index : public index
    {
       public:
-         typedef MultiIndexType index_type;
+         typedef typename std::conditional< PooledNodes,
+                    typename detail::with_allocator< MultiIndexType, slab_allocator<ObjectType> >::type,
+                    MultiIndexType >::type index_type;
          typedef ObjectType     object_type;
 
+         generic_index()
+         : _indices( typename index_type::ctor_args_list(),
+                     make_allocator( _node_pool, std::integral_constant<bool, PooledNodes>() ) ) {}
+
          virtual const object& insert( object&& obj )override
          {
             assert( nullptr != dynamic_cast<ObjectType*>(&obj) );
@@ -68,8 +96,14 @@ namespace graphene { namespace db {
          virtual void modify( const object& obj, const std::function<void(object&)>& m )override
          {
             assert(nullptr != dynamic_cast<const ObjectType*>(&obj));
+            modify_in_place( static_cast<const ObjectType&>(obj), m );
+         }
+
+         template<typename Lambda>
+         void modify_in_place( const ObjectType& obj, const Lambda& m )
+         {
             std::exception_ptr exc;
-            auto ok = _indices.modify(_indices.iterator_to(static_cast<const ObjectType&>(obj)),
+            auto ok = _indices.modify(_indices.iterator_to(obj),
                                        [&m, &exc](ObjectType& o) mutable {
                                           try {
                                              m(o);
@@ -112,7 +146,26 @@ namespace graphene { namespace db {
 
          const index_type& indices()const { return _indices; }
 
+         virtual size_t object_count()const override { return _indices.size(); }
+
+         /// Every node of a multi_index_container holds the object and about three pointers per ordered index
+         virtual size_t object_node_size()const override
+         {
+            if( _node_pool.block_size() > 0 )
+               return _node_pool.block_size();
+            return sizeof(ObjectType)
+                   + boost::mpl::size< typename MultiIndexType::index_type_list >::value * 3 * sizeof(void*);
+         }
+
+         virtual size_t object_pool_reserved_bytes()const override { return _node_pool.reserved_bytes(); }
+
       private:
+         static typename index_type::allocator_type make_allocator( slab_pool& pool, std::true_type )
+         { return typename index_type::allocator_type( pool ); }
+         static typename index_type::allocator_type make_allocator( slab_pool&, std::false_type )
+         { return typename index_type::allocator_type(); }
+
+         slab_pool   _node_pool; // must be declared before _indices to outlive it
          index_type  _indices;
    };
 
@@ -30,6 +30,9 @@
 #include <fc/crypto/sha256.hpp>
 
 #include <fstream>
+#include <functional>
+#include <map>
+#include <set>
 #include <stack>
 
 namespace graphene { namespace db {
@@ -52,6 +55,37 @@ namespace graphene { namespace db {
          virtual void on_modify( const object& obj ){}
    };
 
+   /**
+    * @return a hash of the structure of prototype, i.e. of the names of its members and the kinds of their values,
+    *         recursively
+    */
+   fc::sha256 get_schema_version( const fc::variant& prototype );
+
+   /**
+    * @class index_loader
+    * @brief Reads the saved content of an index in several steps, so that object_database::open can spread the
+    *        work over multiple threads
+    *
+    * The saved objects are split into ranges. Different ranges can be unpacked concurrently, but the unpacked
+    * ranges must be inserted one at a time. After all ranges have been inserted, the secondary indexes of the
+    * index are populated, different secondary indexes can be populated concurrently.
+    */
+   class index_loader
+   {
+      public:
+         virtual ~index_loader(){}
+
+         virtual size_t range_count()const = 0;
+         /** unpacks the objects of the given range into memory */
+         virtual void   unpack_range( size_t range ) = 0;
+         /** inserts the unpacked objects of the given range into the index, without notifying secondary indexes */
+         virtual void   insert_range( size_t range ) = 0;
+
+         virtual size_t secondary_index_count()const = 0;
+         /** notifies the given secondary index of all objects in the index */
+         virtual void   populate_secondary_index( size_t sindex ) = 0;
+   };
+
    /**
     *  @class index
     *  @brief abstract base class for accessing objects indexed in various ways.
@@ -80,7 +114,23 @@ namespace graphene { namespace db {
          virtual void           use_next_id() = 0;
          virtual void           set_next_id( object_id_type id ) = 0;
 
+         /**
+          *  @return a counter which is incremented whenever an object of this index is added, modified or removed,
+          *          including changes made by undo. It is not persisted and starts at 0 for a new index.
+          */
+         virtual uint64_t       change_count()const = 0;
+
          virtual const object&  load( const std::vector<char>& data ) = 0;
+         /**
+          *  Replaces the object with the given id by the serialized object in data, or removes it if data is empty.
+          *  Like @ref load, this bypasses undo tracking and observers, it is meant for reading the database from disk.
+          *  @param version the version of the object format data was saved with, see @ref get_object_version
+          */
+         virtual void           reload( object_id_type id, const std::vector<char>& data,
+                                        const fc::sha256& version ) = 0;
+
+         /** @return a fingerprint of the format in which the objects of this index are saved */
+         virtual fc::sha256     get_object_version()const = 0;
          /**
           *  Polymorphically insert by moving an object into the index.
           *  this should throw if the object is already in the database.
@@ -97,6 +147,8 @@ namespace graphene { namespace db {
           *  Opens the index loading objects from a file
           */
          virtual void open( const fc::path& db ) = 0;
+         /** @return a loader for the content saved in db, or nullptr if there is nothing to load */
+         virtual unique_ptr<index_loader> start_open( const fc::path& db ) = 0;
          virtual void save( const fc::path& db ) = 0;
 
 
@@ -133,7 +185,24 @@ namespace graphene { namespace db {
          virtual void               add_observer( const shared_ptr<index_observer>& ) = 0;
 
          virtual void               object_from_variant( const fc::variant& var, object& obj, uint32_t max_depth )const = 0;
+         /** Replaces the content of obj, except for its id, by the object serialized with fc::raw in data */
+         virtual void               object_from_packed( const std::vector<char>& data, object& obj )const = 0;
          virtual void               object_default( object& obj )const = 0;
+
+         /// Memory accounting, all sizes are estimates
+         /// @{
+         /** @return the number of objects in this index */
+         virtual size_t             object_count()const = 0;
+         /**
+          * @return the number of bytes taken by one object of this index including the overhead of the container
+          *         holding it, memory owned by the members of the object (e.g. strings and vectors) is not included
+          */
+         virtual size_t             object_node_size()const = 0;
+         /** @return the number of bytes held by the secondary indexes, see @ref secondary_index::memory_usage */
+         virtual size_t             secondary_index_memory_usage()const = 0;
+         /** @return the number of bytes reserved by the node pool of the objects, zero if they are not pooled */
+         virtual size_t             object_pool_reserved_bytes()const { return 0; }
+         /// @}
    };
 
    class secondary_index
@@ -144,6 +213,27 @@ namespace graphene { namespace db {
          virtual void object_removed( const object& obj ){};
          virtual void about_to_modify( const object& before ){};
          virtual void object_modified( const object& after  ){};
+
+         /**
+          * @return true if notifications for this index may be collected and delivered once at the end of a
+          *         secondary index batch, see @ref object_database::begin_secondary_index_batch
+          *
+          * Deferred notifications are coalesced: an object which is modified several times within a batch is
+          * reported with a single about_to_modify / object_modified pair, and an object which is created and
+          * removed within a batch is not reported at all. The "before" object passed to @ref about_to_modify and
+          * @ref object_removed may be a copy, so a deferrable index must only depend on the contents of the
+          * objects and must not keep pointers to them. It must also not be used for consensus.
+          */
+         virtual bool is_deferrable()const { return false; }
+
+         /**
+          * @return false while the index is still being filled with the existing objects of its primary index,
+          *         see @ref background_populated_index
+          */
+         virtual bool is_populated()const { return true; }
+
+         /** @return an estimate of the heap memory held by this index in bytes, or 0 if it is not known */
+         virtual size_t memory_usage()const { return 0; }
    };
 
    /**
@@ -160,6 +250,9 @@ namespace graphene { namespace db {
          /** called just after the object is added */
          void on_add( const object& obj );
 
+         /** called just before the next id is advanced without creating an object */
+         void on_reserve_id( object_id_type id );
+
          /** called just before obj is removed */
          void on_remove( const object& obj );
 
@@ -170,7 +263,12 @@ namespace graphene { namespace db {
          T* add_secondary_index(Args... args)
          {
             _sindex.emplace_back( std::make_unique<T>(args...) );
-            return static_cast<T*>(_sindex.back().get());
+            T* result = static_cast<T*>(_sindex.back().get());
+            if( result->is_deferrable() )
+               _deferred_sindex.push_back( result );
+            else
+               _immediate_sindex.push_back( result );
+            return result;
          }
 
          template<typename T>
@@ -184,12 +282,34 @@ namespace graphene { namespace db {
             FC_THROW_EXCEPTION( fc::assert_exception, "invalid index type" );
          }
 
+         /** delivers the notifications collected for deferrable secondary indexes during a batch */
+         void flush_deferred();
+
+         /** @return the number of additions, modifications and removals seen by this index */
+         uint64_t changes()const { return _change_count; }
+
       protected:
+         /// These forward to the deferrable secondary indexes, or queue the change while a batch is active
+         /// @{
+         void deferred_inserted( const object& obj );
+         void deferred_about_to_modify( const object& before );
+         void deferred_modified( const object& after );
+         void deferred_removed( const object& obj );
+         /// @}
+
          vector< shared_ptr<index_observer> >   _observers;
          vector< unique_ptr<secondary_index> >  _sindex;
+         vector< secondary_index* >             _immediate_sindex;
+         vector< secondary_index* >             _deferred_sindex;
+         uint64_t                               _change_count = 0;
 
       private:
          object_database& _db;
+
+         /** objects created during the current batch */
+         std::set< object_id_type >                        _pending_inserts;
+         /** objects modified during the current batch, mapped to their state before the first modification */
+         std::map< object_id_type, unique_ptr<object> >    _pending_modifies;
    };
 
    /** @class direct_index
@@ -296,6 +416,160 @@ namespace graphene { namespace db {
             if( id.instance() >= next ) return nullptr;
             return content[id.instance() >> chunkbits][id.instance() & ((1ULL << chunkbits) - 1)];
          };
+
+         virtual size_t memory_usage()const override
+         {
+            return content.capacity() * sizeof( vector< const Object* > )
+                   + content.size() * ( 1ULL << chunkbits ) * sizeof( const Object* );
+         }
+   };
+
+   /** @class flat_direct_index
+    *  @brief A secondary index that tracks objects in fixed-size chunks of pointers indexed by object instance.
+    *
+    *  Functionally a replacement for @ref direct_index, with two differences:
+    *  - chunks are allocated on the first insert into them and released when their last object is removed,
+    *    so sparse id ranges (e.g. after many objects have been removed) neither fail nor waste memory;
+    *  - every insert is tagged with a generation number that is unique within the index, which allows
+    *    callers to hold on to a @ref handle across blocks and cheaply detect that the object it referred to
+    *    has been removed or replaced (for example by an undo).
+    */
+   template<typename Object, uint8_t chunkbits>
+   class flat_direct_index : public secondary_index
+   {
+      static_assert( chunkbits < 32, "Do you really want chunks with more than 2^31 elements???" );
+
+      public:
+         struct handle
+         {
+            uint64_t instance   = 0;
+            uint64_t generation = 0;
+         };
+
+         virtual void object_inserted( const object& obj ) override
+         {
+            FC_ASSERT( nullptr != dynamic_cast<const Object*>(&obj), "Wrong object type!" );
+            const uint64_t instance = obj.id.instance();
+            const uint64_t c = instance >> chunkbits;
+            if( c >= _chunks.size() )
+               _chunks.resize( c + 1 );
+            if( !_chunks[c].slots )
+            {
+               _chunks[c].slots.reset( new slot[ 1ULL << chunkbits ] );
+               ++_allocated_chunks;
+            }
+            slot& s = _chunks[c].slots[ instance & _mask ];
+            FC_ASSERT( s.ptr == nullptr, "Overwriting insert at ${id}!", ("id",obj.id) );
+            s.ptr = static_cast<const Object*>( &obj );
+            s.generation = ++_last_generation;
+            ++_chunks[c].used;
+            ++_size;
+         }
+
+         virtual void object_removed( const object& obj ) override
+         {
+            FC_ASSERT( nullptr != dynamic_cast<const Object*>(&obj), "Wrong object type!" );
+            slot* s = find_slot( obj.id.instance() );
+            FC_ASSERT( s != nullptr && s->ptr != nullptr, "Removing non-existent object ${id}!", ("id",obj.id) );
+            s->ptr = nullptr;
+            s->generation = 0;
+            --_size;
+            chunk& c = _chunks[ obj.id.instance() >> chunkbits ];
+            if( --c.used == 0 )
+            {
+               c.slots.reset();
+               --_allocated_chunks;
+            }
+         }
+
+         virtual void about_to_modify( const object& before ) override
+         {
+            ids_being_modified.emplace( before.id );
+         }
+
+         virtual void object_modified( const object& after  ) override
+         {
+            FC_ASSERT( ids_being_modified.top() == after.id, "Modification of ID is not supported!");
+            ids_being_modified.pop();
+         }
+
+         template< typename object_id >
+         const Object* find( const object_id& id )const
+         {
+            static_assert( object_id::space_id == Object::space_id, "Space ID mismatch!" );
+            static_assert( object_id::type_id == Object::type_id, "Type_ID mismatch!" );
+            const slot* s = find_slot( id.instance.value );
+            return s ? s->ptr : nullptr;
+         }
+
+         template< typename object_id >
+         const Object& get( const object_id& id )const
+         {
+            const Object* ptr = find( id );
+            FC_ASSERT( ptr != nullptr, "Object not found!" );
+            return *ptr;
+         }
+
+         const Object* find( const object_id_type& id )const
+         {
+            FC_ASSERT( id.space() == Object::space_id, "Space ID mismatch!" );
+            FC_ASSERT( id.type() == Object::type_id, "Type_ID mismatch!" );
+            const slot* s = find_slot( id.instance() );
+            return s ? s->ptr : nullptr;
+         }
+
+         /** @return a handle to the object with the given id, which must exist */
+         handle get_handle( const object_id_type& id )const
+         {
+            FC_ASSERT( find( id ) != nullptr, "Object not found!" );
+            return { id.instance(), find_slot( id.instance() )->generation };
+         }
+
+         /** @return the object referred to by h, or nullptr if it has been removed or replaced meanwhile */
+         const Object* find( const handle& h )const
+         {
+            const slot* s = find_slot( h.instance );
+            return ( s && s->ptr && s->generation == h.generation ) ? s->ptr : nullptr;
+         }
+
+         /** @return the number of tracked objects */
+         size_t size()const { return _size; }
+
+         virtual size_t memory_usage()const override
+         {
+            return _chunks.capacity() * sizeof( chunk ) + _allocated_chunks * ( 1ULL << chunkbits ) * sizeof( slot );
+         }
+
+      private:
+         static const uint64_t _mask = ((1ULL << chunkbits) - 1);
+
+         struct slot
+         {
+            const Object* ptr        = nullptr;
+            uint64_t      generation = 0;
+         };
+         struct chunk
+         {
+            std::unique_ptr<slot[]> slots;
+            uint64_t                used = 0;
+         };
+
+         const slot* find_slot( uint64_t instance )const
+         {
+            const uint64_t c = instance >> chunkbits;
+            if( c >= _chunks.size() || !_chunks[c].slots ) return nullptr;
+            return &_chunks[c].slots[ instance & _mask ];
+         }
+         slot* find_slot( uint64_t instance )
+         {
+            return const_cast<slot*>( static_cast<const flat_direct_index*>(this)->find_slot( instance ) );
+         }
+
+         vector< chunk >              _chunks;
+         size_t                       _allocated_chunks = 0;
+         size_t                       _size = 0;
+         uint64_t                     _last_generation = 0;
+         std::stack< object_id_type > ids_being_modified;
    };
 
    /**
@@ -303,9 +577,13 @@ namespace graphene { namespace db {
     * @brief  Wraps a derived index to intercept calls to create, modify, and remove so that
     *  callbacks may be fired and undo state saved.
     *
+    *  If DirectBits is non-zero, objects are also tracked in a DirectIndex< object_type, DirectBits > secondary
+    *  index (@ref direct_index or @ref flat_direct_index) which is used for lookups by id.
+    *
     *  @see http://en.wikipedia.org/wiki/Curiously_recurring_template_pattern
     */
-   template<typename DerivedIndex, uint8_t DirectBits = 0>
+   template<typename DerivedIndex, uint8_t DirectBits = 0,
+            template<typename, uint8_t> class DirectIndex = direct_index>
    class primary_index  : public DerivedIndex, public base_primary_index
    {
       public:
@@ -315,7 +593,7 @@ namespace graphene { namespace db {
          :base_primary_index(db),_next_id(object_type::space_id,object_type::type_id,0)
          {
             if( DirectBits > 0 )
-               _direct_by_id = add_secondary_index< direct_index< object_type, DirectBits > >();
+               _direct_by_id = add_secondary_index< DirectIndex< object_type, DirectBits > >();
          }
 
          virtual uint8_t object_space_id()const override
@@ -327,6 +605,20 @@ namespace graphene { namespace db {
          virtual object_id_type get_next_id()const override              { return _next_id;    }
          virtual void           use_next_id()override                    { ++_next_id.number;  }
          virtual void           set_next_id( object_id_type id )override { _next_id = id;      }
+         virtual uint64_t       change_count()const override             { return changes();   }
+
+         /**
+          * Skips the next id without creating an object, e.g. for objects which a plugin chose not to store.
+          * The id is handed out again if the current undo session is undone.
+          * @return the reserved id
+          */
+         object_id_type reserve_next_id()
+         {
+            const object_id_type id = _next_id;
+            on_reserve_id( id );
+            use_next_id();
+            return id;
+         }
 
          /** @return the object with id or nullptr if not found */
          virtual const object*  find( object_id_type id )const override
@@ -336,29 +628,51 @@ namespace graphene { namespace db {
             return DerivedIndex::find( id );
          }
 
-         fc::sha256 get_object_version()const
+         /**
+          * The version is derived from the reflected members of object_type, so it changes whenever members are
+          * added, removed, renamed or reordered, and only for the affected object types.
+          * @note Changing the type of a member to another one with the same kind of variant representation (e.g.
+          *       from uint16_t to uint32_t) is not detected.
+          */
+         virtual fc::sha256 get_object_version()const override
          {
-            std::string desc = "1.0";//get_type_description<object_type>();
-            return fc::sha256::hash(desc);
+            static const fc::sha256 version = [](){
+               fc::variant prototype;
+               fc::to_variant( object_type(), prototype, FC_PACK_MAX_DEPTH );
+               return get_schema_version( prototype );
+            }();
+            return version;
+         }
+
+         /**
+          * Reads an object which has been saved in the format of an older version, the data stream holds exactly
+          * the packed object
+          */
+         typedef std::function< void( fc::datastream<const char*>& ds, object_type& obj ) > migration_type;
+
+         /** Allows to load objects which have been saved in the format identified by old_version */
+         void add_migration( const fc::sha256& old_version, migration_type migration )
+         {
+            _migrations[old_version] = std::move( migration );
          }
 
          virtual void open( const path& db )override
-         { 
-            if( !fc::exists( db ) ) return;
-            fc::file_mapping fm( db.generic_string().c_str(), fc::read_only );
-            fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(db) );
-            fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
-            fc::sha256 open_ver;
-
-            fc::raw::unpack(ds, _next_id);
-            fc::raw::unpack(ds, open_ver);
-            FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
-            vector<char> tmp;
-            while( ds.remaining() > 0 )
+         {
+            auto loader = start_open( db );
+            if( !loader ) return;
+            for( size_t range = 0; range < loader->range_count(); ++range )
             {
-               fc::raw::unpack( ds, tmp );
-               load( tmp );
+               loader->unpack_range( range );
+               loader->insert_range( range );
             }
+            for( size_t sindex = 0; sindex < loader->secondary_index_count(); ++sindex )
+               loader->populate_secondary_index( sindex );
+         }
+
+         virtual unique_ptr<index_loader> start_open( const path& db )override
+         {
+            if( !fc::exists( db ) ) return nullptr;
+            return std::make_unique<loader>( *this, db );
          }
 
          virtual void save( const path& db ) override 
@@ -378,18 +692,35 @@ namespace graphene { namespace db {
 
          virtual const object&  load( const std::vector<char>& data )override
          {
-            const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
-            for( const auto& item : _sindex )
-               item->object_inserted( result );
-            return result;
+            return load_object( fc::raw::unpack<object_type>( data ) );
+         }
+
+         virtual void reload( object_id_type id, const std::vector<char>& data, const fc::sha256& version )override
+         {
+            ++_change_count;
+            const object* existing = DerivedIndex::find( id );
+            if( existing != nullptr )
+            {
+               for( const auto& item : _sindex )
+                  item->object_removed( *existing );
+               DerivedIndex::remove( *existing );
+            }
+            if( data.empty() )
+               return;
+            fc::datastream<const char*> ds( data.data(), data.size() );
+            object_type obj;
+            unpack_object( ds, obj, version );
+            load_object( std::move( obj ) );
          }
 
 
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
             const auto& result = DerivedIndex::create( constructor );
-            for( const auto& item : _sindex )
+            for( const auto& item : _immediate_sindex )
                item->object_inserted( result );
+            if( !_deferred_sindex.empty() )
+               deferred_inserted( result );
             on_add( result );
             return result;
          }
@@ -397,29 +728,39 @@ namespace graphene { namespace db {
          virtual const object& insert( object&& obj ) override
          {
             const auto& result = DerivedIndex::insert( std::move( obj ) );
-            for( const auto& item : _sindex )
+            for( const auto& item : _immediate_sindex )
                item->object_inserted( result );
+            if( !_deferred_sindex.empty() )
+               deferred_inserted( result );
             on_add( result );
             return result;
          }
 
          virtual void  remove( const object& obj ) override
          {
-            for( const auto& item : _sindex )
+            for( const auto& item : _immediate_sindex )
                item->object_removed( obj );
+            if( !_deferred_sindex.empty() )
+               deferred_removed( obj );
             on_remove(obj);
             DerivedIndex::remove(obj);
          }
 
          virtual void modify( const object& obj, const std::function<void(object&)>& m )override
          {
-            save_undo( obj );
-            for( const auto& item : _sindex )
-               item->about_to_modify( obj );
-            DerivedIndex::modify( obj, m );
-            for( const auto& item : _sindex )
-               item->object_modified( obj );
-            on_modify( obj );
+            modify_with( obj, [this,&obj,&m]() { DerivedIndex::modify( obj, m ); } );
+         }
+
+         /**
+          * Statically dispatched version of @ref modify which calls the lambda directly instead of wrapping it in
+          * a std::function. This is used by object_database::modify for objects whose index type is known at
+          * compile time, see @ref MAP_OBJECT_TO_PRIMARY_INDEX.
+          * @note Lambda should have the signature:  void(object_type&)
+          */
+         template<typename Lambda>
+         void static_modify( const object_type& obj, const Lambda& m )
+         {
+            modify_with( obj, [this,&obj,&m]() { DerivedIndex::modify_in_place( obj, m ); } );
          }
 
          virtual void add_observer( const shared_ptr<index_observer>& o ) override
@@ -436,6 +777,15 @@ namespace graphene { namespace db {
             obj.id = id;
          }
 
+         virtual void object_from_packed( const std::vector<char>& data, object& obj )const override
+         {
+            object_id_type id = obj.id;
+            object_type* result = dynamic_cast<object_type*>( &obj );
+            FC_ASSERT( result != nullptr );
+            fc::raw::unpack( data, *result );
+            obj.id = id;
+         }
+
          virtual void object_default( object& obj )const override
          {
             object_id_type id = obj.id;
@@ -445,9 +795,159 @@ namespace graphene { namespace db {
             obj.id = id;
          }
 
+         virtual size_t secondary_index_memory_usage()const override
+         {
+            size_t result = 0;
+            for( const auto& item : _sindex )
+               result += item->memory_usage();
+            return result;
+         }
+
       private:
+         void check_version( const fc::sha256& version )const
+         {
+            FC_ASSERT( version == get_object_version() || _migrations.find( version ) != _migrations.end(),
+                       "Incompatible Version, the serialization of objects in this index has changed" );
+         }
+
+         void unpack_object( fc::datastream<const char*>& ds, object_type& obj, const fc::sha256& version )const
+         {
+            if( version == get_object_version() )
+            {
+               fc::raw::unpack( ds, obj );
+               return;
+            }
+            check_version( version );
+            _migrations.find( version )->second( ds, obj );
+         }
+
+         class loader : public index_loader
+         {
+            public:
+               static constexpr size_t objects_per_range = 64 * 1024;
+
+               loader( primary_index& idx, const path& db )
+               : _idx( idx ), _db( db ),
+                 _file( db.generic_string().c_str(), fc::read_only ),
+                 _region( _file, fc::read_only, 0, fc::file_size(db) )
+               {
+                  fc::datastream<const char*> ds( data(), _region.get_size() );
+
+                  fc::raw::unpack(ds, _idx._next_id);
+                  fc::raw::unpack(ds, _version);
+                  _idx.check_version( _version );
+                  // Every record is a packed vector<char> holding the packed object. Only the size prefixes are
+                  // read here, the objects are later unpacked straight from the mapping without copying the records.
+                  size_t count = 0;
+                  while( ds.remaining() > 0 )
+                  {
+                     if( count % objects_per_range == 0 )
+                        _ranges.push_back( { _region.get_size() - ds.remaining(), 0 } );
+                     fc::unsigned_int size;
+                     fc::raw::unpack( ds, size );
+                     FC_ASSERT( size.value <= ds.remaining(), "Truncated object in ${db}", ("db",db) );
+                     ds.skip( size.value );
+                     ++_ranges.back().count;
+                     ++count;
+                  }
+                  _objects.resize( _ranges.size() );
+               }
+
+               virtual size_t range_count()const override { return _ranges.size(); }
+
+               virtual void unpack_range( size_t range ) override
+               {
+                  const size_t begin = _ranges[range].offset;
+                  fc::datastream<const char*> ds( data() + begin, _region.get_size() - begin );
+                  auto& objects = _objects[range];
+                  objects.resize( _ranges[range].count );
+                  for( auto& obj : objects )
+                  {
+                     fc::unsigned_int size;
+                     fc::raw::unpack( ds, size );
+                     fc::datastream<const char*> record( data() + ( _region.get_size() - ds.remaining() ),
+                                                         size.value );
+                     _idx.unpack_object( record, obj, _version );
+                     FC_ASSERT( record.remaining() == 0, "Corrupted object ${id} in ${db}", ("id",obj.id)("db",_db) );
+                     ds.skip( size.value );
+                  }
+               }
+
+               virtual void insert_range( size_t range ) override
+               {
+                  for( auto& obj : _objects[range] )
+                     _idx.DerivedIndex::insert( std::move( obj ) );
+                  vector<object_type>().swap( _objects[range] );
+               }
+
+               virtual size_t secondary_index_count()const override { return _idx._sindex.size(); }
+
+               virtual void populate_secondary_index( size_t sindex ) override
+               {
+                  secondary_index& item = *_idx._sindex[sindex];
+                  _idx.inspect_all_objects( [&item]( const object& o ) { item.object_inserted( o ); } );
+               }
+
+            private:
+               struct range_info
+               {
+                  size_t offset;
+                  size_t count;
+               };
+
+               const char* data()const { return (const char*)_region.get_address(); }
+
+               primary_index&                  _idx;
+               const path                      _db;
+               fc::sha256                      _version;
+               fc::file_mapping                _file;
+               fc::mapped_region               _region;
+               vector< range_info >            _ranges;
+               vector< vector< object_type > > _objects;
+         };
+
+         const object& load_object( object_type&& obj )
+         {
+            const auto& result = DerivedIndex::insert( std::move( obj ) );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            return result;
+         }
+
+         template<typename Apply>
+         void modify_with( const object& obj, const Apply& apply )
+         {
+            save_undo( obj );
+            for( const auto& item : _immediate_sindex )
+               item->about_to_modify( obj );
+            if( !_deferred_sindex.empty() )
+               deferred_about_to_modify( obj );
+            apply();
+            for( const auto& item : _immediate_sindex )
+               item->object_modified( obj );
+            if( !_deferred_sindex.empty() )
+               deferred_modified( obj );
+            on_modify( obj );
+         }
+
          object_id_type                                 _next_id;
-         const direct_index< object_type, DirectBits >* _direct_by_id = nullptr;
+         const DirectIndex< object_type, DirectBits >*  _direct_by_id = nullptr;
+         std::map< fc::sha256, migration_type >         _migrations;
    };
 
+   /// Maps an object type to the type of the primary index it is stored in, if known at compile time.
+   template<typename Object>
+   struct primary_index_of { using type = void; };
+
 } } // graphene::db
+
+/**
+ * This macro specializes @ref graphene::db::primary_index_of for a specific xyz_object type, so that
+ * object_database::modify can dispatch statically. The index type must be exactly the one that is passed to
+ * object_database::add_index for the object type.
+ */
+#define MAP_OBJECT_TO_PRIMARY_INDEX(OBJECT, ...) \
+   namespace graphene { namespace db { \
+   template<> \
+   struct primary_index_of<OBJECT> { using type = __VA_ARGS__; }; \
+   } }
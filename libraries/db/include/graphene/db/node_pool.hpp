@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace graphene { namespace db {
+
+   /**
+    * @class node_pool
+    * @brief A free-list allocator for small blocks, such as the nodes of node-based containers
+    *
+    * Blocks are carved from large chunks and grouped in size classes. Freed blocks are put on the free list of
+    * their size class and reused by later allocations, chunks are only returned to the heap when the pool is
+    * destroyed. Requests larger than @ref max_block_size are forwarded to the global allocator.
+    *
+    * The pool is not thread-safe.
+    */
+   class node_pool
+   {
+      public:
+         static constexpr size_t alignment      = alignof(std::max_align_t);
+         static constexpr size_t max_block_size = 256;
+         static constexpr size_t chunk_size     = 64 * 1024;
+
+         node_pool() = default;
+         node_pool( const node_pool& ) = delete;
+         node_pool& operator=( const node_pool& ) = delete;
+
+         void* allocate( size_t bytes )
+         {
+            if( bytes > max_block_size )
+               return ::operator new( bytes );
+            const size_t cls = size_class( bytes );
+            if( _free_lists[cls] == nullptr )
+               refill( cls );
+            free_block* result = _free_lists[cls];
+            _free_lists[cls] = result->next;
+            _used_bytes += block_size( cls );
+            return result;
+         }
+
+         void deallocate( void* p, size_t bytes ) noexcept
+         {
+            if( bytes > max_block_size )
+            {
+               ::operator delete( p );
+               return;
+            }
+            const size_t cls = size_class( bytes );
+            free_block* block = static_cast<free_block*>( p );
+            block->next = _free_lists[cls];
+            _free_lists[cls] = block;
+            _used_bytes -= block_size( cls );
+         }
+
+         /// @return the number of bytes obtained from the heap for pooled blocks
+         size_t reserved_bytes()const { return _chunks.size() * chunk_size; }
+         /// @return the number of bytes in pooled blocks which are currently handed out
+         size_t used_bytes()const { return _used_bytes; }
+
+      private:
+         struct free_block { free_block* next; };
+
+         static size_t size_class( size_t bytes )
+         { return ( ( bytes > 0 ? bytes : 1 ) + alignment - 1 ) / alignment - 1; }
+         static size_t block_size( size_t cls ) { return ( cls + 1 ) * alignment; }
+
+         void refill( size_t cls )
+         {
+            std::unique_ptr<char[]> chunk( new char[chunk_size] );
+            _chunks.push_back( std::move( chunk ) );
+            char* base = _chunks.back().get();
+            const size_t bsize = block_size( cls );
+            for( size_t offset = 0; offset + bsize <= chunk_size; offset += bsize )
+            {
+               free_block* block = reinterpret_cast<free_block*>( base + offset );
+               block->next = _free_lists[cls];
+               _free_lists[cls] = block;
+            }
+         }
+
+         std::array< free_block*, max_block_size / alignment > _free_lists {};
+         std::vector< std::unique_ptr<char[]> >                _chunks;
+         size_t                                                _used_bytes = 0;
+   };
+
+   /**
+    * @class pool_allocator
+    * @brief A standard allocator which takes its memory from a @ref node_pool
+    *
+    * The pool must outlive every container which uses the allocator.
+    */
+   template<typename T>
+   class pool_allocator
+   {
+      public:
+         typedef T value_type;
+         typedef std::true_type propagate_on_container_copy_assignment;
+         typedef std::true_type propagate_on_container_move_assignment;
+         typedef std::true_type propagate_on_container_swap;
+
+         explicit pool_allocator( node_pool& pool ) : _pool( &pool ) {}
+         template<typename U>
+         pool_allocator( const pool_allocator<U>& other ) : _pool( other._pool ) {}
+
+         T* allocate( size_t n ) { return static_cast<T*>( _pool->allocate( n * sizeof(T) ) ); }
+         void deallocate( T* p, size_t n ) noexcept { _pool->deallocate( p, n * sizeof(T) ); }
+
+         template<typename U>
+         bool operator==( const pool_allocator<U>& other )const { return _pool == other._pool; }
+         template<typename U>
+         bool operator!=( const pool_allocator<U>& other )const { return _pool != other._pool; }
+
+      private:
+         template<typename U> friend class pool_allocator;
+         node_pool* _pool;
+   };
+
+   /**
+    * @class slab_pool
+    * @brief A pool of equally sized blocks, such as the nodes of one multi_index_container
+    *
+    * The block size is taken from the first allocation of a single object.  Allocations of other sizes or of
+    * several objects at once, e.g. the bucket arrays of hashed indices, are forwarded to the global allocator.
+    * Blocks are carved from chunks which grow from @ref min_chunk_size to @ref max_chunk_size, so that the nodes
+    * of a container are packed together, and freed blocks are reused by later allocations.  When graphene_db is
+    * built with GRAPHENE_HUGE_PAGE_OBJECT_POOLS, the largest chunks are backed by transparent huge pages on Linux.
+    *
+    * The pool is not thread-safe.
+    */
+   class slab_pool
+   {
+      public:
+         static constexpr size_t alignment      = alignof(std::max_align_t);
+         static constexpr size_t min_chunk_size = 16 * 1024;
+         static constexpr size_t max_chunk_size = 2 * 1024 * 1024;
+
+         slab_pool() = default;
+         slab_pool( const slab_pool& ) = delete;
+         slab_pool& operator=( const slab_pool& ) = delete;
+         ~slab_pool()
+         {
+            for( char* chunk : _chunks )
+               free_chunk( chunk );
+         }
+
+         void* allocate( size_t bytes, size_t count )
+         {
+            if( _object_size == 0 && count == 1 )
+            {
+               _object_size = bytes;
+               _block_size = ( std::max( bytes, sizeof(free_block) ) + alignment - 1 ) / alignment * alignment;
+            }
+            if( count != 1 || bytes != _object_size )
+               return ::operator new( bytes * count );
+            if( _free_list == nullptr )
+               refill();
+            free_block* result = _free_list;
+            _free_list = result->next;
+            _used_bytes += _block_size;
+            return result;
+         }
+
+         void deallocate( void* p, size_t bytes, size_t count ) noexcept
+         {
+            if( count != 1 || bytes != _object_size )
+            {
+               ::operator delete( p );
+               return;
+            }
+            free_block* block = static_cast<free_block*>( p );
+            block->next = _free_list;
+            _free_list = block;
+            _used_bytes -= _block_size;
+         }
+
+         /// @return the size of the pooled blocks, zero until the first one was allocated
+         size_t block_size()const { return _block_size; }
+         /// @return the number of bytes obtained from the heap for pooled blocks
+         size_t reserved_bytes()const { return _reserved_bytes; }
+         /// @return the number of bytes in pooled blocks which are currently handed out
+         size_t used_bytes()const { return _used_bytes; }
+
+      private:
+         struct free_block { free_block* next; };
+
+         /// Chunks are obtained with malloc, or aligned to their size for huge pages, and released with free
+         static char* allocate_chunk( size_t bytes );
+         static void free_chunk( char* chunk ) noexcept;
+
+         void refill()
+         {
+            const size_t chunk_bytes = std::max( _next_chunk_size, _block_size );
+            _chunks.push_back( nullptr ); // so that a failed allocation does not leak the chunk
+            char* base = allocate_chunk( chunk_bytes );
+            _chunks.back() = base;
+            _reserved_bytes += chunk_bytes;
+            if( _next_chunk_size < max_chunk_size )
+               _next_chunk_size *= 2;
+            // hand out the blocks in address order
+            for( size_t offset = chunk_bytes / _block_size * _block_size; offset > 0; offset -= _block_size )
+            {
+               free_block* block = reinterpret_cast<free_block*>( base + offset - _block_size );
+               block->next = _free_list;
+               _free_list = block;
+            }
+         }
+
+         free_block*                             _free_list       = nullptr;
+         size_t                                  _object_size     = 0;
+         size_t                                  _block_size      = 0;
+         size_t                                  _next_chunk_size = min_chunk_size;
+         size_t                                  _reserved_bytes  = 0;
+         size_t                                  _used_bytes      = 0;
+         std::vector<char*>                      _chunks;
+   };
+
+   /**
+    * @class slab_allocator
+    * @brief A standard allocator which takes its memory from a @ref slab_pool
+    *
+    * The pool must outlive every container which uses the allocator.
+    */
+   template<typename T>
+   class slab_allocator
+   {
+      public:
+         typedef T value_type;
+         typedef std::true_type propagate_on_container_copy_assignment;
+         typedef std::true_type propagate_on_container_move_assignment;
+         typedef std::true_type propagate_on_container_swap;
+         template<typename U> struct rebind { typedef slab_allocator<U> other; };
+
+         explicit slab_allocator( slab_pool& pool ) : _pool( &pool ) {}
+         template<typename U>
+         slab_allocator( const slab_allocator<U>& other ) : _pool( other._pool ) {}
+
+         T* allocate( size_t n ) { return static_cast<T*>( _pool->allocate( sizeof(T), n ) ); }
+         void deallocate( T* p, size_t n ) noexcept { _pool->deallocate( p, sizeof(T), n ); }
+
+         template<typename U>
+         bool operator==( const slab_allocator<U>& other )const { return _pool == other._pool; }
+         template<typename U>
+         bool operator!=( const slab_allocator<U>& other )const { return _pool != other._pool; }
+
+      private:
+         template<typename U> friend class slab_allocator;
+         slab_pool* _pool;
+   };
+
+} } // graphene::db
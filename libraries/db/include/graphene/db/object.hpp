@@ -23,7 +23,9 @@
  */
 #pragma once
 #include <boost/multiprecision/integer.hpp>
+#include <graphene/protocol/json_writer.hpp>
 #include <graphene/protocol/object_id.hpp>
+#include <fc/io/json.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/crypto/city.hpp>
 
@@ -72,7 +74,11 @@ namespace graphene { namespace db {
          virtual unique_ptr<object> clone()const = 0;
          virtual void               move_from( object& obj ) = 0;
          virtual variant            to_variant()const  = 0;
+         /// @return the JSON of @ref to_variant, written without building the variant where possible
+         virtual std::string        to_json()const { return fc::json::to_string( to_variant() ); }
          virtual vector<char>       pack()const = 0;
+         /// Restores the content of this object (including the id) from the output of @ref pack
+         virtual void               unpack_from( const vector<char>& data ) = 0;
    };
 
    /**
@@ -96,7 +102,18 @@ namespace graphene { namespace db {
             static_cast<DerivedClass&>(*this) = std::move( static_cast<DerivedClass&>(obj) );
          }
          virtual variant to_variant()const { return variant( static_cast<const DerivedClass&>(*this), MAX_NESTING ); }
+         virtual std::string to_json()const
+         {
+            return graphene::protocol::to_json( static_cast<const DerivedClass&>(*this), MAX_NESTING );
+         }
          virtual vector<char> pack()const  { return fc::raw::pack( static_cast<const DerivedClass&>(*this) ); }
+         virtual void    unpack_from( const vector<char>& data )
+         {
+            // unpack into a fresh object so that no stale content survives in containers
+            DerivedClass tmp;
+            fc::raw::unpack( data, tmp );
+            static_cast<DerivedClass&>(*this) = std::move( tmp );
+         }
    };
 
    typedef flat_map<uint8_t, object_id_type> annotation_map;
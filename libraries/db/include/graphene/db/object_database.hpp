@@ -29,9 +29,39 @@
 #include <fc/log/logger.hpp>
 
 #include <map>
+#include <ostream>
+#include <unordered_set>
 
 namespace graphene { namespace db {
 
+   /// An estimate of the memory used by one index, in bytes unless noted otherwise
+   struct index_memory_usage
+   {
+      uint8_t  space_id              = 0;
+      uint8_t  type_id               = 0;
+      /// number of objects
+      uint64_t object_count          = 0;
+      /// objects and the nodes of the primary container, excluding memory owned by members of the objects
+      uint64_t object_bytes          = 0;
+      /// all secondary indexes which report their size, see @ref secondary_index::memory_usage
+      uint64_t secondary_index_bytes = 0;
+      /// heap memory reserved for the nodes of the objects if they are pooled, used or not
+      uint64_t pool_reserved_bytes   = 0;
+      /// pre-images and bookkeeping of the objects of this index in all undo states
+      uint64_t undo_bytes            = 0;
+   };
+
+   /// A part of the objects of one index in a snapshot, see @ref object_database::save_snapshot
+   struct snapshot_chunk
+   {
+      uint8_t                                              space_id = 0;
+      uint8_t                                              type_id  = 0;
+      object_id_type                                       next_id;
+      /// the format of the objects, see @ref index::get_object_version
+      fc::sha256                                           object_version;
+      vector< std::pair< object_id_type, vector<char> > >  objects;
+   };
+
    /**
     *   @class object_database
     *   @brief maintains a set of indexed objects that can be modified with multi-level rollback support
@@ -47,12 +77,34 @@ namespace graphene { namespace db {
          void open(const fc::path& data_dir );
 
          /**
-          * Saves the complete state of the object_database to disk, this could take a while
+          * Saves the complete state of the object_database to disk, this could take a while.
+          * In incremental mode, usually only the objects which have changed since the last flush are saved,
+          * see @ref enable_incremental_flush.
           */
          void flush();
          void wipe(const fc::path& data_dir); // remove from disk
          void close();
 
+         /**
+          * In incremental mode, @ref flush writes the objects which have been created, modified or removed since
+          * the previous flush as a delta file next to the full copy of the database, and @ref open replays the
+          * deltas on top of it. The deltas are compacted into a new full copy once there are too many of them
+          * or they have grown too big. A full flush is also done if there is no complete database on disk yet,
+          * or if too many objects have changed since the previous flush.
+          *
+          * Must be called before @ref open.
+          */
+         void enable_incremental_flush( bool enable ) { _incremental_flush = enable; }
+         bool incremental_flush_enabled()const { return _incremental_flush; }
+
+         /// Thresholds of the incremental mode
+         /// @{
+         static constexpr size_t   max_dirty_objects = 4 * 1024 * 1024;
+         static constexpr uint32_t max_deltas        = 16;
+         /** deltas are compacted once their total size exceeds the size of the full copy divided by this */
+         static constexpr uint64_t delta_size_ratio  = 4;
+         /// @}
+
          template<typename T, typename F>
          const T& create( F&& constructor )
          {
@@ -88,7 +140,7 @@ namespace graphene { namespace db {
          void          remove( const object& obj ) { get_mutable_index(obj.id).remove( obj ); }
          template<typename T, typename Lambda>
          void modify( const T& obj, const Lambda& m ) {
-            get_mutable_index(obj.id).modify(obj,m);
+            modify( obj, m, typename std::is_void< typename primary_index_of<T>::type >::type() );
          }
 
          ///@}
@@ -135,6 +187,9 @@ namespace graphene { namespace db {
          IndexType* add_index()
          {
             typedef typename IndexType::object_type ObjectType;
+            typedef typename primary_index_of<ObjectType>::type MappedIndexType;
+            static_assert( std::is_void<MappedIndexType>::value || std::is_same<MappedIndexType,IndexType>::value,
+                           "Index type does not match the one given to MAP_OBJECT_TO_PRIMARY_INDEX" );
             if( _index[ObjectType::space_id].size() <= ObjectType::type_id  )
                 _index[ObjectType::space_id].resize( 255 );
             assert(!_index[ObjectType::space_id][ObjectType::type_id]);
@@ -151,8 +206,36 @@ namespace graphene { namespace db {
 
          void pop_undo();
 
+         /**
+          * While a secondary index batch is active, changes are not reported to deferrable secondary indexes
+          * (see @ref secondary_index::is_deferrable) right away. They are collected per object and delivered
+          * when the outermost batch ends. Batches can be nested.
+          */
+         /// @{
+         void begin_secondary_index_batch() { ++_secondary_index_batch_depth; }
+         void end_secondary_index_batch();
+         bool in_secondary_index_batch()const { return _secondary_index_batch_depth > 0; }
+         /// @}
+
          fc::path get_data_dir()const { return _data_dir; }
 
+         /** @return the estimated memory usage of all indexes, ordered by space and type */
+         vector< index_memory_usage > get_memory_usage()const;
+
+         /** @return the sum of the change counts of all indexes, see @ref index::change_count */
+         uint64_t change_count()const;
+
+         /**
+          * Writes all objects to out as a sequence of chunks, each of them holds at most objects_per_chunk
+          * objects of one index and is followed by its hash. An empty chunk ends the sequence.
+          */
+         void save_snapshot( std::ostream& out, size_t objects_per_chunk = 10000 )const;
+         /**
+          * Reads the chunks written by @ref save_snapshot and inserts their objects, replacing existing objects
+          * with the same ids. Chunks of indexes which do not exist here are skipped. No undo history is kept.
+          */
+         void load_snapshot( fc::datastream<const char*>& ds );
+
          /** public for testing purposes only... should be private in practice. */
          undo_database                          _undo_db;
      protected:
@@ -167,17 +250,95 @@ namespace graphene { namespace db {
          index& get_mutable_index(uint8_t space_id, uint8_t type_id);
 
      private:
+         /// dynamically dispatched modification, for objects without @ref MAP_OBJECT_TO_PRIMARY_INDEX
+         template<typename T, typename Lambda>
+         void modify( const T& obj, const Lambda& m, std::true_type ) {
+            get_mutable_index(obj.id).modify(obj,m);
+         }
+         /// statically dispatched modification
+         template<typename T, typename Lambda>
+         void modify( const T& obj, const Lambda& m, std::false_type ) {
+            typedef typename primary_index_of<T>::type IndexType;
+            get_mutable_index_type<IndexType>().static_modify( obj, m );
+         }
 
          friend class base_primary_index;
          friend class undo_database;
          void save_undo( const object& obj );
          void save_undo_add( const object& obj );
          void save_undo_remove( const object& obj );
+         void save_undo_reserve_id( object_id_type id );
+         void queue_secondary_index_flush( base_primary_index& idx );
+
+         /** records that the object with the given id has to be written by the next incremental flush */
+         void mark_dirty( object_id_type id )
+         {
+            if( !_incremental_flush || _full_flush_needed )
+               return;
+            _dirty_objects.insert( id );
+            if( _dirty_objects.size() > max_dirty_objects )
+            {
+               // a full flush will be cheaper than tracking all of this
+               _full_flush_needed = true;
+               std::unordered_set< object_id_type >().swap( _dirty_objects );
+            }
+         }
+         void flush_full();
+         void flush_delta();
+         void load_delta( const fc::path& delta_file );
+         uint64_t saved_index_bytes()const;
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         uint32_t                                                  _secondary_index_batch_depth = 0;
+         vector< base_primary_index* >                             _secondary_index_flush_queue;
+
+         bool                                                      _incremental_flush = false;
+         /** true if the next flush has to save everything */
+         bool                                                      _full_flush_needed = true;
+         std::unordered_set< object_id_type >                      _dirty_objects;
+         /** number and total size of the delta files on disk */
+         uint32_t                                                  _delta_count = 0;
+         uint64_t                                                  _delta_bytes = 0;
+         /** size of the full copy on disk */
+         uint64_t                                                  _base_bytes = 0;
+   };
+
+   /**
+    * @class secondary_index_batch
+    * @brief RAII helper which keeps a secondary index batch active for its lifetime
+    */
+   class secondary_index_batch
+   {
+      public:
+         explicit secondary_index_batch( object_database& db ) : _db( db ) { _db.begin_secondary_index_batch(); }
+         secondary_index_batch( const secondary_index_batch& ) = delete;
+         secondary_index_batch& operator=( const secondary_index_batch& ) = delete;
+         ~secondary_index_batch()
+         {
+            try {
+               end();
+            } catch ( const fc::exception& e ) {
+               elog( "Failed to update secondary indexes: ${e}", ("e",e.to_detail_string()) );
+            }
+         }
+
+         /** ends the batch early, e.g. before listeners that use the secondary indexes are notified */
+         void end()
+         {
+            if( !_active ) return;
+            _active = false;
+            _db.end_secondary_index_batch();
+         }
+
+      private:
+         object_database& _db;
+         bool             _active = true;
    };
 
 } } // graphene::db
 
+FC_REFLECT( graphene::db::index_memory_usage,
+            (space_id)(type_id)(object_count)(object_bytes)(secondary_index_bytes)(pool_reserved_bytes)(undo_bytes) )
 
+FC_REFLECT( graphene::db::snapshot_chunk, (space_id)(type_id)(next_id)(object_version)(objects) )
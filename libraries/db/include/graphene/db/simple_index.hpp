@@ -24,6 +24,8 @@
 #pragma once
 #include <graphene/db/index.hpp>
 
+#include <algorithm>
+
 namespace graphene { namespace db {
 
    /**
@@ -59,6 +61,13 @@ namespace graphene { namespace db {
             modify_callback( *_objects[obj.id.instance()] );
          }
 
+         template<typename Lambda>
+         void modify_in_place( const T& obj, const Lambda& m )
+         {
+            assert( obj.id.instance() < _objects.size() );
+            m( *_objects[obj.id.instance()] );
+         }
+
          virtual const object& insert( object&& obj )override
          {
             auto instance = obj.id.instance();
@@ -135,6 +144,14 @@ namespace graphene { namespace db {
          const_iterator end()const   { return const_iterator(_objects, _objects.end());   }
 
          size_t size()const { return _objects.size(); }
+
+         virtual size_t object_count()const override
+         {
+            return std::count_if( _objects.begin(), _objects.end(),
+                                  []( const unique_ptr<object>& ptr ){ return ptr != nullptr; } );
+         }
+
+         virtual size_t object_node_size()const override { return sizeof(T) + sizeof(unique_ptr<object>); }
       private:
          vector< unique_ptr<object> > _objects;
    };
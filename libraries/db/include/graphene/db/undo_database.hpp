@@ -23,8 +23,11 @@
  */
 #pragma once
 #include <graphene/db/object.hpp>
+#include <graphene/db/node_pool.hpp>
 #include <deque>
+#include <map>
 #include <fc/exception/exception.hpp>
+#include <fc/reflect/reflect.hpp>
 
 namespace graphene { namespace db {
 
@@ -34,13 +37,61 @@ namespace graphene { namespace db {
 
    struct undo_state
    {
-      unordered_map<object_id_type, unique_ptr<object> > old_values;
-      unordered_map<object_id_type, object_id_type>      old_index_next_ids;
-      std::unordered_set<object_id_type>                 new_ids;
-      unordered_map<object_id_type, unique_ptr<object> > removed;
+      /// Containers whose nodes are taken from the @ref node_pool of the owning @ref undo_database
+      ///@{
+      template<typename K, typename V>
+      using pooled_map = unordered_map< K, V, std::hash<K>, std::equal_to<K>,
+                                        pool_allocator< std::pair<const K, V> > >;
+      template<typename K>
+      using pooled_set = std::unordered_set< K, std::hash<K>, std::equal_to<K>, pool_allocator<K> >;
+      ///@}
+
+      explicit undo_state( node_pool& pool )
+      : old_values( pool_allocator< std::pair<const object_id_type, unique_ptr<object> > >( pool ) ),
+        old_packed_values( pool_allocator< std::pair<const object_id_type, vector<char> > >( pool ) ),
+        old_index_next_ids( pool_allocator< std::pair<const object_id_type, object_id_type> >( pool ) ),
+        new_ids( pool_allocator< object_id_type >( pool ) ),
+        removed( pool_allocator< std::pair<const object_id_type, unique_ptr<object> > >( pool ) )
+      {}
+
+      pooled_map<object_id_type, unique_ptr<object> > old_values;
+      /// Serialized pre-images of modified objects, used instead of @ref old_values in packed mode
+      pooled_map<object_id_type, vector<char> >       old_packed_values;
+      pooled_map<object_id_type, object_id_type>      old_index_next_ids;
+      pooled_set<object_id_type>                      new_ids;
+      pooled_map<object_id_type, unique_ptr<object> > removed;
+
+      /// whether the session of the state has ended, see @ref undo_database::set_max_bytes
+      bool   closed    = false;
+      /// whether the full copies in @ref old_values were replaced by packed pre-images
+      bool   compacted = false;
+      /// estimated memory of the state, only known once it is closed
+      size_t bytes     = 0;
    };
 
 
+   /// The memory held by all undo states for the objects of one index
+   struct undo_index_usage
+   {
+      /// number of full object copies, their size is only known to the index
+      size_t copies = 0;
+      /// bytes of serialized pre-images and of the container nodes of all entries
+      size_t bytes  = 0;
+   };
+
+   /// The estimated memory held by the undo states of completed sessions, i.e. of blocks
+   struct undo_database_usage
+   {
+      uint32_t states              = 0;
+      uint64_t bytes               = 0;
+      /// the latest completed state, normally the undo state of the head block
+      uint64_t last_state_bytes    = 0;
+      uint64_t largest_state_bytes = 0;
+      /// number of states whose copies were replaced by packed pre-images to stay below @ref max_bytes
+      uint32_t compacted_states    = 0;
+      uint64_t max_bytes           = 0;
+   };
+
    /**
     * @class undo_database
     * @brief tracks changes to the state and allows changes to be undone
@@ -85,11 +136,28 @@ namespace graphene { namespace db {
          void    enable();
          bool    enabled()const { return !_disabled; }
 
+         /**
+          * In packed mode the pre-modification value of an object is stored in serialized form rather than as a
+          * full copy. A serialized pre-image is a single allocation regardless of the containers held by the
+          * object and is usually much smaller, at the cost of unpacking it again if the state is undone.
+          *
+          * The mode can be changed at any time, existing undo states are not affected.
+          */
+         void    set_packed_mode( bool packed ) { _packed_mode = packed; }
+         bool    packed_mode()const { return _packed_mode; }
+
          session start_undo_session( bool force_enable = false );
          /**
           * This should be called just after an object is created
           */
          void on_create( const object& obj );
+         /**
+          * This should be called just before the next id of an index is advanced without creating an object
+          *
+          * Like for @ref on_create, the next id of the index is restored if this undo state is undone, but there is
+          * no object to remove.
+          */
+         void on_reserve_id( object_id_type id );
          /**
           * This should be called just before an object is modified
           *
@@ -119,20 +187,55 @@ namespace graphene { namespace db {
          std::size_t size()const { return _stack.size(); }
          void set_max_size(size_t new_max_size) { _max_size = new_max_size; }
          size_t max_size()const { return _max_size; }
+
+         /**
+          * Limits the estimated memory of the undo states of completed sessions to about this many bytes, 0 for
+          * no limit. Above the limit the full copies kept by the oldest states are replaced by packed pre-images,
+          * like in @ref set_packed_mode. States are never dropped for the limit, their number is given by
+          * @ref set_max_size which follows the irreversibility of the chain, so the limit is exceeded if the
+          * packed states still need more memory.
+          */
+         void set_max_bytes( size_t max_bytes );
+         size_t max_bytes()const { return _max_bytes; }
+         undo_database_usage get_usage()const;
          uint32_t active_sessions()const { return _active_sessions; }
 
          const undo_state& head()const;
 
+         /// The pool which backs the containers of all undo states, nodes are recycled between sessions
+         const node_pool& get_node_pool()const { return _node_pool; }
+
+         /** @return the memory held by all undo states, by the (space, type) of the objects */
+         std::map< std::pair<uint8_t,uint8_t>, undo_index_usage > get_usage_by_index()const;
+
       private:
          void undo();
          void merge();
          void commit();
 
+         /// Closes the state at the back of the stack, whose session has ended, and keeps the memory limit
+         void close_last_state();
+         void remove_state_bytes( const undo_state& state );
+         void enforce_max_bytes();
+         size_t estimate_bytes( const undo_state& state )const;
+         void add_usage_by_index( const undo_state& state,
+                                  std::map< std::pair<uint8_t,uint8_t>, undo_index_usage >& result )const;
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
+         bool                    _packed_mode = false;
+         node_pool               _node_pool; // must be declared before _stack to outlive it
          std::deque<undo_state>  _stack;
          object_database&        _db;
          size_t                  _max_size = 256;
+         size_t                  _max_bytes = 0;
+         /// the sum of the bytes of the closed states
+         size_t                  _bytes = 0;
+         size_t                  _last_state_bytes = 0;
+         size_t                  _largest_state_bytes = 0;
    };
 
 } } // graphene::db
+
+FC_REFLECT( graphene::db::undo_database_usage,
+            (states)(bytes)(last_state_bytes)(largest_state_bytes)(compacted_states)(max_bytes) )
@@ -26,18 +26,159 @@
 #include <graphene/db/object_database.hpp>
 
 namespace graphene { namespace db {
+   namespace {
+      void describe_schema( const fc::variant& v, std::string& out )
+      {
+         switch( v.get_type() )
+         {
+            case fc::variant::null_type:   out += 'n'; break;
+            case fc::variant::int64_type:  out += 'i'; break;
+            case fc::variant::uint64_type: out += 'u'; break;
+            case fc::variant::double_type: out += 'd'; break;
+            case fc::variant::bool_type:   out += 'b'; break;
+            case fc::variant::string_type: out += 's'; break;
+            case fc::variant::blob_type:   out += 'x'; break;
+            case fc::variant::array_type:
+               out += '[';
+               for( const auto& item : v.get_array() )
+               {
+                  describe_schema( item, out );
+                  out += ',';
+               }
+               out += ']';
+               break;
+            case fc::variant::object_type:
+               out += '{';
+               for( const auto& entry : v.get_object() )
+               {
+                  out += entry.key();
+                  out += ':';
+                  describe_schema( entry.value(), out );
+                  out += ',';
+               }
+               out += '}';
+               break;
+         }
+      }
+   }
+
+   fc::sha256 get_schema_version( const fc::variant& prototype )
+   {
+      std::string desc;
+      describe_schema( prototype, desc );
+      return fc::sha256::hash( desc );
+   }
+
    void base_primary_index::save_undo( const object& obj )
    { _db.save_undo( obj ); }
 
    void base_primary_index::on_add( const object& obj )
    {
+      ++_change_count;
       _db.save_undo_add( obj );
+      _db.mark_dirty( obj.id );
       for( auto ob : _observers ) ob->on_add( obj );
    }
 
+   void base_primary_index::on_reserve_id( object_id_type id )
+   { _db.save_undo_reserve_id( id ); }
+
    void base_primary_index::on_remove( const object& obj )
-   { _db.save_undo_remove( obj ); for( auto ob : _observers ) ob->on_remove( obj ); }
+   {
+      ++_change_count;
+      _db.save_undo_remove( obj );
+      _db.mark_dirty( obj.id );
+      for( auto ob : _observers ) ob->on_remove( obj );
+   }
 
    void base_primary_index::on_modify( const object& obj )
-   {for( auto ob : _observers ) ob->on_modify(  obj ); }
+   {
+      ++_change_count;
+      _db.mark_dirty( obj.id );
+      for( auto ob : _observers ) ob->on_modify(  obj );
+   }
+
+   void base_primary_index::deferred_inserted( const object& obj )
+   {
+      if( !_db.in_secondary_index_batch() )
+      {
+         for( auto item : _deferred_sindex ) item->object_inserted( obj );
+         return;
+      }
+      if( _pending_inserts.empty() && _pending_modifies.empty() )
+         _db.queue_secondary_index_flush( *this );
+      _pending_inserts.insert( obj.id );
+   }
+
+   void base_primary_index::deferred_about_to_modify( const object& before )
+   {
+      if( !_db.in_secondary_index_batch() )
+      {
+         for( auto item : _deferred_sindex ) item->about_to_modify( before );
+         return;
+      }
+      // only the state before the first change matters, and new objects are reported with their final state
+      if( _pending_inserts.find( before.id ) != _pending_inserts.end()
+            || _pending_modifies.find( before.id ) != _pending_modifies.end() )
+         return;
+      if( _pending_inserts.empty() && _pending_modifies.empty() )
+         _db.queue_secondary_index_flush( *this );
+      _pending_modifies.emplace( before.id, before.clone() );
+   }
+
+   void base_primary_index::deferred_modified( const object& after )
+   {
+      if( !_db.in_secondary_index_batch() )
+         for( auto item : _deferred_sindex ) item->object_modified( after );
+      // else reported by flush_deferred()
+   }
+
+   void base_primary_index::deferred_removed( const object& obj )
+   {
+      if( !_db.in_secondary_index_batch() )
+      {
+         for( auto item : _deferred_sindex ) item->object_removed( obj );
+         return;
+      }
+      auto ins = _pending_inserts.find( obj.id );
+      if( ins != _pending_inserts.end() )
+      {
+         // the secondary indexes have never seen this object
+         _pending_inserts.erase( ins );
+         return;
+      }
+      auto mod = _pending_modifies.find( obj.id );
+      if( mod != _pending_modifies.end() )
+      {
+         // the secondary indexes still know the object in the state before the batch
+         unique_ptr<object> before = std::move( mod->second );
+         _pending_modifies.erase( mod );
+         for( auto item : _deferred_sindex ) item->object_removed( *before );
+         return;
+      }
+      for( auto item : _deferred_sindex ) item->object_removed( obj );
+   }
+
+   void base_primary_index::flush_deferred()
+   {
+      std::set< object_id_type > inserts;
+      std::map< object_id_type, unique_ptr<object> > modifies;
+      inserts.swap( _pending_inserts );
+      modifies.swap( _pending_modifies );
+
+      for( const auto& id : inserts )
+      {
+         const object& obj = _db.get_object( id );
+         for( auto item : _deferred_sindex ) item->object_inserted( obj );
+      }
+      for( const auto& entry : modifies )
+      {
+         const object& obj = _db.get_object( entry.first );
+         for( auto item : _deferred_sindex )
+         {
+            item->about_to_modify( *entry.second );
+            item->object_modified( obj );
+         }
+      }
+   }
 } } // graphene::chain
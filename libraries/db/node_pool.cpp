@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/db/node_pool.hpp>
+
+#include <cstdlib>
+#include <new>
+
+#if defined(GRAPHENE_HUGE_PAGE_OBJECT_POOLS) && defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace graphene { namespace db {
+
+char* slab_pool::allocate_chunk( size_t bytes )
+{
+   void* chunk = nullptr;
+#if defined(GRAPHENE_HUGE_PAGE_OBJECT_POOLS) && defined(__linux__)
+   if( bytes == max_chunk_size )
+   {
+      if( posix_memalign( &chunk, max_chunk_size, bytes ) != 0 )
+         throw std::bad_alloc();
+      // only a hint, the chunk is usable with normal pages if the kernel does not provide huge ones
+      madvise( chunk, bytes, MADV_HUGEPAGE );
+      return static_cast<char*>( chunk );
+   }
+#endif
+   chunk = std::malloc( bytes );
+   if( chunk == nullptr )
+      throw std::bad_alloc();
+   return static_cast<char*>( chunk );
+}
+
+void slab_pool::free_chunk( char* chunk ) noexcept
+{
+   std::free( chunk );
+}
+
+} } // graphene::db
@@ -25,8 +25,13 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/container/flat.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/optional.hpp>
 #include <fc/thread/parallel.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace graphene { namespace db {
 
 object_database::object_database()
@@ -42,6 +47,33 @@ void object_database::close()
 {
 }
 
+void object_database::end_secondary_index_batch()
+{
+   FC_ASSERT( _secondary_index_batch_depth > 0, "No secondary index batch is active" );
+   if( --_secondary_index_batch_depth > 0 )
+      return;
+   vector< base_primary_index* > queue;
+   queue.swap( _secondary_index_flush_queue );
+   // flush every index even if one of them fails, so that no changes are left behind
+   fc::optional< fc::exception > failure;
+   for( auto idx : queue )
+   {
+      try {
+         idx->flush_deferred();
+      } catch( const fc::exception& e ) {
+         if( !failure.valid() )
+            failure = e;
+      }
+   }
+   if( failure.valid() )
+      throw *failure;
+}
+
+void object_database::queue_secondary_index_flush( base_primary_index& idx )
+{
+   _secondary_index_flush_queue.push_back( &idx );
+}
+
 const object* object_database::find_object( object_id_type id )const
 {
    return get_index(id.space(),id.type()).find( id );
@@ -81,6 +113,15 @@ index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
 }
 
 void object_database::flush()
+{
+   if( _incremental_flush && !_full_flush_needed && _delta_count < max_deltas
+         && _delta_bytes <= _base_bytes / delta_size_ratio )
+      flush_delta();
+   else
+      flush_full();
+}
+
+void object_database::flush_full()
 {
    const auto tmp_dir = _data_dir / "object_database.tmp";
    const auto old_dir = _data_dir / "object_database.old";
@@ -119,19 +160,227 @@ void object_database::flush()
    }
    fc::rename( tmp_dir, target_dir );
    fc::remove_all( old_dir );
+
+   // the new full copy does not have any deltas
+   _full_flush_needed = false;
+   std::unordered_set< object_id_type >().swap( _dirty_objects );
+   _delta_count = 0;
+   _delta_bytes = 0;
+   _base_bytes = saved_index_bytes();
+}
+
+void object_database::flush_delta()
+{
+   const auto delta_dir = _data_dir / "object_database" / "delta";
+   const auto tmp_file = delta_dir / "tmp";
+   const auto target_file = delta_dir / fc::to_string( _delta_count + 1 );
+
+   fc::create_directories( delta_dir );
+   {
+      std::ofstream out( tmp_file.generic_string(),
+                         std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      FC_ASSERT( out );
+      vector< std::pair< object_id_type, fc::sha256 > > next_ids;
+      for( const auto& space : _index )
+         for( const auto& idx : space )
+            if( idx )
+               next_ids.emplace_back( idx->get_next_id(), idx->get_object_version() );
+      fc::raw::pack( out, next_ids );
+      const vector<char> removed;
+      for( const auto& id : _dirty_objects )
+      {
+         fc::raw::pack( out, id );
+         const object* obj = find_object( id );
+         if( obj != nullptr )
+            fc::raw::pack( out, obj->pack() );
+         else
+            fc::raw::pack( out, removed );
+      }
+      out.close();
+      FC_ASSERT( out, "Failed to write ${f}", ("f",tmp_file) );
+   }
+   // the rename makes the complete delta visible to open() at once
+   _delta_bytes += fc::file_size( tmp_file );
+   fc::rename( tmp_file, target_file );
+   ++_delta_count;
+   std::unordered_set< object_id_type >().swap( _dirty_objects );
+}
+
+void object_database::load_delta( const fc::path& delta_file )
+{ try {
+   fc::file_mapping fm( delta_file.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(delta_file) );
+   fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+
+   // indexes of disabled plugins are skipped, their state is lost like with a full flush
+   auto find_index = [this]( object_id_type id ) -> index* {
+      if( _index.size() <= id.space() || _index[id.space()].size() <= id.type() )
+         return nullptr;
+      return _index[id.space()][id.type()].get();
+   };
+
+   // the next ids and object format versions of all indexes
+   vector< std::pair< object_id_type, fc::sha256 > > next_ids;
+   fc::raw::unpack( ds, next_ids );
+   std::map< std::pair< uint8_t, uint8_t >, fc::sha256 > versions;
+   for( const auto& next_id : next_ids )
+   {
+      index* idx = find_index( next_id.first );
+      if( idx != nullptr )
+         idx->set_next_id( next_id.first );
+      versions[ std::make_pair( next_id.first.space(), next_id.first.type() ) ] = next_id.second;
+   }
+   object_id_type id;
+   vector<char> data;
+   while( ds.remaining() > 0 )
+   {
+      fc::raw::unpack( ds, id );
+      fc::raw::unpack( ds, data );
+      index* idx = find_index( id );
+      if( idx != nullptr )
+      {
+         const auto version = versions.find( std::make_pair( id.space(), id.type() ) );
+         FC_ASSERT( version != versions.end(), "Unknown index of object ${id}", ("id",id) );
+         idx->reload( id, data, version->second );
+      }
+   }
+} FC_CAPTURE_AND_RETHROW( (delta_file) ) }
+
+uint64_t object_database::saved_index_bytes()const
+{
+   uint64_t result = 0;
+   for( size_t space = 0; space < _index.size(); ++space )
+      for( size_t type = 0; type < _index[space].size(); ++type )
+      {
+         const auto file = _data_dir / "object_database" / fc::to_string(space) / fc::to_string(type);
+         if( _index[space][type] && fc::exists( file ) )
+            result += fc::file_size( file );
+      }
+   return result;
+}
+
+vector< index_memory_usage > object_database::get_memory_usage()const
+{
+   const auto undo_usage = _undo_db.get_usage_by_index();
+   vector< index_memory_usage > result;
+   for( size_t space = 0; space < _index.size(); ++space )
+      for( size_t type = 0; type < _index[space].size(); ++type )
+      {
+         const auto& idx = _index[space][type];
+         if( !idx )
+            continue;
+         index_memory_usage usage;
+         usage.space_id = static_cast<uint8_t>( space );
+         usage.type_id = static_cast<uint8_t>( type );
+         usage.object_count = idx->object_count();
+         const size_t node_size = idx->object_node_size();
+         usage.object_bytes = usage.object_count * node_size;
+         usage.secondary_index_bytes = idx->secondary_index_memory_usage();
+         usage.pool_reserved_bytes = idx->object_pool_reserved_bytes();
+         const auto undo_itr = undo_usage.find( std::make_pair( usage.space_id, usage.type_id ) );
+         if( undo_itr != undo_usage.end() )
+            usage.undo_bytes = undo_itr->second.copies * node_size + undo_itr->second.bytes;
+         result.push_back( usage );
+      }
+   return result;
+}
+
+uint64_t object_database::change_count()const
+{
+   uint64_t result = 0;
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+            result += idx->change_count();
+   return result;
 }
 
+void object_database::save_snapshot( std::ostream& out, size_t objects_per_chunk )const
+{ try {
+   FC_ASSERT( objects_per_chunk > 0 );
+   // keeps every chunk well below the size limit of unpacked vectors
+   constexpr size_t max_chunk_bytes = 1024 * 1024;
+   auto write_chunk = [&out]( const snapshot_chunk& chunk ) {
+      const vector<char> data = fc::raw::pack( chunk );
+      fc::raw::pack( out, data );
+      fc::raw::pack( out, fc::sha256::hash( data.data(), data.size() ) );
+   };
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+      {
+         if( !idx )
+            continue;
+         snapshot_chunk chunk;
+         chunk.space_id = idx->object_space_id();
+         chunk.type_id = idx->object_type_id();
+         chunk.next_id = idx->get_next_id();
+         chunk.object_version = idx->get_object_version();
+         size_t chunk_bytes = 0;
+         bool written = false;
+         idx->inspect_all_objects( [&]( const object& obj ) {
+            chunk.objects.emplace_back( obj.id, obj.pack() );
+            chunk_bytes += chunk.objects.back().second.size();
+            if( chunk.objects.size() >= objects_per_chunk || chunk_bytes >= max_chunk_bytes )
+            {
+               write_chunk( chunk );
+               chunk.objects.clear();
+               chunk_bytes = 0;
+               written = true;
+            }
+         });
+         // an empty index still gets a chunk to restore its next id
+         if( !written || !chunk.objects.empty() )
+            write_chunk( chunk );
+      }
+   fc::raw::pack( out, vector<char>() );
+   FC_ASSERT( out, "Failed to write the snapshot" );
+} FC_CAPTURE_AND_RETHROW( (objects_per_chunk) ) }
+
+void object_database::load_snapshot( fc::datastream<const char*>& ds )
+{ try {
+   vector<char> data;
+   fc::raw::unpack( ds, data );
+   while( !data.empty() )
+   {
+      fc::sha256 hash;
+      fc::raw::unpack( ds, hash );
+      FC_ASSERT( hash == fc::sha256::hash( data.data(), data.size() ), "The snapshot is damaged" );
+      const auto chunk = fc::raw::unpack< snapshot_chunk >( data );
+      // indexes of disabled plugins are skipped
+      if( _index.size() > chunk.space_id && _index[chunk.space_id].size() > chunk.type_id
+            && _index[chunk.space_id][chunk.type_id] )
+      {
+         index& idx = *_index[chunk.space_id][chunk.type_id];
+         idx.set_next_id( chunk.next_id );
+         for( const auto& obj : chunk.objects )
+            idx.reload( obj.first, obj.second, chunk.object_version );
+      }
+      fc::raw::unpack( ds, data );
+   }
+   _full_flush_needed = true;
+} FC_CAPTURE_AND_RETHROW() }
+
 void object_database::wipe(const fc::path& data_dir)
 {
    close();
    ilog("Wiping object database...");
    fc::remove_all(data_dir / "object_database");
+   _full_flush_needed = true;
+   std::unordered_set< object_id_type >().swap( _dirty_objects );
+   _delta_count = 0;
+   _delta_bytes = 0;
+   _base_bytes = 0;
    ilog("Done wiping object database.");
 }
 
 void object_database::open(const fc::path& data_dir)
 { try {
    _data_dir = data_dir;
+   _full_flush_needed = true;
+   _delta_count = 0;
+   _delta_bytes = 0;
+   if( !fc::exists( _data_dir / "object_database" ) )
+      return;
    if( fc::exists( _data_dir / "object_database" / "lock" ) )
    {
        wlog("Ignoring locked object_database");
@@ -139,24 +388,98 @@ void object_database::open(const fc::path& data_dir)
    }
    std::vector<fc::future<void>> tasks;
    tasks.reserve(200);
-
-   auto push_task = [this,&tasks]( size_t space, size_t type ) {
-      if( _index[space][type] )
-         tasks.push_back( fc::do_parallel( [this,space,type] () {
-            _index[space][type]->open( _data_dir / "object_database" / fc::to_string(space) / fc::to_string(type) );
-         } ) );
+   // waits for all tasks, so that none of them is left running on the local data if one of them fails
+   auto wait_all = [&tasks]() {
+      std::exception_ptr failure;
+      for( auto& task : tasks )
+      {
+         try {
+            task.wait();
+         } catch( ... ) {
+            if( !failure )
+               failure = std::current_exception();
+         }
+      }
+      tasks.clear();
+      if( failure )
+         std::rethrow_exception( failure );
    };
 
    ilog("Opening object database from ${d} ...", ("d", data_dir));
+
+   // Map the saved indexes and split them into ranges of objects
+   std::vector< std::pair< index*, fc::path > > saved;
    const auto spaces = _index.size();
    for( size_t space = 0; space < spaces; ++space )
    {
       const auto types = _index[space].size();
       for( size_t type = 0; type  < types; ++type )
-         push_task( space, type );
+         if( _index[space][type] )
+            saved.emplace_back( _index[space][type].get(),
+                                _data_dir / "object_database" / fc::to_string(space) / fc::to_string(type) );
    }
-   for( auto& task : tasks )
-      task.wait();
+   std::vector< unique_ptr<index_loader> > loaders( saved.size() );
+   for( size_t i = 0; i < saved.size(); ++i )
+      tasks.push_back( fc::do_parallel( [&saved,&loaders,i] () {
+         loaders[i] = saved[i].first->start_open( saved[i].second );
+      } ) );
+   wait_all();
+
+   // Unpack the ranges in parallel, so that big indexes are not loaded by a single thread. Only a limited number
+   // of ranges is unpacked at a time, to bound the memory held by unpacked objects which are not inserted yet.
+   std::vector< std::pair< index_loader*, size_t > > ranges;
+   for( const auto& loader : loaders )
+      if( loader )
+         for( size_t range = 0; range < loader->range_count(); ++range )
+            ranges.emplace_back( loader.get(), range );
+   const size_t ranges_per_step = 2 * std::max( 1u, std::thread::hardware_concurrency() );
+   for( size_t first = 0; first < ranges.size(); first += ranges_per_step )
+   {
+      const size_t last = std::min( first + ranges_per_step, ranges.size() );
+      for( size_t i = first; i < last; ++i )
+         tasks.push_back( fc::do_parallel( [&ranges,i] () {
+            ranges[i].first->unpack_range( ranges[i].second );
+         } ) );
+      wait_all();
+      // an index can only take one insert at a time, its ranges are adjacent and inserted by a single task
+      for( size_t i = first; i < last; )
+      {
+         size_t end = i + 1;
+         while( end < last && ranges[end].first == ranges[i].first )
+            ++end;
+         tasks.push_back( fc::do_parallel( [&ranges,i,end] () {
+            for( size_t k = i; k < end; ++k )
+               ranges[k].first->insert_range( ranges[k].second );
+         } ) );
+         i = end;
+      }
+      wait_all();
+   }
+
+   // Populate the secondary indexes once all objects are in place, every one of them in its own task
+   for( const auto& loader : loaders )
+      if( loader )
+         for( size_t sindex = 0; sindex < loader->secondary_index_count(); ++sindex )
+         {
+            index_loader* l = loader.get();
+            tasks.push_back( fc::do_parallel( [l,sindex] () {
+               l->populate_secondary_index( sindex );
+            } ) );
+         }
+   wait_all();
+
+   const auto delta_dir = _data_dir / "object_database" / "delta";
+   while( fc::exists( delta_dir / fc::to_string( _delta_count + 1 ) ) )
+   {
+      const auto delta_file = delta_dir / fc::to_string( _delta_count + 1 );
+      load_delta( delta_file );
+      _delta_bytes += fc::file_size( delta_file );
+      ++_delta_count;
+   }
+   if( _delta_count > 0 )
+      ilog( "Applied ${n} incremental object database updates", ("n",_delta_count) );
+   _base_bytes = saved_index_bytes();
+   _full_flush_needed = false;
    ilog( "Done opening object database." );
 
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
@@ -177,6 +500,11 @@ void object_database::save_undo_add( const object& obj )
    _undo_db.on_create( obj );
 }
 
+void object_database::save_undo_reserve_id( object_id_type id )
+{
+   _undo_db.on_reserve_id( id );
+}
+
 void object_database::save_undo_remove(const object& obj)
 {
    _undo_db.on_remove( obj );
@@ -50,10 +50,17 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
    if( force_enable ) 
       _disabled = false;
 
+   // a new outermost session means that the previous one has ended
+   if( _active_sessions == 0 && !_stack.empty() && !_stack.back().closed )
+      close_last_state();
+
    while( size() > max_size() )
+   {
+      remove_state_bytes( _stack.front() );
       _stack.pop_front();
+   }
 
-   _stack.emplace_back();
+   _stack.emplace_back( _node_pool );
    ++_active_sessions;
    return session(*this, disable_on_exit );
 }
@@ -62,7 +69,7 @@ void undo_database::on_create( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      _stack.emplace_back( _node_pool );
    auto& state = _stack.back();
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
@@ -70,25 +77,41 @@ void undo_database::on_create( const object& obj )
       state.old_index_next_ids[index_id] = obj.id;
    state.new_ids.insert(obj.id);
 }
+void undo_database::on_reserve_id( object_id_type id )
+{
+   if( _disabled ) return;
+
+   if( _stack.empty() )
+      _stack.emplace_back( _node_pool );
+   auto& state = _stack.back();
+   auto index_id = object_id_type( id.space(), id.type(), 0 );
+   auto itr = state.old_index_next_ids.find( index_id );
+   if( itr == state.old_index_next_ids.end() )
+      state.old_index_next_ids[index_id] = id;
+}
 void undo_database::on_modify( const object& obj )
 {
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      _stack.emplace_back( _node_pool );
    auto& state = _stack.back();
    if( state.new_ids.find(obj.id) != state.new_ids.end() )
       return;
    auto itr =  state.old_values.find(obj.id);
    if( itr != state.old_values.end() ) return;
-   state.old_values[obj.id] = obj.clone();
+   if( state.old_packed_values.find(obj.id) != state.old_packed_values.end() ) return;
+   if( _packed_mode )
+      state.old_packed_values[obj.id] = obj.pack();
+   else
+      state.old_values[obj.id] = obj.clone();
 }
 void undo_database::on_remove( const object& obj )
 {
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      _stack.emplace_back( _node_pool );
    undo_state& state = _stack.back();
    if( state.new_ids.count(obj.id) > 0 )
    {
@@ -101,6 +124,15 @@ void undo_database::on_remove( const object& obj )
       state.old_values.erase(obj.id);
       return;
    }
+   auto packed_itr = state.old_packed_values.find(obj.id);
+   if( packed_itr != state.old_packed_values.end() )
+   {
+      auto pre_image = obj.clone();
+      pre_image->unpack_from( packed_itr->second );
+      state.removed[obj.id] = std::move(pre_image);
+      state.old_packed_values.erase(packed_itr);
+      return;
+   }
    if( state.removed.count(obj.id) > 0 ) return;
    state.removed[obj.id] = obj.clone();
 }
@@ -117,6 +149,11 @@ void undo_database::undo()
       _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
    }
 
+   for( auto& item : state.old_packed_values )
+   {
+      _db.modify( _db.get_object( item.first ), [&]( object& obj ){ obj.unpack_from( item.second ); } );
+   }
+
    for( auto ritr = state.new_ids.begin(); ritr != state.new_ids.end(); ++ritr  )
    {
       _db.remove( _db.get_object(*ritr) );
@@ -130,6 +167,7 @@ void undo_database::undo()
    for( auto& item : state.removed )
       _db.insert( std::move(*item.second) );
 
+   remove_state_bytes( state );
    _stack.pop_back();
    enable();
    --_active_sessions;
@@ -147,6 +185,9 @@ void undo_database::merge()
    FC_ASSERT( _stack.size() >=2 );
    auto& state = _stack.back();
    auto& prev_state = _stack[_stack.size()-2];
+   // the merged state grows, it is measured again when it is closed
+   remove_state_bytes( prev_state );
+   prev_state.closed = false;
 
    // An object's relationship to a state can be:
    // in new_ids            : new
@@ -198,7 +239,8 @@ void undo_database::merge()
          // new+upd -> new, type A
          continue;
       }
-      if( prev_state.old_values.find(obj.second->id) != prev_state.old_values.end() )
+      if( prev_state.old_values.find(obj.second->id) != prev_state.old_values.end()
+            || prev_state.old_packed_values.find(obj.second->id) != prev_state.old_packed_values.end() )
       {
          // upd(was=X) + upd(was=Y) -> upd(was=X), type A
          continue;
@@ -209,6 +251,20 @@ void undo_database::merge()
       prev_state.old_values[obj.second->id] = std::move(obj.second);
    }
 
+   // *+upd, packed pre-images follow the same rules
+   for( auto& obj : state.old_packed_values )
+   {
+      if( prev_state.new_ids.find(obj.first) != prev_state.new_ids.end() )
+         continue; // new+upd -> new, type A
+      if( prev_state.old_values.find(obj.first) != prev_state.old_values.end()
+            || prev_state.old_packed_values.find(obj.first) != prev_state.old_packed_values.end() )
+         continue; // upd(was=X) + upd(was=Y) -> upd(was=X), type A
+      // del+upd -> N/A
+      assert( prev_state.removed.find(obj.first) == prev_state.removed.end() );
+      // nop+upd(was=Y) -> upd(was=Y), type B
+      prev_state.old_packed_values[obj.first] = std::move(obj.second);
+   }
+
    // *+new, but we assume the N/A cases don't happen, leaving type B nop+new -> new
    for( auto id : state.new_ids )
       prev_state.new_ids.insert(id);
@@ -247,6 +303,16 @@ void undo_database::merge()
          prev_state.old_values.erase(obj.second->id);
          continue;
       }
+      auto packed_it = prev_state.old_packed_values.find(obj.second->id);
+      if( packed_it != prev_state.old_packed_values.end() )
+      {
+         // upd(was=X) + del(was=Y) -> del(was=X), reuse the object of Y to hold X
+         object_id_type id = obj.second->id;
+         obj.second->unpack_from( packed_it->second );
+         prev_state.removed[id] = std::move(obj.second);
+         prev_state.old_packed_values.erase(packed_it);
+         continue;
+      }
       // del + del -> N/A
       assert( prev_state.removed.find( obj.second->id ) == prev_state.removed.end() );
       // nop + del(was=Y) -> del(was=Y)
@@ -275,6 +341,11 @@ void undo_database::pop_commit()
          _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
       }
 
+      for( auto& item : state.old_packed_values )
+      {
+         _db.modify( _db.get_object( item.first ), [&]( object& obj ){ obj.unpack_from( item.second ); } );
+      }
+
       for( auto ritr = state.new_ids.begin(); ritr != state.new_ids.end(); ++ritr  )
       {
          _db.remove( _db.get_object(*ritr) );
@@ -288,6 +359,7 @@ void undo_database::pop_commit()
       for( auto& item : state.removed )
          _db.insert( std::move(*item.second) );
 
+      remove_state_bytes( state );
       _stack.pop_back();
    }
    catch ( const fc::exception& e )
@@ -304,4 +376,112 @@ const undo_state& undo_database::head()const
    return _stack.back();
 }
 
+void undo_database::set_max_bytes( size_t max_bytes )
+{
+   _max_bytes = max_bytes;
+   enforce_max_bytes();
+}
+
+undo_database_usage undo_database::get_usage()const
+{
+   undo_database_usage result;
+   for( const auto& state : _stack )
+   {
+      if( !state.closed )
+         continue;
+      ++result.states;
+      if( state.compacted )
+         ++result.compacted_states;
+   }
+   result.bytes = _bytes;
+   result.last_state_bytes = _last_state_bytes;
+   result.largest_state_bytes = _largest_state_bytes;
+   result.max_bytes = _max_bytes;
+   return result;
+}
+
+void undo_database::close_last_state()
+{
+   undo_state& state = _stack.back();
+   state.bytes = estimate_bytes( state );
+   state.closed = true;
+   _bytes += state.bytes;
+   _last_state_bytes = state.bytes;
+   _largest_state_bytes = std::max( _largest_state_bytes, state.bytes );
+   enforce_max_bytes();
+}
+
+void undo_database::remove_state_bytes( const undo_state& state )
+{
+   if( state.closed )
+      _bytes -= state.bytes;
+}
+
+void undo_database::enforce_max_bytes()
+{
+   if( _max_bytes == 0 )
+      return;
+   // the oldest states are the least likely to be undone
+   for( auto itr = _stack.begin(); itr != _stack.end() && _bytes > _max_bytes; ++itr )
+   {
+      undo_state& state = *itr;
+      if( !state.closed || state.compacted )
+         continue;
+      for( auto& item : state.old_values )
+         state.old_packed_values[item.first] = item.second->pack();
+      state.old_values.clear();
+      state.compacted = true;
+      _bytes -= state.bytes;
+      state.bytes = estimate_bytes( state );
+      _bytes += state.bytes;
+   }
+}
+
+size_t undo_database::estimate_bytes( const undo_state& state )const
+{
+   std::map< std::pair<uint8_t,uint8_t>, undo_index_usage > usage_by_index;
+   add_usage_by_index( state, usage_by_index );
+   size_t result = 0;
+   for( const auto& usage : usage_by_index )
+      result += usage.second.copies * _db.get_index( usage.first.first, usage.first.second ).object_node_size()
+                + usage.second.bytes;
+   return result;
+}
+
+std::map< std::pair<uint8_t,uint8_t>, undo_index_usage > undo_database::get_usage_by_index()const
+{
+   std::map< std::pair<uint8_t,uint8_t>, undo_index_usage > result;
+   for( const auto& state : _stack )
+      add_usage_by_index( state, result );
+   return result;
+}
+
+void undo_database::add_usage_by_index( const undo_state& state,
+                                        std::map< std::pair<uint8_t,uint8_t>, undo_index_usage >& result )const
+{
+   // a node of an unordered container holds the value, a link and usually the cached hash
+   const auto node_size = []( size_t value_size ) { return value_size + 2 * sizeof(void*); };
+   const auto usage_of = [&result]( const object_id_type& id ) -> undo_index_usage& {
+      return result[ std::make_pair( id.space(), id.type() ) ];
+   };
+   for( const auto& item : state.old_values )
+   {
+      auto& usage = usage_of( item.first );
+      ++usage.copies;
+      usage.bytes += node_size( sizeof(item) );
+   }
+   for( const auto& item : state.old_packed_values )
+      usage_of( item.first ).bytes += node_size( sizeof(item) ) + item.second.capacity();
+   for( const auto& item : state.old_index_next_ids )
+      usage_of( item.first ).bytes += node_size( sizeof(item) );
+   for( const auto& id : state.new_ids )
+      usage_of( id ).bytes += node_size( sizeof(id) );
+   for( const auto& item : state.removed )
+   {
+      auto& usage = usage_of( item.first );
+      ++usage.copies;
+      usage.bytes += node_size( sizeof(item) );
+   }
+}
+
 } } // graphene::db
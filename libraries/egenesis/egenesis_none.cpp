@@ -45,4 +45,14 @@ fc::sha256 get_egenesis_json_hash()
    return fc::sha256::hash( "" );
 }
 
+void compute_egenesis_binary( std::string& result )
+{
+   result = "";
+}
+
+fc::sha256 get_egenesis_binary_hash()
+{
+   return fc::sha256::hash( "" );
+}
+
 } }
@@ -30,5 +30,34 @@ string( REGEX REPLACE ";" "\",\n\"" genesis_json_array "${_chunks}" )
 set( genesis_json_array "\"${genesis_json_array}\",\n\"${_rest}\"" )
 set( genesis_json_array_height "${_chunks_len} - ${_seen} + 2" )
 
+# The binary genesis is embedded as string literals of \x escapes, in chunks of 2048 bytes
+set( genesis_binary_chunk_size 2048 )
+set( genesis_binary_length 0 )
+string( SHA256 genesis_binary_hash "" )
+set( genesis_binary_array "\"\"" )
+set( genesis_binary_array_height 1 )
+if( embed_genesis_binary_args )
+  message( STATUS "Embedding binary genesis" )
+  file( SHA256 "${embed_genesis_binary_args}" genesis_binary_hash )
+  file( READ "${embed_genesis_binary_args}" _hex HEX )
+  string( LENGTH "${_hex}" _hex_length )
+  math( EXPR genesis_binary_length "${_hex_length} / 2" )
+
+  string( RANDOM LENGTH 4096 _hex_dots )
+  string( REGEX REPLACE "." "." _hex_dots "${_hex_dots}" )
+  string( REGEX MATCHALL "${_hex_dots}" _hex_chunks "${_hex}" )
+  string( REGEX REPLACE ";" "" _hex_seen "${_hex_chunks}" )
+  string( LENGTH "${_hex_seen}" _hex_seen )
+  string( SUBSTRING "${_hex}" ${_hex_seen} -1 _hex_rest )
+  if( NOT "${_hex_rest}" STREQUAL "" )
+    list( APPEND _hex_chunks "${_hex_rest}" )
+  endif()
+  list( LENGTH _hex_chunks genesis_binary_array_height )
+
+  string( REGEX REPLACE "([0-9a-f][0-9a-f])" "\\\\x\\1" genesis_binary_array "${_hex_chunks}" )
+  string( REGEX REPLACE ";" "\",\n\"" genesis_binary_array "${genesis_binary_array}" )
+  set( genesis_binary_array "\"${genesis_binary_array}\"" )
+endif( embed_genesis_binary_args )
+
 configure_file( "${CMAKE_CURRENT_SOURCE_DIR}/egenesis_full.cpp.tmpl"
                 "${CMAKE_CURRENT_BINARY_DIR}/egenesis_full.cpp" )
@@ -48,4 +48,17 @@ void compute_egenesis_json( std::string& result );
  */
 fc::sha256 get_egenesis_json_hash();
 
+/**
+ * Get the egenesis in binary form, or the empty string if it was not compiled in.
+ *
+ * It is the packed pair of the hash of the egenesis JSON and the genesis state parsed from that JSON, which
+ * saves parsing the JSON on startup.
+ */
+void compute_egenesis_binary( std::string& result );
+
+/**
+ * The data returned by compute_egenesis_binary() should have this hash.
+ */
+fc::sha256 get_egenesis_binary_hash();
+
 } } // graphene::egenesis
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/chain/genesis_state.hpp>
+
+#include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+
+#include <fstream>
+#include <iostream>
+
+/**
+ * Converts a genesis JSON file to the binary form which is embedded next to the JSON by egenesis_full.
+ *
+ * The output is the packed pair of the hash of the JSON file (the chain ID) and the genesis state.
+ */
+int main( int argc, char** argv )
+{
+   try
+   {
+      if( argc != 3 )
+      {
+         std::cerr << "Usage: " << argv[0] << " <genesis.json> <output file>\n";
+         return 1;
+      }
+
+      std::string genesis_json;
+      fc::read_file_contents( fc::path( argv[1] ), genesis_json );
+      const fc::sha256 json_hash = fc::sha256::hash( genesis_json );
+      const auto embedded = std::make_pair( json_hash, graphene::chain::genesis_state_type::from_variant_in_parallel(
+                                                          fc::json::from_string( genesis_json ), 20 ) );
+      const std::vector<char> packed = fc::raw::pack( embedded );
+
+      // the node trusts the binary form, so make sure it converts back to the same genesis state
+      std::pair< fc::sha256, graphene::chain::genesis_state_type > unpacked;
+      fc::raw::unpack( packed, unpacked );
+      FC_ASSERT( unpacked.first == json_hash );
+      FC_ASSERT( fc::json::to_string( fc::variant( unpacked.second, 20 ) )
+                 == fc::json::to_string( fc::variant( embedded.second, 20 ) ),
+                 "The binary genesis does not match the JSON genesis" );
+
+      std::ofstream out( argv[2], std::ios::binary | std::ios::trunc );
+      out.write( packed.data(), packed.size() );
+      out.close();
+      FC_ASSERT( out, "Unable to write ${f}", ("f", argv[2]) );
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
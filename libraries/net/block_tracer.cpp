@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/net/block_tracer.hpp>
+
+#include <graphene/protocol/block.hpp>
+
+#include <fc/variant.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace net {
+
+void block_tracer::add_span( const protocol::block_id_type& block_id, const char* stage,
+                             const fc::time_point& start, const fc::time_point& end )
+{
+   block_trace_span span;
+   span.stage = stage;
+   span.start = start;
+   span.duration_microseconds = std::max<int64_t>( 0, ( end - start ).count() );
+
+   std::lock_guard<std::mutex> guard( _mutex );
+   auto itr = std::find_if( _traces.begin(), _traces.end(),
+                            [&block_id]( const block_trace& trace ) { return trace.block_id == block_id; } );
+   if( itr == _traces.end() )
+   {
+      if( _max_blocks == 0 )
+         return;
+      _traces.emplace_front();
+      _traces.front().block_id = block_id;
+      _traces.front().block_num = protocol::block_header::num_from_id( block_id );
+      if( _traces.size() > _max_blocks )
+         _traces.pop_back();
+      itr = _traces.begin();
+   }
+   itr->spans.emplace_back( std::move( span ) );
+}
+
+std::vector<block_trace> block_tracer::get_traces()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return std::vector<block_trace>( _traces.begin(), _traces.end() );
+}
+
+fc::variant_object block_tracer::get_chrome_trace()const
+{
+   const std::vector<block_trace> traces = get_traces();
+   fc::variants events;
+   for( auto trace = traces.rbegin(); trace != traces.rend(); ++trace )
+   {
+      const std::string block_id = trace->block_id.str();
+      for( const auto& span : trace->spans )
+      {
+         fc::mutable_variant_object event;
+         event["name"] = span.stage;
+         event["cat"] = "block";
+         event["ph"] = "X";
+         event["ts"] = span.start.time_since_epoch().count();
+         event["dur"] = span.duration_microseconds;
+         event["pid"] = 1;
+         event["tid"] = trace->block_num;
+         event["args"] = fc::mutable_variant_object( "block_id", block_id );
+         events.emplace_back( std::move( event ) );
+      }
+   }
+   fc::mutable_variant_object result;
+   result["traceEvents"] = std::move( events );
+   result["displayTimeUnit"] = "ms";
+   return result;
+}
+
+} } // graphene::net
@@ -25,10 +25,20 @@
 
 #include <fc/io/raw.hpp>
 
+#include <cstring>
+
 namespace graphene { namespace net {
 
   const core_message_type_enum trx_message::type                             = core_message_type_enum::trx_message_type;
   const core_message_type_enum block_message::type                           = core_message_type_enum::block_message_type;
+  const core_message_type_enum compact_block_message::type                   = core_message_type_enum::compact_block_message_type;
+  const core_message_type_enum fetch_compact_block_transactions_message::type
+                                             = core_message_type_enum::fetch_compact_block_transactions_message_type;
+  const core_message_type_enum compact_block_transactions_message::type
+                                             = core_message_type_enum::compact_block_transactions_message_type;
+  const core_message_type_enum fetch_block_range_message::type               = core_message_type_enum::fetch_block_range_message_type;
+  const core_message_type_enum block_range_message::type                     = core_message_type_enum::block_range_message_type;
+  const core_message_type_enum trx_batch_message::type                       = core_message_type_enum::trx_batch_message_type;
   const core_message_type_enum item_ids_inventory_message::type              = core_message_type_enum::item_ids_inventory_message_type;
   const core_message_type_enum blockchain_item_ids_inventory_message::type   = core_message_type_enum::blockchain_item_ids_inventory_message_type;
   const core_message_type_enum fetch_blockchain_item_ids_message::type       = core_message_type_enum::fetch_blockchain_item_ids_message_type;
@@ -49,8 +59,72 @@ namespace graphene { namespace net {
 
 } } // graphene::net
 
+namespace graphene { namespace net {
+
+  item_hash_t trx_message::message_id(const graphene::protocol::signed_transaction& signed_trx)
+  {
+    // the message carries the transaction serialized as it is, so hash that directly
+    item_hash_t::encoder enc;
+    fc::raw::pack(enc, signed_trx);
+    return enc.result();
+  }
+
+  item_hash_t trx_message::message_id(const graphene::protocol::precomputable_transaction& precomputed_trx)
+  {
+    const std::vector<char>& packed = precomputed_trx.get_packed_transaction();
+    item_hash_t::encoder enc;
+    enc.write(packed.data(), packed.size());
+    fc::raw::pack(enc, precomputed_trx.signatures);
+    return enc.result();
+  }
+
+  template<>
+  message::message( const trx_message& m )
+  {
+    msg_type = trx_message::type;
+    data     = m.trx.get_packed_with_signatures();
+    size     = (uint32_t)data.size();
+  }
+
+  message block_message::pack_message(const std::vector<char>& packed_block, const block_id_type& block_id)
+  {
+    // the block id is serialized as its raw bytes after the block
+    message result;
+    result.msg_type = block_message::type;
+    result.data.reserve(packed_block.size() + block_id.data_size());
+    result.data.insert(result.data.end(), packed_block.begin(), packed_block.end());
+    result.data.insert(result.data.end(), block_id.data(), block_id.data() + block_id.data_size());
+    result.size = (uint32_t)result.data.size();
+    return result;
+  }
+
+  block_id_type block_message::block_id_of(const message& block_message_to_read)
+  {
+    FC_ASSERT(block_message_to_read.msg_type.value() == block_message::type);
+    block_id_type result;
+    FC_ASSERT(block_message_to_read.data.size() >= result.data_size(), "The block message is truncated");
+    memcpy(result.data(), block_message_to_read.data.data() + block_message_to_read.data.size() - result.data_size(),
+           result.data_size());
+    return result;
+  }
+
+} } // graphene::net
+
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::trx_message, BOOST_PP_SEQ_NIL, (trx) )
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::block_message, BOOST_PP_SEQ_NIL, (block)(block_id) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::compact_block_transaction, BOOST_PP_SEQ_NIL,
+                                (trx_message_hash)(operation_results) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::compact_block_message, BOOST_PP_SEQ_NIL,
+                                (block_message_hash)(block_header)(block_id)(transactions) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::fetch_compact_block_transactions_message, BOOST_PP_SEQ_NIL,
+                                (block_message_hash)(transaction_indexes) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::compact_block_transactions_message, BOOST_PP_SEQ_NIL,
+                                (block_message_hash)(transactions) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::fetch_block_range_message, BOOST_PP_SEQ_NIL,
+                                (first_block_num)(block_count) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::block_range_message, BOOST_PP_SEQ_NIL,
+                                (first_block_num)(packed_blocks) )
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::trx_batch_message, BOOST_PP_SEQ_NIL, (packed_transactions) )
 
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::item_id, BOOST_PP_SEQ_NIL,
                                (item_type)
@@ -131,6 +205,13 @@ FC_REFLECT_DERIVED_NO_TYPENAME(graphene::net::get_current_connections_reply_mess
 
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::trx_message )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::block_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::compact_block_transaction )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::compact_block_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::fetch_compact_block_transactions_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::compact_block_transactions_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::fetch_block_range_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::block_range_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::trx_batch_message )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::item_id )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::item_ids_inventory_message )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::blockchain_item_ids_inventory_message )
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+#include <fc/variant_object.hpp>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace net {
+
+   /// One stage of the handling of a block, e.g. reading it from a peer or pushing it to the database
+   struct block_trace_span
+   {
+      std::string                  stage;
+      fc::time_point               start;
+      uint64_t                     duration_microseconds = 0;
+   };
+
+   /// The stages of the handling of one block, in the order they ended
+   struct block_trace
+   {
+      protocol::block_id_type        block_id;
+      uint32_t                       block_num = 0;
+      std::vector<block_trace_span>  spans;
+   };
+
+   /**
+    * @class block_tracer
+    * @brief The stages of the handling of the most recently seen blocks, from the socket to the re-broadcast
+    *
+    * Spans are added by the P2P node and by its delegate, possibly in different threads, and are grouped by block
+    * id.  Only the last @ref max_blocks blocks are kept, the oldest block is dropped when a new one is seen.
+    */
+   class block_tracer
+   {
+      public:
+         explicit block_tracer( size_t max_blocks ) : _max_blocks( max_blocks ) {}
+
+         size_t max_blocks()const { return _max_blocks; }
+
+         void add_span( const protocol::block_id_type& block_id, const char* stage,
+                        const fc::time_point& start, const fc::time_point& end );
+
+         /// @return the traced blocks, newest first
+         std::vector<block_trace> get_traces()const;
+
+         /**
+          * @return the traced blocks in the Chrome trace event format, one complete event per span with the block
+          *         number as its thread id, which can be loaded in chrome://tracing or Perfetto
+          */
+         fc::variant_object get_chrome_trace()const;
+
+      private:
+         const size_t             _max_blocks;
+         mutable std::mutex       _mutex;
+         std::deque<block_trace>  _traces;
+   };
+
+   /// Adds a span for the lifetime of the scope to a tracer, if there is one
+   class block_trace_scope
+   {
+      public:
+         block_trace_scope( block_tracer* tracer, const protocol::block_id_type& block_id, const char* stage )
+         : _tracer( tracer ), _block_id( block_id ), _stage( stage ),
+           _start( tracer != nullptr ? fc::time_point::now() : fc::time_point() ) {}
+         ~block_trace_scope()
+         {
+            if( _tracer != nullptr )
+               _tracer->add_span( _block_id, _stage, _start, fc::time_point::now() );
+         }
+
+      private:
+         block_tracer*                  _tracer;
+         const protocol::block_id_type  _block_id;
+         const char*                    _stage;
+         const fc::time_point           _start;
+   };
+
+} } // graphene::net
+
+FC_REFLECT( graphene::net::block_trace_span, (stage)(start)(duration_microseconds) )
+FC_REFLECT( graphene::net::block_trace, (block_id)(block_num)(spans) )
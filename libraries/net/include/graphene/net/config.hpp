@@ -61,6 +61,11 @@
 #define GRAPHENE_NET_DEFAULT_MAX_CONNECTIONS                 200
 
 #define GRAPHENE_NET_MAXIMUM_QUEUED_MESSAGES_IN_BYTES        (1024 * 1024)
+/**
+ * Byte budget of the high priority part of a peer's send queue (blocks and block inventory),
+ * it must be able to hold a few blocks of the maximum size
+ */
+#define GRAPHENE_NET_MAXIMUM_QUEUED_HIGH_PRIORITY_MESSAGES_IN_BYTES (4 * MAX_MESSAGE_SIZE)
 
 /**
  * When we receive a message from the network, we advertise it to
@@ -86,6 +91,22 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * The most blocks sent in reply to one fetch_block_range_message, and the most bytes of serialized blocks in the
+ * reply, which leaves room for the rest of the message
+ */
+#define GRAPHENE_NET_MAX_BLOCKS_PER_RANGE_REQUEST            GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING
+#define GRAPHENE_NET_MAX_BLOCK_RANGE_DATA_SIZE               (MAX_MESSAGE_SIZE - 16*1024)
+
+/**
+ * Transactions requested by a peer which supports transaction batches are collected for this many milliseconds,
+ * or until this many of them are collected, and sent in one trx_batch_message.  A batch size of 0 or 1 disables
+ * batching.  The serialized transactions in a batch never exceed GRAPHENE_NET_MAX_TRX_BATCH_DATA_SIZE.
+ */
+#define GRAPHENE_NET_DEFAULT_TRX_BATCH_FLUSH_INTERVAL_MS     5
+#define GRAPHENE_NET_DEFAULT_MAX_TRX_BATCH_SIZE              100
+#define GRAPHENE_NET_MAX_TRX_BATCH_DATA_SIZE                 (MAX_MESSAGE_SIZE - 16*1024)
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -109,9 +130,31 @@
 
 #define GRAPHENE_NET_MAX_TRX_PER_SECOND                      1000
 
+/**
+ * The transactions of every peer are limited by a token bucket, which is refilled at GRAPHENE_NET_PEER_TRX_PER_SECOND
+ * and holds up to GRAPHENE_NET_PEER_TRX_BURST tokens.  Transactions of a peer without tokens are dropped, so that a
+ * single peer can not saturate the pending transactions of the node.
+ */
+#define GRAPHENE_NET_PEER_TRX_PER_SECOND                     200
+#define GRAPHENE_NET_PEER_TRX_BURST                          1000
+
+/**
+ * The items we have advertised to a peer are remembered in a rolling bloom filter, which has room for the
+ * transactions of GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES at GRAPHENE_NET_MAX_TRX_PER_SECOND.  A false positive
+ * only means that we don't advertise an item to the peer, it will learn about the item from its other peers.
+ */
+#define GRAPHENE_NET_INVENTORY_FILTER_CAPACITY               (GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES * GRAPHENE_NET_MAX_TRX_PER_SECOND * 60)
+#define GRAPHENE_NET_DEFAULT_INVENTORY_FILTER_FALSE_POSITIVE_RATE 0.000001
+
 #define GRAPHENE_NET_MAX_NESTED_OBJECTS                      (250)
 
 #define MAXIMUM_PEERDB_SIZE 1000
 
+/**
+ * The quality score, in milliseconds, assumed for the peers which have not been measured yet, see
+ * peer_connection::get_quality_score_ms().  Peers which were measured to be faster are preferred to them.
+ */
+#define GRAPHENE_NET_DEFAULT_PEER_QUALITY_SCORE_MS 500
+
 constexpr size_t MAX_BLOCKS_TO_HANDLE_AT_ONCE = 200;
 constexpr size_t MAX_SYNC_BLOCKS_TO_PREFETCH = 10 * MAX_BLOCKS_TO_HANDLE_AT_ONCE;
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <graphene/net/config.hpp>
+#include <graphene/net/message.hpp>
 
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/crypto/elliptic.hpp>
@@ -85,6 +86,12 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
+    fetch_compact_block_transactions_message_type = 5019,
+    compact_block_transactions_message_type      = 5020,
+    fetch_block_range_message_type               = 5021,
+    block_range_message_type                     = 5022,
+    trx_batch_message_type                       = 5023,
     core_message_type_last                       = 5099
   };
 
@@ -99,8 +106,21 @@ namespace graphene { namespace net {
       explicit trx_message(const graphene::protocol::signed_transaction& signed_trx) :
         trx(signed_trx)
       {}
+      /// Keeps the serialization which is cached by @p precomputed_trx
+      explicit trx_message(const graphene::protocol::precomputable_transaction& precomputed_trx) :
+        trx(precomputed_trx)
+      {}
+
+      /// @return the id of the trx_message which would carry the transaction, without building the message
+      static item_hash_t message_id(const graphene::protocol::signed_transaction& signed_trx);
+      /// @return the id of the trx_message which would carry the transaction, from its cached serialization
+      static item_hash_t message_id(const graphene::protocol::precomputable_transaction& precomputed_trx);
    };
 
+   /// Builds the message from the cached serialization of the transaction instead of packing it again
+   template<>
+   message::message( const trx_message& m );
+
    struct block_message
    {
       static const core_message_type_enum type;
@@ -112,6 +132,96 @@ namespace graphene { namespace net {
       signed_block    block;
       block_id_type   block_id;
 
+      /**
+       * @return the block_message carrying the serialized block @p packed_block, built without unpacking the block.
+       * The id is not checked against the block, this happens when the block is pushed.
+       */
+      static message pack_message(const std::vector<char>& packed_block, const block_id_type& block_id);
+      /// @return the id a block_message carries, read from the end of the message without unpacking the block
+      static block_id_type block_id_of(const message& block_message_to_read);
+   };
+
+   /// A transaction of a @ref compact_block_message
+   struct compact_block_transaction
+   {
+      /// the hash of the trx_message of the transaction, i.e. its item hash when relayed on its own
+      item_hash_t                                       trx_message_hash;
+      std::vector<graphene::protocol::operation_result> operation_results;
+   };
+
+   /**
+    * Sent instead of a block_message in reply to a fetch_items_message to peers which support compact blocks.
+    * It carries the block header and refers to the transactions by hash, the receiver rebuilds the block from
+    * the transactions it has seen recently and fetches the missing ones with a
+    * fetch_compact_block_transactions_message.
+    */
+   struct compact_block_message
+   {
+      static const core_message_type_enum type;
+
+      item_hash_t                             block_message_hash; ///< the hash of the full block_message
+      graphene::protocol::signed_block_header block_header;
+      block_id_type                           block_id;
+      std::vector<compact_block_transaction>  transactions;
+   };
+
+   /// Requests the transactions of a compact block which the receiver could not find
+   struct fetch_compact_block_transactions_message
+   {
+      static const core_message_type_enum type;
+
+      item_hash_t           block_message_hash;
+      std::vector<uint32_t> transaction_indexes;
+   };
+
+   /// The reply to a fetch_compact_block_transactions_message, in the order of the requested indexes
+   struct compact_block_transactions_message
+   {
+      static const core_message_type_enum type;
+
+      item_hash_t                     block_message_hash;
+      std::vector<signed_transaction> transactions;
+   };
+
+   /// Requests the blocks of the sender's main chain from first_block_num on, sent to peers which support block ranges
+   struct fetch_block_range_message
+   {
+      static const core_message_type_enum type;
+
+      uint32_t first_block_num = 0;
+      uint32_t block_count = 0;
+
+      fetch_block_range_message() {}
+      fetch_block_range_message(uint32_t first_block_num, uint32_t block_count) :
+        first_block_num(first_block_num),
+        block_count(block_count)
+      {}
+   };
+
+   /**
+    * The reply to a fetch_block_range_message.  The blocks are serialized as they are stored in the block database,
+    * there may be fewer of them than requested if the sender doesn't have them or they would not fit in a message.
+    */
+   struct block_range_message
+   {
+      static const core_message_type_enum type;
+
+      uint32_t                       first_block_num = 0;
+      std::vector<std::vector<char>> packed_blocks;
+
+      block_range_message() {}
+      explicit block_range_message(uint32_t first_block_num) : first_block_num(first_block_num) {}
+   };
+
+   /**
+    * Several requested transactions sent in one message, to peers which support transaction batches.  Each entry
+    * is the data of the trx_message which would have been sent otherwise.
+    */
+   struct trx_batch_message
+   {
+      static const core_message_type_enum type;
+
+      std::vector<std::vector<char>> packed_transactions;
    };
 
   struct item_ids_inventory_message
@@ -422,6 +532,12 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
+                 (fetch_compact_block_transactions_message_type)
+                 (compact_block_transactions_message_type)
+                 (fetch_block_range_message_type)
+                 (block_range_message_type)
+                 (trx_batch_message_type)
                  (core_message_type_last) )
 FC_REFLECT_ENUM(graphene::net::rejection_reason_code, (unspecified)
                                                  (different_chain)
@@ -443,6 +559,13 @@ FC_REFLECT_ENUM(graphene::net::firewall_check_result, (unable_to_check)
 
 FC_REFLECT_TYPENAME( graphene::net::trx_message )
 FC_REFLECT_TYPENAME( graphene::net::block_message )
+FC_REFLECT_TYPENAME( graphene::net::compact_block_transaction )
+FC_REFLECT_TYPENAME( graphene::net::compact_block_message )
+FC_REFLECT_TYPENAME( graphene::net::fetch_compact_block_transactions_message )
+FC_REFLECT_TYPENAME( graphene::net::compact_block_transactions_message )
+FC_REFLECT_TYPENAME( graphene::net::fetch_block_range_message )
+FC_REFLECT_TYPENAME( graphene::net::block_range_message )
+FC_REFLECT_TYPENAME( graphene::net::trx_batch_message )
 FC_REFLECT_TYPENAME( graphene::net::item_id )
 FC_REFLECT_TYPENAME( graphene::net::item_ids_inventory_message )
 FC_REFLECT_TYPENAME( graphene::net::blockchain_item_ids_inventory_message )
@@ -466,6 +589,13 @@ FC_REFLECT_TYPENAME( graphene::net::get_current_connections_reply_message )
 
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::trx_message )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::block_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::compact_block_transaction )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::compact_block_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::fetch_compact_block_transactions_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::compact_block_transactions_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::fetch_block_range_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::block_range_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::trx_batch_message )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::item_id )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::item_ids_inventory_message )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::blockchain_item_ids_inventory_message )
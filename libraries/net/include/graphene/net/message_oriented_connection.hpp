@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
 #include <graphene/net/message.hpp>
 
 namespace graphene { namespace net {
@@ -39,11 +40,17 @@ namespace graphene { namespace net {
     virtual void on_connection_closed(message_oriented_connection* originating_connection) = 0;
   };
 
-  /** uses a secure socket to create a connection that reads and writes a stream of `fc::net::message` objects */
+  /**
+   * uses a secure socket to create a connection that reads and writes a stream of `fc::net::message` objects
+   *
+   * The socket I/O, encryption and message framing are done in @p io_thread if one is given, the delegate is always
+   * called in the thread which created the connection.
+   */
   class message_oriented_connection
   {
      public:
-       message_oriented_connection(message_oriented_connection_delegate* delegate = nullptr);
+       message_oriented_connection(message_oriented_connection_delegate* delegate = nullptr,
+                                   fc::thread* io_thread = nullptr);
        ~message_oriented_connection();
        fc::tcp_socket& get_socket();
 
@@ -59,6 +66,8 @@ namespace graphene { namespace net {
        uint64_t       get_total_bytes_received() const;
        fc::time_point get_last_message_sent_time() const;
        fc::time_point get_last_message_received_time() const;
+       /// @return when the reading of the last received message started, valid while it is delivered
+       fc::time_point get_last_message_read_start_time() const;
        fc::time_point get_connection_time() const;
        fc::sha512     get_shared_secret() const;
      private:
@@ -23,12 +23,15 @@
  */
 #pragma once
 
+#include <graphene/net/block_tracer.hpp>
 #include <graphene/net/core_messages.hpp>
 #include <graphene/net/message.hpp>
 #include <graphene/net/peer_database.hpp>
 
 #include <graphene/protocol/types.hpp>
 
+#include <functional>
+
 namespace graphene { namespace net {
 
   using fc::variant_object;
@@ -47,6 +50,8 @@ namespace graphene { namespace net {
     fc::time_point received_time;
     fc::time_point validated_time;
     node_id_t originating_peer;
+    /// when a peer fetched the message from us for the first time, zero if none has yet
+    fc::time_point first_requested_time;
   };
 
    /**
@@ -68,14 +73,12 @@ namespace graphene { namespace net {
           *
           *  @param blk_msg the message which contains the block
           *  @param sync_mode true if the message was fetched through the sync process, false during normal operation
-          *  @param contained_transaction_msg_ids container for the transactions to write back into
           *  @returns true if this message caused the blockchain to switch forks, false if it did not
           *
           *  @throws exception if error validating the item, otherwise the item is
           *          safe to broadcast on.
           */
-         virtual bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode, 
-                                    std::vector<message_hash_type>& contained_transaction_msg_ids ) = 0;
+         virtual bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode ) = 0;
          
          /**
           *  @brief Called when a new transaction comes in from the network
@@ -111,6 +114,14 @@ namespace graphene { namespace net {
           */
          virtual message get_item( const item_id& id ) = 0;
 
+         /**
+          *  Returns the serialized blocks of our main chain from first_block_num on, as they are stored.
+          *  Stops after count blocks, at the end of the chain, at a block we don't have, or before the
+          *  total size of the result would exceed max_total_size.
+          */
+         virtual std::vector<std::vector<char>> get_packed_blocks( uint32_t first_block_num, uint32_t count,
+                                                                   size_t max_total_size ) = 0;
+
          virtual chain_id_type get_chain_id()const = 0;
 
          /**
@@ -277,7 +288,7 @@ namespace graphene { namespace net {
          *  I have a message ready.
          */
         virtual void  broadcast( const message& item_to_broadcast );
-        virtual void  broadcast_transaction( const signed_transaction& trx )
+        virtual void  broadcast_transaction( const graphene::protocol::precomputable_transaction& trx )
         {
            broadcast( trx_message(trx) );
         }
@@ -305,8 +316,33 @@ namespace graphene { namespace net {
 
         void set_total_bandwidth_limit(uint32_t upload_bytes_per_second, uint32_t download_bytes_per_second);
 
+        /**
+         * Sets the number of threads which handle socket I/O, encryption and message framing of the peer
+         * connections, only the processing of the messages is left to the p2p thread.  With 0 threads, which is
+         * the default, everything is done in the p2p thread.  Must be called before any connection is made.
+         */
+        void set_network_io_thread_count(uint32_t thread_count);
+
+        /**
+         * Runs the task once in the p2p thread and once in each of the network I/O threads and waits for it, e.g.
+         * to set their CPU affinity.  The I/O threads must be set up before with @ref set_network_io_thread_count.
+         */
+        void run_in_network_threads(const std::function<void()>& task);
+
+        /**
+         * Sets the tracer which records how long each received block spent in every stage, from the reading of its
+         * message to its re-broadcast.  The delegate may add its own stages to the same tracer.  Null disables it.
+         */
+        void set_block_tracer(std::shared_ptr<block_tracer> tracer);
+
         fc::variant_object network_get_info() const;
         fc::variant_object network_get_usage_stats() const;
+        /**
+         * Returns counters for diagnosing slow peers: for each connected peer the messages and bytes exchanged by
+         * message type, the send queue, inventory sizes, fetch latencies and block propagation delays, and
+         * a histogram of the propagation delays of the blocks we accepted during normal operation.
+         */
+        fc::variant_object network_get_metrics() const;
 
         std::vector<potential_peer_record> get_potential_peers() const;
 
@@ -320,5 +356,6 @@ namespace graphene { namespace net {
 
 } } // graphene::net
 
-FC_REFLECT(graphene::net::message_propagation_data, (received_time)(validated_time)(originating_peer));
+FC_REFLECT(graphene::net::message_propagation_data,
+           (received_time)(validated_time)(originating_peer)(first_requested_time));
 FC_REFLECT( graphene::net::peer_status, (version)(host)(info) );
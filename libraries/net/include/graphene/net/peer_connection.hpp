@@ -27,6 +27,7 @@
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/message_oriented_connection.hpp>
 #include <graphene/net/config.hpp>
+#include <graphene/net/rolling_bloom_filter.hpp>
 
 #include <boost/tuple/tuple.hpp>
 
@@ -37,6 +38,9 @@
 #include <boost/multi_index/tag.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 
+#include <algorithm>
+#include <array>
+#include <map>
 #include <queue>
 #include <boost/container/deque.hpp>
 #include <fc/thread/future.hpp>
@@ -120,7 +124,8 @@ namespace graphene { namespace net
           enqueue_time(enqueue_time)
         {}
 
-        virtual message get_message(peer_connection_delegate* node) = 0;
+        /// @return the message to send, which stays valid until this queued message is destroyed
+        virtual const message& get_message(peer_connection_delegate* node) = 0;
         /** returns roughly the number of bytes of memory the message is consuming while
          * it is sitting on the queue
          */
@@ -142,7 +147,22 @@ namespace graphene { namespace net
           message_send_time_field_offset(message_send_time_field_offset)
         {}
 
-        message get_message(peer_connection_delegate* node) override;
+        const message& get_message(peer_connection_delegate* node) override;
+        size_t get_size_in_queue() override;
+      };
+
+      /* when you queue up a 'shared_queued_message', the message is shared with the message cache and
+       * the queues of other peers, e.g. when broadcasting, only a reference is stored on the queue
+       */
+      struct shared_queued_message : queued_message
+      {
+        std::shared_ptr<const message> message_to_send;
+
+        explicit shared_queued_message(std::shared_ptr<const message> message_to_send) :
+          message_to_send(std::move(message_to_send))
+        {}
+
+        const message& get_message(peer_connection_delegate* node) override;
         size_t get_size_in_queue() override;
       };
 
@@ -153,18 +173,34 @@ namespace graphene { namespace net
       struct virtual_queued_message : queued_message
       {
         item_id item_to_send;
+        message generated_message;
 
         explicit virtual_queued_message(item_id the_item_to_send) :
           item_to_send(std::move(the_item_to_send))
         {}
 
-        message get_message(peer_connection_delegate* node) override;
+        const message& get_message(peer_connection_delegate* node) override;
         size_t get_size_in_queue() override;
       };
 
 
+      /* messages are queued in one of these classes.  Everything in a higher priority class is sent before
+       * anything in a lower priority class, so blocks don't get stuck behind transactions and address gossip.
+       * Each class has its own byte budget, see get_max_queued_messages_size()
+       */
+      enum message_priority
+      {
+        high_priority_messages = 0, // blocks, compact blocks, block ranges and block inventory
+        normal_priority_messages,   // everything else
+        number_of_message_priorities
+      };
+      static message_priority get_message_priority(const message& message_to_send);
+      static size_t get_max_queued_messages_size(message_priority priority);
+
+      using message_queue = std::queue<std::unique_ptr<queued_message>, std::list<std::unique_ptr<queued_message> > >;
       size_t _total_queued_messages_size = 0;
-      std::queue<std::unique_ptr<queued_message>, std::list<std::unique_ptr<queued_message> > > _queued_messages;
+      std::array<size_t, number_of_message_priorities> _queued_messages_size {};
+      std::array<message_queue, number_of_message_priorities> _queued_messages;
       fc::future<void> _send_queued_messages_done;
     public:
       fc::time_point connection_initiation_time;
@@ -248,15 +284,72 @@ namespace graphene { namespace net
                                                                           boost::multi_index::ordered_non_unique<boost::multi_index::tag<timestamp_index>,
                                                                                                                  boost::multi_index::member<timestamped_item_id, fc::time_point_sec, &timestamped_item_id::timestamp> > > > timestamped_items_set_type;
       timestamped_items_set_type inventory_peer_advertised_to_us;
-      timestamped_items_set_type inventory_advertised_to_peer;
+      /// items we've advertised to this peer, so we don't advertise them again.  Lookups may have false positives
+      rolling_bloom_filter inventory_advertised_to_peer { GRAPHENE_NET_INVENTORY_FILTER_CAPACITY,
+                                                          GRAPHENE_NET_DEFAULT_INVENTORY_FILTER_FALSE_POSITIVE_RATE,
+                                                          fc::minutes(GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES) };
 
       item_to_time_map_type items_requested_from_peer;  /// items we've requested from this peer during normal operation.  fetch from another peer if this peer disconnects
+
+      bool supports_compact_blocks = false; /// whether the peer told us in its hello that it understands compact blocks
+      struct partial_compact_block
+      {
+        compact_block_message compact_block;
+        std::vector<fc::optional<signed_transaction>> transactions; /// the transactions of the block, if known
+      };
+      std::map<item_hash_t, partial_compact_block> partial_compact_blocks; /// compact blocks from this peer waiting for their missing transactions, by block message hash
+
+      bool supports_block_ranges = false; /// whether the peer told us in its hello that it serves fetch_block_range_message
+      std::map<uint32_t, std::vector<item_hash_t>> block_ranges_requested_from_peer; /// the ids of the sync blocks requested as ranges, by first block number
+
+      bool supports_trx_batches = false; /// whether the peer told us in its hello that it accepts trx_batch_message
+      std::vector<std::shared_ptr<const message>> pending_trx_batch; /// transactions requested by the peer waiting to be sent in one trx_batch_message
+      size_t pending_trx_batch_size = 0; /// bytes of serialized transactions in pending_trx_batch
+
+      /// @name Metrics, reported by node::network_get_metrics()
+      /// @{
+      struct message_type_counters
+      {
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+      };
+      struct latency_counters
+      {
+        uint64_t count = 0;
+        fc::microseconds total;
+        fc::microseconds max;
+        void record(const fc::microseconds& latency) { ++count; total += latency; max = std::max(max, latency); }
+      };
+      std::map<uint32_t, message_type_counters> messages_received_by_type; /// by message type
+      std::map<uint32_t, message_type_counters> messages_sent_by_type; /// by message type
+      latency_counters fetch_latency; /// from requesting an item during normal operation until it arrived
+      latency_counters block_propagation_delay; /// from the timestamp of a block until it arrived, for the blocks this peer delivered first
+      /// @}
+
+      /// @name Quality, moving averages used to prefer the peers which deliver blocks fastest
+      /// @{
+      fc::microseconds average_round_trip_delay; /// of the current_time_request_message round trips, 0 if unknown
+      fc::microseconds average_block_delay; /// from requesting a block until it arrived, 0 if unknown
+      void record_round_trip_delay(const fc::microseconds& delay);
+      void record_block_delay(const fc::microseconds& delay);
+      /**
+       * @return the expected time in milliseconds to get a block from the peer, lower is better, or 0 if nothing has
+       *         been measured yet.  While no block was received, it is estimated as two round trips.
+       */
+      uint32_t get_quality_score_ms() const;
+      /// @}
       /// @}
 
       // if they're flooding us with transactions, we set this to avoid fetching for a few seconds to let the
       // blockchain catch up
       fc::time_point transaction_fetching_inhibited_until;
 
+      /// the token bucket limiting the transactions of this peer, see GRAPHENE_NET_PEER_TRX_PER_SECOND
+      double transaction_tokens = GRAPHENE_NET_PEER_TRX_BURST;
+      fc::time_point transaction_tokens_updated;
+      /// @return false if the peer has no token left for a transaction received at @p now, otherwise takes one
+      bool take_transaction_token(const fc::time_point& now);
+
       uint32_t last_known_fork_block_number = 0;
 
       fc::future<void> accept_or_connect_task_done;
@@ -268,10 +361,14 @@ namespace graphene { namespace net
       unsigned _send_message_queue_tasks_running = 0; // temporary debugging
 #endif
       bool _currently_handling_message = false; // true while we're in the middle of handling a message from the remote system
-      peer_connection(peer_connection_delegate* delegate);
+      peer_connection(peer_connection_delegate* delegate, fc::thread* io_thread);
       void destroy();
     public:
-      static peer_connection_ptr make_shared(peer_connection_delegate* delegate); // use this instead of the constructor
+      /**
+       * Use this instead of the constructor.
+       * @param io_thread the thread which handles the socket I/O of the connection, nullptr for the calling thread
+       */
+      static peer_connection_ptr make_shared(peer_connection_delegate* delegate, fc::thread* io_thread = nullptr);
       virtual ~peer_connection();
 
       fc::tcp_socket& get_socket();
@@ -281,17 +378,22 @@ namespace graphene { namespace net
       void on_message(message_oriented_connection* originating_connection, const message& received_message) override;
       void on_connection_closed(message_oriented_connection* originating_connection) override;
 
-      void send_queueable_message(std::unique_ptr<queued_message>&& message_to_send);
+      void send_queueable_message(std::unique_ptr<queued_message>&& message_to_send, message_priority priority);
       void send_message(const message& message_to_send, size_t message_send_time_field_offset = (size_t)-1);
+      /// Queues a message which is shared with other queues without copying it
+      void send_message(std::shared_ptr<const message> message_to_send);
       void send_item(const item_id& item_to_send);
       void close_connection();
       void destroy_connection();
 
       uint64_t get_total_bytes_sent() const;
       uint64_t get_total_bytes_received() const;
+      size_t get_queued_message_count() const;
+      size_t get_total_queued_messages_size() const;
 
       fc::time_point get_last_message_sent_time() const;
       fc::time_point get_last_message_received_time() const;
+      fc::time_point get_last_message_read_start_time() const;
 
       fc::optional<fc::ip::endpoint> get_remote_endpoint();
       fc::ip::endpoint get_local_endpoint();
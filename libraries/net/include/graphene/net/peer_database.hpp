@@ -53,6 +53,7 @@ namespace graphene { namespace net {
     uint32_t                          number_of_successful_connection_attempts;
     uint32_t                          number_of_failed_connection_attempts;
     fc::optional<fc::exception>       last_error;
+    uint32_t                          quality_score_ms = 0; /// measured during the last connection, 0 if unknown
 
     potential_peer_record() :
       number_of_successful_connection_attempts(0),
@@ -99,6 +100,11 @@ namespace graphene { namespace net {
     peer_database();
     virtual ~peer_database();
 
+    /**
+     * Loads the peers from a binary store file, every later change is appended to the file right away so it
+     * survives a crash. If the file does not exist, the JSON file of the same name with the extension .json
+     * written by older versions is imported.
+     */
     void open(const fc::path& databaseFilename);
     void close();
     void clear();
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/net/core_messages.hpp>
+
+#include <fc/time.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace net {
+
+  /**
+   * @class rolling_bloom_filter
+   * @brief A compact, probabilistic set of item ids which forgets old items
+   *
+   * Items are added to the current one of two generations of bloom filters.  When the current generation is
+   * holding half of the capacity, or it was started longer than the maximum age ago, the previous generation is
+   * dropped and the current one takes its place.  So an item is remembered for at least half of the capacity
+   * insertions and at most twice the maximum age.
+   *
+   * @ref contains never misses an item which is remembered, but it may claim to contain an item which was never
+   * inserted, with the given false positive rate when the filter is full.  The memory use is fixed by the
+   * capacity and the false positive rate, the bits are only allocated once the first item is inserted.
+   */
+  class rolling_bloom_filter
+  {
+    public:
+      rolling_bloom_filter(size_t capacity, double false_positive_rate, fc::microseconds max_age);
+
+      void insert(const item_id& item);
+      bool contains(const item_id& item) const;
+
+      /// starts a new generation if the current one is older than the maximum age
+      void expire_old_items(fc::time_point now = fc::time_point::now());
+      void clear();
+
+      /// @return the number of items inserted in the remembered generations
+      size_t size() const { return _current.item_count + _previous.item_count; }
+      /// @return the number of bytes allocated for the bits of the filter
+      size_t memory_usage() const;
+
+    private:
+      struct generation
+      {
+        std::vector<uint64_t> bits;
+        size_t                item_count = 0;
+        fc::time_point        start_time;
+      };
+
+      /// @return the two hashes from which the bit indexes of an item are derived
+      std::pair<uint64_t, uint64_t> get_hashes(const item_id& item) const;
+      bool generation_contains(const generation& gen, const std::pair<uint64_t, uint64_t>& hashes) const;
+      void roll(fc::time_point now);
+
+      size_t           _items_per_generation;
+      uint64_t         _bits_per_generation;
+      uint32_t         _hash_count;
+      fc::microseconds _max_age;
+      uint64_t         _seed;
+      generation       _current;
+      generation       _previous;
+  };
+
+} } // graphene::net
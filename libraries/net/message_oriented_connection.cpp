@@ -32,6 +32,7 @@
 #include <graphene/net/stcp_socket.hpp>
 #include <graphene/net/config.hpp>
 
+#include <algorithm>
 #include <atomic>
 
 #ifdef DEFAULT_LOGGER
@@ -41,8 +42,10 @@
 
 #ifndef NDEBUG
 # define VERIFY_CORRECT_THREAD() assert(_thread->is_current())
+# define VERIFY_IO_THREAD() assert(_io_thread->is_current())
 #else
 # define VERIFY_CORRECT_THREAD() do {} while (0)
+# define VERIFY_IO_THREAD() do {} while (0)
 #endif
 
 namespace graphene { namespace net {
@@ -56,21 +59,34 @@ namespace graphene { namespace net {
       stcp_socket _sock;
       fc::promise<void>::ptr _ready_for_sending;
       fc::future<void> _read_loop_done;
-      uint64_t _bytes_received;
-      uint64_t _bytes_sent;
+      std::atomic<uint64_t> _bytes_received;
+      std::atomic<uint64_t> _bytes_sent;
 
-      fc::time_point _connected_time;
-      fc::time_point _last_message_received_time;
-      fc::time_point _last_message_sent_time;
+      std::atomic<fc::time_point> _connected_time;
+      std::atomic<fc::time_point> _last_message_received_time;
+      /// when the header of the last received message arrived, the body was read after it
+      std::atomic<fc::time_point> _last_message_read_start_time;
+      std::atomic<fc::time_point> _last_message_sent_time;
 
       std::atomic_bool _send_message_in_progress;
       std::atomic_bool _read_loop_in_progress;
-#ifndef NDEBUG
+      /// the thread which created the connection, the delegate is called in it
       fc::thread* _thread;
-#endif
+      /// the thread which does the socket I/O, it is the same as _thread unless a separate one was given
+      fc::thread* _io_thread;
 
       void read_loop();
       void start_read_loop();
+      void write_message(const message& message_to_send);
+
+      template<typename Functor>
+      void run_in_thread(fc::thread* thread, Functor&& f, const char* description)
+      {
+        if (thread->is_current())
+          f();
+        else
+          thread->async(std::forward<Functor>(f), description).wait();
+      }
     public:
       fc::tcp_socket& get_socket();
       void accept();
@@ -78,7 +94,8 @@ namespace graphene { namespace net {
       void bind(const fc::ip::endpoint& local_endpoint);
 
       message_oriented_connection_impl(message_oriented_connection* self,
-                                       message_oriented_connection_delegate* delegate = nullptr);
+                                       message_oriented_connection_delegate* delegate = nullptr,
+                                       fc::thread* io_thread = nullptr);
       ~message_oriented_connection_impl();
 
       void send_message(const message& message_to_send);
@@ -90,22 +107,27 @@ namespace graphene { namespace net {
 
       fc::time_point get_last_message_sent_time() const;
       fc::time_point get_last_message_received_time() const;
+      fc::time_point get_last_message_read_start_time() const;
       fc::time_point get_connection_time() const { return _connected_time; }
       fc::sha512 get_shared_secret() const;
     };
 
     message_oriented_connection_impl::message_oriented_connection_impl(message_oriented_connection* self,
-                                                                       message_oriented_connection_delegate* delegate)
+                                                                       message_oriented_connection_delegate* delegate,
+                                                                       fc::thread* io_thread)
     : _self(self),
       _delegate(delegate),
       _ready_for_sending(fc::promise<void>::create()),
       _bytes_received(0),
       _bytes_sent(0),
+      _connected_time(fc::time_point()),
+      _last_message_received_time(fc::time_point()),
+      _last_message_read_start_time(fc::time_point()),
+      _last_message_sent_time(fc::time_point()),
       _send_message_in_progress(false),
-      _read_loop_in_progress(false)
-#ifndef NDEBUG
-      ,_thread(&fc::thread::current())
-#endif
+      _read_loop_in_progress(false),
+      _thread(&fc::thread::current()),
+      _io_thread(io_thread != nullptr ? io_thread : &fc::thread::current())
     {
     }
     message_oriented_connection_impl::~message_oriented_connection_impl()
@@ -123,18 +145,19 @@ namespace graphene { namespace net {
     void message_oriented_connection_impl::accept()
     {
       VERIFY_CORRECT_THREAD();
-      _sock.accept();
+      run_in_thread(_io_thread, [this](){ _sock.accept(); }, "message_oriented_connection accept");
       assert(!_read_loop_done.valid()); // check to be sure we never launch two read loops
-      _read_loop_done = fc::async([=](){ read_loop(); }, "message read_loop");
+      _read_loop_done = _io_thread->async([=](){ read_loop(); }, "message read_loop");
       _ready_for_sending->set_value();
     }
 
     void message_oriented_connection_impl::connect_to(const fc::ip::endpoint& remote_endpoint)
     {
       VERIFY_CORRECT_THREAD();
-      _sock.connect_to(remote_endpoint);
+      run_in_thread(_io_thread, [this, &remote_endpoint](){ _sock.connect_to(remote_endpoint); },
+                    "message_oriented_connection connect_to");
       assert(!_read_loop_done.valid()); // check to be sure we never launch two read loops
-      _read_loop_done = fc::async([=](){ read_loop(); }, "message read_loop");
+      _read_loop_done = _io_thread->async([=](){ read_loop(); }, "message read_loop");
       _ready_for_sending->set_value();
     }
 
@@ -161,7 +184,7 @@ namespace graphene { namespace net {
 
     void message_oriented_connection_impl::read_loop()
     {
-      VERIFY_CORRECT_THREAD();
+      VERIFY_IO_THREAD();
       const int BUFFER_SIZE = 16;
       const int LEFTOVER = BUFFER_SIZE - sizeof(message_header);
       static_assert(BUFFER_SIZE >= sizeof(message_header), "insufficient buffer");
@@ -180,6 +203,7 @@ namespace graphene { namespace net {
         while( true )
         {
           _sock.read(buffer, BUFFER_SIZE);
+          _last_message_read_start_time = fc::time_point::now();
           _bytes_received += BUFFER_SIZE;
           memcpy((char*)&m, buffer, sizeof(message_header));
           FC_ASSERT( m.size.value() <= MAX_MESSAGE_SIZE, "", ("m.size",m.size.value())("MAX_MESSAGE_SIZE",MAX_MESSAGE_SIZE) );
@@ -199,7 +223,7 @@ namespace graphene { namespace net {
           try
           {
             // message handling errors are warnings...
-            _delegate->on_message(_self, m);
+            run_in_thread(_thread, [this, &m](){ _delegate->on_message(_self, m); }, "deliver message");
           }
           /// Dedicated catches needed to distinguish from general fc::exception
           catch ( const fc::canceled_exception& e ) { throw; }
@@ -242,7 +266,7 @@ namespace graphene { namespace net {
       }
 
       if (call_on_connection_closed)
-        _delegate->on_connection_closed(_self);
+        run_in_thread(_thread, [this](){ _delegate->on_connection_closed(_self); }, "deliver connection closed");
 
       if (exception_to_rethrow)
         throw *exception_to_rethrow;
@@ -266,21 +290,41 @@ namespace graphene { namespace net {
       no_parallel_execution_guard guard( &_send_message_in_progress );
       _ready_for_sending->wait();
 
+      run_in_thread(_io_thread, [this, &message_to_send](){ write_message(message_to_send); }, "send message");
+    }
+
+    void message_oriented_connection_impl::write_message(const message& message_to_send)
+    {
+      VERIFY_IO_THREAD();
       try
       {
-        size_t size_of_message_and_header = sizeof(message_header) + message_to_send.size.value();
-        if( message_to_send.size.value() > MAX_MESSAGE_SIZE )
+        const size_t message_size = message_to_send.size.value();
+        size_t size_of_message_and_header = sizeof(message_header) + message_size;
+        if( message_size > MAX_MESSAGE_SIZE )
            elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
         //pad the message we send to a multiple of 16 bytes
         size_t size_with_padding = 16 * ((size_of_message_and_header + 15) / 16);
-        std::vector<char> padded_message( size_with_padding );
-
-        memcpy( padded_message.data(), (const char*)&message_to_send, sizeof(message_header) );
-        memcpy( padded_message.data() + sizeof(message_header), message_to_send.data.data(),
-                message_to_send.size.value() );
-        char* padding_space = padded_message.data() + sizeof(message_header) + message_to_send.size.value();
-        memset(padding_space, 0, size_with_padding - size_of_message_and_header);
-        _sock.write( padded_message.data(), size_with_padding );
+
+        // The socket encrypts in blocks of 16 bytes.  Only the first block, which holds the header, and the padded
+        // last block are assembled here, the blocks in between are written straight from the message, so that a
+        // message which is shared by the send queues of many peers is not copied for every one of them.
+        const size_t size_in_first_block = std::min<size_t>( message_size, 16 - sizeof(message_header) );
+        const size_t size_of_middle_blocks = 16 * ((message_size - size_in_first_block) / 16);
+        const size_t size_in_last_block = message_size - size_in_first_block - size_of_middle_blocks;
+        const char* message_data = message_to_send.data.data();
+
+        char first_block[16] = {};
+        memcpy( first_block, (const char*)&message_to_send, sizeof(message_header) );
+        memcpy( first_block + sizeof(message_header), message_data, size_in_first_block );
+        _sock.write( first_block, sizeof(first_block) );
+        if( size_of_middle_blocks > 0 )
+           _sock.write( message_data + size_in_first_block, size_of_middle_blocks );
+        if( size_in_last_block > 0 )
+        {
+           char last_block[16] = {};
+           memcpy( last_block, message_data + size_in_first_block + size_of_middle_blocks, size_in_last_block );
+           _sock.write( last_block, sizeof(last_block) );
+        }
         _sock.flush();
         _bytes_sent += size_with_padding;
         _last_message_sent_time = fc::time_point::now();
@@ -290,7 +334,7 @@ namespace graphene { namespace net {
     void message_oriented_connection_impl::close_connection()
     {
       VERIFY_CORRECT_THREAD();
-      _sock.close();
+      run_in_thread(_io_thread, [this](){ _sock.close(); }, "message_oriented_connection close");
     }
 
     void message_oriented_connection_impl::destroy_connection()
@@ -346,6 +390,12 @@ namespace graphene { namespace net {
       return _last_message_received_time;
     }
 
+    fc::time_point message_oriented_connection_impl::get_last_message_read_start_time() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _last_message_read_start_time;
+    }
+
     fc::sha512 message_oriented_connection_impl::get_shared_secret() const
     {
       VERIFY_CORRECT_THREAD();
@@ -355,8 +405,9 @@ namespace graphene { namespace net {
   } // end namespace graphene::net::detail
 
 
-  message_oriented_connection::message_oriented_connection(message_oriented_connection_delegate* delegate) :
-    my( std::make_unique<detail::message_oriented_connection_impl>(this, delegate) )
+  message_oriented_connection::message_oriented_connection(message_oriented_connection_delegate* delegate,
+                                                           fc::thread* io_thread) :
+    my( std::make_unique<detail::message_oriented_connection_impl>(this, delegate, io_thread) )
   {
   }
 
@@ -418,6 +469,10 @@ namespace graphene { namespace net {
   {
     return my->get_last_message_received_time();
   }
+  fc::time_point message_oriented_connection::get_last_message_read_start_time() const
+  {
+    return my->get_last_message_read_start_time();
+  }
   fc::time_point message_oriented_connection::get_connection_time() const
   {
     return my->get_connection_time();
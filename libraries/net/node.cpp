@@ -35,6 +35,7 @@
 #include <boost/circular_buffer.hpp>
 
 #include <boost/multi_index_container.hpp>
+#include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/member.hpp>
@@ -114,6 +115,12 @@ namespace graphene { namespace net { namespace detail {
    }
 
    message blockchain_tied_message_cache::get_message( const message_hash_type& hash_of_message_to_lookup ) const
+   {
+      return *get_shared_message( hash_of_message_to_lookup );
+   }
+
+   std::shared_ptr<const message> blockchain_tied_message_cache::get_shared_message(
+         const message_hash_type& hash_of_message_to_lookup ) const
    {
       message_cache_container::index<message_hash_index>::type::const_iterator iter =
          _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup );
@@ -122,6 +129,16 @@ namespace graphene { namespace net { namespace detail {
       FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
    }
 
+   void blockchain_tied_message_cache::message_requested( const message_hash_type& hash_of_message )
+   {
+      auto& idx = _message_cache.get<message_hash_index>();
+      auto iter = idx.find( hash_of_message );
+      if( iter != idx.end() && iter->propagation_data.first_requested_time == fc::time_point() )
+         idx.modify( iter, []( message_info& info ) {
+            info.propagation_data.first_requested_time = fc::time_point::now();
+         } );
+   }
+
     message_propagation_data blockchain_tied_message_cache::get_message_propagation_data(
              const message_hash_type& hash_of_msg_contents_to_lookup ) const
     {
@@ -264,9 +281,10 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_db_updated = false;
 
-            for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
-                 ++iter)
+            // the candidates are tried in the order of their quality score, the peers which were fastest
+            // the last time we were connected to them first, and by last seen time among equally good ones
+            std::vector<std::pair<uint32_t, fc::ip::endpoint>> candidates;
+            for (peer_database::iterator iter = _potential_peer_db.begin(); iter != _potential_peer_db.end(); ++iter)
             {
               fc::microseconds delay_until_retry = fc::seconds( (iter->number_of_failed_connection_attempts + 1)
                                                                 * _peer_connection_retry_timeout );
@@ -277,10 +295,24 @@ namespace graphene { namespace net { namespace detail {
                     iter->last_connection_disposition != last_connection_handshaking_failed) ||
                    (fc::time_point::now() - iter->last_connection_attempt_time) > delay_until_retry))
               {
-                connect_to_endpoint(iter->endpoint);
-                initiated_connection_this_pass = true;
+                const uint32_t score = iter->quality_score_ms > 0 ?
+                      iter->quality_score_ms : uint32_t(GRAPHENE_NET_DEFAULT_PEER_QUALITY_SCORE_MS);
+                candidates.emplace_back(score, iter->endpoint);
               }
             }
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             []( const std::pair<uint32_t, fc::ip::endpoint>& a,
+                                 const std::pair<uint32_t, fc::ip::endpoint>& b ) { return a.first < b.first; });
+
+            for (const auto& candidate : candidates)
+            {
+              if (!is_wanting_new_connections())
+                break;
+              if (is_connection_to_endpoint_in_progress(candidate.second))
+                continue;
+              connect_to_endpoint(candidate.second);
+              initiated_connection_this_pass = true;
+            }
 
             if (!initiated_connection_this_pass && !_potential_peer_db_updated)
               break;
@@ -402,7 +434,38 @@ namespace graphene { namespace net { namespace detail {
         peer->last_sync_item_received_time = fc::time_point::now();
         peer->sync_items_requested_from_peer.insert(item_to_request);
       }
-      peer->send_message(fetch_items_message(graphene::net::block_message_type, items_to_request));
+
+      // consecutive blocks are requested by number from peers which can serve them straight from their block database
+      bool request_as_range = peer->supports_block_ranges && items_to_request.size() > 1;
+      const uint32_t first_block_num = request_as_range ?
+            graphene::protocol::block_header::num_from_id(items_to_request.front()) : 0;
+      request_as_range = request_as_range &&
+            peer->block_ranges_requested_from_peer.find(first_block_num) == peer->block_ranges_requested_from_peer.end();
+      for (size_t i = 1; request_as_range && i < items_to_request.size(); ++i)
+        request_as_range = graphene::protocol::block_header::num_from_id(items_to_request[i]) == first_block_num + i;
+      if (request_as_range)
+      {
+        peer->block_ranges_requested_from_peer[first_block_num] = items_to_request;
+        peer->send_message(fetch_block_range_message(first_block_num, (uint32_t)items_to_request.size()));
+      }
+      else
+        peer->send_message(fetch_items_message(graphene::net::block_message_type, items_to_request));
+    }
+
+    uint32_t node_impl::effective_quality_score_ms( const peer_connection& peer )
+    {
+      const uint32_t quality_score_ms = peer.get_quality_score_ms();
+      return quality_score_ms > 0 ? quality_score_ms : uint32_t(GRAPHENE_NET_DEFAULT_PEER_QUALITY_SCORE_MS);
+    }
+
+    std::vector<peer_connection_ptr> node_impl::get_active_connections_by_quality() const
+    {
+      VERIFY_CORRECT_THREAD();
+      std::vector<peer_connection_ptr> peers( _active_connections.begin(), _active_connections.end() );
+      std::stable_sort( peers.begin(), peers.end(), []( const peer_connection_ptr& a, const peer_connection_ptr& b ) {
+        return effective_quality_score_ms( *a ) < effective_quality_score_ms( *b );
+      } );
+      return peers;
     }
 
     void node_impl::fetch_sync_items_loop()
@@ -420,17 +483,21 @@ namespace graphene { namespace net { namespace detail {
           {
             std::set<item_hash_t> sync_items_to_request;
 
-            // for each idle peer that we're syncing with
+            // for each peer that we're syncing with and which can take more requests, the fastest peers first
             fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
-            for( const peer_connection_ptr& peer : _active_connections )
+            for( const peer_connection_ptr& peer : get_active_connections_by_quality() )
             {
               if( peer->we_need_sync_items_from_peer &&
                   // if we've already scheduled a request for this peer, don't consider scheduling another
                   sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() &&
-                  peer->idle() )
+                  can_request_more_sync_items_from_peer( *peer ) )
               {
                 if (!peer->inhibit_fetching_sync_blocks)
                 {
+                  // top up the requests which are still outstanding, so that the link doesn't go idle while
+                  // the peer is sending us the tail of the previous batch
+                  const size_t max_items_to_request = _max_sync_blocks_per_peer
+                                                      - peer->sync_items_requested_from_peer.size();
                   // loop through the items it has that we don't yet have on our blockchain
                   for( const auto& item_to_potentially_request : peer->ids_of_items_to_get )
                   {
@@ -446,7 +513,7 @@ namespace graphene { namespace net { namespace detail {
                       // then schedule a request from this peer
                       sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                       sync_items_to_request.insert( item_to_potentially_request );
-                      if (sync_item_requests_to_send[peer].size() >= _max_sync_blocks_per_peer)
+                      if (sync_item_requests_to_send[peer].size() >= max_items_to_request)
                         break;
                     }
                   }
@@ -474,6 +541,15 @@ namespace graphene { namespace net { namespace detail {
       } // while( !canceled )
     }
 
+    bool node_impl::can_request_more_sync_items_from_peer( const peer_connection& peer ) const
+    {
+      VERIFY_CORRECT_THREAD();
+      // a peer which is sending us item ids or normal items is left alone, and one which still has more than
+      // half of a batch of sync items outstanding is asked again once it has sent us more of them
+      return peer.items_requested_from_peer.empty() && !peer.item_ids_requested_from_peer &&
+             peer.sync_items_requested_from_peer.size() <= _max_sync_blocks_per_peer / 2;
+    }
+
     void node_impl::trigger_fetch_sync_items_loop()
     {
       VERIFY_CORRECT_THREAD();
@@ -515,7 +591,11 @@ namespace graphene { namespace net { namespace detail {
         {
           peer_connection_ptr peer;
           std::vector<item_id> item_ids;
-          peer_and_items_to_fetch(const peer_connection_ptr& peer) : peer(peer) {}
+          uint32_t quality_score_ms;
+          explicit peer_and_items_to_fetch(const peer_connection_ptr& peer) :
+            peer(peer),
+            quality_score_ms(node_impl::effective_quality_score_ms(*peer))
+          {}
           bool operator<(const peer_and_items_to_fetch& rhs) const { return peer < rhs.peer; }
           size_t number_of_items() const { return item_ids.size(); }
         };
@@ -523,7 +603,9 @@ namespace graphene { namespace net { namespace detail {
                  bmi::ordered_unique<
                     bmi::member<peer_and_items_to_fetch, peer_connection_ptr, &peer_and_items_to_fetch::peer> >,
                  bmi::ordered_non_unique< bmi::tag<requested_item_count_index>,
-                    bmi::const_mem_fun<peer_and_items_to_fetch, size_t, &peer_and_items_to_fetch::number_of_items> >
+                    bmi::composite_key< peer_and_items_to_fetch,
+                       bmi::const_mem_fun<peer_and_items_to_fetch, size_t, &peer_and_items_to_fetch::number_of_items>,
+                       bmi::member<peer_and_items_to_fetch, uint32_t, &peer_and_items_to_fetch::quality_score_ms> > >
                  > >;
         fetch_messages_to_send_set items_by_peer;
 
@@ -550,7 +632,8 @@ namespace graphene { namespace net { namespace detail {
           }
           else
           {
-            // find a peer that has it, we'll use the one who has the least requests going to it to load balance
+            // find a peer that has it, we'll use the one who has the least requests going to it to load balance,
+            // and the fastest one among those
             bool item_fetched = false;
             for (auto peer_iter = items_by_peer.get<requested_item_count_index>().begin(); peer_iter != items_by_peer.get<requested_item_count_index>().end(); ++peer_iter)
             {
@@ -641,6 +724,14 @@ namespace graphene { namespace net { namespace detail {
         std::unordered_set<item_id> inventory_to_advertise;
         _new_inventory.swap( inventory_to_advertise );
 
+        // remember what we have advertised, so that we don't fetch it again when peers advertise it back to us
+        fc::time_point_sec oldest_inventory_to_keep(fc::time_point::now() - fc::minutes(GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES));
+        _recently_advertised_inventory.get<peer_connection::timestamp_index>().erase(
+              _recently_advertised_inventory.get<peer_connection::timestamp_index>().begin(),
+              _recently_advertised_inventory.get<peer_connection::timestamp_index>().lower_bound(oldest_inventory_to_keep));
+        for (const item_id& item_to_advertise : inventory_to_advertise)
+          _recently_advertised_inventory.insert(peer_connection::timestamped_item_id(item_to_advertise, fc::time_point::now()));
+
         // process all inventory to advertise and construct the inventory messages we'll send
         // first, then send them all in a batch (to avoid any fiber interruption points while
         // we're computing the messages)
@@ -661,15 +752,14 @@ namespace graphene { namespace net { namespace detail {
             idump((inventory_to_advertise));
             for (const item_id& item_to_advertise : inventory_to_advertise)
             {
-               auto adv_to_peer = peer->inventory_advertised_to_peer.find(item_to_advertise);
+               bool adv_to_peer = peer->inventory_advertised_to_peer.contains(item_to_advertise);
                auto adv_to_us   = peer->inventory_peer_advertised_to_us.find(item_to_advertise);
 
-              if (adv_to_peer == peer->inventory_advertised_to_peer.end() &&
+              if (!adv_to_peer &&
                   adv_to_us == peer->inventory_peer_advertised_to_us.end())
               {
                 items_to_advertise_by_type[item_to_advertise.item_type].push_back(item_to_advertise.item_hash);
-                peer->inventory_advertised_to_peer.insert(
-                         peer_connection::timestamped_item_id(item_to_advertise, fc::time_point::now()));
+                peer->inventory_advertised_to_peer.insert(item_to_advertise);
                 ++total_items_to_send;
                 if (item_to_advertise.item_type == trx_message_type)
                   testnetlog("advertising transaction ${id} to peer ${endpoint}",
@@ -679,8 +769,9 @@ namespace graphene { namespace net { namespace detail {
               }
               else
               {
-                 if (adv_to_peer != peer->inventory_advertised_to_peer.end() )
-                    idump( (*adv_to_peer) );
+                 if (adv_to_peer)
+                    dlog( "already advertised ${id} to peer ${endpoint}",
+                          ("id", item_to_advertise.item_hash)("endpoint", peer->get_remote_endpoint()) );
                  if (adv_to_us != peer->inventory_peer_advertised_to_us.end() )
                     idump( (*adv_to_us) );
               }
@@ -720,6 +811,91 @@ namespace graphene { namespace net { namespace detail {
         _retrigger_advertise_inventory_loop_promise->set_value();
     }
 
+    void node_impl::trx_batch_flush_loop()
+    {
+      VERIFY_CORRECT_THREAD();
+      while (!_trx_batch_flush_loop_done.canceled())
+      {
+        if (_peers_with_pending_trx_batches.empty())
+        {
+          _retrigger_trx_batch_flush_loop_promise
+                = fc::promise<void>::create("graphene::net::retrigger_trx_batch_flush_loop");
+          _retrigger_trx_batch_flush_loop_promise->wait();
+          _retrigger_trx_batch_flush_loop_promise.reset();
+          continue;
+        }
+
+        // give the batches some time to fill up, full batches are sent right away by add_to_trx_batch()
+        fc::usleep(fc::milliseconds(_trx_batch_flush_interval_ms));
+
+        std::set<peer_connection_ptr> peers_to_flush;
+        peers_to_flush.swap(_peers_with_pending_trx_batches);
+        for (const peer_connection_ptr& peer : peers_to_flush)
+        {
+          try
+          {
+            flush_trx_batch(*peer);
+          }
+          catch (const fc::canceled_exception&)
+          {
+            throw;
+          }
+          catch (const fc::exception& e)
+          {
+            wlog("Error sending a transaction batch to peer ${endpoint}: ${e}",
+                 ("endpoint", peer->get_remote_endpoint())("e", e));
+          }
+        }
+      } // while(!canceled)
+    }
+
+    void node_impl::trigger_trx_batch_flush_loop()
+    {
+      VERIFY_CORRECT_THREAD();
+      if( _retrigger_trx_batch_flush_loop_promise )
+        _retrigger_trx_batch_flush_loop_promise->set_value();
+    }
+
+    bool node_impl::add_to_trx_batch( peer_connection* peer, const std::shared_ptr<const message>& trx_message_to_send )
+    {
+      VERIFY_CORRECT_THREAD();
+      const size_t trx_size = trx_message_to_send->data.size();
+      if (!peer->supports_trx_batches || _max_trx_batch_size <= 1 || trx_size > GRAPHENE_NET_MAX_TRX_BATCH_DATA_SIZE)
+        return false;
+
+      if (peer->pending_trx_batch_size + trx_size > GRAPHENE_NET_MAX_TRX_BATCH_DATA_SIZE)
+        flush_trx_batch(*peer);
+      peer->pending_trx_batch.push_back(trx_message_to_send);
+      peer->pending_trx_batch_size += trx_size;
+
+      if (peer->pending_trx_batch.size() >= _max_trx_batch_size)
+        flush_trx_batch(*peer);
+      else if (peer->pending_trx_batch.size() == 1)
+      {
+        _peers_with_pending_trx_batches.insert(peer->shared_from_this());
+        trigger_trx_batch_flush_loop();
+      }
+      return true;
+    }
+
+    void node_impl::flush_trx_batch( peer_connection& peer )
+    {
+      VERIFY_CORRECT_THREAD();
+      if (peer.pending_trx_batch.empty())
+        return;
+
+      trx_batch_message batch;
+      batch.packed_transactions.reserve(peer.pending_trx_batch.size());
+      for (const std::shared_ptr<const message>& trx_message_to_send : peer.pending_trx_batch)
+        batch.packed_transactions.push_back(trx_message_to_send->data);
+      peer.pending_trx_batch.clear();
+      peer.pending_trx_batch_size = 0;
+
+      dlog("sending a batch of ${count} transactions to peer ${endpoint}",
+           ("count", batch.packed_transactions.size())("endpoint", peer.get_remote_endpoint()));
+      peer.send_message(message(batch));
+    }
+
     void node_impl::kill_inactive_conns_loop(node_impl_ptr self)
     {
       VERIFY_CORRECT_THREAD();
@@ -1253,6 +1429,10 @@ namespace graphene { namespace net { namespace detail {
     {
       VERIFY_CORRECT_THREAD();
       message_hash_type message_hash = received_message.id();
+      peer_connection::message_type_counters& counters =
+            originating_peer->messages_received_by_type[received_message.msg_type.value()];
+      ++counters.messages;
+      counters.bytes += received_message.size.value();
       dlog("handling message ${type} ${hash} size ${size} from peer ${endpoint}",
            ("type", graphene::net::core_message_type_enum(received_message.msg_type.value()))("hash", message_hash)
            ("size", received_message.size)
@@ -1295,8 +1475,32 @@ namespace graphene { namespace net { namespace detail {
         on_closing_connection_message(originating_peer, received_message.as<closing_connection_message>());
         break;
       case core_message_type_enum::block_message_type:
+        if( _block_tracer )
+          _block_tracer->add_span( graphene::net::block_message::block_id_of( received_message ), "read_message",
+                                   originating_peer->get_last_message_read_start_time(),
+                                   originating_peer->get_last_message_received_time() );
         process_block_message(originating_peer, received_message, message_hash);
         break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
+      case core_message_type_enum::fetch_compact_block_transactions_message_type:
+        on_fetch_compact_block_transactions_message(originating_peer,
+                                                    received_message.as<fetch_compact_block_transactions_message>());
+        break;
+      case core_message_type_enum::compact_block_transactions_message_type:
+        on_compact_block_transactions_message(originating_peer,
+                                              received_message.as<compact_block_transactions_message>());
+        break;
+      case core_message_type_enum::fetch_block_range_message_type:
+        on_fetch_block_range_message(originating_peer, received_message.as<fetch_block_range_message>());
+        break;
+      case core_message_type_enum::block_range_message_type:
+        on_block_range_message(originating_peer, received_message.as<block_range_message>());
+        break;
+      case core_message_type_enum::trx_batch_message_type:
+        on_trx_batch_message(originating_peer, received_message.as<trx_batch_message>());
+        break;
       case core_message_type_enum::current_time_request_message_type:
         on_current_time_request_message(originating_peer, received_message.as<current_time_request_message>());
         break;
@@ -1349,6 +1553,9 @@ namespace graphene { namespace net { namespace detail {
       user_data["bitness"] = sizeof(void*) * 8;
 
       user_data["node_id"] = fc::variant( _node_id, 1 );
+      user_data["compact_blocks"] = true;
+      user_data["block_ranges"] = true;
+      user_data["trx_batches"] = true;
 
       item_hash_t head_block_id = _delegate->get_head_block_id();
       user_data["last_known_block_hash"] = fc::variant( head_block_id, 1 );
@@ -1382,6 +1589,12 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->node_id = user_data["node_id"].as<node_id_t>(1);
       if (user_data.contains("last_known_fork_block_number"))
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>(1);
+      if (user_data.contains("compact_blocks"))
+        originating_peer->supports_compact_blocks = user_data["compact_blocks"].as_bool();
+      if (user_data.contains("block_ranges"))
+        originating_peer->supports_block_ranges = user_data["block_ranges"].as_bool();
+      if (user_data.contains("trx_batches"))
+        originating_peer->supports_trx_batches = user_data["trx_batches"].as_bool();
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -2255,6 +2468,25 @@ namespace graphene { namespace net { namespace detail {
       }
     }
 
+    /// Builds the compact form of a block, which refers to its transactions by the hashes of their trx_messages
+    static compact_block_message make_compact_block( const graphene::net::block_message& block_message_to_send,
+                                                     const item_hash_t& block_message_hash )
+    {
+      compact_block_message result;
+      result.block_message_hash = block_message_hash;
+      result.block_header = block_message_to_send.block;
+      result.block_id = block_message_to_send.block_id;
+      result.transactions.reserve(block_message_to_send.block.transactions.size());
+      for (const graphene::protocol::processed_transaction& trx : block_message_to_send.block.transactions)
+      {
+        compact_block_transaction compact_trx;
+        compact_trx.trx_message_hash = trx_message::message_id(trx);
+        compact_trx.operation_results = trx.operation_results;
+        result.transactions.push_back(std::move(compact_trx));
+      }
+      return result;
+    }
+
     message node_impl::get_message_for_item(const item_id& item)
     {
       try
@@ -2273,7 +2505,7 @@ namespace graphene { namespace net { namespace detail {
     }
 
     void node_impl::on_fetch_items_message(peer_connection* originating_peer,
-                                           const fetch_items_message& fetch_items_message_received) const
+                                           const fetch_items_message& fetch_items_message_received)
     {
       VERIFY_CORRECT_THREAD();
       dlog("received items request for ids ${ids} of type ${type} from peer ${endpoint}",
@@ -2281,20 +2513,37 @@ namespace graphene { namespace net { namespace detail {
            ("type", fetch_items_message_received.item_type)
            ("endpoint", originating_peer->get_remote_endpoint()));
 
-      fc::optional<message> last_block_message_sent;
+      fc::optional<block_id_type> last_block_id_sent;
 
-      std::list<message> reply_messages;
+      // Messages from the cache are shared with the cache and the send queues of other peers.  Blocks from
+      // the database are sent by ID, they are generated again when they reach the front of the send queue.
+      struct reply_message
+      {
+        std::shared_ptr<const message> message_to_send;
+        fc::optional<block_id_type>    block_id_to_send;
+      };
+      std::list<reply_message> reply_messages;
       for (const item_hash_t& item_hash : fetch_items_message_received.items_to_fetch)
       {
         try
         {
-          message requested_message = _message_cache.get_message(item_hash);
+          std::shared_ptr<const message> requested_message = _message_cache.get_shared_message(item_hash);
+          _message_cache.message_requested(item_hash);
           dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                ("endpoint", originating_peer->get_remote_endpoint())
-               ("id", requested_message.id()));
-          reply_messages.push_back(requested_message);
+               ("id", item_hash));
           if (fetch_items_message_received.item_type == block_message_type)
-            last_block_message_sent = requested_message;
+          {
+            last_block_id_sent = graphene::net::block_message::block_id_of(*requested_message);
+            // a block which we relayed recently, the peer has most likely seen its transactions already
+            if (originating_peer->supports_compact_blocks)
+            {
+              reply_messages.push_back({ std::make_shared<const message>(make_compact_block(
+                                            requested_message->as<graphene::net::block_message>(), item_hash)), {} });
+              continue;
+            }
+          }
+          reply_messages.push_back({ std::move(requested_message), {} });
           continue;
         }
         catch (fc::key_not_found_exception&)
@@ -2310,33 +2559,38 @@ namespace graphene { namespace net { namespace detail {
                ("id", requested_message.id())
                ("size", requested_message.size)
                ("endpoint", originating_peer->get_remote_endpoint()));
-          reply_messages.push_back(requested_message);
           if (fetch_items_message_received.item_type == block_message_type)
-            last_block_message_sent = requested_message;
+          {
+            last_block_id_sent = graphene::net::block_message::block_id_of(requested_message);
+            reply_messages.push_back({ nullptr, last_block_id_sent });
+          }
+          else
+            reply_messages.push_back({ std::make_shared<const message>(std::move(requested_message)), {} });
           continue;
         }
         catch (fc::key_not_found_exception&)
         {
-          reply_messages.push_back(item_not_available_message(item_to_fetch));
+          reply_messages.push_back({ std::make_shared<const message>(item_not_available_message(item_to_fetch)),
+                                     {} });
           dlog("received item request from peer ${endpoint} but we don't have it",
                ("endpoint", originating_peer->get_remote_endpoint()));
         }
       }
 
       // if we sent them a block, update our record of the last block they've seen accordingly
-      if (last_block_message_sent)
+      if (last_block_id_sent)
       {
-        graphene::net::block_message block = last_block_message_sent->as<graphene::net::block_message>();
-        originating_peer->last_block_delegate_has_seen = block.block_id;
-        originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(block.block_id);
+        originating_peer->last_block_delegate_has_seen = *last_block_id_sent;
+        originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(*last_block_id_sent);
       }
 
-      for (const message& reply : reply_messages)
+      for (reply_message& reply : reply_messages)
       {
-        if (reply.msg_type.value() == block_message_type)
-          originating_peer->send_item(item_id(block_message_type, reply.as<graphene::net::block_message>().block_id));
-        else
-          originating_peer->send_message(reply);
+        if (reply.block_id_to_send)
+          originating_peer->send_item(item_id(block_message_type, *reply.block_id_to_send));
+        else if (reply.message_to_send->msg_type.value() != trx_message_type ||
+                 !add_to_trx_batch(originating_peer, reply.message_to_send))
+          originating_peer->send_message(std::move(reply.message_to_send));
       }
     }
 
@@ -2348,6 +2602,7 @@ namespace graphene { namespace net { namespace detail {
       if (regular_item_iter != originating_peer->items_requested_from_peer.end())
       {
         originating_peer->items_requested_from_peer.erase( regular_item_iter );
+        originating_peer->partial_compact_blocks.erase( requested_item.item_hash );
         originating_peer->inventory_peer_advertised_to_us.erase( requested_item );
         if (is_item_in_any_peers_inventory(requested_item))
         {
@@ -2379,6 +2634,254 @@ namespace graphene { namespace net { namespace detail {
       dlog("Peer doesn't have an item we're looking for, which is fine because we weren't looking for it");
     }
 
+    void node_impl::on_compact_block_message( peer_connection* originating_peer,
+                                              const compact_block_message& compact_block_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = compact_block_message_received.block_message_hash;
+      if (originating_peer->items_requested_from_peer.find(item_id(block_message_type, block_message_hash))
+            == originating_peer->items_requested_from_peer.end())
+      {
+        wlog("received a compact block ${block_id} I didn't ask for from peer ${endpoint}, disconnecting from peer",
+             ("endpoint", originating_peer->get_remote_endpoint())
+             ("block_id", compact_block_message_received.block_id));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me a block that I didn't ask for, block_id: ${block_id}",
+                                                    ("block_id", compact_block_message_received.block_id)));
+        disconnect_from_peer(originating_peer, "You sent me a block that I didn't ask for", true, detailed_error);
+        return;
+      }
+
+      peer_connection::partial_compact_block compact_block;
+      compact_block.compact_block = compact_block_message_received;
+      compact_block.transactions.resize(compact_block_message_received.transactions.size());
+
+      // the transactions which were relayed to us on their own are in the message cache
+      std::vector<uint32_t> missing_transaction_indexes;
+      for (uint32_t i = 0; i < compact_block_message_received.transactions.size(); ++i)
+      {
+        try
+        {
+          const item_hash_t& trx_message_hash = compact_block_message_received.transactions[i].trx_message_hash;
+          compact_block.transactions[i]
+                = signed_transaction(_message_cache.get_shared_message(trx_message_hash)->as<trx_message>().trx);
+        }
+        catch (const fc::exception&)
+        {
+          missing_transaction_indexes.push_back(i);
+        }
+      }
+
+      if (missing_transaction_indexes.empty())
+      {
+        process_complete_compact_block(originating_peer, std::move(compact_block));
+        return;
+      }
+
+      dlog("missing ${n} of ${total} transactions of compact block ${block_id}, fetching them from peer ${endpoint}",
+           ("n", missing_transaction_indexes.size())
+           ("total", compact_block_message_received.transactions.size())
+           ("block_id", compact_block_message_received.block_id)
+           ("endpoint", originating_peer->get_remote_endpoint()));
+      originating_peer->partial_compact_blocks[block_message_hash] = std::move(compact_block);
+      fetch_compact_block_transactions_message request;
+      request.block_message_hash = block_message_hash;
+      request.transaction_indexes = std::move(missing_transaction_indexes);
+      originating_peer->send_message(message(request));
+    }
+
+    void node_impl::on_fetch_compact_block_transactions_message( peer_connection* originating_peer,
+          const fetch_compact_block_transactions_message& fetch_compact_block_transactions_message_received ) const
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = fetch_compact_block_transactions_message_received.block_message_hash;
+      try
+      {
+        // we only send compact blocks which are in the message cache
+        graphene::net::block_message block_message_requested
+              = _message_cache.get_shared_message(block_message_hash)->as<graphene::net::block_message>();
+        const auto& transactions = block_message_requested.block.transactions;
+
+        compact_block_transactions_message reply;
+        reply.block_message_hash = block_message_hash;
+        reply.transactions.reserve(fetch_compact_block_transactions_message_received.transaction_indexes.size());
+        for (uint32_t index : fetch_compact_block_transactions_message_received.transaction_indexes)
+        {
+          FC_ASSERT(index < transactions.size(), "Transaction index out of range");
+          reply.transactions.push_back(transactions[index]);
+        }
+        originating_peer->send_message(message(reply));
+      }
+      catch (const fc::exception& e)
+      {
+        dlog("unable to send the transactions of compact block ${hash} to peer ${endpoint}: ${e}",
+             ("hash", block_message_hash)("endpoint", originating_peer->get_remote_endpoint())("e", e));
+        originating_peer->send_message(item_not_available_message(item_id(block_message_type, block_message_hash)));
+      }
+    }
+
+    void node_impl::on_compact_block_transactions_message( peer_connection* originating_peer,
+          const compact_block_transactions_message& compact_block_transactions_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = compact_block_transactions_message_received.block_message_hash;
+      auto itr = originating_peer->partial_compact_blocks.find(block_message_hash);
+      if (itr == originating_peer->partial_compact_blocks.end())
+      {
+        dlog("received transactions of a compact block we are not waiting for, ignoring them");
+        return;
+      }
+      peer_connection::partial_compact_block compact_block = std::move(itr->second);
+      originating_peer->partial_compact_blocks.erase(itr);
+
+      const auto& received_transactions = compact_block_transactions_message_received.transactions;
+      size_t next_received = 0;
+      for (auto& trx : compact_block.transactions)
+      {
+        if (trx.valid())
+          continue;
+        if (next_received == received_transactions.size())
+          break;
+        trx = received_transactions[next_received];
+        ++next_received;
+      }
+
+      if (next_received != received_transactions.size() ||
+          std::any_of(compact_block.transactions.begin(), compact_block.transactions.end(),
+                      [](const fc::optional<signed_transaction>& trx) { return !trx.valid(); }))
+      {
+        wlog("peer ${endpoint} sent a wrong number of transactions for compact block ${block_id}, disconnecting",
+             ("endpoint", originating_peer->get_remote_endpoint())
+             ("block_id", compact_block.compact_block.block_id));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me the wrong transactions for block ${block_id}",
+                                                    ("block_id", compact_block.compact_block.block_id)));
+        disconnect_from_peer(originating_peer, "You sent me the wrong transactions for a block", true, detailed_error);
+        return;
+      }
+
+      process_complete_compact_block(originating_peer, std::move(compact_block));
+    }
+
+    void node_impl::on_fetch_block_range_message( peer_connection* originating_peer,
+                                                  const fetch_block_range_message& fetch_block_range_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      dlog("received fetch_block_range_message for ${count} blocks from #${num} from peer ${endpoint}",
+           ("count", fetch_block_range_message_received.block_count)
+           ("num", fetch_block_range_message_received.first_block_num)
+           ("endpoint", originating_peer->get_remote_endpoint()));
+      block_range_message reply(fetch_block_range_message_received.first_block_num);
+      try
+      {
+        reply.packed_blocks = _delegate->get_packed_blocks(fetch_block_range_message_received.first_block_num,
+                                                           std::min<uint32_t>(fetch_block_range_message_received.block_count,
+                                                                              GRAPHENE_NET_MAX_BLOCKS_PER_RANGE_REQUEST),
+                                                           GRAPHENE_NET_MAX_BLOCK_RANGE_DATA_SIZE);
+      }
+      catch (const fc::exception& e)
+      {
+        wlog("unable to read the requested block range, replying with the blocks we have: ${e}", ("e", e));
+      }
+      // an incomplete reply is fine, the peer fetches the rest of the blocks one by one
+      originating_peer->send_message(message(reply));
+    }
+
+    void node_impl::on_block_range_message( peer_connection* originating_peer,
+                                            const block_range_message& block_range_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      auto range_iter = originating_peer->block_ranges_requested_from_peer.find(block_range_message_received.first_block_num);
+      if (range_iter == originating_peer->block_ranges_requested_from_peer.end() ||
+          block_range_message_received.packed_blocks.size() > range_iter->second.size())
+      {
+        wlog("peer ${endpoint} sent us a block range we didn't ask for, disconnecting",
+             ("endpoint", originating_peer->get_remote_endpoint()));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me blocks from #${num} that I didn't ask for",
+                                                    ("num", block_range_message_received.first_block_num)));
+        disconnect_from_peer(originating_peer, "You sent me a block range that I didn't ask for", true, detailed_error);
+        return;
+      }
+      const std::vector<item_hash_t> requested_block_ids = std::move(range_iter->second);
+      originating_peer->block_ranges_requested_from_peer.erase(range_iter);
+      dlog("received ${count} of ${requested} requested blocks from #${num} from peer ${endpoint}",
+           ("count", block_range_message_received.packed_blocks.size())("requested", requested_block_ids.size())
+           ("num", block_range_message_received.first_block_num)("endpoint", originating_peer->get_remote_endpoint()));
+
+      // Turn each block into the block_message the peer would have sent for the requested id, without unpacking the
+      // block here.  The block is checked against its id when it is pushed, like a block fetched by id.
+      for (size_t i = 0; i < block_range_message_received.packed_blocks.size(); ++i)
+      {
+        const message block_message_received
+              = graphene::net::block_message::pack_message(block_range_message_received.packed_blocks[i],
+                                                           requested_block_ids[i]);
+        process_block_message(originating_peer, block_message_received, block_message_received.id());
+      }
+
+      // fetch the blocks the peer could not send one by one, it may be on another fork or have been pruned
+      std::vector<item_hash_t> missing_block_ids;
+      for (size_t i = block_range_message_received.packed_blocks.size(); i < requested_block_ids.size(); ++i)
+        if (originating_peer->sync_items_requested_from_peer.find(requested_block_ids[i])
+              != originating_peer->sync_items_requested_from_peer.end())
+          missing_block_ids.push_back(requested_block_ids[i]);
+      if (!missing_block_ids.empty())
+        originating_peer->send_message(fetch_items_message(graphene::net::block_message_type, missing_block_ids));
+    }
+
+    void node_impl::on_trx_batch_message( peer_connection* originating_peer,
+                                          const trx_batch_message& trx_batch_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      dlog("received a batch of ${count} transactions from peer ${endpoint}",
+           ("count", trx_batch_message_received.packed_transactions.size())
+           ("endpoint", originating_peer->get_remote_endpoint()));
+      // each transaction is handled as if it was sent in its own trx_message, so the peer is disconnected
+      // if it sends us a transaction we didn't ask for
+      for (const std::vector<char>& packed_transaction : trx_batch_message_received.packed_transactions)
+      {
+        if (originating_peer->we_have_requested_close)
+          return;
+        message trx_message_received;
+        trx_message_received.msg_type = trx_message_type;
+        trx_message_received.data = packed_transaction;
+        trx_message_received.size = (uint32_t)trx_message_received.data.size();
+        process_ordinary_message(originating_peer, trx_message_received, trx_message_received.id());
+      }
+    }
+
+    void node_impl::process_complete_compact_block( peer_connection* originating_peer,
+                                                    peer_connection::partial_compact_block&& compact_block )
+    {
+      VERIFY_CORRECT_THREAD();
+      compact_block_message& compact = compact_block.compact_block;
+
+      graphene::net::block_message block_message_to_process;
+      static_cast<graphene::protocol::signed_block_header&>(block_message_to_process.block) = compact.block_header;
+      block_message_to_process.block_id = compact.block_id;
+      block_message_to_process.block.transactions.reserve(compact.transactions.size());
+      for (size_t i = 0; i < compact.transactions.size(); ++i)
+      {
+        graphene::protocol::processed_transaction trx(*compact_block.transactions[i]);
+        trx.operation_results = std::move(compact.transactions[i].operation_results);
+        block_message_to_process.block.transactions.push_back(std::move(trx));
+      }
+
+      // the transactions are referred to by the hashes of their contents, so the rebuilt block is the one we
+      // asked for unless the peer sent us a wrong header or wrong operation results
+      message rebuilt_message(block_message_to_process);
+      message_hash_type rebuilt_message_hash = rebuilt_message.id();
+      if (rebuilt_message_hash != compact.block_message_hash)
+      {
+        wlog("compact block ${block_id} from peer ${endpoint} does not match the block I asked for, disconnecting",
+             ("endpoint", originating_peer->get_remote_endpoint())
+             ("block_id", compact.block_id));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me a compact block which does not match the block I asked for, block_id: ${block_id}",
+                                                    ("block_id", compact.block_id)));
+        disconnect_from_peer(originating_peer, "You sent me an invalid compact block", true, detailed_error);
+        return;
+      }
+
+      process_block_message(originating_peer, rebuilt_message, rebuilt_message_hash);
+    }
+
     void node_impl::on_item_ids_inventory_message(peer_connection* originating_peer, const item_ids_inventory_message& item_ids_inventory_message_received)
     {
       VERIFY_CORRECT_THREAD();
@@ -2393,19 +2896,20 @@ namespace graphene { namespace net { namespace detail {
       for( const item_hash_t& item_hash : item_ids_inventory_message_received.item_hashes_available )
       {
         item_id advertised_item_id(item_ids_inventory_message_received.item_type, item_hash);
-        bool we_advertised_this_item_to_a_peer = false;
+        // the filters of the peers may have false positives, so ask the exact list of what we have advertised
+        bool we_advertised_this_item_to_a_peer =
+              _recently_advertised_inventory.find(advertised_item_id) != _recently_advertised_inventory.end();
         bool we_requested_this_item_from_a_peer = false;
+        if (!we_advertised_this_item_to_a_peer)
         {
            fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
             for (const peer_connection_ptr& peer : _active_connections)
             {
-               if (peer->inventory_advertised_to_peer.find(advertised_item_id) != peer->inventory_advertised_to_peer.end())
+               if (peer->items_requested_from_peer.find(advertised_item_id) != peer->items_requested_from_peer.end())
                {
-                  we_advertised_this_item_to_a_peer = true;
+                  we_requested_this_item_from_a_peer = true;
                   break;
                }
-               if (peer->items_requested_from_peer.find(advertised_item_id) != peer->items_requested_from_peer.end())
-                  we_requested_this_item_from_a_peer = true;
             }
         }
 
@@ -2509,6 +3013,7 @@ namespace graphene { namespace net { namespace detail {
       _closing_connections.erase(originating_peer_ptr);
       _handshaking_connections.erase(originating_peer_ptr);
       _terminating_connections.erase(originating_peer_ptr);
+      _peers_with_pending_trx_batches.erase(originating_peer_ptr);
       if (_active_connections.find(originating_peer_ptr) != _active_connections.end())
       {
         _active_connections.erase(originating_peer_ptr);
@@ -2520,6 +3025,9 @@ namespace graphene { namespace net { namespace detail {
           if (updated_peer_record)
           {
             updated_peer_record->last_seen_time = fc::time_point::now();
+            const uint32_t quality_score_ms = originating_peer_ptr->get_quality_score_ms();
+            if (quality_score_ms > 0)
+              updated_peer_record->quality_score_ms = quality_score_ms;
             _potential_peer_db.update_entry(*updated_peer_record);
           }
         }
@@ -2590,8 +3098,8 @@ namespace graphene { namespace net { namespace detail {
 
       try
       {
-        std::vector<message_hash_type> contained_transaction_msg_ids;
-        _delegate->handle_block(block_message_to_send, true, contained_transaction_msg_ids);
+        block_trace_scope trace( _block_tracer.get(), block_message_to_send.block_id, "delegate_handle_block" );
+        _delegate->handle_block(block_message_to_send, true);
         ilog("Successfully pushed sync block ${num} (id:${id})",
              ("num", block_message_to_send.block.block_num())
              ("id", block_message_to_send.block_id));
@@ -2817,13 +3325,26 @@ namespace graphene { namespace net { namespace detail {
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
 
         block_processed_this_iteration = false;
-        for (auto received_block_iter = _received_sync_items.begin();
-             received_block_iter != _received_sync_items.end();
-             ++received_block_iter)
+
+        // the blocks which are next on the active chain or one of the forks, as seen by our sync peers
+        std::set<item_hash_t> next_block_ids;
         {
+          fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
+          for (const peer_connection_ptr& peer : _active_connections)
+            if (!peer->ids_of_items_to_get.empty())
+              next_block_ids.insert(peer->ids_of_items_to_get.front());
+        }
 
-          // find out if this block is the next block on the active chain or one of the forks
-          bool potential_first_block = false;
+        // blocks arrive out of order from the peers we sync with in parallel, so look for the first one which can
+        // be processed now and leave the others waiting for their predecessors
+        auto received_block_iter = std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
+                                                [&next_block_ids]( const graphene::net::block_message& message ) {
+                                                   return next_block_ids.find( message.block_id ) != next_block_ids.end();
+                                                } );
+
+        // if there is one, process it, remove it from all sync peers lists
+        if (received_block_iter != _received_sync_items.end())
+        {
           {
             fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
             for (const peer_connection_ptr& peer : _active_connections)
@@ -2831,66 +3352,59 @@ namespace graphene { namespace net { namespace detail {
                if (!peer->ids_of_items_to_get.empty() &&
                      peer->ids_of_items_to_get.front() == received_block_iter->block_id)
                {
-                  potential_first_block = true;
                   peer->ids_of_items_to_get.pop_front();
                   peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
                }
             }
           }
 
-          // if it is, process it, remove it from all sync peers lists
-          if (potential_first_block)
+          // we can get into an interesting situation near the end of synchronization.  We can be in
+          // sync with one peer who is sending us the last block on the chain via a regular inventory
+          // message, while at the same time still be synchronizing with a peer who is sending us the
+          // block through the sync mechanism.  Further, we must request both blocks because
+          // we don't know they're the same (for the peer in normal operation, it has only told us the
+          // message id, for the peer in the sync case we only known the block_id).
+          if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                        received_block_iter->block_id) == _most_recent_blocks_accepted.end())
           {
-            // we can get into an interesting situation near the end of synchronization.  We can be in
-            // sync with one peer who is sending us the last block on the chain via a regular inventory
-            // message, while at the same time still be synchronizing with a peer who is sending us the
-            // block through the sync mechanism.  Further, we must request both blocks because
-            // we don't know they're the same (for the peer in normal operation, it has only told us the
-            // message id, for the peer in the sync case we only known the block_id).
-            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
-            {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
-              _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
-              ++blocks_processed;
-              block_processed_this_iteration = true;
-            }
-            else
+            graphene::net::block_message block_message_to_process = *received_block_iter;
+            _received_sync_items.erase(received_block_iter);
+            _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
+              send_sync_block_to_node_delegate(block_message_to_process);
+            }, "send_sync_block_to_node_delegate"));
+            ++blocks_processed;
+            block_processed_this_iteration = true;
+          }
+          else
+          {
+            dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+            std::vector< peer_connection_ptr > peers_needing_next_batch;
+            fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
+            for (const peer_connection_ptr& peer : _active_connections)
             {
-              dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
-              std::vector< peer_connection_ptr > peers_needing_next_batch;
-              fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
-              for (const peer_connection_ptr& peer : _active_connections)
+              auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
+              if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
               {
-                auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
-                if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
+                peer->ids_of_items_being_processed.erase(items_being_processed_iter);
+                dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
+                     ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
+
+                // if we just processed the last item in our list from this peer, we will want to
+                // send another request to find out if we are now in sync (this is normally handled in
+                // send_sync_block_to_node_delegate)
+                if (peer->ids_of_items_to_get.empty() &&
+                    peer->number_of_unfetched_item_ids == 0 &&
+                    peer->ids_of_items_being_processed.empty())
                 {
-                  peer->ids_of_items_being_processed.erase(items_being_processed_iter);
-                  dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
-                       ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
-
-                  // if we just processed the last item in our list from this peer, we will want to
-                  // send another request to find out if we are now in sync (this is normally handled in
-                  // send_sync_block_to_node_delegate)
-                  if (peer->ids_of_items_to_get.empty() &&
-                      peer->number_of_unfetched_item_ids == 0 &&
-                      peer->ids_of_items_being_processed.empty())
-                  {
-                    dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
-                    peers_needing_next_batch.push_back( peer );
-                  }
+                  dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
+                  peers_needing_next_batch.push_back( peer );
                 }
               }
-              for( const peer_connection_ptr& peer : peers_needing_next_batch )
-                fetch_next_batch_of_item_ids_from_peer(peer.get());
             }
-
-            break; // start iterating _received_sync_items from the beginning
-          } // end if potential_first_block
-        } // end for each block in _received_sync_items
+            for( const peer_connection_ptr& peer : peers_needing_next_batch )
+              fetch_next_batch_of_item_ids_from_peer(peer.get());
+          }
+        } // end if a block can be processed
 
         if (_handle_message_calls_in_progress.size() >= _max_blocks_to_handle_at_once)
         {
@@ -2932,6 +3446,7 @@ namespace graphene { namespace net { namespace detail {
     }
 
     void node_impl::process_block_when_in_sync( peer_connection* originating_peer,
+                                               const message& message_to_process,
                                                const graphene::net::block_message& block_message_to_process,
                                                const message_hash_type& message_hash )
     {
@@ -2955,30 +3470,41 @@ namespace graphene { namespace net { namespace detail {
         if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
                       block_message_to_process.block_id) == _most_recent_blocks_accepted.end())
         {
-          std::vector<message_hash_type> contained_transaction_msg_ids;
-          _delegate->handle_block(block_message_to_process, false, contained_transaction_msg_ids);
+          {
+            block_trace_scope trace( _block_tracer.get(), block_message_to_process.block_id, "delegate_handle_block" );
+            _delegate->handle_block(block_message_to_process, false);
+          }
           message_validated_time = fc::time_point::now();
           ilog("Successfully pushed block ${num} (id:${id})",
                 ("num", block_message_to_process.block.block_num())
                 ("id", block_message_to_process.block_id));
           _most_recent_blocks_accepted.push_back(block_message_to_process.block_id);
+          record_block_propagation_delay(originating_peer,
+                message_receive_time - fc::time_point(block_message_to_process.block.timestamp));
 
+          // There's a chance we will be seeing some transactions included in blocks before we see the free-floating
+          // transaction itself.  If that happens, there's no reason to fetch the transactions.  Hashing them is only
+          // worth it if we are waiting for transactions at all, blocks sort before transactions in _items_to_fetch.
           bool new_transaction_discovered = false;
-          for (const item_hash_t& transaction_message_hash : contained_transaction_msg_ids)
-          {
-            /*size_t items_erased =*/
-            _items_to_fetch.get<item_id_index>().erase(item_id(trx_message_type, transaction_message_hash));
-            // there are two ways we could behave here: we could either act as if we received
-            // the transaction outside the block and offer it to our peers, or we could just
-            // forget about it (we would still advertise this block to our peers so they should
-            // get the transaction through that mechanism).
-            // We take the second approach, bring in the next if block to try the first approach
-            //if (items_erased)
-            //{
-            //  new_transaction_discovered = true;
-            //  _new_inventory.insert(item_id(trx_message_type, transaction_message_hash));
-            //}
-          }
+          const bool fetching_transactions = !_items_to_fetch.empty() &&
+                                             _items_to_fetch.rbegin()->item.item_type != block_message_type;
+          if (fetching_transactions)
+            for (const auto& transaction : block_message_to_process.block.transactions)
+            {
+              const item_hash_t transaction_message_hash = trx_message::message_id(transaction);
+              /*size_t items_erased =*/
+              _items_to_fetch.get<item_id_index>().erase(item_id(trx_message_type, transaction_message_hash));
+              // there are two ways we could behave here: we could either act as if we received
+              // the transaction outside the block and offer it to our peers, or we could just
+              // forget about it (we would still advertise this block to our peers so they should
+              // get the transaction through that mechanism).
+              // We take the second approach, bring in the next if block to try the first approach
+              //if (items_erased)
+              //{
+              //  new_transaction_discovered = true;
+              //  _new_inventory.insert(item_id(trx_message_type, transaction_message_hash));
+              //}
+            }
           if (new_transaction_discovered)
             trigger_advertise_inventory_loop();
         }
@@ -3009,7 +3535,11 @@ namespace graphene { namespace net { namespace detail {
         }
         message_propagation_data propagation_data { message_receive_time, message_validated_time,
                                                     originating_peer->node_id };
-        broadcast( block_message_to_process, propagation_data );
+        // relay the bytes we received, the block does not need to be packed again
+        {
+          block_trace_scope trace( _block_tracer.get(), block_message_to_process.block_id, "broadcast" );
+          broadcast( message_to_process, propagation_data );
+        }
         _message_cache.block_accepted();
 
         if (is_hard_fork_block(block_number))
@@ -3103,12 +3633,15 @@ namespace graphene { namespace net { namespace detail {
       // mode before we receive and process the item.  In that case, we should process the item as a normal
       // item to avoid confusing the sync code)
       graphene::net::block_message block_message_to_process(message_to_process.as<graphene::net::block_message>());
+      block_trace_scope trace( _block_tracer.get(), block_message_to_process.block_id, "process_block_message" );
       auto item_iter = originating_peer->items_requested_from_peer.find(
                              item_id(graphene::net::block_message_type, message_hash));
       if (item_iter != originating_peer->items_requested_from_peer.end())
       {
+        originating_peer->fetch_latency.record(fc::time_point::now() - item_iter->second);
+        originating_peer->record_block_delay(fc::time_point::now() - item_iter->second);
         originating_peer->items_requested_from_peer.erase(item_iter);
-        process_block_when_in_sync(originating_peer, block_message_to_process, message_hash);
+        process_block_when_in_sync(originating_peer, message_to_process, block_message_to_process, message_hash);
         if (originating_peer->idle())
           trigger_fetch_items_loop();
         return;
@@ -3126,7 +3659,12 @@ namespace graphene { namespace net { namespace detail {
           try
           {
             originating_peer->last_sync_item_received_time = fc::time_point::now();
-            _active_sync_requests.erase(block_message_to_process.block_id);
+            auto request_iter = _active_sync_requests.find(block_message_to_process.block_id);
+            if (request_iter != _active_sync_requests.end())
+            {
+              originating_peer->record_block_delay(fc::time_point::now() - request_iter->second);
+              _active_sync_requests.erase(request_iter);
+            }
             process_block_during_syncing(originating_peer, block_message_to_process, message_hash);
             if (originating_peer->idle())
             {
@@ -3138,6 +3676,8 @@ namespace graphene { namespace net { namespace detail {
               else
                 trigger_fetch_sync_items_loop();
             }
+            else if (can_request_more_sync_items_from_peer(*originating_peer))
+              trigger_fetch_sync_items_loop();
             return;
           }
           catch (const fc::canceled_exception& e)
@@ -3198,6 +3738,7 @@ namespace graphene { namespace net { namespace detail {
                                              - current_time_reply_message_received.request_sent_time )
                                          - ( current_time_reply_message_received.reply_transmitted_time
                                              - current_time_reply_message_received.request_received_time );
+      originating_peer->record_round_trip_delay(originating_peer->round_trip_delay);
     }
 
     void node_impl::forward_firewall_check_to_next_available_peer(firewall_check_state_data* firewall_check_state)
@@ -3282,7 +3823,7 @@ namespace graphene { namespace net { namespace detail {
         {
           // we're not connected to them, so we need to set up a connection to them
           // to test.
-          peer_connection_ptr peer_for_testing(peer_connection::make_shared(this));
+          peer_connection_ptr peer_for_testing(create_peer_connection());
           peer_for_testing->firewall_check_state = new firewall_check_state_data;
           peer_for_testing->firewall_check_state->endpoint_to_test = check_firewall_message_received.endpoint_to_check;
           peer_for_testing->firewall_check_state->expected_node_id = check_firewall_message_received.node_id;
@@ -3399,10 +3940,21 @@ namespace graphene { namespace net { namespace detail {
       }
       else
       {
+        originating_peer->fetch_latency.record( message_receive_time - iter->second );
         originating_peer->items_requested_from_peer.erase( iter );
         if (originating_peer->idle())
           trigger_fetch_items_loop();
 
+        // Drop the transactions of a peer which exceeds its rate, they are not recorded as failed, so they can
+        // still be fetched from other peers
+        if( message_to_process.msg_type.value() == trx_message_type
+            && !originating_peer->take_transaction_token( message_receive_time ) )
+        {
+          dlog( "peer ${peer} exceeds its transaction rate, dropping transaction ${hash}",
+                ("peer", originating_peer->get_remote_endpoint())("hash", message_hash) );
+          return;
+        }
+
         // Next: have the delegate process the message
         fc::time_point message_validated_time;
         try
@@ -3428,6 +3980,7 @@ namespace graphene { namespace net { namespace detail {
           {
           // log common exceptions in debug level
           case graphene::chain::duplicate_transaction::code_enum::code_value :
+          case graphene::chain::pending_transaction_pool_full::code_enum::code_value :
           case graphene::chain::limit_order_create_kill_unfilled::code_enum::code_value :
           case graphene::chain::limit_order_create_market_not_whitelisted::code_enum::code_value :
           case graphene::chain::limit_order_create_market_blacklisted::code_enum::code_value :
@@ -3670,6 +4223,27 @@ namespace graphene { namespace net { namespace detail {
         wlog( "Exception thrown while terminating Advertise inventory loop, ignoring" );
       }
 
+      try
+      {
+        _trx_batch_flush_loop_done.cancel("node_impl::close()");
+        // cancel() is currently broken, so we need to wake up the task to allow it to finish
+        trigger_trx_batch_flush_loop();
+        _trx_batch_flush_loop_done.wait();
+        dlog("Transaction batch flush loop terminated");
+      }
+      catch ( const fc::canceled_exception& )
+      {
+        dlog("Transaction batch flush loop terminated");
+      }
+      catch ( const fc::exception& e )
+      {
+        wlog( "Exception thrown while terminating Transaction batch flush loop, ignoring: ${e}", ("e", e) );
+      }
+      catch (...)
+      {
+        wlog( "Exception thrown while terminating Transaction batch flush loop, ignoring" );
+      }
+
 
       // Next, terminate our existing connections.  First, close all of the connections nicely.
       // This will close the sockets and may result in calls to our "on_connection_closing"
@@ -3814,12 +4388,23 @@ namespace graphene { namespace net { namespace detail {
       send_hello_message(new_peer);
     }
 
+    peer_connection_ptr node_impl::create_peer_connection()
+    {
+      VERIFY_CORRECT_THREAD();
+      peer_connection_ptr new_peer = peer_connection::make_shared(this, get_next_network_io_thread());
+      if (_inventory_filter_false_positive_rate != GRAPHENE_NET_DEFAULT_INVENTORY_FILTER_FALSE_POSITIVE_RATE)
+        new_peer->inventory_advertised_to_peer = rolling_bloom_filter(GRAPHENE_NET_INVENTORY_FILTER_CAPACITY,
+                                                                      _inventory_filter_false_positive_rate,
+                                                                      fc::minutes(GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES));
+      return new_peer;
+    }
+
     void node_impl::accept_loop()
     {
       VERIFY_CORRECT_THREAD();
       while ( !_accept_loop_complete.canceled() )
       {
-        peer_connection_ptr new_peer(peer_connection::make_shared(this));
+        peer_connection_ptr new_peer(create_peer_connection());
 
         try
         {
@@ -4193,6 +4778,7 @@ namespace graphene { namespace net { namespace detail {
              !_fetch_sync_items_loop_done.valid() &&
              !_fetch_item_loop_done.valid() &&
              !_advertise_inventory_loop_done.valid() &&
+             !_trx_batch_flush_loop_done.valid() &&
              !_kill_inactive_conns_loop_done.valid() &&
              !_fetch_updated_peer_lists_loop_done.valid() &&
              !_bandwidth_monitor_loop_done.valid() &&
@@ -4206,6 +4792,7 @@ namespace graphene { namespace net { namespace detail {
       _fetch_item_loop_done = fc::async( [this]() { fetch_items_loop(); }, "fetch_items_loop" );
       _advertise_inventory_loop_done = fc::async( [this]() { advertise_inventory_loop(); },
                                                   "advertise_inventory_loop" );
+      _trx_batch_flush_loop_done = fc::async( [this]() { trx_batch_flush_loop(); }, "trx_batch_flush_loop" );
       _kill_inactive_conns_loop_done = fc::async( [this,self]() { kill_inactive_conns_loop(self); },
                                                   "kill_inactive_conns_loop" );
       _fetch_updated_peer_lists_loop_done = fc::async([this](){ fetch_updated_peer_lists_loop(); },
@@ -4287,7 +4874,7 @@ namespace graphene { namespace net { namespace detail {
                            ("endpoint", remote_endpoint));
 
       dlog("node_impl::connect_to_endpoint(${endpoint})", ("endpoint", remote_endpoint));
-      peer_connection_ptr new_peer(peer_connection::make_shared(this));
+      peer_connection_ptr new_peer(create_peer_connection());
       new_peer->set_remote_endpoint(remote_endpoint);
       initiate_connect_to(new_peer);
     }
@@ -4500,7 +5087,7 @@ namespace graphene { namespace net { namespace detail {
         peer_details["bytessent"] = peer->get_total_bytes_sent();
         peer_details["bytesrecv"] = peer->get_total_bytes_received();
         peer_details["conntime"] = peer->get_connection_time();
-        peer_details["pingtime"] = "";
+        peer_details["pingtime"] = peer->average_round_trip_delay.count() / 1000;
         peer_details["pingwait"] = "";
         peer_details["version"] = "";
         peer_details["subver"] = peer->user_agent;
@@ -4546,6 +5133,10 @@ namespace graphene { namespace net { namespace detail {
         peer_details["peer_needs_sync_items_from_us"] = peer->peer_needs_sync_items_from_us;
         peer_details["we_need_sync_items_from_peer"] = peer->we_need_sync_items_from_peer;
 
+        peer_details["average_round_trip_delay_ms"] = peer->average_round_trip_delay.count() / 1000;
+        peer_details["average_block_delay_ms"] = peer->average_block_delay.count() / 1000;
+        peer_details["quality_score_ms"] = peer->get_quality_score_ms();
+
         this_peer_status.info = peer_details;
         statuses.push_back(this_peer_status);
       }
@@ -4564,9 +5155,10 @@ namespace graphene { namespace net { namespace detail {
       message_hash_type hash_of_message_contents;
       if( item_to_broadcast.msg_type.value() == graphene::net::block_message_type )
       {
-        graphene::net::block_message block_message_to_broadcast = item_to_broadcast.as<graphene::net::block_message>();
-        hash_of_message_contents = block_message_to_broadcast.block_id; // for debugging
-        _most_recent_blocks_accepted.push_back( block_message_to_broadcast.block_id );
+        // the block itself is not needed, do not unpack it
+        const block_id_type block_id = graphene::net::block_message::block_id_of( item_to_broadcast );
+        hash_of_message_contents = block_id; // for debugging
+        _most_recent_blocks_accepted.push_back( block_id );
       }
       else if( item_to_broadcast.msg_type.value() == graphene::net::trx_message_type )
       {
@@ -4629,6 +5221,17 @@ namespace graphene { namespace net { namespace detail {
         _max_sync_blocks_to_prefetch = params["max_sync_blocks_to_prefetch"].as<uint32_t>(1);
       if (params.contains("max_sync_blocks_per_peer"))
         _max_sync_blocks_per_peer = params["max_sync_blocks_per_peer"].as<uint32_t>(1);
+      if (params.contains("trx_batch_flush_interval_ms"))
+        _trx_batch_flush_interval_ms = params["trx_batch_flush_interval_ms"].as<uint32_t>(1);
+      if (params.contains("max_trx_batch_size"))
+        _max_trx_batch_size = params["max_trx_batch_size"].as<uint32_t>(1);
+      if (params.contains("inventory_filter_false_positive_rate"))
+      {
+        double false_positive_rate = params["inventory_filter_false_positive_rate"].as_double();
+        FC_ASSERT(false_positive_rate > 0 && false_positive_rate < 1,
+                  "inventory_filter_false_positive_rate must be between 0 and 1");
+        _inventory_filter_false_positive_rate = false_positive_rate;
+      }
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4648,6 +5251,9 @@ namespace graphene { namespace net { namespace detail {
       result["max_blocks_to_handle_at_once"] = _max_blocks_to_handle_at_once;
       result["max_sync_blocks_to_prefetch"] = _max_sync_blocks_to_prefetch;
       result["max_sync_blocks_per_peer"] = _max_sync_blocks_per_peer;
+      result["trx_batch_flush_interval_ms"] = _trx_batch_flush_interval_ms;
+      result["max_trx_batch_size"] = _max_trx_batch_size;
+      result["inventory_filter_false_positive_rate"] = _inventory_filter_false_positive_rate;
       return result;
     }
 
@@ -4699,6 +5305,41 @@ namespace graphene { namespace net { namespace detail {
       _rate_limiter.set_download_limit( download_bytes_per_second );
     }
 
+    void node_impl::set_network_io_thread_count( uint32_t thread_count )
+    {
+      VERIFY_CORRECT_THREAD();
+      FC_ASSERT( _handshaking_connections.empty() && _active_connections.empty()
+                 && _closing_connections.empty() && _terminating_connections.empty(),
+                 "The number of network I/O threads can not be changed while connections are open" );
+      _network_io_threads.clear();
+      _next_network_io_thread = 0;
+      for( uint32_t i = 0; i < thread_count; ++i )
+        _network_io_threads.push_back( std::make_shared<fc::thread>( "p2p io " + std::to_string(i) ) );
+    }
+
+    void node_impl::run_in_network_threads( const std::function<void()>& task )
+    {
+      VERIFY_CORRECT_THREAD();
+      task();
+      for( const auto& io_thread : _network_io_threads )
+        io_thread->async( task, "run in network thread" ).wait();
+    }
+
+    fc::thread* node_impl::get_next_network_io_thread()
+    {
+      VERIFY_CORRECT_THREAD();
+      if( _network_io_threads.empty() )
+        return nullptr;
+      _next_network_io_thread %= _network_io_threads.size();
+      return _network_io_threads[_next_network_io_thread++].get();
+    }
+
+    void node_impl::set_block_tracer( std::shared_ptr<block_tracer> tracer )
+    {
+      VERIFY_CORRECT_THREAD();
+      _block_tracer = std::move( tracer );
+    }
+
     void node_impl::disable_peer_advertising()
     {
       VERIFY_CORRECT_THREAD();
@@ -4721,6 +5362,86 @@ namespace graphene { namespace net { namespace detail {
       info["firewalled"] = fc::variant( _is_firewalled, 1 );
       return info;
     }
+    /// Upper bounds of the buckets of the block propagation delay histogram, the last bucket takes the rest
+    static const int64_t block_propagation_delay_bucket_bounds_ms[] = { 250, 500, 1000, 2000, 3000, 5000, 10000, 30000 };
+    static_assert( sizeof(block_propagation_delay_bucket_bounds_ms) / sizeof(int64_t) + 1
+                   == node_impl::block_propagation_delay_bucket_count,
+                   "one bucket more than bucket bounds is needed" );
+
+    void node_impl::record_block_propagation_delay( peer_connection* originating_peer, const fc::microseconds& delay )
+    {
+      VERIFY_CORRECT_THREAD();
+      originating_peer->block_propagation_delay.record( delay );
+      size_t bucket = 0;
+      while( bucket + 1 < block_propagation_delay_bucket_count
+             && delay.count() > block_propagation_delay_bucket_bounds_ms[bucket] * 1000 )
+        ++bucket;
+      ++_block_propagation_delay_histogram[bucket];
+    }
+
+    fc::variant_object node_impl::network_get_metrics() const
+    {
+      VERIFY_CORRECT_THREAD();
+      const auto message_counters_to_variant = []( const std::map<uint32_t, peer_connection::message_type_counters>& counters ) {
+        fc::variants result;
+        for( const auto& type_and_counters : counters )
+        {
+          fc::mutable_variant_object entry;
+          entry["type"] = fc::variant( core_message_type_enum( type_and_counters.first ), 1 );
+          entry["messages"] = type_and_counters.second.messages;
+          entry["bytes"] = type_and_counters.second.bytes;
+          result.emplace_back( std::move( entry ) );
+        }
+        return result;
+      };
+      const auto latency_to_variant = []( const peer_connection::latency_counters& latency ) {
+        fc::mutable_variant_object result;
+        result["count"] = latency.count;
+        result["average_ms"] = latency.count > 0 ? latency.total.count() / int64_t(latency.count) / 1000 : 0;
+        result["max_ms"] = latency.max.count() / 1000;
+        return result;
+      };
+
+      fc::variants peers;
+      {
+        fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
+        for( const peer_connection_ptr& peer : _active_connections )
+        {
+          fc::mutable_variant_object peer_metrics;
+          fc::optional<fc::ip::endpoint> endpoint = peer->get_remote_endpoint();
+          peer_metrics["addr"] = endpoint ? (std::string)*endpoint : std::string();
+          peer_metrics["node_id"] = fc::variant( peer->node_id, 1 );
+          peer_metrics["received"] = message_counters_to_variant( peer->messages_received_by_type );
+          peer_metrics["sent"] = message_counters_to_variant( peer->messages_sent_by_type );
+          peer_metrics["queued_messages"] = peer->get_queued_message_count();
+          peer_metrics["queued_bytes"] = peer->get_total_queued_messages_size();
+          peer_metrics["inventory_advertised_to_us"] = peer->inventory_peer_advertised_to_us.size();
+          peer_metrics["inventory_advertised_to_peer"] = peer->inventory_advertised_to_peer.size();
+          peer_metrics["inventory_filter_bytes"] = peer->inventory_advertised_to_peer.memory_usage();
+          peer_metrics["items_requested"] = peer->items_requested_from_peer.size();
+          peer_metrics["sync_items_requested"] = peer->sync_items_requested_from_peer.size();
+          peer_metrics["fetch_latency"] = latency_to_variant( peer->fetch_latency );
+          peer_metrics["block_propagation_delay"] = latency_to_variant( peer->block_propagation_delay );
+          peers.emplace_back( std::move( peer_metrics ) );
+        }
+      }
+
+      fc::variants histogram;
+      for( size_t bucket = 0; bucket < block_propagation_delay_bucket_count; ++bucket )
+      {
+        fc::mutable_variant_object entry;
+        if( bucket + 1 < block_propagation_delay_bucket_count )
+          entry["max_ms"] = block_propagation_delay_bucket_bounds_ms[bucket];
+        entry["blocks"] = _block_propagation_delay_histogram[bucket];
+        histogram.emplace_back( std::move( entry ) );
+      }
+
+      fc::mutable_variant_object result;
+      result["peers"] = peers;
+      result["block_propagation_delay_histogram"] = histogram;
+      return result;
+    }
+
     fc::variant_object node_impl::network_get_usage_stats() const
     {
       VERIFY_CORRECT_THREAD();
@@ -4911,6 +5632,21 @@ namespace graphene { namespace net { namespace detail {
     INVOKE_IN_IMPL(set_total_bandwidth_limit, upload_bytes_per_second, download_bytes_per_second);
   }
 
+  void node::set_network_io_thread_count(uint32_t thread_count)
+  {
+    INVOKE_IN_IMPL(set_network_io_thread_count, thread_count);
+  }
+
+  void node::run_in_network_threads(const std::function<void()>& task)
+  {
+    INVOKE_IN_IMPL(run_in_network_threads, task);
+  }
+
+  void node::set_block_tracer(std::shared_ptr<block_tracer> tracer)
+  {
+    INVOKE_IN_IMPL(set_block_tracer, tracer);
+  }
+
   void node::disable_peer_advertising()
   {
     INVOKE_IN_IMPL(disable_peer_advertising);
@@ -4931,6 +5667,11 @@ namespace graphene { namespace net { namespace detail {
     INVOKE_IN_IMPL(network_get_usage_stats);
   }
 
+  fc::variant_object node::network_get_metrics() const
+  {
+    INVOKE_IN_IMPL(network_get_metrics);
+  }
+
   void node::close()
   {
     INVOKE_IN_IMPL(close);
@@ -5050,9 +5791,9 @@ namespace graphene { namespace net { namespace detail {
     }
 
     bool statistics_gathering_node_delegate_wrapper::handle_block( const graphene::net::block_message& block_message,
-             bool sync_mode, std::vector<message_hash_type>& contained_transaction_msg_ids)
+                                                                   bool sync_mode )
     {
-      INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_msg_ids);
+      INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode);
     }
 
     void statistics_gathering_node_delegate_wrapper::handle_transaction( const graphene::net::trx_message& transaction_message )
@@ -5072,6 +5813,12 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(get_item, id);
     }
 
+    std::vector<std::vector<char>> statistics_gathering_node_delegate_wrapper::get_packed_blocks(
+          uint32_t first_block_num, uint32_t count, size_t max_total_size )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(get_packed_blocks, first_block_num, count, max_total_size);
+    }
+
     chain_id_type statistics_gathering_node_delegate_wrapper::get_chain_id() const
     {
       INVOKE_AND_COLLECT_STATISTICS(get_chain_id);
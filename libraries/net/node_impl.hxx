@@ -16,6 +16,7 @@
 #define testnetlog(...) do {} while (0)
 #endif
 
+#include <array>
 #include <memory>
 #include <mutex>
 #include <fc/thread/thread.hpp>
@@ -159,7 +160,8 @@ private:
    struct message_info
    {
       message_hash_type message_hash;
-      message           message_body;
+      /// shared with the send queues of the peers which the message is sent to
+      std::shared_ptr<const message> message_body;
       uint32_t          block_clock_when_received;
 
       /// for network performance stats
@@ -174,7 +176,7 @@ private:
                     const message_propagation_data& propagation_data,
                     message_hash_type        message_contents_hash ) :
             message_hash( message_hash ),
-            message_body( message_body ),
+            message_body( std::make_shared<const message>( message_body ) ),
             block_clock_when_received( block_clock_when_received ),
             propagation_data( propagation_data ),
             message_contents_hash( message_contents_hash )
@@ -201,6 +203,10 @@ public:
                        const message_propagation_data& propagation_data,
                        const message_hash_type& message_content_hash );
    message get_message( const message_hash_type& hash_of_message_to_lookup ) const;
+   /// Like @ref get_message, but returns the cached message itself instead of a copy
+   std::shared_ptr<const message> get_shared_message( const message_hash_type& hash_of_message_to_lookup ) const;
+   /// Records when a peer fetched the message for the first time
+   void message_requested( const message_hash_type& hash_of_message );
    message_propagation_data get_message_propagation_data(
          const message_hash_type& hash_of_msg_contents_to_lookup ) const;
    size_t size() const { return _message_cache.size(); }
@@ -247,6 +253,7 @@ class statistics_gathering_node_delegate_wrapper : public node_delegate
                                (handle_transaction) \
                                (get_block_ids) \
                                (get_item) \
+                               (get_packed_blocks) \
                                (get_chain_id) \
                                (get_blockchain_synopsis) \
                                (sync_status) \
@@ -341,13 +348,14 @@ class statistics_gathering_node_delegate_wrapper : public node_delegate
 
       bool has_item( const graphene::net::item_id& id ) override;
       void handle_message( const message& ) override;
-      bool handle_block( const graphene::net::block_message& block_message, bool sync_mode,
-                         std::vector<message_hash_type>& contained_transaction_msg_ids ) override;
+      bool handle_block( const graphene::net::block_message& block_message, bool sync_mode ) override;
       void handle_transaction( const graphene::net::trx_message& transaction_message ) override;
       std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t>& blockchain_synopsis,
                                              uint32_t& remaining_item_count,
                                              uint32_t limit = 2000) override;
       message get_item( const item_id& id ) override;
+      std::vector<std::vector<char>> get_packed_blocks( uint32_t first_block_num, uint32_t count,
+                                                        size_t max_total_size ) override;
       graphene::protocol::chain_id_type get_chain_id() const override;
       std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t& reference_point,
                                                        uint32_t number_of_blocks_after_reference_point) override;
@@ -383,11 +391,17 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
 #ifdef P2P_IN_DEDICATED_THREAD
       std::shared_ptr<fc::thread> _thread = std::make_shared<fc::thread>("p2p");
 #endif // P2P_IN_DEDICATED_THREAD
+      /// Threads which handle socket I/O, encryption and message framing of the peer connections, the connections
+      /// are assigned to them in turn.  If empty, all of it is done in the p2p thread
+      std::vector<std::shared_ptr<fc::thread>> _network_io_threads;
+      size_t _next_network_io_thread = 0;
       std::unique_ptr<statistics_gathering_node_delegate_wrapper> _delegate;
+      /// Stages of the handling of the received blocks, null if they are not traced
+      std::shared_ptr<block_tracer> _block_tracer;
       fc::sha256           _chain_id;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat"
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
@@ -465,6 +479,22 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
       fc::future<void>              _advertise_inventory_loop_done;
       /// List of items we have received but not yet advertised to our peers
       concurrent_unordered_set<item_id>   _new_inventory;
+      /// Items we have advertised to our peers recently, which we don't need to fetch
+      peer_connection::timestamped_items_set_type _recently_advertised_inventory;
+      /// False positive rate of the filters of the items advertised to each peer, used for new connections
+      double _inventory_filter_false_positive_rate = GRAPHENE_NET_DEFAULT_INVENTORY_FILTER_FALSE_POSITIVE_RATE;
+      /// @}
+
+      /// Used by the task that sends batches of requested transactions to peers which support them
+      /// @{
+      fc::promise<void>::ptr        _retrigger_trx_batch_flush_loop_promise;
+      fc::future<void>              _trx_batch_flush_loop_done;
+      /// Peers which have transactions waiting in peer_connection::pending_trx_batch
+      std::set<peer_connection_ptr> _peers_with_pending_trx_batches;
+      /// How long requested transactions are collected before they are sent
+      uint32_t _trx_batch_flush_interval_ms = GRAPHENE_NET_DEFAULT_TRX_BATCH_FLUSH_INTERVAL_MS;
+      /// Maximum number of transactions in one batch, 0 or 1 to disable batching
+      size_t _max_trx_batch_size = GRAPHENE_NET_DEFAULT_MAX_TRX_BATCH_SIZE;
       /// @}
 
       fc::future<void>     _kill_inactive_conns_loop_done;
@@ -533,6 +563,11 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
 
       fc::future<void> _fetch_updated_peer_lists_loop_done;
 
+      /// Number of buckets of _block_propagation_delay_histogram, see block_propagation_delay_bucket_bounds_ms
+      static constexpr size_t block_propagation_delay_bucket_count = 9;
+      /// Number of blocks accepted during normal operation by the delay between their timestamp and their arrival
+      std::array<uint64_t, block_propagation_delay_bucket_count> _block_propagation_delay_histogram {};
+
       /// Average network read speed in the past seconds
       boost::circular_buffer<uint32_t> _avg_net_read_speed_seconds { 60 };
       /// Average network write speed in the past seconds
@@ -610,6 +645,12 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
       void request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request );
       void request_sync_items_from_peer( const peer_connection_ptr& peer, const std::vector<item_hash_t>& items_to_request );
       void fetch_sync_items_loop();
+      bool can_request_more_sync_items_from_peer( const peer_connection& peer ) const;
+      /// @return the quality score of the peer, or the default score if it has not been measured yet
+      static uint32_t effective_quality_score_ms( const peer_connection& peer );
+      /// @return the active connections ordered by quality, the fastest first
+      /// @note the caller must hold the mutex of @ref _active_connections
+      std::vector<peer_connection_ptr> get_active_connections_by_quality() const;
       void trigger_fetch_sync_items_loop();
 
       bool is_item_in_any_peers_inventory(const item_id& item) const;
@@ -619,8 +660,17 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
       void advertise_inventory_loop();
       void trigger_advertise_inventory_loop();
 
+      void trx_batch_flush_loop();
+      void trigger_trx_batch_flush_loop();
+      /// Adds a requested transaction to the peer's batch, returns false if it has to be sent on its own
+      bool add_to_trx_batch( peer_connection* peer, const std::shared_ptr<const message>& trx_message_to_send );
+      void flush_trx_batch( peer_connection& peer );
+
       void kill_inactive_conns_loop(node_impl_ptr self);
 
+      /// Creates the connection object for a new peer, with the configured inventory filter
+      peer_connection_ptr create_peer_connection();
+
       void fetch_updated_peer_lists_loop();
       void update_bandwidth_data(uint32_t bytes_read_this_second, uint32_t bytes_written_this_second);
       void bandwidth_monitor_loop();
@@ -664,11 +714,33 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
                                                      const blockchain_item_ids_inventory_message& blockchain_item_ids_inventory_message_received );
 
       void on_fetch_items_message( peer_connection* originating_peer,
-                                   const fetch_items_message& fetch_items_message_received ) const;
+                                   const fetch_items_message& fetch_items_message_received );
 
       void on_item_not_available_message( peer_connection* originating_peer,
                                           const item_not_available_message& item_not_available_message_received );
 
+      void on_compact_block_message( peer_connection* originating_peer,
+                                     const compact_block_message& compact_block_message_received );
+
+      void on_fetch_compact_block_transactions_message( peer_connection* originating_peer,
+            const fetch_compact_block_transactions_message& fetch_compact_block_transactions_message_received ) const;
+
+      void on_compact_block_transactions_message( peer_connection* originating_peer,
+            const compact_block_transactions_message& compact_block_transactions_message_received );
+
+      void on_fetch_block_range_message( peer_connection* originating_peer,
+                                         const fetch_block_range_message& fetch_block_range_message_received );
+
+      void on_block_range_message( peer_connection* originating_peer,
+                                   const block_range_message& block_range_message_received );
+
+      void on_trx_batch_message( peer_connection* originating_peer,
+                                 const trx_batch_message& trx_batch_message_received );
+
+      /// Rebuilds the block of a compact block whose transactions are all known and processes it
+      void process_complete_compact_block( peer_connection* originating_peer,
+                                           peer_connection::partial_compact_block&& compact_block );
+
       void on_item_ids_inventory_message( peer_connection* originating_peer,
                                           const item_ids_inventory_message& item_ids_inventory_message_received );
 
@@ -698,8 +770,10 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
                   peer_connection* originating_peer,
                   const graphene::net::block_message& block_message,
                   const message_hash_type& message_hash);
+      /// @p message_to_process is the message carrying @p block_message, it is relayed as it is
       void process_block_when_in_sync(
                   peer_connection* originating_peer,
+                  const message& message_to_process,
                   const graphene::net::block_message& block_message,
                   const message_hash_type& message_hash);
       void process_block_message(
@@ -775,12 +849,19 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
       void                       set_allowed_peers( const std::vector<node_id_t>& allowed_peers );
       void                       clear_peer_database();
       void                       set_total_bandwidth_limit( uint32_t upload_bytes_per_second, uint32_t download_bytes_per_second );
+      void                       set_network_io_thread_count( uint32_t thread_count );
+      void                       run_in_network_threads( const std::function<void()>& task );
+      void                       set_block_tracer( std::shared_ptr<block_tracer> tracer );
+      fc::thread*                get_next_network_io_thread();
       void                       disable_peer_advertising();
       fc::variant_object         get_call_statistics() const;
       message                    get_message_for_item(const item_id& item) override;
 
       fc::variant_object         network_get_info() const;
       fc::variant_object         network_get_usage_stats() const;
+      fc::variant_object         network_get_metrics() const;
+      void                       record_block_propagation_delay( peer_connection* originating_peer,
+                                                                 const fc::microseconds& delay );
 
       bool is_hard_fork_block(uint32_t block_number) const;
       uint32_t get_next_known_hard_fork_block_number(uint32_t block_number) const;
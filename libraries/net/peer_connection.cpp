@@ -31,6 +31,9 @@
 
 #include <boost/scope_exit.hpp>
 
+#include <algorithm>
+#include <limits>
+
 #ifdef DEFAULT_LOGGER
 # undef DEFAULT_LOGGER
 #endif
@@ -44,7 +47,7 @@
 
 namespace graphene { namespace net
   {
-    message peer_connection::real_queued_message::get_message(peer_connection_delegate*)
+    const message& peer_connection::real_queued_message::get_message(peer_connection_delegate*)
     {
       if (message_send_time_field_offset != (size_t)-1)
       {
@@ -61,9 +64,18 @@ namespace graphene { namespace net
     {
       return message_to_send.data.size();
     }
-    message peer_connection::virtual_queued_message::get_message(peer_connection_delegate* node)
+    const message& peer_connection::shared_queued_message::get_message(peer_connection_delegate*)
+    {
+      return *message_to_send;
+    }
+    size_t peer_connection::shared_queued_message::get_size_in_queue()
     {
-      return node->get_message_for_item(item_to_send);
+      return message_to_send->data.size();
+    }
+    const message& peer_connection::virtual_queued_message::get_message(peer_connection_delegate* node)
+    {
+      generated_message = node->get_message_for_item(item_to_send);
+      return generated_message;
     }
 
     size_t peer_connection::virtual_queued_message::get_size_in_queue()
@@ -71,9 +83,9 @@ namespace graphene { namespace net
       return sizeof(item_id);
     }
 
-    peer_connection::peer_connection(peer_connection_delegate* delegate) :
+    peer_connection::peer_connection(peer_connection_delegate* delegate, fc::thread* io_thread) :
       _node(delegate),
-      _message_connection(this),
+      _message_connection(this, io_thread),
       _total_queued_messages_size(0),
       direction(peer_connection_direction::unknown),
       is_firewalled(firewalled_state::unknown),
@@ -97,7 +109,7 @@ namespace graphene { namespace net
     {
     }
 
-    peer_connection_ptr peer_connection::make_shared(peer_connection_delegate* delegate)
+    peer_connection_ptr peer_connection::make_shared(peer_connection_delegate* delegate, fc::thread* io_thread)
     {
       // The lifetime of peer_connection objects is managed by shared_ptrs in node.  The peer_connection
       // is responsible for notifying the node when it should be deleted, and the process of deleting it
@@ -112,9 +124,10 @@ namespace graphene { namespace net
       class peer_connection_subclass : public peer_connection
       {
       public:
-         explicit peer_connection_subclass(peer_connection_delegate* delegate) : peer_connection(delegate) {}
+         peer_connection_subclass(peer_connection_delegate* delegate, fc::thread* io_thread)
+         : peer_connection(delegate, io_thread) {}
       };
-      return std::make_shared<peer_connection_subclass>(delegate);
+      return std::make_shared<peer_connection_subclass>(delegate, io_thread);
     }
 
     void peer_connection::destroy()
@@ -298,16 +311,26 @@ namespace graphene { namespace net
         ~counter() { assert(_send_message_queue_tasks_counter == 1); --_send_message_queue_tasks_counter; /* dlog("leaving peer_connection::send_queued_messages_task()"); */ }
       } concurrent_invocation_counter(_send_message_queue_tasks_running);
 #endif
-      while (!_queued_messages.empty())
+      for (;;)
       {
-        _queued_messages.front()->transmission_start_time = fc::time_point::now();
-        message message_to_send = _queued_messages.front()->get_message(_node);
+        // always pick the oldest message of the highest priority class which has messages queued
+        auto queue_itr = std::find_if(_queued_messages.begin(), _queued_messages.end(),
+                                      [](const message_queue& queue) { return !queue.empty(); });
+        if (queue_itr == _queued_messages.end())
+          break;
+        message_queue& queue = *queue_itr;
+        const size_t priority = queue_itr - _queued_messages.begin();
+        queue.front()->transmission_start_time = fc::time_point::now();
+        const message& message_to_send = queue.front()->get_message(_node);
         try
         {
           //dlog("peer_connection::send_queued_messages_task() calling message_oriented_connection::send_message() "
           //     "to send message of type ${type} for peer ${endpoint}",
           //     ("type", message_to_send.msg_type)("endpoint", get_remote_endpoint()));
           _message_connection.send_message(message_to_send);
+          message_type_counters& counters = messages_sent_by_type[message_to_send.msg_type.value()];
+          ++counters.messages;
+          counters.bytes += message_to_send.size.value();
           //dlog("peer_connection::send_queued_messages_task()'s call to message_oriented_connection::send_message() completed normally for peer ${endpoint}",
           //     ("endpoint", get_remote_endpoint()));
         }
@@ -337,22 +360,57 @@ namespace graphene { namespace net
         {
           wlog("message_oriented_exception::send_message() threw an unhandled exception");
         }
-        _queued_messages.front()->transmission_finish_time = fc::time_point::now();
-        _total_queued_messages_size -= _queued_messages.front()->get_size_in_queue();
-        _queued_messages.pop();
+        queue.front()->transmission_finish_time = fc::time_point::now();
+        const size_t size_in_queue = queue.front()->get_size_in_queue();
+        _queued_messages_size[priority] -= size_in_queue;
+        _total_queued_messages_size -= size_in_queue;
+        queue.pop();
       }
       //dlog("leaving peer_connection::send_queued_messages_task() due to queue exhaustion");
     }
 
-    void peer_connection::send_queueable_message(std::unique_ptr<queued_message>&& message_to_send)
+    peer_connection::message_priority peer_connection::get_message_priority(const message& message_to_send)
+    {
+      switch (message_to_send.msg_type.value())
+      {
+      case block_message_type:
+      case compact_block_message_type:
+      case compact_block_transactions_message_type:
+      case block_range_message_type:
+      case blockchain_item_ids_inventory_message_type:
+        return high_priority_messages;
+      case item_ids_inventory_message_type:
+      {
+        // only the leading item type is needed, don't unpack the list of hashes
+        fc::datastream<const char*> ds(message_to_send.data.data(), message_to_send.data.size());
+        uint32_t item_type = 0;
+        fc::raw::unpack(ds, item_type);
+        return item_type == block_message_type ? high_priority_messages : normal_priority_messages;
+      }
+      default:
+        return normal_priority_messages;
+      }
+    }
+
+    size_t peer_connection::get_max_queued_messages_size(message_priority priority)
+    {
+      return priority == high_priority_messages ? GRAPHENE_NET_MAXIMUM_QUEUED_HIGH_PRIORITY_MESSAGES_IN_BYTES
+                                                : GRAPHENE_NET_MAXIMUM_QUEUED_MESSAGES_IN_BYTES;
+    }
+
+    void peer_connection::send_queueable_message(std::unique_ptr<queued_message>&& message_to_send,
+                                                 message_priority priority)
     {
       VERIFY_CORRECT_THREAD();
-      _total_queued_messages_size += message_to_send->get_size_in_queue();
-      _queued_messages.emplace(std::move(message_to_send));
-      if (_total_queued_messages_size > GRAPHENE_NET_MAXIMUM_QUEUED_MESSAGES_IN_BYTES)
+      const size_t size_in_queue = message_to_send->get_size_in_queue();
+      _queued_messages_size[priority] += size_in_queue;
+      _total_queued_messages_size += size_in_queue;
+      _queued_messages[priority].emplace(std::move(message_to_send));
+      if (_queued_messages_size[priority] > get_max_queued_messages_size(priority))
       {
-        wlog("send queue exceeded maximum size of ${max} bytes (current size ${current} bytes)",
-             ("max", GRAPHENE_NET_MAXIMUM_QUEUED_MESSAGES_IN_BYTES)("current", _total_queued_messages_size));
+        wlog("send queue of priority ${priority} exceeded maximum size of ${max} bytes (current size ${current} bytes)",
+             ("priority", static_cast<uint32_t>(priority))("max", get_max_queued_messages_size(priority))
+             ("current", _queued_messages_size[priority]));
         try
         {
           close_connection();
@@ -383,7 +441,15 @@ namespace graphene { namespace net
       //     ("type", message_to_send.msg_type)("endpoint", get_remote_endpoint())); // for debug
       auto message_to_enqueue = std::make_unique<real_queued_message>(
                                       message_to_send, message_send_time_field_offset );
-      send_queueable_message(std::move(message_to_enqueue));
+      send_queueable_message(std::move(message_to_enqueue), get_message_priority(message_to_send));
+    }
+
+    void peer_connection::send_message(std::shared_ptr<const message> message_to_send)
+    {
+      VERIFY_CORRECT_THREAD();
+      const message_priority priority = get_message_priority(*message_to_send);
+      auto message_to_enqueue = std::make_unique<shared_queued_message>( std::move(message_to_send) );
+      send_queueable_message(std::move(message_to_enqueue), priority);
     }
 
     void peer_connection::send_item(const item_id& item_to_send)
@@ -391,8 +457,10 @@ namespace graphene { namespace net
       VERIFY_CORRECT_THREAD();
       //dlog("peer_connection::send_item() enqueueing message of type ${type} for peer ${endpoint}",
       //     ("type", item_to_send.item_type)("endpoint", get_remote_endpoint())); // for debug
+      const message_priority priority = item_to_send.item_type == block_message_type ? high_priority_messages
+                                                                                      : normal_priority_messages;
       auto message_to_enqueue = std::make_unique<virtual_queued_message>(item_to_send);
-      send_queueable_message(std::move(message_to_enqueue));
+      send_queueable_message(std::move(message_to_enqueue), priority);
     }
 
     void peer_connection::close_connection()
@@ -423,6 +491,59 @@ namespace graphene { namespace net
       return _message_connection.get_total_bytes_received();
     }
 
+    size_t peer_connection::get_queued_message_count() const
+    {
+      VERIFY_CORRECT_THREAD();
+      size_t count = 0;
+      for (const message_queue& queue : _queued_messages)
+        count += queue.size();
+      return count;
+    }
+
+    size_t peer_connection::get_total_queued_messages_size() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _total_queued_messages_size;
+    }
+
+    namespace
+    {
+      /// Moves the average an eighth of the way towards the sample, the first sample is taken as it is
+      void update_moving_average(fc::microseconds& average, const fc::microseconds& sample)
+      {
+        constexpr int64_t weight = 8;
+        const fc::microseconds positive_sample = std::max(sample, fc::microseconds(1));
+        if (average.count() == 0)
+          average = positive_sample;
+        else
+          average = fc::microseconds(average.count() + (positive_sample.count() - average.count()) / weight);
+      }
+    }
+
+    void peer_connection::record_round_trip_delay(const fc::microseconds& delay)
+    {
+      VERIFY_CORRECT_THREAD();
+      update_moving_average(average_round_trip_delay, delay);
+    }
+
+    void peer_connection::record_block_delay(const fc::microseconds& delay)
+    {
+      VERIFY_CORRECT_THREAD();
+      update_moving_average(average_block_delay, delay);
+    }
+
+    uint32_t peer_connection::get_quality_score_ms() const
+    {
+      VERIFY_CORRECT_THREAD();
+      const int64_t block_delay = average_block_delay.count() > 0 ? average_block_delay.count()
+                                                                  : 2 * average_round_trip_delay.count();
+      if (block_delay == 0)
+        return 0;
+      const int64_t score_ms = (average_round_trip_delay.count() + block_delay) / 1000;
+      return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(score_ms, 1),
+                                                     std::numeric_limits<uint32_t>::max()));
+    }
+
     fc::time_point peer_connection::get_last_message_sent_time() const
     {
       VERIFY_CORRECT_THREAD();
@@ -435,6 +556,12 @@ namespace graphene { namespace net
       return _message_connection.get_last_message_received_time();
     }
 
+    fc::time_point peer_connection::get_last_message_read_start_time() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _message_connection.get_last_message_read_start_time();
+    }
+
     fc::optional<fc::ip::endpoint> peer_connection::get_remote_endpoint()
     {
       VERIFY_CORRECT_THREAD();
@@ -487,20 +614,17 @@ namespace graphene { namespace net
       VERIFY_CORRECT_THREAD();
       fc::time_point_sec oldest_inventory_to_keep(fc::time_point::now() - fc::minutes(GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES));
 
-      // expire old items from inventory_advertised_to_peer
-      auto oldest_inventory_to_keep_iter = inventory_advertised_to_peer.get<timestamp_index>().lower_bound(oldest_inventory_to_keep);
-      auto begin_iter = inventory_advertised_to_peer.get<timestamp_index>().begin();
-      unsigned number_of_elements_advertised_to_peer_to_discard = std::distance(begin_iter, oldest_inventory_to_keep_iter);
-      inventory_advertised_to_peer.get<timestamp_index>().erase(begin_iter, oldest_inventory_to_keep_iter);
+      // expire old items from inventory_advertised_to_peer, the filter forgets whole generations of items
+      inventory_advertised_to_peer.expire_old_items();
 
       // also expire items from inventory_peer_advertised_to_us
-      oldest_inventory_to_keep_iter = inventory_peer_advertised_to_us.get<timestamp_index>().lower_bound(oldest_inventory_to_keep);
-      begin_iter = inventory_peer_advertised_to_us.get<timestamp_index>().begin();
+      auto oldest_inventory_to_keep_iter = inventory_peer_advertised_to_us.get<timestamp_index>().lower_bound(oldest_inventory_to_keep);
+      auto begin_iter = inventory_peer_advertised_to_us.get<timestamp_index>().begin();
       unsigned number_of_elements_peer_advertised_to_discard = std::distance(begin_iter, oldest_inventory_to_keep_iter);
       inventory_peer_advertised_to_us.get<timestamp_index>().erase(begin_iter, oldest_inventory_to_keep_iter);
-      dlog("Expiring old inventory for peer ${peer}: removing ${to_peer} items advertised to peer (${remain_to_peer} left), and ${to_us} advertised to us (${remain_to_us} left)",
+      dlog("Expiring old inventory for peer ${peer}: ${remain_to_peer} items advertised to peer remembered, removing ${to_us} advertised to us (${remain_to_us} left)",
            ("peer", get_remote_endpoint())
-           ("to_peer", number_of_elements_advertised_to_peer_to_discard)("remain_to_peer", inventory_advertised_to_peer.size())
+           ("remain_to_peer", inventory_advertised_to_peer.size())
            ("to_us", number_of_elements_peer_advertised_to_discard)("remain_to_us", inventory_peer_advertised_to_us.size()));
     }
 
@@ -522,6 +646,19 @@ namespace graphene { namespace net
         (GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES + 1) * 60 / GRAPHENE_MIN_BLOCK_INTERVAL;
     }
 
+    bool peer_connection::take_transaction_token(const fc::time_point& now)
+    {
+      VERIFY_CORRECT_THREAD();
+      if( transaction_tokens_updated != fc::time_point() && now > transaction_tokens_updated )
+        transaction_tokens = std::min<double>( GRAPHENE_NET_PEER_TRX_BURST, transaction_tokens
+                               + ( now - transaction_tokens_updated ).to_seconds() * GRAPHENE_NET_PEER_TRX_PER_SECOND );
+      transaction_tokens_updated = now;
+      if( transaction_tokens < 1 )
+        return false;
+      transaction_tokens -= 1;
+      return true;
+    }
+
     bool peer_connection::performing_firewall_check() const
     {
       return firewall_check_state && firewall_check_state->requesting_peer != node_id_t();
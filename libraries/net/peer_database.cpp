@@ -28,14 +28,19 @@
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/tag.hpp>
 
+#include <boost/filesystem/path.hpp>
+
 #include <fc/io/raw.hpp>
 #include <fc/io/raw_variant.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
+#include <fc/filesystem.hpp>
 
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/config.hpp>
 
+#include <fstream>
+
 namespace graphene { namespace net {
   namespace detail
   {
@@ -59,8 +64,25 @@ namespace graphene { namespace net {
                                                                     std::hash<fc::ip::endpoint> > > > potential_peer_set;
 
     private:
+      /// The kinds of entries of the store file, each entry is followed by the record or the endpoint
+      enum store_entry_kind : uint8_t
+      {
+        updated_record = 0,
+        erased_endpoint = 1
+      };
+
       potential_peer_set     _potential_peer_set;
       fc::path _peer_database_filename;
+      /// The store file is open for appending while the database is open
+      std::ofstream _store;
+      /// The number of entries in the store file, it is compacted when there are too many of them
+      size_t _store_entries = 0;
+
+      void load_store();
+      void import_json( const fc::path& json_filename );
+      template<typename T>
+      void append_to_store( store_entry_kind kind, const T& payload );
+      void compact_store();
 
     public:
       void open(const fc::path& databaseFilename);
@@ -92,58 +114,168 @@ namespace graphene { namespace net {
     {
       _peer_database_filename = peer_database_filename;
       if (fc::exists(_peer_database_filename))
+        load_store();
+      else
+      {
+        // a database of an older version is a JSON file next to the store
+        const fc::path json_filename = boost::filesystem::path( _peer_database_filename.generic_string() )
+                                          .replace_extension( ".json" ).generic_string();
+        if (fc::exists(json_filename))
+          import_json(json_filename);
+      }
+      if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+      {
+        // prune database to a reasonable size
+        auto iter = _potential_peer_set.begin();
+        std::advance(iter, MAXIMUM_PEERDB_SIZE);
+        _potential_peer_set.erase(iter, _potential_peer_set.end());
+      }
+      // start with one entry per peer, this also drops an incomplete entry written during a crash
+      compact_store();
+    }
+
+    void peer_database_impl::load_store()
+    {
+      std::string content;
+      try
+      {
+        fc::read_file_contents(_peer_database_filename, content);
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error opening peer database file ${peer_database_filename}, starting with a clean database",
+             ("peer_database_filename", _peer_database_filename));
+        return;
+      }
+      fc::datastream<const char*> ds(content.data(), content.size());
+      while (ds.remaining() > 0)
       {
         try
         {
-          std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
-          std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
-          if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+          std::vector<char> entry;
+          fc::raw::unpack(ds, entry);
+          FC_ASSERT(!entry.empty());
+          fc::datastream<const char*> entry_ds(entry.data() + 1, entry.size() - 1);
+          if (entry.front() == updated_record)
+          {
+            potential_peer_record record;
+            fc::raw::unpack(entry_ds, record);
+            auto iter = _potential_peer_set.get<endpoint_index>().find(record.endpoint);
+            if (iter != _potential_peer_set.get<endpoint_index>().end())
+              _potential_peer_set.get<endpoint_index>().replace(iter, record);
+            else
+              _potential_peer_set.get<endpoint_index>().insert(record);
+          }
+          else
           {
-            // prune database to a reasonable size
-            auto iter = _potential_peer_set.begin();
-            std::advance(iter, MAXIMUM_PEERDB_SIZE);
-            _potential_peer_set.erase(iter, _potential_peer_set.end());
+            FC_ASSERT(entry.front() == erased_endpoint);
+            fc::ip::endpoint endpoint;
+            fc::raw::unpack(entry_ds, endpoint);
+            _potential_peer_set.get<endpoint_index>().erase(endpoint);
           }
         }
         catch (const fc::exception& e)
         {
-          elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
+          // the last entry is incomplete if the node crashed while writing it, keep the entries before it
+          wlog("ignoring a damaged entry at the end of the peer database file ${peer_database_filename}",
                ("peer_database_filename", _peer_database_filename));
+          break;
         }
       }
     }
 
-    void peer_database_impl::close()
+    void peer_database_impl::import_json(const fc::path& json_filename)
     {
-      std::vector<potential_peer_record> peer_records;
-      peer_records.reserve(_potential_peer_set.size());
-      std::copy(_potential_peer_set.begin(), _potential_peer_set.end(), std::back_inserter(peer_records));
+      try
+      {
+        std::vector<potential_peer_record> peer_records = fc::json::from_file(json_filename)
+              .as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        std::copy(peer_records.begin(), peer_records.end(),
+                  std::inserter(_potential_peer_set, _potential_peer_set.end()));
+        ilog("imported ${n} peers from ${json_filename}",
+             ("n", _potential_peer_set.size())("json_filename", json_filename));
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error importing peer database file ${json_filename}, starting with a clean database",
+             ("json_filename", json_filename));
+      }
+    }
+
+    template<typename T>
+    void peer_database_impl::append_to_store(store_entry_kind kind, const T& payload)
+    {
+      if (!_store.is_open())
+        return;
+      std::vector<char> entry(1, static_cast<char>(kind));
+      const std::vector<char> packed_payload = fc::raw::pack(payload);
+      entry.insert(entry.end(), packed_payload.begin(), packed_payload.end());
+      fc::raw::pack(_store, entry);
+      _store.flush();
+      ++_store_entries;
+      // every peer is updated a few times per connection attempt, rewrite the file once it is mostly outdated
+      if (_store_entries > 2 * _potential_peer_set.size() + MAXIMUM_PEERDB_SIZE)
+        compact_store();
+    }
 
+    void peer_database_impl::compact_store()
+    {
+      if (_peer_database_filename.generic_string().empty())
+        return;
+      if (_store.is_open())
+        _store.close();
+      _store_entries = 0;
       try
       {
         fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
         if (!fc::exists(peer_database_filename_dir))
           fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file( peer_records, _peer_database_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        const fc::path tmp_filename = _peer_database_filename.generic_string() + ".tmp";
+        {
+          std::ofstream out(tmp_filename.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc);
+          for (const potential_peer_record& record : _potential_peer_set)
+          {
+            std::vector<char> entry(1, static_cast<char>(updated_record));
+            const std::vector<char> packed_record = fc::raw::pack(record);
+            entry.insert(entry.end(), packed_record.begin(), packed_record.end());
+            fc::raw::pack(out, entry);
+          }
+          out.close();
+          FC_ASSERT(out, "Failed to write ${f}", ("f", tmp_filename));
+        }
+        fc::rename(tmp_filename, _peer_database_filename);
+        _store_entries = _potential_peer_set.size();
+        _store.open(_peer_database_filename.generic_string(), std::ios::out | std::ios::binary | std::ios::app);
       }
       catch (const fc::exception& e)
       {
-        elog("error saving peer database to file ${peer_database_filename}", 
+        elog("error saving peer database to file ${peer_database_filename}",
              ("peer_database_filename", _peer_database_filename));
       }
+    }
+
+    void peer_database_impl::close()
+    {
+      compact_store();
+      _store.close();
+      _peer_database_filename = fc::path();
       _potential_peer_set.clear();
     }
 
     void peer_database_impl::clear()
     {
       _potential_peer_set.clear();
+      compact_store();
     }
 
     void peer_database_impl::erase(const fc::ip::endpoint& endpointToErase)
     {
       auto iter = _potential_peer_set.get<endpoint_index>().find(endpointToErase);
       if (iter != _potential_peer_set.get<endpoint_index>().end())
+      {
         _potential_peer_set.get<endpoint_index>().erase(iter);
+        append_to_store(erased_endpoint, endpointToErase);
+      }
     }
 
     void peer_database_impl::update_entry(const potential_peer_record& updatedRecord)
@@ -153,6 +285,7 @@ namespace graphene { namespace net {
         _potential_peer_set.get<endpoint_index>().modify(iter, [&updatedRecord](potential_peer_record& record) { record = updatedRecord; });
       else
         _potential_peer_set.get<endpoint_index>().insert(updatedRecord);
+      append_to_store(updated_record, updatedRecord);
     }
 
     potential_peer_record peer_database_impl::lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup)
@@ -285,6 +418,6 @@ FC_REFLECT_ENUM( graphene::net::potential_peer_last_connection_disposition,
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::potential_peer_record, BOOST_PP_SEQ_NIL,
                                 (endpoint)(last_seen_time)(last_connection_disposition)
                                 (last_connection_attempt_time)(number_of_successful_connection_attempts)
-                                (number_of_failed_connection_attempts)(last_error) )
+                                (number_of_failed_connection_attempts)(last_error)(quality_score_ms) )
 
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::potential_peer_record)
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/net/rolling_bloom_filter.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace graphene { namespace net {
+
+  namespace
+  {
+    // the finalizer of splitmix64, spreads the bits of the seeded item hash
+    uint64_t mix_bits(uint64_t x)
+    {
+      x += 0x9e3779b97f4a7c15ULL;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+    }
+  }
+
+  rolling_bloom_filter::rolling_bloom_filter(size_t capacity, double false_positive_rate, fc::microseconds max_age) :
+    _items_per_generation(std::max<size_t>((capacity + 1) / 2, 1)),
+    _max_age(max_age)
+  {
+    FC_ASSERT(false_positive_rate > 0 && false_positive_rate < 1,
+              "The false positive rate must be between 0 and 1, got ${rate}", ("rate", false_positive_rate));
+    // an item is looked up in both generations, so each one gets half of the false positive rate
+    const double ln2 = std::log(2.0);
+    const double bits = std::ceil(-(double)_items_per_generation * std::log(false_positive_rate / 2) / (ln2 * ln2));
+    _bits_per_generation = std::max<uint64_t>(((uint64_t)bits + 63) / 64 * 64, 64);
+    _hash_count = (uint32_t)std::min(std::max(std::round(bits / _items_per_generation * ln2), 1.0), 32.0);
+
+    // a random seed per filter, so that nobody can make up item ids which collide in the filters of all nodes
+    std::random_device random_source;
+    _seed = ((uint64_t)random_source() << 32) | random_source();
+  }
+
+  std::pair<uint64_t, uint64_t> rolling_bloom_filter::get_hashes(const item_id& item) const
+  {
+    const uint64_t first = mix_bits(std::hash<item_id>()(item) ^ _seed);
+    // the second hash is the step between the bits, it must not be 0
+    return std::make_pair(first, mix_bits(first) | 1);
+  }
+
+  bool rolling_bloom_filter::generation_contains(const generation& gen,
+                                                 const std::pair<uint64_t, uint64_t>& hashes) const
+  {
+    if (gen.item_count == 0)
+      return false;
+    for (uint32_t i = 0; i < _hash_count; ++i)
+    {
+      const uint64_t bit = (hashes.first + i * hashes.second) % _bits_per_generation;
+      if ((gen.bits[bit / 64] & (uint64_t(1) << (bit % 64))) == 0)
+        return false;
+    }
+    return true;
+  }
+
+  void rolling_bloom_filter::insert(const item_id& item)
+  {
+    const fc::time_point now = fc::time_point::now();
+    if (_current.bits.empty())
+    {
+      _current.bits.assign(_bits_per_generation / 64, 0);
+      _current.start_time = now;
+    }
+    else if (_current.item_count >= _items_per_generation)
+      roll(now);
+
+    const std::pair<uint64_t, uint64_t> hashes = get_hashes(item);
+    for (uint32_t i = 0; i < _hash_count; ++i)
+    {
+      const uint64_t bit = (hashes.first + i * hashes.second) % _bits_per_generation;
+      _current.bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    ++_current.item_count;
+  }
+
+  bool rolling_bloom_filter::contains(const item_id& item) const
+  {
+    if (size() == 0)
+      return false;
+    const std::pair<uint64_t, uint64_t> hashes = get_hashes(item);
+    return generation_contains(_current, hashes) || generation_contains(_previous, hashes);
+  }
+
+  void rolling_bloom_filter::expire_old_items(fc::time_point now)
+  {
+    if (size() > 0 && now - _current.start_time > _max_age)
+      roll(now);
+  }
+
+  void rolling_bloom_filter::clear()
+  {
+    _current = generation();
+    _previous = generation();
+  }
+
+  size_t rolling_bloom_filter::memory_usage() const
+  {
+    return (_current.bits.capacity() + _previous.bits.capacity()) * sizeof(uint64_t);
+  }
+
+  void rolling_bloom_filter::roll(fc::time_point now)
+  {
+    // reuse the bits of the dropped generation for the new one
+    std::swap(_current, _previous);
+    if (_current.bits.empty())
+      _current.bits.assign(_bits_per_generation / 64, 0);
+    else
+      std::fill(_current.bits.begin(), _current.bits.end(), 0);
+    _current.item_count = 0;
+    _current.start_time = now;
+  }
+
+} } // graphene::net
@@ -36,6 +36,12 @@
 
 namespace graphene { namespace net {
 
+/**
+ * Size of the buffers which hold the ciphertext.  Data is encrypted and decrypted a whole buffer at a time, the
+ * cipher contexts use hardware acceleration where the CPU has it, so the cost per byte is lowest for large batches.
+ */
+static const size_t cipher_buffer_length = 16 * 1024;
+
 stcp_socket::stcp_socket()
 //:_buf_len(0)
 #ifndef NDEBUG
@@ -100,11 +106,10 @@ size_t stcp_socket::readsome( char* buffer, size_t len )
     } buffer_in_use_checker(_read_buffer_in_use);
 #endif
 
-    const size_t read_buffer_length = 4096;
     if (!_read_buffer)
-      _read_buffer.reset(new char[read_buffer_length], [](char* p){ delete[] p; });
+      _read_buffer.reset(new char[cipher_buffer_length], [](char* p){ delete[] p; });
 
-    len = std::min<size_t>(read_buffer_length, len);
+    len = std::min<size_t>(cipher_buffer_length, len);
 
     size_t s = _sock.readsome( _read_buffer, len, 0 );
     if( s % 16 ) 
@@ -141,17 +146,10 @@ size_t stcp_socket::writesome( const char* buffer, size_t len )
     } buffer_in_use_checker(_write_buffer_in_use);
 #endif
 
-    const std::size_t write_buffer_length = 4096;
     if (!_write_buffer)
-      _write_buffer.reset(new char[write_buffer_length], [](char* p){ delete[] p; });
-    len = std::min<size_t>(write_buffer_length, len);
-    memset(_write_buffer.get(), 0, len); // just in case aes.encode screws up
-    /**
-     * every sizeof(crypt_buf) bytes the aes channel
-     * has an error and doesn't decrypt properly...  disable
-     * for now because we are going to upgrade to something
-     * better.
-     */
+      _write_buffer.reset(new char[cipher_buffer_length], [](char* p){ delete[] p; });
+    len = std::min<size_t>(cipher_buffer_length, len);
+    // the whole buffer is overwritten by the ciphertext, there is no need to clear it first
     uint32_t ciphertext_len = _send_aes.encode( buffer, len, _write_buffer.get() );
     assert(ciphertext_len == len);
     _sock.write( _write_buffer, ciphertext_len );
@@ -23,6 +23,7 @@
  */
 
 #include <graphene/account_history/account_history_plugin.hpp>
+#include <graphene/account_history/account_history_store.hpp>
 
 #include <graphene/chain/impacted.hpp>
 
@@ -31,12 +32,18 @@
 #include <graphene/chain/config.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/transaction_evaluation_state.hpp>
 #include <graphene/chain/hardfork.hpp>
 
+#include <fc/thread/parallel.hpp>
 #include <fc/thread/thread.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <limits>
+
 namespace graphene { namespace account_history {
 
 namespace detail
@@ -71,33 +78,57 @@ class account_history_plugin_impl
       primary_index< operation_history_index >* _oho_index;
       uint64_t _max_ops_per_account = -1;
       uint64_t _extended_max_ops_per_account = -1;
+      bool _store_removed_history = false;
+      account_history_store _store;
+
+      /// Operations per thread below which computing the impacted accounts in parallel does not pay off
+      static constexpr size_t min_ops_per_parallel_chunk = 32;
+
+      /** computes the accounts each of the applied operations of the block is relevant to */
+      void compute_impacted_accounts( const signed_block& b,
+                                      const vector< optional< operation_history_object > >& hist,
+                                      vector< flat_set<account_id_type> >& impacted )const;
+
+      /// Number of excess entries to remove per block in the deferred trimming mode, 0 to remove them at once
+      uint64_t _trim_batch_size = 0;
+      /// Accounts which have more entries than they keep, in the order they exceeded their limit
+      std::deque<account_id_type> _trim_backlog;
+      flat_set<account_id_type> _trim_backlog_accounts;
+      uint64_t _trimmed_entries = 0;
 
       /** add one history record, then check and remove the earliest history record */
       void add_account_history( const account_id_type account_id, const operation_history_id_type op_id );
+      /** the number of history records to keep for the account */
+      uint64_t get_max_ops_to_keep( const account_id_type account_id );
+      /** remove the earliest history record of the account unless it is the most recent one */
+      bool remove_earliest_account_history( const account_id_type account_id );
+      /** remove up to the given number of excess history records of the accounts in the trim backlog */
+      void trim_account_histories( uint64_t max_entries );
+      account_history_trim_metrics get_trim_metrics();
 
 };
 
 void account_history_plugin_impl::update_account_histories( const signed_block& b )
 {
    graphene::chain::database& db = database();
+   // the data directory of the database is only known once it is open, which is before the first block is applied.
+   // The history is rebuilt from the first block on a replay, so the store starts over as well.
+   if( _store_removed_history && !_store.is_open() )
+      _store.open( db.get_data_dir() / "account_history", b.block_num() == 1 );
+
    const vector<optional< operation_history_object > >& hist = db.get_applied_operations();
-   bool is_first = true;
-   auto skip_oho_id = [&is_first,&db,this]() {
-      if( is_first && db._undo_db.enabled() ) // this ensures that the current id is rolled back on undo
-      {
-         db.remove( db.create<operation_history_object>( []( operation_history_object& obj) {} ) );
-         is_first = false;
-      }
-      else
-         _oho_index->use_next_id();
-   };
+   // the skipped id is handed out again if the block is undone
+   auto skip_oho_id = [this]() { _oho_index->reserve_next_id(); };
+
+   vector< flat_set<account_id_type> > all_impacted( hist.size() );
+   if( !( _max_ops_per_account == 0 && _partial_operations ) )
+      compute_impacted_accounts( b, hist, all_impacted );
 
    for( const optional< operation_history_object >& o_op : hist )
    {
       optional<operation_history_object> oho;
 
       auto create_oho = [&]() {
-         is_first = false;
          return optional<operation_history_object>( db.create<operation_history_object>( [&]( operation_history_object& h )
          {
             if( o_op.valid() )
@@ -123,38 +154,8 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
          // add to the operation history index
          oho = create_oho();
 
-      const operation_history_object& op = *o_op;
-
       // get the set of accounts this operation applies to
-      flat_set<account_id_type> impacted;
-      vector<authority> other;
-      // fee payer is added here
-      operation_get_required_authorities( op.op, impacted, impacted, other,
-                                          MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( db.head_block_time() ) );
-
-      if( op.op.is_type< account_create_operation >() )
-         impacted.insert( op.result.get<object_id_type>() );
-
-      // https://github.com/bitshares/bitshares-core/issues/265
-      if( HARDFORK_CORE_265_PASSED(b.timestamp) || !op.op.is_type< account_create_operation >() )
-      {
-         operation_get_impacted_accounts( op.op, impacted,
-                                          MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( db.head_block_time() ) );
-      }
-
-      if( op.result.is_type<extendable_operation_result>() )
-      {
-         const auto& op_result = op.result.get<extendable_operation_result>();
-         if( op_result.value.impacted_accounts.valid() )
-         {
-            for( const auto& a : *op_result.value.impacted_accounts )
-               impacted.insert( a );
-         }
-      }
-
-      for( auto& a : other )
-         for( auto& item : a.account_auths )
-            impacted.insert( item.first );
+      const flat_set<account_id_type>& impacted = all_impacted[ &o_op - hist.data() ];
 
       // be here, either _max_ops_per_account > 0, or _partial_operations == false, or both
       // if _partial_operations == false, oho should have been created above
@@ -208,6 +209,90 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
       if (_partial_operations && ! oho.valid())
          skip_oho_id();
    }
+
+   // deferred trimming removes a batch per block, and the whole backlog in maintenance blocks
+   if( _trim_batch_size > 0 && !_trim_backlog.empty() )
+   {
+      const bool maintenance = ( db.get_dynamic_global_properties().dynamic_flags
+                                 & dynamic_global_property_object::maintenance_flag ) != 0;
+      trim_account_histories( maintenance ? std::numeric_limits<uint64_t>::max() : _trim_batch_size );
+   }
+}
+
+void account_history_plugin_impl::compute_impacted_accounts( const signed_block& b,
+                                           const vector< optional< operation_history_object > >& hist,
+                                           vector< flat_set<account_id_type> >& impacted )const
+{
+   const bool ignore_custom_op_reqd_auths = MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( _self.database().head_block_time() );
+   const bool hf_265_passed = HARDFORK_CORE_265_PASSED( b.timestamp );
+   // shared with the other plugins, computed here before the workers read it
+   const vector< flat_set<account_id_type> >& op_impacted = _self.database().get_applied_operations_impacted_accounts();
+   auto compute = [&hist,&impacted,&op_impacted,ignore_custom_op_reqd_auths,hf_265_passed]
+                  ( size_t first, size_t last ) {
+      for( size_t i = first; i < last; ++i )
+      {
+         if( !hist[i].valid() )
+            continue;
+         const operation_history_object& op = *hist[i];
+         flat_set<account_id_type>& accounts = impacted[i];
+
+         vector<authority> other;
+         // fee payer is added here
+         operation_get_required_authorities( op.op, accounts, accounts, other, ignore_custom_op_reqd_auths );
+
+         if( op.op.is_type< account_create_operation >() )
+            accounts.insert( op.result.get<object_id_type>() );
+
+         // https://github.com/bitshares/bitshares-core/issues/265
+         if( hf_265_passed || !op.op.is_type< account_create_operation >() )
+            accounts.insert( op_impacted[i].begin(), op_impacted[i].end() );
+
+         if( op.result.is_type<extendable_operation_result>() )
+         {
+            const auto& op_result = op.result.get<extendable_operation_result>();
+            if( op_result.value.impacted_accounts.valid() )
+            {
+               for( const auto& a : *op_result.value.impacted_accounts )
+                  accounts.insert( a );
+            }
+         }
+
+         for( auto& a : other )
+            for( auto& item : a.account_auths )
+               accounts.insert( item.first );
+      }
+   };
+
+   // The impacted accounts only depend on the operations, so they are computed in the thread pool before the
+   // history is updated sequentially. Small blocks are not worth the handover.
+   const size_t chunks = std::min<size_t>( fc::asio::default_io_service_scope::get_num_threads(),
+                                           hist.size() / min_ops_per_parallel_chunk );
+   if( chunks <= 1 )
+   {
+      compute( 0, hist.size() );
+      return;
+   }
+   std::vector< fc::future<void> > workers;
+   workers.reserve( chunks );
+   for( size_t chunk = 0; chunk < chunks; ++chunk )
+   {
+      const size_t first = hist.size() * chunk / chunks;
+      const size_t last = hist.size() * ( chunk + 1 ) / chunks;
+      workers.push_back( fc::do_parallel( [&compute,first,last]() { compute( first, last ); } ) );
+   }
+   // all workers must be done before the results go out of scope, even if one of them failed
+   std::exception_ptr failure;
+   for( auto& worker : workers )
+   {
+      try {
+         worker.wait();
+      } catch( ... ) {
+         if( !failure )
+            failure = std::current_exception();
+      }
+   }
+   if( failure )
+      std::rethrow_exception( failure );
 }
 
 void account_history_plugin_impl::add_account_history( const account_id_type account_id,
@@ -226,6 +311,19 @@ void account_history_plugin_impl::add_account_history( const account_id_type acc
        obj.most_recent_op = ath.id;
        obj.total_ops = ath.sequence;
    });
+   // Remove the earliest account history entry if too many, or leave it to the deferred trimming
+   if( stats_obj.total_ops - stats_obj.removed_ops > get_max_ops_to_keep( account_id ) )
+   {
+      if( _trim_batch_size == 0 )
+         remove_earliest_account_history( account_id );
+      else if( _trim_backlog_accounts.insert( account_id ).second )
+         _trim_backlog.push_back( account_id );
+   }
+}
+
+uint64_t account_history_plugin_impl::get_max_ops_to_keep( const account_id_type account_id )
+{
+   graphene::chain::database& db = database();
    // Amount of history to keep depends on if account is in the "extended history" list
    bool extended_hist = ( _extended_history_accounts.find( account_id ) != _extended_history_accounts.end() );
    if( !extended_hist && !_extended_history_registrars.empty() ) {
@@ -238,49 +336,101 @@ void account_history_plugin_impl::add_account_history( const account_id_type acc
    if (extended_hist && _extended_max_ops_per_account > max_ops_to_keep) {
       max_ops_to_keep = _extended_max_ops_per_account;
    }
-   // Remove the earliest account history entry if too many.
-   if( stats_obj.total_ops - stats_obj.removed_ops > max_ops_to_keep )
+   return max_ops_to_keep;
+}
+
+bool account_history_plugin_impl::remove_earliest_account_history( const account_id_type account_id )
+{
+   graphene::chain::database& db = database();
+   const auto& stats_obj = account_id(db).statistics(db);
+   // look for the earliest entry
+   const auto& his_idx = db.get_index_type<account_transaction_history_index>();
+   const auto& by_seq_idx = his_idx.indices().get<by_seq>();
+   auto itr = by_seq_idx.lower_bound( boost::make_tuple( account_id, 0 ) );
+   // make sure don't remove the most recent one
+   if( itr == by_seq_idx.end() || itr->account != account_id || itr->id == stats_obj.most_recent_op )
+      return false;
+
+   // if found, remove the entry, and adjust account stats object
+   const auto remove_op_id = itr->operation_id;
+   if( _store_removed_history )
+      _store.store( account_id, itr->sequence, remove_op_id(db) );
+   const auto itr_remove = itr;
+   ++itr;
+   db.remove( *itr_remove );
+   db.modify( stats_obj, [&]( account_statistics_object& obj ){
+       obj.removed_ops = obj.removed_ops + 1;
+   });
+   // modify previous node's next pointer
+   // this should be always true, but just have a check here
+   if( itr != by_seq_idx.end() && itr->account == account_id )
+   {
+      db.modify( *itr, [&]( account_transaction_history_object& obj ){
+         obj.next = account_transaction_history_id_type();
+      });
+   }
+   // else need to modify the head pointer, but it shouldn't be true
+
+   // remove the operation history entry (1.11.x) if configured and no reference left
+   if( _partial_operations )
    {
-      // look for the earliest entry
-      const auto& his_idx = db.get_index_type<account_transaction_history_index>();
-      const auto& by_seq_idx = his_idx.indices().get<by_seq>();
-      auto itr = by_seq_idx.lower_bound( boost::make_tuple( account_id, 0 ) );
-      // make sure don't remove the one just added
-      if( itr != by_seq_idx.end() && itr->account == account_id && itr->id != ath.id )
+      // check for references
+      const auto& by_opid_idx = his_idx.indices().get<by_opid>();
+      if( by_opid_idx.find( remove_op_id ) == by_opid_idx.end() )
       {
-         // if found, remove the entry, and adjust account stats object
-         const auto remove_op_id = itr->operation_id;
-         const auto itr_remove = itr;
-         ++itr;
-         db.remove( *itr_remove );
-         db.modify( stats_obj, [&]( account_statistics_object& obj ){
-             obj.removed_ops = obj.removed_ops + 1;
-         });
-         // modify previous node's next pointer
-         // this should be always true, but just have a check here
-         if( itr != by_seq_idx.end() && itr->account == account_id )
-         {
-            db.modify( *itr, [&]( account_transaction_history_object& obj ){
-               obj.next = account_transaction_history_id_type();
-            });
-         }
-         // else need to modify the head pointer, but it shouldn't be true
+         // if no reference, remove
+         db.remove( remove_op_id(db) );
+      }
+   }
+   return true;
+}
 
-         // remove the operation history entry (1.11.x) if configured and no reference left
-         if( _partial_operations )
+void account_history_plugin_impl::trim_account_histories( uint64_t max_entries )
+{
+   graphene::chain::database& db = database();
+   // The accounts are trimmed in the order they exceeded their limit. An account whose excess is larger than the
+   // batch stays first and is continued with the next batch, others are not starved by busy accounts because
+   // an account is queued once until it is trimmed completely.
+   while( max_entries > 0 && !_trim_backlog.empty() )
+   {
+      const account_id_type account_id = _trim_backlog.front();
+      const auto& stats_obj = account_id(db).statistics(db);
+      const uint64_t max_ops_to_keep = get_max_ops_to_keep( account_id );
+      bool done = false;
+      while( !done && max_entries > 0 )
+      {
+         done = ( stats_obj.total_ops - stats_obj.removed_ops <= max_ops_to_keep
+                  || !remove_earliest_account_history( account_id ) );
+         if( !done )
          {
-            // check for references
-            const auto& by_opid_idx = his_idx.indices().get<by_opid>();
-            if( by_opid_idx.find( remove_op_id ) == by_opid_idx.end() )
-            {
-               // if no reference, remove
-               db.remove( remove_op_id(db) );
-            }
+            --max_entries;
+            ++_trimmed_entries;
          }
       }
+      if( !done && stats_obj.total_ops - stats_obj.removed_ops > max_ops_to_keep )
+         break;
+      _trim_backlog.pop_front();
+      _trim_backlog_accounts.erase( account_id );
    }
 }
 
+account_history_trim_metrics account_history_plugin_impl::get_trim_metrics()
+{
+   graphene::chain::database& db = database();
+   account_history_trim_metrics result;
+   result.backlog_accounts = _trim_backlog.size();
+   for( const account_id_type account_id : _trim_backlog )
+   {
+      const auto& stats_obj = account_id(db).statistics(db);
+      const uint64_t kept = stats_obj.total_ops - stats_obj.removed_ops;
+      const uint64_t max_ops_to_keep = get_max_ops_to_keep( account_id );
+      if( kept > max_ops_to_keep )
+         result.backlog_entries += kept - max_ops_to_keep;
+   }
+   result.trimmed_entries = _trimmed_entries;
+   return result;
+}
+
 } // end namespace detail
 
 
@@ -322,6 +472,12 @@ void account_history_plugin::plugin_set_program_options(
          ("extended-history-by-registrar",
           boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(),
           "Track longer history for accounts with this registrar (may specify multiple times)")
+         ("account-history-trim-batch-size", boost::program_options::value<uint64_t>(),
+          "Remove operations beyond max-ops-per-account in batches of this size per block, and all of them in "
+          "maintenance blocks, instead of with every new operation (default: 0, remove at once)")
+         ("account-history-store", boost::program_options::value<bool>(),
+          "Keep the operations which are removed from memory due to max-ops-per-account in an on-disk store "
+          "in the data directory and serve them through the history API (default: false)")
          ;
    cfg.add(cli);
 }
@@ -347,15 +503,57 @@ void account_history_plugin::plugin_initialize(const boost::program_options::var
                   graphene::chain::account_id_type);
    LOAD_VALUE_SET(options, "extended-history-by-registrar", my->_extended_history_registrars,
                   graphene::chain::account_id_type);
+   if (options.count("account-history-trim-batch-size") > 0) {
+       my->_trim_batch_size = options["account-history-trim-batch-size"].as<uint64_t>();
+   }
+   if (options.count("account-history-store") > 0) {
+       my->_store_removed_history = options["account-history-store"].as<bool>();
+   }
 }
 
 void account_history_plugin::plugin_startup()
 {
 }
 
+void account_history_plugin::plugin_shutdown()
+{
+   if( my->_store.is_open() )
+   {
+      my->_store.flush();
+      my->_store.close();
+   }
+}
+
 flat_set<account_id_type> account_history_plugin::tracked_accounts() const
 {
    return my->_tracked_accounts;
 }
 
+account_history_trim_metrics account_history_plugin::get_trim_metrics()const
+{
+   return my->get_trim_metrics();
+}
+
+bool account_history_plugin::has_account_history_store()const
+{
+   return my->_store_removed_history;
+}
+
+optional<operation_history_object> account_history_plugin::get_stored_operation( account_id_type account,
+                                                                                 uint64_t sequence )const
+{
+   optional<operation_history_object> result;
+   if( !my->_store.is_open() )
+      return result;
+   return my->_store.fetch( account, sequence );
+}
+
+uint64_t account_history_plugin::find_stored_sequence( account_id_type account, uint64_t max_sequence,
+                                                       operation_history_id_type op_id )const
+{
+   if( !my->_store.is_open() )
+      return 0;
+   return my->_store.find_sequence( account, max_sequence, op_id );
+}
+
 } }
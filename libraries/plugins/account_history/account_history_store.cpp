@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/account_history/account_history_store.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <cstring>
+#include <limits>
+
+namespace graphene { namespace account_history {
+
+namespace
+{
+   /// An entry of a page: position and size of the operation, then the instance of its ID
+   constexpr size_t entry_size = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t);
+   /// The header of a page: the account instance and the page number
+   constexpr size_t page_header_size = sizeof(uint64_t) + sizeof(uint64_t);
+   constexpr size_t page_size = page_header_size + account_history_store::page_entries * entry_size;
+   constexpr uint64_t no_page = std::numeric_limits<uint64_t>::max();
+
+   uint64_t file_size( std::fstream& file )
+   {
+      file.seekg( 0, std::ios::end );
+      return static_cast<uint64_t>( file.tellg() );
+   }
+}
+
+void account_history_store::open( const fc::path& dir, bool reset )
+{ try {
+   fc::create_directories( dir );
+   _operations.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   _pages.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   _page_positions.clear();
+
+   const fc::path pages_filename = dir / "pages";
+   const auto mode = std::fstream::binary | std::fstream::in | std::fstream::out;
+   if( reset || !fc::exists( pages_filename ) )
+   {
+      _pages.open( pages_filename.generic_string().c_str(), mode | std::fstream::trunc );
+      _operations.open( (dir/"operations").generic_string().c_str(), mode | std::fstream::trunc );
+      return;
+   }
+
+   _pages.open( pages_filename.generic_string().c_str(), mode );
+   _operations.open( (dir/"operations").generic_string().c_str(), mode );
+
+   const uint64_t size = file_size( _pages );
+   char header[page_header_size];
+   for( uint64_t position = 0; position + page_size <= size; position += page_size )
+   {
+      _pages.seekg( static_cast<std::streamoff>( position ) );
+      _pages.read( header, sizeof(header) );
+      uint64_t account;
+      uint64_t page;
+      std::memcpy( &account, header, sizeof(account) );
+      std::memcpy( &page, header + sizeof(account), sizeof(page) );
+      auto& positions = _page_positions[account];
+      if( positions.size() <= page )
+         positions.resize( page + 1, no_page );
+      positions[page] = position;
+   }
+} FC_CAPTURE_AND_RETHROW( (dir)(reset) ) }
+
+bool account_history_store::is_open()const
+{
+   return _pages.is_open();
+}
+
+void account_history_store::flush()
+{
+   _operations.flush();
+   _pages.flush();
+}
+
+void account_history_store::close()
+{
+   _operations.close();
+   _pages.close();
+   _page_positions.clear();
+}
+
+void account_history_store::store( account_id_type account, uint64_t sequence, const operation_history_object& op )
+{ try {
+   FC_ASSERT( sequence > 0 );
+   const vector<char> data = fc::raw::pack( op );
+   const uint64_t offset = file_size( _operations );
+   _operations.seekp( static_cast<std::streamoff>( offset ) );
+   _operations.write( data.data(), data.size() );
+
+   const uint64_t page = ( sequence - 1 ) / page_entries;
+   auto& positions = _page_positions[account.instance.value];
+   if( positions.size() <= page )
+      positions.resize( page + 1, no_page );
+   if( positions[page] == no_page )
+   {
+      // the entries of a new page are zero-filled, i.e. not stored
+      vector<char> new_page( page_size, 0 );
+      const uint64_t account_instance = account.instance.value;
+      std::memcpy( new_page.data(), &account_instance, sizeof(account_instance) );
+      std::memcpy( new_page.data() + sizeof(account_instance), &page, sizeof(page) );
+      positions[page] = file_size( _pages );
+      _pages.seekp( static_cast<std::streamoff>( positions[page] ) );
+      _pages.write( new_page.data(), new_page.size() );
+   }
+
+   char buffer[entry_size];
+   const uint32_t size = static_cast<uint32_t>( data.size() );
+   const uint64_t op_instance = op.id.instance();
+   std::memcpy( buffer, &offset, sizeof(offset) );
+   std::memcpy( buffer + sizeof(offset), &size, sizeof(size) );
+   std::memcpy( buffer + sizeof(offset) + sizeof(size), &op_instance, sizeof(op_instance) );
+   const uint64_t position = positions[page] + page_header_size + ( ( sequence - 1 ) % page_entries ) * entry_size;
+   _pages.seekp( static_cast<std::streamoff>( position ) );
+   _pages.write( buffer, sizeof(buffer) );
+} FC_CAPTURE_AND_RETHROW( (account)(sequence) ) }
+
+optional<account_history_store::entry> account_history_store::read_entry( account_id_type account,
+                                                                          uint64_t sequence )const
+{
+   optional<entry> result;
+   const auto itr = _page_positions.find( account.instance.value );
+   if( sequence == 0 || itr == _page_positions.end() )
+      return result;
+   const uint64_t page = ( sequence - 1 ) / page_entries;
+   if( itr->second.size() <= page || itr->second[page] == no_page )
+      return result;
+
+   char buffer[entry_size];
+   const uint64_t position = itr->second[page] + page_header_size + ( ( sequence - 1 ) % page_entries ) * entry_size;
+   _pages.seekg( static_cast<std::streamoff>( position ) );
+   _pages.read( buffer, sizeof(buffer) );
+   entry e;
+   std::memcpy( &e.offset, buffer, sizeof(e.offset) );
+   std::memcpy( &e.size, buffer + sizeof(e.offset), sizeof(e.size) );
+   std::memcpy( &e.op_instance, buffer + sizeof(e.offset) + sizeof(e.size), sizeof(e.op_instance) );
+   if( e.size > 0 )
+      result = e;
+   return result;
+}
+
+optional<operation_history_object> account_history_store::fetch( account_id_type account, uint64_t sequence )const
+{ try {
+   optional<operation_history_object> result;
+   const optional<entry> e = read_entry( account, sequence );
+   if( !e.valid() || file_size( _operations ) < e->offset + e->size )
+      return result;
+
+   vector<char> data( e->size );
+   _operations.seekg( static_cast<std::streamoff>( e->offset ) );
+   _operations.read( data.data(), data.size() );
+   result = fc::raw::unpack<operation_history_object>( data );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (account)(sequence) ) }
+
+uint64_t account_history_store::first_sequence( account_id_type account )const
+{
+   const auto itr = _page_positions.find( account.instance.value );
+   if( itr == _page_positions.end() )
+      return 0;
+   // entries are stored in the order of the sequence numbers, the sequence numbers which were removed from memory
+   // before the store was enabled are not stored
+   for( uint64_t page = 0; page < itr->second.size(); ++page )
+   {
+      if( itr->second[page] == no_page )
+         continue;
+      for( uint64_t sequence = page * page_entries + 1; sequence <= ( page + 1 ) * page_entries; ++sequence )
+      {
+         if( read_entry( account, sequence ).valid() )
+            return sequence;
+      }
+   }
+   return 0;
+}
+
+uint64_t account_history_store::find_sequence( account_id_type account, uint64_t max_sequence,
+                                               operation_history_id_type op_id )const
+{ try {
+   const uint64_t first = first_sequence( account );
+   if( first == 0 || first > max_sequence )
+      return 0;
+   // the operation IDs grow with the sequence numbers, search the last one which is not greater than op_id
+   uint64_t low = first;
+   uint64_t high = max_sequence + 1;
+   while( low < high )
+   {
+      const uint64_t mid = low + ( high - low ) / 2;
+      const optional<entry> e = read_entry( account, mid );
+      if( e.valid() && e->op_instance <= op_id.instance.value )
+         low = mid + 1;
+      else
+         high = mid;
+   }
+   return low - 1 >= first ? low - 1 : 0;
+} FC_CAPTURE_AND_RETHROW( (account)(max_sequence)(op_id) ) }
+
+} } //graphene::account_history
@@ -56,6 +56,14 @@ enum account_history_object_type
 };
 
 
+/// The backlog of the deferred trimming of account histories, see the "account-history-trim-batch-size" option
+struct account_history_trim_metrics
+{
+   uint64_t backlog_accounts = 0; ///< accounts which have more operations in memory than they keep
+   uint64_t backlog_entries = 0;  ///< operations of these accounts which wait to be removed
+   uint64_t trimmed_entries = 0;  ///< operations removed by deferred trimming since startup
+};
+
 namespace detail
 {
     class account_history_plugin_impl;
@@ -73,11 +81,28 @@ class account_history_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       void plugin_initialize(const boost::program_options::variables_map& options) override;
       void plugin_startup() override;
+      void plugin_shutdown() override;
 
       flat_set<account_id_type> tracked_accounts()const;
 
+      account_history_trim_metrics get_trim_metrics()const;
+
+      /// @return whether the operations which are removed from memory are kept in the on-disk store
+      bool has_account_history_store()const;
+      /// @return the operation with the given sequence number in the history of the account from the on-disk store,
+      ///         or null if it is not stored. Only sequence numbers up to the number of removed operations of the
+      ///         account are valid, the others are in memory.
+      optional<operation_history_object> get_stored_operation( account_id_type account, uint64_t sequence )const;
+      /// @return the highest sequence number up to @p max_sequence in the on-disk store whose operation ID is not
+      ///         greater than @p op_id, or 0 if there is none
+      uint64_t find_stored_sequence( account_id_type account, uint64_t max_sequence,
+                                     operation_history_id_type op_id )const;
+
    private:
       std::unique_ptr<detail::account_history_plugin_impl> my;
 };
 
 } } //graphene::account_history
+
+FC_REFLECT( graphene::account_history::account_history_trim_metrics,
+            (backlog_accounts)(backlog_entries)(trimmed_entries) )
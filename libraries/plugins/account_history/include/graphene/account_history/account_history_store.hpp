@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fstream>
+#include <unordered_map>
+
+namespace graphene { namespace account_history {
+   using namespace chain;
+
+/**
+ *  @brief An on-disk store of the account history entries which were removed from memory
+ *
+ *  The operations are appended to the "operations" file, serialized with fc::raw. The "pages" file holds the
+ *  sequence numbers of each account in fixed-size pages of @ref page_entries entries, an entry holds the position
+ *  and size of an operation and the instance of its ID. Only the positions of the pages are kept in memory.
+ *
+ *  An entry which is stored again after a chain reorganization overwrites the previous one, the operation which
+ *  was stored for it stays in the operations file unreferenced. Entries are valid for the sequence numbers of the
+ *  account which are not in memory, i.e. up to the number of removed operations of the account.
+ *
+ *  The store is not thread-safe.
+ */
+class account_history_store
+{
+   public:
+      static constexpr uint64_t page_entries = 256;
+
+      /// Opens the store in the given directory, or creates it if it does not exist or @p reset is true
+      void open( const fc::path& dir, bool reset );
+      bool is_open()const;
+      void flush();
+      void close();
+
+      void store( account_id_type account, uint64_t sequence, const operation_history_object& op );
+      /// @return the operation of the entry with the given sequence number, or null if it is not stored
+      optional<operation_history_object> fetch( account_id_type account, uint64_t sequence )const;
+      /// @return the highest sequence number up to @p max_sequence whose operation ID is not greater than
+      ///         @p op_id, or 0 if there is none
+      uint64_t find_sequence( account_id_type account, uint64_t max_sequence, operation_history_id_type op_id )const;
+
+   private:
+      struct entry
+      {
+         uint64_t offset = 0;
+         uint32_t size = 0;
+         uint64_t op_instance = 0;
+      };
+      /// @return the entry of the given sequence number, or null if it is not stored
+      optional<entry> read_entry( account_id_type account, uint64_t sequence )const;
+      /// @return the lowest sequence number of the account which is stored, or 0 if there is none
+      uint64_t first_sequence( account_id_type account )const;
+
+      mutable std::fstream _operations;
+      mutable std::fstream _pages;
+      /// Positions of the pages in the pages file by account instance and page number
+      std::unordered_map< uint64_t, vector<uint64_t> > _page_positions;
+};
+
+} } //graphene::account_history
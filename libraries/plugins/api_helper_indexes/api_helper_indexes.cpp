@@ -23,9 +23,23 @@
  */
 
 #include <graphene/api_helper_indexes/api_helper_indexes.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/credit_offer_object.hpp>
+#include <graphene/chain/htlc_object.hpp>
 #include <graphene/chain/liquidity_pool_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
+#include <graphene/chain/vesting_balance_object.hpp>
+#include <graphene/chain/withdraw_permission_object.hpp>
+
+#include <graphene/db/background_populated_index.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace graphene { namespace api_helper_indexes {
 
@@ -93,6 +107,89 @@ share_type amount_in_collateral_index::get_backing_collateral( const asset_id_ty
    return itr->second;
 } FC_CAPTURE_AND_RETHROW( (asst) ) }
 
+void call_orders_by_collateral_ratio_index::apply( const object& objct, bool add )
+{
+   const call_order_object& o = static_cast<const call_order_object&>( objct );
+   bucket_map& buckets = buckets_by_asset[ o.debt_type() ];
+   const int32_t bucket = get_bucket( o.collateral, o.debt );
+   bucket_totals& totals = buckets[ bucket ];
+   if( add )
+   {
+      ++totals.count;
+      totals.debt += o.debt;
+      totals.collateral += o.collateral;
+      return;
+   }
+   --totals.count;
+   totals.debt -= o.debt;
+   totals.collateral -= o.collateral;
+   if( totals.count == 0 )
+      buckets.erase( bucket );
+   if( buckets.empty() )
+      buckets_by_asset.erase( o.debt_type() );
+}
+
+void call_orders_by_collateral_ratio_index::object_inserted( const object& objct )
+{ try {
+   apply( objct, true );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void call_orders_by_collateral_ratio_index::object_removed( const object& objct )
+{ try {
+   apply( objct, false );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void call_orders_by_collateral_ratio_index::about_to_modify( const object& objct )
+{ try {
+   apply( objct, false );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void call_orders_by_collateral_ratio_index::object_modified( const object& objct )
+{ try {
+   apply( objct, true );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+size_t call_orders_by_collateral_ratio_index::memory_usage()const
+{
+   // a node of a map holds the value, three pointers and the color
+   const size_t node_overhead = 4 * sizeof(void*);
+   size_t result = 0;
+   for( const auto& item : buckets_by_asset )
+      result += sizeof( item ) + node_overhead
+                + item.second.size() * ( sizeof( bucket_map::value_type ) + node_overhead );
+   return result;
+}
+
+int32_t call_orders_by_collateral_ratio_index::get_bucket( share_type collateral, share_type debt )
+{
+   if( debt <= 0 )
+      return std::numeric_limits<int32_t>::max();
+   if( collateral <= 0 )
+      return std::numeric_limits<int32_t>::min();
+   // Amounts are below 2^53, so converting them is exact, and the rounded ratio never sorts differently from the
+   // exact one. The mantissa is in [0.5, 1), each half of it is split evenly.
+   int exponent = 0;
+   const double mantissa = std::frexp( double( collateral.value ) / double( debt.value ), &exponent );
+   return exponent * buckets_per_octave + static_cast<int32_t>( ( mantissa - 0.5 ) * 2 * buckets_per_octave );
+}
+
+call_orders_by_collateral_ratio_index::bucket_totals call_orders_by_collateral_ratio_index::get_totals_below(
+            const asset_id_type& debt_asset, int32_t bucket )const
+{
+   bucket_totals result;
+   auto asset_itr = buckets_by_asset.find( debt_asset );
+   if( asset_itr == buckets_by_asset.end() )
+      return result;
+   const bucket_map& buckets = asset_itr->second;
+   for( auto itr = buckets.begin(); itr != buckets.end() && itr->first < bucket; ++itr )
+   {
+      result.count += itr->second.count;
+      result.debt += itr->second.debt;
+      result.collateral += itr->second.collateral;
+   }
+   return result;
+}
+
 void asset_in_liquidity_pools_index::object_inserted( const object& objct )
 { try {
    const auto& o = static_cast<const liquidity_pool_object&>( objct );
@@ -127,6 +224,358 @@ const flat_set<liquidity_pool_id_type>& asset_in_liquidity_pools_index::get_liqu
    return empty_set;
 }
 
+vector<credit_offers_by_collateral_index::offer_key> credit_offers_by_collateral_index::get_keys(
+            const object& objct )
+{
+   const auto& o = static_cast<const credit_offer_object&>( objct );
+   vector<offer_key> result;
+   if( !o.enabled )
+      return result;
+   result.reserve( o.acceptable_collateral.size() );
+   for( const auto& collateral : o.acceptable_collateral )
+      result.emplace_back( o.asset_type, collateral.first, o.fee_rate, -o.current_balance,
+                           credit_offer_id_type( o.id ) );
+   return result;
+}
+
+void credit_offers_by_collateral_index::object_inserted( const object& objct )
+{ try {
+   for( const auto& key : get_keys( objct ) )
+      offers.insert( key );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void credit_offers_by_collateral_index::object_removed( const object& objct )
+{ try {
+   for( const auto& key : get_keys( objct ) )
+      offers.erase( key );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void credit_offers_by_collateral_index::about_to_modify( const object& objct )
+{ try {
+   keys_being_modified.push( get_keys( objct ) );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void credit_offers_by_collateral_index::object_modified( const object& objct )
+{ try {
+   for( const auto& key : keys_being_modified.top() )
+      offers.erase( key );
+   keys_being_modified.pop();
+   object_inserted( objct );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+size_t credit_offers_by_collateral_index::memory_usage()const
+{
+   // a node of a set holds the value, three pointers and the color
+   const size_t node_size = sizeof( offer_set::value_type ) + 4 * sizeof(void*);
+   return offers.size() * node_size;
+}
+
+void asset_holders_index::object_inserted( const object& objct )
+{ try {
+   const account_balance_object& o = static_cast<const account_balance_object&>( objct );
+   if( o.balance != 0 )
+      holders.insert( holder{ o.asset_type, o.balance, o.owner } );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void asset_holders_index::object_removed( const object& objct )
+{ try {
+   const account_balance_object& o = static_cast<const account_balance_object&>( objct );
+   if( o.balance != 0 )
+      holders.erase( boost::make_tuple( o.asset_type, o.balance, o.owner ) );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void asset_holders_index::about_to_modify( const object& objct )
+{ try {
+   const account_balance_object& o = static_cast<const account_balance_object&>( objct );
+   holders_being_modified.push( holder{ o.asset_type, o.balance, o.owner } );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void asset_holders_index::object_modified( const object& objct )
+{ try {
+   const holder& before = holders_being_modified.top();
+   if( before.balance != 0 )
+      holders.erase( boost::make_tuple( before.asset_type, before.balance, before.owner ) );
+   holders_being_modified.pop();
+   object_inserted( objct );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+size_t asset_holders_index::memory_usage()const
+{
+   // a node of a ranked index holds the value, three pointers, the color and the size of its subtree
+   const size_t node_size = sizeof( holder ) + 5 * sizeof(void*);
+   return holders.size() * node_size;
+}
+
+uint64_t asset_holders_index::get_holders_count( const asset_id_type& asset )const
+{
+   return holders.rank( holders.upper_bound( boost::make_tuple( asset ) ) )
+          - holders.rank( holders.lower_bound( boost::make_tuple( asset ) ) );
+}
+
+vector<asset_holders_index::holder> asset_holders_index::get_holders( const asset_id_type& asset, uint64_t start,
+                                                                      uint32_t limit )const
+{
+   vector<holder> result;
+   if( start >= get_holders_count( asset ) )
+      return result;
+   auto itr = holders.nth( holders.rank( holders.lower_bound( boost::make_tuple( asset ) ) ) + start );
+   for( ; itr != holders.end() && itr->asset_type == asset && result.size() < limit; ++itr )
+      result.push_back( *itr );
+   return result;
+}
+
+void order_book_versions_index::on_order_changed( const object& objct, int32_t count_delta )
+{
+   const limit_order_object& o = static_cast<const limit_order_object&>( objct );
+   const auto market = o.get_market();
+   auto itr = markets.find( market );
+   if( itr == markets.end() )
+      itr = markets.emplace( market, market_data() ).first;
+   itr->second.version = ++last_version;
+   itr->second.order_count += count_delta;
+   if( 0 == itr->second.order_count )
+      markets.erase( itr );
+}
+
+void order_book_versions_index::object_inserted( const object& objct )
+{ try {
+   on_order_changed( objct, 1 );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void order_book_versions_index::object_removed( const object& objct )
+{ try {
+   on_order_changed( objct, -1 );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void order_book_versions_index::object_modified( const object& objct )
+{ try {
+   // the market of an order never changes
+   on_order_changed( objct, 0 );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+size_t order_book_versions_index::memory_usage()const
+{
+   // a node of a map holds the value, three pointers and the color
+   const size_t node_size = sizeof( decltype(markets)::value_type ) + 4 * sizeof(void*);
+   return markets.size() * node_size;
+}
+
+uint64_t order_book_versions_index::get_version( asset_id_type a, asset_id_type b )const
+{
+   if( a > b )
+      std::swap( a, b );
+   auto itr = markets.find( std::make_pair( a, b ) );
+   return itr == markets.end() ? 0 : itr->second.version;
+}
+
+const string& name_trigram_index::get_name( const object& obj )
+{
+   if( obj.id.type() == asset_id_type::type_id )
+      return static_cast<const asset_object&>( obj ).symbol;
+   return static_cast<const account_object&>( obj ).name;
+}
+
+flat_set<uint32_t> name_trigram_index::get_trigrams( const string& name )
+{
+   flat_set<uint32_t> result;
+   for( size_t i = 0; i + min_search_length <= name.size(); ++i )
+      result.insert( ( uint32_t( uint8_t( name[i] ) ) << 16 ) | ( uint32_t( uint8_t( name[i+1] ) ) << 8 )
+                     | uint8_t( name[i+2] ) );
+   return result;
+}
+
+void name_trigram_index::object_inserted( const object& objct )
+{ try {
+   for( uint32_t trigram : get_trigrams( get_name( objct ) ) )
+      objects_by_trigram[trigram].insert( objct.id.instance() );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void name_trigram_index::object_removed( const object& objct )
+{ try {
+   for( uint32_t trigram : get_trigrams( get_name( objct ) ) )
+   {
+      auto itr = objects_by_trigram.find( trigram );
+      if( itr == objects_by_trigram.end() )
+         continue;
+      itr->second.erase( objct.id.instance() );
+      if( itr->second.empty() )
+         objects_by_trigram.erase( itr );
+   }
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+size_t name_trigram_index::memory_usage()const
+{
+   // a node of an unordered map holds the value, the next pointer and the hash, plus a bucket pointer
+   size_t result = objects_by_trigram.size() * ( sizeof( decltype(objects_by_trigram)::value_type )
+                                                 + 3 * sizeof(void*) );
+   for( const auto& item : objects_by_trigram )
+      result += item.second.capacity() * sizeof( uint64_t );
+   return result;
+}
+
+vector<uint64_t> name_trigram_index::find( const string& text, uint32_t limit,
+                                           const std::function<const string&(uint64_t)>& get_name )const
+{
+   vector<uint64_t> result;
+   if( text.size() < min_search_length || 0 == limit )
+      return result;
+
+   vector< const flat_set<uint64_t>* > candidates;
+   for( uint32_t trigram : get_trigrams( text ) )
+   {
+      auto itr = objects_by_trigram.find( trigram );
+      if( itr == objects_by_trigram.end() )
+         return result;
+      candidates.push_back( &itr->second );
+   }
+   std::sort( candidates.begin(), candidates.end(), []( const flat_set<uint64_t>* a, const flat_set<uint64_t>* b ) {
+      return a->size() < b->size();
+   } );
+
+   // every trigram of the text is in the name, but maybe not in the same order
+   for( uint64_t instance : *candidates.front() )
+   {
+      bool has_all = std::all_of( candidates.begin() + 1, candidates.end(), [instance]( const flat_set<uint64_t>* c ) {
+         return c->find( instance ) != c->end();
+      } );
+      if( has_all && get_name( instance ).find( text ) != string::npos )
+      {
+         result.push_back( instance );
+         if( result.size() >= limit )
+            break;
+      }
+   }
+   return result;
+}
+
+void vesting_balances_by_owner_index::object_inserted( const object& objct )
+{ try {
+   const auto& o = static_cast<const vesting_balance_object&>( objct );
+   auto& data = owners[ o.owner ]; // Note: [] operator will create an entry if not found
+   data.balances.insert( o.id );
+   if( o.balance.amount != 0 )
+      data.totals[ o.balance.asset_id ] += o.balance.amount;
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void vesting_balances_by_owner_index::object_removed( const object& objct )
+{ try {
+   const auto& o = static_cast<const vesting_balance_object&>( objct );
+   auto itr = owners.find( o.owner );
+   if( itr == owners.end() ) // should not happen
+      return;
+   itr->second.balances.erase( o.id );
+   auto total_itr = itr->second.totals.find( o.balance.asset_id );
+   if( total_itr != itr->second.totals.end() )
+   {
+      total_itr->second -= o.balance.amount;
+      if( total_itr->second == 0 )
+         itr->second.totals.erase( total_itr );
+   }
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void vesting_balances_by_owner_index::about_to_modify( const object& objct )
+{ try {
+   object_removed( objct );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void vesting_balances_by_owner_index::object_modified( const object& objct )
+{ try {
+   object_inserted( objct );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+size_t vesting_balances_by_owner_index::memory_usage()const
+{
+   // a node of a map holds the value, three pointers and the color
+   size_t result = owners.size() * ( sizeof( decltype(owners)::value_type ) + 4 * sizeof(void*) );
+   for( const auto& item : owners )
+      result += item.second.balances.capacity() * sizeof( vesting_balance_id_type )
+                + item.second.totals.capacity() * sizeof( std::pair<asset_id_type, share_type> );
+   return result;
+}
+
+const flat_set<vesting_balance_id_type>& vesting_balances_by_owner_index::get_vesting_balances(
+            const account_id_type& owner )const
+{
+   auto itr = owners.find( owner );
+   return itr != owners.end() ? itr->second.balances : empty_data.balances;
+}
+
+const flat_map<asset_id_type, share_type>& vesting_balances_by_owner_index::get_totals(
+            const account_id_type& owner )const
+{
+   auto itr = owners.find( owner );
+   return itr != owners.end() ? itr->second.totals : empty_data.totals;
+}
+
+vector<expirations_by_account_index::expiration_key> expirations_by_account_index::get_keys( const object& objct )
+{
+   vector<expiration_key> result;
+   account_id_type first;
+   account_id_type second;
+   time_point_sec expiration;
+   if( objct.id.type() == htlc_id_type::type_id )
+   {
+      const auto& o = static_cast<const htlc_object&>( objct );
+      first = o.transfer.from;
+      second = o.transfer.to;
+      expiration = o.conditions.time_lock.expiration;
+   }
+   else
+   {
+      const auto& o = static_cast<const withdraw_permission_object&>( objct );
+      first = o.withdraw_from_account;
+      second = o.authorized_account;
+      expiration = o.expiration;
+   }
+   result.emplace_back( first, expiration, objct.id );
+   if( second != first )
+      result.emplace_back( second, expiration, objct.id );
+   return result;
+}
+
+void expirations_by_account_index::object_inserted( const object& objct )
+{ try {
+   for( const auto& key : get_keys( objct ) )
+      expirations.insert( key );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void expirations_by_account_index::object_removed( const object& objct )
+{ try {
+   for( const auto& key : get_keys( objct ) )
+      expirations.erase( key );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void expirations_by_account_index::about_to_modify( const object& objct )
+{ try {
+   keys_being_modified.push( get_keys( objct ) );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+void expirations_by_account_index::object_modified( const object& objct )
+{ try {
+   // the expiration of a HTLC is extended by htlc_extend
+   for( const auto& key : keys_being_modified.top() )
+      expirations.erase( key );
+   keys_being_modified.pop();
+   object_inserted( objct );
+} FC_CAPTURE_AND_RETHROW( (objct) ) }
+
+size_t expirations_by_account_index::memory_usage()const
+{
+   // a node of a set holds the value, three pointers and the color
+   const size_t node_size = sizeof( expiration_set::value_type ) + 4 * sizeof(void*);
+   return expirations.size() * node_size;
+}
+
+vector<object_id_type> expirations_by_account_index::find( const account_id_type& account, time_point_sec start,
+                                                           uint32_t limit )const
+{
+   vector<object_id_type> result;
+   auto itr = expirations.lower_bound( std::make_tuple( account, start, object_id_type() ) );
+   for( ; itr != expirations.end() && std::get<0>( *itr ) == account && result.size() < limit; ++itr )
+      result.push_back( std::get<2>( *itr ) );
+   return result;
+}
+
 namespace detail
 {
 
@@ -142,6 +591,56 @@ class api_helper_indexes_impl
          return _self.database();
       }
 
+      /**
+       * Adds a secondary index to the primary index of @p IndexType and fills it with the existing objects,
+       * right away or later in @ref populate_in_background
+       */
+      template<typename SecondaryIndexType, typename IndexType, typename PrimaryIndexType = primary_index<IndexType>>
+      SecondaryIndexType* add_helper_index()
+      {
+         const IndexType& objects = database().get_index_type<IndexType>();
+         if( !_background_population )
+         {
+            auto* result = database().add_secondary_index< PrimaryIndexType, SecondaryIndexType >();
+            for( const auto& obj : objects.indices() )
+               result->object_inserted( obj );
+            return result;
+         }
+         using populated_index_type = graphene::db::background_populated_index< IndexType, SecondaryIndexType >;
+         auto* result = database().add_secondary_index< PrimaryIndexType, populated_index_type >( &objects );
+         _pending_population.emplace_back( [result]( size_t max_objects ) {
+            return result->populate( max_objects );
+         } );
+         return result;
+      }
+
+      /// Fills the indexes added with background population a step at a time, yielding to other tasks in between
+      void populate_in_background()
+      {
+         for( const auto& populate : _pending_population )
+         {
+            bool done = false;
+            while( !done )
+            {
+               fc::yield();
+               // a batch may only be open while a block is applied, this is just to be safe
+               if( !database().in_secondary_index_batch() )
+                  database().with_state_write_lock( [&populate,&done]() {
+                     done = populate( population_step_size );
+                  } );
+            }
+         }
+         _pending_population.clear();
+         ilog( "api_helper_indexes: all indexes are populated" );
+      }
+
+      /// The number of objects added to an index before yielding to other tasks
+      static constexpr size_t population_step_size = 10000;
+
+      bool _background_population = false;
+      std::vector< std::function<bool(size_t)> > _pending_population;
+      fc::future<void> _population_task;
+
    private:
       api_helper_indexes& _self;
 };
@@ -171,33 +670,60 @@ void api_helper_indexes::plugin_set_program_options(
    boost::program_options::options_description& cfg
    )
 {
+   cli.add_options()
+         ("api-helper-indexes-background-population", boost::program_options::bool_switch()->default_value(false),
+          "Fill the helper indexes in the background after startup instead of before the node starts. "
+          "The API calls which need an index report that it is warming up until it is complete.")
+         ;
+   cfg.add(cli);
 }
 
 void api_helper_indexes::plugin_initialize(const boost::program_options::variables_map& options)
 {
+   if( options.count( "api-helper-indexes-background-population" ) > 0 )
+      my->_background_population = options["api-helper-indexes-background-population"].as<bool>();
 }
 
 void api_helper_indexes::plugin_startup()
 {
    ilog("api_helper_indexes: plugin_startup() begin");
-   amount_in_collateral_idx = database().add_secondary_index< primary_index<call_order_index>,
-                                                              amount_in_collateral_index >();
-   for( const auto& call : database().get_index_type<call_order_index>().indices() )
-      amount_in_collateral_idx->object_inserted( call );
-
-   auto& account_members = *database().add_secondary_index< primary_index<account_index>, account_member_index >();
-   for( const auto& account : database().get_index_type< account_index >().indices() )
-      account_members.object_inserted( account );
-
-   auto& approvals = *database().add_secondary_index< primary_index<proposal_index>, required_approval_index >();
-   for( const auto& proposal : database().get_index_type< proposal_index >().indices() )
-      approvals.object_inserted( proposal );
-
-   asset_in_liquidity_pools_idx = database().add_secondary_index< primary_index<liquidity_pool_index>,
-                                                        asset_in_liquidity_pools_index >();
-   for( const auto& pool : database().get_index_type<liquidity_pool_index>().indices() )
-      asset_in_liquidity_pools_idx->object_inserted( pool );
+   amount_in_collateral_idx = my->add_helper_index< amount_in_collateral_index, call_order_index >();
+   call_orders_by_collateral_ratio_idx = my->add_helper_index< call_orders_by_collateral_ratio_index,
+                                                               call_order_index >();
+   my->add_helper_index< account_member_index, account_index >();
+   my->add_helper_index< required_approval_index, proposal_index >();
+   asset_in_liquidity_pools_idx = my->add_helper_index< asset_in_liquidity_pools_index, liquidity_pool_index,
+                                        primary_index<liquidity_pool_index, 10, flat_direct_index> >();
+   credit_offers_by_collateral_idx = my->add_helper_index< credit_offers_by_collateral_index, credit_offer_index >();
+   asset_holders_idx = my->add_helper_index< asset_holders_index, account_balance_index >();
+   order_book_versions_idx = my->add_helper_index< order_book_versions_index, limit_order_index >();
+   account_name_trigrams_idx = my->add_helper_index< name_trigram_index, account_index,
+                                                     primary_index<account_index, 20> >();
+   asset_symbol_trigrams_idx = my->add_helper_index< name_trigram_index, asset_index,
+                                                     primary_index<asset_index, 13> >();
+   vesting_balances_by_owner_idx = my->add_helper_index< vesting_balances_by_owner_index, vesting_balance_index >();
+   htlc_expirations_idx = my->add_helper_index< expirations_by_account_index, htlc_index >();
+   withdraw_permission_expirations_idx = my->add_helper_index< expirations_by_account_index,
+                                                               withdraw_permission_index >();
+
+   if( !my->_pending_population.empty() )
+   {
+      ilog("api_helper_indexes: populating the indexes in the background");
+      my->_population_task = fc::async( [this]() { my->populate_in_background(); },
+                                        "api_helper_indexes population" );
+   }
+}
 
+void api_helper_indexes::plugin_shutdown()
+{
+   try {
+      if( my->_population_task.valid() && !my->_population_task.ready() )
+         my->_population_task.cancel_and_wait( __FUNCTION__ );
+   } catch( const fc::canceled_exception& ) {
+      // Expected exception. Move along.
+   } catch( const fc::exception& e ) {
+      edump( (e.to_detail_string()) );
+   }
 }
 
 } }
@@ -26,6 +26,18 @@
 #include <graphene/app/plugin.hpp>
 #include <graphene/protocol/types.hpp>
 
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ranked_index.hpp>
+#include <boost/multi_index_container.hpp>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <stack>
+#include <tuple>
+#include <unordered_map>
+
 namespace graphene { namespace api_helper_indexes {
 using namespace chain;
 
@@ -42,6 +54,7 @@ class amount_in_collateral_index : public secondary_index
       void object_removed( const object& obj ) override;
       void about_to_modify( const object& before ) override;
       void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
 
       share_type get_amount_in_collateral( const asset_id_type& asset )const;
       share_type get_backing_collateral( const asset_id_type& asset )const;
@@ -51,6 +64,48 @@ class amount_in_collateral_index : public secondary_index
       flat_map<asset_id_type, share_type> backing_collateral;
 };
 
+/**
+ *  @brief This secondary index buckets the call orders of each MPA by collateral ratio, and keeps the number of
+ *         positions and their total debt and collateral per bucket.
+ *
+ *  A bucket spans 1/16 of a binary order of magnitude of the collateral per debt in satoshis, i.e. about 4.4%. The
+ *  totals of the positions below a collateral ratio are the sums of the buckets below the one of the ratio, plus
+ *  the positions in that bucket, which are found through the by_collateral index of the call orders. The positions
+ *  of an MPA spread over few buckets, so only the positions close to the ratio are walked.
+ */
+class call_orders_by_collateral_ratio_index : public secondary_index
+{
+   public:
+      static constexpr int32_t buckets_per_octave = 16;
+
+      struct bucket_totals
+      {
+         uint32_t   count = 0;
+         share_type debt;
+         share_type collateral;
+      };
+      using bucket_map = std::map< int32_t, bucket_totals >;
+
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+      void about_to_modify( const object& before ) override;
+      void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
+
+      size_t memory_usage()const override;
+
+      /// @return the bucket of the positions with the given amounts of collateral per debt, the buckets of lower
+      ///         collateral ratios come first
+      static int32_t get_bucket( share_type collateral, share_type debt );
+      /// @return the sums of the buckets of the MPA which come before @p bucket
+      bucket_totals get_totals_below( const asset_id_type& debt_asset, int32_t bucket )const;
+
+   private:
+      void apply( const object& obj, bool add );
+
+      std::map< asset_id_type, bucket_map > buckets_by_asset;
+};
+
 /**
  *  @brief This secondary index maintains a map to make it easier to find liquidity pools by any asset in the pool.
  *  @note This is implemented with \c flat_map and \c flat_set considering there aren't too many liquidity pools
@@ -63,6 +118,7 @@ class asset_in_liquidity_pools_index: public secondary_index
       void object_removed( const object& obj ) override;
       void about_to_modify( const object& before ) override;
       void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
 
       const flat_set<liquidity_pool_id_type>& get_liquidity_pools_by_asset( const asset_id_type& a )const;
 
@@ -71,6 +127,220 @@ class asset_in_liquidity_pools_index: public secondary_index
       flat_map<asset_id_type, flat_set<liquidity_pool_id_type>> asset_in_pools_map;
 };
 
+/**
+ *  @brief This secondary index tracks the enabled credit offers by asset type and acceptable collateral asset.
+ *
+ *  For each pair of assets the offers are sorted by fee rate, then by current balance in descending order, so that
+ *  the best offers for a borrower come first.
+ */
+class credit_offers_by_collateral_index : public secondary_index
+{
+   public:
+      /// asset type, collateral asset, fee rate, negated current balance, offer ID
+      using offer_key = std::tuple< asset_id_type, asset_id_type, uint32_t, share_type, credit_offer_id_type >;
+      using offer_set = std::set< offer_key >;
+
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+      void about_to_modify( const object& before ) override;
+      void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
+
+      size_t memory_usage()const override;
+
+      /// @return the offers, sorted by asset type, collateral asset, fee rate and current balance in descending order
+      const offer_set& get_offers()const { return offers; }
+
+   private:
+      static vector<offer_key> get_keys( const object& obj );
+
+      offer_set offers;
+      std::stack< vector<offer_key> > keys_being_modified;
+};
+
+/**
+ *  @brief This secondary index ranks the holders of each asset by balance.
+ *
+ *  Only non-zero balances are tracked. They are sorted by asset type, then by balance in descending order, then by
+ *  owner, like the by_asset_balance index of the balances. The index is ranked, so that the number of holders of an
+ *  asset and the holder at a given position are found in logarithmic time instead of by walking the balances.
+ */
+class asset_holders_index : public secondary_index
+{
+   public:
+      struct holder
+      {
+         asset_id_type   asset_type;
+         share_type      balance;
+         account_id_type owner;
+      };
+      using holder_set = boost::multi_index_container< holder,
+         boost::multi_index::indexed_by<
+            boost::multi_index::ranked_unique<
+               boost::multi_index::composite_key< holder,
+                  boost::multi_index::member< holder, asset_id_type, &holder::asset_type >,
+                  boost::multi_index::member< holder, share_type, &holder::balance >,
+                  boost::multi_index::member< holder, account_id_type, &holder::owner >
+               >,
+               boost::multi_index::composite_key_compare<
+                  std::less< asset_id_type >,
+                  std::greater< share_type >,
+                  std::less< account_id_type >
+               >
+            >
+         >
+      >;
+
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+      void about_to_modify( const object& before ) override;
+      void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
+
+      size_t memory_usage()const override;
+
+      /// @return the number of accounts with a non-zero balance of the asset
+      uint64_t get_holders_count( const asset_id_type& asset )const;
+      /// @return up to @p limit holders of the asset, starting with the one at position @p start
+      vector<holder> get_holders( const asset_id_type& asset, uint64_t start, uint32_t limit )const;
+
+   private:
+      holder_set holders;
+      std::stack< holder > holders_being_modified;
+};
+
+/**
+ *  @brief This secondary index numbers the changes of the limit orders of each market.
+ *
+ *  Every change of an order gives its market a new version number, so that a result computed from the orders of a
+ *  market, e.g. its order book, can be reused as long as the version of the market is the same. Markets without
+ *  orders have version 0 and are not stored.
+ */
+class order_book_versions_index : public secondary_index
+{
+   public:
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+      void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
+
+      size_t memory_usage()const override;
+
+      /// @return the version of the market of the two assets, in any order
+      uint64_t get_version( asset_id_type a, asset_id_type b )const;
+
+   private:
+      struct market_data
+      {
+         uint64_t version     = 0;
+         uint32_t order_count = 0;
+      };
+
+      void on_order_changed( const object& obj, int32_t count_delta );
+
+      std::map< std::pair< asset_id_type, asset_id_type >, market_data > markets;
+      /// the last version given to a market, it keeps growing when changes are undone
+      uint64_t last_version = 0;
+};
+
+/**
+ *  @brief This secondary index maps the trigrams, i.e. the substrings of 3 characters, of the names of accounts or
+ *         of the symbols of assets to the objects whose names contain them.
+ *
+ *  It finds the objects whose names contain a string of at least 3 characters without walking all names. Names and
+ *  symbols never change, so only created and removed objects are tracked.
+ */
+class name_trigram_index : public secondary_index
+{
+   public:
+      static constexpr size_t min_search_length = 3;
+
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+      bool is_deferrable()const override { return true; }
+
+      size_t memory_usage()const override;
+
+      /**
+       *  @param text the string to search for, at least @ref min_search_length characters
+       *  @param limit the maximum number of objects to return
+       *  @param get_name returns the name of the object with the given instance
+       *  @return the instances of the oldest objects whose names contain @p text, in ascending order
+       */
+      vector<uint64_t> find( const string& text, uint32_t limit,
+                             const std::function<const string&(uint64_t)>& get_name )const;
+
+   private:
+      static const string& get_name( const object& obj );
+      static flat_set<uint32_t> get_trigrams( const string& name );
+
+      std::unordered_map< uint32_t, flat_set<uint64_t> > objects_by_trigram;
+};
+
+/**
+ *  @brief This secondary index tracks the vesting balances of each account sorted by ID, and their total amounts
+ *         by asset.
+ *  @note Entries of an account are not erased when it has no more vesting balances, in order to avoid read/write
+ *        race conditions.
+ */
+class vesting_balances_by_owner_index : public secondary_index
+{
+   public:
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+      void about_to_modify( const object& before ) override;
+      void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
+
+      size_t memory_usage()const override;
+
+      const flat_set<vesting_balance_id_type>& get_vesting_balances( const account_id_type& owner )const;
+      /// @return the total amount of the vesting balances of the account by asset, assets without any are omitted
+      const flat_map<asset_id_type, share_type>& get_totals( const account_id_type& owner )const;
+
+   private:
+      struct owner_data
+      {
+         flat_set<vesting_balance_id_type>   balances;
+         flat_map<asset_id_type, share_type> totals;
+      };
+
+      owner_data empty_data;
+      std::map< account_id_type, owner_data > owners;
+};
+
+/**
+ *  @brief This secondary index sorts the HTLCs or the withdraw permissions of each account by expiration.
+ *
+ *  An object is tracked for both of its accounts, i.e. the sender and the receiver of a HTLC, or the account to
+ *  withdraw from and the authorized account of a withdraw permission.
+ */
+class expirations_by_account_index : public secondary_index
+{
+   public:
+      /// account, expiration, object ID
+      using expiration_key = std::tuple< account_id_type, time_point_sec, object_id_type >;
+      using expiration_set = std::set< expiration_key >;
+
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+      void about_to_modify( const object& before ) override;
+      void object_modified( const object& after ) override;
+      bool is_deferrable()const override { return true; }
+
+      size_t memory_usage()const override;
+
+      /// @return the IDs of up to @p limit objects of the account which expire at or after @p start, the first
+      ///         to expire first
+      vector<object_id_type> find( const account_id_type& account, time_point_sec start, uint32_t limit )const;
+
+   private:
+      static vector<expiration_key> get_keys( const object& obj );
+
+      expiration_set expirations;
+      std::stack< vector<expiration_key> > keys_being_modified;
+};
+
 namespace detail
 {
     class api_helper_indexes_impl;
@@ -89,13 +359,23 @@ class api_helper_indexes : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       void plugin_initialize(const boost::program_options::variables_map& options) override;
       void plugin_startup() override;
+      void plugin_shutdown() override;
 
       friend class detail::api_helper_indexes_impl;
 
    private:
       std::unique_ptr<detail::api_helper_indexes_impl> my;
       amount_in_collateral_index* amount_in_collateral_idx = nullptr;
+      call_orders_by_collateral_ratio_index* call_orders_by_collateral_ratio_idx = nullptr;
       asset_in_liquidity_pools_index* asset_in_liquidity_pools_idx = nullptr;
+      credit_offers_by_collateral_index* credit_offers_by_collateral_idx = nullptr;
+      asset_holders_index* asset_holders_idx = nullptr;
+      order_book_versions_index* order_book_versions_idx = nullptr;
+      name_trigram_index* account_name_trigrams_idx = nullptr;
+      name_trigram_index* asset_symbol_trigrams_idx = nullptr;
+      vesting_balances_by_owner_index* vesting_balances_by_owner_idx = nullptr;
+      expirations_by_account_index* htlc_expirations_idx = nullptr;
+      expirations_by_account_index* withdraw_permission_expirations_idx = nullptr;
 };
 
 } } //graphene::template
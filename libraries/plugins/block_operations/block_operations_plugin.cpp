@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/block_operations/block_operations_plugin.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <cstring>
+
+namespace graphene { namespace block_operations {
+
+namespace
+{
+   /// An entry of the index file: position and size of the operations, then the ID of the block
+   constexpr size_t index_entry_size = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(block_id_type);
+
+   uint64_t file_size( std::fstream& file )
+   {
+      file.seekg( 0, std::ios::end );
+      return static_cast<uint64_t>( file.tellg() );
+   }
+}
+
+void block_operations_store::open( const fc::path& dir )
+{ try {
+   fc::create_directories( dir );
+   _operations.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   _index.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+
+   const fc::path index_filename = dir / "index";
+   const auto mode = std::fstream::binary | std::fstream::in | std::fstream::out;
+   if( !fc::exists( index_filename ) )
+   {
+      _index.open( index_filename.generic_string().c_str(), mode | std::fstream::trunc );
+      _operations.open( (dir/"operations").generic_string().c_str(), mode | std::fstream::trunc );
+   }
+   else
+   {
+      _index.open( index_filename.generic_string().c_str(), mode );
+      _operations.open( (dir/"operations").generic_string().c_str(), mode );
+   }
+} FC_CAPTURE_AND_RETHROW( (dir) ) }
+
+bool block_operations_store::is_open()const
+{
+   return _index.is_open();
+}
+
+void block_operations_store::flush()
+{
+   _operations.flush();
+   _index.flush();
+}
+
+void block_operations_store::close()
+{
+   _operations.close();
+   _index.close();
+}
+
+void block_operations_store::store( uint32_t block_num, const block_id_type& block_id,
+                                    const vector<operation_history_object>& ops )
+{ try {
+   FC_ASSERT( block_num > 0 );
+   const vector<char> data = fc::raw::pack( ops );
+   const uint64_t offset = file_size( _operations );
+   _operations.seekp( static_cast<std::streamoff>( offset ) );
+   _operations.write( data.data(), data.size() );
+
+   char entry[index_entry_size];
+   const uint32_t size = static_cast<uint32_t>( data.size() );
+   std::memcpy( entry, &offset, sizeof(offset) );
+   std::memcpy( entry + sizeof(offset), &size, sizeof(size) );
+   std::memcpy( entry + sizeof(offset) + sizeof(size), block_id.data(), sizeof(block_id_type) );
+
+   // blocks which were not stored, e.g. before the plugin was enabled, have empty entries
+   const uint64_t position = uint64_t( block_num - 1 ) * index_entry_size;
+   const uint64_t index_size = file_size( _index );
+   if( index_size < position )
+   {
+      const vector<char> gap( position - index_size, 0 );
+      _index.seekp( static_cast<std::streamoff>( index_size ) );
+      _index.write( gap.data(), gap.size() );
+   }
+   _index.seekp( static_cast<std::streamoff>( position ) );
+   _index.write( entry, sizeof(entry) );
+} FC_CAPTURE_AND_RETHROW( (block_num)(block_id) ) }
+
+optional< vector<operation_history_object> > block_operations_store::fetch( uint32_t block_num,
+                                                                           const block_id_type& block_id )const
+{ try {
+   optional< vector<operation_history_object> > result;
+   const uint64_t position = uint64_t( block_num - 1 ) * index_entry_size;
+   if( block_num == 0 || file_size( _index ) < position + index_entry_size )
+      return result;
+
+   char entry[index_entry_size];
+   _index.seekg( static_cast<std::streamoff>( position ) );
+   _index.read( entry, sizeof(entry) );
+   uint64_t offset;
+   uint32_t size;
+   block_id_type stored_id;
+   std::memcpy( &offset, entry, sizeof(offset) );
+   std::memcpy( &size, entry + sizeof(offset), sizeof(size) );
+   std::memcpy( stored_id.data(), entry + sizeof(offset) + sizeof(size), sizeof(block_id_type) );
+   if( stored_id != block_id || size == 0 || file_size( _operations ) < offset + size )
+      return result;
+
+   vector<char> data( size );
+   _operations.seekg( static_cast<std::streamoff>( offset ) );
+   _operations.read( data.data(), data.size() );
+   result = fc::raw::unpack< vector<operation_history_object> >( data );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (block_num)(block_id) ) }
+
+namespace detail
+{
+
+class block_operations_plugin_impl
+{
+   public:
+      explicit block_operations_plugin_impl( block_operations_plugin& _plugin )
+      : _self( _plugin ) {}
+
+      void on_block( const signed_block& b );
+
+      graphene::chain::database& database()
+      {
+         return _self.database();
+      }
+
+      block_operations_plugin& _self;
+      block_operations_store   _store;
+};
+
+void block_operations_plugin_impl::on_block( const signed_block& b )
+{
+   // the data directory of the database is only known once it is open, which is before the first block is applied
+   if( !_store.is_open() )
+      _store.open( database().get_data_dir() / "block_operations" );
+
+   vector<operation_history_object> ops;
+   for( const optional< operation_history_object >& o_op : database().get_applied_operations() )
+   {
+      if( o_op.valid() )
+         ops.push_back( *o_op );
+   }
+   _store.store( b.block_num(), b.id(), ops );
+}
+
+} // end namespace detail
+
+block_operations_plugin::block_operations_plugin(graphene::app::application& app) :
+   plugin(app),
+   my( std::make_unique<detail::block_operations_plugin_impl>(*this) )
+{
+   // Nothing else to do
+}
+
+block_operations_plugin::~block_operations_plugin() = default;
+
+std::string block_operations_plugin::plugin_name()const
+{
+   return "block_operations";
+}
+
+std::string block_operations_plugin::plugin_description()const
+{
+   return "Stores the operations applied by each block, including virtual operations and results";
+}
+
+void block_operations_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg
+   )
+{
+}
+
+void block_operations_plugin::plugin_initialize(const boost::program_options::variables_map& options)
+{
+   database().applied_block.connect( [this]( const signed_block& b ) {
+      my->on_block( b );
+   } );
+}
+
+void block_operations_plugin::plugin_startup()
+{
+   ilog("block_operations: plugin_startup() begin");
+}
+
+void block_operations_plugin::plugin_shutdown()
+{
+   if( my->_store.is_open() )
+   {
+      my->_store.flush();
+      my->_store.close();
+   }
+}
+
+optional< vector<operation_history_object> > block_operations_plugin::get_block_operations( uint32_t block_num )
+{
+   optional< vector<operation_history_object> > result;
+   if( !my->_store.is_open() || block_num == 0 || block_num > database().head_block_num() )
+      return result;
+   return my->_store.fetch( block_num, database().get_block_id_for_num( block_num ) );
+}
+
+} }
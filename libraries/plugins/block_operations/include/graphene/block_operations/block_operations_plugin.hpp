@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/plugin.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fstream>
+
+namespace graphene { namespace block_operations {
+   using namespace chain;
+
+/**
+ *  @brief An append-only store of the operations applied by each block
+ *
+ *  The operations of a block are appended to the "operations" file, serialized with fc::raw. The "index" file holds
+ *  one fixed-size entry per block number with the position and size of the operations and the ID of the block they
+ *  belong to. A block which is applied again after a chain reorganization overwrites its index entry, the
+ *  operations which were stored for the replaced block stay in the operations file unreferenced.
+ *
+ *  The store is not thread-safe.
+ */
+class block_operations_store
+{
+   public:
+      void open( const fc::path& dir );
+      bool is_open()const;
+      void flush();
+      void close();
+
+      void store( uint32_t block_num, const block_id_type& block_id, const vector<operation_history_object>& ops );
+      /// @return the operations of the block, or null if they are not stored or were stored for another block
+      optional< vector<operation_history_object> > fetch( uint32_t block_num, const block_id_type& block_id )const;
+
+   private:
+      mutable std::fstream _operations;
+      mutable std::fstream _index;
+};
+
+namespace detail
+{
+    class block_operations_plugin_impl;
+}
+
+/**
+ *  The block operations plugin keeps the real and virtual operations applied by each block together with their
+ *  results in a @ref block_operations_store, for clients which need a block-ordered feed of operations without
+ *  tracking the history of accounts.
+ */
+class block_operations_plugin : public graphene::app::plugin
+{
+   public:
+      explicit block_operations_plugin(graphene::app::application& app);
+      ~block_operations_plugin() override;
+
+      std::string plugin_name()const override;
+      std::string plugin_description()const override;
+      void plugin_set_program_options(
+         boost::program_options::options_description& cli,
+         boost::program_options::options_description& cfg) override;
+      void plugin_initialize(const boost::program_options::variables_map& options) override;
+      void plugin_startup() override;
+      void plugin_shutdown() override;
+
+      /// @return the operations of a block of the current chain, or null if they are not stored
+      optional< vector<operation_history_object> > get_block_operations( uint32_t block_num );
+
+   private:
+      std::unique_ptr<detail::block_operations_plugin_impl> my;
+};
+
+} } //graphene::block_operations
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/custom_operations/account_storage_value_store.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <vector>
+
+namespace graphene { namespace custom_operations {
+
+namespace
+{
+   uint64_t file_size( std::fstream& file )
+   {
+      file.seekg( 0, std::ios::end );
+      return static_cast<uint64_t>( file.tellg() );
+   }
+}
+
+void account_storage_value_store::open( const fc::path& dir, bool reset )
+{ try {
+   fc::create_directories( dir );
+   _values.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+
+   const fc::path values_filename = dir / "values";
+   auto mode = std::fstream::binary | std::fstream::in | std::fstream::out;
+   if( reset || !fc::exists( values_filename ) )
+      mode |= std::fstream::trunc;
+   _values.open( values_filename.generic_string().c_str(), mode );
+} FC_CAPTURE_AND_RETHROW( (dir)(reset) ) }
+
+bool account_storage_value_store::is_open()const
+{
+   return _values.is_open();
+}
+
+void account_storage_value_store::flush()
+{
+   _values.flush();
+}
+
+void account_storage_value_store::close()
+{
+   _values.close();
+}
+
+uint64_t account_storage_value_store::store( const fc::variant& value, uint32_t& size )
+{ try {
+   const std::vector<char> data = fc::raw::pack( value );
+   const uint64_t offset = file_size( _values );
+   _values.seekp( static_cast<std::streamoff>( offset ) );
+   _values.write( data.data(), data.size() );
+   size = static_cast<uint32_t>( data.size() );
+   return offset;
+} FC_CAPTURE_AND_RETHROW() }
+
+fc::optional<fc::variant> account_storage_value_store::fetch( uint64_t offset, uint32_t size )const
+{ try {
+   fc::optional<fc::variant> result;
+   if( size == 0 || file_size( _values ) < offset + size )
+      return result;
+
+   std::vector<char> data( size );
+   _values.seekg( static_cast<std::streamoff>( offset ) );
+   _values.read( data.data(), data.size() );
+   result = fc::raw::unpack<fc::variant>( data );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (offset)(size) ) }
+
+} } //graphene::custom_operations
@@ -29,10 +29,26 @@
 
 namespace graphene { namespace custom_operations {
 
-custom_generic_evaluator::custom_generic_evaluator(database& db, const account_id_type account)
+custom_generic_evaluator::custom_generic_evaluator(database& db, const account_id_type account,
+                                                   account_storage_value_store* value_store)
 {
    _db = &db;
    _account = account;
+   _value_store = value_store;
+}
+
+static void set_value( account_storage_object& aso, const optional<variant>& value,
+                       account_storage_value_store* value_store )
+{
+   aso.value_offset = 0;
+   aso.value_size = 0;
+   if( value.valid() && value_store != nullptr )
+   {
+      aso.value.reset();
+      aso.value_offset = value_store->store( *value, aso.value_size );
+   }
+   else
+      aso.value = value;
 }
 
 vector<object_id_type> custom_generic_evaluator::do_apply(const account_storage_map& op)
@@ -62,13 +78,15 @@ vector<object_id_type> custom_generic_evaluator::do_apply(const account_storage_
          if(itr == index.end())
          {
             try {
+               optional<variant> value;
+               if(row.second.valid())
+                  value = fc::json::from_string(*row.second);
                const auto& created = _db->create<account_storage_object>(
-                                        [&op, this, &row]( account_storage_object& aso ) {
+                                        [&op, this, &row, &value]( account_storage_object& aso ) {
                   aso.account = _account;
                   aso.catalog = op.catalog;
                   aso.key = row.first;
-                  if(row.second.valid())
-                     aso.value = fc::json::from_string(*row.second);
+                  set_value( aso, value, _value_store );
                });
                results.push_back(created.id);
             }
@@ -77,11 +95,11 @@ vector<object_id_type> custom_generic_evaluator::do_apply(const account_storage_
          else
          {
             try {
-               _db->modify(*itr, [&row](account_storage_object &aso) {
-                  if(row.second.valid())
-                     aso.value = fc::json::from_string(*row.second);
-                  else
-                     aso.value.reset();
+               optional<variant> value;
+               if(row.second.valid())
+                  value = fc::json::from_string(*row.second);
+               _db->modify(*itr, [this, &value](account_storage_object &aso) {
+                  set_value( aso, value, _value_store );
                });
                results.push_back(itr->id);
             }
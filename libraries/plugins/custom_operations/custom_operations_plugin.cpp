@@ -40,6 +40,8 @@ class custom_operations_plugin_impl
       {  }
 
       void onBlock();
+      /// Opens the value store if it is enabled and not open yet, or resets it on a replay from the first block
+      void open_value_store( bool reset );
 
       graphene::chain::database& database()
       {
@@ -52,6 +54,9 @@ class custom_operations_plugin_impl
       custom_operations_plugin& _self;
 
       uint32_t _start_block = 45000000;
+
+      bool _store_values = false;
+      account_storage_value_store _value_store;
 };
 
 struct custom_op_visitor
@@ -59,13 +64,15 @@ struct custom_op_visitor
    typedef void result_type;
    account_id_type _fee_payer;
    database* _db;
+   account_storage_value_store* _value_store;
 
-   custom_op_visitor(database& db, account_id_type fee_payer) { _db = &db; _fee_payer = fee_payer; };
+   custom_op_visitor(database& db, account_id_type fee_payer, account_storage_value_store* value_store)
+   { _db = &db; _fee_payer = fee_payer; _value_store = value_store; };
 
    template<typename T>
    void operator()(T &v) const {
       v.validate();
-      custom_generic_evaluator evaluator(*_db, _fee_payer);
+      custom_generic_evaluator evaluator(*_db, _fee_payer, _value_store);
       evaluator.do_apply(v);
    }
 };
@@ -86,7 +93,7 @@ void custom_operations_plugin_impl::onBlock()
 
       try {
          auto unpacked = fc::raw::unpack<custom_plugin_operation>(custom_op.data);
-         custom_op_visitor vtor(db, custom_op.fee_payer());
+         custom_op_visitor vtor(db, custom_op.fee_payer(), _value_store.is_open() ? &_value_store : nullptr);
          unpacked.visit(vtor);
       }
       catch (fc::exception& e) { // only api node will know if the unpack, validate or apply fails
@@ -97,6 +104,19 @@ void custom_operations_plugin_impl::onBlock()
    }
 }
 
+void custom_operations_plugin_impl::open_value_store( bool reset )
+{
+   if( !_store_values )
+      return;
+   if( _value_store.is_open() )
+   {
+      if( !reset )
+         return;
+      _value_store.close();
+   }
+   _value_store.open( database().get_data_dir() / "custom_operations", reset );
+}
+
 } // end namespace detail
 
 custom_operations_plugin::custom_operations_plugin(graphene::app::application& app) :
@@ -125,6 +145,9 @@ void custom_operations_plugin::plugin_set_program_options(
    cli.add_options()
          ("custom-operations-start-block", boost::program_options::value<uint32_t>()->default_value(45000000),
           "Start processing custom operations transactions with the plugin only after this block")
+         ("custom-operations-store-values", boost::program_options::value<bool>(),
+          "Keep the values of the account storage in an on-disk store in the data directory and load them "
+          "on request instead of holding them in memory (default: false)")
          ;
    cfg.add(cli);
 
@@ -137,8 +160,14 @@ void custom_operations_plugin::plugin_initialize(const boost::program_options::v
    if (options.count("custom-operations-start-block") > 0) {
       my->_start_block = options["custom-operations-start-block"].as<uint32_t>();
    }
+   if (options.count("custom-operations-store-values") > 0) {
+      my->_store_values = options["custom-operations-store-values"].as<bool>();
+   }
 
    database().applied_block.connect( [this]( const signed_block& b) {
+      // The objects are rebuilt from the first block on a replay, so the store starts over as well.
+      if( b.block_num() == 1 )
+         my->open_value_store( true );
       if( b.block_num() >= my->_start_block )
          my->onBlock();
    } );
@@ -147,6 +176,23 @@ void custom_operations_plugin::plugin_initialize(const boost::program_options::v
 void custom_operations_plugin::plugin_startup()
 {
    ilog("custom_operations: plugin_startup() begin");
+   my->open_value_store( database().head_block_num() == 0 );
+}
+
+void custom_operations_plugin::plugin_shutdown()
+{
+   if( my->_value_store.is_open() )
+   {
+      my->_value_store.flush();
+      my->_value_store.close();
+   }
+}
+
+optional<variant> custom_operations_plugin::get_value( const account_storage_object& aso )const
+{
+   if( aso.value_size == 0 || !my->_value_store.is_open() )
+      return aso.value;
+   return my->_value_store.fetch( aso.value_offset, aso.value_size );
 }
 
 } }
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/filesystem.hpp>
+#include <fc/optional.hpp>
+#include <fc/variant.hpp>
+
+#include <fstream>
+
+namespace graphene { namespace custom_operations {
+
+/**
+ *  @brief An on-disk store of the values of account storage objects
+ *
+ *  The values are appended to the "values" file, serialized with fc::raw. An object refers to its value by the
+ *  position and size of it in the file, so that only the catalogs and keys are kept in memory. Values are never
+ *  overwritten: a value which is replaced or removed, also by an undo, stays in the file unreferenced.
+ *
+ *  The store is not thread-safe.
+ */
+class account_storage_value_store
+{
+   public:
+      /// Opens the store in the given directory, or creates it if it does not exist or @p reset is true
+      void open( const fc::path& dir, bool reset );
+      bool is_open()const;
+      void flush();
+      void close();
+
+      /// Appends the value to the store
+      /// @return the position of the value in the store
+      uint64_t store( const fc::variant& value, uint32_t& size );
+      /// @return the value at the given position, or null if it is not stored
+      fc::optional<fc::variant> fetch( uint64_t offset, uint32_t size )const;
+
+   private:
+      mutable std::fstream _values;
+};
+
+} } //graphene::custom_operations
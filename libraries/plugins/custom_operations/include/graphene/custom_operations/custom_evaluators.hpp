@@ -24,6 +24,7 @@
 #pragma once
 #include <graphene/custom_operations/custom_objects.hpp>
 #include <graphene/custom_operations/custom_operations.hpp>
+#include <graphene/custom_operations/account_storage_value_store.hpp>
 
 namespace graphene { namespace custom_operations {
 
@@ -32,7 +33,10 @@ class custom_generic_evaluator
    public:
       database* _db;
       account_id_type _account;
-      custom_generic_evaluator(database& db, const account_id_type account);
+      /// The store which receives the values, or null to keep them in memory
+      account_storage_value_store* _value_store;
+      custom_generic_evaluator(database& db, const account_id_type account,
+                               account_storage_value_store* value_store = nullptr);
 
       vector<object_id_type> do_apply(const account_storage_map& o);
 };
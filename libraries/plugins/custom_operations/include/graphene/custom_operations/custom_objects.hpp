@@ -49,6 +49,10 @@ struct account_storage_object : public abstract_object<account_storage_object>
    string catalog;
    string key;
    optional<variant> value;
+   /// Position and size of the value in the value store of the plugin if it is stored out of line,
+   /// a size of 0 means the value is held in @ref value
+   uint64_t value_offset = 0;
+   uint32_t value_size = 0;
 };
 
 struct by_account_catalog_key;
@@ -74,5 +78,5 @@ using account_storage_id_type = object_id<CUSTOM_OPERATIONS_SPACE_ID, account_ma
 } } //graphene::custom_operations
 
 FC_REFLECT_DERIVED( graphene::custom_operations::account_storage_object, (graphene::db::object),
-                    (account)(catalog)(key)(value))
+                    (account)(catalog)(key)(value)(value_offset)(value_size))
 FC_REFLECT_ENUM( graphene::custom_operations::types, (account_map))
@@ -51,6 +51,10 @@ class custom_operations_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       void plugin_initialize(const boost::program_options::variables_map& options) override;
       void plugin_startup() override;
+      void plugin_shutdown() override;
+
+      /// @return the value of the object, loaded from the value store if it is stored out of line
+      optional<variant> get_value( const account_storage_object& aso )const;
 
    private:
       std::unique_ptr<detail::custom_operations_plugin_impl> my;
@@ -1,5 +1,6 @@
 
 #include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
 #include <fc/optional.hpp>
 #include <fc/variant_object.hpp>
 
@@ -11,6 +12,11 @@
 
 #include <graphene/utilities/key_conversion.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
 #include <graphene/debug_witness/debug_api.hpp>
 #include <graphene/debug_witness/debug_witness.hpp>
 
@@ -25,12 +31,23 @@ class debug_api_impl
 
       void debug_push_blocks( const std::string& src_filename, uint32_t count );
       void debug_generate_blocks( const std::string& debug_key, uint32_t count );
+      debug_benchmark_result debug_benchmark_transactions( const std::string& source, uint32_t first_block,
+                                                           const std::string& debug_key,
+                                                           uint32_t transactions_per_block, uint32_t max_blocks );
       void debug_update_object( const fc::variant_object& update );
       void debug_stream_json_objects( const std::string& filename );
       void debug_stream_json_objects_flush();
       std::shared_ptr< graphene::debug_witness_plugin::debug_witness_plugin > get_plugin();
 
       graphene::app::application& app;
+
+   private:
+      /// Generates the next block with the scheduled witness, after giving it the debug key if necessary
+      static void generate_block( graphene::chain::database& db, const fc::ecc::private_key& debug_private_key );
+      static std::vector< graphene::chain::signed_transaction > load_transactions( const std::string& source,
+                                                                                   uint32_t first_block,
+                                                                                   uint64_t max_count );
+      static debug_benchmark_latency summarize( std::vector<int64_t>& latencies );
 };
 
 debug_api_impl::debug_api_impl( graphene::app::application& _app ) : app( _app )
@@ -74,6 +91,22 @@ void debug_api_impl::debug_push_blocks( const std::string& src_filename, uint32_
    }
 }
 
+void debug_api_impl::generate_block( graphene::chain::database& db, const fc::ecc::private_key& debug_private_key )
+{
+   graphene::chain::public_key_type debug_public_key = debug_private_key.get_public_key();
+   graphene::chain::witness_id_type scheduled_witness = db.get_scheduled_witness( 1 );
+   fc::time_point_sec scheduled_time = db.get_slot_time( 1 );
+   graphene::chain::public_key_type scheduled_key = scheduled_witness( db ).signing_key;
+   if( scheduled_key != debug_public_key )
+   {
+      ilog( "Modified key for witness ${w}", ("w", scheduled_witness) );
+      fc::limited_mutable_variant_object update( GRAPHENE_MAX_NESTED_OBJECTS );
+      update("_action", "update")("id", scheduled_witness)("signing_key", debug_public_key);
+      db.debug_update( update );
+   }
+   db.generate_block( scheduled_time, scheduled_witness, debug_private_key, graphene::chain::database::skip_nothing );
+}
+
 void debug_api_impl::debug_generate_blocks( const std::string& debug_key, uint32_t count )
 {
    if( count == 0 )
@@ -81,23 +114,125 @@ void debug_api_impl::debug_generate_blocks( const std::string& debug_key, uint32
 
    fc::optional<fc::ecc::private_key> debug_private_key = graphene::utilities::wif_to_key( debug_key );
    FC_ASSERT( debug_private_key.valid() );
-   graphene::chain::public_key_type debug_public_key = debug_private_key->get_public_key();
 
    std::shared_ptr< graphene::chain::database > db = app.chain_database();
    for( uint32_t i=0; i<count; i++ )
+      generate_block( *db, *debug_private_key );
+}
+
+std::vector< graphene::chain::signed_transaction > debug_api_impl::load_transactions( const std::string& source,
+                                                                                      uint32_t first_block,
+                                                                                      uint64_t max_count )
+{
+   std::vector< graphene::chain::signed_transaction > result;
+   fc::path src_path = fc::path( source );
+   if( fc::is_directory( src_path ) )
+   {
+      graphene::chain::block_database bdb;
+      bdb.open( src_path );
+      for( uint32_t block_num = std::max( first_block, 1u ); result.size() < max_count; ++block_num )
+      {
+         fc::optional< graphene::chain::signed_block > block = bdb.fetch_by_number( block_num );
+         if( !block.valid() )
+            break;
+         for( const auto& trx : block->transactions )
+         {
+            if( result.size() >= max_count )
+               break;
+            result.push_back( trx );
+         }
+      }
+      bdb.close();
+   }
+   else
+   {
+      FC_ASSERT( fc::exists( src_path ), "Transaction source ${s} does not exist", ("s", source) );
+      result = fc::json::from_file( src_path ).as< std::vector< graphene::chain::signed_transaction > >(
+                     GRAPHENE_MAX_NESTED_OBJECTS );
+      if( result.size() > max_count )
+         result.resize( max_count );
+   }
+   return result;
+}
+
+debug_benchmark_latency debug_api_impl::summarize( std::vector<int64_t>& latencies )
+{
+   debug_benchmark_latency result;
+   if( latencies.empty() )
+      return result;
+   std::sort( latencies.begin(), latencies.end() );
+   result.count   = latencies.size();
+   result.min     = latencies.front();
+   result.max     = latencies.back();
+   result.average = std::accumulate( latencies.begin(), latencies.end(), int64_t(0) ) / int64_t(latencies.size());
+   result.p50     = latencies[ ( latencies.size() - 1 ) / 2 ];
+   result.p99     = latencies[ ( latencies.size() - 1 ) * 99 / 100 ];
+   return result;
+}
+
+debug_benchmark_result debug_api_impl::debug_benchmark_transactions( const std::string& source, uint32_t first_block,
+                                                                      const std::string& debug_key,
+                                                                      uint32_t transactions_per_block,
+                                                                      uint32_t max_blocks )
+{
+   FC_ASSERT( transactions_per_block > 0, "At least one transaction per block is required" );
+   fc::optional<fc::ecc::private_key> debug_private_key = graphene::utilities::wif_to_key( debug_key );
+   FC_ASSERT( debug_private_key.valid() );
+
+   const uint64_t max_count = ( max_blocks > 0 ) ? uint64_t(max_blocks) * transactions_per_block
+                                                 : std::numeric_limits<uint64_t>::max();
+   std::vector< graphene::chain::signed_transaction > transactions
+         = load_transactions( source, first_block, max_count );
+   ilog( "Benchmarking ${n} transactions from ${s}, ${t} per block",
+         ("n", transactions.size())("s", source)("t", transactions_per_block) );
+
+   std::shared_ptr< graphene::chain::database > db = app.chain_database();
+   // The recorded transactions refer to blocks of another chain and are signed by keys we do not have
+   const uint32_t skip = graphene::chain::database::skip_transaction_signatures;
+
+   debug_benchmark_result result;
+   std::vector<int64_t> push_latencies;
+   std::vector<int64_t> block_latencies;
+   push_latencies.reserve( transactions.size() );
+   const fc::time_point start = fc::time_point::now();
+   for( size_t next = 0; next < transactions.size(); )
    {
-      graphene::chain::witness_id_type scheduled_witness = db->get_scheduled_witness( 1 );
-      fc::time_point_sec scheduled_time = db->get_slot_time( 1 );
-      graphene::chain::public_key_type scheduled_key = scheduled_witness( *db ).signing_key;
-      if( scheduled_key != debug_public_key )
+      const size_t end = std::min( transactions.size(), next + transactions_per_block );
+      for( ; next < end; ++next )
       {
-         ilog( "Modified key for witness ${w}", ("w", scheduled_witness) );
-         fc::limited_mutable_variant_object update( GRAPHENE_MAX_NESTED_OBJECTS );
-         update("_action", "update")("id", scheduled_witness)("signing_key", debug_public_key);
-         db->debug_update( update );
+         graphene::chain::signed_transaction& trx = transactions[next];
+         trx.set_reference_block( db->head_block_id() );
+         trx.set_expiration( db->head_block_time()
+                             + db->get_global_properties().parameters.maximum_time_until_expiration );
+         const fc::time_point push_start = fc::time_point::now();
+         try
+         {
+            db->push_transaction( trx, skip );
+            push_latencies.push_back( ( fc::time_point::now() - push_start ).count() );
+            ++result.transactions;
+            result.operations += trx.operations.size();
+         }
+         catch( const fc::exception& e )
+         {
+            ++result.failed_transactions;
+            dlog( "Benchmark transaction ${i} was rejected: ${e}", ("i", next)("e", e.to_string()) );
+         }
       }
-      db->generate_block( scheduled_time, scheduled_witness, *debug_private_key, graphene::chain::database::skip_nothing );
+      const fc::time_point block_start = fc::time_point::now();
+      generate_block( *db, *debug_private_key );
+      block_latencies.push_back( ( fc::time_point::now() - block_start ).count() );
+      ++result.blocks;
    }
+   result.elapsed_microseconds = ( fc::time_point::now() - start ).count();
+   if( result.elapsed_microseconds > 0 )
+      result.transactions_per_second = double( result.transactions ) * 1000000 / result.elapsed_microseconds;
+   result.push_transaction = summarize( push_latencies );
+   result.generate_block = summarize( block_latencies );
+
+   ilog( "Benchmark applied ${t} transactions (${f} rejected) in ${b} blocks, ${r} transactions per second",
+         ("t", result.transactions)("f", result.failed_transactions)("b", result.blocks)
+         ("r", result.transactions_per_second) );
+   return result;
 }
 
 void debug_api_impl::debug_update_object( const fc::variant_object& update )
@@ -138,6 +273,14 @@ void debug_api::debug_generate_blocks( std::string debug_key, uint32_t count )
    my->debug_generate_blocks( debug_key, count );
 }
 
+debug_benchmark_result debug_api::debug_benchmark_transactions( std::string source, uint32_t first_block,
+                                                                 std::string debug_key,
+                                                                 uint32_t transactions_per_block,
+                                                                 uint32_t max_blocks )
+{
+   return my->debug_benchmark_transactions( source, first_block, debug_key, transactions_per_block, max_blocks );
+}
+
 void debug_api::debug_update_object( fc::variant_object update )
 {
    my->debug_update_object( update );
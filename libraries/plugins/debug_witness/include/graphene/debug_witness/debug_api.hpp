@@ -27,6 +27,7 @@
 #include <string>
 
 #include <fc/api.hpp>
+#include <fc/reflect/reflect.hpp>
 #include <fc/variant_object.hpp>
 
 namespace graphene { namespace app {
@@ -39,6 +40,32 @@ namespace detail {
 class debug_api_impl;
 }
 
+/// Latencies of a phase of a benchmark, in microseconds
+struct debug_benchmark_latency
+{
+   uint64_t count   = 0;
+   int64_t  min     = 0;
+   int64_t  average = 0;
+   int64_t  p50     = 0;
+   int64_t  p99     = 0;
+   int64_t  max     = 0;
+};
+
+struct debug_benchmark_result
+{
+   uint32_t blocks                  = 0;
+   uint64_t transactions            = 0;
+   /// transactions which were rejected when they were pushed, they are not part of the generated blocks
+   uint64_t failed_transactions     = 0;
+   uint64_t operations              = 0;
+   int64_t  elapsed_microseconds    = 0;
+   double   transactions_per_second = 0;
+   /// evaluation of each transaction when it is pushed into the pending state
+   debug_benchmark_latency push_transaction;
+   /// generation of each block, which applies its transactions again
+   debug_benchmark_latency generate_block;
+};
+
 class debug_api
 {
    public:
@@ -54,6 +81,24 @@ class debug_api
        */
       void debug_generate_blocks( std::string debug_key, uint32_t count );
 
+      /**
+       * Replay recorded transactions into locally generated blocks and measure how long it takes.
+       *
+       * The transactions are read from a block_database directory, starting with block @p first_block, or from a
+       * JSON file which contains an array of signed transactions. Their reference block and expiration are
+       * replaced so that they are valid on the local chain, and their signatures are not checked. Transactions
+       * which are rejected are counted and skipped.
+       *
+       * @param source a block_database directory or a JSON file
+       * @param first_block the first block to read from a block_database, ignored for files
+       * @param debug_key the key which signs the generated blocks
+       * @param transactions_per_block how many transactions each generated block should contain, at least 1
+       * @param max_blocks stop after generating this many blocks, 0 to replay all transactions of the source
+       */
+      debug_benchmark_result debug_benchmark_transactions( std::string source, uint32_t first_block,
+                                                           std::string debug_key, uint32_t transactions_per_block,
+                                                           uint32_t max_blocks );
+
       /**
        * Directly manipulate database objects (will undo and re-apply last block with new changes post-applied).
        */
@@ -87,9 +132,15 @@ class debug_api
 
 } }
 
+FC_REFLECT( graphene::debug_witness::debug_benchmark_latency, (count)(min)(average)(p50)(p99)(max) )
+FC_REFLECT( graphene::debug_witness::debug_benchmark_result,
+            (blocks)(transactions)(failed_transactions)(operations)(elapsed_microseconds)(transactions_per_second)
+            (push_transaction)(generate_block) )
+
 FC_API(graphene::debug_witness::debug_api,
        (debug_push_blocks)
        (debug_generate_blocks)
+       (debug_benchmark_transactions)
        (debug_update_object)
        (debug_stream_json_objects)
        (debug_stream_json_objects_flush)
@@ -30,6 +30,10 @@
 #include <fc/network/http/websocket.hpp>
 #include <fc/rpc/websocket_api.hpp>
 #include <fc/api.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/thread/future.hpp>
+
+#include <mutex>
 
 namespace graphene { namespace delayed_node {
 namespace bpo = boost::program_options;
@@ -40,9 +44,28 @@ struct delayed_node_plugin_impl {
    fc::http::websocket_client client;
    std::shared_ptr<fc::rpc::websocket_api_connection> client_connection;
    fc::api<graphene::app::database_api> database_api;
+   /// used to fetch blocks in ranges, if the trusted node grants access to it
+   fc::optional< fc::api<graphene::app::block_api> > block_api;
+   uint32_t batch_size = 100;
    boost::signals2::scoped_connection client_connection_closed;
    graphene::chain::block_id_type last_received_remote_head;
    graphene::chain::block_id_type last_processed_remote_head;
+   bool connected = false;
+   /// set after connecting, to catch up with the blocks which were applied while we were not connected
+   bool sync_requested = false;
+   /// how long to wait for a notification of the trusted node before polling it anyway
+   uint32_t poll_interval_seconds = 10;
+
+   /// set by the block applied notifications of the trusted node to wake up the main loop
+   std::mutex wakeup_mutex;
+   fc::promise<void>::ptr wakeup;
+
+   void wake_up()
+   {
+      std::lock_guard<std::mutex> guard( wakeup_mutex );
+      if( wakeup && !wakeup->ready() )
+         wakeup->set_value();
+   }
 };
 }
 
@@ -59,6 +82,10 @@ void delayed_node_plugin::plugin_set_program_options(bpo::options_description& c
    cli.add_options()
          ("trusted-node", boost::program_options::value<std::string>(),
           "RPC endpoint of a trusted validating node (required for delayed_node)")
+         ("delayed-node-batch-size", boost::program_options::value<uint32_t>(),
+          "Number of blocks to request from the trusted node at once while catching up (default: 100)")
+         ("delayed-node-poll-interval", boost::program_options::value<uint32_t>(),
+          "Seconds after which the trusted node is polled if it has not notified a new block (default: 10)")
          ;
    cfg.add(cli);
 }
@@ -79,13 +106,29 @@ void delayed_node_plugin::connect()
    my->client_connection = std::make_shared<fc::rpc::websocket_api_connection>(
            con, GRAPHENE_NET_MAX_NESTED_OBJECTS );
    my->database_api = my->client_connection->get_remote_api<graphene::app::database_api>(0);
+   my->block_api.reset();
+   try
+   {
+      auto login = my->client_connection->get_remote_api<graphene::app::login_api>(1);
+      if( login->login( "", "" ) )
+         my->block_api = login->block();
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "The block API of the trusted node is not available, fetching blocks one by one: ${e}",
+            ("e", e.to_string()) );
+   }
    my->database_api->set_block_applied_callback([this]( const fc::variant& block_id )
    {
       fc::from_variant( block_id, my->last_received_remote_head, GRAPHENE_MAX_NESTED_OBJECTS );
+      my->wake_up();
    } );
    my->client_connection_closed = my->client_connection->closed.connect([this] {
       connection_failed();
    });
+   my->connected = true;
+   my->sync_requested = true;
+   my->wake_up();
 }
 
 void delayed_node_plugin::plugin_initialize(const boost::program_options::variables_map& options)
@@ -93,6 +136,39 @@ void delayed_node_plugin::plugin_initialize(const boost::program_options::variab
    FC_ASSERT(options.count("trusted-node") > 0);
    my = std::make_unique<detail::delayed_node_plugin_impl>();
    my->remote_endpoint = "ws://" + options.at("trusted-node").as<std::string>();
+   if( options.count("delayed-node-batch-size") > 0 )
+      my->batch_size = std::max<uint32_t>( 1, options.at("delayed-node-batch-size").as<uint32_t>() );
+   if( options.count("delayed-node-poll-interval") > 0 )
+      my->poll_interval_seconds = std::max<uint32_t>( 1, options.at("delayed-node-poll-interval").as<uint32_t>() );
+}
+
+std::vector<graphene::chain::signed_block> delayed_node_plugin::fetch_blocks( uint32_t block_num_from,
+                                                                              uint32_t block_num_to )
+{
+   std::vector<graphene::chain::signed_block> blocks;
+   blocks.reserve( block_num_to - block_num_from + 1 );
+   if( my->block_api.valid() )
+   {
+      const auto packed_blocks = (*my->block_api)->get_packed_blocks( block_num_from, block_num_to );
+      for( const auto& packed : packed_blocks )
+      {
+         FC_ASSERT( packed.valid(), "Trusted node claims it has blocks it doesn't actually have." );
+         blocks.push_back( fc::raw::unpack<graphene::chain::signed_block>( *packed ) );
+      }
+   }
+   else
+   {
+      for( uint32_t block_num = block_num_from; block_num <= block_num_to; ++block_num )
+      {
+         fc::optional<graphene::chain::signed_block> block = my->database_api->get_block( block_num );
+         FC_ASSERT( block, "Trusted node claims it has blocks it doesn't actually have." );
+         blocks.push_back( std::move( *block ) );
+      }
+   }
+   FC_ASSERT( blocks.size() == block_num_to - block_num_from + 1
+                 && blocks.front().block_num() == block_num_from,
+              "Trusted node returned other blocks than requested." );
+   return blocks;
 }
 
 void delayed_node_plugin::sync_with_trusted_node()
@@ -116,15 +192,52 @@ void delayed_node_plugin::sync_with_trusted_node()
          break;
       }
       pass_count++;
-      while( remote_dpo.last_irreversible_block_num > db.head_block_num() )
+      // the next batch is fetched while the current one is applied
+      const uint32_t last_block_num = remote_dpo.last_irreversible_block_num;
+      uint32_t next_block_num = db.head_block_num() + 1;
+      auto fetch_next_batch = [this,&next_block_num,last_block_num]() {
+         const uint32_t from = next_block_num;
+         const uint32_t to = std::min( last_block_num, from + ( my->batch_size - 1 ) );
+         next_block_num = to + 1;
+         return fc::async( [this,from,to]() { return fetch_blocks( from, to ); }, "delayed_node fetch blocks" );
+      };
+      auto next_batch = fetch_next_batch();
+      while( true )
       {
-         fc::optional<graphene::chain::signed_block> block = my->database_api->get_block( db.head_block_num()+1 );
-         // TODO: during sync, decouple requesting blocks from preprocessing + applying them
-         FC_ASSERT(block, "Trusted node claims it has blocks it doesn't actually have.");
-         ilog("Pushing block #${n}", ("n", block->block_num()));
-         db.precompute_parallel( *block, graphene::chain::database::skip_nothing ).wait();
-         db.push_block(*block);
-         synced_blocks++;
+         const std::vector<graphene::chain::signed_block> blocks = next_batch.wait();
+         const bool more = ( next_block_num <= last_block_num );
+         if( more )
+            next_batch = fetch_next_batch();
+
+         std::vector< fc::future<void> > precomputed;
+         precomputed.reserve( blocks.size() );
+         for( const auto& block : blocks )
+            precomputed.push_back( db.precompute_parallel( block, graphene::chain::database::skip_nothing ) );
+         size_t i = 0;
+         try
+         {
+            for( ; i < blocks.size(); ++i )
+            {
+               ilog("Pushing block #${n}", ("n", blocks[i].block_num()));
+               precomputed[i].wait();
+               db.push_block( blocks[i] );
+               synced_blocks++;
+            }
+         }
+         catch( const fc::exception& )
+         {
+            // the precomputations refer to the blocks
+            for( ++i; i < blocks.size(); ++i )
+            {
+               try {
+                  precomputed[i].wait();
+               } catch( const fc::exception& ) {
+               }
+            }
+            throw;
+         }
+         if( !more )
+            break;
       }
    }
 }
@@ -135,17 +248,45 @@ void delayed_node_plugin::mainloop()
    {
       try
       {
-         fc::usleep( fc::microseconds( 296645 ) );  // wake up a little over 3Hz
+         fc::promise<void>::ptr wakeup = fc::promise<void>::create( "delayed_node::wakeup" );
+         {
+            std::lock_guard<std::mutex> guard( my->wakeup_mutex );
+            my->wakeup = wakeup;
+         }
+
+         bool poll = my->sync_requested;
+         my->sync_requested = false;
+         if( !poll && my->last_received_remote_head == my->last_processed_remote_head )
+         {
+            try
+            {
+               wakeup->wait( fc::seconds( my->poll_interval_seconds ) );
+            }
+            catch( const fc::timeout_exception& )
+            {
+               // the notifications may have been lost, ask the trusted node anyway
+               poll = true;
+            }
+         }
 
-         if( my->last_received_remote_head == my->last_processed_remote_head )
+         if( !my->connected )
+            continue;
+         if( !poll && my->last_received_remote_head == my->last_processed_remote_head )
             continue;
 
+         const graphene::chain::block_id_type remote_head = my->last_received_remote_head;
          sync_with_trusted_node();
-         my->last_processed_remote_head = my->last_received_remote_head;
+         my->last_processed_remote_head = remote_head;
+      }
+      catch( const fc::canceled_exception& )
+      {
+         throw;
       }
       catch( const fc::exception& e )
       {
          elog("Error during connection: ${e}", ("e", e.to_detail_string()));
+         // do not retry at once
+         fc::usleep( fc::seconds( 1 ) );
       }
    }
 }
@@ -162,6 +303,7 @@ void delayed_node_plugin::plugin_startup()
 
 void delayed_node_plugin::connection_failed()
 {
+   my->connected = false;
    my->last_received_remote_head = my->last_processed_remote_head;
    elog("Connection to trusted node failed; retrying in 5 seconds...");
    fc::schedule([this]{connect();}, fc::time_point::now() + fc::seconds(5));
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <graphene/app/plugin.hpp>
+#include <graphene/protocol/block.hpp>
 
 namespace graphene { namespace delayed_node {
 namespace detail { struct delayed_node_plugin_impl; }
@@ -46,6 +47,8 @@ protected:
    void connection_failed();
    void connect();
    void sync_with_trusted_node();
+   /// @return the blocks from @p block_num_from to @p block_num_to of the trusted node
+   std::vector<graphene::protocol::signed_block> fetch_blocks( uint32_t block_num_from, uint32_t block_num_to );
 };
 
 } } //graphene::account_history
@@ -26,13 +26,250 @@
 #include <graphene/chain/impacted.hpp>
 #include <graphene/chain/account_evaluator.hpp>
 #include <graphene/chain/hardfork.hpp>
+#include <graphene/utilities/elasticsearch_bulk_writer.hpp>
+#include <graphene/utilities/thread_affinity.hpp>
 #include <curl/curl.h>
 
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
 namespace graphene { namespace elasticsearch {
 
 namespace detail
 {
 
+static operation_history_struct make_operation_history_struct( const operation_history_object& oho,
+                                                               bool with_object, bool with_string )
+{
+   operation_history_struct os;
+   os.trx_in_block = oho.trx_in_block;
+   os.op_in_trx = oho.op_in_trx;
+   os.operation_result = fc::json::to_string(oho.result);
+   os.virtual_op = oho.virtual_op;
+
+   if(with_object) {
+      oho.op.visit(fc::from_static_variant(os.op_object, FC_PACK_MAX_DEPTH));
+      adaptor_struct adaptor;
+      os.op_object = adaptor.adapt(os.op_object.get_object());
+   }
+   if(with_string)
+      os.op = fc::json::to_string(oho.op);
+   return os;
+}
+
+static void add_bulk_line( graphene::utilities::BulkBody& body, const std::string& index_name,
+                           const account_transaction_history_object& ath, const operation_history_struct& os,
+                           int16_t op_type, const block_struct& bs, const optional<visitor_struct>& vs )
+{
+   bulk_struct line;
+   line.account_history = ath;
+   line.operation_history = os;
+   line.operation_type = op_type;
+   line.operation_id_num = ath.operation_id.instance.value;
+   line.block_data = bs;
+   line.additional_data = vs;
+   const std::string id = fc::to_string(ath.id.space_id) + "." + fc::to_string(ath.id.type_id) + "."
+                        + fc::to_string(ath.id.instance.value);
+   body.addIndex(index_name, "data", id, fc::json::to_string(line, fc::json::legacy_generator));
+}
+
+/**
+ * Builds the bulk requests of replayed blocks on a pool of threads.
+ *
+ * The chain thread collects copies of the operations of a range of blocks and of the account history objects
+ * created for them, and submits them as one bundle. Bundles are serialized concurrently, and their bodies are
+ * collected in the order of submission, so that the bulk writer still receives the blocks in order and its
+ * checkpoint only covers complete blocks.
+ */
+class replay_indexer
+{
+   public:
+      /// A bundle is submitted once it holds this many documents, and at the end of the replay
+      static constexpr size_t bundle_documents = 1000;
+
+      struct operation_entry
+      {
+         std::string                                  index_name;
+         operation_history_object                     oho;
+         int16_t                                      op_type = 0;
+         block_struct                                 block_data;
+         optional<visitor_struct>                     visitor_data;
+         vector<account_transaction_history_object>   account_histories;
+      };
+      struct bundle
+      {
+         /// The last block whose operations are complete in this bundle
+         uint32_t                 last_block_num = 0;
+         vector<operation_entry>  operations;
+         size_t                   documents = 0;
+      };
+
+      /// @param cpus the CPUs to pin the threads to, any if empty
+      replay_indexer( uint32_t threads, bool operation_object, bool operation_string, const vector<uint32_t>& cpus )
+         : _operation_object( operation_object ), _operation_string( operation_string ),
+           _max_building( threads * 2 )
+      {
+         for( uint32_t i = 0; i < threads; ++i )
+            _threads.emplace_back( [this,cpus]() {
+               if( !cpus.empty() )
+               {
+                  try
+                  {
+                     graphene::utilities::pin_current_thread( cpus );
+                  }
+                  catch( const fc::exception& e )
+                  {
+                     wlog( "Unable to pin an elasticsearch replay worker: ${e}", ("e",e.to_string()) );
+                  }
+               }
+               run();
+            } );
+      }
+      ~replay_indexer()
+      {
+         {
+            std::lock_guard<std::mutex> lock( _mutex );
+            _stopping = true;
+         }
+         _work.notify_all();
+         for( auto& t : _threads )
+            t.join();
+      }
+
+      /** Queues a bundle, blocks while too many bundles wait to be built */
+      void submit( bundle&& b )
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         _done.wait( lock, [this]() { return building() < _max_building; } );
+         _queue.emplace_back( _next_submitted++, std::move( b ) );
+         _work.notify_one();
+      }
+
+      /**
+       * Appends the bodies of the bundles which are built to body, in the order of submission
+       * @param wait whether to wait until all submitted bundles are built
+       * @return the last block of the appended bundles, 0 if none was appended
+       */
+      uint32_t collect( graphene::utilities::BulkBody& body, bool wait )
+      {
+         vector<result> ready;
+         {
+            std::unique_lock<std::mutex> lock( _mutex );
+            if( wait )
+               _done.wait( lock, [this]() { return building() == 0; } );
+            auto itr = _results.begin();
+            while( itr != _results.end() && itr->first == _next_collected )
+            {
+               ready.push_back( std::move( itr->second ) );
+               itr = _results.erase( itr );
+               ++_next_collected;
+            }
+         }
+         uint32_t last_block_num = 0;
+         for( const auto& r : ready )
+         {
+            if( !r.error.empty() )
+               FC_THROW_EXCEPTION( graphene::chain::plugin_exception,
+                     "Error building the bulk request of the blocks up to ${b}: ${e}",
+                     ("b",r.last_block_num)("e",r.error) );
+            body.append( r.body );
+            last_block_num = r.last_block_num;
+         }
+         return last_block_num;
+      }
+
+   private:
+      struct result
+      {
+         uint32_t                        last_block_num = 0;
+         graphene::utilities::BulkBody   body;
+         std::string                     error;
+      };
+
+      /// @return the number of bundles which are queued or being built, the mutex must be held
+      size_t building()const { return _next_submitted - _next_collected - _results.size(); }
+
+      void run()
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         while( true )
+         {
+            _work.wait( lock, [this]() { return _stopping || !_queue.empty(); } );
+            if( _queue.empty() )
+               return;
+            auto item = std::move( _queue.front() );
+            _queue.pop_front();
+            lock.unlock();
+
+            result r;
+            r.last_block_num = item.second.last_block_num;
+            try
+            {
+               for( const auto& op : item.second.operations )
+               {
+                  const auto os = make_operation_history_struct( op.oho, _operation_object, _operation_string );
+                  for( const auto& ath : op.account_histories )
+                     add_bulk_line( r.body, op.index_name, ath, os, op.op_type, op.block_data, op.visitor_data );
+               }
+            }
+            catch( const fc::exception& e )
+            {
+               r.error = e.to_detail_string();
+            }
+            catch( const std::exception& e )
+            {
+               r.error = e.what();
+            }
+
+            lock.lock();
+            _results.emplace( item.first, std::move( r ) );
+            _done.notify_all();
+         }
+      }
+
+      const bool                                   _operation_object;
+      const bool                                   _operation_string;
+      const size_t                                 _max_building;
+      vector<std::thread>                          _threads;
+      std::mutex                                   _mutex;
+      std::condition_variable                      _work;
+      std::condition_variable                      _done;
+      std::deque< std::pair<uint64_t, bundle> >    _queue;
+      std::map< uint64_t, result >                 _results;
+      uint64_t                                     _next_submitted = 0;
+      uint64_t                                     _next_collected = 0;
+      bool                                         _stopping = false;
+};
+
+/// A thread which sends the queries of the history API to Elastic Search over its own connection
+class query_connection
+{
+   public:
+      explicit query_connection( uint32_t number )
+         : thread( "elasticsearch_query_" + std::to_string( number ) )
+      {
+         curl = curl_easy_init();
+         curl_easy_setopt(curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_2);
+      }
+      ~query_connection()
+      {
+         thread.quit();
+         curl_easy_cleanup(curl);
+      }
+
+      fc::thread              thread;
+      /// Only used in thread, so that the connection is reused by the following queries
+      CURL*                   curl;
+      /// The queries which are running or wait in thread
+      std::atomic<uint32_t>   pending { 0 };
+};
+
 class elasticsearch_plugin_impl
 {
    public:
@@ -45,6 +282,13 @@ class elasticsearch_plugin_impl
       virtual ~elasticsearch_plugin_impl();
 
       bool update_account_histories( const signed_block& b );
+      /// Sends bulk_body, which completes the given block
+      bool sendBulk( uint32_t block_num );
+      /// Waits for the replay indexer to build all bundles and sends their bodies
+      bool flushReplay();
+      /// Runs query( curl ) in the query thread with the fewest pending queries and records its latency
+      template<typename Query>
+      auto runQuery( Query&& query ) -> fc::future< decltype( query( (CURL*)nullptr ) ) >;
 
       graphene::chain::database& database()
       {
@@ -64,9 +308,25 @@ class elasticsearch_plugin_impl
       uint32_t _elasticsearch_start_es_after_block = 0;
       bool _elasticsearch_operation_string = false;
       mode _elasticsearch_mode = mode::only_save;
+      uint32_t _elasticsearch_async_connections = 0;
+      uint32_t _elasticsearch_async_queue_size = 16;
+      /// Sends the bulk requests in the background if _elasticsearch_async_connections is not 0
+      std::unique_ptr<graphene::utilities::ESBulkWriter> _bulk_writer;
+      uint32_t _elasticsearch_replay_workers = 0;
+      /// Builds the bulk requests while replaying if _elasticsearch_replay_workers is not 0
+      std::unique_ptr<replay_indexer> _replay_indexer;
+      replay_indexer::bundle _replay_bundle;
+      /// The last block whose lines are complete in bulk_body when they were built by the replay indexer
+      uint32_t _replay_collected_block = 0;
+      bool _parallel_replay = false;
+      uint32_t _elasticsearch_query_threads = 4;
+      /// The CPUs to pin the query threads and the replay workers to, any if empty
+      vector<uint32_t> _elasticsearch_thread_cpus;
+      vector< std::unique_ptr<query_connection> > _query_connections;
+      mutable std::mutex _query_metrics_mutex;
+      elasticsearch_query_metrics _query_metrics;
       CURL *curl; // curl handler
-      vector <string> bulk_lines; //  vector of op lines
-      vector<std::string> prepare;
+      graphene::utilities::BulkBody bulk_body; // op lines
 
       graphene::utilities::ES es;
       uint32_t limit_documents;
@@ -74,12 +334,11 @@ class elasticsearch_plugin_impl
       operation_history_struct os;
       block_struct bs;
       visitor_struct vs;
-      bulk_struct bulk_line_struct;
-      std::string bulk_line;
       std::string index_name;
       bool is_sync = false;
    private:
-      bool add_elasticsearch( const account_id_type account_id, const optional<operation_history_object>& oho, const uint32_t block_number );
+      bool add_elasticsearch( const account_id_type account_id, const optional<operation_history_object>& oho,
+                              const uint32_t block_number, replay_indexer::operation_entry* replay_entry );
       const account_transaction_history_object& addNewEntry(const account_statistics_object& stats_obj,
                                                             const account_id_type& account_id,
                                                             const optional <operation_history_object>& oho);
@@ -91,8 +350,6 @@ class elasticsearch_plugin_impl
       void doVisitor(const optional <operation_history_object>& oho);
       void checkState(const fc::time_point_sec& block_time);
       void cleanObjects(const account_transaction_history_id_type& ath, const account_id_type& account_id);
-      void createBulkLine(const account_transaction_history_object& ath);
-      void prepareBulk(const account_transaction_history_id_type& ath_id);
       void populateESstruct();
 };
 
@@ -108,24 +365,21 @@ bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b
 {
    checkState(b.timestamp);
    index_name = graphene::utilities::generateIndexName(b.timestamp, _elasticsearch_index_prefix);
+   // the documents of the replayed blocks have to be sent before those of the first block in sync
+   if(_replay_indexer && is_sync && _parallel_replay && !flushReplay())
+      return false;
+   _parallel_replay = _replay_indexer && !is_sync;
 
    graphene::chain::database& db = database();
    const vector<optional< operation_history_object > >& hist = db.get_applied_operations();
-   bool is_first = true;
-   auto skip_oho_id = [&is_first,&db,this]() {
-      if( is_first && db._undo_db.enabled() ) // this ensures that the current id is rolled back on undo
-      {
-         db.remove( db.create<operation_history_object>( []( operation_history_object& obj) {} ) );
-         is_first = false;
-      }
-      else
-         _oho_index->use_next_id();
-   };
-   for( const optional< operation_history_object >& o_op : hist ) {
+   // the skipped id is handed out again if the block is undone
+   auto skip_oho_id = [this]() { _oho_index->reserve_next_id(); };
+   const vector< flat_set<account_id_type> >& op_impacted = db.get_applied_operations_impacted_accounts();
+   for( size_t op_index = 0; op_index < hist.size(); ++op_index ) {
+      const optional< operation_history_object >& o_op = hist[op_index];
       optional <operation_history_object> oho;
 
       auto create_oho = [&]() {
-         is_first = false;
          return optional<operation_history_object>(
                db.create<operation_history_object>([&](operation_history_object &h) {
                   if (o_op.valid())
@@ -148,11 +402,26 @@ bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b
 
       // populate what we can before impacted loop
       getOperationType(oho);
-      doOperationHistory(oho);
+      if(!_parallel_replay)
+         doOperationHistory(oho);
       doBlock(oho->trx_in_block, b);
       if(_elasticsearch_visitor)
          doVisitor(oho);
 
+      // the documents are built by the replay indexer from a copy of the data
+      replay_indexer::operation_entry* replay_entry = nullptr;
+      if(_parallel_replay && b.block_num() > _elasticsearch_start_es_after_block)
+      {
+         _replay_bundle.operations.emplace_back();
+         replay_entry = &_replay_bundle.operations.back();
+         replay_entry->index_name = index_name;
+         replay_entry->oho = *oho;
+         replay_entry->op_type = op_type;
+         replay_entry->block_data = bs;
+         if(_elasticsearch_visitor)
+            replay_entry->visitor_data = vs;
+      }
+
       const operation_history_object& op = *o_op;
 
       // get the set of accounts this operation applies to
@@ -168,8 +437,7 @@ bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b
       // https://github.com/bitshares/bitshares-core/issues/265
       if( HARDFORK_CORE_265_PASSED(b.timestamp) || !op.op.is_type< account_create_operation >() )
       {
-         operation_get_impacted_accounts( op.op, impacted,
-                                          MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( db.head_block_time() ) );
+         impacted.insert( op_impacted[op_index].begin(), op_impacted[op_index].end() );
       }
 
       if( op.result.is_type<extendable_operation_result>() )
@@ -188,7 +456,7 @@ bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b
 
       for( auto& account_id : impacted )
       {
-         if(!add_elasticsearch( account_id, oho, b.block_num() ))
+         if(!add_elasticsearch( account_id, oho, b.block_num(), replay_entry ))
          {
             elog( "Error adding data to Elastic Search: block num ${b}, account ${a}, data ${d}",
                   ("b",b.block_num()) ("a",account_id) ("d", oho) );
@@ -197,34 +465,91 @@ bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b
       }
    }
    // we send bulk at end of block when we are in sync for better real time client experience
-   if(is_sync)
+   if(is_sync && !bulk_body.empty())
+   {
+      if(!sendBulk(b.block_num()))
+         return false;
+   }
+
+   if(_parallel_replay)
    {
-      populateESstruct();
-      if(es.bulk_lines.size() > 0)
+      _replay_bundle.last_block_num = b.block_num();
+      if(_replay_bundle.documents >= replay_indexer::bundle_documents)
       {
-         prepare.clear();
-         if(!graphene::utilities::SendBulk(std::move(es)))
-         {
-            // Note: although called with `std::move()`, `es` is not updated in `SendBulk()`
-            elog( "Error sending ${n} lines of bulk data to Elastic Search, the first lines are:",
-                  ("n",es.bulk_lines.size()) );
-            for( size_t i = 0; i < es.bulk_lines.size() && i < 10; ++i )
-            {
-               edump( (es.bulk_lines[i]) );
-            }
+         _replay_indexer->submit(std::move(_replay_bundle));
+         _replay_bundle = replay_indexer::bundle();
+         const uint32_t collected = _replay_indexer->collect(bulk_body, false);
+         if(collected > 0)
+            _replay_collected_block = collected;
+         if(bulk_body.lines() >= limit_documents && !sendBulk(_replay_collected_block))
             return false;
-         }
-         else
-            bulk_lines.clear();
       }
    }
 
-   if(bulk_lines.size() != limit_documents)
-      bulk_lines.reserve(limit_documents);
-
    return true;
 }
 
+bool elasticsearch_plugin_impl::flushReplay()
+{
+   if(!_replay_bundle.operations.empty())
+      _replay_indexer->submit(std::move(_replay_bundle));
+   _replay_bundle = replay_indexer::bundle();
+   const uint32_t collected = _replay_indexer->collect(bulk_body, true);
+   if(collected > 0)
+      _replay_collected_block = collected;
+   _parallel_replay = false;
+   if(bulk_body.empty())
+      return true;
+   return sendBulk(_replay_collected_block);
+}
+
+template<typename Query>
+auto elasticsearch_plugin_impl::runQuery( Query&& query ) -> fc::future< decltype( query( (CURL*)nullptr ) ) >
+{
+   typedef decltype( query( (CURL*)nullptr ) ) result_type;
+   FC_ASSERT( !_query_connections.empty(), "Elastic Search is not queried in only_save mode" );
+   query_connection* conn = _query_connections.front().get();
+   for( const auto& c : _query_connections )
+      if( c->pending < conn->pending )
+         conn = c.get();
+   ++conn->pending;
+   {
+      std::lock_guard<std::mutex> lock( _query_metrics_mutex );
+      ++_query_metrics.in_flight;
+   }
+   const fc::time_point queued_at = fc::time_point::now();
+   return conn->thread.async( [this,conn,queued_at,query]() -> result_type {
+      const fc::time_point started_at = fc::time_point::now();
+      bool failed = true;
+      auto record = [&]() {
+         const fc::time_point done_at = fc::time_point::now();
+         --conn->pending;
+         std::lock_guard<std::mutex> lock( _query_metrics_mutex );
+         auto& m = _query_metrics;
+         --m.in_flight;
+         ++m.queries;
+         if( failed )
+            ++m.failures;
+         const uint64_t query_time = ( done_at - started_at ).count();
+         m.total_wait_microseconds += ( started_at - queued_at ).count();
+         m.total_query_microseconds += query_time;
+         m.max_query_microseconds = std::max( m.max_query_microseconds, query_time );
+      };
+      try
+      {
+         result_type result = query( conn->curl );
+         failed = false;
+         record();
+         return result;
+      }
+      catch( ... )
+      {
+         record();
+         throw;
+      }
+   }, "elasticsearch query" );
+}
+
 void elasticsearch_plugin_impl::checkState(const fc::time_point_sec& block_time)
 {
    if((fc::time_point::now() - block_time) < fc::seconds(30))
@@ -247,18 +572,7 @@ void elasticsearch_plugin_impl::getOperationType(const optional <operation_histo
 
 void elasticsearch_plugin_impl::doOperationHistory(const optional <operation_history_object>& oho)
 {
-   os.trx_in_block = oho->trx_in_block;
-   os.op_in_trx = oho->op_in_trx;
-   os.operation_result = fc::json::to_string(oho->result);
-   os.virtual_op = oho->virtual_op;
-
-   if(_elasticsearch_operation_object) {
-      oho->op.visit(fc::from_static_variant(os.op_object, FC_PACK_MAX_DEPTH));
-      adaptor_struct adaptor;
-      os.op_object = adaptor.adapt(os.op_object.get_object());
-   }
-   if(_elasticsearch_operation_string)
-      os.op = fc::json::to_string(oho->op);
+   os = make_operation_history_struct(*oho, _elasticsearch_operation_object, _elasticsearch_operation_string);
 }
 
 void elasticsearch_plugin_impl::doBlock(uint32_t trx_in_block, const signed_block& b)
@@ -314,38 +628,53 @@ void elasticsearch_plugin_impl::doVisitor(const optional <operation_history_obje
 
 bool elasticsearch_plugin_impl::add_elasticsearch( const account_id_type account_id,
                                                    const optional <operation_history_object>& oho,
-                                                   const uint32_t block_number)
+                                                   const uint32_t block_number,
+                                                   replay_indexer::operation_entry* replay_entry )
 {
    const auto &stats_obj = getStatsObject(account_id);
    const auto &ath = addNewEntry(stats_obj, account_id, oho);
    growStats(stats_obj, ath);
-   if(block_number > _elasticsearch_start_es_after_block)  {
-      createBulkLine(ath);
-      prepareBulk(ath.id);
+   if(replay_entry != nullptr) {
+      replay_entry->account_histories.push_back(ath);
+      ++_replay_bundle.documents;
+   }
+   else if(block_number > _elasticsearch_start_es_after_block)  {
+      add_bulk_line(bulk_body, index_name, ath, os, op_type, bs,
+                    _elasticsearch_visitor ? optional<visitor_struct>(vs) : optional<visitor_struct>());
    }
    cleanObjects(ath.id, account_id);
 
-   if (curl && bulk_lines.size() >= limit_documents) { // we are in bulk time, ready to add data to elasticsearech
-      prepare.clear();
-      populateESstruct();
-      if(!graphene::utilities::SendBulk(std::move(es)))
-      {
-         // Note: although called with `std::move()`, `es` is not updated in `SendBulk()`
-         elog( "Error sending ${n} lines of bulk data to Elastic Search, the first lines are:",
-               ("n",es.bulk_lines.size()) );
-         for( size_t i = 0; i < es.bulk_lines.size() && i < 10; ++i )
-         {
-            edump( (es.bulk_lines[i]) );
-         }
+   // we are in bulk time, ready to add data to elasticsearech.
+   // While replaying in parallel, bulk_body only holds the lines of complete blocks.
+   if (!_parallel_replay && curl && bulk_body.lines() >= limit_documents) {
+      // the lines of the current block are not complete yet
+      if(!sendBulk(block_number - 1))
          return false;
-      }
-      else
-         bulk_lines.clear();
    }
 
    return true;
 }
 
+bool elasticsearch_plugin_impl::sendBulk( uint32_t block_num )
+{
+   if(_bulk_writer)
+   {
+      _bulk_writer->push(block_num, bulk_body.release());
+      return true;
+   }
+
+   populateESstruct();
+   const bool sent = graphene::utilities::SendBulkBody(es, bulk_body.str());
+   if(!sent)
+   {
+      elog( "Error sending ${n} lines of bulk data to Elastic Search, the first lines are: ${l}",
+            ("n",bulk_body.lines())("l",bulk_body.head(10)) );
+   }
+   // the buffer is reused by the next request
+   bulk_body.clear();
+   return sent;
+}
+
 const account_statistics_object& elasticsearch_plugin_impl::getStatsObject(const account_id_type& account_id)
 {
    graphene::chain::database& db = database();
@@ -379,31 +708,6 @@ void elasticsearch_plugin_impl::growStats(const account_statistics_object& stats
    });
 }
 
-void elasticsearch_plugin_impl::createBulkLine(const account_transaction_history_object& ath)
-{
-   bulk_line_struct.account_history = ath;
-   bulk_line_struct.operation_history = os;
-   bulk_line_struct.operation_type = op_type;
-   bulk_line_struct.operation_id_num = ath.operation_id.instance.value;
-   bulk_line_struct.block_data = bs;
-   if(_elasticsearch_visitor)
-      bulk_line_struct.additional_data = vs;
-   bulk_line = fc::json::to_string(bulk_line_struct, fc::json::legacy_generator);
-}
-
-void elasticsearch_plugin_impl::prepareBulk(const account_transaction_history_id_type& ath_id)
-{
-   const std::string _id = fc::json::to_string(ath_id);
-   fc::mutable_variant_object bulk_header;
-   bulk_header["_index"] = index_name;
-   bulk_header["_type"] = "data";
-   bulk_header["_id"] = fc::to_string(ath_id.space_id) + "." + fc::to_string(ath_id.type_id) + "."
-                      + fc::to_string(ath_id.instance.value);
-   prepare = graphene::utilities::createBulk(bulk_header, std::move(bulk_line));
-   std::move(prepare.begin(), prepare.end(), std::back_inserter(bulk_lines));
-   prepare.clear();
-}
-
 void elasticsearch_plugin_impl::cleanObjects(const account_transaction_history_id_type& ath_id, const account_id_type& account_id)
 {
    graphene::chain::database& db = database();
@@ -436,7 +740,7 @@ void elasticsearch_plugin_impl::cleanObjects(const account_transaction_history_i
 void elasticsearch_plugin_impl::populateESstruct()
 {
    es.curl = curl;
-   es.bulk_lines = std::move(bulk_lines);
+   es.bulk_lines.clear();
    es.elasticsearch_url = _elasticsearch_node_url;
    es.auth = _elasticsearch_basic_auth;
    es.index_prefix = _elasticsearch_index_prefix;
@@ -490,6 +794,21 @@ void elasticsearch_plugin::plugin_set_program_options(
                "Save operation as string. Needed to serve history api calls(false)")
          ("elasticsearch-mode", boost::program_options::value<uint16_t>(),
                "Mode of operation: only_save(0), only_query(1), all(2) - Default: 0")
+         ("elasticsearch-async-connections", boost::program_options::value<uint32_t>(),
+               "Send bulk requests in the background over this many connections, retrying failed requests, "
+               "instead of while applying blocks(0)")
+         ("elasticsearch-async-queue-size", boost::program_options::value<uint32_t>(),
+               "Number of bulk requests which may wait to be sent in the background before applying blocks "
+               "waits for them(16)")
+         ("elasticsearch-replay-workers", boost::program_options::value<uint32_t>(),
+               "Number of threads building the bulk requests while replaying, requires "
+               "elasticsearch-async-connections(0)")
+         ("elasticsearch-query-threads", boost::program_options::value<uint32_t>(),
+               "Number of threads sending the queries of the history API, each of them over its own "
+               "connection(4)")
+         ("elasticsearch-thread-cpus", boost::program_options::value<std::string>(),
+               "CPUs to run the query threads and the replay workers on, a comma separated list of CPU numbers, "
+               "ranges like 0-3 and NUMA nodes like node:1(any)")
          ;
    cfg.add(cli);
 }
@@ -532,6 +851,39 @@ void elasticsearch_plugin::plugin_initialize(const boost::program_options::varia
          FC_THROW_EXCEPTION(graphene::chain::plugin_exception, "Elasticsearch mode not valid");
       my->_elasticsearch_mode = static_cast<mode>(options["elasticsearch-mode"].as<uint16_t>());
    }
+   if (options.count("elasticsearch-async-connections") > 0) {
+      my->_elasticsearch_async_connections = options["elasticsearch-async-connections"].as<uint32_t>();
+   }
+   if (options.count("elasticsearch-async-queue-size") > 0) {
+      my->_elasticsearch_async_queue_size = options["elasticsearch-async-queue-size"].as<uint32_t>();
+   }
+   if (options.count("elasticsearch-replay-workers") > 0) {
+      my->_elasticsearch_replay_workers = options["elasticsearch-replay-workers"].as<uint32_t>();
+      // the checkpoint of the bulk writer is what makes it safe to send the blocks out of the chain thread
+      if(my->_elasticsearch_replay_workers > 0 && my->_elasticsearch_async_connections == 0)
+         FC_THROW_EXCEPTION(graphene::chain::plugin_exception,
+               "elasticsearch-replay-workers requires elasticsearch-async-connections");
+   }
+
+   if (options.count("elasticsearch-query-threads") > 0) {
+      my->_elasticsearch_query_threads = std::max<uint32_t>(1, options["elasticsearch-query-threads"].as<uint32_t>());
+   }
+
+   if (options.count("elasticsearch-thread-cpus") > 0) {
+      my->_elasticsearch_thread_cpus =
+            graphene::utilities::parse_cpu_set( options["elasticsearch-thread-cpus"].as<std::string>() );
+   }
+
+   if(my->_elasticsearch_mode != mode::only_save) {
+      for(uint32_t i = 0; i < my->_elasticsearch_query_threads; ++i)
+         my->_query_connections.push_back( std::make_unique<detail::query_connection>(i) );
+      if(!my->_elasticsearch_thread_cpus.empty()) {
+         const auto cpus = my->_elasticsearch_thread_cpus;
+         for(const auto& conn : my->_query_connections)
+            conn->thread.async( [cpus]() { graphene::utilities::pin_current_thread( cpus ); } ).wait();
+      }
+      my->_query_metrics.threads = my->_elasticsearch_query_threads;
+   }
 
    if(my->_elasticsearch_mode != mode::only_query) {
       if (my->_elasticsearch_mode == mode::all && !my->_elasticsearch_operation_string)
@@ -555,10 +907,71 @@ void elasticsearch_plugin::plugin_startup()
 
    if(!graphene::utilities::checkES(es))
       FC_THROW_EXCEPTION(fc::exception, "ES database is not up in url ${url}", ("url", my->_elasticsearch_node_url));
+
+   if(my->_elasticsearch_mode != mode::only_query && my->_elasticsearch_async_connections > 0)
+   {
+      my->_bulk_writer = std::make_unique<graphene::utilities::ESBulkWriter>( my->_elasticsearch_node_url,
+            my->_elasticsearch_basic_auth, my->_elasticsearch_async_connections,
+            my->_elasticsearch_async_queue_size, database().get_data_dir() / "elasticsearch" );
+      my->_bulk_writer->start();
+      ilog( "elasticsearch ACCOUNT HISTORY: data is acknowledged up to block ${b}",
+            ("b", my->_bulk_writer->lastAcknowledgedBlock()) );
+      if(my->_elasticsearch_replay_workers > 0)
+         my->_replay_indexer = std::make_unique<detail::replay_indexer>( my->_elasticsearch_replay_workers,
+               my->_elasticsearch_operation_object, my->_elasticsearch_operation_string,
+               my->_elasticsearch_thread_cpus );
+   }
    ilog("elasticsearch ACCOUNT HISTORY: plugin_startup() begin");
 }
 
+void elasticsearch_plugin::plugin_shutdown()
+{
+   if(my->_replay_indexer)
+   {
+      my->flushReplay();
+      my->_replay_indexer.reset();
+   }
+   if(my->_bulk_writer)
+   {
+      // the lines of the last blocks are saved with the requests which are not acknowledged
+      my->sendBulk(database().head_block_num());
+      my->_bulk_writer->stop();
+      my->_bulk_writer.reset();
+   }
+}
+
 operation_history_object elasticsearch_plugin::get_operation_by_id(operation_history_id_type id)
+{
+   return my->runQuery( [this,id]( CURL* curl ) { return queryOperation(curl, id); } ).wait();
+}
+
+vector<operation_history_object> elasticsearch_plugin::get_account_history(
+      const account_id_type account_id,
+      operation_history_id_type stop,
+      unsigned limit,
+      operation_history_id_type start)
+{
+   return get_account_history_async(account_id, stop, limit, start).wait();
+}
+
+fc::future<vector<operation_history_object>> elasticsearch_plugin::get_account_history_async(
+      const account_id_type account_id,
+      operation_history_id_type stop,
+      unsigned limit,
+      operation_history_id_type start)
+{
+   return my->runQuery( [this,account_id,stop,limit,start]( CURL* curl ) {
+      return queryAccountHistory(curl, account_id, stop, limit, start);
+   });
+}
+
+elasticsearch_query_metrics elasticsearch_plugin::get_query_metrics()const
+{
+   std::lock_guard<std::mutex> lock( my->_query_metrics_mutex );
+   return my->_query_metrics;
+}
+
+operation_history_object elasticsearch_plugin::queryOperation(CURL* curl, operation_history_id_type id)
 {
    const string operation_id_string = std::string(object_id_type(id));
 
@@ -573,18 +986,19 @@ operation_history_object elasticsearch_plugin::get_operation_by_id(operation_his
    }
    )";
 
-   auto es = prepareHistoryQuery(query);
+   auto es = prepareHistoryQuery(query, curl);
    const auto response = graphene::utilities::simpleQuery(es);
    variant variant_response = fc::json::from_string(response);
    const auto source = variant_response["hits"]["hits"][size_t(0)]["_source"];
    return fromEStoOperation(source);
 }
 
-vector<operation_history_object> elasticsearch_plugin::get_account_history(
+vector<operation_history_object> elasticsearch_plugin::queryAccountHistory(
+      CURL* curl,
       const account_id_type account_id,
-      operation_history_id_type stop = operation_history_id_type(),
-      unsigned limit = 100,
-      operation_history_id_type start = operation_history_id_type())
+      operation_history_id_type stop,
+      unsigned limit,
+      operation_history_id_type start)
 {
    const string account_id_string = std::string(object_id_type(account_id));
 
@@ -615,7 +1029,7 @@ vector<operation_history_object> elasticsearch_plugin::get_account_history(
    }
    )";
 
-   auto es = prepareHistoryQuery(query);
+   auto es = prepareHistoryQuery(query, curl);
 
    vector<operation_history_object> result;
 
@@ -662,12 +1076,8 @@ operation_history_object elasticsearch_plugin::fromEStoOperation(variant source)
    return result;
 }
 
-graphene::utilities::ES elasticsearch_plugin::prepareHistoryQuery(string query)
+graphene::utilities::ES elasticsearch_plugin::prepareHistoryQuery(string query, CURL* curl)
 {
-   CURL *curl;
-   curl = curl_easy_init();
-   curl_easy_setopt(curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_2);
-
    graphene::utilities::ES es;
    es.curl = curl;
    es.elasticsearch_url = my->_elasticsearch_node_url;
@@ -28,6 +28,8 @@
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/utilities/elasticsearch.hpp>
 
+#include <fc/thread/future.hpp>
+
 namespace graphene { namespace elasticsearch {
    using namespace chain;
 
@@ -52,6 +54,18 @@ namespace detail
 
 enum mode { only_save = 0 , only_query = 1, all = 2 };
 
+/// Latencies of the queries sent to Elastic Search by the history API, see the "elasticsearch-query-threads" option
+struct elasticsearch_query_metrics
+{
+   uint32_t threads = 0;                  ///< threads which send queries, each of them over its own connection
+   uint32_t in_flight = 0;                ///< queries which are running or wait for a thread
+   uint64_t queries = 0;                  ///< queries completed since startup
+   uint64_t failures = 0;                 ///< completed queries which failed
+   uint64_t total_wait_microseconds = 0;  ///< time the completed queries waited for a thread
+   uint64_t total_query_microseconds = 0; ///< time the completed queries took to run, including the transfer
+   uint64_t max_query_microseconds = 0;   ///< longest time a completed query took to run
+};
+
 class elasticsearch_plugin : public graphene::app::plugin
 {
    public:
@@ -65,18 +79,29 @@ class elasticsearch_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       void plugin_initialize(const boost::program_options::variables_map& options) override;
       void plugin_startup() override;
+      void plugin_shutdown() override;
 
       operation_history_object get_operation_by_id(operation_history_id_type id);
       vector<operation_history_object> get_account_history(const account_id_type account_id,
             operation_history_id_type stop, unsigned limit, operation_history_id_type start);
+      /**
+       * Same as @ref get_account_history, but the query is run in one of the query threads of the plugin.
+       * Waiting for the result only suspends the calling task, the thread of the caller serves other tasks meanwhile.
+       */
+      fc::future<vector<operation_history_object>> get_account_history_async(const account_id_type account_id,
+            operation_history_id_type stop, unsigned limit, operation_history_id_type start);
+      elasticsearch_query_metrics get_query_metrics()const;
       mode get_running_mode();
 
       friend class detail::elasticsearch_plugin_impl;
       std::unique_ptr<detail::elasticsearch_plugin_impl> my;
 
    private:
+      operation_history_object queryOperation(CURL* curl, operation_history_id_type id);
+      vector<operation_history_object> queryAccountHistory(CURL* curl, const account_id_type account_id,
+            operation_history_id_type stop, unsigned limit, operation_history_id_type start);
       operation_history_object fromEStoOperation(variant source);
-      graphene::utilities::ES prepareHistoryQuery(string query);
+      graphene::utilities::ES prepareHistoryQuery(string query, CURL* curl);
 };
 
 
@@ -300,6 +325,9 @@ struct adaptor_struct {
 } } //graphene::elasticsearch
 
 FC_REFLECT_ENUM( graphene::elasticsearch::mode, (only_save)(only_query)(all) )
+FC_REFLECT( graphene::elasticsearch::elasticsearch_query_metrics,
+            (threads)(in_flight)(queries)(failures)(total_wait_microseconds)(total_query_microseconds)
+            (max_query_microseconds) )
 FC_REFLECT( graphene::elasticsearch::operation_history_struct, (trx_in_block)(op_in_trx)(operation_result)(virtual_op)(op)(op_object) )
 FC_REFLECT( graphene::elasticsearch::block_struct, (block_num)(block_time)(trx_id) )
 FC_REFLECT( graphene::elasticsearch::fee_struct, (asset)(asset_name)(amount)(amount_units) )
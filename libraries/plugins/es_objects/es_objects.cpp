@@ -67,8 +67,7 @@ class es_objects_plugin_impl
       std::string _es_objects_index_prefix = "objects-";
       uint32_t _es_objects_start_es_after_block = 0;
       CURL *curl; // curl handler
-      vector <std::string> bulk;
-      vector<std::string> prepare;
+      graphene::utilities::BulkBody bulk;
 
       bool _es_objects_keep_only_current = true;
 
@@ -116,10 +115,9 @@ bool es_objects_plugin_impl::genesis()
 
    graphene::utilities::ES es;
    es.curl = curl;
-   es.bulk_lines = bulk;
    es.elasticsearch_url = _es_objects_elasticsearch_url;
    es.auth = _es_objects_auth;
-   if (!graphene::utilities::SendBulk(std::move(es)))
+   if (!graphene::utilities::SendBulkBody(es, bulk.str()))
       FC_THROW_EXCEPTION(graphene::chain::plugin_exception, "Error inserting genesis data.");
    else
       bulk.clear();
@@ -202,15 +200,14 @@ bool es_objects_plugin_impl::index_database(const vector<object_id_type>& ids, s
          }
       }
 
-      if (curl && bulk.size() >= limit_documents) { // we are in bulk time, ready to add data to elasticsearech
+      if (curl && bulk.lines() >= limit_documents) { // we are in bulk time, ready to add data to elasticsearech
 
          graphene::utilities::ES es;
          es.curl = curl;
-         es.bulk_lines = bulk;
          es.elasticsearch_url = _es_objects_elasticsearch_url;
          es.auth = _es_objects_auth;
 
-         if (!graphene::utilities::SendBulk(std::move(es)))
+         if (!graphene::utilities::SendBulkBody(es, bulk.str()))
             return false;
          else
             bulk.clear();
@@ -224,29 +221,13 @@ void es_objects_plugin_impl::remove_from_database( object_id_type id, std::strin
 {
    if(_es_objects_keep_only_current)
    {
-      fc::mutable_variant_object delete_line;
-      delete_line["_id"] = string(id);
-      delete_line["_index"] = _es_objects_index_prefix + index;
-      delete_line["_type"] = "data";
-      fc::mutable_variant_object final_delete_line;
-      final_delete_line["delete"] = delete_line;
-      prepare.push_back(fc::json::to_string(final_delete_line));
-      std::move(prepare.begin(), prepare.end(), std::back_inserter(bulk));
-      prepare.clear();
+      bulk.addDelete(_es_objects_index_prefix + index, "data", string(id));
    }
 }
 
 template<typename T>
 void es_objects_plugin_impl::prepareTemplate(T blockchain_object, string index_name)
 {
-   fc::mutable_variant_object bulk_header;
-   bulk_header["_index"] = _es_objects_index_prefix + index_name;
-   bulk_header["_type"] = "data";
-   if(_es_objects_keep_only_current)
-   {
-      bulk_header["_id"] = string(blockchain_object.id);
-   }
-
    adaptor_struct adaptor;
    fc::variant blockchain_object_variant;
    fc::to_variant( blockchain_object, blockchain_object_variant, GRAPHENE_NET_MAX_NESTED_OBJECTS );
@@ -256,11 +237,10 @@ void es_objects_plugin_impl::prepareTemplate(T blockchain_object, string index_n
    o["block_time"] = block_time;
    o["block_number"] = block_number;
 
-   string data = fc::json::to_string(o, fc::json::legacy_generator);
+   const string data = fc::json::to_string(o, fc::json::legacy_generator);
 
-   prepare = graphene::utilities::createBulk(bulk_header, std::move(data));
-   std::move(prepare.begin(), prepare.end(), std::back_inserter(bulk));
-   prepare.clear();
+   bulk.addIndex(_es_objects_index_prefix + index_name, "data",
+                 _es_objects_keep_only_current ? string(blockchain_object.id) : string(), data);
 }
 
 es_objects_plugin_impl::~es_objects_plugin_impl()
@@ -48,6 +48,9 @@ class grouped_orders_plugin_impl
 
 /**
  *  @brief This secondary index is used to track changes on limit order objects.
+ *
+ *  The changes are deferred to the end of each block and coalesced per order, so an order which is filled several
+ *  times in a block is only moved between groups once.
  */
 class limit_order_group_index : public secondary_index
 {
@@ -58,12 +61,18 @@ class limit_order_group_index : public secondary_index
       virtual void object_removed( const object& obj ) override;
       virtual void about_to_modify( const object& before ) override;
       virtual void object_modified( const object& after  ) override;
+      /** only used by the API */
+      virtual bool is_deferrable()const override { return true; }
 
       const flat_set<uint16_t>& get_tracked_groups() const
       { return _tracked_groups; }
 
-      const map< limit_order_group_key, limit_order_group_data >& get_order_groups() const
-      { return _og_data; }
+      const limit_order_group_map& get_order_groups( const asset_id_type base, const asset_id_type quote ) const
+      {
+         static const limit_order_group_map empty;
+         auto itr = _og_data.find( std::make_pair( base, quote ) );
+         return ( itr == _og_data.end() ? empty : itr->second );
+      }
 
    private:
       void remove_order( const limit_order_object& obj, bool remove_empty = true );
@@ -71,15 +80,15 @@ class limit_order_group_index : public secondary_index
       /** tracked groups */
       flat_set<uint16_t> _tracked_groups;
 
-      /** maps the group key to group data */
-      map< limit_order_group_key, limit_order_group_data > _og_data;
+      /** maps the market, i.e. the assets of the sell price, to the groups of the market */
+      flat_map< std::pair<asset_id_type, asset_id_type>, limit_order_group_map > _og_data;
 };
 
 void limit_order_group_index::object_inserted( const object& objct )
 { try {
    const limit_order_object& o = static_cast<const limit_order_object&>( objct );
 
-   auto& idx = _og_data;
+   auto& idx = _og_data[ std::make_pair( o.sell_price.base.asset_id, o.sell_price.quote.asset_id ) ];
 
    for( uint16_t group : get_tracked_groups() )
    {
@@ -113,12 +122,10 @@ void limit_order_group_index::object_inserted( const object& objct )
       // if idx is not empty, find the group that is next to this order
       auto itr = idx.lower_bound( limit_order_group_key( group, capped_price ) );
       bool check_previous = false;
-      if( itr == idx.end() || itr->first.group != group
-            || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-            || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id )
-         // not same market or group type
+      if( itr == idx.end() || itr->first.group != group )
+         // not same group type
          check_previous = true;
-      else // same market and group type
+      else // same group type
       {
          bool update_max = false;
          if( capped_price > itr->second.max_price ) // implies itr->min_price <= itr->max_price < max
@@ -133,10 +140,10 @@ void limit_order_group_index::object_inserted( const object& objct )
          {
             if( capped_min && o.sell_price < itr->first.min_price )
             {  // need to update itr->min_price here, if itr is below min, and new order is even lower
-               // TODO improve performance
                limit_order_group_data data( itr->second.max_price, o.for_sale + itr->second.total_for_sale );
-               idx.erase( itr );
-               idx[ limit_order_group_key( group, o.sell_price ) ] = data;
+               itr = idx.erase( itr );
+               // the new key sorts at the same position, since no key of the group is between them
+               idx.emplace_hint( itr, limit_order_group_key( group, o.sell_price ), data );
             }
             else
             {
@@ -154,11 +161,10 @@ void limit_order_group_index::object_inserted( const object& objct )
          else
          {
             --itr; // should be valid
-            if( itr->first.group != group || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-                                          || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id )
-               // not same market or group type
+            if( itr->first.group != group )
+               // not same group type
                create_ogo();
-            else // same market and group type
+            else // same group type
             {
                // due to lower_bound, always true: capped_price < itr->first.min_price, so no need to check again,
                // if new order is in range of itr group, always need to update itr->first.min_price, unless
@@ -175,10 +181,9 @@ void limit_order_group_index::object_inserted( const object& objct )
                }
                else
                {  // new order is within the range
-                  // TODO improve performance
                   limit_order_group_data data( itr->second.max_price, o.for_sale + itr->second.total_for_sale );
-                  idx.erase( itr );
-                  idx[ limit_order_group_key( group, o.sell_price ) ] = data;
+                  itr = idx.erase( itr );
+                  idx.emplace_hint( itr, limit_order_group_key( group, o.sell_price ), data );
                }
             }
          }
@@ -205,16 +210,20 @@ void limit_order_group_index::object_modified( const object& objct )
 
 void limit_order_group_index::remove_order( const limit_order_object& o, bool remove_empty )
 {
-   auto& idx = _og_data;
+   auto market_itr = _og_data.find( std::make_pair( o.sell_price.base.asset_id, o.sell_price.quote.asset_id ) );
+   if( market_itr == _og_data.end() )
+   {
+      // can not find corresponding market, should not happen
+      wlog( "can not find the order group containing order for removing (market dismatch): ${o}", ("o",o) );
+      return;
+   }
+   auto& idx = market_itr->second;
 
    for( uint16_t group : get_tracked_groups() )
    {
       // find the group that should contain this order
       auto itr = idx.lower_bound( limit_order_group_key( group, o.sell_price ) );
-      if( itr == idx.end() || itr->first.group != group
-            || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-            || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id
-            || itr->second.max_price < o.sell_price )
+      if( itr == idx.end() || itr->first.group != group || itr->second.max_price < o.sell_price )
       {
          // can not find corresponding group, should not happen
          wlog( "can not find the order group containing order for removing (price dismatch): ${o}", ("o",o) );
@@ -232,6 +241,9 @@ void limit_order_group_index::remove_order( const limit_order_object& o, bool re
             idx.erase( itr );
       }
    }
+
+   if( idx.empty() )
+      _og_data.erase( market_itr );
 }
 
 } // end namespace detail
@@ -290,12 +302,13 @@ const flat_set<uint16_t>& grouped_orders_plugin::tracked_groups() const
    return my->_tracked_groups;
 }
 
-const map< limit_order_group_key, limit_order_group_data >& grouped_orders_plugin::limit_order_groups()
+const limit_order_group_map& grouped_orders_plugin::limit_order_groups( const asset_id_type base,
+                                                                         const asset_id_type quote )
 {
    const auto& idx = database().get_index_type< limit_order_index >();
    const auto& pidx = dynamic_cast<const primary_index< limit_order_index >&>(idx);
    const auto& logidx = pidx.get_secondary_index< detail::limit_order_group_index >();
-   return logidx.get_order_groups();
+   return logidx.get_order_groups( base, quote );
 }
 
 } }
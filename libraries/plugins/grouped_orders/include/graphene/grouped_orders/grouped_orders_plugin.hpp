@@ -57,6 +57,9 @@ struct limit_order_group_data
    share_type    total_for_sale; ///< asset id is min_price.base.asset_id
 };
 
+/// The order groups of one market, sorted by group and by price descendingly
+typedef flat_map< limit_order_group_key, limit_order_group_data > limit_order_group_map;
+
 namespace detail
 {
     class grouped_orders_plugin_impl;
@@ -82,7 +85,8 @@ class grouped_orders_plugin : public graphene::app::plugin
 
       const flat_set<uint16_t>&   tracked_groups()const;
 
-      const map< limit_order_group_key, limit_order_group_data >& limit_order_groups();
+      /// @return the order groups of the orders which sell @p base for @p quote, as of the last applied block
+      const limit_order_group_map& limit_order_groups( const asset_id_type base, const asset_id_type quote );
 
    private:
       std::unique_ptr<detail::grouped_orders_plugin_impl> my;
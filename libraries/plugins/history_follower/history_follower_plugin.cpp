@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/history_follower/history_follower_plugin.hpp>
+
+#include <graphene/chain/account_object.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
+
+namespace graphene { namespace history_follower {
+
+namespace
+{
+
+/// @return the object of a change, account statistics get the history fields of the local object
+vector<char> local_object_data( const graphene::chain::database& db,
+                                const graphene::object_changes::object_change& change )
+{
+   if( !change.id.is<account_statistics_id_type>() )
+      return change.data;
+   auto stats = fc::raw::unpack<account_statistics_object>( change.data );
+   const account_statistics_object* local = db.find( account_statistics_id_type( change.id ) );
+   const account_statistics_object defaults;
+   const account_statistics_object& history = ( local != nullptr ) ? *local : defaults;
+   stats.most_recent_op = history.most_recent_op;
+   stats.total_ops = history.total_ops;
+   stats.removed_ops = history.removed_ops;
+   return fc::raw::pack( stats );
+}
+
+} // anonymous namespace
+
+namespace detail
+{
+
+class history_follower_plugin_impl
+{
+   public:
+      /// The largest record which is accepted from the primary
+      static constexpr uint32_t max_record_size = 256 * 1024 * 1024;
+
+      explicit history_follower_plugin_impl( history_follower_plugin& _plugin )
+      : _self( _plugin ) {}
+
+      void accept_loop();
+      /// Applies the records sent over the socket until it is closed
+      void read_records( fc::tcp_socket& socket );
+
+      history_follower_plugin& _self;
+      fc::ip::endpoint         _endpoint;
+      fc::tcp_server           _server;
+      fc::future<void>         _accept_loop_done;
+};
+
+void history_follower_plugin_impl::accept_loop()
+{
+   while( !_accept_loop_done.canceled() )
+   {
+      fc::tcp_socket socket;
+      try
+      {
+         _server.accept( socket );
+         ilog( "history_follower: receiving object changes from ${ep}", ("ep",socket.remote_endpoint()) );
+         read_records( socket );
+      }
+      catch( const fc::canceled_exception& )
+      {
+         throw;
+      }
+      catch( const fc::eof_exception& )
+      {
+         ilog( "history_follower: the primary has closed the connection" );
+      } FC_CAPTURE_AND_LOG( (_endpoint) )
+   }
+}
+
+void history_follower_plugin_impl::read_records( fc::tcp_socket& socket )
+{
+   vector<char> data;
+   while( true )
+   {
+      uint32_t size = 0;
+      socket.read( reinterpret_cast<char*>( &size ), sizeof(size) );
+      FC_ASSERT( size <= max_record_size, "The primary sent a record of ${n} bytes", ("n",size) );
+      data.resize( size );
+      socket.read( data.data(), data.size() );
+      const auto record = fc::raw::unpack<graphene::object_changes::object_changes_block>( data );
+      try
+      {
+         _self.apply_record( record );
+      } FC_CAPTURE_AND_LOG( (record.block_num)(record.block_id) )
+   }
+}
+
+} // end namespace detail
+
+history_follower_plugin::history_follower_plugin(graphene::app::application& app) :
+   plugin(app),
+   my( std::make_unique<detail::history_follower_plugin_impl>(*this) )
+{
+   // Nothing else to do
+}
+
+history_follower_plugin::~history_follower_plugin() = default;
+
+std::string history_follower_plugin::plugin_name()const
+{
+   return "history_follower";
+}
+
+std::string history_follower_plugin::plugin_description()const
+{
+   return "Follows the object changes and operations of another node instead of applying blocks, "
+          "for history API replicas";
+}
+
+void history_follower_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg
+   )
+{
+   cli.add_options()
+         ("history-follower-endpoint", boost::program_options::value<std::string>(),
+               "IP:port to receive the object changes of the primary node on, which sends them with the socket "
+               "sink of the object_changes plugin and object-changes-follower-feed (required for history_follower)")
+         ;
+   cfg.add(cli);
+}
+
+void history_follower_plugin::plugin_initialize(const boost::program_options::variables_map& options)
+{ try {
+   FC_ASSERT( options.count("history-follower-endpoint") > 0, "history_follower requires history-follower-endpoint" );
+   my->_endpoint = fc::ip::endpoint::from_string( options["history-follower-endpoint"].as<std::string>() );
+} FC_CAPTURE_AND_RETHROW() }
+
+void history_follower_plugin::plugin_startup()
+{
+   my->_server.set_reuse_address();
+   my->_server.listen( my->_endpoint );
+   ilog( "history_follower: listening for object changes on ${ep}", ("ep",my->_endpoint) );
+   my->_accept_loop_done = fc::async( [this]() { my->accept_loop(); }, "history_follower accept loop" );
+}
+
+void history_follower_plugin::plugin_shutdown()
+{
+   try
+   {
+      my->_server.close();
+      if( my->_accept_loop_done.valid() )
+         my->_accept_loop_done.cancel_and_wait( "history_follower_plugin::plugin_shutdown()" );
+   }
+   catch( const fc::canceled_exception& )
+   {
+      // the loop has been canceled
+   } FC_CAPTURE_AND_LOG( (my->_endpoint) )
+}
+
+void history_follower_plugin::apply_record( const graphene::object_changes::object_changes_block& record )
+{ try {
+   FC_ASSERT( record.block.valid(), "The record has no block, the primary has to enable object-changes-follower-feed" );
+   graphene::chain::database& db = database();
+   vector<replicated_object_change> changes;
+   changes.reserve( record.changes.size() );
+   for( const auto& change : record.changes )
+   {
+      // the objects of plugins are maintained by the plugins of this node
+      if( ( change.id.space() != protocol_ids && change.id.space() != implementation_ids )
+            || change.id.is<operation_history_id_type>() || change.id.is<account_transaction_history_id_type>() )
+         continue;
+      replicated_object_change replicated;
+      replicated.id = change.id;
+      if( change.action != graphene::object_changes::object_change::removed )
+         replicated.data = local_object_data( db, change );
+      changes.push_back( std::move( replicated ) );
+   }
+   db.apply_replicated_block( *record.block, record.operations, changes );
+} FC_CAPTURE_AND_RETHROW( (record.block_num)(record.block_id) ) }
+
+} }
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/plugin.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/object_changes/object_changes_plugin.hpp>
+
+namespace graphene { namespace history_follower {
+   using namespace chain;
+
+namespace detail
+{
+    class history_follower_plugin_impl;
+}
+
+/**
+ *  The history follower plugin turns the node into a replica of another node, the primary, for history APIs. It
+ *  does not apply blocks itself, instead it listens for the object changes plugin of the primary, which sends the
+ *  objects changed by each block together with the block and its applied operations, see
+ *  object-changes-follower-feed. They are written to the database with @ref database::apply_replicated_block,
+ *  so that the account_history and market_history plugins of this node maintain their indexes without evaluating
+ *  transactions. The P2P network is disabled.
+ *
+ *  The follower has to start from the same state as the primary, i.e. both from genesis or from a state snapshot
+ *  of the primary. Objects of plugins are not copied from the primary, and the history fields of the account
+ *  statistics keep their local values. Blocks which the primary fails to send leave a gap, then the follower stops
+ *  applying blocks until it is restarted from a new state snapshot.
+ */
+class history_follower_plugin : public graphene::app::plugin
+{
+   public:
+      explicit history_follower_plugin(graphene::app::application& app);
+      ~history_follower_plugin() override;
+
+      std::string plugin_name()const override;
+      std::string plugin_description()const override;
+      void plugin_set_program_options(
+         boost::program_options::options_description& cli,
+         boost::program_options::options_description& cfg) override;
+      void plugin_initialize(const boost::program_options::variables_map& options) override;
+      void plugin_startup() override;
+      void plugin_shutdown() override;
+
+      /// Applies a record of the object changes plugin of the primary, see @ref database::apply_replicated_block
+      void apply_record( const graphene::object_changes::object_changes_block& record );
+
+   private:
+      std::unique_ptr<detail::history_follower_plugin_impl> my;
+};
+
+} } //graphene::history_follower
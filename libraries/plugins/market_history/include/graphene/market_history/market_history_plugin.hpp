@@ -57,7 +57,8 @@ enum market_history_object_type
    market_ticker_meta_object_type = 3,
    liquidity_pool_history_object_type = 4,
    liquidity_pool_ticker_meta_object_type = 5,
-   liquidity_pool_ticker_object_type = 6
+   liquidity_pool_ticker_object_type = 6,
+   liquidity_pool_history_interval_object_type = 7
 };
 
 struct bucket_key
@@ -298,6 +299,72 @@ typedef generic_index< liquidity_pool_history_object,
                        liquidity_pool_history_multi_index_type > liquidity_pool_history_index;
 
 
+/**
+ * Aggregates the operations of a liquidity pool in a time interval which were rolled out of the detailed
+ * history, only stored if the compaction of the liquidity pool history is enabled
+ */
+struct liquidity_pool_history_interval_object : public abstract_object<liquidity_pool_history_interval_object>
+{
+   static constexpr uint8_t space_id = MARKET_HISTORY_SPACE_ID;
+   static constexpr uint8_t type_id  = liquidity_pool_history_interval_object_type;
+
+   liquidity_pool_id_type   pool;
+   uint32_t                 seconds = 0; ///< the length of the interval
+   fc::time_point_sec       open;        ///< the start of the interval
+   uint64_t                 min_sequence = 0;
+   uint64_t                 max_sequence = 0;
+   /// The number of creations and deletions, which are not aggregated otherwise
+   uint32_t                 other_count = 0;
+   uint32_t                 deposit_count = 0;
+   fc::uint128_t            deposit_amount_a = 0;
+   fc::uint128_t            deposit_amount_b = 0;
+   fc::uint128_t            deposit_share_amount = 0;
+   uint32_t                 withdrawal_count = 0;
+   fc::uint128_t            withdrawal_amount_a = 0;
+   fc::uint128_t            withdrawal_amount_b = 0;
+   fc::uint128_t            withdrawal_share_amount = 0;
+   fc::uint128_t            withdrawal_fee_a = 0;
+   fc::uint128_t            withdrawal_fee_b = 0;
+   uint32_t                 exchange_a2b_count = 0;
+   fc::uint128_t            exchange_a2b_amount_a = 0;
+   fc::uint128_t            exchange_a2b_amount_b = 0;
+   uint32_t                 exchange_b2a_count = 0;
+   fc::uint128_t            exchange_b2a_amount_a = 0;
+   fc::uint128_t            exchange_b2a_amount_b = 0;
+   fc::uint128_t            exchange_fee_a = 0;
+   fc::uint128_t            exchange_fee_b = 0;
+   share_type               balance_delta_a;
+   share_type               balance_delta_b;
+};
+
+struct by_pool_open;
+
+typedef multi_index_container<
+   liquidity_pool_history_interval_object,
+   indexed_by<
+      ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+      ordered_unique< tag<by_pool_open>,
+         composite_key< liquidity_pool_history_interval_object,
+            member<liquidity_pool_history_interval_object, liquidity_pool_id_type,
+                   &liquidity_pool_history_interval_object::pool>,
+            member<liquidity_pool_history_interval_object, uint32_t,
+                   &liquidity_pool_history_interval_object::seconds>,
+            member<liquidity_pool_history_interval_object, time_point_sec,
+                   &liquidity_pool_history_interval_object::open>
+         >,
+         composite_key_compare<
+            std::less< liquidity_pool_id_type >,
+            std::less< uint32_t >,
+            std::greater< time_point_sec >
+         >
+      >
+   >
+> liquidity_pool_history_interval_multi_index_type;
+
+typedef generic_index< liquidity_pool_history_interval_object,
+                       liquidity_pool_history_interval_multi_index_type > liquidity_pool_history_interval_index;
+
+
 /// Stores meta data for liquidity pool tickers
 struct liquidity_pool_ticker_meta_object : public abstract_object<liquidity_pool_ticker_meta_object>
 {
@@ -390,11 +457,21 @@ class market_history_plugin : public graphene::app::plugin
       void plugin_initialize(
          const boost::program_options::variables_map& options) override;
       void plugin_startup() override;
+      void plugin_shutdown() override;
 
       uint32_t                    max_history()const;
       const flat_set<uint32_t>&   tracked_buckets()const;
       uint32_t                    max_order_his_records_per_market()const;
       uint32_t                    max_order_his_seconds_per_market()const;
+      /// @return the length of the intervals the rolled out liquidity pool history is aggregated in, 0 if disabled
+      uint32_t                    liquidity_pool_history_interval()const;
+
+      /// @return whether the buckets which are removed from memory are kept in the market history store
+      bool                        has_market_history_store()const;
+      /// @return the buckets of the market history store whose open time is in [ @p start, @p end ]
+      vector<bucket_object>       get_stored_buckets( asset_id_type base, asset_id_type quote, uint32_t seconds,
+                                                      fc::time_point_sec start, fc::time_point_sec end,
+                                                      uint32_t limit )const;
 
    private:
       std::unique_ptr<detail::market_history_plugin_impl> my;
@@ -421,6 +498,15 @@ FC_REFLECT_DERIVED( graphene::market_history::market_ticker_meta_object, (graphe
                     (rolling_min_order_his_id)(skip_min_order_his_id) )
 FC_REFLECT_DERIVED( graphene::market_history::liquidity_pool_history_object, (graphene::db::object),
                     (pool)(sequence)(time)(op_type)(op) )
+FC_REFLECT_DERIVED( graphene::market_history::liquidity_pool_history_interval_object, (graphene::db::object),
+                    (pool)(seconds)(open)(min_sequence)(max_sequence)(other_count)
+                    (deposit_count)(deposit_amount_a)(deposit_amount_b)(deposit_share_amount)
+                    (withdrawal_count)(withdrawal_amount_a)(withdrawal_amount_b)(withdrawal_share_amount)
+                    (withdrawal_fee_a)(withdrawal_fee_b)
+                    (exchange_a2b_count)(exchange_a2b_amount_a)(exchange_a2b_amount_b)
+                    (exchange_b2a_count)(exchange_b2a_amount_a)(exchange_b2a_amount_b)
+                    (exchange_fee_a)(exchange_fee_b)
+                    (balance_delta_a)(balance_delta_b) )
 FC_REFLECT_DERIVED( graphene::market_history::liquidity_pool_ticker_meta_object, (graphene::db::object),
                     (rolling_min_lp_his_id)(skip_min_lp_his_id) )
 FC_REFLECT_DERIVED( graphene::market_history::liquidity_pool_ticker_object, (graphene::db::object),
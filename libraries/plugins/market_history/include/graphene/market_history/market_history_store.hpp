@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/market_history/market_history_plugin.hpp>
+#include <graphene/chain/mapped_file_view.hpp>
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace graphene { namespace market_history {
+
+/**
+ *  @brief An on-disk store of the buckets which were removed from memory due to history-per-size
+ *
+ *  Each market and bucket size has a file of its own in the directory of the store. A file is a sequence of
+ *  chunks of @ref chunk_buckets buckets which are laid out by column: the open times, then the prices and the
+ *  volumes. An open time of 0 marks an unused slot, the buckets of a file are ordered by open time.
+ *
+ *  Buckets are read through memory mappings of the files, so that ranges of buckets are read without copying
+ *  the files. A bucket which is stored again after a chain reorganization overwrites the previous one if it has
+ *  the same open time and is ignored if it is older than the last bucket of the file otherwise.
+ *
+ *  The store is not thread-safe.
+ */
+class market_history_store
+{
+   public:
+      static constexpr uint32_t chunk_buckets = 1024;
+
+      /// Opens the store in the given directory, or creates it if it does not exist or @p reset is true
+      void open( const fc::path& dir, bool reset );
+      bool is_open()const;
+      void close();
+
+      void store( const bucket_object& bucket );
+      /// @return the buckets of the market and size whose open time is in [ @p start, @p end ], at most @p limit
+      vector<bucket_object> fetch( asset_id_type base, asset_id_type quote, uint32_t seconds,
+                                   fc::time_point_sec start, fc::time_point_sec end, uint32_t limit )const;
+
+   private:
+      typedef std::tuple< uint64_t, uint64_t, uint32_t > series_key;
+      struct series
+      {
+         fc::path                                          file;
+         /// The number of buckets in the file
+         uint64_t                                          size = 0;
+         /// Created on the first read
+         mutable std::unique_ptr<graphene::chain::mapped_file_view> view;
+      };
+
+      series& get_series( asset_id_type base, asset_id_type quote, uint32_t seconds );
+      const series* find_series( asset_id_type base, asset_id_type quote, uint32_t seconds )const;
+      /// @return the open time of the bucket at @p pos of the series
+      uint32_t read_open_time( const series& s, uint64_t pos )const;
+      /// @return the position of the first bucket of the series opened at or after @p time
+      uint64_t lower_bound( const series& s, uint32_t time )const;
+
+      fc::path                          _dir;
+      bool                              _open = false;
+      std::map< series_key, series >    _series;
+};
+
+} } //graphene::market_history
@@ -23,6 +23,7 @@
  */
 
 #include <graphene/market_history/market_history_plugin.hpp>
+#include <graphene/market_history/market_history_store.hpp>
 
 #include <graphene/chain/account_evaluator.hpp>
 #include <graphene/chain/account_object.hpp>
@@ -40,6 +41,8 @@ namespace graphene { namespace market_history {
 namespace detail
 {
 
+struct market_bucket_deltas;
+
 class market_history_plugin_impl
 {
    public:
@@ -51,10 +54,16 @@ class market_history_plugin_impl
        */
       void update_market_histories( const signed_block& b );
 
+      /// apply the maker fills of a block to the buckets of all tracked sizes
+      void apply_bucket_deltas( fc::time_point_sec now, const market_bucket_deltas& deltas );
+
       /// process all operations related to liquidity pools
       void update_liquidity_pool_histories( time_point_sec time, const operation_history_object& oho,
                                             const liquidity_pool_ticker_meta_object*& lp_meta );
 
+      /// removes a rolled out liquidity pool history object, aggregating it first if compaction is enabled
+      void remove_liquidity_pool_history( const liquidity_pool_history_object& his );
+
       graphene::chain::database& database()
       {
          return _self.database();
@@ -63,19 +72,54 @@ class market_history_plugin_impl
       market_history_plugin&     _self;
       flat_set<uint32_t>         _tracked_buckets;
       uint32_t                   _maximum_history_per_bucket_size = 1000;
+      bool                       _store_removed_buckets = false;
+      market_history_store       _store;
       uint32_t                   _max_order_his_records_per_market = 1000;
       uint32_t                   _max_order_his_seconds_per_market = 259200;
+      uint32_t                   _lp_his_compaction_interval = 0;
+      uint32_t                   _max_lp_his_intervals_per_pool = 1000;
+};
+
+
+/// The maker fills of a market in a block, which are applied to the buckets of all sizes at once
+struct market_bucket_delta
+{
+   bucket_key key; ///< the market, the size and open time are set per bucket
+   share_type base_volume;
+   share_type quote_volume;
+   price      open;
+   price      close;
+   price      high;
+   price      low;
 };
 
+/// The bucket deltas of the markets of a block, in the order the markets were first filled in the block
+struct market_bucket_deltas
+{
+   vector<market_bucket_delta>                                  deltas;
+   std::map< std::pair<asset_id_type,asset_id_type>, size_t >   positions;
+};
+
+/// Adds to a volume of a bucket, a volume which would overflow stays at the maximum
+static void add_bucket_volume( share_type& volume, const share_type& amount )
+{
+   try {
+      volume += amount;
+   } catch( fc::overflow_exception& ) {
+      volume = std::numeric_limits<int64_t>::max();
+   }
+}
 
 struct operation_process_fill_order
 {
    market_history_plugin&            _plugin;
    fc::time_point_sec                _now;
    const market_ticker_meta_object*& _meta;
+   market_bucket_deltas&             _bucket_deltas;
 
-   operation_process_fill_order( market_history_plugin& mhp, fc::time_point_sec n, const market_ticker_meta_object*& meta )
-   :_plugin(mhp),_now(n),_meta(meta) {}
+   operation_process_fill_order( market_history_plugin& mhp, fc::time_point_sec n,
+                                 const market_ticker_meta_object*& meta, market_bucket_deltas& bucket_deltas )
+   :_plugin(mhp),_now(n),_meta(meta),_bucket_deltas(bucket_deltas) {}
 
    typedef void result_type;
 
@@ -205,17 +249,50 @@ struct operation_process_fill_order
          });
       }
 
-      // To update buckets data
-      const auto max_history = _plugin.max_history();
-      if( max_history == 0 ) return;
+      // To update buckets data, the fills are aggregated per market and applied once at the end of the block,
+      // since all fills of a block fall into the same bucket of every size
+      if( _plugin.max_history() == 0 || _plugin.tracked_buckets().empty() )
+         return;
 
-      const auto& buckets = _plugin.tracked_buckets();
-      if( buckets.size() == 0 ) return;
+      auto pos_itr = _bucket_deltas.positions.find( std::make_pair( key.base, key.quote ) );
+      if( pos_itr == _bucket_deltas.positions.end() )
+      {
+         _bucket_deltas.positions[ std::make_pair( key.base, key.quote ) ] = _bucket_deltas.deltas.size();
+         market_bucket_delta delta;
+         delta.key = key;
+         delta.base_volume = trade_price.base.amount;
+         delta.quote_volume = trade_price.quote.amount;
+         delta.open = fill_price;
+         delta.close = fill_price;
+         delta.high = fill_price;
+         delta.low = fill_price;
+         _bucket_deltas.deltas.push_back( delta );
+      }
+      else
+      {
+         market_bucket_delta& delta = _bucket_deltas.deltas[ pos_itr->second ];
+         add_bucket_volume( delta.base_volume, trade_price.base.amount );
+         add_bucket_volume( delta.quote_volume, trade_price.quote.amount );
+         delta.close = fill_price;
+         if( delta.high < fill_price )
+            delta.high = fill_price;
+         if( delta.low > fill_price )
+            delta.low = fill_price;
+      }
+   }
+};
 
-      const auto& bucket_idx = db.get_index_type<bucket_index>();
-      for( auto bucket : buckets )
+void market_history_plugin_impl::apply_bucket_deltas( fc::time_point_sec now, const market_bucket_deltas& deltas )
+{
+   graphene::chain::database& db = database();
+   const auto max_history = _maximum_history_per_bucket_size;
+   const auto& by_key_idx = db.get_index_type<bucket_index>().indices().get<by_key>();
+   for( const market_bucket_delta& delta : deltas.deltas )
+   {
+      bucket_key key = delta.key;
+      for( auto bucket : _tracked_buckets )
       {
-          auto bucket_num = _now.sec_since_epoch() / bucket;
+          auto bucket_num = now.sec_since_epoch() / bucket;
           fc::time_point_sec cutoff;
           if( bucket_num > max_history )
              cutoff = cutoff + ( bucket * ( bucket_num - max_history ) );
@@ -223,54 +300,41 @@ struct operation_process_fill_order
           key.seconds = bucket;
           key.open    = fc::time_point_sec() + ( bucket_num * bucket );
 
-          const auto& by_key_idx = bucket_idx.indices().get<by_key>();
           auto bucket_itr = by_key_idx.find( key );
           if( bucket_itr == by_key_idx.end() )
           { // create new bucket
-            /* const auto& obj = */
             db.create<bucket_object>( [&]( bucket_object& b ){
                  b.key = key;
-                 b.base_volume = trade_price.base.amount;
-                 b.quote_volume = trade_price.quote.amount;
-                 b.open_base = fill_price.base.amount;
-                 b.open_quote = fill_price.quote.amount;
-                 b.close_base = fill_price.base.amount;
-                 b.close_quote = fill_price.quote.amount;
-                 b.high_base = b.close_base;
-                 b.high_quote = b.close_quote;
-                 b.low_base = b.close_base;
-                 b.low_quote = b.close_quote;
+                 b.base_volume = delta.base_volume;
+                 b.quote_volume = delta.quote_volume;
+                 b.open_base = delta.open.base.amount;
+                 b.open_quote = delta.open.quote.amount;
+                 b.close_base = delta.close.base.amount;
+                 b.close_quote = delta.close.quote.amount;
+                 b.high_base = delta.high.base.amount;
+                 b.high_quote = delta.high.quote.amount;
+                 b.low_base = delta.low.base.amount;
+                 b.low_quote = delta.low.quote.amount;
             });
-            //wlog( "    creating bucket ${b}", ("b",obj) );
           }
           else
           { // update existing bucket
-             //wlog( "    before updating bucket ${b}", ("b",*bucket_itr) );
              db.modify( *bucket_itr, [&]( bucket_object& b ){
-                  try {
-                     b.base_volume += trade_price.base.amount;
-                  } catch( fc::overflow_exception& ) {
-                     b.base_volume = std::numeric_limits<int64_t>::max();
-                  }
-                  try {
-                     b.quote_volume += trade_price.quote.amount;
-                  } catch( fc::overflow_exception& ) {
-                     b.quote_volume = std::numeric_limits<int64_t>::max();
-                  }
-                  b.close_base = fill_price.base.amount;
-                  b.close_quote = fill_price.quote.amount;
-                  if( b.high() < fill_price )
+                  add_bucket_volume( b.base_volume, delta.base_volume );
+                  add_bucket_volume( b.quote_volume, delta.quote_volume );
+                  b.close_base = delta.close.base.amount;
+                  b.close_quote = delta.close.quote.amount;
+                  if( b.high() < delta.high )
                   {
-                      b.high_base = b.close_base;
-                      b.high_quote = b.close_quote;
+                      b.high_base = delta.high.base.amount;
+                      b.high_quote = delta.high.quote.amount;
                   }
-                  if( b.low() > fill_price )
+                  if( b.low() > delta.low )
                   {
-                      b.low_base = b.close_base;
-                      b.low_quote = b.close_quote;
+                      b.low_base = delta.low.base.amount;
+                      b.low_quote = delta.low.quote.amount;
                   }
              });
-             //wlog( "    after bucket bucket ${b}", ("b",*bucket_itr) );
           }
 
           {
@@ -283,15 +347,16 @@ struct operation_process_fill_order
                     bucket_itr->key.seconds == bucket &&
                     bucket_itr->key.open < cutoff )
              {
-              //  elog( "    removing old bucket ${b}", ("b", *bucket_itr) );
                 auto old_bucket_itr = bucket_itr;
                 ++bucket_itr;
+                if( _store_removed_buckets )
+                   _store.store( *old_bucket_itr );
                 db.remove( *old_bucket_itr );
              }
           }
       }
    }
-};
+}
 
 void market_history_plugin_impl::update_market_histories( const signed_block& b )
 {
@@ -307,6 +372,10 @@ void market_history_plugin_impl::update_market_histories( const signed_block& b
    if( lp_meta_idx.size() > 0 )
       _lp_meta = &( *lp_meta_idx.begin() );
 
+   if( _store_removed_buckets && !_store.is_open() )
+      _store.open( db.get_data_dir() / "market_history", b.block_num() == 1 );
+
+   market_bucket_deltas bucket_deltas;
    const vector<optional< operation_history_object > >& hist = db.get_applied_operations();
    for( const optional< operation_history_object >& o_op : hist )
    {
@@ -315,12 +384,20 @@ void market_history_plugin_impl::update_market_histories( const signed_block& b
          // process market history
          try
          {
-            o_op->op.visit( operation_process_fill_order( _self, b.timestamp, _meta ) );
+            o_op->op.visit( operation_process_fill_order( _self, b.timestamp, _meta, bucket_deltas ) );
          } FC_CAPTURE_AND_LOG( (o_op) )
          // process liquidity pool history
          update_liquidity_pool_histories( b.timestamp, *o_op, _lp_meta );
       }
    }
+   // update buckets data
+   if( !bucket_deltas.deltas.empty() )
+   {
+      try
+      {
+         apply_bucket_deltas( b.timestamp, bucket_deltas );
+      } FC_CAPTURE_AND_LOG( (b.block_num()) )
+   }
    // roll out expired data from ticker
    if( _meta != nullptr )
    {
@@ -604,7 +681,7 @@ void market_history_plugin_impl::update_liquidity_pool_histories(
                   {
                      auto old_itr = itr;
                      ++itr;
-                     db.remove( *old_itr );
+                     remove_liquidity_pool_history( *old_itr );
                   }
                }
                else
@@ -613,7 +690,7 @@ void market_history_plugin_impl::update_liquidity_pool_histories(
                   {
                      auto old_itr = time_itr;
                      ++time_itr;
-                     db.remove( *old_itr );
+                     remove_liquidity_pool_history( *old_itr );
                   }
                }
             }
@@ -721,6 +798,120 @@ void market_history_plugin_impl::update_liquidity_pool_histories(
 
 } FC_CAPTURE_AND_LOG( (time)(oho) ) }
 
+/// Adds a liquidity pool operation to an interval the same way as to the ticker
+static void add_to_interval( liquidity_pool_history_interval_object& i, const operation_history_object& oho )
+{
+   if( oho.op.is_type< liquidity_pool_deposit_operation >() )
+   {
+      const auto& result = oho.result.get< generic_exchange_operation_result >();
+      i.deposit_count += 1;
+      i.deposit_amount_a += result.paid.front().amount.value;
+      i.deposit_amount_b += result.paid.back().amount.value;
+      i.deposit_share_amount += result.received.front().amount.value;
+      i.balance_delta_a += result.paid.front().amount.value;
+      i.balance_delta_b += result.paid.back().amount.value;
+   }
+   else if( oho.op.is_type< liquidity_pool_withdraw_operation >() )
+   {
+      const auto& op = oho.op.get< liquidity_pool_withdraw_operation >();
+      const auto& result = oho.result.get< generic_exchange_operation_result >();
+      i.withdrawal_count += 1;
+      i.withdrawal_amount_a += result.received.front().amount.value;
+      i.withdrawal_amount_b += result.received.back().amount.value;
+      i.withdrawal_share_amount += op.share_amount.amount.value;
+      i.withdrawal_fee_a += result.fees.front().amount.value;
+      i.withdrawal_fee_b += result.fees.back().amount.value;
+      i.balance_delta_a -= result.received.front().amount.value;
+      i.balance_delta_b -= result.received.back().amount.value;
+   }
+   else if( oho.op.is_type< liquidity_pool_exchange_operation >() )
+   {
+      const auto& op = oho.op.get< liquidity_pool_exchange_operation >();
+      const auto& result = oho.result.get< generic_exchange_operation_result >();
+      auto amount_in = op.amount_to_sell.amount - result.fees.front().amount;
+      auto amount_out = result.received.front().amount + result.fees.at(1).amount;
+      if( op.amount_to_sell.asset_id < op.min_to_receive.asset_id ) // pool got a, paid b
+      {
+         i.exchange_a2b_count += 1;
+         i.exchange_a2b_amount_a += amount_in.value;
+         i.exchange_a2b_amount_b += amount_out.value;
+         i.exchange_fee_b += result.fees.back().amount.value;
+         i.balance_delta_a += amount_in.value;
+         i.balance_delta_b -= amount_out.value;
+      }
+      else // pool got b, paid a
+      {
+         i.exchange_b2a_count += 1;
+         i.exchange_b2a_amount_a += amount_out.value;
+         i.exchange_b2a_amount_b += amount_in.value;
+         i.exchange_fee_a += result.fees.back().amount.value;
+         i.balance_delta_a -= amount_out.value;
+         i.balance_delta_b += amount_in.value;
+      }
+   }
+   else
+      i.other_count += 1;
+}
+
+void market_history_plugin_impl::remove_liquidity_pool_history( const liquidity_pool_history_object& his )
+{
+   auto& db = database();
+   const uint32_t seconds = _lp_his_compaction_interval;
+   if( seconds == 0 || _max_lp_his_intervals_per_pool == 0 )
+   {
+      db.remove( his );
+      return;
+   }
+
+   const liquidity_pool_id_type pool = his.pool;
+   const fc::time_point_sec open( his.time.sec_since_epoch() / seconds * seconds );
+   const auto& interval_idx = db.get_index_type<liquidity_pool_history_interval_index>().indices()
+                                .get<by_pool_open>();
+   auto itr = interval_idx.find( boost::make_tuple( pool, seconds, open ) );
+   if( itr != interval_idx.end() )
+   {
+      db.modify( *itr, [&his]( liquidity_pool_history_interval_object& i ) {
+         i.min_sequence = std::min( i.min_sequence, his.sequence );
+         i.max_sequence = std::max( i.max_sequence, his.sequence );
+         add_to_interval( i, his.op );
+      } );
+      db.remove( his );
+      return;
+   }
+
+   // only the most recent intervals of the pool are kept, counted back from the newest one
+   fc::time_point_sec newest_open = open;
+   auto newest_itr = interval_idx.lower_bound( boost::make_tuple( pool, seconds ) );
+   if( newest_itr != interval_idx.end() && newest_itr->pool == pool && newest_itr->seconds == seconds )
+      newest_open = std::max( newest_open, newest_itr->open );
+   const uint64_t kept_seconds = uint64_t( seconds ) * ( _max_lp_his_intervals_per_pool - 1 );
+   fc::time_point_sec cutoff;
+   if( newest_open.sec_since_epoch() > kept_seconds )
+      cutoff = newest_open - static_cast<uint32_t>( kept_seconds );
+
+   if( open >= cutoff )
+   {
+      db.create<liquidity_pool_history_interval_object>( [&his,seconds,open](
+                                      liquidity_pool_history_interval_object& i ) {
+         i.pool = his.pool;
+         i.seconds = seconds;
+         i.open = open;
+         i.min_sequence = his.sequence;
+         i.max_sequence = his.sequence;
+         add_to_interval( i, his.op );
+      } );
+   }
+   db.remove( his );
+
+   auto old_itr = interval_idx.upper_bound( boost::make_tuple( pool, seconds, cutoff ) );
+   while( old_itr != interval_idx.end() && old_itr->pool == pool && old_itr->seconds == seconds )
+   {
+      auto to_remove = old_itr;
+      ++old_itr;
+      db.remove( *to_remove );
+   }
+}
+
 
 } // end namespace detail
 
@@ -760,6 +951,16 @@ void market_history_plugin::plugin_set_program_options(
            "or those meet the other option, which has more data (default: 259200 (3 days)). "
            "This parameter is reused for liquidity pools as operations in last X seconds per pool in history. "
            "Note: this parameter need to be greater than 24 hours to be able to serve market ticker data correctly.")
+         ("market-history-store", boost::program_options::value<bool>(),
+           "Keep the buckets which are removed from memory due to history-per-size in an on-disk store "
+           "in the data directory and serve them through the history API (default: false)")
+         ("liquidity-pool-history-compaction-interval", boost::program_options::value<uint32_t>(),
+           "Length in seconds of the intervals the operations of a liquidity pool which are removed from its "
+           "history due to max-order-his-records-per-market and max-order-his-seconds-per-market are aggregated "
+           "in, 0 to drop them (default: 0)")
+         ("liquidity-pool-history-intervals-per-pool", boost::program_options::value<uint32_t>(),
+           "How far back in time to keep the aggregated history of each liquidity pool, "
+           "measured in the number of intervals (default: 1000)")
          ;
    cfg.add(cli);
 }
@@ -776,6 +977,7 @@ void market_history_plugin::plugin_initialize(const boost::program_options::vari
    database().add_index< primary_index< liquidity_pool_history_index > >();
    database().add_index< primary_index< simple_index< liquidity_pool_ticker_meta_object > > >();
    database().add_index< primary_index< liquidity_pool_ticker_index, 8 > >(); // 256 pools per chunk
+   database().add_index< primary_index< liquidity_pool_history_interval_index > >();
 
    if( options.count( "bucket-size" ) > 0 )
    {
@@ -789,12 +991,24 @@ void market_history_plugin::plugin_initialize(const boost::program_options::vari
       my->_max_order_his_records_per_market = options["max-order-his-records-per-market"].as<uint32_t>();
    if( options.count( "max-order-his-seconds-per-market" ) > 0 )
       my->_max_order_his_seconds_per_market = options["max-order-his-seconds-per-market"].as<uint32_t>();
+   if( options.count( "market-history-store" ) > 0 )
+      my->_store_removed_buckets = options["market-history-store"].as<bool>();
+   if( options.count( "liquidity-pool-history-compaction-interval" ) > 0 )
+      my->_lp_his_compaction_interval = options["liquidity-pool-history-compaction-interval"].as<uint32_t>();
+   if( options.count( "liquidity-pool-history-intervals-per-pool" ) > 0 )
+      my->_max_lp_his_intervals_per_pool = options["liquidity-pool-history-intervals-per-pool"].as<uint32_t>();
 } FC_CAPTURE_AND_RETHROW() }
 
 void market_history_plugin::plugin_startup()
 {
 }
 
+void market_history_plugin::plugin_shutdown()
+{
+   if( my->_store.is_open() )
+      my->_store.close();
+}
+
 const flat_set<uint32_t>& market_history_plugin::tracked_buckets() const
 {
    return my->_tracked_buckets;
@@ -815,4 +1029,23 @@ uint32_t market_history_plugin::max_order_his_seconds_per_market()const
    return my->_max_order_his_seconds_per_market;
 }
 
+uint32_t market_history_plugin::liquidity_pool_history_interval()const
+{
+   return my->_lp_his_compaction_interval;
+}
+
+bool market_history_plugin::has_market_history_store()const
+{
+   return my->_store_removed_buckets;
+}
+
+vector<bucket_object> market_history_plugin::get_stored_buckets( asset_id_type base, asset_id_type quote,
+                                                                 uint32_t seconds, fc::time_point_sec start,
+                                                                 fc::time_point_sec end, uint32_t limit )const
+{
+   if( !my->_store.is_open() )
+      return {};
+   return my->_store.fetch( base, quote, seconds, start, end, limit );
+}
+
 } }
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/market_history/market_history_store.hpp>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace graphene { namespace market_history {
+
+namespace
+{
+   /// The number of int64 columns of a chunk, they follow the column of the open times
+   constexpr size_t value_columns = 10;
+   constexpr uint64_t chunk_size = market_history_store::chunk_buckets * sizeof(uint32_t)
+                                 + market_history_store::chunk_buckets * sizeof(int64_t) * value_columns;
+   /// The files are mapped in regions of whole chunks, so that a chunk is always contiguous in memory
+   constexpr uint64_t region_chunks = 64;
+   constexpr size_t max_regions = 1024;
+   const char* const file_extension = ".buckets";
+
+   uint64_t time_offset( uint64_t pos )
+   {
+      return ( pos / market_history_store::chunk_buckets ) * chunk_size
+             + ( pos % market_history_store::chunk_buckets ) * sizeof(uint32_t);
+   }
+
+   uint64_t value_offset( uint64_t pos, size_t column )
+   {
+      return ( pos / market_history_store::chunk_buckets ) * chunk_size
+             + market_history_store::chunk_buckets * sizeof(uint32_t)
+             + column * market_history_store::chunk_buckets * sizeof(int64_t)
+             + ( pos % market_history_store::chunk_buckets ) * sizeof(int64_t);
+   }
+
+   /// @return the columns of a bucket, in the order of the file
+   std::array< share_type*, value_columns > columns_of( bucket_object& b )
+   {
+      return { { &b.high_base, &b.high_quote, &b.low_base, &b.low_quote, &b.open_base, &b.open_quote,
+                 &b.close_base, &b.close_quote, &b.base_volume, &b.quote_volume } };
+   }
+}
+
+void market_history_store::open( const fc::path& dir, bool reset )
+{ try {
+   _series.clear();
+   _dir = dir;
+   if( reset )
+      fc::remove_all( dir );
+   fc::create_directories( dir );
+   _open = true;
+
+   for( fc::directory_iterator itr( dir ), end; itr != end; ++itr )
+   {
+      const fc::path file = *itr;
+      if( file.extension() != file_extension )
+         continue;
+      // <base instance>_<quote instance>_<seconds>
+      const std::string name = file.stem().string();
+      const auto first = name.find( '_' );
+      const auto second = name.find( '_', first + 1 );
+      FC_ASSERT( first != std::string::npos && second != std::string::npos, "Unexpected file ${f}", ("f",file) );
+      const series_key key( std::stoull( name.substr( 0, first ) ),
+                            std::stoull( name.substr( first + 1, second - first - 1 ) ),
+                            uint32_t( std::stoul( name.substr( second + 1 ) ) ) );
+
+      series& s = _series[key];
+      s.file = file;
+      const uint64_t chunks = fc::file_size( file ) / chunk_size;
+      if( chunks == 0 )
+         continue;
+      // the last chunk is the only one which can have unused slots, they are at its end
+      s.size = chunks * chunk_buckets;
+      uint64_t low = ( chunks - 1 ) * chunk_buckets;
+      while( low < s.size )
+      {
+         const uint64_t mid = low + ( s.size - low ) / 2;
+         if( read_open_time( s, mid ) == 0 )
+            s.size = mid;
+         else
+            low = mid + 1;
+      }
+   }
+} FC_CAPTURE_AND_RETHROW( (dir)(reset) ) }
+
+bool market_history_store::is_open()const
+{
+   return _open;
+}
+
+void market_history_store::close()
+{
+   _series.clear();
+   _open = false;
+}
+
+market_history_store::series& market_history_store::get_series( asset_id_type base, asset_id_type quote,
+                                                                 uint32_t seconds )
+{
+   const series_key key( base.instance.value, quote.instance.value, seconds );
+   auto itr = _series.find( key );
+   if( itr != _series.end() )
+      return itr->second;
+
+   series& s = _series[key];
+   s.file = _dir / ( std::to_string( std::get<0>( key ) ) + "_" + std::to_string( std::get<1>( key ) ) + "_"
+                     + std::to_string( seconds ) + file_extension );
+   std::ofstream create( s.file.generic_string().c_str(), std::ios::binary | std::ios::trunc );
+   FC_ASSERT( create.good(), "Unable to create ${f}", ("f",s.file) );
+   return s;
+}
+
+const market_history_store::series* market_history_store::find_series( asset_id_type base, asset_id_type quote,
+                                                                       uint32_t seconds )const
+{
+   auto itr = _series.find( series_key( base.instance.value, quote.instance.value, seconds ) );
+   return itr != _series.end() ? &itr->second : nullptr;
+}
+
+uint32_t market_history_store::read_open_time( const series& s, uint64_t pos )const
+{
+   if( !s.view )
+      s.view.reset( new graphene::chain::mapped_file_view( s.file, region_chunks * chunk_size, max_regions ) );
+   uint32_t time = 0;
+   FC_ASSERT( s.view->read( time_offset( pos ), sizeof(time), reinterpret_cast<char*>( &time ) ),
+              "${f} is truncated", ("f",s.file) );
+   return time;
+}
+
+uint64_t market_history_store::lower_bound( const series& s, uint32_t time )const
+{
+   uint64_t low = 0;
+   uint64_t high = s.size;
+   while( low < high )
+   {
+      const uint64_t mid = low + ( high - low ) / 2;
+      if( read_open_time( s, mid ) < time )
+         low = mid + 1;
+      else
+         high = mid;
+   }
+   return low;
+}
+
+void market_history_store::store( const bucket_object& bucket )
+{ try {
+   FC_ASSERT( _open, "The market history store is not open" );
+   series& s = get_series( bucket.key.base, bucket.key.quote, bucket.key.seconds );
+   const uint32_t time = bucket.key.open.sec_since_epoch();
+   FC_ASSERT( time > 0 );
+
+   uint64_t pos = s.size;
+   if( s.size > 0 && read_open_time( s, s.size - 1 ) >= time )
+   {
+      pos = lower_bound( s, time );
+      if( read_open_time( s, pos ) != time )
+         return;
+   }
+
+   std::fstream file( s.file.generic_string().c_str(), std::ios::binary | std::ios::in | std::ios::out );
+   file.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   if( pos == s.size && pos % chunk_buckets == 0 )
+   {
+      // the slots of a new chunk are zero-filled, i.e. unused
+      const vector<char> chunk( chunk_size, 0 );
+      file.seekp( static_cast<std::streamoff>( ( pos / chunk_buckets ) * chunk_size ) );
+      file.write( chunk.data(), chunk.size() );
+   }
+
+   bucket_object copy = bucket;
+   const auto columns = columns_of( copy );
+   for( size_t column = 0; column < value_columns; ++column )
+   {
+      const int64_t value = columns[column]->value;
+      file.seekp( static_cast<std::streamoff>( value_offset( pos, column ) ) );
+      file.write( reinterpret_cast<const char*>( &value ), sizeof(value) );
+   }
+   // the open time marks the slot as used, it is written last
+   file.seekp( static_cast<std::streamoff>( time_offset( pos ) ) );
+   file.write( reinterpret_cast<const char*>( &time ), sizeof(time) );
+   file.flush();
+   file.close();
+
+   if( pos == s.size )
+      ++s.size;
+   if( s.view )
+      s.view->resize( fc::file_size( s.file ) );
+} FC_CAPTURE_AND_RETHROW( (bucket.key) ) }
+
+vector<bucket_object> market_history_store::fetch( asset_id_type base, asset_id_type quote, uint32_t seconds,
+                                                   fc::time_point_sec start, fc::time_point_sec end,
+                                                   uint32_t limit )const
+{ try {
+   vector<bucket_object> result;
+   const series* s = find_series( base, quote, seconds );
+   if( s == nullptr || s->size == 0 || limit == 0 || start > end )
+      return result;
+
+   for( uint64_t pos = lower_bound( *s, start.sec_since_epoch() ); pos < s->size && result.size() < limit; ++pos )
+   {
+      const char* chunk = s->view->data( ( pos / chunk_buckets ) * chunk_size, chunk_size );
+      FC_ASSERT( chunk != nullptr, "${f} is truncated", ("f",s->file) );
+      const uint64_t chunk_start = ( pos / chunk_buckets ) * chunk_size;
+      uint32_t time;
+      std::memcpy( &time, chunk + time_offset( pos ) - chunk_start, sizeof(time) );
+      if( time > end.sec_since_epoch() )
+         break;
+
+      bucket_object b;
+      b.key = bucket_key( base, quote, seconds, fc::time_point_sec( time ) );
+      const auto columns = columns_of( b );
+      for( size_t column = 0; column < value_columns; ++column )
+         std::memcpy( &columns[column]->value, chunk + value_offset( pos, column ) - chunk_start, sizeof(int64_t) );
+      result.push_back( b );
+   }
+   return result;
+} FC_CAPTURE_AND_RETHROW( (base)(quote)(seconds)(start)(end)(limit) ) }
+
+} } //graphene::market_history
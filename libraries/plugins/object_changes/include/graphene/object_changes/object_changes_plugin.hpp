@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/plugin.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+namespace graphene { namespace object_changes {
+   using namespace chain;
+
+/// A change of an object in the binary format of the object changes plugin
+struct object_change
+{
+   enum action_type : uint8_t
+   {
+      created = 0,
+      updated = 1,
+      removed = 2
+   };
+
+   uint8_t          action = created;
+   object_id_type   id;
+   /// The object after the change, or before its removal, serialized with fc::raw
+   vector<char>     data;
+};
+
+/// The object changes of a block in the binary format of the object changes plugin
+struct object_changes_block
+{
+   uint32_t                block_num = 0;
+   block_id_type           block_id;
+   fc::time_point_sec      block_time;
+   vector<object_change>   changes;
+   /// The applied operations of the block, only set for followers, see object-changes-follower-feed
+   vector<operation_history_object> operations;
+   /// The block, only set for followers
+   optional<signed_block>  block;
+};
+
+namespace detail
+{
+    class object_changes_plugin_impl;
+}
+
+/**
+ *  The object changes plugin emits the objects which are created, updated and removed by each block to a sink,
+ *  which is a file, a TCP connection or Elastic Search. The changes can be limited to some object types.
+ *
+ *  The file and the TCP sinks receive one record per block, either as a line of JSON or as an
+ *  @ref object_changes_block serialized with fc::raw and preceded by its size as a 32-bit integer. Elastic Search
+ *  receives one document per change in an index per object type. The changes of several blocks are sent at once
+ *  while the chain is not in sync.
+ *
+ *  A block which is applied again after a chain reorganization is emitted again, consumers keep the last record
+ *  of a block number. Like the es_objects plugin, no changes are emitted while the chain is replayed.
+ *
+ *  With object-changes-follower-feed, the binary records also carry the block and its applied operations, which is
+ *  what the history_follower plugin of another node consumes instead of applying the blocks itself.
+ */
+class object_changes_plugin : public graphene::app::plugin
+{
+   public:
+      explicit object_changes_plugin(graphene::app::application& app);
+      ~object_changes_plugin() override;
+
+      std::string plugin_name()const override;
+      std::string plugin_description()const override;
+      void plugin_set_program_options(
+         boost::program_options::options_description& cli,
+         boost::program_options::options_description& cfg) override;
+      void plugin_initialize(const boost::program_options::variables_map& options) override;
+      void plugin_startup() override;
+      void plugin_shutdown() override;
+
+   private:
+      std::unique_ptr<detail::object_changes_plugin_impl> my;
+};
+
+} } //graphene::object_changes
+
+FC_REFLECT( graphene::object_changes::object_change, (action)(id)(data) )
+FC_REFLECT( graphene::object_changes::object_changes_block, (block_num)(block_id)(block_time)(changes)
+                                                            (operations)(block) )
@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/object_changes/object_changes_plugin.hpp>
+
+#include <graphene/utilities/elasticsearch.hpp>
+#include <graphene/utilities/elasticsearch_bulk_writer.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/network/ip.hpp>
+#include <fc/network/tcp_socket.hpp>
+
+#include <fstream>
+
+namespace graphene { namespace object_changes {
+
+namespace detail
+{
+
+/// Receives the changes of blocks, and sends them on @ref flush
+class object_changes_sink
+{
+   public:
+      virtual ~object_changes_sink() = default;
+
+      /// @param objects the objects of the changes as variants, empty in binary format
+      virtual void add_block( const object_changes_block& block, const fc::variants& objects ) = 0;
+      /// Sends the blocks added since the last call, the last of them is @p last_block_num
+      virtual void flush( uint32_t last_block_num ) = 0;
+};
+
+const char* action_name( uint8_t action )
+{
+   switch( action )
+   {
+      case object_change::created: return "create";
+      case object_change::updated: return "update";
+      default:                     return "remove";
+   }
+}
+
+/// Encodes the blocks as lines of JSON or as sized binary records into a buffer
+class stream_sink : public object_changes_sink
+{
+   public:
+      explicit stream_sink( bool json ) : _json( json ) {}
+
+      void add_block( const object_changes_block& block, const fc::variants& objects ) override
+      {
+         if( _json )
+         {
+            fc::variants changes;
+            changes.reserve( block.changes.size() );
+            for( size_t i = 0; i < block.changes.size(); ++i )
+            {
+               changes.emplace_back( fc::mutable_variant_object()
+                                        ( "action", action_name( block.changes[i].action ) )
+                                        ( "id", block.changes[i].id )
+                                        ( "object", objects[i] ) );
+            }
+            _buffer += fc::json::to_string( fc::mutable_variant_object()
+                                               ( "block_num", block.block_num )
+                                               ( "block_id", block.block_id )
+                                               ( "block_time", block.block_time )
+                                               ( "changes", changes ) );
+            _buffer += '\n';
+         }
+         else
+         {
+            const vector<char> data = fc::raw::pack( block );
+            const uint32_t size = static_cast<uint32_t>( data.size() );
+            _buffer.append( reinterpret_cast<const char*>( &size ), sizeof(size) );
+            _buffer.append( data.data(), data.size() );
+         }
+      }
+
+   protected:
+      const bool    _json;
+      std::string   _buffer;
+};
+
+/// Appends the blocks to a file
+class file_sink : public stream_sink
+{
+   public:
+      file_sink( const fc::path& file, bool json ) : stream_sink( json )
+      {
+         if( file.has_parent_path() )
+            fc::create_directories( file.parent_path() );
+         _file.open( file.generic_string().c_str(), std::ios::binary | std::ios::app );
+         FC_ASSERT( _file.good(), "Unable to open ${f}", ("f",file) );
+      }
+
+      void flush( uint32_t last_block_num ) override
+      {
+         _file.write( _buffer.data(), _buffer.size() );
+         _file.flush();
+         if( !_file.good() )
+            elog( "Unable to write the object changes up to block ${b}", ("b",last_block_num) );
+         _buffer.clear();
+      }
+
+   private:
+      std::ofstream _file;
+};
+
+/// Sends the blocks to a TCP endpoint, reconnecting after failures
+class socket_sink : public stream_sink
+{
+   public:
+      /// The data which is kept while the endpoint is not reachable
+      static constexpr size_t max_buffer_size = 64 * 1024 * 1024;
+
+      socket_sink( const fc::ip::endpoint& endpoint, bool json ) : stream_sink( json ), _endpoint( endpoint ) {}
+
+      void flush( uint32_t last_block_num ) override
+      {
+         try
+         {
+            if( !_socket.is_open() )
+               _socket.connect_to( _endpoint );
+            _socket.write( _buffer.data(), _buffer.size() );
+            _socket.flush();
+            _buffer.clear();
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "Unable to send the object changes up to block ${b} to ${ep}: ${e}",
+                  ("b",last_block_num)("ep",_endpoint)("e",e.to_detail_string()) );
+            _socket.close();
+            if( _buffer.size() > max_buffer_size )
+            {
+               elog( "Dropping ${n} bytes of object changes which could not be sent", ("n",_buffer.size()) );
+               _buffer.clear();
+            }
+         }
+      }
+
+   private:
+      const fc::ip::endpoint _endpoint;
+      fc::tcp_socket         _socket;
+};
+
+/// Indexes each change as a document of Elastic Search, in an index per object type
+class elasticsearch_sink : public object_changes_sink
+{
+   public:
+      elasticsearch_sink( const std::string& url, const std::string& auth, const std::string& index_prefix,
+                          uint32_t connections, const fc::path& dir )
+      : _index_prefix( index_prefix ), _writer( url, auth, connections, 16, dir )
+      {
+         _writer.start();
+      }
+
+      void add_block( const object_changes_block& block, const fc::variants& objects ) override
+      {
+         for( size_t i = 0; i < block.changes.size(); ++i )
+         {
+            const object_id_type id = block.changes[i].id;
+            const std::string document = fc::json::to_string( fc::mutable_variant_object()
+                                                                 ( "block_num", block.block_num )
+                                                                 ( "block_time", block.block_time )
+                                                                 ( "action", action_name( block.changes[i].action ) )
+                                                                 ( "object_id", id )
+                                                                 ( "object", objects[i] ),
+                                                              fc::json::legacy_generator );
+            _body.addIndex( _index_prefix + fc::to_string( id.space() ) + "." + fc::to_string( id.type() ), "data",
+                            fc::to_string( block.block_num ) + "-" + fc::to_string( i ), document );
+         }
+      }
+
+      void flush( uint32_t last_block_num ) override
+      {
+         _writer.push( last_block_num, _body.release() );
+      }
+
+   private:
+      const std::string                 _index_prefix;
+      graphene::utilities::BulkBody     _body;
+      graphene::utilities::ESBulkWriter _writer;
+};
+
+class object_changes_plugin_impl
+{
+   public:
+      explicit object_changes_plugin_impl( object_changes_plugin& _plugin )
+      : _self( _plugin ) {}
+
+      graphene::chain::database& database()
+      {
+         return _self.database();
+      }
+
+      void on_block( const signed_block& b );
+      void on_objects( uint8_t action, const vector<object_id_type>& ids, const vector<const object*>* objs );
+      /// Hands the changes of the current block to the sink
+      void finish_block();
+      bool is_tracked( const object_id_type& id )const
+      {
+         return _types.empty() || _types.find( std::make_pair( id.space(), id.type() ) ) != _types.end();
+      }
+
+      object_changes_plugin&                       _self;
+
+      std::string                                  _sink_name = "file";
+      bool                                         _json = true;
+      bool                                         _follower_feed = false;
+      flat_set< std::pair<uint8_t, uint8_t> >      _types;
+      uint32_t                                     _batch_blocks = 100;
+      fc::path                                     _file;
+      std::string                                  _endpoint;
+      std::string                                  _es_url = "http://localhost:9200/";
+      std::string                                  _es_auth;
+      std::string                                  _es_index_prefix = "object-changes-";
+      uint32_t                                     _es_connections = 2;
+
+      std::unique_ptr<object_changes_sink>         _sink;
+      optional<object_changes_block>               _current;
+      fc::variants                                 _current_objects;
+      uint32_t                                     _unflushed_blocks = 0;
+      uint32_t                                     _last_block_num = 0;
+};
+
+void object_changes_plugin_impl::on_block( const signed_block& b )
+{
+   // the object notifications of a block follow the applied_block notification
+   finish_block();
+   _current = object_changes_block();
+   _current->block_num = b.block_num();
+   _current->block_id = b.id();
+   _current->block_time = b.timestamp;
+   if( _follower_feed )
+   {
+      for( const auto& op : database().get_applied_operations() )
+      {
+         if( op.valid() )
+            _current->operations.push_back( *op );
+      }
+      _current->block = b;
+   }
+}
+
+void object_changes_plugin_impl::on_objects( uint8_t action, const vector<object_id_type>& ids,
+                                             const vector<const object*>* objs )
+{
+   if( !_current.valid() )
+      return;
+   const graphene::chain::database& db = database();
+   for( size_t i = 0; i < ids.size(); ++i )
+   {
+      if( !is_tracked( ids[i] ) )
+         continue;
+      // objects which were removed later in the block are only reported as removed
+      const object* obj = ( objs != nullptr ) ? (*objs)[i] : db.find_object( ids[i] );
+      if( obj == nullptr )
+         continue;
+      object_change change;
+      change.action = action;
+      change.id = ids[i];
+      if( _json )
+         _current_objects.push_back( obj->to_variant() );
+      else
+         change.data = obj->pack();
+      _current->changes.push_back( std::move( change ) );
+   }
+}
+
+void object_changes_plugin_impl::finish_block()
+{
+   if( !_current.valid() || !_sink )
+      return;
+   try
+   {
+      _sink->add_block( *_current, _current_objects );
+      ++_unflushed_blocks;
+      _last_block_num = _current->block_num;
+      // send every block once the chain is in sync
+      if( _unflushed_blocks >= _batch_blocks
+            || ( fc::time_point::now() - fc::time_point( _current->block_time ) ) < fc::seconds(30) )
+      {
+         _sink->flush( _last_block_num );
+         _unflushed_blocks = 0;
+      }
+   } FC_CAPTURE_AND_LOG( (_current->block_num) )
+   _current.reset();
+   _current_objects.clear();
+}
+
+} // end namespace detail
+
+object_changes_plugin::object_changes_plugin(graphene::app::application& app) :
+   plugin(app),
+   my( std::make_unique<detail::object_changes_plugin_impl>(*this) )
+{
+   // Nothing else to do
+}
+
+object_changes_plugin::~object_changes_plugin() = default;
+
+std::string object_changes_plugin::plugin_name()const
+{
+   return "object_changes";
+}
+
+std::string object_changes_plugin::plugin_description()const
+{
+   return "Emits the objects which are created, updated and removed by each block to a file, a TCP endpoint "
+          "or Elastic Search";
+}
+
+void object_changes_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg
+   )
+{
+   cli.add_options()
+         ("object-changes-sink", boost::program_options::value<std::string>(),
+               "Where to emit object changes: file, socket or elasticsearch (file)")
+         ("object-changes-format", boost::program_options::value<std::string>(),
+               "Format of the object changes of the file and socket sinks: json or binary (json)")
+         ("object-changes-types", boost::program_options::value<std::vector<std::string>>()->composing(),
+               "Only emit changes of objects of these types, e.g. 1.2 for accounts (may specify multiple times, "
+               "default: all)")
+         ("object-changes-follower-feed", boost::program_options::value<bool>(),
+               "Whether to add the blocks and their applied operations to the binary records, for history_follower "
+               "nodes. It requires the binary format and all object types (false)")
+         ("object-changes-batch-blocks", boost::program_options::value<uint32_t>(),
+               "Number of blocks whose changes are sent at once while the chain is not in sync (100)")
+         ("object-changes-file", boost::program_options::value<std::string>(),
+               "File which the file sink appends to (object_changes/changes in the data directory)")
+         ("object-changes-socket-endpoint", boost::program_options::value<std::string>(),
+               "IP:port which the socket sink sends to")
+         ("object-changes-es-url", boost::program_options::value<std::string>(),
+               "Elastic Search node url of the elasticsearch sink (http://localhost:9200/)")
+         ("object-changes-es-basic-auth", boost::program_options::value<std::string>(),
+               "Basic auth of the elasticsearch sink ('')")
+         ("object-changes-es-index-prefix", boost::program_options::value<std::string>(),
+               "Prefix of the indexes of the elasticsearch sink, followed by the object type (object-changes-)")
+         ("object-changes-es-connections", boost::program_options::value<uint32_t>(),
+               "Number of connections of the elasticsearch sink (2)")
+         ;
+   cfg.add(cli);
+}
+
+void object_changes_plugin::plugin_initialize(const boost::program_options::variables_map& options)
+{ try {
+   if( options.count("object-changes-sink") > 0 )
+      my->_sink_name = options["object-changes-sink"].as<std::string>();
+   FC_ASSERT( my->_sink_name == "file" || my->_sink_name == "socket" || my->_sink_name == "elasticsearch",
+              "Unknown object changes sink ${s}", ("s",my->_sink_name) );
+   if( options.count("object-changes-format") > 0 )
+   {
+      const std::string format = options["object-changes-format"].as<std::string>();
+      FC_ASSERT( format == "json" || format == "binary", "Unknown object changes format ${f}", ("f",format) );
+      my->_json = ( format == "json" );
+   }
+   FC_ASSERT( my->_json || my->_sink_name != "elasticsearch", "The elasticsearch sink requires the json format" );
+   if( options.count("object-changes-types") > 0 )
+   {
+      for( const std::string& type : options["object-changes-types"].as<std::vector<std::string>>() )
+      {
+         const auto dot = type.find( '.' );
+         FC_ASSERT( dot != std::string::npos, "Invalid object type ${t}", ("t",type) );
+         const auto space_id = std::stoul( type.substr( 0, dot ) );
+         const auto type_id = std::stoul( type.substr( dot + 1 ) );
+         FC_ASSERT( space_id <= 0xff && type_id <= 0xff, "Invalid object type ${t}", ("t",type) );
+         my->_types.insert( std::make_pair( uint8_t( space_id ), uint8_t( type_id ) ) );
+      }
+   }
+   if( options.count("object-changes-follower-feed") > 0 )
+      my->_follower_feed = options["object-changes-follower-feed"].as<bool>();
+   FC_ASSERT( !my->_follower_feed || ( !my->_json && my->_types.empty() && my->_sink_name != "elasticsearch" ),
+              "The follower feed requires the binary format of the file or socket sink and all object types" );
+   if( options.count("object-changes-batch-blocks") > 0 )
+      my->_batch_blocks = std::max<uint32_t>( 1, options["object-changes-batch-blocks"].as<uint32_t>() );
+   if( options.count("object-changes-file") > 0 )
+      my->_file = options["object-changes-file"].as<std::string>();
+   if( options.count("object-changes-socket-endpoint") > 0 )
+      my->_endpoint = options["object-changes-socket-endpoint"].as<std::string>();
+   FC_ASSERT( my->_sink_name != "socket" || !my->_endpoint.empty(),
+              "The socket sink requires object-changes-socket-endpoint" );
+   if( options.count("object-changes-es-url") > 0 )
+      my->_es_url = options["object-changes-es-url"].as<std::string>();
+   if( options.count("object-changes-es-basic-auth") > 0 )
+      my->_es_auth = options["object-changes-es-basic-auth"].as<std::string>();
+   if( options.count("object-changes-es-index-prefix") > 0 )
+      my->_es_index_prefix = options["object-changes-es-index-prefix"].as<std::string>();
+   if( options.count("object-changes-es-connections") > 0 )
+      my->_es_connections = options["object-changes-es-connections"].as<uint32_t>();
+
+   database().applied_block.connect( [this]( const signed_block& b ) {
+      my->on_block( b );
+   } );
+   database().new_objects.connect( [this]( const vector<object_id_type>& ids,
+                                           const flat_set<account_id_type>& ) {
+      my->on_objects( object_change::created, ids, nullptr );
+   } );
+   database().changed_objects.connect( [this]( const vector<object_id_type>& ids,
+                                               const flat_set<account_id_type>& ) {
+      my->on_objects( object_change::updated, ids, nullptr );
+   } );
+   database().removed_objects.connect( [this]( const vector<object_id_type>& ids,
+                                               const vector<const object*>& objs,
+                                               const flat_set<account_id_type>& ) {
+      my->on_objects( object_change::removed, ids, &objs );
+   } );
+} FC_CAPTURE_AND_RETHROW() }
+
+void object_changes_plugin::plugin_startup()
+{
+   const fc::path data_dir = database().get_data_dir() / "object_changes";
+   if( my->_sink_name == "file" )
+      my->_sink = std::make_unique<detail::file_sink>( my->_file == fc::path() ? data_dir / "changes" : my->_file,
+                                                       my->_json );
+   else if( my->_sink_name == "socket" )
+      my->_sink = std::make_unique<detail::socket_sink>( fc::ip::endpoint::from_string( my->_endpoint ),
+                                                         my->_json );
+   else
+      my->_sink = std::make_unique<detail::elasticsearch_sink>( my->_es_url, my->_es_auth, my->_es_index_prefix,
+                                                                my->_es_connections, data_dir );
+   ilog("object_changes: plugin_startup() begin, emitting to the ${s} sink", ("s",my->_sink_name));
+}
+
+void object_changes_plugin::plugin_shutdown()
+{
+   if( !my->_sink )
+      return;
+   // the last block is complete, its object notifications have been received
+   my->finish_block();
+   if( my->_unflushed_blocks > 0 )
+   {
+      try
+      {
+         my->_sink->flush( my->_last_block_num );
+      } FC_CAPTURE_AND_LOG( (my->_last_block_num) )
+      my->_unflushed_blocks = 0;
+   }
+   my->_sink.reset();
+}
+
+} }
@@ -28,6 +28,8 @@
 
 #include <fc/time.hpp>
 
+#include <thread>
+
 namespace graphene { namespace snapshot_plugin {
 
 class snapshot_plugin : public graphene::app::plugin {
@@ -43,13 +45,22 @@ class snapshot_plugin : public graphene::app::plugin {
       ) override;
 
       void plugin_initialize( const boost::program_options::variables_map& options ) override;
+      void plugin_shutdown() override;
 
    private:
        void check_snapshot( const graphene::chain::signed_block& b);
+       /// Copies all objects and writes them in the background, one file per index into the directory dest
+       void create_packed_snapshot();
+       void wait_for_packed_snapshot();
 
        uint32_t           snapshot_block = -1, last_block = 0;
        fc::time_point_sec snapshot_time = fc::time_point_sec::maximum(), last_time = fc::time_point_sec(1);
        fc::path           dest;
+       bool               binary = false;
+       bool               packed = false;
+       bool               compress = false;
+       uint32_t           writer_threads = 4;
+       std::thread        packed_writer;
 };
 
 } } //graphene::snapshot_plugin
@@ -26,6 +26,15 @@
 #include <graphene/chain/database.hpp>
 
 #include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+
+#include <atomic>
+#include <fstream>
+
+#ifdef GRAPHENE_HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 using namespace graphene::snapshot_plugin;
 using std::string;
@@ -36,6 +45,9 @@ namespace bpo = boost::program_options;
 static const char* OPT_BLOCK_NUM  = "snapshot-at-block";
 static const char* OPT_BLOCK_TIME = "snapshot-at-time";
 static const char* OPT_DEST       = "snapshot-to";
+static const char* OPT_FORMAT     = "snapshot-format";
+static const char* OPT_THREADS    = "snapshot-threads";
+static const char* OPT_COMPRESS   = "snapshot-compression";
 
 void snapshot_plugin::plugin_set_program_options(
    boost::program_options::options_description& command_line_options,
@@ -45,6 +57,13 @@ void snapshot_plugin::plugin_set_program_options(
          (OPT_BLOCK_NUM, bpo::value<uint32_t>(), "Block number after which to do a snapshot")
          (OPT_BLOCK_TIME, bpo::value<string>(), "Block time (ISO format) after which to do a snapshot")
          (OPT_DEST, bpo::value<string>(), "Pathname of JSON file where to store the snapshot")
+         (OPT_FORMAT, bpo::value<string>()->default_value("json"),
+          "Format of the snapshot, 'json' for a file with one object per line, 'binary' for a state snapshot "
+          "which a new node can load with load-state-snapshot, or 'packed' for a directory with one file of "
+          "packed objects per index, written in the background")
+         (OPT_THREADS, bpo::value<uint32_t>(), "Number of threads writing a packed snapshot (default: 4)")
+         (OPT_COMPRESS, bpo::value<bool>()->implicit_value(true),
+          "Whether to compress the files of a packed snapshot with zstd (default: false)")
          ;
    config_file_options.add(command_line_options);
 }
@@ -72,6 +91,21 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
          snapshot_block = options[OPT_BLOCK_NUM].as<uint32_t>();
       if( options.count(OPT_BLOCK_TIME) > 0 )
          snapshot_time = fc::time_point_sec::from_iso_string( options[OPT_BLOCK_TIME].as<std::string>() );
+      if( options.count(OPT_FORMAT) > 0 )
+      {
+         const std::string format = options[OPT_FORMAT].as<std::string>();
+         FC_ASSERT( format == "json" || format == "binary" || format == "packed",
+                    "Unknown snapshot-format ${f}", ("f",format) );
+         binary = ( format == "binary" );
+         packed = ( format == "packed" );
+      }
+      if( options.count(OPT_THREADS) > 0 )
+         writer_threads = std::max<uint32_t>( 1, options[OPT_THREADS].as<uint32_t>() );
+      if( options.count(OPT_COMPRESS) > 0 )
+         compress = options[OPT_COMPRESS].as<bool>();
+#ifndef GRAPHENE_HAVE_ZSTD
+      FC_ASSERT( !compress, "Compressed snapshots are not supported by this build" );
+#endif
       database().applied_block.connect( [&]( const graphene::chain::signed_block& b ) {
          check_snapshot( b );
       });
@@ -82,6 +116,21 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
    ilog("snapshot plugin: plugin_initialize() end");
 } FC_LOG_AND_RETHROW() }
 
+static void create_binary_snapshot( const graphene::chain::database& db, const fc::path& dest )
+{
+   ilog("snapshot plugin: creating binary snapshot");
+   try
+   {
+      db.save_state_snapshot( dest );
+   }
+   catch ( fc::exception& e )
+   {
+      wlog( "Failed to create the binary snapshot: ${ex}", ("ex",e) );
+      return;
+   }
+   ilog("snapshot plugin: created binary snapshot");
+}
+
 static void create_snapshot( const graphene::chain::database& db, const fc::path& dest )
 {
    ilog("snapshot plugin: creating snapshot");
@@ -108,19 +157,206 @@ static void create_snapshot( const graphene::chain::database& db, const fc::path
          }
          auto& index = db.get_index( (uint8_t)space_id, (uint8_t)type_id );
          index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
-            out << fc::json::to_string( o.to_variant() ) << '\n';
+            out << o.to_json() << '\n';
          });
       }
    out.close();
    ilog("snapshot plugin: created snapshot");
 }
 
+namespace {
+
+/// The objects of one index, copied at the block of a packed snapshot
+struct index_copy
+{
+   uint8_t                                              space_id = 0;
+   uint8_t                                              type_id  = 0;
+   graphene::db::object_id_type                         next_id;
+   fc::sha256                                           object_version;
+   vector< std::unique_ptr<graphene::db::object> >      objects;
+};
+
+#ifdef GRAPHENE_HAVE_ZSTD
+const int compression_level = 3;
+#endif
+
+/**
+ * Writes the objects like @ref graphene::db::object_database::save_snapshot does, as chunks of at most 1 MiB
+ * followed by their hash and an empty chunk at the end. If compressed, every chunk is a zstd frame, so the
+ * file can be decompressed as a whole e.g. by the zstd tool.
+ */
+void write_index_file( const index_copy& copy, const fc::path& file, bool compress )
+{
+   constexpr size_t objects_per_chunk = 10000;
+   constexpr size_t max_chunk_bytes = 1024 * 1024;
+
+   std::ofstream out( file.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc );
+   FC_ASSERT( out, "Unable to open ${f}", ("f",file) );
+
+   auto write_record = [&out,compress]( const vector<char>& data ) {
+      vector<char> record = fc::raw::pack( data );
+      if( !data.empty() )
+      {
+         const vector<char> hash = fc::raw::pack( fc::sha256::hash( data.data(), data.size() ) );
+         record.insert( record.end(), hash.begin(), hash.end() );
+      }
+#ifdef GRAPHENE_HAVE_ZSTD
+      if( compress )
+      {
+         vector<char> compressed( ZSTD_compressBound( record.size() ) );
+         const size_t size = ZSTD_compress( compressed.data(), compressed.size(), record.data(), record.size(),
+                                            compression_level );
+         FC_ASSERT( !ZSTD_isError( size ), "Failed to compress snapshot: ${e}", ("e",ZSTD_getErrorName( size )) );
+         out.write( compressed.data(), size );
+         return;
+      }
+#endif
+      out.write( record.data(), record.size() );
+   };
+
+   graphene::db::snapshot_chunk chunk;
+   chunk.space_id = copy.space_id;
+   chunk.type_id = copy.type_id;
+   chunk.next_id = copy.next_id;
+   chunk.object_version = copy.object_version;
+   size_t chunk_bytes = 0;
+   bool written = false;
+   for( const auto& obj : copy.objects )
+   {
+      chunk.objects.emplace_back( obj->id, obj->pack() );
+      chunk_bytes += chunk.objects.back().second.size();
+      if( chunk.objects.size() >= objects_per_chunk || chunk_bytes >= max_chunk_bytes )
+      {
+         write_record( fc::raw::pack( chunk ) );
+         chunk.objects.clear();
+         chunk_bytes = 0;
+         written = true;
+      }
+   }
+   // an empty index still gets a chunk to restore its next id
+   if( !written || !chunk.objects.empty() )
+      write_record( fc::raw::pack( chunk ) );
+   write_record( vector<char>() );
+   out.close();
+   FC_ASSERT( out, "Failed to write ${f}", ("f",file) );
+}
+
+} // anonymous namespace
+
+void snapshot_plugin::create_packed_snapshot()
+{
+   const graphene::chain::database& db = database();
+   ilog("snapshot plugin: creating packed snapshot");
+   wait_for_packed_snapshot();
+
+   // the chain continues while the copies are written
+   auto copies = std::make_shared< vector<index_copy> >();
+   for( uint32_t space_id = 0; space_id < 256; space_id++ )
+      for( uint32_t type_id = 0; type_id < 256; type_id++ )
+      {
+         try
+         {
+            db.get_index( (uint8_t)space_id, (uint8_t)type_id );
+         }
+         catch (fc::assert_exception& e)
+         {
+            continue;
+         }
+         const auto& index = db.get_index( (uint8_t)space_id, (uint8_t)type_id );
+         copies->emplace_back();
+         index_copy& copy = copies->back();
+         copy.space_id = (uint8_t)space_id;
+         copy.type_id = (uint8_t)type_id;
+         copy.next_id = index.get_next_id();
+         copy.object_version = index.get_object_version();
+         index.inspect_all_objects( [&copy]( const graphene::db::object& o ) {
+            copy.objects.push_back( o.clone() );
+         });
+      }
+
+   const fc::mutable_variant_object info = fc::mutable_variant_object()
+      ( "chain_id", db.get_chain_id() )
+      ( "block_num", db.head_block_num() )
+      ( "block_id", db.head_block_id() )
+      ( "block_time", db.head_block_time() )
+      ( "compressed", compress );
+   const fc::path dir = dest;
+   const bool compressed = compress;
+   const uint32_t threads = std::min<uint32_t>( writer_threads, std::max<size_t>( copies->size(), 1 ) );
+   ilog( "snapshot plugin: copied ${n} indexes at block ${b}, writing them with ${t} threads",
+         ("n",copies->size())("b",db.head_block_num())("t",threads) );
+
+   packed_writer = std::thread( [copies,info,dir,compressed,threads]() {
+      try
+      {
+         fc::create_directories( dir );
+         std::atomic<size_t> next_index( 0 );
+         std::atomic<bool> failed( false );
+         auto work = [&]() {
+            for( size_t i = next_index++; i < copies->size(); i = next_index++ )
+            {
+               const index_copy& copy = (*copies)[i];
+               const fc::path file = dir / ( fc::to_string( copy.space_id ) + "." + fc::to_string( copy.type_id )
+                                             + ( compressed ? ".zst" : "" ) );
+               try
+               {
+                  write_index_file( copy, file, compressed );
+               }
+               catch( const fc::exception& e )
+               {
+                  wlog( "Failed to write ${f}: ${e}", ("f",file)("e",e.to_detail_string()) );
+                  failed = true;
+               }
+               // release the memory of the copy early
+               (*copies)[i].objects.clear();
+            }
+         };
+         vector<std::thread> workers;
+         for( uint32_t t = 1; t < threads; ++t )
+            workers.emplace_back( work );
+         work();
+         for( auto& worker : workers )
+            worker.join();
+         if( failed )
+         {
+            wlog( "Failed to create the packed snapshot" );
+            return;
+         }
+         // written last, a snapshot without it is incomplete
+         fc::json::save_to_file( fc::variant( info ), dir / "snapshot.json" );
+         ilog( "snapshot plugin: created packed snapshot" );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Failed to create the packed snapshot: ${e}", ("e",e.to_detail_string()) );
+      }
+   } );
+}
+
+void snapshot_plugin::wait_for_packed_snapshot()
+{
+   if( packed_writer.joinable() )
+      packed_writer.join();
+}
+
+void snapshot_plugin::plugin_shutdown()
+{
+   wait_for_packed_snapshot();
+}
+
 void snapshot_plugin::check_snapshot( const graphene::chain::signed_block& b )
 { try {
     uint32_t current_block = b.block_num();
     if( (last_block < snapshot_block && snapshot_block <= current_block)
            || (last_time < snapshot_time && snapshot_time <= b.timestamp) )
-       create_snapshot( database(), dest );
+    {
+       if( binary )
+          create_binary_snapshot( database(), dest );
+       else if( packed )
+          create_packed_snapshot();
+       else
+          create_snapshot( database(), dest );
+    }
     last_block = current_block;
     last_time = b.timestamp;
 } FC_LOG_AND_RETHROW() }
@@ -28,6 +28,8 @@
 
 #include <fc/thread/future.hpp>
 
+#include <list>
+
 namespace graphene { namespace witness_plugin {
 
 namespace block_production_condition
@@ -75,6 +77,10 @@ private:
    void schedule_production_loop();
    block_production_condition::block_production_condition_enum block_production_loop();
    block_production_condition::block_production_condition_enum maybe_produce_block( fc::limited_mutable_variant_object& capture );
+   /// Prepares the transactions of the next block if it is produced by one of our witnesses
+   void maybe_prepare_block_candidate();
+   /// Records when the blocks we produced were first requested by a peer
+   void check_block_requests();
    void add_private_key(const std::string& key_id_to_wif_pair_string);
 
    /// Fetch signing keys of all witnesses in the cache from object database and update the cache accordingly
@@ -82,6 +88,7 @@ private:
 
    boost::program_options::variables_map _options;
    bool _production_enabled = false;
+   bool _prepare_block_candidate = false;
    bool _shutting_down = false;
    uint32_t _required_witness_participation = 33 * GRAPHENE_1_PERCENT;
    uint32_t _production_skip_flags = graphene::chain::database::skip_nothing;
@@ -89,6 +96,8 @@ private:
    std::map<chain::public_key_type, fc::ecc::private_key, chain::pubkey_comparator> _private_keys;
    std::set<chain::witness_id_type> _witnesses;
    fc::future<void> _block_production_task;
+   /// Blocks we produced which no peer has requested yet, with the time they were generated
+   std::list< std::pair<chain::block_id_type, fc::time_point> > _unrequested_blocks;
 
    /// For tracking signing keys of specified witnesses, only update when applied a block
    fc::flat_map< chain::witness_id_type, fc::optional<chain::public_key_type> > _witness_key_cache;
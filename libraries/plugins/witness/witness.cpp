@@ -23,6 +23,8 @@
  */
 #include <graphene/witness/witness.hpp>
 
+#include <graphene/app/block_production_metrics.hpp>
+
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/witness_object.hpp>
 
@@ -81,6 +83,8 @@ void witness_plugin::plugin_set_program_options(
           "Path to a file containing tuples of [PublicKey, WIF private key]."
           " The file has to contain exactly one tuple (i.e. private - public key pair) per line."
           " This option may be specified multiple times, thus multiple files can be provided.")
+         ("prepare-block-candidate", bpo::bool_switch()->notifier([this](bool p){_prepare_block_candidate = p;}),
+               "Apply the pending transactions of the next own block in advance, while waiting for its slot.")
          ;
    config_file_options.add(command_line_options);
 }
@@ -252,6 +256,7 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
    {
       try
       {
+         check_block_requests();
          result = maybe_produce_block(capture);
       }
       catch( const fc::canceled_exception& )
@@ -269,7 +274,8 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
    switch( result )
    {
       case block_production_condition::produced:
-         ilog("Generated block #${n} with ${x} transaction(s) and timestamp ${t} at time ${c}", (capture));
+         ilog("Generated block #${n} with ${x} transaction(s) and timestamp ${t} at time ${c}, "
+              "started ${d}ms after the slot and took ${g}ms", (capture));
          break;
       case block_production_condition::not_synced:
          ilog("Not producing block because production is disabled until we receive a recent block "
@@ -307,6 +313,62 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
    return result;
 }
 
+void witness_plugin::check_block_requests()
+{
+   if( _unrequested_blocks.empty() || p2p_node() == nullptr )
+      return;
+   auto metrics = app().get_options().block_production;
+   const fc::time_point now = fc::time_point::now();
+   for( auto itr = _unrequested_blocks.begin(); itr != _unrequested_blocks.end(); )
+   {
+      fc::time_point first_requested_time;
+      try
+      {
+         first_requested_time = p2p_node()->get_block_propagation_data( itr->first ).first_requested_time;
+      }
+      catch( const fc::key_not_found_exception& )
+      {
+         // the block is no longer cached by the P2P node
+      }
+      if( first_requested_time != fc::time_point() )
+      {
+         const fc::microseconds delay = first_requested_time - itr->second;
+         ilog( "Block ${id} was first requested by a peer ${d}ms after it was generated",
+               ("id",itr->first)("d",delay.count() / 1000) );
+         if( metrics )
+            metrics->set_first_request_time( itr->first, delay );
+         itr = _unrequested_blocks.erase( itr );
+      }
+      else if( now - itr->second > fc::seconds(30) )
+      {
+         wlog( "Block ${id} was not requested by any peer", ("id",itr->first) );
+         itr = _unrequested_blocks.erase( itr );
+      }
+      else
+         ++itr;
+   }
+}
+
+void witness_plugin::maybe_prepare_block_candidate()
+{
+   chain::database& db = database();
+   const chain::witness_id_type next_witness = db.get_scheduled_witness( 1 );
+   if( _witnesses.find( next_witness ) == _witnesses.end() )
+      return;
+   const auto& key = _witness_key_cache[next_witness];
+   if( !key.valid() || _private_keys.find( *key ) == _private_keys.end() )
+      return;
+   try
+   {
+      db.prepare_block_candidate( next_witness, _production_skip_flags );
+   }
+   catch( const fc::exception& e )
+   {
+      // the block will be assembled at its slot time instead
+      wlog( "Failed to prepare the next block: ${e}", ("e",e.to_detail_string()) );
+   }
+}
+
 block_production_condition::block_production_condition_enum witness_plugin::maybe_produce_block(
       fc::limited_mutable_variant_object& capture )
 {
@@ -327,6 +389,8 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    uint32_t slot = db.get_slot_at_time( now );
    if( slot == 0 )
    {
+      if( _prepare_block_candidate )
+         maybe_prepare_block_candidate();
       capture("next_time", db.get_slot_time(1));
       return block_production_condition::not_time_yet;
    }
@@ -381,8 +445,36 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
       private_key_itr->second,
       _production_skip_flags
       );
-   capture("n", block.block_num())("t", block.timestamp)("c", now)("x", block.transactions.size());
-   fc::async( [this,block](){ p2p_node()->broadcast(net::block_message(block)); } );
+   const fc::time_point generated_time = fc::time_point::now();
+   capture("n", block.block_num())("t", block.timestamp)("c", now)("x", block.transactions.size())
+          ("d", ( now_fine - fc::time_point( scheduled_time ) ).count() / 1000)
+          ("g", ( generated_time - now_fine ).count() / 1000);
+
+   auto metrics = app().get_options().block_production;
+   if( metrics )
+   {
+      const chain::block_generation_timings& timings = db.get_last_block_generation_timings();
+      app::block_production_record record;
+      record.block_num = block.block_num();
+      record.block_id = block.id();
+      record.slot_time = scheduled_time;
+      record.wakeup_drift_microseconds = ( now_fine - fc::time_point( scheduled_time ) ).count();
+      record.select_transactions_microseconds = timings.select_transactions.count();
+      record.merkle_root_microseconds = timings.merkle_root.count();
+      record.sign_microseconds = timings.sign.count();
+      record.push_block_microseconds = timings.push_block.count();
+      record.candidate_used = timings.candidate_used;
+      record.transactions = static_cast<uint32_t>( block.transactions.size() );
+      metrics->add_record( record );
+      _unrequested_blocks.emplace_back( record.block_id, generated_time );
+   }
+
+   fc::async( [this,block,metrics](){
+      const fc::time_point start = fc::time_point::now();
+      p2p_node()->broadcast(net::block_message(block));
+      if( metrics )
+         metrics->set_broadcast_time( block.id(), fc::time_point::now() - start );
+   } );
 
    return block_production_condition::produced;
 }
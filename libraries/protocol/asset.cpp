@@ -31,6 +31,25 @@
 namespace graphene { namespace protocol {
       using fc::uint128_t;
 
+      namespace {
+         /**
+          * @return a * b / c, rounded down or up. The 128-bit product is only divided in 128 bits when it does not
+          * fit in 64 bits, which is rare for real amounts and prices and much slower than a 64-bit division.
+          * Negative arguments are converted to 128 bits like before, so that they fail the same checks.
+          */
+         inline uint128_t multiply_and_divide( int64_t a, int64_t b, int64_t c, bool round_up )
+         {
+            const uint128_t product = uint128_t( a ) * b;
+            if( a >= 0 && b >= 0 && c > 0 && static_cast<uint64_t>( product >> 64 ) == 0 )
+            {
+               const uint64_t p64 = static_cast<uint64_t>( product );
+               const uint64_t c64 = static_cast<uint64_t>( c );
+               return round_up ? p64 / c64 + ( p64 % c64 != 0 ? 1 : 0 ) : p64 / c64;
+            }
+            return round_up ? ( ( product + c ) - 1 ) / c : product / c;
+         }
+      }
+
       bool operator == ( const price& a, const price& b )
       {
          if( std::tie( a.base.asset_id, a.quote.asset_id ) != std::tie( b.base.asset_id, b.quote.asset_id ) )
@@ -60,14 +79,14 @@ namespace graphene { namespace protocol {
          if( a.asset_id == b.base.asset_id )
          {
             FC_ASSERT( b.base.amount.value > 0 );
-            uint128_t result = (uint128_t(a.amount.value) * b.quote.amount.value)/b.base.amount.value;
+            uint128_t result = multiply_and_divide( a.amount.value, b.quote.amount.value, b.base.amount.value, false );
             FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
             return asset( static_cast<int64_t>(result), b.quote.asset_id );
          }
          else if( a.asset_id == b.quote.asset_id )
          {
             FC_ASSERT( b.quote.amount.value > 0 );
-            uint128_t result = (uint128_t(a.amount.value) * b.base.amount.value)/b.quote.amount.value;
+            uint128_t result = multiply_and_divide( a.amount.value, b.base.amount.value, b.quote.amount.value, false );
             FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
             return asset( static_cast<int64_t>(result), b.base.asset_id );
          }
@@ -80,16 +99,14 @@ namespace graphene { namespace protocol {
          if( a.asset_id == b.base.asset_id )
          {
             FC_ASSERT( b.base.amount.value > 0 );
-            uint128_t result = ( ( ( uint128_t(a.amount.value) * b.quote.amount.value ) + b.base.amount.value ) - 1 )
-                               / b.base.amount.value;
+            uint128_t result = multiply_and_divide( a.amount.value, b.quote.amount.value, b.base.amount.value, true );
             FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
             return asset( static_cast<int64_t>(result), b.quote.asset_id );
          }
          else if( a.asset_id == b.quote.asset_id )
          {
             FC_ASSERT( b.quote.amount.value > 0 );
-            uint128_t result = ( ( ( uint128_t(a.amount.value) * b.base.amount.value ) + b.quote.amount.value ) - 1 )
-                               / b.quote.amount.value;
+            uint128_t result = multiply_and_divide( a.amount.value, b.base.amount.value, b.quote.amount.value, true );
             FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
             return asset( static_cast<int64_t>(result), b.base.asset_id );
          }
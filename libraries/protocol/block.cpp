@@ -75,28 +75,66 @@ namespace graphene { namespace protocol {
 
       if( 0 == _calculated_merkle_root._hash[0].value() )
       {
-         vector<digest_type> ids;
-         ids.resize( transactions.size() );
-         for( uint32_t i = 0; i < transactions.size(); ++i )
-            ids[i] = transactions[i].merkle_digest();
-
-         vector<digest_type>::size_type current_number_of_hashes = ids.size();
-         while( current_number_of_hashes > 1 )
-         {
-            // hash ID's in pairs
-            uint32_t i_max = current_number_of_hashes - (current_number_of_hashes&1);
-            uint32_t k = 0;
+         merkle_accumulator merkle;
+         for( const auto& trx : transactions )
+            merkle.append( trx.merkle_digest() );
+         _calculated_merkle_root = merkle.root();
+      }
+      return _calculated_merkle_root;
+   }
 
-            for( uint32_t i = 0; i < i_max; i += 2 )
-               ids[k++] = digest_type::hash( std::make_pair( ids[i], ids[i+1] ) );
+   void signed_block::set_merkle_root( const merkle_accumulator& merkle )
+   {
+      FC_ASSERT( merkle.size() == transactions.size(),
+                 "The merkle accumulator holds ${m} digests for ${n} transactions",
+                 ("m", merkle.size())("n", transactions.size()) );
+      transaction_merkle_root = merkle.root();
+      _calculated_merkle_root = transaction_merkle_root;
+   }
 
-            if( current_number_of_hashes&1 )
-               ids[k++] = ids[i_max];
-            current_number_of_hashes = k;
-         }
-         _calculated_merkle_root = checksum_type::hash( ids[0] );
+   void merkle_accumulator::append( const digest_type& transaction_digest )
+   {
+      _subtrees.emplace_back( transaction_digest, 0 );
+      ++_count;
+      // two subtrees of the same height are the pair hashed at that level
+      while( _subtrees.size() > 1 && _subtrees.back().second == _subtrees[_subtrees.size() - 2].second )
+      {
+         const digest_type right = _subtrees.back().first;
+         _subtrees.pop_back();
+         auto& left = _subtrees.back();
+         left.first = digest_type::hash( std::make_pair( left.first, right ) );
+         ++left.second;
       }
-      return _calculated_merkle_root;
+   }
+
+   checksum_type merkle_accumulator::root()const
+   {
+      if( _subtrees.empty() )
+         return checksum_type();
+      // digests which were carried up are hashed with the subtrees on their left, from the lowest level up
+      digest_type result = _subtrees.back().first;
+      for( auto itr = _subtrees.rbegin() + 1; itr != _subtrees.rend(); ++itr )
+         result = digest_type::hash( std::make_pair( itr->first, result ) );
+      return checksum_type::hash( result );
+   }
+
+   uint64_t signed_block::get_packed_size()const
+   {
+      if( _packed_size == 0 )
+         _packed_size = fc::raw::pack_size( *this );
+      return _packed_size;
+   }
+
+   void signed_block::unpack_from( const char* data, size_t size )
+   {
+      fc::datastream<const char*> ds( data, size );
+      fc::raw::unpack( ds, *this );
+      _signee = fc::ecc::public_key();
+      _block_id = block_id_type();
+      _calculated_merkle_root = checksum_type();
+      _packed_size = 0;
+      for( auto& trx : transactions )
+         trx.clear_caches();
    }
 } }
 
@@ -36,9 +36,40 @@ namespace graphene { namespace protocol {
          x.set_which(i);
          result.parameters.insert(x);
       }
+      result.update_index();
       return result;
    }
 
+   void fee_schedule::update_index()
+   {
+      _index.assign( fee_parameters::count(), no_position );
+      uint16_t position = 0;
+      for( const fee_parameters& p : parameters )
+      {
+         if( p.which() >= 0 && static_cast<size_t>( p.which() ) < _index.size() )
+            _index[p.which()] = position;
+         ++position;
+      }
+   }
+
+   const fee_parameters* fee_schedule::find( operation::tag_type which )const
+   {
+      if( which >= 0 && static_cast<size_t>( which ) < _index.size() )
+      {
+         const uint16_t position = _index[which];
+         if( position < parameters.size() )
+         {
+            const fee_parameters& p = *parameters.nth( position );
+            if( p.which() == which )
+               return &p;
+         }
+      }
+      fee_parameters key;
+      key.set_which( which );
+      auto itr = parameters.find( key );
+      return itr != parameters.end() ? &*itr : nullptr;
+   }
+
    const fee_schedule& fee_schedule::get_default()
    {
       static const auto result = get_default_impl();
@@ -58,6 +58,62 @@ namespace graphene { namespace protocol {
       return fee_params.fee + product;
    }
 
+   namespace {
+      class preimage_hasher
+      {
+         const std::vector<char>& data;
+      public:
+         typedef bool result_type;
+
+         explicit preimage_hasher( const std::vector<char>& preimage ) : data( preimage ) {}
+
+         template<typename T>
+         bool operator()( const T& preimage_hash )const
+         {
+            return T::hash( data.data(), (uint32_t) data.size() ) == preimage_hash;
+         }
+      };
+
+      class preimage_digest_matcher
+      {
+         const htlc_preimage_digests& digests;
+      public:
+         typedef bool result_type;
+
+         explicit preimage_digest_matcher( const htlc_preimage_digests& d ) : digests( d ) {}
+
+         bool operator()( const htlc_algo_ripemd160& h )const { return digests.ripemd160 == h; }
+         bool operator()( const htlc_algo_sha1& h )const      { return digests.sha1 == h; }
+         bool operator()( const htlc_algo_sha256& h )const    { return digests.sha256 == h; }
+         bool operator()( const htlc_algo_hash160& h )const   { return digests.hash160 == h; }
+      };
+   }
+
+   void htlc_redeem_operation::precompute_preimage_digests()const
+   {
+      if( _preimage_digests )
+         return;
+      auto digests = std::make_shared<htlc_preimage_digests>();
+      const char* data = preimage.data();
+      const auto size = (uint32_t) preimage.size();
+      digests->ripemd160 = htlc_algo_ripemd160::hash( data, size );
+      digests->sha1      = htlc_algo_sha1::hash( data, size );
+      digests->sha256    = htlc_algo_sha256::hash( data, size );
+      digests->hash160   = htlc_algo_hash160::hash( data, size );
+      _preimage_digests = std::move( digests );
+   }
+
+   bool htlc_redeem_operation::preimage_matches( const htlc_hash& preimage_hash )const
+   {
+      if( _preimage_digests )
+      {
+         const preimage_digest_matcher matcher( *_preimage_digests );
+         return preimage_hash.visit( matcher );
+      }
+      const preimage_hasher hasher( preimage );
+      return preimage_hash.visit( hasher );
+   }
+
    void htlc_extend_operation::validate()const {
       FC_ASSERT( fee.amount >= 0 , "Fee amount should not be negative");
    }
@@ -56,13 +56,47 @@ namespace graphene { namespace protocol {
       mutable block_id_type       _block_id;
    };
 
+   /**
+    * Computes the merkle root of the transactions of a block while they are appended, with the same result as
+    * @ref signed_block::calculate_merkle_root
+    *
+    * The digests are hashed in pairs at every level of the tree, a digest without a partner is carried to the next
+    * level. Only the roots of the complete subtrees are kept, at most one per level, so that appending costs one
+    * hash on average and the root is available after log2(n) more hashes.
+    */
+   class merkle_accumulator
+   {
+   public:
+      void          append( const digest_type& transaction_digest );
+      checksum_type root()const;
+      size_t        size()const { return _count; }
+
+   private:
+      /// roots of the complete subtrees with their heights, from the leftmost and highest one
+      vector< std::pair<digest_type, uint8_t> > _subtrees;
+      size_t                                   _count = 0;
+   };
+
    class signed_block : public signed_block_header
    {
    public:
       const checksum_type& calculate_merkle_root()const;
+      /**
+       * Sets the @ref transaction_merkle_root from @p merkle, which holds the merkle digests of the transactions
+       * of this block, and caches it for @ref calculate_merkle_root
+       */
+      void                 set_merkle_root( const merkle_accumulator& merkle );
+      /// @return the serialized size of the block, it is cached like the merkle root
+      uint64_t             get_packed_size()const;
+      /**
+       * Replaces this block with the one serialized in @p data and drops all cached results. The containers of the
+       * old contents are reused where possible, so that unpacking many blocks into the same object allocates little.
+       */
+      void                 unpack_from( const char* data, size_t size );
       vector<processed_transaction> transactions;
    protected:
       mutable checksum_type   _calculated_merkle_root;
+      mutable uint64_t        _packed_size = 0;
    };
 
 } } // graphene::protocol
@@ -24,6 +24,9 @@
 #pragma once
 #include <graphene/protocol/operations.hpp>
 
+#include <limits>
+#include <vector>
+
 namespace graphene { namespace protocol {
 
    template<typename T> struct transform_to_fee_parameters;
@@ -34,25 +37,31 @@ namespace graphene { namespace protocol {
    };
    using fee_parameters = transform_to_fee_parameters<operation>::type;
 
+   struct fee_schedule;
+
+   /// @return the parameters of type @p Param in the schedule, or null if it has none
+   template<typename Param>
+   const Param* find_fee_parameters( const fee_schedule& schedule );
+
    template<typename Operation>
    class fee_helper {
      public:
-      const typename Operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const typename Operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( typename Operation::fee_parameters_type() );
-         FC_ASSERT( itr != parameters.end() );
-         return itr->template get<typename Operation::fee_parameters_type>();
+         auto p = find_fee_parameters<typename Operation::fee_parameters_type>( schedule );
+         FC_ASSERT( p != nullptr );
+         return *p;
       }
    };
 
    template<>
    class fee_helper<account_create_operation> {
      public:
-      const account_create_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const account_create_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( account_create_operation::fee_parameters_type() );
-         FC_ASSERT( itr != parameters.end() );
-         return itr->get<account_create_operation::fee_parameters_type>();
+         auto p = find_fee_parameters<account_create_operation::fee_parameters_type>( schedule );
+         FC_ASSERT( p != nullptr );
+         return *p;
       }
       typename account_create_operation::fee_parameters_type& get(fee_parameters::flat_set_type& parameters)const
       {
@@ -65,14 +74,14 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<bid_collateral_operation> {
      public:
-      const bid_collateral_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const bid_collateral_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( bid_collateral_operation::fee_parameters_type() );
-         if ( itr != parameters.end() )
-            return itr->get<bid_collateral_operation::fee_parameters_type>();
+         auto p = find_fee_parameters<bid_collateral_operation::fee_parameters_type>( schedule );
+         if ( p != nullptr )
+            return *p;
 
          static bid_collateral_operation::fee_parameters_type bid_collateral_dummy;
-         bid_collateral_dummy.fee = fee_helper<call_order_update_operation>().cget(parameters).fee;
+         bid_collateral_dummy.fee = fee_helper<call_order_update_operation>().cget(schedule).fee;
          return bid_collateral_dummy;
       }
    };
@@ -80,14 +89,14 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<asset_update_issuer_operation> {
      public:
-      const asset_update_issuer_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const asset_update_issuer_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( asset_update_issuer_operation::fee_parameters_type() );
-         if ( itr != parameters.end() )
-            return itr->get<asset_update_issuer_operation::fee_parameters_type>();
+         auto p = find_fee_parameters<asset_update_issuer_operation::fee_parameters_type>( schedule );
+         if ( p != nullptr )
+            return *p;
 
          static asset_update_issuer_operation::fee_parameters_type dummy;
-         dummy.fee = fee_helper<asset_update_operation>().cget(parameters).fee;
+         dummy.fee = fee_helper<asset_update_operation>().cget(schedule).fee;
          return dummy;
       }
    };
@@ -95,14 +104,14 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<asset_claim_pool_operation> {
      public:
-      const asset_claim_pool_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const asset_claim_pool_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( asset_claim_pool_operation::fee_parameters_type() );
-         if ( itr != parameters.end() )
-            return itr->get<asset_claim_pool_operation::fee_parameters_type>();
+         auto p = find_fee_parameters<asset_claim_pool_operation::fee_parameters_type>( schedule );
+         if ( p != nullptr )
+            return *p;
 
          static asset_claim_pool_operation::fee_parameters_type asset_claim_pool_dummy;
-         asset_claim_pool_dummy.fee = fee_helper<asset_fund_fee_pool_operation>().cget(parameters).fee;
+         asset_claim_pool_dummy.fee = fee_helper<asset_fund_fee_pool_operation>().cget(schedule).fee;
          return asset_claim_pool_dummy;
       }
    };
@@ -110,7 +119,7 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<ticket_create_operation> {
      public:
-      const ticket_create_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const ticket_create_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
          static ticket_create_operation::fee_parameters_type param;
          return param;
@@ -120,7 +129,7 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<ticket_update_operation> {
      public:
-      const ticket_update_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const ticket_update_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
          static ticket_update_operation::fee_parameters_type param;
          return param;
@@ -130,11 +139,11 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<htlc_create_operation> {
      public:
-      const htlc_create_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const htlc_create_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( htlc_create_operation::fee_parameters_type() );
-         if ( itr != parameters.end() )
-            return itr->get<htlc_create_operation::fee_parameters_type>();
+         auto p = find_fee_parameters<htlc_create_operation::fee_parameters_type>( schedule );
+         if ( p != nullptr )
+            return *p;
 
          static htlc_create_operation::fee_parameters_type htlc_create_operation_fee_dummy;
          return htlc_create_operation_fee_dummy;
@@ -144,11 +153,11 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<htlc_redeem_operation> {
      public:
-      const htlc_redeem_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const htlc_redeem_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( htlc_redeem_operation::fee_parameters_type() );
-         if ( itr != parameters.end() )
-            return itr->get<htlc_redeem_operation::fee_parameters_type>();
+         auto p = find_fee_parameters<htlc_redeem_operation::fee_parameters_type>( schedule );
+         if ( p != nullptr )
+            return *p;
 
          static htlc_redeem_operation::fee_parameters_type htlc_redeem_operation_fee_dummy;
          return htlc_redeem_operation_fee_dummy;
@@ -157,11 +166,11 @@ namespace graphene { namespace protocol {
    template<>
    class fee_helper<htlc_extend_operation> {
      public:
-      const htlc_extend_operation::fee_parameters_type& cget(const fee_parameters::flat_set_type& parameters)const
+      const htlc_extend_operation::fee_parameters_type& cget(const fee_schedule& schedule)const
       {
-         auto itr = parameters.find( htlc_extend_operation::fee_parameters_type() );
-         if ( itr != parameters.end() )
-            return itr->get<htlc_extend_operation::fee_parameters_type>();
+         auto p = find_fee_parameters<htlc_extend_operation::fee_parameters_type>( schedule );
+         if ( p != nullptr )
+            return *p;
 
          static htlc_extend_operation::fee_parameters_type htlc_extend_operation_fee_dummy;
          return htlc_extend_operation_fee_dummy;
@@ -200,7 +209,7 @@ namespace graphene { namespace protocol {
       template<typename Operation>
       const typename Operation::fee_parameters_type& get()const
       {
-         return fee_helper<Operation>().cget(parameters);
+         return fee_helper<Operation>().cget(*this);
       }
       template<typename Operation>
       typename Operation::fee_parameters_type& get()
@@ -210,19 +219,43 @@ namespace graphene { namespace protocol {
       template<typename Operation>
       bool exists()const
       {
-         auto itr = parameters.find(typename Operation::fee_parameters_type());
-         return itr != parameters.end();
+         return find( fee_parameters::tag<typename Operation::fee_parameters_type>::value ) != nullptr;
       }
 
+      /**
+       *  @return the parameters of the operation type @p which, or null if there are none
+       *
+       *  Uses the positions recorded by @ref update_index and falls back to a search of @ref parameters if they
+       *  are outdated, so that it stays correct when @ref parameters is modified without updating the index.
+       */
+      const fee_parameters* find( operation::tag_type which )const;
+
+      /**
+       *  Records the position of the parameters of every operation type, which turns the lookups of
+       *  @ref calculate_fee into direct accesses. Must be called when @ref parameters changes.
+       */
+      void update_index();
+
       /**
        *  @note must be sorted by fee_parameters.which() and have no duplicates
        */
       fee_parameters::flat_set_type parameters;
       uint32_t                      scale = GRAPHENE_100_PERCENT; ///< fee * scale / GRAPHENE_100_PERCENT
    private:
+      static constexpr uint16_t no_position = std::numeric_limits<uint16_t>::max();
       static fee_schedule get_default_impl();
+
+      /// the position in @ref parameters of the parameters of every operation type, @ref no_position if absent
+      std::vector<uint16_t> _index;
    };
 
+   template<typename Param>
+   const Param* find_fee_parameters( const fee_schedule& schedule )
+   {
+      const fee_parameters* p = schedule.find( fee_parameters::tag<Param>::value );
+      return p != nullptr ? &p->get<Param>() : nullptr;
+   }
+
    using fee_schedule_type = fee_schedule;
 
 } } // graphene::protocol
@@ -28,6 +28,7 @@
 #include <graphene/protocol/asset.hpp>
 #include <graphene/protocol/memo.hpp>
 #include <algorithm> // std::max
+#include <memory>
 
 namespace graphene { namespace protocol {
       typedef fc::ripemd160    htlc_algo_ripemd160;
@@ -42,6 +43,15 @@ namespace graphene { namespace protocol {
          htlc_algo_hash160
       > htlc_hash;
 
+      /// The digests of a preimage with every supported algorithm
+      struct htlc_preimage_digests
+      {
+         htlc_algo_ripemd160 ripemd160;
+         htlc_algo_sha1      sha1;
+         htlc_algo_sha256    sha256;
+         htlc_algo_hash160   hash160;
+      };
+
       struct htlc_create_operation : public base_operation 
       {
          struct fee_parameters_type {
@@ -119,6 +129,22 @@ namespace graphene { namespace protocol {
           * @brief calculates the fee to be paid for this operation
           */
          share_type calculate_fee(const fee_parameters_type& fee_params)const;
+
+         /**
+          * @brief Hashes the preimage with every supported algorithm and caches the digests
+          *
+          * The algorithm is only known from the HTLC object, so this is done for all of them. It is called when
+          * transactions are precomputed, so that the evaluator only needs to compare digests.
+          */
+         void precompute_preimage_digests()const;
+
+         /**
+          * @return whether the preimage generates the given hash, uses the cached digests if they are available
+          */
+         bool preimage_matches( const htlc_hash& preimage_hash )const;
+
+         /// the digests cached by @ref precompute_preimage_digests, not serialized
+         mutable std::shared_ptr<const htlc_preimage_digests> _preimage_digests;
       };
 
       /**
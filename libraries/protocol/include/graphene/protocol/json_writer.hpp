@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/address.hpp>
+#include <graphene/protocol/ext.hpp>
+#include <graphene/protocol/pts_address.hpp>
+#include <graphene/protocol/types.hpp>
+#include <graphene/protocol/vote.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace protocol {
+
+   /**
+    * @class json_writer
+    * @brief Writes values as JSON without building variants for them
+    *
+    * The output is the one of fc::json::to_string( fc::variant( value, max_depth ) ) with the default output format.
+    * Reflected structs, containers, optionals, shared pointers and static variants are written directly, driven by
+    * the FC_REFLECT metadata, so that no variant objects with their allocated keys are built. Strings, enums,
+    * floating point values and all types with a custom to_variant, e.g. object ids, keys and extensions, are small
+    * and are converted through a variant, which keeps their output exactly as fc produces it.
+    */
+   class json_writer
+   {
+      public:
+         explicit json_writer( std::string& out, uint32_t max_depth = GRAPHENE_MAX_NESTED_OBJECTS )
+            : _out( out ), _depth( max_depth ) {}
+
+         template<typename T>
+         void write( const T& value )
+         {
+            write_value( value, kind_of<T>() );
+         }
+
+         void write( bool value ) { _out += value ? "true" : "false"; }
+
+         template<typename T>
+         void write( const fc::safe<T>& value ) { write( value.value ); }
+
+         template<typename T>
+         void write( const fc::optional<T>& value )
+         {
+            if( value.valid() )
+               write( *value );
+            else
+               _out += "null";
+         }
+
+         template<typename T>
+         void write( const std::shared_ptr<T>& value )
+         {
+            if( value )
+               write( *value );
+            else
+               _out += "null";
+         }
+
+         template<typename A, typename B>
+         void write( const std::pair<A, B>& value )
+         {
+            nesting_guard guard( *this );
+            _out += '[';
+            write( value.first );
+            _out += ',';
+            write( value.second );
+            _out += ']';
+         }
+
+         /// fc writes byte vectors as hex strings
+         void write( const std::vector<char>& value ) { write_variant( value ); }
+         template<typename T, typename... A>
+         void write( const std::vector<T, A...>& value ) { write_array( value ); }
+         template<typename T, typename... A>
+         void write( const std::deque<T, A...>& value ) { write_array( value ); }
+         template<typename T, typename... A>
+         void write( const std::set<T, A...>& value ) { write_array( value ); }
+         template<typename T, typename... A>
+         void write( const fc::flat_set<T, A...>& value ) { write_array( value ); }
+         /// maps are written as arrays of [key, value] pairs
+         template<typename K, typename V, typename... A>
+         void write( const std::map<K, V, A...>& value ) { write_array( value ); }
+         template<typename K, typename V, typename... A>
+         void write( const fc::flat_map<K, V, A...>& value ) { write_array( value ); }
+
+         /// static variants are written as [tag, value]
+         template<typename... T>
+         void write( const fc::static_variant<T...>& value )
+         {
+            nesting_guard guard( *this );
+            _out += '[';
+            write_integer( static_cast<int64_t>( value.which() ) );
+            _out += ',';
+            value_visitor visitor{ *this };
+            value.visit( visitor );
+            _out += ']';
+         }
+
+         /// Types which are reflected but have a custom to_variant
+         /// @{
+         void write( const public_key_type& value ) { write_variant( value ); }
+         void write( const address& value ) { write_variant( value ); }
+         void write( const pts_address& value ) { write_variant( value ); }
+         void write( const vote_id_type& value ) { write_variant( value ); }
+         void write( const object_id_type& value ) { write_variant( value ); }
+         template<uint8_t SpaceID, uint8_t TypeID>
+         void write( const graphene::db::object_id<SpaceID, TypeID>& value ) { write_variant( value ); }
+         template<typename T>
+         void write( const extension<T>& value ) { write_variant( value ); }
+         template<typename I, typename E>
+         void write( const fc::enum_type<I, E>& value ) { write_variant( value ); }
+         void write( const fc::unsigned_int& value ) { write_variant( value ); }
+         void write( const fc::signed_int& value ) { write_variant( value ); }
+         /// @}
+
+      private:
+         using integer_kind   = std::integral_constant<int, 0>;
+         using reflected_kind = std::integral_constant<int, 1>;
+         using variant_kind   = std::integral_constant<int, 2>;
+
+         template<typename T>
+         using kind_of = std::integral_constant<int,
+               ( std::is_integral<T>::value && !std::is_same<T, char>::value ) ? integer_kind::value
+               : ( fc::reflector<T>::is_defined::value && !std::is_enum<T>::value ) ? reflected_kind::value
+               : variant_kind::value >;
+
+         /// Decrements the remaining depth while a nested value is written, like the variant conversions do
+         struct nesting_guard
+         {
+            explicit nesting_guard( json_writer& w ) : writer( w )
+            {
+               FC_ASSERT( writer._depth > 0, "Recursion depth exceeded" );
+               --writer._depth;
+            }
+            ~nesting_guard() { ++writer._depth; }
+            json_writer& writer;
+         };
+
+         struct value_visitor
+         {
+            typedef void result_type;
+            json_writer& writer;
+            template<typename T>
+            void operator()( const T& value )const { writer.write( value ); }
+         };
+
+         template<typename T>
+         struct member_visitor
+         {
+            json_writer& writer;
+            const T&     object;
+            mutable bool first;
+
+            template<typename Member, class Class, Member (Class::*member)>
+            void operator()( const char* name )const { write_member( name, object.*member ); }
+
+            /// unset optional members are left out
+            template<typename M>
+            void write_member( const char* name, const fc::optional<M>& value )const
+            {
+               if( value.valid() )
+                  write_member( name, *value );
+            }
+            template<typename M>
+            void write_member( const char* name, const M& value )const
+            {
+               if( !first )
+                  writer._out += ',';
+               first = false;
+               writer._out += '"';
+               writer._out += name;
+               writer._out += "\":";
+               writer.write( value );
+            }
+         };
+
+         template<typename T>
+         void write_value( const T& value, integer_kind )
+         {
+            if( std::is_signed<T>::value )
+               write_integer( static_cast<int64_t>( value ) );
+            else
+               write_unsigned( static_cast<uint64_t>( value ) );
+         }
+
+         template<typename T>
+         void write_value( const T& value, reflected_kind )
+         {
+            nesting_guard guard( *this );
+            _out += '{';
+            member_visitor<T> visitor{ *this, value, true };
+            fc::reflector<T>::visit( visitor );
+            _out += '}';
+         }
+
+         template<typename T>
+         void write_value( const T& value, variant_kind ) { write_variant( value ); }
+
+         template<typename Container>
+         void write_array( const Container& values )
+         {
+            nesting_guard guard( *this );
+            _out += '[';
+            bool first = true;
+            for( const auto& item : values )
+            {
+               if( !first )
+                  _out += ',';
+               first = false;
+               write( item );
+            }
+            _out += ']';
+         }
+
+         template<typename T>
+         void write_variant( const T& value )
+         {
+            _out += fc::json::to_string( fc::variant( value, _depth ), fc::json::stringify_large_ints_and_doubles,
+                                         _depth );
+         }
+
+         /// integers which do not fit in 32 bits are quoted, like fc::json does it
+         void write_integer( int64_t value )
+         {
+            const bool quoted = value > 0xffffffff || value < -int64_t( 0xffffffff );
+            if( quoted )
+               _out += '"';
+            _out += std::to_string( value );
+            if( quoted )
+               _out += '"';
+         }
+         void write_unsigned( uint64_t value )
+         {
+            const bool quoted = value > 0xffffffff;
+            if( quoted )
+               _out += '"';
+            _out += std::to_string( value );
+            if( quoted )
+               _out += '"';
+         }
+
+         std::string& _out;
+         uint32_t     _depth;
+   };
+
+   /// @return the JSON of @p value, see @ref json_writer
+   template<typename T>
+   std::string to_json( const T& value, uint32_t max_depth = GRAPHENE_MAX_NESTED_OBJECTS )
+   {
+      std::string result;
+      json_writer( result, max_depth ).write( value );
+      return result;
+   }
+
+} } // graphene::protocol
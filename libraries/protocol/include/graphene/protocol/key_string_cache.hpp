@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace graphene { namespace protocol {
+
+   /**
+    * @class key_string_cache
+    * @brief A thread-safe cache of the base58 forms of public keys, shared by the whole process
+    *
+    * API responses format the same keys over and over, e.g. the keys of popular accounts, and requests parse them
+    * again. Formatting and parsing both need a base58 conversion and a checksum hash. The cache keeps the string forms
+    * of recently formatted and parsed keys, the least recently used entries are dropped when the cache is full.
+    *
+    * The cache is disabled until a capacity is set, see @ref set_capacity.
+    */
+   class key_string_cache
+   {
+      public:
+         /** @return the cache used by the string conversions of @ref public_key_type */
+         static key_string_cache& instance();
+
+         /** Sets the maximum number of cached keys per direction, 0 disables the cache and drops all entries */
+         void set_capacity( size_t entries );
+         size_t capacity()const;
+         /** @return the number of cached entries of both directions */
+         size_t size()const;
+
+         /** @return true and sets @p result if the string form of @p key is cached */
+         bool find_string( const fc::ecc::public_key_data& key, std::string& result );
+         /** @return true and sets @p result if the key parsed from @p base58str is cached */
+         bool find_key( const std::string& base58str, fc::ecc::public_key_data& result );
+         /**
+          * Caches @p base58str as the formatted string of @p key, for both directions. Does nothing while disabled.
+          */
+         void insert_formatted( const fc::ecc::public_key_data& key, const std::string& base58str );
+         /**
+          * Caches @p key as the result of parsing @p base58str, which must have been parsed successfully. The string
+          * is not used for formatting, it may differ from the formatted one. Does nothing while disabled.
+          */
+         void insert_parsed( const std::string& base58str, const fc::ecc::public_key_data& key );
+
+      private:
+         static constexpr size_t shard_count = 16;
+         static size_t per_shard_capacity( size_t entries ) { return ( entries + shard_count - 1 ) / shard_count; }
+
+         struct key_hash
+         {
+            size_t operator()( const fc::ecc::public_key_data& key )const;
+         };
+
+         /**
+          * The entries of one direction, spread over shards with separate locks by the hash of what is looked up,
+          * so that concurrent lookups rarely wait
+          */
+         template<typename Key, typename Value, typename Hash>
+         class lru_map
+         {
+            public:
+               bool find( const Key& key, Value& result );
+               void insert( const Key& key, const Value& value, size_t per_shard );
+               void shrink( size_t per_shard );
+               size_t size()const;
+
+            private:
+               using lru_list = std::list< std::pair< Key, Value > >;
+               struct shard
+               {
+                  mutable std::mutex                                           mutex;
+                  lru_list                                                     lru;
+                  std::unordered_map< Key, typename lru_list::iterator, Hash > entries;
+               };
+               shard& shard_of( const Key& key ) { return _shards[ ( Hash()( key ) >> 8 ) % shard_count ]; }
+
+               std::array< shard, shard_count > _shards;
+         };
+
+         lru_map< fc::ecc::public_key_data, std::string, key_hash >                _formatted;
+         lru_map< std::string, fc::ecc::public_key_data, std::hash<std::string> > _parsed;
+         std::atomic<size_t>                                                       _capacity { 0 };
+   };
+
+} } // graphene::protocol
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace graphene { namespace protocol {
+
+   /**
+    * @class signature_cache
+    * @brief A thread-safe cache of the public keys recovered from signatures, shared by the whole process
+    *
+    * A transaction usually gets its signatures recovered several times, e.g. when it is received through the API,
+    * when it is received from a peer and when the block which contains it is applied. The keys are cached by digest
+    * and signature, the least recently used entries are dropped when the cache is full.
+    *
+    * The cache is disabled until a capacity is set, see @ref set_capacity.
+    */
+   class signature_cache
+   {
+      public:
+         /** @return the cache used by @ref signed_transaction::get_signature_keys */
+         static signature_cache& instance();
+
+         /** Sets the maximum number of cached keys, 0 disables the cache and drops all entries */
+         void set_capacity( size_t entries );
+         size_t capacity()const;
+         /** @return the number of cached keys */
+         size_t size()const;
+
+         /**
+          * @return the public key which created sig for digest, like fc::ecc::public_key( sig, digest )
+          * @throws if the key can not be recovered, failures are not cached
+          */
+         public_key_type recover( const signature_type& sig, const digest_type& digest );
+
+      private:
+         struct entry_key
+         {
+            digest_type    digest;
+            signature_type signature;
+            bool operator==( const entry_key& other )const
+            { return digest == other.digest && signature == other.signature; }
+         };
+         struct entry_key_hash
+         {
+            size_t operator()( const entry_key& key )const;
+         };
+         using lru_list = std::list< std::pair< entry_key, public_key_type > >;
+
+         /// Entries are spread over shards with separate locks, so that concurrent lookups rarely wait
+         struct shard
+         {
+            mutable std::mutex                                               mutex;
+            lru_list                                                         lru;
+            std::unordered_map< entry_key, lru_list::iterator, entry_key_hash > entries;
+         };
+         static constexpr size_t shard_count = 16;
+
+         std::array< shard, shard_count > _shards;
+         std::atomic<size_t>              _capacity_per_shard { 0 };
+   };
+
+} } // graphene::protocol
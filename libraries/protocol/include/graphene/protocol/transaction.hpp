@@ -124,7 +124,7 @@ namespace graphene { namespace protocol {
 
    protected:
       // Calculate the digest used for signature validation
-      digest_type sig_digest( const chain_id_type& chain_id )const;
+      virtual digest_type sig_digest( const chain_id_type& chain_id )const;
       mutable transaction_id_type _tx_id_buffer;
    };
 
@@ -229,6 +229,10 @@ namespace graphene { namespace protocol {
    /** This represents a signed transaction that will never have its operations,
     *  signatures etc. modified again, after initial creation. It is therefore
     *  safe to cache results from various calls.
+    *
+    *  The transaction is serialized once, the ID, the signature digest, the packed size, the merkle digest and the
+    *  p2p message are all derived from these bytes. The signatures are not part of them, they are appended where
+    *  needed, so that signing does not invalidate the cache.
     */
    class precomputable_transaction : public signed_transaction {
    public:
@@ -241,9 +245,20 @@ namespace graphene { namespace protocol {
       virtual void                             validate()const override;
       virtual const flat_set<public_key_type>& get_signature_keys( const chain_id_type& chain_id )const override;
       virtual uint64_t                         get_packed_size()const override;
+
+      /// @return the serialized @ref transaction, i.e. without the signatures, packed on the first call
+      const std::vector<char>& get_packed_transaction()const;
+      /// @return the whole serialized transaction including the signatures, as @ref fc::raw::pack would return it
+      std::vector<char> get_packed_with_signatures()const;
+      /// Drops all cached results, must be called after the transaction has been overwritten, e.g. by unpacking
+      void clear_caches();
    protected:
+      virtual digest_type sig_digest( const chain_id_type& chain_id )const override;
+
       mutable bool _validated = false;
       mutable uint64_t _packed_size = 0;
+      /// shared by the copies of the transaction, e.g. the ones in blocks and in the pending state
+      mutable std::shared_ptr<const std::vector<char>> _packed_transaction;
    };
 
    /**
@@ -276,6 +291,24 @@ namespace graphene { namespace protocol {
                           const flat_set<account_id_type>& active_approvals = flat_set<account_id_type>(),
                           const flat_set<account_id_type>& owner_approvals = flat_set<account_id_type>() );
 
+   /**
+    * @brief Like @ref verify_authority, but returns whether the authorities are satisfied instead of throwing
+    *
+    * Only FC exceptions are turned into a negative result. The failure is not captured with the operations and
+    * signatures, which makes it cheaper when the result is expected to be negative often, e.g. for proposals which
+    * have not collected all approvals yet.
+    */
+   bool is_authority_satisfied( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                                const std::function<const authority*(account_id_type)>& get_active,
+                                const std::function<const authority*(account_id_type)>& get_owner,
+                                const custom_authority_lookup& get_custom,
+                                bool allow_non_immediate_owner,
+                                bool ignore_custom_operation_required_auths,
+                                uint32_t max_recursion,
+                                bool allow_committee,
+                                const flat_set<account_id_type>& active_approvals,
+                                const flat_set<account_id_type>& owner_approvals );
+
    /**
     *  @brief captures the result of evaluating the operations contained in the transaction
     *
@@ -293,6 +326,9 @@ namespace graphene { namespace protocol {
    {
       processed_transaction( const signed_transaction& trx = signed_transaction() )
          : precomputable_transaction(trx){}
+      /// Keeps the results which are cached by @p trx
+      processed_transaction( const precomputable_transaction& trx )
+         : precomputable_transaction(trx){}
       virtual ~processed_transaction() = default;
 
       vector<operation_result> operation_results;
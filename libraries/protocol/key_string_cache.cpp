@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/protocol/key_string_cache.hpp>
+
+#include <cstring>
+
+namespace graphene { namespace protocol {
+
+key_string_cache& key_string_cache::instance()
+{
+   static key_string_cache cache;
+   return cache;
+}
+
+size_t key_string_cache::key_hash::operator()( const fc::ecc::public_key_data& key )const
+{
+   // the first byte only tells the parity of y, the x coordinate is effectively random
+   uint64_t bits;
+   std::memcpy( &bits, key.data() + 1, sizeof( bits ) );
+   return size_t( bits );
+}
+
+template<typename Key, typename Value, typename Hash>
+bool key_string_cache::lru_map<Key, Value, Hash>::find( const Key& key, Value& result )
+{
+   shard& s = shard_of( key );
+   std::lock_guard<std::mutex> lock( s.mutex );
+   auto itr = s.entries.find( key );
+   if( itr == s.entries.end() )
+      return false;
+   s.lru.splice( s.lru.begin(), s.lru, itr->second );
+   result = itr->second->second;
+   return true;
+}
+
+template<typename Key, typename Value, typename Hash>
+void key_string_cache::lru_map<Key, Value, Hash>::insert( const Key& key, const Value& value, size_t per_shard )
+{
+   shard& s = shard_of( key );
+   std::lock_guard<std::mutex> lock( s.mutex );
+   if( s.entries.find( key ) != s.entries.end() )
+      return;
+   s.lru.emplace_front( key, value );
+   s.entries.emplace( key, s.lru.begin() );
+   while( s.lru.size() > per_shard )
+   {
+      s.entries.erase( s.lru.back().first );
+      s.lru.pop_back();
+   }
+}
+
+template<typename Key, typename Value, typename Hash>
+void key_string_cache::lru_map<Key, Value, Hash>::shrink( size_t per_shard )
+{
+   for( auto& s : _shards )
+   {
+      std::lock_guard<std::mutex> lock( s.mutex );
+      while( s.lru.size() > per_shard )
+      {
+         s.entries.erase( s.lru.back().first );
+         s.lru.pop_back();
+      }
+   }
+}
+
+template<typename Key, typename Value, typename Hash>
+size_t key_string_cache::lru_map<Key, Value, Hash>::size()const
+{
+   size_t result = 0;
+   for( const auto& s : _shards )
+   {
+      std::lock_guard<std::mutex> lock( s.mutex );
+      result += s.lru.size();
+   }
+   return result;
+}
+
+void key_string_cache::set_capacity( size_t entries )
+{
+   _capacity.store( entries, std::memory_order_relaxed );
+   const size_t per_shard = per_shard_capacity( entries );
+   _formatted.shrink( per_shard );
+   _parsed.shrink( per_shard );
+}
+
+size_t key_string_cache::capacity()const
+{
+   return _capacity.load( std::memory_order_relaxed );
+}
+
+size_t key_string_cache::size()const
+{
+   return _formatted.size() + _parsed.size();
+}
+
+bool key_string_cache::find_string( const fc::ecc::public_key_data& key, std::string& result )
+{
+   return capacity() > 0 && _formatted.find( key, result );
+}
+
+bool key_string_cache::find_key( const std::string& base58str, fc::ecc::public_key_data& result )
+{
+   return capacity() > 0 && _parsed.find( base58str, result );
+}
+
+void key_string_cache::insert_formatted( const fc::ecc::public_key_data& key, const std::string& base58str )
+{
+   const size_t per_shard = per_shard_capacity( capacity() );
+   if( per_shard == 0 )
+      return;
+   _formatted.insert( key, base58str, per_shard );
+   _parsed.insert( base58str, key, per_shard );
+}
+
+void key_string_cache::insert_parsed( const std::string& base58str, const fc::ecc::public_key_data& key )
+{
+   const size_t per_shard = per_shard_capacity( capacity() );
+   if( per_shard == 0 )
+      return;
+   _parsed.insert( base58str, key, per_shard );
+}
+
+} } // graphene::protocol
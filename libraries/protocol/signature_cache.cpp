@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/protocol/signature_cache.hpp>
+
+#include <cstring>
+
+namespace graphene { namespace protocol {
+
+signature_cache& signature_cache::instance()
+{
+   static signature_cache cache;
+   return cache;
+}
+
+size_t signature_cache::entry_key_hash::operator()( const entry_key& key )const
+{
+   // both parts are effectively random, a few bytes of each are enough
+   uint64_t sig_bits;
+   std::memcpy( &sig_bits, key.signature.begin() + 1, sizeof( sig_bits ) );
+   return size_t( key.digest._hash[0].value() ^ sig_bits );
+}
+
+void signature_cache::set_capacity( size_t entries )
+{
+   const size_t per_shard = ( entries + shard_count - 1 ) / shard_count;
+   _capacity_per_shard.store( per_shard, std::memory_order_relaxed );
+   for( auto& s : _shards )
+   {
+      std::lock_guard<std::mutex> lock( s.mutex );
+      while( s.lru.size() > per_shard )
+      {
+         s.entries.erase( s.lru.back().first );
+         s.lru.pop_back();
+      }
+   }
+}
+
+size_t signature_cache::capacity()const
+{
+   return _capacity_per_shard.load( std::memory_order_relaxed ) * shard_count;
+}
+
+size_t signature_cache::size()const
+{
+   size_t result = 0;
+   for( const auto& s : _shards )
+   {
+      std::lock_guard<std::mutex> lock( s.mutex );
+      result += s.lru.size();
+   }
+   return result;
+}
+
+public_key_type signature_cache::recover( const signature_type& sig, const digest_type& digest )
+{
+   const size_t per_shard = _capacity_per_shard.load( std::memory_order_relaxed );
+   if( per_shard == 0 )
+      return fc::ecc::public_key( sig, digest );
+
+   entry_key key { digest, sig };
+   const size_t hash = entry_key_hash()( key );
+   shard& s = _shards[ ( hash >> 8 ) % shard_count ];
+   {
+      std::lock_guard<std::mutex> lock( s.mutex );
+      auto itr = s.entries.find( key );
+      if( itr != s.entries.end() )
+      {
+         s.lru.splice( s.lru.begin(), s.lru, itr->second );
+         return itr->second->second;
+      }
+   }
+
+   // recover without holding the lock, another thread may do the same meanwhile
+   public_key_type result = fc::ecc::public_key( sig, digest );
+
+   std::lock_guard<std::mutex> lock( s.mutex );
+   if( s.entries.find( key ) == s.entries.end() )
+   {
+      s.lru.emplace_front( key, result );
+      s.entries.emplace( key, s.lru.begin() );
+      while( s.lru.size() > per_shard )
+      {
+         s.entries.erase( s.lru.back().first );
+         s.lru.pop_back();
+      }
+   }
+   return result;
+}
+
+} } // graphene::protocol
@@ -28,6 +28,7 @@
 #include <graphene/protocol/fee_schedule.hpp>
 #include <graphene/protocol/pts_address.hpp>
 #include <graphene/protocol/restriction_predicate.hpp>
+#include <graphene/protocol/signature_cache.hpp>
 
 #include <fc/io/raw.hpp>
 
@@ -35,8 +36,11 @@ namespace graphene { namespace protocol {
 
 digest_type processed_transaction::merkle_digest()const
 {
+   const std::vector<char>& packed = get_packed_transaction();
    digest_type::encoder enc;
-   fc::raw::pack( enc, *this );
+   enc.write( packed.data(), packed.size() );
+   fc::raw::pack( enc, signatures );
+   fc::raw::pack( enc, operation_results );
    return enc.result();
 }
 
@@ -266,7 +270,7 @@ struct sign_state
 };
 
 
-void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+static void verify_authority_impl( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
                        const std::function<const authority*(account_id_type)>& get_active,
                        const std::function<const authority*(account_id_type)>& get_owner,
                        const custom_authority_lookup& get_custom,
@@ -275,10 +279,9 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
                        uint32_t max_recursion_depth,
                        bool  allow_committee,
                        const flat_set<account_id_type>& active_aprovals,
-                       const flat_set<account_id_type>& owner_approvals )
+                       const flat_set<account_id_type>& owner_approvals,
+                       rejected_predicate_map& rejected_custom_auths )
 {
-   rejected_predicate_map rejected_custom_auths;
-   try {
    flat_set<account_id_type> required_active;
    flat_set<account_id_type> required_owner;
    vector<authority> other;
@@ -291,7 +294,7 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
 
    auto approved_by_custom_authority = [&s, &rejected_custom_auths, get_custom = std::move(get_custom)](
            account_id_type account,
-           operation op ) mutable {
+           const operation& op ) mutable {
       auto viable_custom_auths = get_custom( account, op, &rejected_custom_auths );
       for( const auto& auth : viable_custom_auths )
          if( s.check_authority( &auth ) ) return true;
@@ -344,17 +347,58 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
       tx_irrelevant_sig,
       "Unnecessary signature(s) detected"
       );
+}
+
+void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                       const std::function<const authority*(account_id_type)>& get_active,
+                       const std::function<const authority*(account_id_type)>& get_owner,
+                       const custom_authority_lookup& get_custom,
+                       bool allow_non_immediate_owner,
+                       bool ignore_custom_operation_required_auths,
+                       uint32_t max_recursion_depth,
+                       bool  allow_committee,
+                       const flat_set<account_id_type>& active_aprovals,
+                       const flat_set<account_id_type>& owner_approvals )
+{
+   rejected_predicate_map rejected_custom_auths;
+   try {
+      verify_authority_impl( ops, sigs, get_active, get_owner, get_custom, allow_non_immediate_owner,
+                             ignore_custom_operation_required_auths, max_recursion_depth, allow_committee,
+                             active_aprovals, owner_approvals, rejected_custom_auths );
 } FC_CAPTURE_AND_RETHROW( (rejected_custom_auths)(ops)(sigs) ) }
 
+bool is_authority_satisfied( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                             const std::function<const authority*(account_id_type)>& get_active,
+                             const std::function<const authority*(account_id_type)>& get_owner,
+                             const custom_authority_lookup& get_custom,
+                             bool allow_non_immediate_owner,
+                             bool ignore_custom_operation_required_auths,
+                             uint32_t max_recursion_depth,
+                             bool  allow_committee,
+                             const flat_set<account_id_type>& active_aprovals,
+                             const flat_set<account_id_type>& owner_approvals )
+{
+   rejected_predicate_map rejected_custom_auths;
+   try {
+      verify_authority_impl( ops, sigs, get_active, get_owner, get_custom, allow_non_immediate_owner,
+                             ignore_custom_operation_required_auths, max_recursion_depth, allow_committee,
+                             active_aprovals, owner_approvals, rejected_custom_auths );
+   } catch( const fc::exception& ) {
+      return false;
+   }
+   return true;
+}
+
 
 const flat_set<public_key_type>& signed_transaction::get_signature_keys( const chain_id_type& chain_id )const
 { try {
    auto d = sig_digest( chain_id );
    flat_set<public_key_type> result;
+   signature_cache& cache = signature_cache::instance();
    for( const auto&  sig : signatures )
    {
       GRAPHENE_ASSERT(
-         result.insert( fc::ecc::public_key(sig,d) ).second,
+         result.insert( cache.recover( sig, d ) ).second,
             tx_duplicate_sig,
             "Duplicate Signature detected" );
    }
@@ -431,10 +475,59 @@ set<public_key_type> signed_transaction::minimize_required_signatures(
    return set<public_key_type>( result.begin(), result.end() );
 }
 
+const std::vector<char>& precomputable_transaction::get_packed_transaction()const
+{
+   if( !_packed_transaction )
+   {
+      _packed_transaction = std::make_shared<const std::vector<char>>(
+                                  fc::raw::pack( static_cast<const transaction&>( *this ) ) );
+      _packed_size = _packed_transaction->size();
+   }
+   return *_packed_transaction;
+}
+
+std::vector<char> precomputable_transaction::get_packed_with_signatures()const
+{
+   const std::vector<char>& packed = get_packed_transaction();
+   std::vector<char> result;
+   result.reserve( packed.size() + fc::raw::pack_size( signatures ) );
+   result.insert( result.end(), packed.begin(), packed.end() );
+   const std::vector<char> packed_signatures = fc::raw::pack( signatures );
+   result.insert( result.end(), packed_signatures.begin(), packed_signatures.end() );
+   return result;
+}
+
+void precomputable_transaction::clear_caches()
+{
+   _tx_id_buffer = transaction_id_type();
+   _signees.clear();
+   _validated = false;
+   _packed_size = 0;
+   _packed_transaction.reset();
+   for( const auto& op : operations )
+   {
+      if( op.is_type<htlc_redeem_operation>() )
+         op.get<htlc_redeem_operation>()._preimage_digests.reset();
+   }
+}
+
+digest_type precomputable_transaction::sig_digest( const chain_id_type& chain_id )const
+{
+   const std::vector<char>& packed = get_packed_transaction();
+   digest_type::encoder enc;
+   fc::raw::pack( enc, chain_id );
+   enc.write( packed.data(), packed.size() );
+   return enc.result();
+}
+
 const transaction_id_type& precomputable_transaction::id()const
 {
    if( 0 == _tx_id_buffer._hash[0].value() )
-      transaction::id();
+   {
+      const std::vector<char>& packed = get_packed_transaction();
+      auto h = digest_type::hash( packed.data(), packed.size() );
+      memcpy(_tx_id_buffer._hash, h._hash, std::min(sizeof(_tx_id_buffer), sizeof(h)));
+   }
    return _tx_id_buffer;
 }
 
@@ -448,7 +541,7 @@ void precomputable_transaction::validate() const
 uint64_t precomputable_transaction::get_packed_size()const
 {
    if( _packed_size == 0 )
-      _packed_size = transaction::get_packed_size();
+      get_packed_transaction();
    return _packed_size;
 }
 
@@ -24,6 +24,7 @@
 
 #include <graphene/protocol/types.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
+#include <graphene/protocol/key_string_cache.hpp>
 
 #include <fc/crypto/base58.hpp>
 #include <fc/crypto/ripemd160.hpp>
@@ -44,6 +45,9 @@ namespace graphene { namespace protocol {
     {
       // TODO:  Refactor syntactic checks into static is_valid()
       //        to make public_key_type API more similar to address API
+       key_string_cache& cache = key_string_cache::instance();
+       if( cache.find_key( base58str, key_data ) )
+          return;
        std::string prefix( GRAPHENE_ADDRESS_PREFIX );
        const size_t prefix_len = prefix.size();
        FC_ASSERT( base58str.size() > prefix_len );
@@ -52,6 +56,7 @@ namespace graphene { namespace protocol {
        auto bin_key = fc::raw::unpack<binary_key>(bin);
        key_data = bin_key.data;
        FC_ASSERT( fc::ripemd160::hash( (char*) key_data.data(), key_data.size() )._hash[0].value() == bin_key.check );
+       cache.insert_parsed( base58str, key_data );
     };
 
     public_key_type::operator fc::ecc::public_key_data() const
@@ -66,11 +71,17 @@ namespace graphene { namespace protocol {
 
     public_key_type::operator std::string() const
     {
+       key_string_cache& cache = key_string_cache::instance();
+       std::string result;
+       if( cache.find_string( key_data, result ) )
+          return result;
        binary_key k;
        k.data = key_data;
        k.check = fc::ripemd160::hash( (char*) k.data.data(), k.data.size() )._hash[0].value();
        auto data = fc::raw::pack( k );
-       return GRAPHENE_ADDRESS_PREFIX + fc::to_base58( data.data(), data.size() );
+       result = GRAPHENE_ADDRESS_PREFIX + fc::to_base58( data.data(), data.size() );
+       cache.insert_formatted( key_data, result );
+       return result;
     }
 
     bool operator == ( const public_key_type& p1, const fc::ecc::public_key& p2)
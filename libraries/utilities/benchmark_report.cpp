@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/utilities/benchmark_report.hpp>
+#include <graphene/utilities/git_revision.hpp>
+
+#include <fc/git_revision.hpp>
+#include <fc/io/json.hpp>
+#include <fc/time.hpp>
+
+#include <boost/asio/ip/host_name.hpp>
+#include <boost/config.hpp>
+
+#include <thread>
+
+namespace graphene { namespace utilities {
+
+benchmark_report::benchmark_report( const std::string& benchmark ) : _benchmark( benchmark ) {}
+
+void benchmark_report::set_parameter( const std::string& name, const fc::variant& value )
+{
+   _parameters[name] = value;
+}
+
+void benchmark_report::add( const std::string& name, double value, const std::string& unit, bool lower_is_better )
+{
+   fc::mutable_variant_object result;
+   result( "name", name )( "value", value )( "unit", unit )( "lower_is_better", lower_is_better );
+   for( fc::variant& existing : _results )
+      if( existing.get_object()["name"].as_string() == name )
+      {
+         existing = fc::variant_object( std::move( result ) );
+         return;
+      }
+   _results.emplace_back( fc::variant_object( std::move( result ) ) );
+}
+
+fc::variant_object benchmark_report::to_variant()const
+{
+   fc::mutable_variant_object report;
+   report( "format", 1 )
+         ( "benchmark", _benchmark )
+         ( "environment", environment() )
+         ( "parameters", fc::variant_object( _parameters ) )
+         ( "results", _results );
+   return report;
+}
+
+void benchmark_report::save( const fc::path& file )const
+{
+   fc::json::save_to_file( fc::variant( to_variant() ), file );
+}
+
+fc::variant_object benchmark_report::environment()
+{
+   std::string host;
+   try
+   {
+      host = boost::asio::ip::host_name();
+   }
+   catch( const std::exception& )
+   {
+      // the host name only helps to spot runs on different machines
+   }
+
+   fc::mutable_variant_object env;
+   env( "time", fc::time_point_sec( fc::time_point::now() ).to_iso_string() )
+      ( "git_revision", git_revision_sha )
+      ( "git_revision_time", fc::time_point_sec( git_revision_unix_timestamp ).to_iso_string() )
+      ( "git_description", git_revision_description )
+      ( "fc_revision", fc::git_revision_sha )
+      ( "compiler", BOOST_COMPILER )
+      ( "platform", BOOST_PLATFORM )
+#ifdef NDEBUG
+      ( "build_type", "release" )
+#else
+      ( "build_type", "debug" )
+#endif
+      ( "host", host )
+      ( "cpu_threads", std::thread::hardware_concurrency() );
+   return env;
+}
+
+} } // graphene::utilities
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/utilities/download.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <curl/curl.h>
+
+#include <fstream>
+#include <memory>
+
+namespace graphene { namespace utilities {
+
+namespace {
+
+size_t write_to_file( void* contents, size_t size, size_t nmemb, void* userp )
+{
+   std::ofstream& out = *static_cast<std::ofstream*>( userp );
+   out.write( static_cast<const char*>( contents ), size * nmemb );
+   // a short count lets curl abort the transfer
+   return out ? size * nmemb : 0;
+}
+
+} // anonymous namespace
+
+void download_file( const std::string& url, const fc::path& file )
+{ try {
+   std::ofstream out( file.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc );
+   FC_ASSERT( out, "Unable to open ${f}", ("f",file) );
+
+   std::unique_ptr<CURL, void(*)(CURL*)> curl( curl_easy_init(), curl_easy_cleanup );
+   FC_ASSERT( curl != nullptr, "Unable to initialize curl" );
+   curl_easy_setopt( curl.get(), CURLOPT_URL, url.c_str() );
+   curl_easy_setopt( curl.get(), CURLOPT_FOLLOWLOCATION, 1L );
+   curl_easy_setopt( curl.get(), CURLOPT_FAILONERROR, 1L );
+   curl_easy_setopt( curl.get(), CURLOPT_WRITEFUNCTION, write_to_file );
+   curl_easy_setopt( curl.get(), CURLOPT_WRITEDATA, static_cast<void*>( &out ) );
+   const CURLcode result = curl_easy_perform( curl.get() );
+   FC_ASSERT( result == CURLE_OK, "Download failed: ${e}", ("e",curl_easy_strerror( result )) );
+
+   out.close();
+   FC_ASSERT( out, "Failed to write ${f}", ("f",file) );
+} FC_CAPTURE_AND_RETHROW( (url)(file) ) }
+
+} } // graphene::utilities
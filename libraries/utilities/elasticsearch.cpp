@@ -63,22 +63,112 @@ const std::string simpleQuery(ES& es)
 
 bool SendBulk(ES&& es)
 {
-   std::string bulking = joinBulkLines(es.bulk_lines);
+   return SendBulkBody(es, joinBulkLines(es.bulk_lines));
+}
 
+bool SendBulkBody(ES& es, const std::string& body)
+{
    graphene::utilities::CurlRequest curl_request;
    curl_request.handler = es.curl;
    curl_request.url = es.elasticsearch_url + "_bulk";
    curl_request.auth = es.auth;
    curl_request.type = "POST";
-   curl_request.query = std::move(bulking);
 
-   auto curlResponse = doCurl(curl_request);
+   auto curlResponse = doCurl(curl_request, &body);
 
    if(handleBulkResponse(getResponseCode(curl_request.handler), curlResponse))
       return true;
    return false;
 }
 
+void BulkBody::appendString(const std::string& s)
+{
+   static const char* const hex = "0123456789abcdef";
+   _buffer += '"';
+   for(const char c : s)
+   {
+      switch(c)
+      {
+         case '"':  _buffer += "\\\""; break;
+         case '\\': _buffer += "\\\\"; break;
+         case '\n': _buffer += "\\n"; break;
+         case '\r': _buffer += "\\r"; break;
+         case '\t': _buffer += "\\t"; break;
+         default:
+            if(static_cast<unsigned char>(c) < 0x20)
+            {
+               _buffer += "\\u00";
+               _buffer += hex[(c >> 4) & 0x0f];
+               _buffer += hex[c & 0x0f];
+            }
+            else
+               _buffer += c;
+      }
+   }
+   _buffer += '"';
+}
+
+void BulkBody::addIndex(const std::string& index, const std::string& type, const std::string& id,
+                        const std::string& document)
+{
+   _buffer += "{\"index\":{\"_index\":";
+   appendString(index);
+   _buffer += ",\"_type\":";
+   appendString(type);
+   if(!id.empty())
+   {
+      _buffer += ",\"_id\":";
+      appendString(id);
+   }
+   _buffer += "}}\n";
+   _buffer += document;
+   _buffer += '\n';
+   _lines += 2;
+}
+
+void BulkBody::addDelete(const std::string& index, const std::string& type, const std::string& id)
+{
+   _buffer += "{\"delete\":{\"_id\":";
+   appendString(id);
+   _buffer += ",\"_index\":";
+   appendString(index);
+   _buffer += ",\"_type\":";
+   appendString(type);
+   _buffer += "}}\n";
+   ++_lines;
+}
+
+void BulkBody::append(const BulkBody& other)
+{
+   _buffer += other._buffer;
+   _lines += other._lines;
+}
+
+std::string BulkBody::head(size_t count)const
+{
+   size_t end = 0;
+   for(size_t i = 0; i < count && end < _buffer.size(); ++i)
+   {
+      end = _buffer.find('\n', end);
+      end = (end == std::string::npos) ? _buffer.size() : end + 1;
+   }
+   return _buffer.substr(0, end);
+}
+
+void BulkBody::clear()
+{
+   _buffer.clear();
+   _lines = 0;
+}
+
+std::string BulkBody::release()
+{
+   std::string result = std::move(_buffer);
+   _buffer = std::string();
+   _lines = 0;
+   return result;
+}
+
 const std::string joinBulkLines(const std::vector<std::string>& bulk)
 {
    auto bulking = boost::algorithm::join(bulk, "\n");
@@ -164,8 +254,9 @@ const std::string generateIndexName(const fc::time_point_sec& block_date, const
    return index_name;
 }
 
-const std::string doCurl(CurlRequest& curl)
+const std::string doCurl(CurlRequest& curl, const std::string* body)
 {
+   const std::string& query = (body != nullptr) ? *body : curl.query;
    std::string CurlReadBuffer;
    struct curl_slist *headers = NULL;
    headers = curl_slist_append(headers, "Content-Type: application/json");
@@ -179,11 +270,13 @@ const std::string doCurl(CurlRequest& curl)
    {
       curl_easy_setopt(curl.handler, CURLOPT_HTTPGET, false);
       curl_easy_setopt(curl.handler, CURLOPT_POST, true);
-      curl_easy_setopt(curl.handler, CURLOPT_POSTFIELDS, curl.query.c_str());
+      curl_easy_setopt(curl.handler, CURLOPT_POSTFIELDS, query.c_str());
+      curl_easy_setopt(curl.handler, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)query.size());
    }
    else // GET or DELETE (only these are used in this file)
    {
       curl_easy_setopt(curl.handler, CURLOPT_POSTFIELDS, NULL);
+      curl_easy_setopt(curl.handler, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)-1);
       curl_easy_setopt(curl.handler, CURLOPT_POST, false);
       curl_easy_setopt(curl.handler, CURLOPT_HTTPGET, true);
    }
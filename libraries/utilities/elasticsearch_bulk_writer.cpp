@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/utilities/elasticsearch_bulk_writer.hpp>
+#include <graphene/utilities/elasticsearch.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace graphene { namespace utilities {
+
+namespace
+{
+   const char* const checkpoint_filename = "checkpoint";
+   const char* const pending_filename = "pending";
+   constexpr long poll_milliseconds = 100;
+   constexpr uint32_t max_backoff_seconds = 60;
+}
+
+ESBulkWriter::ESBulkWriter( const std::string& url, const std::string& auth, uint32_t connections,
+                            uint32_t queue_size, const fc::path& dir )
+: _url( url + "_bulk" ),
+  _auth( auth ),
+  _connections( std::max<uint32_t>( connections, 1 ) ),
+  _queue_size( std::max<uint32_t>( queue_size, 1 ) ),
+  _dir( dir )
+{
+}
+
+ESBulkWriter::~ESBulkWriter()
+{
+   try {
+      stop();
+   } catch( const fc::exception& e ) {
+      elog( "Failed to stop the Elastic Search bulk writer: ${e}", ("e",e.to_detail_string()) );
+   } catch( const std::exception& e ) {
+      elog( "Failed to stop the Elastic Search bulk writer: ${e}", ("e",e.what()) );
+   }
+}
+
+void ESBulkWriter::start()
+{ try {
+   FC_ASSERT( !_worker.joinable(), "The Elastic Search bulk writer is already running" );
+   fc::create_directories( _dir );
+
+   std::ifstream checkpoint( (_dir / checkpoint_filename).generic_string().c_str() );
+   if( checkpoint.good() )
+      checkpoint >> _last_acknowledged_block;
+   loadPending();
+   if( !_queue.empty() )
+      ilog( "Sending ${n} bulk requests to Elastic Search which were not acknowledged before the last shutdown",
+            ("n",_queue.size()) );
+
+   _worker = std::thread( [this]() { run(); } );
+} FC_CAPTURE_AND_RETHROW( (_dir) ) }
+
+void ESBulkWriter::stop()
+{
+   if( !_worker.joinable() )
+      return;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stopping = true;
+   }
+   _ready.notify_one();
+   _space.notify_all();
+   _worker.join();
+   _stopping = false;
+}
+
+void ESBulkWriter::push( uint32_t block_num, std::string&& body )
+{
+   if( body.empty() )
+      return;
+   batch b;
+   b.block_num = block_num;
+   b.body = std::move( body );
+
+   std::unique_lock<std::mutex> lock( _mutex );
+   _space.wait( lock, [this]() { return _stopping || _queue.size() < _queue_size; } );
+   b.sequence = _next_sequence++;
+   _queue.push_back( std::move( b ) );
+   lock.unlock();
+   _ready.notify_one();
+}
+
+uint32_t ESBulkWriter::lastAcknowledgedBlock()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _last_acknowledged_block;
+}
+
+void ESBulkWriter::acknowledge( const batch& b )
+{
+   uint32_t checkpoint = 0;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _acknowledged[b.sequence] = b.block_num;
+      while( !_acknowledged.empty() && _acknowledged.begin()->first == _next_acknowledged )
+      {
+         checkpoint = std::max( _last_acknowledged_block, _acknowledged.begin()->second );
+         _last_acknowledged_block = checkpoint;
+         _acknowledged.erase( _acknowledged.begin() );
+         ++_next_acknowledged;
+      }
+   }
+   if( checkpoint == 0 )
+      return;
+   std::ofstream file( (_dir / checkpoint_filename).generic_string().c_str(), std::ios::trunc );
+   file << checkpoint;
+   if( !file.good() )
+      wlog( "Unable to save the Elastic Search checkpoint ${b}", ("b",checkpoint) );
+}
+
+void ESBulkWriter::loadPending()
+{
+   const fc::path file = _dir / pending_filename;
+   if( !fc::exists( file ) )
+      return;
+   std::ifstream in( file.generic_string().c_str(), std::ios::binary );
+   while( true )
+   {
+      batch b;
+      uint64_t size = 0;
+      if( !in.read( reinterpret_cast<char*>( &b.block_num ), sizeof(b.block_num) )
+            || !in.read( reinterpret_cast<char*>( &size ), sizeof(size) ) )
+         break;
+      b.body.resize( size );
+      if( !in.read( &b.body[0], size ) )
+      {
+         wlog( "The last pending Elastic Search bulk request in ${f} is truncated", ("f",file) );
+         break;
+      }
+      b.sequence = _next_sequence++;
+      _queue.push_back( std::move( b ) );
+   }
+   in.close();
+   fc::remove( file );
+}
+
+void ESBulkWriter::savePending( std::vector<batch>& batches )
+{
+   if( batches.empty() )
+      return;
+   std::sort( batches.begin(), batches.end(), []( const batch& a, const batch& b ) {
+      return a.sequence < b.sequence;
+   } );
+   const fc::path file = _dir / pending_filename;
+   std::ofstream out( file.generic_string().c_str(), std::ios::binary | std::ios::trunc );
+   for( const batch& b : batches )
+   {
+      const uint64_t size = b.body.size();
+      out.write( reinterpret_cast<const char*>( &b.block_num ), sizeof(b.block_num) );
+      out.write( reinterpret_cast<const char*>( &size ), sizeof(size) );
+      out.write( b.body.data(), b.body.size() );
+   }
+   out.close();
+   if( out.good() )
+      ilog( "Saved ${n} Elastic Search bulk requests which were not acknowledged to ${f}",
+            ("n",batches.size())("f",file) );
+   else
+      elog( "Unable to save ${n} Elastic Search bulk requests which were not acknowledged to ${f}",
+            ("n",batches.size())("f",file) );
+}
+
+void ESBulkWriter::run()
+{
+   CURLM* multi = curl_multi_init();
+   struct curl_slist* headers = curl_slist_append( nullptr, "Content-Type: application/json" );
+   std::vector<connection> connections( _connections );
+   for( connection& c : connections )
+   {
+      c.handle = curl_easy_init();
+      curl_easy_setopt( c.handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_2 );
+      curl_easy_setopt( c.handle, CURLOPT_URL, _url.c_str() );
+      curl_easy_setopt( c.handle, CURLOPT_HTTPHEADER, headers );
+      curl_easy_setopt( c.handle, CURLOPT_POST, 1L );
+      curl_easy_setopt( c.handle, CURLOPT_WRITEFUNCTION, WriteCallback );
+      curl_easy_setopt( c.handle, CURLOPT_WRITEDATA, (void *)&c.response );
+      curl_easy_setopt( c.handle, CURLOPT_USERAGENT, "libcrp/0.1" );
+      if( !_auth.empty() )
+         curl_easy_setopt( c.handle, CURLOPT_USERPWD, _auth.c_str() );
+   }
+
+   std::vector<batch> retries;
+   size_t in_flight = 0;
+   while( true )
+   {
+      std::vector<batch> to_send;
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         auto has_work = [this]() { return _stopping || !_queue.empty(); };
+         if( in_flight == 0 && retries.empty() )
+            _ready.wait( lock, has_work );
+         else if( in_flight == 0 ) // waiting for the backoff of the failed requests
+            _ready.wait_for( lock, std::chrono::milliseconds( poll_milliseconds ), has_work );
+         if( _stopping )
+            break;
+
+         // failed requests are sent again before the queued ones
+         const size_t free_connections = connections.size() - in_flight;
+         const fc::time_point now = fc::time_point::now();
+         for( auto itr = retries.begin(); itr != retries.end() && to_send.size() < free_connections; )
+         {
+            if( itr->retry_at <= now )
+            {
+               to_send.push_back( std::move( *itr ) );
+               itr = retries.erase( itr );
+            }
+            else
+               ++itr;
+         }
+         while( !_queue.empty() && to_send.size() < free_connections )
+         {
+            to_send.push_back( std::move( _queue.front() ) );
+            _queue.pop_front();
+         }
+      }
+      if( !to_send.empty() )
+         _space.notify_all();
+
+      for( batch& b : to_send )
+      {
+         auto c = std::find_if( connections.begin(), connections.end(), []( const connection& conn ) {
+            return !conn.busy;
+         } );
+         c->current = std::move( b );
+         c->response.clear();
+         c->busy = true;
+         curl_easy_setopt( c->handle, CURLOPT_POSTFIELDS, c->current.body.c_str() );
+         curl_easy_setopt( c->handle, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)c->current.body.size() );
+         curl_multi_add_handle( multi, c->handle );
+         ++in_flight;
+      }
+      if( in_flight == 0 )
+         continue;
+
+      int running = 0;
+      curl_multi_perform( multi, &running );
+      int messages = 0;
+      while( CURLMsg* msg = curl_multi_info_read( multi, &messages ) )
+      {
+         if( msg->msg != CURLMSG_DONE )
+            continue;
+         auto c = std::find_if( connections.begin(), connections.end(), [msg]( const connection& conn ) {
+            return conn.handle == msg->easy_handle;
+         } );
+         curl_multi_remove_handle( multi, c->handle );
+         c->busy = false;
+         --in_flight;
+
+         bool acknowledged = false;
+         if( msg->data.result == CURLE_OK )
+         {
+            try {
+               acknowledged = handleBulkResponse( getResponseCode( c->handle ), c->response );
+            } catch( const fc::exception& e ) {
+               elog( "Unexpected response of Elastic Search: ${e}", ("e",e.to_detail_string()) );
+            }
+         }
+         else
+            elog( "Unable to send a bulk request to Elastic Search: ${e}",
+                  ("e",curl_easy_strerror( msg->data.result )) );
+
+         if( acknowledged )
+            acknowledge( c->current );
+         else
+         {
+            batch& b = c->current;
+            const uint32_t backoff = std::min( max_backoff_seconds, 1u << std::min<uint32_t>( b.attempts, 6 ) );
+            ++b.attempts;
+            b.retry_at = fc::time_point::now() + fc::seconds( backoff );
+            wlog( "Sending the bulk request of block ${b} to Elastic Search again in ${s} seconds, attempt ${n}",
+                  ("b",b.block_num)("s",backoff)("n",b.attempts + 1) );
+            retries.push_back( std::move( b ) );
+         }
+      }
+      if( in_flight > 0 )
+         curl_multi_wait( multi, nullptr, 0, poll_milliseconds, nullptr );
+   }
+
+   // save everything which is not acknowledged, requests in flight are aborted and sent again later
+   std::vector<batch> pending = std::move( retries );
+   for( connection& c : connections )
+   {
+      if( c.busy )
+      {
+         curl_multi_remove_handle( multi, c.handle );
+         pending.push_back( std::move( c.current ) );
+      }
+      curl_easy_cleanup( c.handle );
+   }
+   curl_multi_cleanup( multi );
+   curl_slist_free_all( headers );
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      for( batch& b : _queue )
+         pending.push_back( std::move( b ) );
+      _queue.clear();
+   }
+   savePending( pending );
+}
+
+} } // end namespace graphene::utilities
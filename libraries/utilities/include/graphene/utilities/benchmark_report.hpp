@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/filesystem.hpp>
+#include <fc/variant_object.hpp>
+
+#include <string>
+
+namespace graphene { namespace utilities {
+
+/**
+ * @brief Collects the results of a benchmark run and writes them as JSON
+ *
+ * Next to the results the report describes the build and the machine, and the parameters of the run, so that
+ * tools can compare a run with a stored baseline and tell apart regressions from runs which are not comparable.
+ * The format is
+ *
+ *    { "format": 1, "benchmark": <name>, "environment": {...}, "parameters": {...},
+ *      "results": [ { "name": <name>, "value": <number>, "unit": <unit>, "lower_is_better": <bool> }, ... ] }
+ *
+ * A name appears only once in the results, adding it again replaces the earlier value.
+ */
+class benchmark_report
+{
+public:
+   explicit benchmark_report( const std::string& benchmark );
+
+   /// Records a setting of the run which makes results incomparable when it differs, e.g. the state size
+   void set_parameter( const std::string& name, const fc::variant& value );
+
+   /// Adds a result, @p lower_is_better tells whether a decrease is an improvement, e.g. false for throughput
+   void add( const std::string& name, double value, const std::string& unit, bool lower_is_better = true );
+
+   bool empty()const { return _results.empty(); }
+
+   fc::variant_object to_variant()const;
+
+   /// Writes the report to @p file, replacing its content
+   void save( const fc::path& file )const;
+
+   /// Describes the build and the machine: revisions, compiler, build type, platform, host name and CPU threads
+   static fc::variant_object environment();
+
+private:
+   std::string                _benchmark;
+   fc::mutable_variant_object _parameters;
+   fc::variants               _results;
+};
+
+} } // graphene::utilities
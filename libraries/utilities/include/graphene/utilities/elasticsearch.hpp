@@ -44,6 +44,37 @@ namespace graphene { namespace utilities {
          std::string endpoint;
          std::string query;
    };
+   /**
+    * The body of a bulk request. The action lines are written to a single buffer directly, without building
+    * variants, and the documents are appended to it. The buffer keeps its capacity when it is cleared, so that
+    * it is reused by the following requests.
+    */
+   class BulkBody {
+      public:
+         /** Adds an index action, no ID is set if @p id is empty */
+         void addIndex(const std::string& index, const std::string& type, const std::string& id,
+                       const std::string& document);
+         void addDelete(const std::string& index, const std::string& type, const std::string& id);
+         /** Appends the lines of another body */
+         void append(const BulkBody& other);
+
+         /** @return the number of lines of the body, i.e. the actions and the documents */
+         size_t lines()const { return _lines; }
+         bool empty()const { return _lines == 0; }
+         const std::string& str()const { return _buffer; }
+         /** @return the first lines of the body, for logging */
+         std::string head(size_t count)const;
+
+         void clear();
+         /** Moves the body out, the buffer is empty afterwards */
+         std::string release();
+
+      private:
+         void appendString(const std::string& s);
+
+         std::string _buffer;
+         size_t _lines = 0;
+   };
    class CurlRequest {
       public:
          CURL *handler;
@@ -54,6 +85,8 @@ namespace graphene { namespace utilities {
    };
 
    bool SendBulk(ES&& es);
+   /** Sends a bulk request, @p body holds the lines of the request, each of them terminated by a newline */
+   bool SendBulkBody(ES& es, const std::string& body);
    const std::vector<std::string> createBulk(const fc::mutable_variant_object& bulk_header, std::string&& data);
    bool checkES(ES& es);
    const std::string simpleQuery(ES& es);
@@ -61,7 +94,8 @@ namespace graphene { namespace utilities {
    bool handleBulkResponse(long http_code, const std::string& CurlReadBuffer);
    const std::string getEndPoint(ES& es);
    const std::string generateIndexName(const fc::time_point_sec& block_date, const std::string& _elasticsearch_index_prefix);
-   const std::string doCurl(CurlRequest& curl);
+   /** Performs the request, @p body replaces the query of the request if it is not null */
+   const std::string doCurl(CurlRequest& curl, const std::string* body = nullptr);
    const std::string joinBulkLines(const std::vector<std::string>& bulk);
    long getResponseCode(CURL *handler);
 
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+#include <fc/filesystem.hpp>
+#include <fc/time.hpp>
+
+namespace graphene { namespace utilities {
+
+   /**
+    * Sends bulk requests to Elastic Search in a background thread, over several connections at once.
+    *
+    * Batches of bulk lines are queued with the number of the last block whose lines they complete. A request
+    * which fails is retried with an exponential backoff until it succeeds. The highest block number of the
+    * batches which are acknowledged together with all batches queued before them is saved in the "checkpoint"
+    * file of the directory of the writer. Batches which are not acknowledged when the writer is stopped are
+    * saved in the "pending" file and sent first when the writer is started again, so that an outage of
+    * Elastic Search does not require to index the chain again.
+    */
+   class ESBulkWriter
+   {
+      public:
+         /**
+          * @param url the URL of the Elastic Search node, the bulk requests are sent to its "_bulk" endpoint
+          * @param connections the maximum number of requests which are sent at the same time
+          * @param queue_size the maximum number of queued batches, @ref push blocks while the queue is full
+          * @param dir the directory of the checkpoint and of the batches which are not sent
+          */
+         ESBulkWriter( const std::string& url, const std::string& auth, uint32_t connections, uint32_t queue_size,
+                       const fc::path& dir );
+         ~ESBulkWriter();
+
+         void start();
+         /** Aborts the requests in flight and saves the batches which are not acknowledged */
+         void stop();
+         /**
+          * Queues the body of a bulk request which completes the given block, see @ref BulkBody,
+          * blocks while the queue is full
+          */
+         void push( uint32_t block_num, std::string&& body );
+         /** @return the block number of the checkpoint, 0 if no batch has been acknowledged */
+         uint32_t lastAcknowledgedBlock()const;
+
+      private:
+         struct batch
+         {
+            uint64_t         sequence = 0;
+            uint32_t         block_num = 0;
+            std::string      body;
+            uint32_t         attempts = 0;
+            fc::time_point   retry_at;
+         };
+         struct connection
+         {
+            CURL*            handle = nullptr;
+            batch            current;
+            std::string      response;
+            bool             busy = false;
+         };
+
+         void run();
+         void acknowledge( const batch& b );
+         void loadPending();
+         void savePending( std::vector<batch>& batches );
+
+         const std::string                 _url;
+         const std::string                 _auth;
+         const uint32_t                    _connections;
+         const uint32_t                    _queue_size;
+         const fc::path                    _dir;
+
+         std::thread                       _worker;
+         mutable std::mutex                _mutex;
+         std::condition_variable           _ready;
+         std::condition_variable           _space;
+         std::deque<batch>                 _queue;
+         bool                              _stopping = false;
+         uint64_t                          _next_sequence = 0;
+         /// The acknowledged batches which are not covered by the checkpoint yet
+         std::map<uint64_t, uint32_t>      _acknowledged;
+         uint64_t                          _next_acknowledged = 0;
+         uint32_t                          _last_acknowledged_block = 0;
+   };
+
+} } // end namespace graphene::utilities
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace utilities {
+
+/**
+ * Parses a set of CPUs, a comma separated list of CPU numbers, ranges like "0-3" and NUMA nodes like "node:1",
+ * which stand for the CPUs of the node as listed in /sys/devices/system/node/node1/cpulist on Linux.
+ * @return the sorted CPU numbers without duplicates
+ * @throws fc::exception if the set is malformed or empty, or names a NUMA node which does not exist
+ */
+std::vector<uint32_t> parse_cpu_set( const std::string& cpu_set );
+
+/**
+ * Restricts the calling thread to run on the given CPUs. As Linux allocates memory on the NUMA node of the CPU which
+ * first touches it, pinning a thread to the CPUs of one node also keeps the memory it allocates on that node.
+ * Only supported on Linux, elsewhere a warning is logged and the thread is left as it is.
+ * @throws fc::exception if the set is empty or the affinity can not be set
+ */
+void pin_current_thread( const std::vector<uint32_t>& cpus );
+
+} } // graphene::utilities
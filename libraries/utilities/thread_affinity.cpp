@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/utilities/thread_affinity.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace graphene { namespace utilities {
+
+namespace {
+
+uint32_t parse_cpu_number( const std::string& s )
+{
+   FC_ASSERT( !s.empty() && s.size() <= 9
+                 && std::all_of( s.begin(), s.end(), []( char c ) { return c >= '0' && c <= '9'; } ),
+              "Invalid CPU number '${s}'", ("s",s) );
+   return static_cast<uint32_t>( std::stoul( s ) );
+}
+
+void parse_cpu_list( const std::string& list, std::vector<uint32_t>& cpus, bool allow_nodes )
+{
+   std::vector<std::string> items;
+   boost::split( items, list, boost::is_any_of( "," ) );
+   for( std::string item : items )
+   {
+      boost::trim( item );
+      if( allow_nodes && boost::starts_with( item, "node:" ) )
+      {
+         const uint32_t node = parse_cpu_number( item.substr( 5 ) );
+         const std::string path = "/sys/devices/system/node/node" + std::to_string( node ) + "/cpulist";
+         std::ifstream in( path );
+         std::string node_cpus;
+         FC_ASSERT( in && std::getline( in, node_cpus ), "Unknown NUMA node ${n}", ("n",node) );
+         parse_cpu_list( node_cpus, cpus, false );
+         continue;
+      }
+      const auto dash = item.find( '-' );
+      if( dash == std::string::npos )
+      {
+         cpus.push_back( parse_cpu_number( item ) );
+         continue;
+      }
+      const uint32_t first = parse_cpu_number( item.substr( 0, dash ) );
+      const uint32_t last = parse_cpu_number( item.substr( dash + 1 ) );
+      FC_ASSERT( first <= last, "Invalid CPU range '${r}'", ("r",item) );
+      for( uint32_t cpu = first; cpu <= last; ++cpu )
+         cpus.push_back( cpu );
+   }
+}
+
+} // anonymous namespace
+
+std::vector<uint32_t> parse_cpu_set( const std::string& cpu_set )
+{
+   std::vector<uint32_t> cpus;
+   parse_cpu_list( cpu_set, cpus, true );
+   std::sort( cpus.begin(), cpus.end() );
+   cpus.erase( std::unique( cpus.begin(), cpus.end() ), cpus.end() );
+   FC_ASSERT( !cpus.empty(), "The CPU set must not be empty" );
+   return cpus;
+}
+
+void pin_current_thread( const std::vector<uint32_t>& cpus )
+{
+   FC_ASSERT( !cpus.empty(), "The CPU set must not be empty" );
+#ifdef __linux__
+   cpu_set_t set;
+   CPU_ZERO( &set );
+   for( const uint32_t cpu : cpus )
+   {
+      FC_ASSERT( cpu < CPU_SETSIZE, "CPU ${c} is out of range", ("c",cpu) );
+      CPU_SET( cpu, &set );
+   }
+   const int result = pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+   FC_ASSERT( result == 0, "Unable to set the CPU affinity of the thread, error ${e}", ("e",result) );
+#else
+   wlog( "Setting the CPU affinity of threads is not supported on this platform" );
+#endif
+}
+
+} } // graphene::utilities
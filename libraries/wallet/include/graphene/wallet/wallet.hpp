@@ -791,6 +791,25 @@ class wallet_api
          return std::make_pair(trx.id(),trx);
       }
 
+      /** Transfer amounts from one account to many others, packing the transfers into as few transactions as the
+       *  maximum transaction size allows.
+       *
+       *  Recipients, fees, the reference block and the signing keys are looked up once for the whole batch,
+       *  instead of once per transfer.
+       * @param from the name or id of the account sending the funds
+       * @param asset_symbol_or_id the symbol or id of the asset to send
+       * @param recipients pairs of the name or id of a receiving account and the amount to send to it
+       *                   (in nominal units -- to send half of a BTS, specify 0.5)
+       * @param memo a memo to attach to every transfer, or an empty string for none
+       * @param broadcast true to broadcast the transactions on the network
+       * @returns the signed transactions, in the order of the recipients
+       */
+      vector<signed_transaction> transfer_many(string from,
+                                               string asset_symbol_or_id,
+                                               vector<pair<string, string>> recipients,
+                                               string memo,
+                                               bool broadcast = false);
+
 
       /**
        *  This method is used to convert a JSON transaction to its transactin ID.
@@ -1752,6 +1771,11 @@ class wallet_api
       void dbg_make_mia(string creator, string symbol);
       void dbg_push_blocks( std::string src_filename, uint32_t count );
       void dbg_generate_blocks( std::string debug_wif_key, uint32_t count );
+      graphene::debug_witness::debug_benchmark_result dbg_benchmark_transactions( std::string source,
+                                                                                  uint32_t first_block,
+                                                                                  std::string debug_wif_key,
+                                                                                  uint32_t transactions_per_block,
+                                                                                  uint32_t max_blocks );
       void dbg_stream_json_objects( const std::string& filename );
       void dbg_update_object( fc::variant_object update );
 
@@ -1852,6 +1876,7 @@ FC_API( graphene::wallet::wallet_api,
         (cancel_order)
         (transfer)
         (transfer2)
+        (transfer_many)
         (get_transaction_id)
         (create_asset)
         (update_asset)
@@ -1928,6 +1953,7 @@ FC_API( graphene::wallet::wallet_api,
         (dbg_make_mia)
         (dbg_push_blocks)
         (dbg_generate_blocks)
+        (dbg_benchmark_transactions)
         (dbg_stream_json_objects)
         (dbg_update_object)
         (flood_network)
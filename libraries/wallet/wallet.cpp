@@ -103,13 +103,12 @@ namespace graphene { namespace wallet {
 
       // Create as many derived owner keys as requested
       vector<brain_key_info> results;
-      for (int i = 0; i < number_of_desired_keys; ++i) {
-        fc::ecc::private_key priv_key = graphene::wallet::detail::derive_private_key( brain_key, i );
-
+      results.reserve( number_of_desired_keys );
+      for( const auto& key : graphene::wallet::detail::derive_keys( brain_key, 0, number_of_desired_keys ) ) {
         brain_key_info result;
         result.brain_priv_key = brain_key;
-        result.wif_priv_key = key_to_wif( priv_key );
-        result.pub_key = priv_key.get_public_key();
+        result.wif_priv_key = key_to_wif( key.private_key );
+        result.pub_key = key.public_key;
 
         results.push_back(result);
       }
@@ -579,7 +578,8 @@ account_object wallet_api::get_account(string account_name_or_id) const
 
 extended_asset_object wallet_api::get_asset(string asset_name_or_id) const
 {
-   auto found_asset = my->find_asset(asset_name_or_id);
+   // the collateral totals change without changing the asset object, so always ask the node
+   auto found_asset = my->fetch_asset(asset_name_or_id);
    FC_ASSERT( found_asset, "Unable to find asset '${a}'", ("a",asset_name_or_id) );
    return *found_asset;
 }
@@ -794,6 +794,12 @@ signed_transaction wallet_api::transfer(string from, string to, string amount,
 {
    return my->transfer(from, to, amount, asset_symbol, memo, broadcast);
 }
+vector<signed_transaction> wallet_api::transfer_many(string from, string asset_symbol,
+                                                    vector<pair<string, string>> recipients, string memo,
+                                                    bool broadcast /* = false */)
+{
+   return my->transfer_many(from, asset_symbol, recipients, memo, broadcast);
+}
 signed_transaction wallet_api::create_asset(string issuer,
                                             string symbol,
                                             uint8_t precision,
@@ -1059,6 +1065,12 @@ void wallet_api::dbg_generate_blocks( std::string debug_wif_key, uint32_t count
    my->dbg_generate_blocks( debug_wif_key, count );
 }
 
+graphene::debug_witness::debug_benchmark_result wallet_api::dbg_benchmark_transactions( std::string source,
+      uint32_t first_block, std::string debug_wif_key, uint32_t transactions_per_block, uint32_t max_blocks )
+{
+   return my->dbg_benchmark_transactions( source, first_block, debug_wif_key, transactions_per_block, max_blocks );
+}
+
 void wallet_api::dbg_stream_json_objects( const std::string& filename )
 {
    my->dbg_stream_json_objects( filename );
@@ -1495,7 +1507,7 @@ blind_confirmation wallet_api::transfer_from_blind( string from_blind_account_ke
    transfer_from_blind_operation from_blind;
 
 
-   auto fees  = my->_remote_db->get_global_properties().parameters.get_current_fees();
+   auto fees  = my->get_global_properties().parameters.get_current_fees();
    fc::optional<asset_object> asset_obj = get_asset(symbol);
    FC_ASSERT(asset_obj.valid(), "Could not find asset matching ${asset}", ("asset", symbol));
    auto amount = asset_obj->amount_from_string(amount_in);
@@ -1575,7 +1587,7 @@ blind_confirmation wallet_api::blind_transfer_help( string from_key_or_label,
    blind_transfer_operation blind_tr;
    blind_tr.outputs.resize(2);
 
-   auto fees  = my->_remote_db->get_global_properties().parameters.get_current_fees();
+   auto fees  = my->get_global_properties().parameters.get_current_fees();
 
    auto amount = asset_obj->amount_from_string(amount_in);
 
@@ -1803,7 +1815,7 @@ blind_confirmation wallet_api::transfer_to_blind( string from_account_id_or_name
               [&]( const blind_output& a, const blind_output& b ){ return a.commitment < b.commitment; } );
 
    confirm.trx.operations.push_back( bop );
-   my->set_operation_fees( confirm.trx, my->_remote_db->get_global_properties().parameters.get_current_fees());
+   my->set_operation_fees( confirm.trx, my->get_global_properties().parameters.get_current_fees());
    confirm.trx.validate();
    confirm.trx = sign_transaction(confirm.trx, broadcast);
 
@@ -76,7 +76,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( account_create_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees() );
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees() );
       tx.validate();
 
       return sign_transaction(tx, broadcast);
@@ -94,7 +94,7 @@ namespace graphene { namespace wallet { namespace detail {
       op.account_to_upgrade = account_obj.get_id();
       op.upgrade_to_lifetime_member = true;
       tx.operations = {op};
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees() );
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees() );
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -138,7 +138,7 @@ namespace graphene { namespace wallet { namespace detail {
 
          signed_transaction tx;
          tx.operations.push_back(op);
-         set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+         set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
          tx.validate();
 
          return sign_transaction(tx, broadcast);
@@ -194,10 +194,18 @@ namespace graphene { namespace wallet { namespace detail {
 
    account_object wallet_api_impl::get_account(account_id_type id) const
    {
+      {
+         std::lock_guard<std::mutex> guard( _cache.lock );
+         auto itr = _cache.accounts.find( id );
+         if( itr != _cache.accounts.end() )
+            return itr->second;
+      }
+
       std::string account_id = account_id_to_string(id);
 
-      auto rec = _remote_db->get_accounts({account_id}, {}).front();
+      auto rec = _remote_db->get_accounts({account_id}, true).front();
       FC_ASSERT(rec);
+      cache_account( *rec );
       return *rec;
    }
 
@@ -210,8 +218,15 @@ namespace graphene { namespace wallet { namespace detail {
          // It's an ID
          return get_account(*id);
       } else {
-         auto rec = _remote_db->lookup_account_names({account_name_or_id}).front();
+         {
+            std::lock_guard<std::mutex> guard( _cache.lock );
+            auto itr = _cache.account_names.find( account_name_or_id );
+            if( itr != _cache.account_names.end() )
+               return _cache.accounts.at( itr->second );
+         }
+         auto rec = _remote_db->get_accounts({account_name_or_id}, true).front();
          FC_ASSERT( rec && rec->name == account_name_or_id );
+         cache_account( *rec );
          return *rec;
       }
    }
@@ -260,7 +275,7 @@ namespace graphene { namespace wallet { namespace detail {
 
          signed_transaction tx;
          tx.operations.push_back( account_create_op );
-         set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+         set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
          tx.validate();
 
          // we do not insert owner_privkey here because
@@ -282,7 +297,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( whitelist_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -407,7 +422,7 @@ namespace graphene { namespace wallet { namespace detail {
          tx.operations.reserve( ctx.ops.size() );
          for( const balance_claim_operation& op : ctx.ops )
             tx.operations.emplace_back( op );
-         set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees() );
+         set_operation_fees( tx, get_global_properties().parameters.get_current_fees() );
          tx.validate();
          signed_transaction signed_tx = sign_transaction( tx, false );
          for( const address& addr : ctx.addrs )
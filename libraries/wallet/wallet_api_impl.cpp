@@ -22,7 +22,6 @@
  * THE SOFTWARE.
  */
 #include <boost/algorithm/string/replace.hpp>
-#include <boost/range/adaptors.hpp>
 
 #include <fc/rpc/api_connection.hpp>
 #include <fc/popcount.hpp>
@@ -79,6 +78,13 @@ namespace graphene { namespace wallet { namespace detail {
          on_block_applied( block_id );
       } );
 
+      // only the objects requested for the cache are subscribed to
+      _remote_db->set_subscribe_callback( [this](const variant& updates )
+      {
+         on_objects_changed( updates );
+      }, false );
+      _remote_db->set_auto_subscription( false );
+
       _wallet.chain_id = _chain_id;
       _wallet.ws_server = initial_data.ws_server;
       _wallet.ws_user = initial_data.ws_user;
@@ -176,16 +182,99 @@ namespace graphene { namespace wallet { namespace detail {
    }
    global_property_object wallet_api_impl::get_global_properties() const
    {
-      return _remote_db->get_global_properties();
+      {
+         std::lock_guard<std::mutex> guard( _cache.lock );
+         if( _cache.global_properties )
+            return *_cache.global_properties;
+      }
+      // fetch through get_objects, which subscribes to the object
+      global_property_object props = _remote_db->get_objects( { global_property_id_type() }, true ).front()
+                                                .as<global_property_object>( GRAPHENE_MAX_NESTED_OBJECTS );
+      std::lock_guard<std::mutex> guard( _cache.lock );
+      _cache.global_properties = props;
+      return props;
    }
    dynamic_global_property_object wallet_api_impl::get_dynamic_global_properties() const
    {
       return _remote_db->get_dynamic_global_properties();
    }
 
+   void wallet_api_impl::on_objects_changed( const variant& updates )
+   {
+      if( !updates.is_array() )
+         return;
+
+      std::lock_guard<std::mutex> guard( _cache.lock );
+      for( const variant& item : updates.get_array() )
+      {
+         // changed objects are reported in full, removed objects by their id
+         const variant* id_var = &item;
+         if( item.is_object() )
+         {
+            auto itr = item.get_object().find( "id" );
+            if( itr == item.get_object().end() )
+               continue;
+            id_var = &itr->value();
+         }
+         if( !id_var->is_string() )
+            continue;
+
+         object_id_type id;
+         try
+         {
+            id = id_var->as<object_id_type>( 1 );
+         }
+         catch( const fc::exception& )
+         {
+            continue;
+         }
+
+         if( id.is<account_id_type>() )
+         {
+            auto itr = _cache.accounts.find( id.as<account_id_type>() );
+            if( itr != _cache.accounts.end() )
+            {
+               _cache.account_names.erase( itr->second.name );
+               _cache.accounts.erase( itr );
+            }
+         }
+         else if( id.is<asset_id_type>() )
+         {
+            auto itr = _cache.assets.find( id.as<asset_id_type>() );
+            if( itr != _cache.assets.end() )
+            {
+               _cache.asset_symbols.erase( itr->second.symbol );
+               _cache.assets.erase( itr );
+            }
+         }
+         else if( id == object_id_type( global_property_id_type() ) )
+            _cache.global_properties.reset();
+      }
+   }
+
+   void wallet_api_impl::cache_account( const account_object& account )const
+   {
+      std::lock_guard<std::mutex> guard( _cache.lock );
+      _cache.accounts[account.id] = account;
+      _cache.account_names[account.name] = account.id;
+   }
+
+   void wallet_api_impl::cache_asset( const extended_asset_object& asset )const
+   {
+      std::lock_guard<std::mutex> guard( _cache.lock );
+      _cache.assets[asset.id] = asset;
+      _cache.asset_symbols[asset.symbol] = asset.id;
+   }
+
    void wallet_api_impl::on_block_applied( const variant& block_id )
    {
-      fc::async([this]{resync();}, "Resync after block");
+      // nothing to claim, or a resync is still waiting to run
+      if( !has_pending_registrations() || _resync_scheduled.exchange( true ) )
+         return;
+      fc::async([this]{
+         _resync_scheduled = false;
+         resync();
+      }, "Resync after block");
    }
 
    void wallet_api_impl::set_operation_fees( signed_transaction& tx, const fee_schedule& s  )
@@ -216,32 +305,53 @@ namespace graphene { namespace wallet { namespace detail {
 
    int wallet_api_impl::find_first_unused_derived_key_index(const fc::ecc::private_key& parent_key)
    {
+      // keys are derived and checked in chunks, a key is used if the wallet holds it or an account references it
+      constexpr int chunk_size = 8;
+      const std::string parent_wif = key_to_wif(parent_key);
       int first_unused_index = 0;
       int number_of_consecutive_unused_keys = 0;
-      for (int key_index = 0; ; ++key_index)
+      for (int chunk_start = 0; ; chunk_start += chunk_size)
       {
-         fc::ecc::private_key derived_private_key = derive_private_key(key_to_wif(parent_key), key_index);
-         graphene::chain::public_key_type derived_public_key = derived_private_key.get_public_key();
-         if( _keys.find(derived_public_key) == _keys.end() )
+         const vector<derived_key> derived_keys = derive_keys( parent_wif, chunk_start, chunk_size );
+         vector<public_key_type> public_keys;
+         public_keys.reserve( chunk_size );
+         for( const derived_key& k : derived_keys )
+            public_keys.push_back( k.public_key );
+         vector<flat_set<account_id_type>> references;
+         try
          {
-            if (number_of_consecutive_unused_keys)
+            references = _remote_db->get_key_references( public_keys );
+         }
+         catch( const fc::exception& )
+         {
+            // without the api_helper_indexes plugin on the node only the keys of the wallet count as used
+         }
+         references.resize( chunk_size );
+
+         for (int i = 0; i < chunk_size; ++i)
+         {
+            const int key_index = chunk_start + i;
+            if( _keys.find(public_keys[i]) == _keys.end() && references[i].empty() )
             {
-               ++number_of_consecutive_unused_keys;
-               if (number_of_consecutive_unused_keys > 5)
-                  return first_unused_index;
+               if (number_of_consecutive_unused_keys)
+               {
+                  ++number_of_consecutive_unused_keys;
+                  if (number_of_consecutive_unused_keys > 5)
+                     return first_unused_index;
+               }
+               else
+               {
+                  first_unused_index = key_index;
+                  number_of_consecutive_unused_keys = 1;
+               }
             }
             else
             {
-               first_unused_index = key_index;
-               number_of_consecutive_unused_keys = 1;
+               // key_index is used
+               first_unused_index = 0;
+               number_of_consecutive_unused_keys = 0;
             }
          }
-         else
-         {
-            // key_index is used
-            first_unused_index = 0;
-            number_of_consecutive_unused_keys = 0;
-         }
       }
    }
 
@@ -311,44 +421,48 @@ namespace graphene { namespace wallet { namespace detail {
       //   notification is received, should also be done here
       //   "batch style" by querying the blockchain
 
-      if( !_wallet.pending_account_registrations.empty() )
-      {
-         // make a vector of the account names pending registration
-         std::vector<string> pending_account_names =
-               boost::copy_range<std::vector<string> >(boost::adaptors::keys(_wallet.pending_account_registrations));
-
-         // look those up on the blockchain
-         std::vector<fc::optional<graphene::chain::account_object >>
-               pending_account_objects = _remote_db->lookup_account_names( pending_account_names );
-
-         // if any of them exist, claim them
-         for( const fc::optional<graphene::chain::account_object>& optional_account : pending_account_objects )
-            if( optional_account )
-               claim_registered_account(*optional_account);
-      }
+      if( !has_pending_registrations() )
+         return;
 
-      if (!_wallet.pending_witness_registrations.empty())
+      // look up the names pending account registration and the owners of witnesses pending registration at once
+      flat_set<string> pending_names;
+      pending_names.reserve( _wallet.pending_account_registrations.size()
+                             + _wallet.pending_witness_registrations.size() );
+      for( const auto& pending : _wallet.pending_account_registrations )
+         pending_names.insert( pending.first );
+      for( const auto& pending : _wallet.pending_witness_registrations )
+         pending_names.insert( pending.first );
+
+      std::vector<fc::optional<graphene::chain::account_object>> pending_account_objects =
+            _remote_db->lookup_account_names( std::vector<string>( pending_names.begin(), pending_names.end() ) );
+
+      for( const fc::optional<graphene::chain::account_object>& optional_account : pending_account_objects )
       {
-         // make a vector of the owner accounts for witnesses pending registration
-         std::vector<string> pending_witness_names =
-               boost::copy_range<std::vector<string> >(boost::adaptors::keys(_wallet.pending_witness_registrations));
+         if( !optional_account )
+            continue;
 
-         // look up the owners on the blockchain
-         std::vector<fc::optional<graphene::chain::account_object>> owner_account_objects =
-               _remote_db->lookup_account_names(pending_witness_names);
+         // if the account exists, claim it
+         if( _wallet.pending_account_registrations.find( optional_account->name )
+               != _wallet.pending_account_registrations.end() )
+            claim_registered_account(*optional_account);
 
-         // if any of them have registered witnesses, claim them
-         for( const fc::optional<graphene::chain::account_object>& optional_account : owner_account_objects )
-            if (optional_account)
-            {
-               std::string account_id = account_id_to_string(optional_account->id);
-               fc::optional<witness_object> witness_obj = _remote_db->get_witness_by_account(account_id);
-               if (witness_obj)
-                  claim_registered_witness(optional_account->name);
-            }
+         // if the owner has registered its witness, claim it
+         if( _wallet.pending_witness_registrations.find( optional_account->name )
+               != _wallet.pending_witness_registrations.end() )
+         {
+            std::string account_id = account_id_to_string(optional_account->id);
+            fc::optional<witness_object> witness_obj = _remote_db->get_witness_by_account(account_id);
+            if (witness_obj)
+               claim_registered_witness(optional_account->name);
+         }
       }
    }
 
+   bool wallet_api_impl::has_pending_registrations()const
+   {
+      return !_wallet.pending_account_registrations.empty() || !_wallet.pending_witness_registrations.empty();
+   }
+
    string wallet_api_impl::get_wallet_filename() const
    {
       return _wallet_filename;
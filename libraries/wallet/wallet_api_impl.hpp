@@ -23,6 +23,9 @@
  */
 #pragma once
 
+#include <atomic>
+#include <mutex>
+
 #include <fc/thread/mutex.hpp>
 
 #include <graphene/app/api.hpp>
@@ -66,6 +69,15 @@ string address_to_shorthash( const graphene::protocol::address& addr );
 
 fc::ecc::private_key derive_private_key( const std::string& prefix_string, int sequence_number );
 
+struct derived_key
+{
+   fc::ecc::private_key private_key;
+   public_key_type      public_key;
+};
+
+/// derives the keys with @p count consecutive sequence numbers in parallel, in the order of the sequence numbers
+vector<derived_key> derive_keys( const std::string& prefix_string, int first_sequence_number, int count );
+
 string normalize_brain_key( string s );
 
 struct op_prototype_visitor
@@ -365,6 +377,9 @@ public:
    signed_transaction transfer(string from, string to, string amount,
          string asset_symbol, string memo, bool broadcast = false);
 
+   vector<signed_transaction> transfer_many(string from, string asset_symbol,
+         vector<pair<string, string>> recipients, string memo, bool broadcast = false);
+
    signed_transaction issue_asset(string to_account, string amount, string symbol,
          string memo, bool broadcast = false);
 
@@ -387,6 +402,10 @@ public:
 
    void dbg_generate_blocks( const std::string& debug_wif_key, uint32_t count );
 
+   graphene::debug_witness::debug_benchmark_result dbg_benchmark_transactions( const std::string& source,
+         uint32_t first_block, const std::string& debug_wif_key, uint32_t transactions_per_block,
+         uint32_t max_blocks );
+
    void dbg_stream_json_objects( const std::string& filename );
 
    void dbg_update_object( const fc::variant_object& update );
@@ -444,10 +463,35 @@ private:
    void claim_registered_witness(const std::string& witness_name);
 
    fc::mutex _resync_mutex;
+   /// set while a resync is scheduled but has not started yet, so that blocks arriving meanwhile do not queue more
+   std::atomic<bool> _resync_scheduled { false };
+   /// @return true if the wallet waits for registrations which @ref resync could claim
+   bool has_pending_registrations()const;
    void resync();
 
    void init_prototype_ops();
 
+   /// Accounts, assets and global properties looked up on the node. They are subscribed to and stay cached until
+   /// the node reports a change, so that commands resolve names, precisions and fees without a remote call.
+   /// Notifications come in from the connection while commands run, so the maps are guarded by @ref lock.
+   struct object_cache
+   {
+      std::mutex                                 lock;
+      map<account_id_type, account_object>       accounts;
+      map<string, account_id_type>               account_names;
+      map<asset_id_type, extended_asset_object>  assets;
+      map<string, asset_id_type>                 asset_symbols;
+      optional<global_property_object>           global_properties;
+   };
+   mutable object_cache _cache;
+
+   /// drops the cached objects which are reported in @p updates
+   void on_objects_changed( const variant& updates );
+   void cache_account( const account_object& account )const;
+   void cache_asset( const extended_asset_object& asset )const;
+   /// looks up an asset on the node, bypassing the cache, and caches the result
+   optional<extended_asset_object> fetch_asset( const string& asset_symbol_or_id )const;
+
    map<transaction_handle_type, signed_transaction> _builder_transactions;
 
    // if the user executes the same command twice in quick succession,
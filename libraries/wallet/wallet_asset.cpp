@@ -36,8 +36,13 @@ namespace graphene { namespace wallet { namespace detail {
 
    optional<extended_asset_object> wallet_api_impl::find_asset(asset_id_type id)const
    {
-      auto rec = _remote_db->get_assets({asset_id_to_string(id)}, {}).front();
-      return rec;
+      {
+         std::lock_guard<std::mutex> guard( _cache.lock );
+         auto itr = _cache.assets.find( id );
+         if( itr != _cache.assets.end() )
+            return itr->second;
+      }
+      return fetch_asset( asset_id_to_string(id) );
    }
 
    optional<extended_asset_object> wallet_api_impl::find_asset(string asset_symbol_or_id)const
@@ -50,16 +55,27 @@ namespace graphene { namespace wallet { namespace detail {
          return find_asset(*id);
       } else {
          // It's a symbol
-         auto rec = _remote_db->lookup_asset_symbols({asset_symbol_or_id}).front();
-         if( rec )
          {
-            if( rec->symbol != asset_symbol_or_id )
-               return optional<asset_object>();
+            std::lock_guard<std::mutex> guard( _cache.lock );
+            auto itr = _cache.asset_symbols.find( asset_symbol_or_id );
+            if( itr != _cache.asset_symbols.end() )
+               return _cache.assets.at( itr->second );
          }
-         return rec;
+         return fetch_asset( asset_symbol_or_id );
       }
    }
 
+   optional<extended_asset_object> wallet_api_impl::fetch_asset( const string& asset_symbol_or_id )const
+   {
+      auto rec = _remote_db->get_assets({asset_symbol_or_id}, true).front();
+      if( !rec )
+         return rec;
+      if( !maybe_id<asset_id_type>(asset_symbol_or_id) && rec->symbol != asset_symbol_or_id )
+         return optional<extended_asset_object>();
+      cache_asset( *rec );
+      return rec;
+   }
+
    extended_asset_object wallet_api_impl::get_asset(asset_id_type id)const
    {
       auto opt = find_asset(id);
@@ -77,12 +93,9 @@ namespace graphene { namespace wallet { namespace detail {
    asset_id_type wallet_api_impl::get_asset_id(const string& asset_symbol_or_id) const
    {
       FC_ASSERT( asset_symbol_or_id.size() > 0 );
-      vector<optional<extended_asset_object>> opt_asset;
       if( std::isdigit( asset_symbol_or_id.front() ) )
          return fc::variant(asset_symbol_or_id, 1).as<asset_id_type>( 1 );
-      opt_asset = _remote_db->lookup_asset_symbols( {asset_symbol_or_id} );
-      FC_ASSERT( (opt_asset.size() > 0) && (opt_asset[0].valid()) );
-      return opt_asset[0]->id;
+      return get_asset( asset_symbol_or_id ).id;
    }
 
    signed_transaction wallet_api_impl::create_asset(string issuer, string symbol,
@@ -101,7 +114,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( create_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -127,7 +140,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( update_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -149,7 +162,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( update_issuer );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -169,7 +182,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( update_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -192,7 +205,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( update_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -212,7 +225,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( publish_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -234,7 +247,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( fund_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -255,7 +268,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( claim_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -276,7 +289,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( reserve_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -296,7 +309,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( settle_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -315,7 +328,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( settle_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -345,7 +358,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back(issue_op);
-      set_operation_fees(tx,_remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees(tx,get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction(tx, broadcast);
@@ -369,7 +382,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
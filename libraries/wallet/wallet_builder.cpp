@@ -56,7 +56,7 @@ namespace graphene { namespace wallet { namespace detail {
       auto fee_asset_obj = get_asset(fee_asset);
       asset total_fee = fee_asset_obj.amount(0);
 
-      auto gprops = _remote_db->get_global_properties().parameters;
+      auto gprops = get_global_properties().parameters;
       if( fee_asset_obj.get_id() != asset_id_type() )
       {
          for( auto& op : _builder_transactions[handle].operations )
@@ -117,7 +117,7 @@ namespace graphene { namespace wallet { namespace detail {
       if( review_period_seconds )
          pcop.review_period_seconds = review_period_seconds;
       trx.operations = {pcop};
-      _remote_db->get_global_properties().parameters.get_current_fees().set_fee( trx.operations.front() );
+      get_global_properties().parameters.get_current_fees().set_fee( trx.operations.front() );
 
       return trx = sign_transaction(trx, broadcast);
    }
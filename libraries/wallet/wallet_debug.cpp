@@ -58,6 +58,17 @@ namespace graphene { namespace wallet { namespace detail {
       (*_remote_debug)->debug_stream_json_objects_flush();
    }
 
+   graphene::debug_witness::debug_benchmark_result wallet_api_impl::dbg_benchmark_transactions(
+         const std::string& source, uint32_t first_block, const std::string& debug_wif_key,
+         uint32_t transactions_per_block, uint32_t max_blocks )
+   {
+      use_debug_api();
+      auto result = (*_remote_debug)->debug_benchmark_transactions( source, first_block, debug_wif_key,
+                                                                    transactions_per_block, max_blocks );
+      (*_remote_debug)->debug_stream_json_objects_flush();
+      return result;
+   }
+
    void wallet_api_impl::dbg_stream_json_objects( const std::string& filename )
    {
       use_debug_api();
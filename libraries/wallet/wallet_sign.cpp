@@ -23,6 +23,7 @@
  */
 
 #include <fc/crypto/aes.hpp>
+#include <fc/thread/parallel.hpp>
 
 #include "wallet_api_impl.hpp"
 #include <graphene/wallet/wallet.hpp>
@@ -59,6 +60,32 @@ namespace graphene { namespace wallet { namespace detail {
       return derived_key;
    }
 
+   vector<derived_key> derive_keys( const std::string& prefix_string, int first_sequence_number, int count )
+   {
+      vector<derived_key> result( count );
+      std::vector<fc::future<void>> workers;
+      workers.reserve( count );
+      for( int i = 0; i < count; ++i )
+         workers.push_back( fc::do_parallel( [&prefix_string,&result,first_sequence_number,i] () {
+            result[i].private_key = derive_private_key( prefix_string, first_sequence_number + i );
+            result[i].public_key = result[i].private_key.get_public_key();
+         } ) );
+      // all workers must be done before the result goes out of scope, even if one of them failed
+      std::exception_ptr failure;
+      for( auto& worker : workers )
+      {
+         try {
+            worker.wait();
+         } catch( ... ) {
+            if( !failure )
+               failure = std::current_exception();
+         }
+      }
+      if( failure )
+         std::rethrow_exception( failure );
+      return result;
+   }
+
    string normalize_brain_key( string s )
    {
       size_t i = 0, n = s.length();
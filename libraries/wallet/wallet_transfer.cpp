@@ -77,12 +77,130 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back(xfer_op);
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction(tx, broadcast);
    } FC_CAPTURE_AND_RETHROW( (from)(to)(amount)(asset_symbol)(memo)(broadcast) ) }
 
+   vector<signed_transaction> wallet_api_impl::transfer_many(string from, string asset_symbol,
+         vector<pair<string, string>> recipients, string memo, bool broadcast )
+   { try {
+      FC_ASSERT( !self.is_locked() );
+      FC_ASSERT( !recipients.empty(), "No recipients given" );
+      fc::optional<asset_object> asset_obj = get_asset(asset_symbol);
+      FC_ASSERT(asset_obj, "Could not find asset matching ${asset}", ("asset", asset_symbol));
+
+      account_object from_account = get_account(from);
+
+      // look up the recipients in a few large calls instead of one call per transfer
+      constexpr size_t lookup_batch_size = 1000;
+      vector<optional<account_object>> to_accounts;
+      to_accounts.reserve( recipients.size() );
+      for( size_t start = 0; start < recipients.size(); start += lookup_batch_size )
+      {
+         const size_t end = std::min( recipients.size(), start + lookup_batch_size );
+         vector<string> names;
+         names.reserve( end - start );
+         for( size_t i = start; i < end; ++i )
+            names.push_back( recipients[i].first );
+         auto found = _remote_db->get_accounts( names, {} );
+         std::move( found.begin(), found.end(), std::back_inserter( to_accounts ) );
+      }
+
+      fc::optional<fc::ecc::private_key> memo_key;
+      if( memo.size() )
+         memo_key = get_private_key( from_account.options.memo_key );
+
+      const chain_parameters params = get_global_properties().parameters;
+      const fee_schedule& fees = params.get_current_fees();
+
+      vector<operation> transfers;
+      transfers.reserve( recipients.size() );
+      for( size_t i = 0; i < recipients.size(); ++i )
+      {
+         FC_ASSERT( to_accounts[i], "Could not find account matching ${to}", ("to", recipients[i].first) );
+         transfer_operation xfer_op;
+         xfer_op.from = from_account.id;
+         xfer_op.to = to_accounts[i]->id;
+         xfer_op.amount = asset_obj->amount_from_string( recipients[i].second );
+         if( memo_key )
+         {
+            xfer_op.memo = memo_data();
+            xfer_op.memo->from = from_account.options.memo_key;
+            xfer_op.memo->to = to_accounts[i]->options.memo_key;
+            xfer_op.memo->set_message( *memo_key, to_accounts[i]->options.memo_key, memo );
+         }
+         transfers.emplace_back( std::move( xfer_op ) );
+         fees.set_fee( transfers.back() );
+      }
+
+      // every transfer needs the same authority, so ask for the keys once
+      signed_transaction probe;
+      probe.operations.push_back( transfers.front() );
+      vector<fc::ecc::private_key> signing_keys;
+      for( const public_key_type& key : get_owned_required_keys( probe ) )
+         signing_keys.push_back( get_private_key( key ) );
+
+      // compact signatures take 65 bytes each, leave a little room for the growing operation count
+      const size_t fixed_size = fc::raw::pack_size( signed_transaction() ) + signing_keys.size() * 65 + 4;
+      FC_ASSERT( fixed_size < params.maximum_transaction_size );
+
+      const auto dyn_props = get_dynamic_global_properties();
+      vector<signed_transaction> result;
+      size_t tx_size = fixed_size;
+      for( operation& op : transfers )
+      {
+         const size_t op_size = fc::raw::pack_size( op );
+         if( result.empty() || tx_size + op_size > params.maximum_transaction_size )
+         {
+            result.emplace_back();
+            tx_size = fixed_size;
+         }
+         result.back().operations.push_back( std::move( op ) );
+         tx_size += op_size;
+      }
+
+      for( signed_transaction& tx : result )
+      {
+         tx.set_reference_block( dyn_props.head_block_id );
+         tx.validate();
+         // like sign_transaction, move the expiration if the same batch was generated shortly before
+         for( uint32_t expiration_time_offset = 0; ; ++expiration_time_offset )
+         {
+            tx.set_expiration( dyn_props.time + fc::seconds(30 + expiration_time_offset) );
+            tx.clear_signatures();
+            for( const fc::ecc::private_key& key : signing_keys )
+               tx.sign( key, _chain_id );
+
+            recently_generated_transaction_record record;
+            record.generation_time = dyn_props.time;
+            record.transaction_id = tx.id();
+            if( _recently_generated_transactions.insert( record ).second )
+               break;
+         }
+      }
+
+      if( broadcast )
+      {
+         for( const signed_transaction& tx : result )
+         {
+            try
+            {
+               _remote_net_broadcast->broadcast_transaction( tx );
+            }
+            catch (const fc::exception& e)
+            {
+               elog("Caught exception while broadcasting tx ${id}:  ${e}",
+                    ("id", tx.id().str())("e", e.to_detail_string()) );
+               throw;
+            }
+         }
+      }
+
+      return result;
+   } FC_CAPTURE_AND_RETHROW( (from)(asset_symbol)(memo)(broadcast) ) }
+
    signed_transaction wallet_api_impl::htlc_create( string source, string destination, string amount,
          string asset_symbol, string hash_algorithm, const std::string& preimage_hash, uint32_t preimage_size,
          const uint32_t claim_period_seconds, const std::string& memo, bool broadcast )
@@ -114,7 +232,7 @@ namespace graphene { namespace wallet { namespace detail {
 
          signed_transaction tx;
          tx.operations.push_back(create_op);
-         set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+         set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
          tx.validate();
 
          return sign_transaction(tx, broadcast);
@@ -140,7 +258,7 @@ namespace graphene { namespace wallet { namespace detail {
 
          signed_transaction tx;
          tx.operations.push_back(update_op);
-         set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+         set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
          tx.validate();
 
          return sign_transaction(tx, broadcast);
@@ -165,7 +283,7 @@ namespace graphene { namespace wallet { namespace detail {
 
          signed_transaction tx;
          tx.operations.push_back(update_op);
-         set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+         set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
          tx.validate();
 
          return sign_transaction(tx, broadcast);
@@ -200,7 +318,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back(op);
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees());
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -230,7 +348,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction trx;
       trx.operations = {op};
-      set_operation_fees( trx, _remote_db->get_global_properties().parameters.get_current_fees());
+      set_operation_fees( trx, get_global_properties().parameters.get_current_fees());
       trx.validate();
 
       return sign_transaction(trx, broadcast);
@@ -245,7 +363,7 @@ namespace graphene { namespace wallet { namespace detail {
          op.fee_paying_account = get_object(order_id).seller;
          op.order = order_id;
          trx.operations = {op};
-         set_operation_fees( trx, _remote_db->get_global_properties().parameters.get_current_fees());
+         set_operation_fees( trx, get_global_properties().parameters.get_current_fees());
 
          trx.validate();
          return sign_transaction(trx, broadcast);
@@ -272,7 +390,7 @@ namespace graphene { namespace wallet { namespace detail {
 
       signed_transaction tx;
       tx.operations.push_back( vesting_balance_withdraw_op );
-      set_operation_fees( tx, _remote_db->get_global_properties().parameters.get_current_fees() );
+      set_operation_fees( tx, get_global_properties().parameters.get_current_fees() );
       tx.validate();
 
       return sign_transaction( tx, broadcast );
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * genesis_stream transforms a genesis JSON file in a single streaming pass, so it handles genesis files which are
+ * too large for the Python scripts in this directory. It combines what apply_patch.py, sort_objects.py and
+ * change_key_prefix.py do:
+ *
+ * - the patches are applied first, arrays under "append" are appended to and members under "replace" replaced,
+ * - then initial_assets and initial_accounts are sorted by their "id" member, which is removed,
+ * - then the key and address prefix is changed.
+ *
+ * The members of the genesis object are copied as text unless they are transformed. The elements of the large
+ * arrays are read one batch at a time and transformed on several threads, only the arrays which are sorted are
+ * kept in memory as a whole. The members are written in the order of the input.
+ */
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/thread/parallel.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bpo = boost::program_options;
+
+namespace {
+
+/// Reads the text of JSON values from a stream without parsing them
+class json_scanner
+{
+   public:
+      explicit json_scanner( std::istream& in ) : _buf( in.rdbuf() ) {}
+
+      /// @return the next character which is not white space, without consuming it, or EOF
+      int peek()
+      {
+         int c = _buf->sgetc();
+         while( c != EOF && std::isspace( c ) )
+         {
+            _buf->sbumpc();
+            c = _buf->sgetc();
+         }
+         return c;
+      }
+
+      void expect( char expected )
+      {
+         const int c = peek();
+         FC_ASSERT( c == expected, "Expected '${e}' in the genesis JSON at offset ${o}",
+                    ("e", std::string( 1, expected ))("o", _offset) );
+         next();
+      }
+
+      /// Appends the text of the next value to @p result
+      void read_value( std::string& result )
+      {
+         FC_ASSERT( peek() != EOF, "Unexpected end of the genesis JSON" );
+         int c = next();
+         result.push_back( c );
+         if( c == '"' )
+            read_string_rest( result );
+         else if( c == '{' || c == '[' )
+         {
+            uint32_t depth = 1;
+            while( depth > 0 )
+            {
+               c = next_or_fail();
+               result.push_back( c );
+               if( c == '"' )
+                  read_string_rest( result );
+               else if( c == '{' || c == '[' )
+                  ++depth;
+               else if( c == '}' || c == ']' )
+                  --depth;
+            }
+         }
+         else // a number, true, false or null
+         {
+            while( ( c = _buf->sgetc() ) != EOF && !std::isspace( c ) && c != ',' && c != ']' && c != '}' )
+               result.push_back( next() );
+         }
+      }
+
+      std::string read_string()
+      {
+         std::string text;
+         read_value( text );
+         return fc::json::from_string( text ).as_string();
+      }
+
+   private:
+      int next() { ++_offset; return _buf->sbumpc(); }
+
+      int next_or_fail()
+      {
+         const int c = next();
+         FC_ASSERT( c != EOF, "Unexpected end of the genesis JSON" );
+         return c;
+      }
+
+      void read_string_rest( std::string& result )
+      {
+         for( int c = next_or_fail(); c != '"'; c = next_or_fail() )
+         {
+            result.push_back( c );
+            if( c == '\\' )
+               result.push_back( next_or_fail() );
+         }
+         result.push_back( '"' );
+      }
+
+      std::streambuf* _buf;
+      uint64_t        _offset = 0;
+};
+
+struct transformation
+{
+   std::map< std::string, fc::variants > appends;
+   std::map< std::string, fc::variant >  replacements;
+   bool                                  sort = false;
+   bool                                  change_prefix = false;
+   std::string                           prefix_from;
+   std::string                           prefix_to;
+
+   void load_patch( const boost::filesystem::path& file )
+   {
+      const fc::variant_object patch = fc::json::from_file( file ).get_object();
+      if( patch.contains( "append" ) )
+         for( const auto& entry : patch["append"].get_object() )
+         {
+            const fc::variants& added = entry.value().get_array();
+            auto replacement = replacements.find( entry.key() );
+            if( replacement != replacements.end() )
+            {
+               // an earlier patch replaced the member, append to the replacement
+               fc::variants elements = replacement->second.get_array();
+               elements.insert( elements.end(), added.begin(), added.end() );
+               replacement->second = fc::variant( std::move( elements ) );
+               continue;
+            }
+            fc::variants& elements = appends[entry.key()];
+            elements.insert( elements.end(), added.begin(), added.end() );
+         }
+      if( patch.contains( "replace" ) )
+         for( const auto& entry : patch["replace"].get_object() )
+         {
+            replacements[entry.key()] = entry.value();
+            appends.erase( entry.key() );
+         }
+   }
+
+   bool is_sorted( const std::string& member )const
+   {
+      return sort && ( member == "initial_assets" || member == "initial_accounts" );
+   }
+
+   /// @return whether the elements of the array @p member have to be parsed
+   bool changes_elements( const std::string& member )const
+   {
+      static const std::set<std::string> keyed_members { "initial_accounts", "initial_assets", "initial_balances",
+                                                         "initial_vesting_balances", "initial_witness_candidates" };
+      return is_sorted( member ) || ( change_prefix && keyed_members.count( member ) > 0 );
+   }
+
+   std::string convert_key( const fc::variant& key )const
+   {
+      const std::string& k = key.get_string();
+      FC_ASSERT( k.compare( 0, prefix_from.size(), prefix_from ) == 0,
+                 "Key ${k} does not start with prefix ${p}", ("k", k)("p", prefix_from) );
+      return prefix_to + k.substr( prefix_from.size() );
+   }
+
+   /// Changes the prefix of the keys and addresses in an element of the array @p member
+   void transform_element( const std::string& member, fc::variant& element )const
+   {
+      if( !change_prefix )
+         return;
+      fc::mutable_variant_object obj( element.get_object() );
+      if( member == "initial_accounts" )
+      {
+         obj["owner_key"] = convert_key( obj["owner_key"] );
+         obj["active_key"] = convert_key( obj["active_key"] );
+      }
+      else if( member == "initial_assets" )
+      {
+         if( obj.find( "collateral_records" ) != obj.end() )
+         {
+            fc::variants records = obj["collateral_records"].get_array();
+            for( fc::variant& record : records )
+            {
+               fc::mutable_variant_object r( record.get_object() );
+               r["owner"] = convert_key( r["owner"] );
+               record = fc::variant( std::move( r ) );
+            }
+            obj["collateral_records"] = std::move( records );
+         }
+      }
+      else if( member == "initial_balances" || member == "initial_vesting_balances" )
+         obj["owner"] = convert_key( obj["owner"] );
+      else if( member == "initial_witness_candidates" )
+         obj["block_signing_key"] = convert_key( obj["block_signing_key"] );
+      element = fc::variant( std::move( obj ) );
+   }
+};
+
+/// Sorts the elements by their "id" member and removes it, like sort_objects.py
+void sort_by_id( fc::variants& elements )
+{
+   std::stable_sort( elements.begin(), elements.end(), []( const fc::variant& a, const fc::variant& b ) {
+      const fc::variant& ida = a.get_object()["id"];
+      const fc::variant& idb = b.get_object()["id"];
+      if( ida.is_numeric() && idb.is_numeric() )
+         return ida.as_int64() < idb.as_int64();
+      return ida.as_string() < idb.as_string();
+   } );
+   for( fc::variant& element : elements )
+   {
+      fc::mutable_variant_object obj( element.get_object() );
+      obj.erase( "id" );
+      element = fc::variant( std::move( obj ) );
+   }
+}
+
+/// Runs @p f on every index in [0, count) in chunks on several threads
+template<typename Function>
+void for_each_in_parallel( size_t count, Function f )
+{
+   constexpr size_t min_chunk_size = 1000;
+   const size_t threads = std::max( 1u, std::thread::hardware_concurrency() );
+   const size_t chunk_size = std::max( min_chunk_size, ( count + threads - 1 ) / threads );
+   std::vector<fc::future<void>> tasks;
+   for( size_t begin = 0; begin < count; begin += chunk_size )
+   {
+      const size_t end = std::min( begin + chunk_size, count );
+      tasks.push_back( fc::do_parallel( [&f,begin,end] () {
+         for( size_t i = begin; i < end; ++i )
+            f( i );
+      } ) );
+   }
+   // all tasks must be done before their data goes out of scope, even if one of them failed
+   std::exception_ptr failure;
+   for( auto& task : tasks )
+   {
+      try {
+         task.wait();
+      } catch( ... ) {
+         if( !failure )
+            failure = std::current_exception();
+      }
+   }
+   if( failure )
+      std::rethrow_exception( failure );
+}
+
+class genesis_streamer
+{
+   public:
+      static constexpr size_t batch_size = 100000;
+
+      genesis_streamer( const transformation& t, std::istream& in, std::ostream& out )
+         : _t( t ), _in( in ), _out( out ) {}
+
+      void run()
+      {
+         std::set<std::string> seen;
+         bool first = true;
+         _in.expect( '{' );
+         _out << '{';
+         if( _in.peek() != '}' )
+         {
+            for(;;)
+            {
+               const std::string member = _in.read_string();
+               _in.expect( ':' );
+               seen.insert( member );
+               write_member_name( member, first );
+               auto replacement = _t.replacements.find( member );
+               if( replacement != _t.replacements.end() )
+               {
+                  std::string skipped;
+                  _in.read_value( skipped );
+                  _out << fc::json::to_string( replacement->second );
+                  std::cerr << "replaced item " << member << "\n";
+               }
+               else if( _in.peek() == '[' && ( _t.changes_elements( member ) || _t.appends.count( member ) ) )
+                  stream_array( member );
+               else
+               {
+                  std::string value;
+                  _in.read_value( value );
+                  _out << value;
+               }
+               if( _in.peek() != ',' )
+                  break;
+               _in.expect( ',' );
+            }
+         }
+         _in.expect( '}' );
+
+         // members which only exist in the patches
+         for( const auto& append : _t.appends )
+            if( !seen.count( append.first ) )
+            {
+               std::cerr << "[WARN]  item " << append.first << " was created\n";
+               write_member_name( append.first, first );
+               fc::variants elements;
+               finish_array( append.first, elements );
+               _out << '[';
+               write_elements( elements, 0 );
+               _out << ']';
+            }
+         for( const auto& replacement : _t.replacements )
+            if( !seen.count( replacement.first ) )
+            {
+               write_member_name( replacement.first, first );
+               _out << fc::json::to_string( replacement.second );
+            }
+         _out << "}\n";
+      }
+
+   private:
+      void write_member_name( const std::string& member, bool& first )
+      {
+         if( !first )
+            _out << ',';
+         first = false;
+         _out << fc::json::to_string( member ) << ':';
+      }
+
+      void stream_array( const std::string& member )
+      {
+         const bool parse = _t.changes_elements( member );
+         const bool sorted = _t.is_sorted( member );
+         fc::variants all_elements; // the elements which are written last, all of them if the array is sorted
+         std::vector<std::string> batch;
+         size_t written = 0;
+
+         _in.expect( '[' );
+         _out << '[';
+         bool more = ( _in.peek() != ']' );
+         while( more )
+         {
+            batch.emplace_back();
+            _in.read_value( batch.back() );
+            more = ( _in.peek() == ',' );
+            if( more )
+               _in.expect( ',' );
+            if( batch.size() < batch_size && more )
+               continue;
+
+            if( !parse )
+            {
+               for( const std::string& element : batch )
+                  _out << ( written++ > 0 ? "," : "" ) << element;
+            }
+            else
+            {
+               fc::variants elements( batch.size() );
+               for_each_in_parallel( batch.size(), [this,&batch,&elements,&member,sorted]( size_t i ) {
+                  elements[i] = fc::json::from_string( batch[i] );
+                  if( !sorted )
+                     _t.transform_element( member, elements[i] );
+               } );
+               if( sorted )
+                  std::move( elements.begin(), elements.end(), std::back_inserter( all_elements ) );
+               else
+                  written = write_elements( elements, written );
+            }
+            batch.clear();
+         }
+         _in.expect( ']' );
+
+         finish_array( member, all_elements );
+         write_elements( all_elements, written );
+         _out << ']';
+         auto append = _t.appends.find( member );
+         if( append != _t.appends.end() )
+            std::cerr << "appended " << append->second.size() << " items to " << member << "\n";
+      }
+
+      /// Appends the elements from the patches to @p elements, which were not transformed yet, and transforms them
+      void finish_array( const std::string& member, fc::variants& elements )const
+      {
+         auto append = _t.appends.find( member );
+         if( append != _t.appends.end() )
+            elements.insert( elements.end(), append->second.begin(), append->second.end() );
+         if( _t.is_sorted( member ) )
+            sort_by_id( elements );
+         for_each_in_parallel( elements.size(), [this,&elements,&member]( size_t i ) {
+            _t.transform_element( member, elements[i] );
+         } );
+      }
+
+      /// @return the number of elements of the array written so far
+      size_t write_elements( const fc::variants& elements, size_t written )
+      {
+         std::vector<std::string> texts( elements.size() );
+         for_each_in_parallel( elements.size(), [&elements,&texts]( size_t i ) {
+            texts[i] = fc::json::to_string( elements[i] );
+         } );
+         for( const std::string& text : texts )
+            _out << ( written++ > 0 ? "," : "" ) << text;
+         return written;
+      }
+
+      const transformation& _t;
+      json_scanner          _in;
+      std::ostream&         _out;
+};
+
+} // anonymous namespace
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("BitShares genesis stream transformer");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("input,i", bpo::value<boost::filesystem::path>(), "Genesis file to transform")
+            ("output,o", bpo::value<boost::filesystem::path>(), "File to write the transformed genesis to")
+            ("patch,d", bpo::value<std::vector<boost::filesystem::path>>()->composing(),
+             "Patch file to apply like apply_patch.py, may be given several times")
+            ("sort", "Sort initial_assets and initial_accounts by their \"id\" member and remove it")
+            ("from,f", bpo::value<std::string>(), "Key and address prefix to replace")
+            ("to,t", bpo::value<std::string>(), "New key and address prefix")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "genesis_stream:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") || !options.count("input") || !options.count("output") )
+      {
+         std::cout << cli_options << "\n";
+         return options.count("help") ? 0 : 1;
+      }
+
+      transformation t;
+      if( options.count("patch") )
+         for( const auto& patch : options["patch"].as<std::vector<boost::filesystem::path>>() )
+            t.load_patch( patch );
+      t.sort = options.count("sort") > 0;
+      if( options.count("from") || options.count("to") )
+      {
+         t.change_prefix = true;
+         t.prefix_from = options.count("from") ? options["from"].as<std::string>() : "";
+         t.prefix_to = options.count("to") ? options["to"].as<std::string>() : "";
+      }
+
+      std::ifstream in( options["input"].as<boost::filesystem::path>().string(), std::ios::binary );
+      FC_ASSERT( in, "Unable to open the input file" );
+      const boost::filesystem::path output = options["output"].as<boost::filesystem::path>();
+      const boost::filesystem::path tmp_output = output.string() + ".tmp";
+      {
+         std::ofstream out( tmp_output.string(), std::ios::binary | std::ios::trunc );
+         FC_ASSERT( out, "Unable to open the output file" );
+         genesis_streamer( t, in, out ).run();
+         out.close();
+         FC_ASSERT( out, "Unable to write the output file" );
+      }
+      boost::filesystem::rename( tmp_output, output );
+      return 0;
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
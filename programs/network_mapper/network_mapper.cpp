@@ -5,6 +5,8 @@
 #include <fc/network/ip.hpp>
 #include <fc/network/resolve.hpp>
 #include <fc/thread/future.hpp>
+#include <fc/thread/thread.hpp>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <queue>
@@ -25,6 +27,15 @@ public:
   bool _connection_was_rejected;
   bool _done;
   fc::promise<void>::ptr _probe_complete_promise;
+  fc::future<void> _probe_task;
+
+  fc::time_point _start_time;
+  fc::microseconds _connect_latency; /// until the TCP connection was established
+  fc::microseconds _handshake_latency; /// from sending our hello message until the peer's hello arrived
+  fc::time_point _hello_sent_time;
+  uint32_t _head_block_number = 0; /// as advertised in the hello message of the peer
+  fc::time_point_sec _head_block_time;
+  std::string _user_agent;
 
 public:
   peer_probe() :
@@ -36,11 +47,29 @@ public:
     _probe_complete_promise(fc::promise<void>::create("probe_complete"))
   {}
 
+  /// Starts connecting to the peer in the background, the probe is complete when @ref _probe_complete_promise is set
   void start(const fc::ip::endpoint& endpoint_to_probe,
              const fc::ecc::private_key& my_node_id,
              const graphene::chain::chain_id_type& chain_id)
   {
     _remote = endpoint_to_probe;
+    _start_time = fc::time_point::now();
+    _probe_task = fc::async([this, my_node_id, chain_id]() {
+      try
+      {
+        connect_and_say_hello(my_node_id, chain_id);
+      }
+      catch (const fc::exception& e)
+      {
+        if (!_probe_complete_promise->ready())
+          _probe_complete_promise->set_exception(e.dynamic_copy_exception());
+      }
+    }, "probe_task");
+  }
+
+  void connect_and_say_hello(const fc::ecc::private_key& my_node_id,
+                             const graphene::chain::chain_id_type& chain_id)
+  {
     fc::future<void> connect_task = fc::async([this](){ _connection->connect_to(_remote); }, "connect_task");
     try
     {
@@ -48,10 +77,11 @@ public:
     }
     catch (const fc::timeout_exception&)
     {
-      ilog("timeout connecting to node ${endpoint}", ("endpoint", endpoint_to_probe));
+      ilog("timeout connecting to node ${endpoint}", ("endpoint", _remote));
       connect_task.cancel(__FUNCTION__);
       throw;
     }
+    _connect_latency = fc::time_point::now() - _start_time;
 
     fc::sha256::encoder shared_secret_encoder;
     fc::sha512 shared_secret = _connection->get_shared_secret();
@@ -66,6 +96,7 @@ public:
 				  chain_id,
                                   fc::variant_object());
 
+    _hello_sent_time = fc::time_point::now();
     _connection->send_message(hello);
   }
 
@@ -104,9 +135,23 @@ public:
   void on_hello_message(graphene::net::peer_connection* originating_peer,
                         const graphene::net::hello_message& hello_message_received)
   {
+    _handshake_latency = fc::time_point::now() - _hello_sent_time;
     _node_id = hello_message_received.node_public_key;
-    if (hello_message_received.user_data.contains("node_id"))
-      originating_peer->node_id = hello_message_received.user_data["node_id"].as<graphene::net::node_id_t>( 1 );
+    _user_agent = hello_message_received.user_agent;
+    const fc::variant_object& user_data = hello_message_received.user_data;
+    if (user_data.contains("node_id"))
+      originating_peer->node_id = user_data["node_id"].as<graphene::net::node_id_t>( 1 );
+    try
+    {
+      if (user_data.contains("last_known_block_number"))
+        _head_block_number = user_data["last_known_block_number"].as<uint32_t>( 1 );
+      if (user_data.contains("last_known_block_time"))
+        _head_block_time = user_data["last_known_block_time"].as<fc::time_point_sec>( 1 );
+    }
+    catch (const fc::exception&)
+    {
+      wlog("peer ${endpoint} advertised an invalid chain head", ("endpoint", _remote));
+    }
     originating_peer->send_message(graphene::net::connection_rejected_message());
   }
 
@@ -151,7 +196,8 @@ public:
   void on_connection_closed(graphene::net::peer_connection* originating_peer) override
   {
     _done = true;
-    _probe_complete_promise->set_value();
+    if (!_probe_complete_promise->ready())
+      _probe_complete_promise->set_value();
   }
 
   graphene::net::message get_message_for_item(const graphene::net::item_id& item) override
@@ -165,6 +211,32 @@ public:
   }
 };
 
+/// What the mapper learned about a node it probed
+struct probed_node
+{
+  fc::ip::endpoint endpoint;
+  fc::microseconds connect_latency;
+  fc::microseconds handshake_latency;
+  uint32_t head_block_number = 0;
+  fc::time_point_sec head_block_time;
+  std::string user_agent;
+};
+
+/// Writes the minimum, median, average and maximum of the latencies in milliseconds
+static void print_latency_stats(std::ostream& out, const char* name, std::vector<fc::microseconds> latencies)
+{
+  if (latencies.empty())
+    return;
+  std::sort(latencies.begin(), latencies.end());
+  int64_t total = 0;
+  for (const fc::microseconds& latency : latencies)
+    total += latency.count();
+  out << name << " latency (ms): min " << latencies.front().count() / 1000
+      << ", median " << latencies[latencies.size() / 2].count() / 1000
+      << ", average " << total / int64_t(latencies.size()) / 1000
+      << ", max " << latencies.back().count() / 1000 << "\n";
+}
+
 int main(int argc, char** argv)
 {
   std::queue<fc::ip::endpoint> nodes_to_visit;
@@ -172,14 +244,24 @@ int main(int argc, char** argv)
   std::set<fc::ip::endpoint> nodes_already_visited;
 
   if ( argc < 3 ) {
-     std::cerr << "Usage: " << argv[0] << " <chain-id> <seed-addr> [<seed-addr> ...]\n";
+     std::cerr << "Usage: " << argv[0] << " <chain-id> [--max-probes=<n>] <seed-addr> [<seed-addr> ...]\n";
      return 1;
   }
 
   const graphene::chain::chain_id_type chain_id( argv[1] );
+  // the number of peers which are probed at the same time
+  size_t max_probes = 64;
+  // a probe which is not complete after this time is abandoned
+  const fc::microseconds probe_timeout = fc::seconds(30);
+  const std::string max_probes_option = "--max-probes=";
   for ( int i = 2; i < argc; i++ )
   {
      std::string ep(argv[i]);
+     if (ep.compare(0, max_probes_option.size(), max_probes_option) == 0)
+     {
+        max_probes = std::max<size_t>( 1, boost::lexical_cast<size_t>( ep.substr( max_probes_option.size() ) ) );
+        continue;
+     }
      uint16_t port;
      auto pos = ep.find(':');
      if (pos > 0)
@@ -189,6 +271,11 @@ int main(int argc, char** argv)
      for (const auto& addr : fc::resolve( ep.substr( 0, pos > 0 ? pos : ep.size() ), port ))
         nodes_to_visit.push( addr );
   }
+  if (nodes_to_visit.empty())
+  {
+     std::cerr << "No seed address to start from\n";
+     return 1;
+  }
 
   fc::path data_dir = fc::temp_directory_path() / ("network_map_" + (fc::string) chain_id);
   fc::create_directories(data_dir);
@@ -198,42 +285,49 @@ int main(int argc, char** argv)
   fc::ecc::private_key my_node_id = fc::ecc::private_key::generate();
   std::map<graphene::net::node_id_t, graphene::net::address_info> address_info_by_node_id;
   std::map<graphene::net::node_id_t, std::vector<graphene::net::address_info> > connections_by_node_id;
+  std::map<graphene::net::node_id_t, probed_node> probed_nodes_by_node_id;
   std::vector<std::shared_ptr<peer_probe>> probes;
+  size_t failed_probes = 0;
 
   while (!nodes_to_visit.empty() || !probes.empty())
   {
-    while (!nodes_to_visit.empty())
+    // keep up to max_probes probes running, the connections are made in the background
+    while (!nodes_to_visit.empty() && probes.size() < max_probes)
     {
        fc::ip::endpoint remote = nodes_to_visit.front();
        nodes_to_visit.pop();
        nodes_to_visit_set.erase( remote );
        nodes_already_visited.insert( remote );
 
-       try
-       {
-          auto probe = std::make_shared<peer_probe>();
-          probe->start(remote, my_node_id, chain_id);
-          probes.emplace_back( std::move( probe ) );
-       }
-       catch (const fc::exception&)
-       {
-          std::cerr << "Failed to connect " << fc::string(remote) << " - skipping!" << std::endl;
-       }
+       auto probe = std::make_shared<peer_probe>();
+       probe->start(remote, my_node_id, chain_id);
+       probes.emplace_back( std::move( probe ) );
     }
 
     if (!probes.empty())
     {
-       fc::yield();
+       fc::usleep( fc::milliseconds(50) );
+       const fc::time_point now = fc::time_point::now();
        std::vector<std::shared_ptr<peer_probe>> running;
        for ( auto& probe : probes ) {
           if (probe->_probe_complete_promise->error())
           {
-             std::cerr << fc::string(probe->_remote) << " ran into an error!\n";
+             std::cerr << "Failed to probe " << fc::string(probe->_remote) << " - skipping!\n";
+             ++failed_probes;
              continue;
           }
           if (!probe->_probe_complete_promise->ready())
           {
-             running.push_back( probe );
+             if (now - probe->_start_time < probe_timeout)
+                running.push_back( probe );
+             else
+             {
+                std::cerr << "Timeout probing " << fc::string(probe->_remote) << " - skipping!\n";
+                ++failed_probes;
+                if (probe->_probe_task.valid() && !probe->_probe_task.ready())
+                   probe->_probe_task.cancel(__FUNCTION__);
+                probe->_connection->destroy_connection();
+             }
              continue;
           }
 
@@ -248,6 +342,14 @@ int main(int argc, char** argv)
              connections_by_node_id[this_node_info.node_id] = probe->_peers;
              if (address_info_by_node_id.find(this_node_info.node_id) == address_info_by_node_id.end())
                 address_info_by_node_id[this_node_info.node_id] = this_node_info;
+
+             probed_node& node = probed_nodes_by_node_id[this_node_info.node_id];
+             node.endpoint = probe->_remote;
+             node.connect_latency = probe->_connect_latency;
+             node.handshake_latency = probe->_handshake_latency;
+             node.head_block_number = probe->_head_block_number;
+             node.head_block_time = probe->_head_block_time;
+             node.user_agent = probe->_user_agent;
           }
 
           for (const graphene::net::address_info& info : probe->_peers)
@@ -263,13 +365,13 @@ int main(int argc, char** argv)
                 address_info_by_node_id[info.node_id] = info;
           }
        }
+       if (running.size() != probes.size())
+          std::cout << address_info_by_node_id.size() << " checked, "
+                    << running.size() << " active, "
+                    << nodes_to_visit.size() << " to do\n";
        probes = std::move( running );
-       std::cout << address_info_by_node_id.size() << " checked, "
-                 << probes.size() << " active, "
-                 << nodes_to_visit.size() << " to do\n";
     }
   }
-
   graphene::net::node_id_t seed_node_id;
   std::set<graphene::net::node_id_t> non_firewalled_nodes_set;
   for (const auto& address_info_for_node : address_info_by_node_id)
@@ -303,7 +405,13 @@ int main(int argc, char** argv)
 
   for (const auto& address_info_for_node : address_info_by_node_id)
   {
-    dot_stream << "  \"" << fc::variant( address_info_for_node.first, 1 ).as_string() << "\"[label=\"" << (std::string)address_info_for_node.second.remote_endpoint << "\"";
+    dot_stream << "  \"" << fc::variant( address_info_for_node.first, 1 ).as_string() << "\"[label=\""
+               << (std::string)address_info_for_node.second.remote_endpoint;
+    auto probed_itr = probed_nodes_by_node_id.find(address_info_for_node.first);
+    if (probed_itr != probed_nodes_by_node_id.end())
+      dot_stream << "\\n" << probed_itr->second.handshake_latency.count() / 1000 << " ms, block "
+                 << probed_itr->second.head_block_number;
+    dot_stream << "\"";
     if (address_info_for_node.second.firewalled != graphene::net::firewalled_state::not_firewalled)
       dot_stream << ",shape=rectangle";
     dot_stream << "];\n";
@@ -314,5 +422,41 @@ int main(int argc, char** argv)
 
   dot_stream << "}\n";
 
+  // the nodes we connected to, with their latencies and the chain head they advertised
+  fc::variants nodes;
+  std::vector<fc::microseconds> connect_latencies;
+  std::vector<fc::microseconds> handshake_latencies;
+  uint32_t highest_head_block_number = 0;
+  for (const auto& node_id_and_node : probed_nodes_by_node_id)
+  {
+    const probed_node& node = node_id_and_node.second;
+    fc::mutable_variant_object entry;
+    entry["node_id"] = fc::variant( node_id_and_node.first, 1 );
+    entry["endpoint"] = (std::string)node.endpoint;
+    entry["user_agent"] = node.user_agent;
+    entry["connect_latency_ms"] = node.connect_latency.count() / 1000;
+    entry["handshake_latency_ms"] = node.handshake_latency.count() / 1000;
+    entry["head_block_number"] = node.head_block_number;
+    entry["head_block_time"] = node.head_block_time;
+    entry["connections"] = connections_by_node_id[node_id_and_node.first].size();
+    nodes.emplace_back( std::move( entry ) );
+    connect_latencies.push_back( node.connect_latency );
+    handshake_latencies.push_back( node.handshake_latency );
+    highest_head_block_number = std::max( highest_head_block_number, node.head_block_number );
+  }
+  fc::json::save_to_file( nodes, data_dir / "network_nodes.json", true, 3 );
+
+  size_t nodes_behind = 0;
+  for (const auto& node_id_and_node : probed_nodes_by_node_id)
+    if (node_id_and_node.second.head_block_number + 10 < highest_head_block_number)
+      ++nodes_behind;
+  std::cout << probed_nodes_by_node_id.size() << " nodes probed, " << failed_probes << " probes failed\n";
+  print_latency_stats( std::cout, "Connect", connect_latencies );
+  print_latency_stats( std::cout, "Handshake", handshake_latencies );
+  std::cout << "Highest advertised head block " << highest_head_block_number << ", "
+            << nodes_behind << " nodes more than 10 blocks behind\n";
+  std::cout << "Wrote " << (data_dir / "network_graph.dot").string() << " and "
+            << (data_dir / "network_nodes.json").string() << "\n";
+
   return 0;
 }
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * replay_benchmark replays the blocks of an existing block log into a fresh object database and reports where the
+ * time goes: signature precomputation, the evaluation of every operation type, chain maintenance, undo sessions and
+ * the handlers of the block signals. Use it to compare releases on the same blocks.
+ */
+
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/egenesis/egenesis.hpp>
+#include <graphene/utilities/benchmark_report.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace graphene::chain;
+namespace bpo = boost::program_options;
+
+namespace {
+
+struct operation_name_visitor
+{
+   typedef std::string result_type;
+   template<typename T>
+   std::string operator()( const T& )const
+   {
+      std::string name = fc::get_typename<T>::name();
+      const size_t colon = name.rfind( ':' );
+      return colon == std::string::npos ? name : name.substr( colon + 1 );
+   }
+};
+
+std::string operation_name( size_t which )
+{
+   operation op;
+   op.set_which( which );
+   return op.visit( operation_name_visitor() );
+}
+
+genesis_state_type load_genesis( const bpo::variables_map& options )
+{
+   std::string genesis_json;
+   if( options.count("genesis-json") )
+      fc::read_file_contents( options["genesis-json"].as<boost::filesystem::path>(), genesis_json );
+   else
+   {
+      graphene::egenesis::compute_egenesis_json( genesis_json );
+      FC_ASSERT( !genesis_json.empty(), "No genesis is compiled in, use --genesis-json" );
+   }
+   genesis_state_type genesis = fc::json::from_string( genesis_json ).as<genesis_state_type>( 20 );
+   if( !options.count("genesis-json") )
+      genesis.initial_chain_id = fc::sha256::hash( genesis_json );
+   return genesis;
+}
+
+void print_phase( const char* name, uint64_t microseconds, uint64_t total,
+                  graphene::utilities::benchmark_report& results )
+{
+   results.add( std::string( name ) + " time", microseconds / 1000.0, "ms" );
+   std::cout << "   " << std::setw(20) << std::left << name << std::right << std::setw(12) << microseconds / 1000
+             << " ms " << std::setw(6) << std::setprecision(1) << std::fixed
+             << ( total > 0 ? 100.0 * microseconds / total : 0.0 ) << " %\n";
+}
+
+void report( const apply_profile& profile, uint64_t total, const database& db,
+             graphene::utilities::benchmark_report& results )
+{
+   const double seconds = total / 1000000.0;
+   results.add( "blocks per second", seconds > 0 ? profile.blocks / seconds : 0.0, "1/s", false );
+   results.add( "total time", total / 1000.0, "ms" );
+   std::cout << profile.blocks << " blocks, " << profile.transactions << " transactions in "
+             << std::setprecision(1) << std::fixed << seconds << " s, "
+             << ( seconds > 0 ? profile.blocks / seconds : 0.0 ) << " blocks per second\n";
+
+   const uint64_t accounted = profile.signature_microseconds + profile.transaction_microseconds
+                            + profile.maintenance_microseconds + profile.signal_handler_microseconds
+                            + profile.undo_microseconds;
+   print_phase( "signatures", profile.signature_microseconds, total, results );
+   print_phase( "transactions", profile.transaction_microseconds, total, results );
+   print_phase( "maintenance", profile.maintenance_microseconds, total, results );
+   print_phase( "signal handlers", profile.signal_handler_microseconds, total, results );
+   print_phase( "undo sessions", profile.undo_microseconds, total, results );
+   print_phase( "other", accounted < total ? total - accounted : 0, total, results );
+
+   std::vector<size_t> order;
+   for( size_t which = 0; which < profile.operations.size(); ++which )
+      if( profile.operations[which].count > 0 )
+         order.push_back( which );
+   std::sort( order.begin(), order.end(), [&profile]( size_t a, size_t b ) {
+      return profile.operations[a].microseconds > profile.operations[b].microseconds;
+   } );
+   std::cout << "operations, including the operations executed by proposals:\n";
+   for( size_t which : order )
+   {
+      const operation_apply_profile& op = profile.operations[which];
+      std::cout << "   " << std::setw(40) << std::left << operation_name( which ) << std::right
+                << std::setw(10) << op.count << " ops " << std::setw(10) << op.microseconds / 1000 << " ms "
+                << std::setw(8) << std::setprecision(2) << double( op.microseconds ) / op.count << " us/op\n";
+      results.add( operation_name( which ) + " time per operation", double( op.microseconds ) / op.count, "us" );
+   }
+
+   const auto& maintenances = db.get_maintenance_profiles();
+   if( !maintenances.empty() )
+      std::cout << "latest maintenances:\n";
+   for( const maintenance_profile& m : maintenances )
+   {
+      std::cout << "   block " << m.block_num << ": " << m.microseconds / 1000 << " ms";
+      for( const maintenance_phase_profile& phase : m.phases )
+         std::cout << ", " << phase.name << " " << phase.microseconds / 1000 << " ms";
+      std::cout << "\n";
+   }
+}
+
+} // anonymous namespace
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("BitShares replay benchmark");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("data-dir,d", bpo::value<boost::filesystem::path>(),
+             "Data directory of the node whose block log is replayed")
+            ("work-dir,w", bpo::value<boost::filesystem::path>()->default_value("replay_benchmark_data"),
+             "Directory for the object database of the replay, it is wiped first")
+            ("genesis-json,g", bpo::value<boost::filesystem::path>(),
+             "File to read the genesis state from, the built-in genesis is used without it")
+            ("first", bpo::value<uint32_t>()->default_value(1), "First block which is measured")
+            ("last", bpo::value<uint32_t>()->default_value(0), "Last block to replay, 0 for the end of the log")
+            ("verify-signatures", "Check the signatures of blocks and transactions, like a revalidating replay")
+            ("undo", "Apply every block in an undo session, like a node does near the head of the chain")
+            ("results", bpo::value<boost::filesystem::path>(),
+             "File to write the results to as JSON, for comparisons with compare_benchmarks.py")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "replay_benchmark:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") || !options.count("data-dir") )
+      {
+         std::cout << cli_options << "\n";
+         return options.count("help") ? 0 : 1;
+      }
+
+      block_database source;
+      source.open( fc::path( options["data-dir"].as<boost::filesystem::path>() ) / "blockchain" / "database"
+                   / "block_num_to_block" );
+      const auto last_id = source.last_id();
+      FC_ASSERT( last_id.valid(), "The block log is empty" );
+      uint32_t last = block_header::num_from_id( *last_id );
+      if( options["last"].as<uint32_t>() != 0 )
+         last = std::min( last, options["last"].as<uint32_t>() );
+      const uint32_t first = std::max( 1u, options["first"].as<uint32_t>() );
+      FC_ASSERT( first <= last, "Nothing to measure, the log ends at block ${l}", ("l", last) );
+
+      uint32_t skip = database::skip_witness_signature |
+                      database::skip_block_size_check |
+                      database::skip_merkle_check |
+                      database::skip_transaction_signatures |
+                      database::skip_transaction_dupe_check |
+                      database::skip_tapos_check |
+                      database::skip_witness_schedule_check;
+      if( options.count("verify-signatures") )
+         skip &= ~( database::skip_witness_signature | database::skip_transaction_signatures );
+      const bool with_undo = options.count("undo") > 0;
+
+      const fc::path work_dir( options["work-dir"].as<boost::filesystem::path>() );
+      fc::remove_all( work_dir );
+      fc::create_directories( work_dir );
+
+      database db;
+      db.open( work_dir, [&options]() { return load_genesis( options ); }, GRAPHENE_CURRENT_DB_VERSION );
+      if( !with_undo )
+         db._undo_db.disable();
+
+      std::cerr << "replay_benchmark:  replaying blocks 1 to " << last << ", measuring from block " << first << "\n";
+
+      apply_profile profile;
+      signed_block block;
+      fc::time_point start;
+      for( uint32_t num = db.head_block_num() + 1; num <= last; ++num )
+      {
+         FC_ASSERT( source.fetch_by_number( num, block ), "Block ${n} is missing", ("n", num) );
+         if( num == first )
+         {
+            db.set_apply_profile( &profile );
+            start = fc::time_point::now();
+         }
+         const bool measured = ( num >= first );
+
+         fc::time_point phase_start = fc::time_point::now();
+         db.precompute_parallel( block, skip ).wait();
+         if( measured )
+            profile.signature_microseconds += ( fc::time_point::now() - phase_start ).count();
+
+         if( with_undo )
+         {
+            phase_start = fc::time_point::now();
+            auto session = db._undo_db.start_undo_session();
+            uint64_t undo_microseconds = ( fc::time_point::now() - phase_start ).count();
+            db.apply_block( block, skip );
+            phase_start = fc::time_point::now();
+            session.commit();
+            undo_microseconds += ( fc::time_point::now() - phase_start ).count();
+            if( measured )
+               profile.undo_microseconds += undo_microseconds;
+         }
+         else
+            db.apply_block( block, skip );
+
+         if( num % 100000 == 0 )
+            std::cerr << "replay_benchmark:  at block " << num << "\n";
+      }
+      const uint64_t total = ( fc::time_point::now() - start ).count();
+      db.set_apply_profile( nullptr );
+
+      graphene::utilities::benchmark_report results( "replay_benchmark" );
+      results.set_parameter( "first", first );
+      results.set_parameter( "last", last );
+      results.set_parameter( "verify_signatures", options.count("verify-signatures") > 0 );
+      results.set_parameter( "undo", with_undo );
+      report( profile, total, db, results );
+      if( options.count("results") )
+         results.save( fc::path( options["results"].as<boost::filesystem::path>() ) );
+      db.close();
+      return 0;
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
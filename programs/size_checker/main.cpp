@@ -22,14 +22,30 @@
  * THE SOFTWARE.
  */
 
+/**
+ * size_checker prints the memory and wire size of the default instance of every operation type.
+ *
+ * Given the data directory of a node it profiles the operations in a range of its block log instead: the number
+ * of operations of every type, their average serialized size and the fees paid for them. With --replay the blocks
+ * are also applied to a fresh object database, which adds the measured evaluation time of every operation type.
+ */
+
+#include <fc/filesystem.hpp>
+#include <fc/io/fstream.hpp>
 #include <fc/io/json.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/variant.hpp>
 #include <fc/variant_object.hpp>
 
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/egenesis/egenesis.hpp>
 #include <graphene/protocol/block.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
 
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
 #include <algorithm>
 #include <iostream>
 #include <sstream>
@@ -37,6 +53,7 @@
 #include <vector>
 
 using namespace graphene::protocol;
+namespace bpo = boost::program_options;
 
 vector< fc::variant_object > g_op_types;
 
@@ -47,6 +64,18 @@ uint64_t get_wire_size()
    return fc::raw::pack( data ).size();
 }
 
+struct operation_name_visitor
+{
+   typedef std::string result_type;
+   template<typename Type>
+   std::string operator()( const Type& )const
+   {
+      std::string name = fc::get_typename<Type>::name();
+      const size_t colon = name.rfind( ':' );
+      return colon == std::string::npos ? name : name.substr( colon + 1 );
+   }
+};
+
 struct size_check_type_visitor
 {
    typedef void result_type;
@@ -65,10 +94,192 @@ struct size_check_type_visitor
    }
 };
 
+struct operation_fee_visitor
+{
+   typedef asset result_type;
+   template<typename Type>
+   asset operator()( const Type& op )const { return op.fee; }
+};
+
+/// What the operations of one type in the profiled blocks cost
+struct operation_cost
+{
+   uint64_t count          = 0;
+   uint64_t wire_size      = 0;
+   /// fees paid in the core asset
+   share_type core_fees    = 0;
+   /// number of operations whose fee was paid in another asset
+   uint64_t non_core_fees  = 0;
+};
+
+graphene::chain::genesis_state_type load_genesis( const bpo::variables_map& options )
+{
+   std::string genesis_json;
+   if( options.count("genesis-json") )
+      fc::read_file_contents( options["genesis-json"].as<boost::filesystem::path>(), genesis_json );
+   else
+   {
+      graphene::egenesis::compute_egenesis_json( genesis_json );
+      FC_ASSERT( !genesis_json.empty(), "No genesis is compiled in, use --genesis-json" );
+   }
+   auto genesis = fc::json::from_string( genesis_json ).as<graphene::chain::genesis_state_type>( 20 );
+   if( !options.count("genesis-json") )
+      genesis.initial_chain_id = fc::sha256::hash( genesis_json );
+   return genesis;
+}
+
+void profile_operations( const bpo::variables_map& options )
+{
+   using graphene::chain::database;
+
+   graphene::chain::block_database source;
+   source.open( fc::path( options["data-dir"].as<boost::filesystem::path>() ) / "blockchain" / "database"
+                / "block_num_to_block" );
+   const auto last_id = source.last_id();
+   FC_ASSERT( last_id.valid(), "The block log is empty" );
+   uint32_t last = block_header::num_from_id( *last_id );
+   if( options["last"].as<uint32_t>() != 0 )
+      last = std::min( last, options["last"].as<uint32_t>() );
+   const uint32_t first = std::max( 1u, options["first"].as<uint32_t>() );
+   FC_ASSERT( first <= last, "Nothing to profile, the log ends at block ${l}", ("l", last) );
+
+   // the evaluation times need the state before the first block, so all earlier blocks are replayed too
+   const bool replay = options.count("replay") > 0;
+   std::unique_ptr<database> db;
+   graphene::chain::apply_profile profile;
+   const uint32_t skip = database::skip_witness_signature |
+                         database::skip_block_size_check |
+                         database::skip_merkle_check |
+                         database::skip_transaction_signatures |
+                         database::skip_transaction_dupe_check |
+                         database::skip_tapos_check |
+                         database::skip_witness_schedule_check;
+   if( replay )
+   {
+      const fc::path work_dir( options["work-dir"].as<boost::filesystem::path>() );
+      fc::remove_all( work_dir );
+      fc::create_directories( work_dir );
+      db = std::make_unique<database>();
+      db->open( work_dir, [&options]() { return load_genesis( options ); }, GRAPHENE_CURRENT_DB_VERSION );
+      db->_undo_db.disable();
+   }
+
+   std::vector<operation_cost> costs( operation().count() );
+   signed_block block;
+   for( uint32_t num = ( replay ? db->head_block_num() + 1 : first ); num <= last; ++num )
+   {
+      FC_ASSERT( source.fetch_by_number( num, block ), "Block ${n} is missing", ("n", num) );
+      if( num >= first )
+      {
+         for( const auto& trx : block.transactions )
+            for( const operation& op : trx.operations )
+            {
+               operation_cost& cost = costs[op.which()];
+               ++cost.count;
+               cost.wire_size += fc::raw::pack_size( op );
+               const asset fee = op.visit( operation_fee_visitor() );
+               if( fee.asset_id == asset_id_type() )
+                  cost.core_fees += fee.amount;
+               else
+                  ++cost.non_core_fees;
+            }
+      }
+      if( replay )
+      {
+         if( num == first )
+            db->set_apply_profile( &profile );
+         db->precompute_parallel( block, skip ).wait();
+         db->apply_block( block, skip );
+      }
+      if( num % 100000 == 0 )
+         std::cerr << "size_checker:  at block " << num << "\n";
+   }
+   if( replay )
+   {
+      db->set_apply_profile( nullptr );
+      db->close();
+   }
+
+   // most expensive first, by evaluation time if it was measured and by size otherwise
+   vector< std::pair< double, fc::variant_object > > rows;
+   for( size_t which = 0; which < costs.size(); ++which )
+   {
+      const operation_cost& cost = costs[which];
+      const bool applied = which < profile.operations.size() && profile.operations[which].count > 0;
+      if( cost.count == 0 && !applied )
+         continue;
+      operation op;
+      op.set_which( which );
+      fc::mutable_variant_object vo;
+      vo["name"] = op.visit( operation_name_visitor() );
+      vo["count"] = cost.count;
+      vo["average_wire_size"] = cost.count > 0 ? double( cost.wire_size ) / cost.count : 0.0;
+      vo["core_fees"] = cost.core_fees;
+      vo["average_core_fee"] = cost.count > cost.non_core_fees
+                               ? double( cost.core_fees.value ) / ( cost.count - cost.non_core_fees ) : 0.0;
+      vo["non_core_fee_count"] = cost.non_core_fees;
+      double sort_key = cost.wire_size;
+      if( replay )
+      {
+         // the applied count includes the operations executed by proposals
+         const graphene::chain::operation_apply_profile measured = applied ? profile.operations[which]
+                                                                         : graphene::chain::operation_apply_profile();
+         const double microseconds_per_op = applied ? double( measured.microseconds ) / measured.count : 0.0;
+         vo["applied_count"] = measured.count;
+         vo["apply_us_per_op"] = microseconds_per_op;
+         if( microseconds_per_op > 0 && cost.count > cost.non_core_fees )
+            vo["core_fee_per_apply_ms"] = vo["average_core_fee"].as_double() * 1000 / microseconds_per_op;
+         sort_key = measured.microseconds;
+      }
+      rows.emplace_back( sort_key, vo );
+   }
+   std::stable_sort( rows.begin(), rows.end(), []( const auto& a, const auto& b ) { return a.first > b.first; } );
+
+   std::cout << "[\n";
+   for( size_t i = 0; i < rows.size(); ++i )
+      std::cout << "   " << fc::json::to_string( rows[i].second ) << ( i + 1 < rows.size() ? ",\n" : "\n" );
+   std::cout << "]\n";
+}
+
 int main( int argc, char** argv )
 {
    try
    {
+      bpo::options_description cli_options("BitShares operation size and cost checker");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("data-dir,d", bpo::value<boost::filesystem::path>(),
+             "Data directory of a node, profiles the operations in its block log instead of the default instances")
+            ("first", bpo::value<uint32_t>()->default_value(1), "First block which is profiled")
+            ("last", bpo::value<uint32_t>()->default_value(0), "Last block which is profiled, 0 for the end of the log")
+            ("replay", "Also apply the blocks to a fresh database and measure the evaluation time of the operations")
+            ("work-dir,w", bpo::value<boost::filesystem::path>()->default_value("size_checker_data"),
+             "Directory for the object database of --replay, it is wiped first")
+            ("genesis-json,g", bpo::value<boost::filesystem::path>(),
+             "File to read the genesis state of --replay from, the built-in genesis is used without it")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "size_checker:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 0;
+      }
+      if( options.count("data-dir") )
+      {
+         profile_operations( options );
+         return 0;
+      }
+
       graphene::protocol::operation op;
 
 
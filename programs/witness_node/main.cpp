@@ -35,6 +35,9 @@
 #include <graphene/grouped_orders/grouped_orders_plugin.hpp>
 #include <graphene/api_helper_indexes/api_helper_indexes.hpp>
 #include <graphene/custom_operations/custom_operations_plugin.hpp>
+#include <graphene/block_operations/block_operations_plugin.hpp>
+#include <graphene/object_changes/object_changes_plugin.hpp>
+#include <graphene/history_follower/history_follower_plugin.hpp>
 
 #include <fc/thread/thread.hpp>
 #include <fc/interprocess/signals.hpp>
@@ -120,6 +123,9 @@ int main(int argc, char** argv) {
       node->register_plugin<graphene::grouped_orders::grouped_orders_plugin>();
       node->register_plugin<graphene::api_helper_indexes::api_helper_indexes>();
       node->register_plugin<graphene::custom_operations::custom_operations_plugin>();
+      node->register_plugin<graphene::block_operations::block_operations_plugin>();
+      node->register_plugin<graphene::object_changes::object_changes_plugin>();
+      node->register_plugin<graphene::history_follower::history_follower_plugin>();
 
       // add plugin options to config
       try
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * api_stress connects many websocket clients to a running node and keeps each of them busy with a weighted mix of
+ * API calls: object lookups, order book polling, account history queries and transaction broadcasts. Clients can
+ * also subscribe to objects, like wallets and web frontends do. At the end the throughput and the latency
+ * distribution of every kind of call are printed.
+ */
+
+#include <graphene/utilities/benchmark_report.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/network/http/websocket.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bpo = boost::program_options;
+
+namespace {
+
+enum call_kind
+{
+   objects_call,
+   order_book_call,
+   history_call,
+   broadcast_call,
+   call_kind_count
+};
+
+const std::array<const char*, call_kind_count> call_kind_names =
+      { { "get_objects", "get_order_book", "get_account_history", "broadcast_transaction" } };
+
+struct stress_config
+{
+   std::string                          server;
+   std::string                          user;
+   std::string                          password;
+   uint32_t                             connections = 0;
+   uint32_t                             pipeline = 0;
+   uint32_t                             duration_seconds = 0;
+   uint32_t                             max_account = 0;
+   std::string                          base_asset;
+   std::string                          quote_asset;
+   bool                                 subscribe = false;
+   std::array<uint32_t, call_kind_count> weights {};
+   /// signed transactions to broadcast, every one of them is sent once
+   fc::variants                         transactions;
+};
+
+/// Latencies and errors of the calls of all connections
+class load_stats
+{
+   public:
+      void add( call_kind kind, const fc::microseconds& latency, bool failed )
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         _latencies[kind].push_back( latency.count() );
+         if( failed )
+            ++_errors[kind];
+      }
+
+      void add_notification()
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         ++_notifications;
+      }
+
+      void report( std::ostream& out, double seconds, graphene::utilities::benchmark_report& results )
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         out << std::fixed << std::setprecision(1);
+         for( size_t kind = 0; kind < call_kind_count; ++kind )
+         {
+            std::vector<int64_t>& samples = _latencies[kind];
+            if( samples.empty() )
+               continue;
+            std::sort( samples.begin(), samples.end() );
+            const auto percentile = [&samples]( size_t p ) { return samples[ ( samples.size() - 1 ) * p / 100 ]; };
+            out << call_kind_names[kind] << ": " << samples.size() << " calls, " << _errors[kind] << " errors, "
+                << samples.size() / seconds << " per second\n"
+                << "   latency us: median " << percentile(50) << ", 90% " << percentile(90)
+                << ", 99% " << percentile(99) << ", max " << samples.back() << "\n";
+            const std::string name = call_kind_names[kind];
+            results.add( name + " calls per second", samples.size() / seconds, "1/s", false );
+            results.add( name + " median latency", percentile(50), "us" );
+            results.add( name + " 99th percentile latency", percentile(99), "us" );
+            results.add( name + " errors", _errors[kind], "calls" );
+
+            // power of two buckets, starting at 128 us
+            int64_t bound = 128;
+            size_t counted = 0;
+            while( counted < samples.size() )
+            {
+               const size_t below = std::upper_bound( samples.begin(), samples.end(), bound ) - samples.begin();
+               if( below > counted )
+                  out << "   <= " << std::setw(9) << bound << " us: " << ( below - counted ) << "\n";
+               counted = below;
+               bound *= 2;
+            }
+         }
+         out << "notifications: " << _notifications << ", " << _notifications / seconds << " per second\n";
+         results.add( "notifications per second", _notifications / seconds, "1/s", false );
+      }
+
+   private:
+      std::mutex                                       _lock;
+      std::array<std::vector<int64_t>, call_kind_count> _latencies;
+      std::array<uint64_t, call_kind_count>             _errors {};
+      uint64_t                                         _notifications = 0;
+};
+
+/// One websocket connection which keeps a number of calls in flight until it is stopped
+class stress_connection
+{
+   public:
+      typedef std::function<void( bool failed, const fc::variant& result )> result_handler;
+
+      stress_connection( const stress_config& config, uint64_t seed, load_stats& stats,
+                         std::atomic<size_t>& next_transaction )
+         : _config( config ), _random( seed ), _stats( stats ), _next_transaction( next_transaction ) {}
+
+      void start()
+      {
+         _connection = _client.connect( _config.server );
+         _connection->on_message_handler( [this]( const std::string& message ) { on_message( message ); } );
+         call( 1, "login", { _config.user, _config.password }, [this]( bool failed, const fc::variant& ) {
+            FC_ASSERT( !failed, "Failed to log in to ${s}", ("s", _config.server) );
+            request_api( "database", _database_api, [this]() {
+               request_api( "history", _history_api, [this]() {
+                  request_api( "network_broadcast", _broadcast_api, [this]() { start_load(); } );
+               } );
+            } );
+         } );
+      }
+
+      void stop() { _stopped = true; }
+
+      void close()
+      {
+         if( _connection )
+            _connection->close( 1000, "done" );
+      }
+
+   private:
+      struct pending_call
+      {
+         int             kind;  ///< the @ref call_kind, or -1 for calls which are not measured
+         fc::time_point  start;
+         result_handler  on_result;
+      };
+
+      /// asks for the id of an API, which stays 0 if the node does not offer it
+      void request_api( const std::string& name, uint64_t& api, std::function<void()> next )
+      {
+         call( 1, name, {}, [&api,next]( bool failed, const fc::variant& result ) {
+            if( !failed && result.is_numeric() )
+               api = result.as_uint64();
+            next();
+         } );
+      }
+
+      void start_load()
+      {
+         FC_ASSERT( _database_api != 0, "The node does not offer the database API" );
+         if( _config.subscribe )
+         {
+            call( _database_api, "set_subscribe_callback", { 1, false } );
+            call( _database_api, "get_full_accounts", { fc::variants{ random_account() }, true } );
+         }
+         for( uint32_t i = 0; i < _config.pipeline; ++i )
+            send_next();
+      }
+
+      fc::variant random_account()
+      {
+         std::uniform_int_distribution<uint32_t> account( 0, _config.max_account );
+         return "1.2." + std::to_string( account( _random ) );
+      }
+
+      /// picks the next kind of call by weight, leaving out the APIs the node does not offer
+      void send_next()
+      {
+         if( _stopped )
+            return;
+         std::array<uint32_t, call_kind_count> weights = _config.weights;
+         if( _history_api == 0 )
+            weights[history_call] = 0;
+         if( _broadcast_api == 0 || _next_transaction >= _config.transactions.size() )
+            weights[broadcast_call] = 0;
+         uint32_t total = 0;
+         for( uint32_t w : weights )
+            total += w;
+         if( total == 0 )
+            return;
+
+         uint32_t pick = std::uniform_int_distribution<uint32_t>( 0, total - 1 )( _random );
+         size_t kind = 0;
+         while( pick >= weights[kind] )
+            pick -= weights[kind++];
+
+         // keep the pipeline full, whatever the outcome
+         const auto measured = [this]( bool, const fc::variant& ) { send_next(); };
+         switch( kind )
+         {
+            case objects_call:
+               call( _database_api, "get_objects", { fc::variants{ random_account() } }, measured, kind );
+               break;
+            case order_book_call:
+               call( _database_api, "get_order_book", { _config.base_asset, _config.quote_asset, 50 },
+                     measured, kind );
+               break;
+            case history_call:
+               call( _history_api, "get_account_history", { random_account(), "1.11.0", 100, "1.11.0" },
+                     measured, kind );
+               break;
+            case broadcast_call:
+            {
+               const size_t index = _next_transaction++;
+               if( index >= _config.transactions.size() )
+                  return send_next();
+               call( _broadcast_api, "broadcast_transaction", { _config.transactions[index] }, measured, kind );
+               break;
+            }
+         }
+      }
+
+      void call( uint64_t api, const std::string& method, fc::variants args, result_handler on_result = {},
+                 int kind = -1 )
+      {
+         uint64_t id;
+         {
+            std::lock_guard<std::mutex> guard( _lock );
+            id = _next_id++;
+            _pending[id] = pending_call{ kind, fc::time_point::now(), std::move( on_result ) };
+         }
+         fc::mutable_variant_object request;
+         request( "id", id )( "method", "call" )( "params", fc::variants{ api, method, std::move( args ) } );
+         _connection->send_message( fc::json::to_string( request ) );
+      }
+
+      void on_message( const std::string& message )
+      {
+         const fc::time_point now = fc::time_point::now();
+         fc::variant_object reply;
+         try
+         {
+            reply = fc::json::from_string( message ).get_object();
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "Unreadable reply: ${e}", ("e", e.to_detail_string()) );
+            return;
+         }
+
+         // subscription notifications carry no id
+         if( reply.contains( "method" ) && reply["method"].as_string() == "notice" )
+         {
+            _stats.add_notification();
+            return;
+         }
+         if( !reply.contains( "id" ) )
+            return;
+
+         pending_call done;
+         {
+            std::lock_guard<std::mutex> guard( _lock );
+            auto itr = _pending.find( reply["id"].as_uint64() );
+            if( itr == _pending.end() )
+               return;
+            done = std::move( itr->second );
+            _pending.erase( itr );
+         }
+
+         const bool failed = reply.contains( "error" );
+         if( done.kind >= 0 )
+            _stats.add( call_kind( done.kind ), now - done.start, failed );
+         if( done.on_result )
+            done.on_result( failed, failed ? fc::variant() : reply["result"] );
+      }
+
+      const stress_config&               _config;
+      std::mt19937_64                    _random;
+      load_stats&                        _stats;
+      std::atomic<size_t>&               _next_transaction;
+
+      fc::http::websocket_client         _client;
+      fc::http::websocket_connection_ptr _connection;
+      uint64_t                           _database_api = 0;
+      uint64_t                           _history_api = 0;
+      uint64_t                           _broadcast_api = 0;
+      std::atomic<bool>                  _stopped { false };
+
+      std::mutex                         _lock;
+      uint64_t                           _next_id = 1;
+      std::map<uint64_t, pending_call>   _pending;
+};
+
+} // anonymous namespace
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("BitShares API stress test");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("server,s", bpo::value<std::string>()->default_value("ws://127.0.0.1:8090"),
+             "Websocket endpoint of the node")
+            ("user,u", bpo::value<std::string>()->default_value(""), "API user name")
+            ("password,p", bpo::value<std::string>()->default_value(""), "API password")
+            ("connections,c", bpo::value<uint32_t>()->default_value(200), "Number of concurrent connections")
+            ("pipeline", bpo::value<uint32_t>()->default_value(1), "Calls every connection keeps in flight")
+            ("duration,d", bpo::value<uint32_t>()->default_value(60), "Seconds to run the load")
+            ("max-account", bpo::value<uint32_t>()->default_value(90000), "Highest account instance to query")
+            ("market", bpo::value<std::string>()->default_value("1.3.0:1.3.1"),
+             "Base and quote asset of the polled order book, separated by a colon")
+            ("subscribe", bpo::value<bool>()->default_value(true),
+             "Make every connection subscribe to an account")
+            ("weight-objects", bpo::value<uint32_t>()->default_value(50), "Weight of get_objects calls")
+            ("weight-order-book", bpo::value<uint32_t>()->default_value(25), "Weight of get_order_book calls")
+            ("weight-history", bpo::value<uint32_t>()->default_value(20), "Weight of get_account_history calls")
+            ("weight-broadcast", bpo::value<uint32_t>()->default_value(5), "Weight of broadcast_transaction calls")
+            ("transactions", bpo::value<std::string>(),
+             "JSON file with an array of signed transactions to broadcast, each one is sent once")
+            ("results", bpo::value<std::string>(),
+             "File to write the results to as JSON, for comparisons with compare_benchmarks.py")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "api_stress:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 0;
+      }
+
+      stress_config config;
+      config.server = options["server"].as<std::string>();
+      config.user = options["user"].as<std::string>();
+      config.password = options["password"].as<std::string>();
+      config.connections = options["connections"].as<uint32_t>();
+      config.pipeline = std::max( 1u, options["pipeline"].as<uint32_t>() );
+      config.duration_seconds = options["duration"].as<uint32_t>();
+      config.max_account = options["max-account"].as<uint32_t>();
+      config.subscribe = options["subscribe"].as<bool>();
+      const std::string market = options["market"].as<std::string>();
+      const size_t colon = market.find( ':' );
+      FC_ASSERT( colon != std::string::npos, "The market must be given as BASE:QUOTE" );
+      config.base_asset = market.substr( 0, colon );
+      config.quote_asset = market.substr( colon + 1 );
+      config.weights[objects_call] = options["weight-objects"].as<uint32_t>();
+      config.weights[order_book_call] = options["weight-order-book"].as<uint32_t>();
+      config.weights[history_call] = options["weight-history"].as<uint32_t>();
+      config.weights[broadcast_call] = options["weight-broadcast"].as<uint32_t>();
+      if( options.count("transactions") )
+         config.transactions = fc::json::from_file( fc::path( options["transactions"].as<std::string>() ) )
+                                  .get_array();
+
+      load_stats stats;
+      std::atomic<size_t> next_transaction { 0 };
+      std::random_device entropy;
+      std::vector<std::unique_ptr<stress_connection>> connections;
+      connections.reserve( config.connections );
+      for( uint32_t i = 0; i < config.connections; ++i )
+      {
+         connections.push_back( std::make_unique<stress_connection>( config, ( uint64_t( entropy() ) << 32 ) ^ i,
+                                                                     stats, next_transaction ) );
+         connections.back()->start();
+      }
+      std::cerr << "api_stress:  " << config.connections << " connections to " << config.server << ", running for "
+                << config.duration_seconds << " seconds\n";
+
+      const fc::time_point start = fc::time_point::now();
+      fc::usleep( fc::seconds( config.duration_seconds ) );
+      for( auto& c : connections )
+         c->stop();
+      const double seconds = double( ( fc::time_point::now() - start ).count() ) / 1000000;
+      // let the calls in flight come back before closing
+      fc::usleep( fc::seconds( 2 ) );
+      for( auto& c : connections )
+         c->close();
+
+      graphene::utilities::benchmark_report results( "api_stress" );
+      results.set_parameter( "connections", config.connections );
+      results.set_parameter( "pipeline", config.pipeline );
+      results.set_parameter( "subscribe", config.subscribe );
+      results.set_parameter( "weights", fc::variant( std::vector<uint32_t>( config.weights.begin(),
+                                                                             config.weights.end() ), 1 ) );
+      stats.report( std::cout, seconds, results );
+      if( options.count("results") )
+         results.save( fc::path( options["results"].as<std::string>() ) );
+      return 0;
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
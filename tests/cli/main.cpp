@@ -434,6 +434,42 @@ BOOST_FIXTURE_TEST_CASE( create_new_account, cli_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( cli_transfer_many, cli_fixture )
+{
+   try
+   {
+      INVOKE(create_new_account);
+
+      const auto core_balance = [this]( const string& account ) {
+         for( const asset& a : con.wallet_api_ptr->list_account_balances( account ) )
+            if( a.asset_id == asset_id_type() )
+               return a.amount;
+         return share_type();
+      };
+      const share_type jmjatlanta_before = core_balance( "jmjatlanta" );
+      const share_type init0_before = core_balance( "init0" );
+
+      BOOST_TEST_MESSAGE("Paying several accounts at once");
+      vector<pair<string, string>> recipients = { { "jmjatlanta", "1" }, { "init0", "2" }, { "jmjatlanta", "3" } };
+      vector<signed_transaction> txs = con.wallet_api_ptr->transfer_many( "nathan", "1.3.0", recipients, "", true );
+      BOOST_REQUIRE_EQUAL( txs.size(), 1u );
+      BOOST_CHECK_EQUAL( txs.front().operations.size(), 3u );
+      BOOST_CHECK( generate_block(app1) );
+
+      const int64_t precision = GRAPHENE_BLOCKCHAIN_PRECISION;
+      BOOST_CHECK_EQUAL( core_balance( "jmjatlanta" ).value, ( jmjatlanta_before + 4 * precision ).value );
+      BOOST_CHECK_EQUAL( core_balance( "init0" ).value, ( init0_before + 2 * precision ).value );
+
+      // an unknown recipient fails the whole batch
+      recipients.emplace_back( "nobody-here", "1" );
+      BOOST_CHECK_THROW( con.wallet_api_ptr->transfer_many( "nathan", "1.3.0", recipients, "", false ),
+                         fc::exception );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_FIXTURE_TEST_CASE( uia_tests, cli_fixture )
 {
    try
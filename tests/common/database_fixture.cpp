@@ -31,6 +31,7 @@
 #include <graphene/api_helper_indexes/api_helper_indexes.hpp>
 #include <graphene/es_objects/es_objects.hpp>
 #include <graphene/custom_operations/custom_operations_plugin.hpp>
+#include <graphene/block_operations/block_operations_plugin.hpp>
 
 #include <graphene/chain/balance_object.hpp>
 #include <graphene/chain/committee_member_object.hpp>
@@ -46,6 +47,7 @@
 #include <fc/crypto/digest.hpp>
 
 #include <iomanip>
+#include <map>
 
 #include "database_fixture.hpp"
 
@@ -86,6 +88,8 @@ database_fixture_base::database_fixture_base()
          fc::enable_record_assert_trip = true;
       if( arg == "--show-test-names" )
          std::cout << "running test " << current_test_name << std::endl;
+      if( arg == "--cache-genesis-state" )
+         cache_initial_state = true;
    }
 } FC_LOG_AND_RETHROW() }
 
@@ -143,6 +147,61 @@ database_fixture_base::~database_fixture_base()
 
 }
 
+bool database_fixture_base::cache_initial_state = false;
+
+namespace {
+
+/// The snapshots of @ref database_fixture_base::cache_initial_state_snapshot by the key of their setup
+std::map<string, fc::path> initial_state_snapshots;
+
+const fc::path& initial_state_snapshot_dir()
+{
+   // removed when the process exits
+   static const fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   return dir.path();
+}
+
+/// @return the key of the setup of the fixture, or an empty string if its initial state must not be cached
+string initial_state_key( const database_fixture_base& fixture )
+{
+   // the elasticsearch plugins write the initial state to the server
+   if( !fixture.es_index_prefix.empty() || !fixture.es_obj_index_prefix.empty() )
+      return string();
+   string key = fc::json::to_string( fixture.genesis_state );
+   static const std::vector<string> plugins { "account_history", "market_history", "grouped_orders",
+         "api_helper_indexes", "custom_operations", "block_operations", "elasticsearch", "es_objects" };
+   for( const auto& name : plugins )
+   {
+      if( fixture.app.is_plugin_enabled( name ) )
+         key += " " + name;
+   }
+   if( !fixture.db.is_standby_votes_tracking_enabled() )
+      key += " no-standby-votes";
+   return fc::sha256::hash( key ).str();
+}
+
+} // anonymous namespace
+
+fc::path database_fixture_base::find_cached_initial_state()const
+{
+   if( !cache_initial_state )
+      return fc::path();
+   auto itr = initial_state_snapshots.find( initial_state_key( *this ) );
+   return itr == initial_state_snapshots.end() ? fc::path() : itr->second;
+}
+
+void database_fixture_base::cache_initial_state_snapshot()const
+{
+   if( !cache_initial_state )
+      return;
+   const string key = initial_state_key( *this );
+   if( key.empty() || initial_state_snapshots.find( key ) != initial_state_snapshots.end() )
+      return;
+   const fc::path file = initial_state_snapshot_dir() / ( key + ".snapshot" );
+   db.save_state_snapshot( file );
+   initial_state_snapshots[key] = file;
+}
+
 void database_fixture_base::init_genesis( database_fixture_base& fixture )
 {
    fixture.genesis_state.initial_timestamp = fc::time_point_sec(GRAPHENE_TESTING_GENESIS_TIMESTAMP);
@@ -200,6 +259,29 @@ std::shared_ptr<boost::program_options::variables_map> database_fixture_base::in
    {
       fc::set_option( options, "max-ops-per-account", (uint64_t)75 );
    }
+   if (fixture.current_test_name == "deferred_account_history_trimming")
+   {
+      fc::set_option( options, "max-ops-per-account", (uint64_t)3 );
+      fc::set_option( options, "account-history-trim-batch-size", (uint64_t)2 );
+   }
+   if (fixture.current_test_name == "account_history_store")
+   {
+      fc::set_option( options, "max-ops-per-account", (uint64_t)5 );
+      fc::set_option( options, "partial-operations", true );
+      fc::set_option( options, "account-history-store", true );
+   }
+   if (fixture.current_test_name == "market_history_store")
+   {
+      fc::set_option( options, "history-per-size", (uint32_t)2 );
+      fc::set_option( options, "market-history-store", true );
+   }
+   if (fixture.current_test_name == "liquidity_pool_history_compaction_test")
+   {
+      fc::set_option( options, "max-order-his-records-per-market", (uint32_t)2 );
+      fc::set_option( options, "max-order-his-seconds-per-market", (uint32_t)60 );
+      fc::set_option( options, "liquidity-pool-history-compaction-interval", (uint32_t)3600 );
+      fc::set_option( options, "liquidity-pool-history-intervals-per-pool", (uint32_t)2 );
+   }
    if (fixture.current_test_name == "api_limit_get_account_history_operations")
    {
       fc::set_option( options, "max-ops-per-account", (uint64_t)125 );
@@ -373,18 +455,26 @@ std::shared_ptr<boost::program_options::variables_map> database_fixture_base::in
    if( fixture.current_test_name == "asset_in_collateral"
             || fixture.current_test_name == "htlc_database_api"
             || fixture.current_test_name == "liquidity_pool_apis_test"
+            || fixture.current_test_name == "credit_offer_apis_test"
             || fixture.current_suite_name == "database_api_tests"
+            || fixture.current_suite_name == "asset_api_tests"
             || fixture.current_suite_name == "api_limit_tests" )
    {
       fixture.app.register_plugin<graphene::api_helper_indexes::api_helper_indexes>(true);
    }
 
    if(fixture.current_test_name == "custom_operations_account_storage_map_test" ||
-      fixture.current_test_name == "custom_operations_account_storage_list_test") {
+      fixture.current_test_name == "custom_operations_account_storage_list_test" ||
+      fixture.current_test_name == "custom_operations_value_store_test") {
       fixture.app.register_plugin<graphene::custom_operations::custom_operations_plugin>(true);
       fc::set_option( options, "custom-operations-start-block", uint32_t(1) );
+      if( fixture.current_test_name == "custom_operations_value_store_test" )
+         fc::set_option( options, "custom-operations-store-values", true );
    }
 
+   if( fixture.current_test_name == "get_block_operations" )
+      fixture.app.register_plugin<graphene::block_operations::block_operations_plugin>(true);
+
    fc::set_option( options, "bucket-size", string("[15]") );
 
    fixture.app.register_plugin<graphene::market_history::market_history_plugin>(true);
@@ -235,6 +235,19 @@ struct database_fixture_base {
    static void init_genesis( database_fixture_base& fixture );
    static std::shared_ptr<boost::program_options::variables_map> init_options( database_fixture_base& fixture );
 
+   /// Set by the command line argument --cache-genesis-state, see @ref find_cached_initial_state
+   static bool cache_initial_state;
+   /**
+    * With --cache-genesis-state, the state after the first block of a test case is saved as a state snapshot and
+    * loaded by later test cases of the process with the same genesis state and plugins, instead of building it
+    * again. Test cases which undo the first block or whose options change the initial state otherwise must not
+    * run in this mode.
+    * @return the snapshot for the fixture, or an empty path if there is none or the mode is disabled
+    */
+   fc::path find_cached_initial_state()const;
+   /// Saves the current state for @ref find_cached_initial_state, if the mode is enabled
+   void cache_initial_state_snapshot()const;
+
    static fc::ecc::private_key generate_private_key(string seed);
    string generate_anon_acct_name();
    static void verify_asset_supplies( const database& db );
@@ -595,10 +608,17 @@ struct database_fixture_init : database_fixture_base {
       fc::json::save_to_file( fixture.genesis_state, fixture.data_dir.path() / "genesis.json" );
       auto options = F::init_options( fixture );
       fc::set_option( *options, "genesis-json", boost::filesystem::path(fixture.data_dir.path() / "genesis.json") );
+      const fc::path cached_state = fixture.find_cached_initial_state();
+      if( !cached_state.empty() )
+         fc::set_option( *options, "load-state-snapshot", cached_state.generic_string() );
       fixture.app.initialize( fixture.data_dir.path(), options );
       fixture.app.startup();
 
-      fixture.generate_block();
+      if( cached_state.empty() )
+      {
+         fixture.generate_block();
+         fixture.cache_initial_state_snapshot();
+      }
 
       test::set_expiration( fixture.db, fixture.trx );
    } FC_LOG_AND_RETHROW() }
@@ -0,0 +1,627 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * p2p_benchmark starts many p2p nodes in one process, connected over the loopback interface, and measures how
+ * transactions and blocks propagate through them. Every node runs the real graphene::net::node with a delegate which
+ * keeps the items in memory and accepts all of them, so that only the relay code is measured. At the end the
+ * distributions of the propagation delays and the bytes sent by message type are printed.
+ */
+
+#include <graphene/net/core_messages.hpp>
+#include <graphene/net/node.hpp>
+#include <graphene/protocol/block.hpp>
+#include <graphene/protocol/transfer.hpp>
+#include <graphene/utilities/benchmark_report.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bpo = boost::program_options;
+
+using graphene::net::item_hash_t;
+using graphene::net::item_id;
+using graphene::protocol::block_header;
+using graphene::protocol::block_id_type;
+using graphene::protocol::signed_block;
+using graphene::protocol::signed_transaction;
+
+namespace {
+
+struct benchmark_config
+{
+   uint32_t nodes = 0;
+   uint32_t peers = 0;
+   uint32_t blocks = 0;
+   uint32_t block_transactions = 0;
+   uint32_t block_interval_ms = 0;
+   uint32_t hop_delay_ms = 0;
+   uint32_t upload_limit = 0;
+   uint32_t download_limit = 0;
+   uint32_t io_threads = 0;
+   uint32_t settle_seconds = 0;
+   uint32_t seed = 0;
+};
+
+/// The times at which items were broadcast and at which they reached the other nodes
+class propagation_tracker
+{
+   public:
+      explicit propagation_tracker( uint32_t receivers ) : _receivers( receivers ) {}
+
+      void sent( const fc::ripemd160& item )
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         _items[item].sent = fc::time_point::now();
+      }
+
+      void received( const fc::ripemd160& item )
+      {
+         const fc::time_point now = fc::time_point::now();
+         std::lock_guard<std::mutex> guard( _lock );
+         auto itr = _items.find( item );
+         if( itr != _items.end() )
+            itr->second.delays.push_back( ( now - itr->second.sent ).count() );
+      }
+
+      /// @return true if every item reached every node
+      bool complete()const
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         return std::all_of( _items.begin(), _items.end(), [this]( const auto& entry ) {
+            return entry.second.delays.size() >= _receivers;
+         } );
+      }
+
+      void report( std::ostream& out, const std::string& what, graphene::utilities::benchmark_report& results )const
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         if( _items.empty() )
+            return;
+         std::vector<int64_t> all_delays;
+         std::vector<int64_t> half_delays;
+         std::vector<int64_t> most_delays;
+         std::vector<int64_t> full_delays;
+         size_t incomplete = 0;
+         for( const auto& entry : _items )
+         {
+            std::vector<int64_t> delays = entry.second.delays;
+            std::sort( delays.begin(), delays.end() );
+            all_delays.insert( all_delays.end(), delays.begin(), delays.end() );
+            // the delay until the given share of the other nodes had the item
+            const auto reached = [this,&delays]( uint32_t percent, std::vector<int64_t>& result ) {
+               const size_t needed = std::max<size_t>( 1, ( size_t(_receivers) * percent + 99 ) / 100 );
+               if( delays.size() >= needed )
+                  result.push_back( delays[needed - 1] );
+            };
+            reached( 50, half_delays );
+            reached( 90, most_delays );
+            reached( 100, full_delays );
+            if( delays.size() < _receivers )
+               ++incomplete;
+         }
+         out << what << ": " << _items.size() << " broadcast, " << incomplete << " did not reach every node\n";
+         results.add( what + " not reaching every node", incomplete, "items" );
+         print_distribution( out, what, "delay to each node", std::move( all_delays ), results );
+         print_distribution( out, what, "until 50% of the nodes", std::move( half_delays ), results );
+         print_distribution( out, what, "until 90% of the nodes", std::move( most_delays ), results );
+         print_distribution( out, what, "until all nodes", std::move( full_delays ), results );
+      }
+
+   private:
+      struct item_record
+      {
+         fc::time_point       sent;
+         std::vector<int64_t> delays;  ///< in microseconds, one for every node which received the item
+      };
+
+      static void print_distribution( std::ostream& out, const std::string& items, const std::string& what,
+                                      std::vector<int64_t> samples, graphene::utilities::benchmark_report& results )
+      {
+         if( samples.empty() )
+            return;
+         std::sort( samples.begin(), samples.end() );
+         const auto percentile = [&samples]( size_t p ) {
+            return samples[ ( samples.size() - 1 ) * p / 100 ] / 1000.0;
+         };
+         out << std::fixed << std::setprecision(1)
+             << "   " << what << " ms: median " << percentile(50) << ", 90% " << percentile(90)
+             << ", 99% " << percentile(99) << ", max " << samples.back() / 1000.0 << "\n";
+         results.add( items + " " + what + " median", percentile(50), "ms" );
+         results.add( items + " " + what + " 99th percentile", percentile(99), "ms" );
+      }
+
+      const uint32_t                           _receivers;
+      mutable std::mutex                       _lock;
+      std::map<fc::ripemd160, item_record>     _items;
+};
+
+/**
+ * Keeps the blocks and transactions of one node in memory and accepts every one of them. The blocks are not
+ * validated and never cause a fork, the block with the highest number is the head.
+ */
+class benchmark_delegate : public graphene::net::node_delegate
+{
+   public:
+      benchmark_delegate( const benchmark_config& config, fc::time_point_sec genesis_time,
+                          propagation_tracker& block_tracker, propagation_tracker& transaction_tracker )
+         : _config( config ), _genesis_time( genesis_time ),
+           _block_tracker( block_tracker ), _transaction_tracker( transaction_tracker ) {}
+
+      /// @return false if the block was known already
+      bool store_block( const signed_block& block )
+      {
+         const block_id_type id = block.id();
+         std::lock_guard<std::mutex> guard( _lock );
+         if( !_blocks.emplace( id, block ).second )
+            return false;
+         const uint32_t num = block.block_num();
+         if( num > _chain.size() )
+            _chain.resize( num );
+         _chain[num - 1] = id;
+         return true;
+      }
+
+      /// @return false if the transaction was known already
+      bool store_transaction( const graphene::protocol::precomputable_transaction& trx )
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         return _transactions.emplace( trx.id(), trx ).second;
+      }
+
+      bool has_item( const item_id& id ) override
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         if( id.item_type == graphene::net::block_message_type )
+            return _blocks.find( id.item_hash ) != _blocks.end();
+         return _transactions.find( id.item_hash ) != _transactions.end();
+      }
+
+      bool handle_block( const graphene::net::block_message& blk_msg, bool ) override
+      {
+         simulate_hop_delay();
+         if( store_block( blk_msg.block ) )
+            _block_tracker.received( blk_msg.block_id );
+         return false;
+      }
+
+      void handle_transaction( const graphene::net::trx_message& trx_msg ) override
+      {
+         simulate_hop_delay();
+         if( store_transaction( trx_msg.trx ) )
+            _transaction_tracker.received( trx_msg.trx.id() );
+      }
+
+      void handle_message( const graphene::net::message& ) override {}
+
+      std::vector<item_hash_t> get_block_ids( const std::vector<item_hash_t>& blockchain_synopsis,
+                                              uint32_t& remaining_item_count, uint32_t limit ) override
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         remaining_item_count = 0;
+         uint32_t last_known_num = 0;
+         for( auto itr = blockchain_synopsis.rbegin(); itr != blockchain_synopsis.rend(); ++itr )
+            if( _blocks.find( *itr ) != _blocks.end() )
+            {
+               last_known_num = block_header::num_from_id( *itr );
+               break;
+            }
+         std::vector<item_hash_t> result;
+         for( uint32_t num = std::max( last_known_num, 1u ); num <= _chain.size() && result.size() < limit; ++num )
+            result.push_back( _chain[num - 1] );
+         if( !result.empty() )
+            remaining_item_count = _chain.size() - block_header::num_from_id( result.back() );
+         return result;
+      }
+
+      graphene::net::message get_item( const item_id& id ) override
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         if( id.item_type == graphene::net::block_message_type )
+         {
+            auto itr = _blocks.find( id.item_hash );
+            FC_ASSERT( itr != _blocks.end(), "Unknown block ${id}", ("id", id.item_hash) );
+            return graphene::net::block_message( itr->second );
+         }
+         auto itr = _transactions.find( id.item_hash );
+         FC_ASSERT( itr != _transactions.end(), "Unknown transaction ${id}", ("id", id.item_hash) );
+         return graphene::net::trx_message( itr->second );
+      }
+
+      std::vector<std::vector<char>> get_packed_blocks( uint32_t first_block_num, uint32_t count,
+                                                        size_t max_total_size ) override
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         std::vector<std::vector<char>> result;
+         size_t total_size = 0;
+         for( uint32_t num = std::max( first_block_num, 1u );
+              num <= _chain.size() && result.size() < count; ++num )
+         {
+            auto itr = _blocks.find( _chain[num - 1] );
+            if( itr == _blocks.end() )
+               break;
+            std::vector<char> packed = fc::raw::pack( itr->second );
+            if( total_size + packed.size() > max_total_size )
+               break;
+            total_size += packed.size();
+            result.push_back( std::move( packed ) );
+         }
+         return result;
+      }
+
+      graphene::protocol::chain_id_type get_chain_id()const override { return graphene::protocol::chain_id_type(); }
+
+      /// The delegate never switches forks, so the synopsis always describes the head of its chain
+      std::vector<item_hash_t> get_blockchain_synopsis( const item_hash_t&, uint32_t ) override
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         std::vector<item_hash_t> synopsis;
+         const uint32_t head_num = _chain.size();
+         for( uint32_t distance = 0; distance < head_num; distance = ( distance > 0 ? distance * 2 : 1 ) )
+            synopsis.push_back( _chain[head_num - 1 - distance] );
+         std::reverse( synopsis.begin(), synopsis.end() );
+         return synopsis;
+      }
+
+      void sync_status( uint32_t, uint32_t ) override {}
+      void connection_count_changed( uint32_t ) override {}
+
+      uint32_t get_block_number( const item_hash_t& block_id ) override
+      {
+         return block_header::num_from_id( block_id );
+      }
+
+      fc::time_point_sec get_block_time( const item_hash_t& block_id ) override
+      {
+         if( block_id == item_hash_t() )
+            return _genesis_time;
+         std::lock_guard<std::mutex> guard( _lock );
+         auto itr = _blocks.find( block_id );
+         return itr != _blocks.end() ? itr->second.timestamp : fc::time_point_sec::min();
+      }
+
+      item_hash_t get_head_block_id()const override
+      {
+         std::lock_guard<std::mutex> guard( _lock );
+         return _chain.empty() ? item_hash_t() : _chain.back();
+      }
+
+      uint32_t estimate_last_known_fork_from_git_revision_timestamp( uint32_t ) const override { return 0; }
+
+      void error_encountered( const std::string& message, const fc::oexception& error ) override
+      {
+         elog( "${message}: ${error}", ("message", message)("error", error ? error->to_detail_string() : "") );
+      }
+
+      uint8_t get_current_block_interval_in_seconds()const override
+      {
+         return uint8_t( std::max( 1u, std::min( 255u, _config.block_interval_ms / 1000 ) ) );
+      }
+
+   private:
+      /// Holds the item up like validation and a slower link would, other items are handled meanwhile
+      void simulate_hop_delay()const
+      {
+         if( _config.hop_delay_ms > 0 )
+            fc::usleep( fc::milliseconds( _config.hop_delay_ms ) );
+      }
+
+      const benchmark_config&                                            _config;
+      const fc::time_point_sec                                           _genesis_time;
+      propagation_tracker&                                               _block_tracker;
+      propagation_tracker&                                               _transaction_tracker;
+
+      mutable std::mutex                                                 _lock;
+      std::map<block_id_type, signed_block>                              _blocks;
+      std::vector<block_id_type>                                         _chain;  ///< the block IDs by number - 1
+      std::map<graphene::protocol::transaction_id_type,
+               graphene::protocol::precomputable_transaction>            _transactions;
+};
+
+struct benchmark_node
+{
+   std::unique_ptr<fc::thread>            delegate_thread;
+   std::shared_ptr<benchmark_delegate>    delegate;
+   std::shared_ptr<graphene::net::node>   node;
+   fc::ip::endpoint                       endpoint;
+};
+
+/// A transfer signed by a fixed key, @p sequence makes it unique
+signed_transaction make_transaction( uint64_t sequence, const fc::ecc::private_key& key )
+{
+   graphene::protocol::transfer_operation op;
+   op.from = graphene::protocol::account_id_type( 100 + sequence % 1000 );
+   op.to = graphene::protocol::account_id_type( 100 + ( sequence * 7 + 1 ) % 1000 );
+   op.amount = graphene::protocol::asset( int64_t( sequence ) );
+   op.fee = graphene::protocol::asset( 10000 );
+   signed_transaction trx;
+   trx.operations.push_back( op );
+   trx.expiration = fc::time_point_sec( fc::time_point::now() ) + 3600;
+   trx.sign( key, graphene::protocol::chain_id_type() );
+   return trx;
+}
+
+/// Sums the bytes and messages which all nodes sent to their peers, by message type
+void report_traffic( std::ostream& out, const std::vector<benchmark_node>& nodes, uint64_t payload_bytes,
+                     graphene::utilities::benchmark_report& results )
+{
+   std::map<std::string, std::pair<uint64_t, uint64_t>> sent_by_type;  // messages and bytes
+   uint64_t total_bytes = 0;
+   for( const benchmark_node& n : nodes )
+   {
+      const fc::variant_object metrics = n.node->network_get_metrics();
+      for( const fc::variant& peer : metrics["peers"].get_array() )
+         for( const fc::variant& entry : peer["sent"].get_array() )
+         {
+            auto& counters = sent_by_type[ entry["type"].as_string() ];
+            counters.first += entry["messages"].as_uint64();
+            counters.second += entry["bytes"].as_uint64();
+            total_bytes += entry["bytes"].as_uint64();
+         }
+   }
+   out << "bytes sent: " << total_bytes << ", " << total_bytes / std::max<size_t>( 1, nodes.size() )
+       << " per node";
+   if( payload_bytes > 0 )
+      out << std::fixed << std::setprecision(2) << ", " << double( total_bytes ) / payload_bytes
+          << " times the serialized items delivered to every node";
+   out << "\n";
+   results.add( "bytes sent per node", double( total_bytes ) / std::max<size_t>( 1, nodes.size() ), "bytes" );
+   for( const auto& entry : sent_by_type )
+   {
+      out << "   " << entry.first << ": " << entry.second.first << " messages, " << entry.second.second
+          << " bytes\n";
+      results.add( entry.first + " bytes sent", entry.second.second, "bytes" );
+   }
+}
+
+/// Waits until @p done returns true or @p timeout passed, @return the result of the last call of @p done
+template<typename Condition>
+bool wait_for( Condition done, const fc::microseconds& timeout )
+{
+   const fc::time_point deadline = fc::time_point::now() + timeout;
+   while( !done() )
+   {
+      if( fc::time_point::now() >= deadline )
+         return done();
+      fc::usleep( fc::milliseconds( 50 ) );
+   }
+   return true;
+}
+
+void sleep_until( const fc::time_point& when )
+{
+   const fc::time_point now = fc::time_point::now();
+   if( when > now )
+      fc::usleep( when - now );
+}
+
+} // anonymous namespace
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("BitShares p2p propagation benchmark");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("nodes,n", bpo::value<uint32_t>()->default_value(20), "Number of nodes")
+            ("peers,p", bpo::value<uint32_t>()->default_value(4),
+             "Number of earlier started nodes every node connects to")
+            ("blocks,b", bpo::value<uint32_t>()->default_value(20), "Number of blocks to broadcast")
+            ("block-transactions,t", bpo::value<uint32_t>()->default_value(100),
+             "Transactions broadcast before every block and included in it")
+            ("block-interval-ms", bpo::value<uint32_t>()->default_value(1000), "Time between two blocks")
+            ("hop-delay-ms", bpo::value<uint32_t>()->default_value(0),
+             "Time every node holds an item before it relays it, simulates validation and link latency")
+            ("upload-limit", bpo::value<uint32_t>()->default_value(0),
+             "Upload limit of every node in bytes per second, 0 for none")
+            ("download-limit", bpo::value<uint32_t>()->default_value(0),
+             "Download limit of every node in bytes per second, 0 for none")
+            ("io-threads", bpo::value<uint32_t>()->default_value(0),
+             "Number of socket I/O threads of every node, see p2p-io-threads of the witness node")
+            ("settle-seconds", bpo::value<uint32_t>()->default_value(10),
+             "Maximum time to wait for the last items to reach every node")
+            ("seed", bpo::value<uint32_t>()->default_value(1), "Seed of the random topology and origins")
+            ("results", bpo::value<std::string>(),
+             "File to write the results to as JSON, for comparisons with compare_benchmarks.py")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "p2p_benchmark:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 0;
+      }
+
+      benchmark_config config;
+      config.nodes = std::max( 2u, options["nodes"].as<uint32_t>() );
+      config.peers = std::max( 1u, options["peers"].as<uint32_t>() );
+      config.blocks = options["blocks"].as<uint32_t>();
+      config.block_transactions = options["block-transactions"].as<uint32_t>();
+      config.block_interval_ms = std::max( 1u, options["block-interval-ms"].as<uint32_t>() );
+      config.hop_delay_ms = options["hop-delay-ms"].as<uint32_t>();
+      config.upload_limit = options["upload-limit"].as<uint32_t>();
+      config.download_limit = options["download-limit"].as<uint32_t>();
+      config.io_threads = options["io-threads"].as<uint32_t>();
+      config.settle_seconds = options["settle-seconds"].as<uint32_t>();
+      config.seed = options["seed"].as<uint32_t>();
+
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::time_point_sec genesis_time( fc::time_point::now() );
+      propagation_tracker block_tracker( config.nodes - 1 );
+      propagation_tracker transaction_tracker( config.nodes - 1 );
+
+      std::vector<benchmark_node> nodes( config.nodes );
+      for( uint32_t i = 0; i < config.nodes; ++i )
+      {
+         benchmark_node& n = nodes[i];
+         n.delegate_thread = std::make_unique<fc::thread>( "p2p_delegate_" + std::to_string( i ) );
+         n.delegate = std::make_shared<benchmark_delegate>( config, genesis_time, block_tracker,
+                                                            transaction_tracker );
+         n.node = std::make_shared<graphene::net::node>( "p2p_benchmark" );
+         n.node->load_configuration( data_dir.path() / std::to_string( i ) );
+         if( config.io_threads > 0 )
+            n.node->set_network_io_thread_count( config.io_threads );
+         // the delegate is called in the thread which registers it, give every node its own like a separate process
+         n.delegate_thread->async( [&n]() { n.node->set_node_delegate( n.delegate ); } ).wait();
+
+         // keep the nodes from connecting to more peers than they are given below
+         fc::mutable_variant_object parameters;
+         parameters["desired_number_of_connections"] = config.peers;
+         parameters["maximum_number_of_connections"] = config.nodes;
+         n.node->set_advanced_node_parameters( parameters );
+         if( config.upload_limit > 0 || config.download_limit > 0 )
+            n.node->set_total_bandwidth_limit(
+                  config.upload_limit > 0 ? config.upload_limit : std::numeric_limits<uint32_t>::max(),
+                  config.download_limit > 0 ? config.download_limit : std::numeric_limits<uint32_t>::max() );
+
+         n.node->listen_on_endpoint( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ), false );
+         n.node->listen_to_p2p_network();
+         n.node->connect_to_p2p_network();
+         n.node->sync_from( item_id( graphene::net::block_message_type, item_hash_t() ), std::vector<uint32_t>() );
+         n.endpoint = n.node->get_actual_listening_endpoint();
+      }
+
+      // every node connects to random earlier nodes, so that the network is connected
+      std::mt19937 random( config.seed );
+      uint64_t connections = 0;
+      for( uint32_t i = 1; i < config.nodes; ++i )
+      {
+         std::vector<uint32_t> earlier( i );
+         std::iota( earlier.begin(), earlier.end(), 0u );
+         std::shuffle( earlier.begin(), earlier.end(), random );
+         earlier.resize( std::min( i, config.peers ) );
+         for( uint32_t peer : earlier )
+         {
+            nodes[i].node->connect_to_endpoint( nodes[peer].endpoint );
+            ++connections;
+         }
+      }
+      const auto connection_ends = [&nodes]() {
+         uint64_t count = 0;
+         for( const benchmark_node& n : nodes )
+            count += n.node->get_connection_count();
+         return count;
+      };
+      wait_for( [&]() { return connection_ends() >= 2 * connections; }, fc::seconds(30) );
+      std::cerr << "p2p_benchmark:  " << config.nodes << " nodes, " << connection_ends() / 2 << " of "
+                << connections << " connections established\n";
+
+      const fc::ecc::private_key key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string("p2p") ) );
+      std::uniform_int_distribution<uint32_t> origin( 0, config.nodes - 1 );
+      const fc::microseconds block_interval = fc::milliseconds( config.block_interval_ms );
+      uint64_t sequence = 0;
+      uint64_t payload_bytes = 0;
+      block_id_type previous_id;
+      for( uint32_t b = 0; b < config.blocks; ++b )
+      {
+         const fc::time_point start = fc::time_point::now();
+         signed_block block;
+         block.previous = previous_id;
+         block.witness = graphene::protocol::witness_id_type( b % 21 );
+         // the transactions of the block are spread over the block interval, like they arrive from wallets
+         for( uint32_t t = 0; t < config.block_transactions; ++t )
+         {
+            const signed_transaction trx = make_transaction( ++sequence, key );
+            benchmark_node& from = nodes[ origin( random ) ];
+            from.delegate->store_transaction( graphene::protocol::precomputable_transaction( trx ) );
+            transaction_tracker.sent( trx.id() );
+            from.node->broadcast( graphene::net::trx_message( trx ) );
+            payload_bytes += fc::raw::pack_size( trx ) * ( config.nodes - 1 );
+            block.transactions.emplace_back( trx );
+            sleep_until( start + fc::microseconds( block_interval.count() * ( t + 1 )
+                                                   / ( config.block_transactions + 1 ) ) );
+         }
+         block.timestamp = fc::time_point_sec( fc::time_point::now() );
+         block.transaction_merkle_root = block.calculate_merkle_root();
+
+         benchmark_node& from = nodes[ origin( random ) ];
+         from.delegate->store_block( block );
+         block_tracker.sent( block.id() );
+         from.node->broadcast( graphene::net::block_message( block ) );
+         payload_bytes += fc::raw::pack_size( block ) * ( config.nodes - 1 );
+         previous_id = block.id();
+         sleep_until( start + block_interval );
+      }
+      wait_for( [&]() { return block_tracker.complete() && transaction_tracker.complete(); },
+                fc::seconds( config.settle_seconds ) );
+
+      graphene::utilities::benchmark_report results( "p2p_benchmark" );
+      results.set_parameter( "nodes", config.nodes );
+      results.set_parameter( "peers", config.peers );
+      results.set_parameter( "blocks", config.blocks );
+      results.set_parameter( "block_transactions", config.block_transactions );
+      results.set_parameter( "block_interval_ms", config.block_interval_ms );
+      results.set_parameter( "hop_delay_ms", config.hop_delay_ms );
+      results.set_parameter( "upload_limit", config.upload_limit );
+      results.set_parameter( "download_limit", config.download_limit );
+      results.set_parameter( "io_threads", config.io_threads );
+      transaction_tracker.report( std::cout, "transactions", results );
+      block_tracker.report( std::cout, "blocks", results );
+      report_traffic( std::cout, nodes, payload_bytes, results );
+      if( options.count("results") )
+         results.save( fc::path( options["results"].as<std::string>() ) );
+
+      for( benchmark_node& n : nodes )
+         n.node->close();
+      for( benchmark_node& n : nodes )
+         n.node.reset();
+      return 0;
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cerr << "p2p_benchmark:  " << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+
+import argparse
+import json
+import sys
+
+def load_report(filename):
+    with open(filename, "r") as f:
+        report = json.load(f)
+    if report.get("format") != 1:
+        raise ValueError("%s: unsupported results format %r" % (filename, report.get("format")))
+    return report
+
+def warn_differences(baseline, current):
+    warnings = []
+    if baseline.get("benchmark") != current.get("benchmark"):
+        warnings.append("benchmark: %s vs %s" % (baseline.get("benchmark"), current.get("benchmark")))
+    if baseline.get("parameters") != current.get("parameters"):
+        warnings.append("parameters: %s vs %s" % (json.dumps(baseline.get("parameters"), sort_keys=True),
+                                                  json.dumps(current.get("parameters"), sort_keys=True)))
+    base_env = baseline.get("environment", {})
+    cur_env = current.get("environment", {})
+    for key in ("build_type", "host", "cpu_threads", "compiler"):
+        if base_env.get(key) != cur_env.get(key):
+            warnings.append("%s: %s vs %s" % (key, base_env.get(key), cur_env.get(key)))
+    for w in warnings:
+        sys.stderr.write("warning: results are not comparable, %s\n" % w)
+    return
+
+def change_percent(base, cur, lower_is_better):
+    # positive means better, negative means worse
+    if base == 0:
+        return 0.0 if cur == 0 else (-100.0 if lower_is_better else 100.0)
+    delta = (cur - base) * 100.0 / abs(base)
+    return -delta if lower_is_better else delta
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two benchmark result files")
+    parser.add_argument("baseline", help="results of the reference run")
+    parser.add_argument("current", help="results of the run to check")
+    parser.add_argument("-t", "--threshold", type=float, default=10.0,
+                        help="regression in percent which makes the comparison fail (default: 10)")
+    opts = parser.parse_args()
+
+    baseline = load_report(opts.baseline)
+    current = load_report(opts.current)
+    warn_differences(baseline, current)
+
+    base_results = {r["name"]: r for r in baseline.get("results", [])}
+    cur_results = {r["name"]: r for r in current.get("results", [])}
+
+    rows = []
+    regressions = 0
+    for name, cur in cur_results.items():
+        base = base_results.get(name)
+        if base is None:
+            continue
+        change = change_percent(base["value"], cur["value"], cur.get("lower_is_better", True))
+        status = ""
+        if change < -opts.threshold:
+            status = "REGRESSION"
+            regressions += 1
+        elif change > opts.threshold:
+            status = "improved"
+        rows.append((name, "%.6g" % base["value"], "%.6g" % cur["value"], cur.get("unit", ""),
+                     "%+.1f%%" % change, status))
+
+    header = ("result", "baseline", "current", "unit", "change", "")
+    widths = [max(len(row[i]) for row in rows + [header]) for i in range(len(header))]
+    for row in [header] + rows:
+        print("  ".join(col.ljust(widths[i]) if i in (0, 3, 5) else col.rjust(widths[i])
+                        for i, col in enumerate(row)).rstrip())
+
+    missing = sorted(set(base_results) - set(cur_results))
+    added = sorted(set(cur_results) - set(base_results))
+    for name in missing:
+        print("missing in current: %s" % name)
+    for name in added:
+        print("new in current: %s" % name)
+
+    print("%d results compared, %d regressed by more than %g%%" % (len(rows), regressions, opts.threshold))
+    return 1 if regressions > 0 else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
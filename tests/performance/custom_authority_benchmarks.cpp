@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/custom_authority_object.hpp>
+#include <graphene/chain/hardfork.hpp>
+#include <graphene/protocol/restriction_predicate.hpp>
+
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "latency_stats.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+template<typename Object>
+unsigned_int member_index( const string& name )
+{
+   unsigned_int index;
+   fc::typelist::runtime::for_each( typename fc::reflector<Object>::native_members(), [&name, &index]( auto t ) {
+      if( name == decltype(t)::type::get_name() )
+         index = decltype(t)::type::index;
+   });
+   return index;
+}
+
+/// Restrictions of transfers to one of @p recipients, of at most @p max_amount of the core asset
+vector<restriction> make_transfer_restrictions( const flat_set<account_id_type>& recipients, int64_t max_amount )
+{
+   vector<restriction> restrictions;
+   restrictions.emplace_back( member_index<transfer_operation>( "to" ), restriction::func_in, recipients );
+   restrictions.emplace_back( member_index<transfer_operation>( "amount" ), restriction::func_attr,
+         vector<restriction>{ restriction( member_index<asset>( "asset_id" ), restriction::func_eq, asset_id_type() ),
+                              restriction( member_index<asset>( "amount" ), restriction::func_le, max_amount ) } );
+   return restrictions;
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE( custom_authority_benchmarks, database_fixture )
+
+/**
+ * Compares evaluating a predicate which is compiled once, as the custom authority objects cache it, with building
+ * the predicate for every evaluation
+ */
+BOOST_AUTO_TEST_CASE( restriction_predicate_benchmark )
+{ try {
+   const uint32_t iterations = 10000;
+   flat_set<account_id_type> recipients;
+   for( uint32_t i = 0; i < 100; ++i )
+      recipients.insert( account_id_type( i * 2 ) );
+   const vector<restriction> restrictions = make_transfer_restrictions( recipients, 1000 );
+   const auto op_type = operation::tag<transfer_operation>::value;
+
+   transfer_operation transfer;
+   transfer.to = account_id_type( 100 );
+   transfer.amount = asset( 500 );
+   const operation op = transfer;
+
+   latency_stats build;
+   latency_stats build_and_evaluate;
+   for( uint32_t i = 0; i < iterations; ++i )
+   {
+      auto start = fc::time_point::now();
+      restriction_predicate_function predicate = get_restriction_predicate( restrictions, op_type );
+      build.add( fc::time_point::now() - start );
+      BOOST_REQUIRE( predicate( op ).success );
+
+      start = fc::time_point::now();
+      BOOST_REQUIRE( get_restriction_predicate( restrictions, op_type )( op ).success );
+      build_and_evaluate.add( fc::time_point::now() - start );
+   }
+   build.report( "build a restriction predicate" );
+   build_and_evaluate.report( "build and evaluate a restriction predicate" );
+
+   const restriction_predicate_function compiled = get_restriction_predicate( restrictions, op_type );
+   latency_stats evaluate;
+   for( uint32_t i = 0; i < iterations; ++i )
+   {
+      const auto start = fc::time_point::now();
+      BOOST_REQUIRE( compiled( op ).success );
+      evaluate.add( fc::time_point::now() - start );
+   }
+   evaluate.report( "evaluate a compiled restriction predicate" );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Measures transactions which are authorized by one of many custom authorities of an account, so that every
+ * transaction evaluates the predicates of all of them
+ */
+BOOST_AUTO_TEST_CASE( custom_authority_transfer_benchmark )
+{ try {
+   const uint32_t authority_count = 50;
+   const uint32_t transfer_count = 2000;
+
+   generate_blocks( HARDFORK_BSIP_40_TIME );
+   generate_blocks( 5 );
+   db.modify( global_property_id_type()(db), [authority_count]( global_property_object& gpo ) {
+      custom_authority_options_type options;
+      options.max_custom_authorities_per_account = authority_count;
+      options.max_custom_authorities_per_account_op = authority_count;
+      gpo.parameters.extensions.value.custom_authority_options = options;
+   });
+   set_expiration( db, trx );
+   ACTORS( (alice)(bob)(charlie) );
+   fund( alice, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+
+   // only the last authority allows transfers to charlie
+   for( uint32_t i = 0; i < authority_count; ++i )
+   {
+      custom_authority_create_operation op;
+      op.account = alice_id;
+      op.auth.add_authority( bob_id, 1 );
+      op.auth.weight_threshold = 1;
+      op.enabled = true;
+      op.valid_to = db.head_block_time() + 86400;
+      op.operation_type = operation::tag<transfer_operation>::value;
+      flat_set<account_id_type> recipients{ account_id_type( 1000 + i ) };
+      if( i + 1 == authority_count )
+         recipients.insert( charlie_id );
+      op.restrictions = make_transfer_restrictions( recipients, GRAPHENE_BLOCKCHAIN_PRECISION );
+      trx.clear();
+      trx.operations = { op };
+      set_expiration( db, trx );
+      sign( trx, alice_private_key );
+      PUSH_TX( db, trx );
+   }
+   generate_block();
+
+   latency_stats transfers;
+   for( uint32_t i = 0; i < transfer_count; ++i )
+   {
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = charlie_id;
+      op.amount = asset( 1 + i % 1000 );
+      trx.clear();
+      trx.operations = { op };
+      set_expiration( db, trx );
+      trx.expiration += i % 3600;
+      sign( trx, bob_private_key );
+      const auto start = fc::time_point::now();
+      PUSH_TX( db, trx );
+      transfers.add( fc::time_point::now() - start );
+   }
+   transfers.report( "transfers authorized by the last of " + std::to_string( authority_count )
+                     + " custom authorities" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/credit_offer_object.hpp>
+#include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/htlc_object.hpp>
+#include <graphene/chain/market_object.hpp>
+#include <graphene/chain/proposal_object.hpp>
+#include <graphene/chain/ticket_object.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "latency_stats.hpp"
+
+#include <cstdlib>
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/**
+ * Measures the evaluation and application of single operations of one type, against a database which already holds
+ * many objects of the kind the evaluator works on
+ */
+struct evaluator_benchmark_fixture : database_fixture
+{
+   /// The number of objects which exist before the timed operations, can be set with GRAPHENE_BENCHMARK_STATE_SIZE
+   const uint32_t state_size;
+   /// The number of timed operations of each type, can be set with GRAPHENE_BENCHMARK_OPERATIONS
+   const uint32_t operations;
+
+   evaluator_benchmark_fixture()
+      : state_size( env_count( "GRAPHENE_BENCHMARK_STATE_SIZE", 10000 ) ),
+        operations( env_count( "GRAPHENE_BENCHMARK_OPERATIONS", 1000 ) )
+   {
+      benchmark_results().set_parameter( "state_size", state_size );
+      benchmark_results().set_parameter( "operations", operations );
+   }
+
+   static uint32_t env_count( const char* name, uint32_t default_value )
+   {
+      const char* value_str = getenv( name );
+      const uint32_t value = value_str ? std::strtoul( value_str, nullptr, 10 ) : 0;
+      return value > 0 ? value : default_value;
+   }
+
+   /// Pushes a transaction containing only @p op, only the push itself is timed
+   fc::microseconds push_timed( operation op, processed_transaction* result = nullptr )
+   {
+      set_expiration( db, trx );
+      trx.operations.clear();
+      db.current_fee_schedule().set_fee( op );
+      trx.operations.push_back( std::move( op ) );
+      trx.validate();
+      const auto start = fc::time_point::now();
+      processed_transaction ptx = PUSH_TX( db, trx, ~0 );
+      const auto elapsed = fc::time_point::now() - start;
+      trx.operations.clear();
+      if( result )
+         *result = std::move( ptx );
+      return elapsed;
+   }
+
+   /// Pushes @p op, adds the time of the push to @p stats if given, and returns the ID of the created object
+   object_id_type push_new( operation op, latency_stats* stats = nullptr )
+   {
+      processed_transaction ptx;
+      const auto elapsed = push_timed( std::move( op ), &ptx );
+      if( stats )
+         stats->add( elapsed );
+      return ptx.operation_results[0].get<object_id_type>();
+   }
+
+   /// Moves the chain past the hardforks of every benchmarked operation type
+   void advance_past_hardforks()
+   {
+      generate_blocks( HARDFORK_CORE_2582_TIME );
+      generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+      generate_block();
+      set_expiration( db, trx );
+   }
+
+   asset_publish_feed_operation make_feed( account_id_type publisher, asset_id_type mpa,
+                                           share_type debt_per_core )const
+   {
+      asset_publish_feed_operation op;
+      op.publisher = publisher;
+      op.asset_id = mpa;
+      op.feed.settlement_price = price( asset( debt_per_core, mpa ), asset(1) );
+      op.feed.core_exchange_rate = op.feed.settlement_price;
+      op.feed.maintenance_collateral_ratio = 1850;
+      op.feed.maximum_short_squeeze_ratio = 1250;
+      return op;
+   }
+
+   /// Creates a MPA with a feed of 100 published by @p feeder, and @ref state_size call orders of 100000 debt with
+   /// collateral ratios from 2 to 2.5
+   asset_id_type create_mpa_with_call_orders( account_id_type feeder )
+   {
+      const asset_id_type mpa_id = create_bitasset( "BENCHUSD", feeder ).get_id();
+      update_feed_producers( mpa_id, { feeder } );
+      push_timed( make_feed( feeder, mpa_id, 100 ) );
+      for( uint32_t i = 0; i < state_size; ++i )
+      {
+         const account_object& borrower = create_account( "borrower" + std::to_string( i ) );
+         fund( borrower, asset(10000) );
+         borrow( borrower, asset( 100000, mpa_id ), asset( 2000 + uint64_t(i) * 500 / state_size ) );
+      }
+      return mpa_id;
+   }
+
+   limit_order_create_operation make_sell_order( account_id_type seller, const asset& amount,
+                                                 const asset& receive )const
+   {
+      limit_order_create_operation op;
+      op.seller = seller;
+      op.amount_to_sell = amount;
+      op.min_to_receive = receive;
+      return op;
+   }
+};
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE( evaluator_benchmarks, evaluator_benchmark_fixture )
+
+BOOST_AUTO_TEST_CASE( limit_order_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (maker)(trader) );
+   const asset_id_type uia_id = create_user_issued_asset( "BENCH" ).get_id();
+   issue_uia( maker, asset( int64_t(state_size) * 1000, uia_id ) );
+   issue_uia( trader, asset( int64_t(operations) * 1000, uia_id ) );
+
+   // asks of 1000 BENCH at state_size different prices, the timed asks are spread over the same prices and so
+   // never match
+   for( uint32_t i = 0; i < state_size; ++i )
+      push_timed( make_sell_order( maker_id, asset( 1000, uia_id ), asset( 1000 + i ) ) );
+
+   latency_stats creation;
+   vector<limit_order_id_type> orders;
+   for( uint32_t i = 0; i < operations; ++i )
+      orders.push_back( push_new( make_sell_order( trader_id, asset( 1000, uia_id ),
+                                                   asset( 1000 + uint64_t(i) * state_size / operations ) ),
+                                  &creation ) );
+   creation.report( "limit_order_create" );
+
+   latency_stats cancellation;
+   for( const limit_order_id_type& order : orders )
+   {
+      limit_order_cancel_operation op;
+      op.fee_paying_account = trader_id;
+      op.order = order;
+      cancellation.add( push_timed( op ) );
+   }
+   cancellation.report( "limit_order_cancel" );
+   BOOST_CHECK_EQUAL( db.get_index_type<limit_order_index>().indices().size(), state_size );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( call_order_update_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (feeder)(borrower) );
+   const asset_id_type mpa_id = create_mpa_with_call_orders( feeder_id );
+   fund( borrower, asset(10000000) );
+   borrow( borrower, asset( 100000, mpa_id ), asset(4000) );
+
+   // alternately increase and decrease the position, its collateral ratio stays between 4 and 4.1
+   latency_stats updates;
+   for( uint32_t i = 0; i < operations; ++i )
+   {
+      const int64_t sign = ( i % 2 == 0 ) ? 1 : -1;
+      call_order_update_operation op;
+      op.funding_account = borrower_id;
+      op.delta_collateral = asset( sign * 100 );
+      op.delta_debt = asset( sign * 1000, mpa_id );
+      updates.add( push_timed( op ) );
+   }
+   updates.report( "call_order_update" );
+   BOOST_CHECK_EQUAL( db.get_index_type<call_order_index>().indices().size(), uint64_t(state_size) + 1 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( asset_publish_feed_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (feeder) );
+   const asset_id_type mpa_id = create_mpa_with_call_orders( feeder_id );
+   flat_set<account_id_type> feeders;
+   for( uint32_t i = 0; i < GRAPHENE_DEFAULT_MAX_ASSET_FEED_PUBLISHERS; ++i )
+      feeders.insert( create_account( "feeder" + std::to_string( i ) ).get_id() );
+   update_feed_producers( mpa_id, feeders );
+   for( const account_id_type& publisher : feeders )
+      push_timed( make_feed( publisher, mpa_id, 100 ) );
+
+   // the median feed moves between 100 and 101, which does not margin-call any of the call orders
+   latency_stats feeds;
+   for( uint32_t i = 0; i < operations; ++i )
+   {
+      const account_id_type publisher = *( feeders.begin() + i % feeders.size() );
+      feeds.add( push_timed( make_feed( publisher, mpa_id, 100 + ( i / feeders.size() ) % 2 ) ) );
+   }
+   feeds.report( "asset_publish_feed" );
+   BOOST_CHECK_EQUAL( db.get_index_type<call_order_index>().indices().size(), state_size );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( liquidity_pool_exchange_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (maker)(trader) );
+   const asset_id_type usd_id = create_user_issued_asset( "BENCHUSD" ).get_id();
+   issue_uia( maker, asset( 100000000, usd_id ) );
+   issue_uia( trader, asset( 100000000, usd_id ) );
+   fund( maker, asset(100000000) );
+   fund( trader, asset(100000000) );
+
+   vector<liquidity_pool_id_type> pools;
+   for( uint32_t i = 0; i < state_size; ++i )
+   {
+      const asset_object& share_asset = create_user_issued_asset( "BENCHLP" + std::to_string( i ), maker,
+                                                                  charge_market_fee );
+      pools.push_back( push_new( make_liquidity_pool_create_op( maker_id, asset_id_type(), usd_id,
+                                                                share_asset.get_id(), 30, 0 ) ) );
+   }
+   const liquidity_pool_id_type pool_id = pools[ pools.size() / 2 ];
+   push_timed( make_liquidity_pool_deposit_op( maker_id, pool_id, asset(10000000), asset( 10000000, usd_id ) ) );
+
+   // alternately sell the core asset and BENCHUSD to the pool
+   latency_stats exchanges;
+   for( uint32_t i = 0; i < operations; ++i )
+   {
+      const bool sell_core = ( i % 2 == 0 );
+      exchanges.add( push_timed( make_liquidity_pool_exchange_op( trader_id, pool_id,
+                                       sell_core ? asset(1000) : asset( 1000, usd_id ),
+                                       sell_core ? asset( 1, usd_id ) : asset(1) ) ) );
+   }
+   exchanges.report( "liquidity_pool_exchange" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( htlc_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (alice)(bob) );
+   fund( alice, asset( int64_t( state_size + operations ) * 10 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+   fund( bob, asset( int64_t(operations) * 10 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+   // this installs fees for the transfers too, so the accounts are funded beforehand
+   set_htlc_committee_parameters();
+
+   const std::vector<char> preimage( 32, 'x' );
+   htlc_create_operation create;
+   create.from = alice_id;
+   create.to = bob_id;
+   create.amount = asset(1000);
+   create.preimage_hash = fc::sha256::hash( preimage.data(), preimage.size() );
+   create.preimage_size = static_cast<uint16_t>( preimage.size() );
+   create.claim_period_seconds = 3600;
+   for( uint32_t i = 0; i < state_size; ++i )
+      push_timed( create );
+
+   latency_stats creation;
+   vector<htlc_id_type> htlcs;
+   for( uint32_t i = 0; i < operations; ++i )
+      htlcs.push_back( push_new( create, &creation ) );
+   creation.report( "htlc_create" );
+
+   latency_stats redemption;
+   for( const htlc_id_type& htlc : htlcs )
+   {
+      htlc_redeem_operation redeem;
+      redeem.htlc_id = htlc;
+      redeem.redeemer = bob_id;
+      redeem.preimage = preimage;
+      redemption.add( push_timed( redeem ) );
+   }
+   redemption.report( "htlc_redeem" );
+   BOOST_CHECK_EQUAL( db.get_index_type<htlc_index>().indices().size(), state_size );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( proposal_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (alice)(bob) );
+   fund( alice, asset(10000000) );
+
+   transfer_operation xfer;
+   xfer.from = alice_id;
+   xfer.to = bob_id;
+   xfer.amount = asset(1);
+   for( uint32_t i = 0; i < state_size; ++i )
+      push_timed( make_proposal_create_op( xfer, alice_id ) );
+
+   latency_stats creation;
+   vector<proposal_id_type> proposals;
+   for( uint32_t i = 0; i < operations; ++i )
+      proposals.push_back( push_new( make_proposal_create_op( xfer, alice_id ), &creation ) );
+   creation.report( "proposal_create" );
+
+   // every approval completes the authorization, so the update also executes the proposed transfer
+   latency_stats approval;
+   for( const proposal_id_type& proposal : proposals )
+   {
+      proposal_update_operation update;
+      update.fee_paying_account = alice_id;
+      update.proposal = proposal;
+      update.active_approvals_to_add.insert( alice_id );
+      approval.add( push_timed( update ) );
+   }
+   approval.report( "proposal_update executing the proposal" );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), operations );
+   BOOST_CHECK_EQUAL( db.get_index_type<proposal_index>().indices().size(), state_size );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( credit_offer_accept_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (sam)(ted) );
+   const asset_id_type collateral_id = create_user_issued_asset( "BENCHCOL" ).get_id();
+   const int64_t total = int64_t( state_size + operations ) * 1000;
+   fund( sam, asset( total ) );
+   issue_uia( ted, asset( total * 2, collateral_id ) );
+
+   flat_map<asset_id_type, price> collateral;
+   collateral[collateral_id] = price( asset(1), asset( 2, collateral_id ) );
+   const credit_offer_id_type offer_id = push_new( make_credit_offer_create_op( sam_id, asset_id_type(), total,
+                                                         100, 3600, 1, true, db.head_block_time() + fc::days(1),
+                                                         collateral, {} ) );
+
+   const credit_offer_accept_operation accept = make_credit_offer_accept_op( ted_id, offer_id, asset(1000),
+                                                                            asset( 2000, collateral_id ) );
+   for( uint32_t i = 0; i < state_size; ++i )
+      push_timed( accept );
+
+   latency_stats acceptance;
+   for( uint32_t i = 0; i < operations; ++i )
+      acceptance.add( push_timed( accept ) );
+   acceptance.report( "credit_offer_accept" );
+   BOOST_CHECK_EQUAL( db.get_index_type<credit_deal_index>().indices().size(), uint64_t(state_size) + operations );
+   BOOST_CHECK_EQUAL( offer_id( db ).current_balance.value, 0 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( ticket_create_evaluator_benchmark )
+{ try {
+   advance_past_hardforks();
+   ACTORS( (alice) );
+   fund( alice, asset( int64_t( state_size + operations ) * 100 ) );
+
+   const ticket_create_operation create = make_ticket_create_op( alice_id, lock_180_days, asset(100) );
+   for( uint32_t i = 0; i < state_size; ++i )
+      push_timed( create );
+
+   latency_stats creation;
+   for( uint32_t i = 0; i < operations; ++i )
+      creation.add( push_timed( create ) );
+   creation.report( "ticket_create" );
+   BOOST_CHECK_EQUAL( db.get_index_type<ticket_index>().indices().size(), uint64_t(state_size) + operations );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/utilities/benchmark_report.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace chain { namespace test {
+
+/// The results of this run, written to the file named by GRAPHENE_BENCHMARK_RESULTS when the tests finish
+inline graphene::utilities::benchmark_report& benchmark_results()
+{
+   static graphene::utilities::benchmark_report results( "performance_test" );
+   return results;
+}
+
+/// Adds a result named after the running test case and @p what
+inline void add_benchmark_result( const std::string& what, double value, const std::string& unit,
+                                  bool lower_is_better = true )
+{
+   benchmark_results().add( boost::unit_test::framework::current_test_case().p_name.value + ": " + what,
+                            value, unit, lower_is_better );
+}
+
+/// Collects the latencies of one kind of operation, logs throughput and percentiles and adds them to the results
+class latency_stats
+{
+   public:
+      void add( const fc::microseconds& elapsed ) { _samples.push_back( elapsed.count() ); }
+
+      void report( const std::string& what )const
+      {
+         if( _samples.empty() )
+            return;
+         std::vector<int64_t> sorted = _samples;
+         std::sort( sorted.begin(), sorted.end() );
+         int64_t total = 0;
+         for( int64_t sample : sorted )
+            total += sample;
+         wlog( "Benchmark: ${what}: ${n} in ${ms} ms, ${ops} per second, latency median ${med} us, "
+               "99th percentile ${p99} us, max ${max} us",
+               ("what",what)("n",sorted.size())("ms",total/1000)
+               ("ops",total > 0 ? int64_t(sorted.size()) * 1000000 / total : 0)
+               ("med",sorted[sorted.size() / 2])("p99",sorted[sorted.size() * 99 / 100])("max",sorted.back()) );
+         add_benchmark_result( what + " throughput", total > 0 ? sorted.size() * 1000000.0 / total : 0.0,
+                               "1/s", false );
+         add_benchmark_result( what + " median latency", sorted[sorted.size() / 2], "us" );
+         add_benchmark_result( what + " 99th percentile latency", sorted[sorted.size() * 99 / 100], "us" );
+      }
+
+   private:
+      std::vector<int64_t> _samples;
+};
+
+} } } // graphene::chain::test
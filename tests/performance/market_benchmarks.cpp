@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/market_object.hpp>
+
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "latency_stats.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+struct market_benchmark_fixture : database_fixture
+{
+   using bsrm_type = bitasset_options::black_swan_response_type;
+
+   /// The number of orders in the synthetic order books, can be set with GRAPHENE_BENCHMARK_BOOK_DEPTH
+   const uint32_t depth;
+
+   market_benchmark_fixture() : depth( book_depth() )
+   {
+      benchmark_results().set_parameter( "book_depth", depth );
+   }
+
+   static uint32_t book_depth()
+   {
+      const char* depth_str = getenv( "GRAPHENE_BENCHMARK_BOOK_DEPTH" );
+      const uint32_t value = depth_str ? std::strtoul( depth_str, nullptr, 10 ) : 0;
+      return value > 0 ? value : 1000;
+   }
+
+   /// Pushes a transaction containing only @p op, only the push itself is timed
+   fc::microseconds push_timed( operation op, processed_transaction* result = nullptr )
+   {
+      set_expiration( db, trx );
+      trx.operations.clear();
+      db.current_fee_schedule().set_fee( op );
+      trx.operations.push_back( std::move( op ) );
+      trx.validate();
+      const auto start = fc::time_point::now();
+      processed_transaction ptx = PUSH_TX( db, trx, ~0 );
+      const auto elapsed = fc::time_point::now() - start;
+      trx.operations.clear();
+      if( result )
+         *result = std::move( ptx );
+      return elapsed;
+   }
+
+   limit_order_create_operation make_sell_order( account_id_type seller, const asset& amount,
+                                                 const asset& receive )const
+   {
+      limit_order_create_operation op;
+      op.seller = seller;
+      op.amount_to_sell = amount;
+      op.min_to_receive = receive;
+      return op;
+   }
+
+   void advance_past_market_hardforks()
+   {
+      generate_blocks( HARDFORK_CORE_2582_TIME );
+      generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+      generate_block();
+      set_expiration( db, trx );
+   }
+
+   const asset_object& create_benchmark_mpa( const string& name, account_id_type issuer,
+                                             optional<bsrm_type> bsrm = {} )
+   {
+      asset_create_operation op = make_bitasset( name, issuer );
+      op.bitasset_opts->force_settlement_delay_sec = 600;
+      if( bsrm.valid() )
+         op.bitasset_opts->extensions.value.black_swan_response_method = static_cast<uint8_t>( *bsrm );
+      processed_transaction ptx;
+      push_timed( op, &ptx );
+      return db.get<asset_object>( ptx.operation_results[0].get<object_id_type>() );
+   }
+
+   asset_publish_feed_operation make_feed( account_id_type publisher, asset_id_type mpa,
+                                           share_type debt_per_core )const
+   {
+      asset_publish_feed_operation op;
+      op.publisher = publisher;
+      op.asset_id = mpa;
+      op.feed.settlement_price = price( asset( debt_per_core, mpa ), asset(1) );
+      op.feed.core_exchange_rate = op.feed.settlement_price;
+      op.feed.maintenance_collateral_ratio = 1850;
+      op.feed.maximum_short_squeeze_ratio = 1250;
+      return op;
+   }
+
+   /// Opens @ref depth call orders of 100000 debt with collateral ratios from 2 to 2.5 at a feed of 100,
+   /// and gives the debt to @p holder
+   void create_call_orders( const asset_object& mpa, const account_object& holder )
+   {
+      for( uint32_t i = 0; i < depth; ++i )
+      {
+         const account_object& borrower = create_account( "borrower" + std::to_string( i ) );
+         fund( borrower, asset(1000000) );
+         borrow( borrower, asset( 100000, mpa.get_id() ), asset( 2000 + uint64_t(i) * 500 / depth ) );
+         transfer( borrower, holder, asset( 100000, mpa.get_id() ) );
+      }
+   }
+
+   size_t count_limit_orders( account_id_type seller )const
+   {
+      const auto& orders = db.get_index_type<limit_order_index>().indices();
+      return std::count_if( orders.begin(), orders.end(),
+                            [seller]( const limit_order_object& order ) { return order.seller == seller; } );
+   }
+
+   size_t count_call_orders( asset_id_type mpa )const
+   {
+      const auto& calls = db.get_index_type<call_order_index>().indices();
+      return std::count_if( calls.begin(), calls.end(),
+                            [mpa]( const call_order_object& call ) { return call.debt_type() == mpa; } );
+   }
+};
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE( market_benchmarks, market_benchmark_fixture )
+
+BOOST_AUTO_TEST_CASE( limit_order_benchmark )
+{ try {
+   ACTORS( (maker)(taker) );
+   const asset_object& uia = create_user_issued_asset( "BENCH" );
+   const asset_id_type uia_id = uia.get_id();
+   issue_uia( maker, asset( int64_t(depth) * 1000 * 3, uia_id ) );
+   fund( maker, asset(10000000) );
+   fund( taker, asset( int64_t(depth) * ( 1000 + depth ) * 4 + 10000000 ) );
+
+   // asks of 1000 BENCH at depth different prices
+   auto place_book = [this,maker_id,uia_id]( latency_stats* stats ) {
+      std::vector<limit_order_id_type> orders;
+      for( uint32_t i = 0; i < depth; ++i )
+      {
+         processed_transaction ptx;
+         const auto elapsed = push_timed( make_sell_order( maker_id, asset( 1000, uia_id ), asset( 1000 + i ) ),
+                                          &ptx );
+         if( stats )
+            stats->add( elapsed );
+         orders.push_back( ptx.operation_results[0].get<object_id_type>() );
+      }
+      return orders;
+   };
+
+   latency_stats placement;
+   const std::vector<limit_order_id_type> orders = place_book( &placement );
+   placement.report( "place limit orders" );
+
+   latency_stats cancellation;
+   for( const limit_order_id_type& order : orders )
+   {
+      limit_order_cancel_operation op;
+      op.fee_paying_account = maker_id;
+      op.order = order;
+      cancellation.add( push_timed( op ) );
+   }
+   cancellation.report( "cancel limit orders" );
+
+   place_book( nullptr );
+   latency_stats single_fills;
+   for( uint32_t i = 0; i < depth; ++i )
+      single_fills.add( push_timed( make_sell_order( taker_id, asset( 1000 + i ), asset( 1000, uia_id ) ) ) );
+   single_fills.report( "taker orders filling one maker order each" );
+   BOOST_CHECK_EQUAL( count_limit_orders( maker_id ), 0u );
+
+   place_book( nullptr );
+   latency_stats sweep;
+   sweep.add( push_timed( make_sell_order( taker_id, asset( int64_t(depth) * ( 1000 + depth - 1 ) ),
+                                           asset( int64_t(depth) * 1000, uia_id ) ) ) );
+   sweep.report( "taker order sweeping " + std::to_string( depth ) + " maker orders" );
+   BOOST_CHECK_EQUAL( count_limit_orders( maker_id ), 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( order_book_walk_benchmark )
+{ try {
+   advance_past_market_hardforks();
+   ACTORS( (maker)(feeder)(holder) );
+   const asset_object& uia = create_user_issued_asset( "BENCH" );
+   const asset_id_type uia_id = uia.get_id();
+   issue_uia( maker, asset( int64_t(depth) * 1000, uia_id ) );
+   fund( maker, asset(10000000) );
+   for( uint32_t i = 0; i < depth; ++i )
+      push_timed( make_sell_order( maker_id, asset( 1000, uia_id ), asset( 1000 + i ) ) );
+
+   const asset_object& mpa = create_benchmark_mpa( "BENCHUSD", feeder_id );
+   update_feed_producers( mpa, { feeder_id } );
+   push_timed( make_feed( feeder_id, mpa.get_id(), 100 ) );
+   create_call_orders( mpa, holder );
+
+   const uint32_t rounds = 100;
+   const auto& book = db.get_index_type<limit_order_index>().indices().get<by_price>();
+   latency_stats lookups;
+   share_type found;
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      const auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < depth; ++i )
+         found += book.lower_bound( price( asset( 1000, uia_id ), asset( 1000 + i ) ) )->for_sale;
+      lookups.add( fc::time_point::now() - start );
+   }
+   lookups.report( std::to_string( depth ) + " lookups by price in the limit order book" );
+   BOOST_CHECK_EQUAL( found.value, int64_t(rounds) * depth * 1000 );
+
+   latency_stats limit_walks;
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      const auto start = fc::time_point::now();
+      share_type total;
+      auto itr = book.lower_bound( price::max( uia_id, asset_id_type() ) );
+      const auto end = book.upper_bound( price::min( uia_id, asset_id_type() ) );
+      for( ; itr != end; ++itr )
+         total += itr->for_sale;
+      limit_walks.add( fc::time_point::now() - start );
+      BOOST_CHECK_EQUAL( total.value, int64_t(depth) * 1000 );
+   }
+   limit_walks.report( "walks over " + std::to_string( depth ) + " limit orders" );
+
+   const auto& calls = db.get_index_type<call_order_index>().indices().get<by_collateral>();
+   latency_stats call_walks;
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      const auto start = fc::time_point::now();
+      uint32_t undercollateralized = 0;
+      const price limit = price( asset( 25, asset_id_type() ), asset( 1, mpa.get_id() ) );
+      for( const call_order_object& call : calls )
+         if( call.collateralization() < limit )
+            ++undercollateralized;
+      call_walks.add( fc::time_point::now() - start );
+      BOOST_CHECK_LE( undercollateralized, depth );
+   }
+   call_walks.report( "walks over " + std::to_string( depth ) + " call orders by collateralization" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( margin_call_cascade_benchmark )
+{ try {
+   advance_past_market_hardforks();
+   ACTORS( (feeder)(seller) );
+   fund( seller, asset(10000000) );
+   const asset_object& mpa = create_benchmark_mpa( "BENCHUSD", feeder_id );
+   const asset_id_type mpa_id = mpa.get_id();
+   update_feed_producers( mpa, { feeder_id } );
+   push_timed( make_feed( feeder_id, mpa_id, 100 ) );
+   create_call_orders( mpa, seller );
+
+   // asks of 100000 debt for 1300 core, which the call orders do not take at a feed of 100
+   latency_stats placement;
+   for( uint32_t i = 0; i < depth; ++i )
+      placement.add( push_timed( make_sell_order( seller_id, asset( 100000, mpa_id ), asset(1300) ) ) );
+   placement.report( "place limit orders next to call orders" );
+   BOOST_CHECK_EQUAL( count_call_orders( mpa_id ), depth );
+
+   // at a feed of 70 every call order is below the MCR and is filled by one ask
+   latency_stats cascade;
+   cascade.add( push_timed( make_feed( feeder_id, mpa_id, 70 ) ) );
+   cascade.report( "feed margin-calling " + std::to_string( depth ) + " call orders" );
+   BOOST_CHECK_EQUAL( count_call_orders( mpa_id ), 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( global_settlement_benchmark )
+{ try {
+   advance_past_market_hardforks();
+   ACTORS( (feeder)(holder) );
+   const asset_object& mpa = create_benchmark_mpa( "BENCHUSD", feeder_id );
+   const asset_id_type mpa_id = mpa.get_id();
+   update_feed_producers( mpa, { feeder_id } );
+   push_timed( make_feed( feeder_id, mpa_id, 100 ) );
+   create_call_orders( mpa, holder );
+
+   // at a feed of 40 the collateral of every call order is worth less than its debt
+   latency_stats settlement;
+   settlement.add( push_timed( make_feed( feeder_id, mpa_id, 40 ) ) );
+   settlement.report( "feed globally settling " + std::to_string( depth ) + " call orders" );
+   BOOST_CHECK( mpa.bitasset_data( db ).has_settlement() );
+   BOOST_CHECK_EQUAL( count_call_orders( mpa_id ), 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( force_settlement_benchmark )
+{ try {
+   advance_past_market_hardforks();
+   ACTORS( (feeder)(seller) );
+   fund( seller, asset(10000000) );
+   const asset_object& mpa = create_benchmark_mpa( "BENCHUSD", feeder_id );
+   const asset_id_type mpa_id = mpa.get_id();
+   update_feed_producers( mpa, { feeder_id } );
+   push_timed( make_feed( feeder_id, mpa_id, 100 ) );
+   create_call_orders( mpa, seller );
+
+   latency_stats placement;
+   for( uint32_t i = 0; i < depth; ++i )
+   {
+      asset_settle_operation op;
+      op.account = seller_id;
+      op.amount = asset( 1000, mpa_id );
+      placement.add( push_timed( op ) );
+   }
+   placement.report( "request force settlements" );
+   const auto& settlements = db.get_index_type<force_settlement_index>().indices().get<by_expiration>();
+   BOOST_REQUIRE_EQUAL( settlements.size(), depth );
+
+   // include the pending transactions, so that the timed block only processes the settlements
+   generate_block();
+   const fc::time_point_sec settlement_time = settlements.begin()->settlement_date;
+   const uint32_t slot = db.get_slot_at_time( settlement_time + db.get_global_properties().parameters.block_interval );
+   latency_stats execution;
+   const auto start = fc::time_point::now();
+   db.generate_block( db.get_slot_time( slot ), db.get_scheduled_witness( slot ), init_account_priv_key, ~0 );
+   execution.add( fc::time_point::now() - start );
+   execution.report( "block executing " + std::to_string( depth ) + " force settlements" );
+   BOOST_CHECK( settlements.empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( settled_debt_benchmark )
+{ try {
+   advance_past_market_hardforks();
+   ACTORS( (feeder)(seller) );
+   fund( seller, asset(10000000) );
+   const asset_object& mpa = create_benchmark_mpa( "BENCHUSD", feeder_id, bsrm_type::individual_settlement_to_order );
+   const asset_id_type mpa_id = mpa.get_id();
+   update_feed_producers( mpa, { feeder_id } );
+   push_timed( make_feed( feeder_id, mpa_id, 100 ) );
+   create_call_orders( mpa, seller );
+
+   // at a feed of 45 every call order is below the MSSR and is settled into the settled debt order
+   latency_stats cascade;
+   cascade.add( push_timed( make_feed( feeder_id, mpa_id, 45 ) ) );
+   cascade.report( "feed settling " + std::to_string( depth ) + " call orders into a settled debt order" );
+   BOOST_CHECK_EQUAL( count_call_orders( mpa_id ), 0u );
+   BOOST_REQUIRE( db.find_settled_debt_order( mpa_id ) );
+
+   latency_stats takers;
+   for( uint32_t i = 0; i < depth; ++i )
+      takers.add( push_timed( make_sell_order( seller_id, asset( 1000, mpa_id ), asset(1) ) ) );
+   takers.report( "taker orders filled by the settled debt order" );
+   BOOST_CHECK_EQUAL( count_limit_orders( seller_id ), 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
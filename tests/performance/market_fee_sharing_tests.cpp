@@ -27,6 +27,7 @@
 #include <graphene/chain/hardfork.hpp>
 #include <fc/time.hpp>
 #include "../common/database_fixture.hpp"
+#include "latency_stats.hpp"
 
 using namespace graphene::chain;
 
@@ -93,6 +94,7 @@ BOOST_FIXTURE_TEST_CASE(mfs_performance_test, database_fixture)
 
       const auto elapsed = duration_cast<milliseconds>(end - start);
       wlog("Elapsed: ${c} ms", ("c", elapsed.count()));
+      graphene::chain::test::add_benchmark_result( "elapsed", elapsed.count(), "ms" );
 
       for (unsigned int i = 0; i < accounts; ++i)
       {
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/market_object.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fc/time.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "latency_stats.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/**
+ * Builds a large state of accounts, balances, limit orders and account history and reports how much memory every
+ * index takes per object, as estimated by @ref graphene::db::object_database::get_memory_usage, next to the growth
+ * of the resident set of the process
+ */
+struct memory_benchmark_fixture : database_fixture
+{
+   /// The number of accounts to create, can be set with GRAPHENE_BENCHMARK_ACCOUNTS
+   const uint32_t account_count;
+   /// The number of transactions in each block
+   static constexpr uint32_t transactions_per_block = 1000;
+
+   memory_benchmark_fixture()
+#ifdef NDEBUG
+      : account_count( env_count( "GRAPHENE_BENCHMARK_ACCOUNTS", 1000000 ) )
+#else
+      : account_count( env_count( "GRAPHENE_BENCHMARK_ACCOUNTS", 20000 ) )
+#endif
+   {
+      benchmark_results().set_parameter( "accounts", account_count );
+   }
+
+   static uint32_t env_count( const char* name, uint32_t default_value )
+   {
+      const char* value_str = getenv( name );
+      const uint32_t value = value_str ? std::strtoul( value_str, nullptr, 10 ) : 0;
+      return value > 0 ? value : default_value;
+   }
+
+   /// @return the resident set size of the process in bytes, or 0 if it is not known on this platform
+   static uint64_t resident_bytes()
+   {
+#ifdef __linux__
+      std::ifstream statm( "/proc/self/statm" );
+      uint64_t total_pages = 0;
+      uint64_t resident_pages = 0;
+      if( statm >> total_pages >> resident_pages )
+         return resident_pages * uint64_t( sysconf( _SC_PAGESIZE ) );
+#endif
+      return 0;
+   }
+
+   static std::string index_name( uint8_t space_id, uint8_t type_id )
+   {
+      static const std::map< std::pair<uint8_t,uint8_t>, std::string > names = {
+         { { account_object::space_id, account_object::type_id }, "account" },
+         { { account_statistics_object::space_id, account_statistics_object::type_id }, "account statistics" },
+         { { account_balance_object::space_id, account_balance_object::type_id }, "account balance" },
+         { { limit_order_object::space_id, limit_order_object::type_id }, "limit order" },
+         { { operation_history_object::space_id, operation_history_object::type_id }, "operation history" },
+         { { account_transaction_history_object::space_id,
+             account_transaction_history_object::type_id }, "account history" }
+      };
+      const auto itr = names.find( std::make_pair( space_id, type_id ) );
+      if( itr != names.end() )
+         return itr->second;
+      return std::to_string( space_id ) + "." + std::to_string( type_id );
+   }
+
+   /// Pushes every operation in its own transaction, the pending state is committed in blocks
+   template<typename MakeOp>
+   void push_all( const std::string& what, MakeOp&& make_op )
+   {
+      const auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         set_expiration( db, trx );
+         trx.operations.clear();
+         trx.operations.push_back( make_op( i ) );
+         PUSH_TX( db, trx, ~0 );
+         if( ( i + 1 ) % transactions_per_block == 0 )
+            generate_block();
+      }
+      trx.operations.clear();
+      generate_block();
+      const auto elapsed = fc::time_point::now() - start;
+      BOOST_TEST_MESSAGE( what << ": " << account_count << " operations in " << elapsed.count() / 1000 << " ms" );
+   }
+
+   /**
+    * Logs the memory usage of every index which holds objects, and adds the usage per object of the indexes named
+    * in @ref index_name to the results
+    */
+   void report_memory( const std::string& phase, uint64_t resident_before )const
+   {
+      uint64_t objects = 0;
+      uint64_t estimated = 0;
+      BOOST_TEST_MESSAGE( "Memory after " << phase << ":" );
+      for( const auto& usage : db.get_memory_usage() )
+      {
+         if( usage.object_count == 0 )
+            continue;
+         const std::string name = index_name( usage.space_id, usage.type_id );
+         const double per_object = double( usage.object_bytes ) / usage.object_count;
+         const double secondary_per_object = double( usage.secondary_index_bytes ) / usage.object_count;
+         BOOST_TEST_MESSAGE( "   " << name << ": " << usage.object_count << " objects, " << per_object
+                             << " bytes per object, " << secondary_per_object
+                             << " bytes per object in secondary indexes, " << usage.undo_bytes
+                             << " bytes in undo states" );
+         objects += usage.object_count;
+         estimated += usage.object_bytes + usage.secondary_index_bytes + usage.undo_bytes;
+         if( name.find( '.' ) == std::string::npos )
+         {
+            add_benchmark_result( phase + ": " + name + " bytes per object", per_object, "bytes" );
+            add_benchmark_result( phase + ": " + name + " secondary index bytes per object", secondary_per_object,
+                                  "bytes" );
+         }
+      }
+      const uint64_t resident = resident_bytes();
+      BOOST_TEST_MESSAGE( "   estimated " << estimated << " bytes for " << objects << " objects, resident set grew by "
+                          << int64_t( resident - resident_before ) << " bytes" );
+      add_benchmark_result( phase + ": estimated bytes", estimated, "bytes" );
+      if( resident > 0 )
+         add_benchmark_result( phase + ": resident set growth", int64_t( resident - resident_before ), "bytes" );
+   }
+
+   /// @return the undo bytes of the balance index
+   uint64_t balance_undo_bytes()const
+   {
+      for( const auto& usage : db.get_memory_usage() )
+         if( usage.space_id == account_balance_object::space_id && usage.type_id == account_balance_object::type_id )
+            return usage.undo_bytes;
+      return 0;
+   }
+
+   static uint64_t directory_bytes( const fc::path& dir )
+   {
+      uint64_t result = 0;
+      for( boost::filesystem::recursive_directory_iterator itr( dir.string() ), end; itr != end; ++itr )
+         if( boost::filesystem::is_regular_file( itr->status() ) )
+            result += boost::filesystem::file_size( itr->path() );
+      return result;
+   }
+};
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE( memory_benchmarks, memory_benchmark_fixture )
+
+BOOST_AUTO_TEST_CASE( state_memory_benchmark )
+{ try {
+   uint64_t resident = resident_bytes();
+   push_all( "account_create", [this]( uint32_t i ) -> operation {
+      return make_account( "mem" + std::to_string( i ) );
+   });
+   const auto& accounts = db.get_index_type<account_index>().indices().get<by_name>();
+   vector<account_id_type> ids;
+   ids.reserve( account_count );
+   for( uint32_t i = 0; i < account_count; ++i )
+      ids.push_back( accounts.find( "mem" + std::to_string( i ) )->get_id() );
+   report_memory( "accounts", resident );
+
+   resident = resident_bytes();
+   push_all( "transfer", [this,&ids]( uint32_t i ) -> operation {
+      transfer_operation op;
+      op.from = account_id_type();
+      op.to = ids[i];
+      op.amount = asset( 1000 );
+      return op;
+   });
+   const asset_object& uia = create_user_issued_asset( "MEMBENCH" );
+   const asset_id_type uia_id = uia.get_id();
+   const account_id_type issuer_id = uia.issuer;
+   push_all( "asset_issue", [&ids,uia_id,issuer_id]( uint32_t i ) -> operation {
+      asset_issue_operation op;
+      op.issuer = issuer_id;
+      op.asset_to_issue = asset( 1000000, uia_id );
+      op.issue_to_account = ids[i];
+      return op;
+   });
+   report_memory( "balances", resident );
+
+   // asks at 1000 different prices, none of them match
+   resident = resident_bytes();
+   push_all( "limit_order_create", [&ids,uia_id]( uint32_t i ) -> operation {
+      limit_order_create_operation op;
+      op.seller = ids[i];
+      op.amount_to_sell = asset( 1000, uia_id );
+      op.min_to_receive = asset( 1000 + i % 1000 );
+      op.expiration = time_point_sec::maximum();
+      return op;
+   });
+   BOOST_CHECK_EQUAL( db.get_index_type<limit_order_index>().indices().size(), account_count );
+   report_memory( "orders", resident );
+
+   // the pre-images of one modification of every balance object in a single undo state, as copies and packed
+   const auto undo_bytes_per_balance = [this]( bool packed ) {
+      const bool old_mode = db._undo_db.packed_mode();
+      db._undo_db.set_packed_mode( packed );
+      const uint64_t undo_before = balance_undo_bytes();
+      const auto& balances = db.get_index_type<account_balance_index>().indices();
+      auto session = db._undo_db.start_undo_session();
+      for( const account_balance_object& balance : balances )
+         db.modify( balance, []( account_balance_object& b ) { b.balance += 0; } );
+      const double result = double( balance_undo_bytes() - undo_before ) / balances.size();
+      session.undo();
+      db._undo_db.set_packed_mode( old_mode );
+      return result;
+   };
+   const double copied_undo_bytes = undo_bytes_per_balance( false );
+   const double packed_undo_bytes = undo_bytes_per_balance( true );
+   BOOST_TEST_MESSAGE( "Undo state per modified balance: " << copied_undo_bytes << " bytes as a copy, "
+                       << packed_undo_bytes << " bytes packed" );
+   add_benchmark_result( "undo bytes per modified balance (copy)", copied_undo_bytes, "bytes" );
+   add_benchmark_result( "undo bytes per modified balance (packed)", packed_undo_bytes, "bytes" );
+
+   // saving and opening the object database
+   auto start = fc::time_point::now();
+   db.flush();
+   const auto save_time = fc::time_point::now() - start;
+   const uint64_t saved_bytes = directory_bytes( db.get_data_dir() / "object_database" );
+   BOOST_TEST_MESSAGE( "Saved the object database, " << saved_bytes << " bytes, in " << save_time.count() / 1000
+                       << " ms" );
+   add_benchmark_result( "object database save", save_time.count() / 1000, "ms" );
+   add_benchmark_result( "object database size", saved_bytes, "bytes" );
+   {
+      // the indexes of the plugins are not added, their files are not loaded
+      database reopened;
+      resident = resident_bytes();
+      start = fc::time_point::now();
+      reopened.graphene::db::object_database::open( db.get_data_dir() );
+      const auto open_time = fc::time_point::now() - start;
+      BOOST_TEST_MESSAGE( "Opened the object database in " << open_time.count() / 1000 << " ms, resident set grew by "
+                          << int64_t( resident_bytes() - resident ) << " bytes" );
+      add_benchmark_result( "object database open", open_time.count() / 1000, "ms" );
+      BOOST_CHECK_EQUAL( reopened.get_index_type<account_balance_index>().indices().size(),
+                         db.get_index_type<account_balance_index>().indices().size() );
+      BOOST_CHECK_EQUAL( reopened.get_index_type<limit_order_index>().indices().size(), account_count );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
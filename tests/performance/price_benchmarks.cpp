@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2026 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/protocol/asset.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+#include <fc/uint128.hpp>
+
+#include "latency_stats.hpp"
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace graphene::protocol;
+using graphene::chain::test::add_benchmark_result;
+
+namespace {
+
+/// asset * price as it was computed before the 64-bit fast path, always dividing in 128 bits
+asset reference_multiply( const asset& a, const price& b )
+{
+   if( a.asset_id == b.base.asset_id )
+   {
+      FC_ASSERT( b.base.amount.value > 0 );
+      fc::uint128_t result = ( fc::uint128_t( a.amount.value ) * b.quote.amount.value ) / b.base.amount.value;
+      FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
+      return asset( static_cast<int64_t>( result ), b.quote.asset_id );
+   }
+   FC_ASSERT( a.asset_id == b.quote.asset_id && b.quote.amount.value > 0 );
+   fc::uint128_t result = ( fc::uint128_t( a.amount.value ) * b.base.amount.value ) / b.quote.amount.value;
+   FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
+   return asset( static_cast<int64_t>( result ), b.base.asset_id );
+}
+
+/// asset::multiply_and_round_up as it was computed before the 64-bit fast path
+asset reference_multiply_and_round_up( const asset& a, const price& b )
+{
+   if( a.asset_id == b.base.asset_id )
+   {
+      FC_ASSERT( b.base.amount.value > 0 );
+      fc::uint128_t result = ( ( ( fc::uint128_t( a.amount.value ) * b.quote.amount.value ) + b.base.amount.value )
+                               - 1 ) / b.base.amount.value;
+      FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
+      return asset( static_cast<int64_t>( result ), b.quote.asset_id );
+   }
+   FC_ASSERT( a.asset_id == b.quote.asset_id && b.quote.amount.value > 0 );
+   fc::uint128_t result = ( ( ( fc::uint128_t( a.amount.value ) * b.base.amount.value ) + b.quote.amount.value )
+                            - 1 ) / b.quote.amount.value;
+   FC_ASSERT( result <= GRAPHENE_MAX_SHARE_SUPPLY );
+   return asset( static_cast<int64_t>( result ), b.base.asset_id );
+}
+
+struct price_sample
+{
+   asset amount;
+   price rate;
+};
+
+/// Random amounts and prices of at most @p amount_bits bits, the products fit in 64 bits for up to 31 bits
+std::vector<price_sample> make_samples( size_t count, uint32_t amount_bits )
+{
+   std::mt19937_64 random( 42 );
+   const int64_t max_amount = amount_bits >= 63 ? GRAPHENE_MAX_SHARE_SUPPLY : ( int64_t(1) << amount_bits );
+   std::uniform_int_distribution<int64_t> amounts( 1, max_amount );
+   std::vector<price_sample> samples;
+   samples.reserve( count );
+   for( size_t i = 0; i < count; ++i )
+   {
+      price_sample sample;
+      sample.rate = asset( amounts( random ), asset_id_type(1) ) / asset( amounts( random ), asset_id_type() );
+      // the result must not exceed the maximum supply
+      const fc::uint128_t limit = fc::uint128_t( GRAPHENE_MAX_SHARE_SUPPLY ) * sample.rate.base.amount.value
+                                  / sample.rate.quote.amount.value;
+      const int64_t amount = amounts( random );
+      sample.amount = asset( fc::uint128_t( amount ) > limit ? static_cast<int64_t>( limit ) : amount,
+                             asset_id_type(1) );
+      samples.push_back( sample );
+   }
+   return samples;
+}
+
+/// Runs @p kernel over all samples @p rounds times and logs the throughput
+void measure( const std::string& what, const std::vector<price_sample>& samples, uint32_t rounds,
+              const std::function<int64_t( const price_sample& )>& kernel )
+{
+   int64_t checksum = 0;
+   const auto start = fc::time_point::now();
+   for( uint32_t round = 0; round < rounds; ++round )
+      for( const price_sample& sample : samples )
+         checksum += kernel( sample );
+   const int64_t elapsed = ( fc::time_point::now() - start ).count();
+   const int64_t count = int64_t( samples.size() ) * rounds;
+   wlog( "Benchmark: ${what}: ${n} in ${ms} ms, ${ns} ns each (checksum ${c})",
+         ("what",what)("n",count)("ms",elapsed / 1000)("ns",count > 0 ? elapsed * 1000 / count : 0)("c",checksum) );
+   add_benchmark_result( what, count > 0 ? elapsed * 1000.0 / count : 0.0, "ns" );
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( price_benchmarks )
+
+/**
+ * Compares asset * price and asset::multiply_and_round_up with the implementation which always divides in 128 bits,
+ * for amounts whose products fit in 64 bits and for the largest possible amounts
+ */
+BOOST_AUTO_TEST_CASE( asset_price_multiplication_benchmark )
+{ try {
+   const size_t sample_count = 100000;
+   const uint32_t rounds = 20;
+   for( uint32_t amount_bits : { 24u, 63u } )
+   {
+      const std::vector<price_sample> samples = make_samples( sample_count, amount_bits );
+      // both implementations agree, including the rounding
+      for( const price_sample& sample : samples )
+      {
+         BOOST_REQUIRE( sample.amount * sample.rate == reference_multiply( sample.amount, sample.rate ) );
+         BOOST_REQUIRE( sample.amount.multiply_and_round_up( sample.rate )
+                        == reference_multiply_and_round_up( sample.amount, sample.rate ) );
+      }
+
+      const std::string suffix = " with amounts of up to " + std::to_string( amount_bits ) + " bits";
+      measure( "asset * price" + suffix, samples, rounds, []( const price_sample& s ) {
+         return ( s.amount * s.rate ).amount.value;
+      });
+      measure( "reference asset * price" + suffix, samples, rounds, []( const price_sample& s ) {
+         return reference_multiply( s.amount, s.rate ).amount.value;
+      });
+      measure( "multiply_and_round_up" + suffix, samples, rounds, []( const price_sample& s ) {
+         return s.amount.multiply_and_round_up( s.rate ).amount.value;
+      });
+      measure( "reference multiply_and_round_up" + suffix, samples, rounds, []( const price_sample& s ) {
+         return reference_multiply_and_round_up( s.amount, s.rate ).amount.value;
+      });
+   }
+} FC_LOG_AND_RETHROW() }
+
+/// Measures price comparisons, as the order book indexes do them
+BOOST_AUTO_TEST_CASE( price_comparison_benchmark )
+{ try {
+   const std::vector<price_sample> samples = make_samples( 100000, 63 );
+   measure( "price < price", samples, 20, [&samples]( const price_sample& s ) {
+      return s.rate < samples.front().rate ? 1 : 0;
+   });
+   measure( "price == price", samples, 20, [&samples]( const price_sample& s ) {
+      return s.rate == samples.front().rate ? 1 : 0;
+   });
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -81,4 +81,42 @@ BOOST_AUTO_TEST_CASE( api_limit_get_asset_holders )
    BOOST_REQUIRE_EQUAL( holders.size(), 4u );
 }
 
+BOOST_AUTO_TEST_CASE( asset_holders_index )
+{ try {
+   graphene::app::asset_api asset_api(app);
+
+   ACTORS( (alice)(bob)(carol)(dan) );
+   transfer( committee_account, bob_id, asset(10000000) );
+   const auto& usd = create_user_issued_asset( "USDTEST" );
+   const string usd_id = std::string( static_cast<object_id_type>( usd.get_id() ) );
+   BOOST_CHECK_EQUAL( asset_api.get_asset_holders_count( usd_id ), 0 );
+
+   issue_uia( alice_id, usd.amount(100) );
+   issue_uia( bob_id, usd.amount(300) );
+   issue_uia( carol_id, usd.amount(200) );
+   BOOST_CHECK_EQUAL( asset_api.get_asset_holders_count( usd_id ), 3 );
+
+   // pagination by rank
+   auto holders = asset_api.get_asset_holders( usd_id, 1, 10 );
+   BOOST_REQUIRE_EQUAL( holders.size(), 2u );
+   BOOST_CHECK( holders[0].name == "carol" );
+   BOOST_CHECK( holders[1].name == "alice" );
+   BOOST_CHECK_EQUAL( asset_api.get_asset_holders( usd_id, 3, 10 ).size(), 0u );
+
+   // balances which change move the holders, empty balances do not count
+   transfer( bob_id, dan_id, usd.amount(300) );
+   generate_block();
+   BOOST_CHECK_EQUAL( asset_api.get_asset_holders_count( usd_id ), 3 );
+   holders = asset_api.get_asset_holders( usd_id, 0, 1 );
+   BOOST_REQUIRE_EQUAL( holders.size(), 1u );
+   BOOST_CHECK( holders[0].name == "dan" );
+   BOOST_CHECK_EQUAL( holders[0].amount.value, 300 );
+
+   for( const auto& ah : asset_api.get_all_asset_holders() )
+   {
+      if( ah.asset_id == usd.get_id() )
+         BOOST_CHECK_EQUAL( ah.count, 3 );
+   }
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
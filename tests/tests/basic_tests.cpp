@@ -29,14 +29,25 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/exceptions.hpp>
+#include <graphene/chain/impacted.hpp>
 
 #include <graphene/db/simple_index.hpp>
 
+#include <graphene/protocol/key_string_cache.hpp>
+#include <graphene/protocol/signature_cache.hpp>
+
+#include <graphene/net/config.hpp>
+#include <graphene/net/peer_database.hpp>
+#include <graphene/net/rolling_bloom_filter.hpp>
+
+#include <graphene/utilities/thread_affinity.hpp>
+
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/hex.hpp>
 #include "../common/database_fixture.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <random>
 
 using namespace graphene::chain;
@@ -419,6 +430,239 @@ BOOST_AUTO_TEST_CASE( memo_test )
    BOOST_CHECK_EQUAL(m.get_message(receiver, sender.get_public_key()), "Hello, world!");
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( transaction_waves_test )
+{ try {
+   auto make_transfer = []( uint64_t from, uint64_t to, uint64_t fee_asset ) {
+      transfer_operation op;
+      op.from = account_id_type( from );
+      op.to = account_id_type( to );
+      op.fee = asset( 1, asset_id_type( fee_asset ) );
+      op.amount = asset( 1 );
+      signed_transaction tx;
+      tx.operations.push_back( op );
+      return tx;
+   };
+
+   std::vector<signed_transaction> txs;
+   txs.push_back( make_transfer( 10, 11, 0 ) ); // 0: wave 0
+   txs.push_back( make_transfer( 12, 13, 2 ) ); // 1: independent of 0, wave 0
+   txs.push_back( make_transfer( 11, 14, 0 ) ); // 2: after 0 due to account 11, wave 1
+   txs.push_back( make_transfer( 15, 16, 2 ) ); // 3: after 1 due to the fee pool of asset 2, wave 1
+   txs.push_back( make_transfer( 22, 23, 0 ) ); // 4: wave 0
+   signed_transaction vote;
+   account_update_operation update;
+   update.account = account_id_type( 20 );
+   vote.operations.push_back( update );
+   txs.push_back( vote );                       // 5: conflicts with all, wave 2
+   txs.push_back( make_transfer( 17, 18, 0 ) ); // 6: after the barrier, wave 3
+   txs.push_back( make_transfer( 19, 21, 0 ) ); // 7: wave 3
+
+   std::vector<transaction_conflict_set> sets;
+   for( const auto& tx : txs )
+      sets.push_back( transaction_get_conflict_set( tx ) );
+   BOOST_CHECK( !sets[0].conflicts_with_all );
+   BOOST_CHECK( sets[0].accounts.count( account_id_type(10) ) && sets[0].accounts.count( account_id_type(11) ) );
+   BOOST_CHECK( sets[0].assets.empty() );
+   BOOST_CHECK( sets[1].assets.count( asset_id_type(2) ) );
+   BOOST_CHECK( sets[5].conflicts_with_all );
+
+   const std::vector<uint32_t> waves = schedule_transaction_waves( sets );
+   BOOST_CHECK( waves == std::vector<uint32_t>( { 0, 0, 1, 1, 0, 2, 3, 3 } ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( signature_cache_test )
+{ try {
+   graphene::protocol::signature_cache cache;
+   auto key = generate_private_key("1");
+   auto other_key = generate_private_key("2");
+
+   vector<digest_type> digests;
+   for( uint32_t i = 0; i < 100; ++i )
+      digests.push_back( fc::sha256::hash( fc::to_string(i) ) );
+
+   // disabled by default
+   BOOST_CHECK( cache.recover( key.sign_compact( digests[0] ), digests[0] ) == public_key_type(key.get_public_key()) );
+   BOOST_CHECK_EQUAL( cache.size(), 0u );
+
+   cache.set_capacity( 32 );
+   BOOST_CHECK_EQUAL( cache.capacity(), 32u );
+   for( const auto& d : digests )
+   {
+      const auto sig = key.sign_compact( d );
+      BOOST_CHECK( cache.recover( sig, d ) == public_key_type(key.get_public_key()) );
+      // a hit returns the same key
+      BOOST_CHECK( cache.recover( sig, d ) == public_key_type(key.get_public_key()) );
+      // the same signature for another digest is not mixed up
+      const auto other_sig = other_key.sign_compact( d );
+      BOOST_CHECK( cache.recover( other_sig, d ) == public_key_type(other_key.get_public_key()) );
+      BOOST_CHECK( cache.size() <= cache.capacity() );
+   }
+   BOOST_CHECK( cache.size() > 0 );
+
+   cache.set_capacity( 0 );
+   BOOST_CHECK_EQUAL( cache.size(), 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( key_string_cache_test )
+{ try {
+   graphene::protocol::key_string_cache cache;
+   const public_key_type key( generate_private_key("1").get_public_key() );
+   const public_key_type other_key( generate_private_key("2").get_public_key() );
+   const std::string key_string( key );
+   std::string str;
+   fc::ecc::public_key_data data;
+
+   // disabled by default
+   cache.insert_formatted( key.key_data, key_string );
+   BOOST_CHECK( !cache.find_string( key.key_data, str ) );
+   BOOST_CHECK_EQUAL( cache.size(), 0u );
+
+   cache.set_capacity( 32 );
+   cache.insert_formatted( key.key_data, key_string );
+   BOOST_REQUIRE( cache.find_string( key.key_data, str ) );
+   BOOST_CHECK_EQUAL( str, key_string );
+   BOOST_REQUIRE( cache.find_key( key_string, data ) );
+   BOOST_CHECK( data == key.key_data );
+   BOOST_CHECK( !cache.find_string( other_key.key_data, str ) );
+
+   // parsed strings are only used for parsing
+   const std::string other_string( other_key );
+   cache.insert_parsed( other_string, other_key.key_data );
+   BOOST_CHECK( cache.find_key( other_string, data ) );
+   BOOST_CHECK( data == other_key.key_data );
+   BOOST_CHECK( !cache.find_string( other_key.key_data, str ) );
+
+   for( uint32_t i = 0; i < 100; ++i )
+   {
+      const public_key_type k( generate_private_key( fc::to_string(i) ).get_public_key() );
+      cache.insert_formatted( k.key_data, std::string( k ) );
+      BOOST_CHECK( cache.size() <= 2 * cache.capacity() );
+   }
+
+   cache.set_capacity( 0 );
+   BOOST_CHECK_EQUAL( cache.size(), 0u );
+
+   // the conversions of public_key_type give the same results with the process-wide cache
+   auto& shared = graphene::protocol::key_string_cache::instance();
+   const size_t old_capacity = shared.capacity();
+   shared.set_capacity( 32 );
+   BOOST_CHECK_EQUAL( std::string( key ), key_string );
+   BOOST_CHECK_EQUAL( std::string( key ), key_string );
+   BOOST_CHECK( public_key_type( key_string ) == key );
+   BOOST_CHECK( public_key_type( key_string ) == key );
+   std::string damaged = key_string;
+   damaged.back() = ( damaged.back() == '2' ? '3' : '2' );
+   BOOST_CHECK_THROW( public_key_type( damaged ), fc::exception );
+   shared.set_capacity( old_capacity );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( rolling_bloom_filter_test )
+{ try {
+   using graphene::net::item_id;
+   auto make_item = []( uint32_t i ) {
+      return item_id( graphene::net::trx_message_type, fc::ripemd160::hash( fc::to_string(i) ) );
+   };
+   graphene::net::rolling_bloom_filter filter( 2000, 0.001, fc::minutes(2) );
+   BOOST_CHECK( !filter.contains( make_item(0) ) );
+   BOOST_CHECK_EQUAL( filter.memory_usage(), 0u );
+
+   for( uint32_t i = 0; i < 1000; ++i )
+      filter.insert( make_item(i) );
+   BOOST_CHECK_EQUAL( filter.size(), 1000u );
+   BOOST_CHECK( filter.memory_usage() > 0 );
+   for( uint32_t i = 0; i < 1000; ++i )
+      BOOST_CHECK( filter.contains( make_item(i) ) );
+   uint32_t false_positives = 0;
+   for( uint32_t i = 1000; i < 11000; ++i )
+      if( filter.contains( make_item(i) ) )
+         ++false_positives;
+   BOOST_CHECK_LT( false_positives, 50u );
+
+   // the second generation keeps the last items, the first ones are forgotten after two generations
+   for( uint32_t i = 1000; i < 3000; ++i )
+      filter.insert( make_item(i) );
+   for( uint32_t i = 2000; i < 3000; ++i )
+      BOOST_CHECK( filter.contains( make_item(i) ) );
+   false_positives = 0;
+   for( uint32_t i = 0; i < 1000; ++i )
+      if( filter.contains( make_item(i) ) )
+         ++false_positives;
+   BOOST_CHECK_LT( false_positives, 50u );
+
+   // old generations expire
+   const fc::time_point later = fc::time_point::now() + fc::minutes(3);
+   filter.expire_old_items( later );
+   BOOST_CHECK( filter.contains( make_item(2999) ) );
+   filter.expire_old_items( later + fc::minutes(3) );
+   BOOST_CHECK_EQUAL( filter.size(), 0u );
+   BOOST_CHECK( !filter.contains( make_item(2999) ) );
+
+   GRAPHENE_REQUIRE_THROW( graphene::net::rolling_bloom_filter( 100, 0, fc::minutes(2) ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( peer_database_test )
+{ try {
+   using graphene::net::peer_database;
+   using graphene::net::potential_peer_record;
+   fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   const fc::path filename = dir.path() / "peers.dat";
+   const auto endpoint = []( uint16_t port ) {
+      return fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), port );
+   };
+
+   {
+      peer_database db;
+      db.open( filename );
+      BOOST_CHECK_EQUAL( db.size(), 0u );
+      for( uint16_t port = 1; port <= 3; ++port )
+         db.update_entry( potential_peer_record( endpoint( port ), fc::time_point_sec( port ) ) );
+      potential_peer_record record = db.lookup_or_create_entry_for_endpoint( endpoint( 2 ) );
+      record.number_of_successful_connection_attempts = 5;
+      db.update_entry( record );
+      db.erase( endpoint( 3 ) );
+      // the database is not closed, the changes are already in the file
+   }
+
+   {
+      peer_database db;
+      db.open( filename );
+      BOOST_CHECK_EQUAL( db.size(), 2u );
+      BOOST_REQUIRE( db.lookup_entry_for_endpoint( endpoint( 2 ) ).valid() );
+      BOOST_CHECK_EQUAL( db.lookup_entry_for_endpoint( endpoint( 2 ) )->number_of_successful_connection_attempts, 5u );
+      BOOST_CHECK( !db.lookup_entry_for_endpoint( endpoint( 3 ) ).valid() );
+      db.close();
+   }
+
+   // a damaged entry at the end of the file is dropped, the entries before it are kept
+   {
+      std::ofstream out( filename.generic_string(), std::ios::out | std::ios::binary | std::ios::app );
+      out.write( "\x20\x00", 2 );
+   }
+   {
+      peer_database db;
+      db.open( filename );
+      BOOST_CHECK_EQUAL( db.size(), 2u );
+      db.update_entry( potential_peer_record( endpoint( 4 ) ) );
+      db.close();
+      db.open( filename );
+      BOOST_CHECK_EQUAL( db.size(), 3u );
+      db.close();
+   }
+
+   // the JSON file of older versions is imported when there is no store
+   const fc::path old_filename = dir.path() / "old_peers.json";
+   fc::json::save_to_file( std::vector<potential_peer_record>{ potential_peer_record( endpoint( 5 ) ) },
+                           old_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+   {
+      peer_database db;
+      db.open( dir.path() / "old_peers.dat" );
+      BOOST_CHECK_EQUAL( db.size(), 1u );
+      BOOST_CHECK( db.lookup_entry_for_endpoint( endpoint( 5 ) ).valid() );
+      db.close();
+   }
+   BOOST_CHECK( fc::exists( dir.path() / "old_peers.dat" ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( exceptions )
 {
    GRAPHENE_CHECK_THROW(FC_THROW_EXCEPTION(balance_claim_invalid_claim_amount, "Etc"), balance_claim_invalid_claim_amount);
@@ -641,6 +885,31 @@ BOOST_AUTO_TEST_CASE( merkle_root )
    BOOST_CHECK( block.calculate_merkle_root() == c(dO) );
 }
 
+BOOST_AUTO_TEST_CASE( merkle_accumulator_test )
+{
+   // appending the digests one by one gives the root of the whole block after every step
+   clearable_block block;
+   merkle_accumulator merkle;
+   BOOST_CHECK( merkle.root() == block.calculate_merkle_root() );
+   for( uint32_t i = 0; i < 70; ++i )
+   {
+      processed_transaction trx;
+      trx.ref_block_prefix = i;
+      merkle.append( trx.merkle_digest() );
+      block.transactions.push_back( trx );
+      block.clear();
+      BOOST_CHECK_EQUAL( merkle.size(), i + 1 );
+      BOOST_CHECK( merkle.root() == block.calculate_merkle_root() );
+   }
+
+   signed_block generated;
+   generated.transactions = block.transactions;
+   generated.set_merkle_root( merkle );
+   BOOST_CHECK( generated.transaction_merkle_root == block.calculate_merkle_root() );
+   generated.transactions.pop_back();
+   BOOST_CHECK_THROW( generated.set_merkle_root( merkle ), fc::exception );
+}
+
 /**
  * Reproduces https://github.com/bitshares/bitshares-core/issues/888 and tests fix for it.
  */
@@ -656,4 +925,26 @@ BOOST_AUTO_TEST_CASE( bitasset_feed_expiration_test )
    BOOST_CHECK( !o.feed_is_expired( now ) );
 }
 
+BOOST_AUTO_TEST_CASE( cpu_set_test )
+{
+   using graphene::utilities::parse_cpu_set;
+
+   BOOST_CHECK( parse_cpu_set( "3" ) == std::vector<uint32_t>( { 3 } ) );
+   // sorted and without duplicates
+   BOOST_CHECK( parse_cpu_set( "6-8, 1,7" ) == std::vector<uint32_t>( { 1, 6, 7, 8 } ) );
+   BOOST_CHECK_THROW( parse_cpu_set( "" ), fc::exception );
+   BOOST_CHECK_THROW( parse_cpu_set( "1,,2" ), fc::exception );
+   BOOST_CHECK_THROW( parse_cpu_set( "3-1" ), fc::exception );
+   BOOST_CHECK_THROW( parse_cpu_set( "-1" ), fc::exception );
+   BOOST_CHECK_THROW( parse_cpu_set( "x" ), fc::exception );
+   BOOST_CHECK_THROW( parse_cpu_set( "node:99999" ), fc::exception );
+   std::ifstream node0( "/sys/devices/system/node/node0/cpulist" );
+   if( node0 )
+      BOOST_CHECK( !parse_cpu_set( "node:0" ).empty() );
+
+   // CPUs which do not exist are ignored, so this lets the thread run anywhere
+   graphene::utilities::pin_current_thread( parse_cpu_set( "0-1023" ) );
+   BOOST_CHECK_THROW( graphene::utilities::pin_current_thread( {} ), fc::exception );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -33,9 +33,12 @@
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/impacted.hpp>
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 
+#include <graphene/net/block_tracer.hpp>
+
 #include <graphene/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
@@ -43,6 +46,11 @@
 
 #include "../common/database_fixture.hpp"
 
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
 using namespace graphene::chain;
 using namespace graphene::chain::test;
 
@@ -125,8 +133,240 @@ BOOST_AUTO_TEST_CASE( block_database_test )
          auto blk = bdb.fetch_by_number( i+1 );
          FC_ASSERT( blk.valid() );
          FC_ASSERT( blk->witness == witness_id_type(blk->block_num()) );
+         auto packed = bdb.fetch_packed_by_number( i+1 );
+         FC_ASSERT( packed.valid() );
+         FC_ASSERT( *packed == fc::raw::pack( *blk ) );
+      }
+      FC_ASSERT( !bdb.fetch_packed_by_number( 6 ).valid() );
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( segmented_block_database_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      segmented_block_log::settings format;
+      format.blocks_per_segment = segmented_block_log::min_blocks_per_segment;
+      format.compress = segmented_block_log::compression_supported();
+      const uint32_t num_blocks = 2 * format.blocks_per_segment + 5;
+
+      block_database bdb;
+      bdb.open( data_dir.path(), format );
+      BOOST_CHECK( bdb.is_open() );
+      BOOST_CHECK( !bdb.last_id().valid() );
+
+      clearable_block b;
+      vector<block_id_type> ids( 1 );
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.clear();
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+      }
+      BOOST_CHECK( fc::exists( data_dir.path() / "0000000000.index" ) );
+      BOOST_CHECK( fc::exists( data_dir.path() / "0000000002.blocks" ) );
+      BOOST_CHECK( !fc::exists( data_dir.path() / "index" ) );
+
+      const auto check_block = [&bdb,&ids]( uint32_t block_num ) {
+         const auto blk = bdb.fetch_by_number( block_num );
+         BOOST_REQUIRE( blk.valid() );
+         BOOST_CHECK( blk->witness == witness_id_type(block_num) );
+         BOOST_CHECK( bdb.fetch_block_id( block_num ) == ids[block_num] );
+         BOOST_CHECK( bdb.contains( ids[block_num] ) );
+         BOOST_CHECK( bdb.fetch_optional( ids[block_num] ).valid() );
+         const auto packed = bdb.fetch_packed_by_number( block_num );
+         BOOST_REQUIRE( packed.valid() );
+         BOOST_CHECK( *packed == fc::raw::pack( *blk ) );
+      };
+      for( uint32_t block_num : { 1u, format.blocks_per_segment - 1, format.blocks_per_segment,
+                                  2 * format.blocks_per_segment + 1, num_blocks } )
+         check_block( block_num );
+      BOOST_CHECK( !bdb.fetch_by_number( num_blocks + 1 ).valid() );
+      BOOST_CHECK( bdb.last_id() == ids.back() );
+
+      // remove the blocks of the last segment, the last block is then in the previous segment
+      for( uint32_t block_num = num_blocks; block_num >= 2 * format.blocks_per_segment; --block_num )
+         bdb.remove( ids[block_num] );
+      BOOST_CHECK( !bdb.contains( ids[num_blocks] ) );
+      BOOST_CHECK( bdb.last_id() == ids[2 * format.blocks_per_segment - 1] );
+
+      // the format is kept when reopening
+      bdb.close();
+      BOOST_CHECK( !bdb.is_open() );
+      bdb.open( data_dir.path() );
+      BOOST_CHECK( bdb.last_id() == ids[2 * format.blocks_per_segment - 1] );
+      check_block( format.blocks_per_segment );
+      BOOST_CHECK_EQUAL( bdb.total_block_size(),
+                         fc::file_size( data_dir.path() / "0000000000.blocks" )
+                         + fc::file_size( data_dir.path() / "0000000001.blocks" )
+                         + fc::file_size( data_dir.path() / "0000000002.blocks" ) );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_database_pruning_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      segmented_block_log::settings format;
+      format.blocks_per_segment = segmented_block_log::min_blocks_per_segment;
+      const uint32_t num_blocks = 3 * format.blocks_per_segment + 5;
+
+      block_database bdb;
+      bdb.open( data_dir.path(), format );
+      BOOST_REQUIRE( bdb.is_segmented() );
+      BOOST_CHECK_EQUAL( 1u, bdb.first_block_num() );
+
+      clearable_block b;
+      vector<block_id_type> ids( 1 );
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.clear();
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
       }
 
+      // only complete segments are removed
+      bdb.prune( 2 * format.blocks_per_segment - 1 );
+      BOOST_CHECK_EQUAL( format.blocks_per_segment, bdb.first_block_num() );
+      BOOST_CHECK( !bdb.fetch_by_number( format.blocks_per_segment - 1 ).valid() );
+      BOOST_CHECK( !bdb.contains( ids[1] ) );
+      GRAPHENE_REQUIRE_THROW( bdb.fetch_block_id( 1 ), fc::key_not_found_exception );
+      BOOST_CHECK( bdb.fetch_by_number( format.blocks_per_segment ).valid() );
+      BOOST_CHECK( bdb.fetch_optional( ids[num_blocks] ).valid() );
+
+      // the files of a pruned segment are deleted by the next prune
+      BOOST_CHECK( fc::exists( data_dir.path() / "0000000000.blocks" ) );
+      bdb.prune( 2 * format.blocks_per_segment );
+      BOOST_CHECK( !fc::exists( data_dir.path() / "0000000000.blocks" ) );
+      BOOST_CHECK( !fc::exists( data_dir.path() / "0000000000.index" ) );
+      bdb.close();
+      BOOST_CHECK( !fc::exists( data_dir.path() / "0000000001.blocks" ) );
+
+      bdb.open( data_dir.path() );
+      BOOST_CHECK_EQUAL( 2 * format.blocks_per_segment, bdb.first_block_num() );
+      BOOST_CHECK( bdb.last_id() == ids.back() );
+      BOOST_CHECK( !bdb.fetch_by_number( 2 * format.blocks_per_segment - 1 ).valid() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_database_concurrent_read_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+
+      const uint32_t num_blocks = 500;
+      std::atomic<uint32_t> stored( 0 );
+      std::atomic<uint32_t> failures( 0 );
+      std::atomic<bool> done( false );
+      // blocks are stored here while another thread reads the ones which are already stored
+      std::thread reader( [&]() {
+         uint32_t reads = 0;
+         while( !done.load() || reads == 0 )
+         {
+            const uint32_t count = stored.load();
+            if( count == 0 )
+               continue;
+            const uint32_t block_num = 1 + ( reads++ * 7919 ) % count;
+            const auto blk = bdb.fetch_by_number( block_num );
+            if( !blk.valid() || blk->block_num() != block_num
+                  || blk->witness != witness_id_type(block_num)
+                  || bdb.fetch_block_id( block_num ) != blk->id() )
+               ++failures;
+         }
+      });
+
+      clearable_block b;
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.clear();
+         bdb.store( b.id(), b );
+         stored.store( i + 1 );
+      }
+      done.store( true );
+      reader.join();
+
+      BOOST_CHECK_EQUAL( 0u, failures.load() );
+      BOOST_CHECK( bdb.last_id() == b.id() );
+      BOOST_CHECK_EQUAL( bdb.total_block_size(), fc::file_size( data_dir.path() / "blocks" ) );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_database_write_behind_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+      bdb.set_write_queue_size( 4 );
+
+      // queued blocks can be read before they are written
+      clearable_block b;
+      vector<block_id_type> ids;
+      for( uint32_t i = 0; i < 50; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.clear();
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+
+         BOOST_CHECK( bdb.contains( b.id() ) );
+         BOOST_CHECK( bdb.fetch_block_id( i+1 ) == b.id() );
+         auto fetch = bdb.fetch_optional( b.id() );
+         BOOST_REQUIRE( fetch.valid() );
+         BOOST_CHECK( fetch->witness == b.witness );
+         BOOST_CHECK( bdb.last_id() == b.id() );
+         if( i % 10 == 0 )
+            bdb.request_flush( i+1 );
+      }
+
+      // a later block with the same number replaces the queued or written one
+      clearable_block other;
+      other.previous = ids[48];
+      other.witness = witness_id_type(100);
+      other.clear();
+      bdb.store( other.id(), other );
+      BOOST_CHECK( !bdb.contains( ids[49] ) );
+      BOOST_CHECK( bdb.contains( other.id() ) );
+
+      bdb.flush();
+      BOOST_CHECK_EQUAL( bdb.total_block_size(), fc::file_size( data_dir.path() / "blocks" ) );
+      bdb.close();
+
+      block_database reopened;
+      reopened.open( data_dir.path() );
+      BOOST_CHECK( reopened.last_id() == other.id() );
+      for( uint32_t i = 0; i < 49; ++i )
+      {
+         auto blk = reopened.fetch_by_number( i+1 );
+         BOOST_REQUIRE( blk.valid() );
+         BOOST_CHECK( blk->id() == ids[i] );
+      }
    } catch (fc::exception& e) {
       edump((e.to_detail_string()));
       throw;
@@ -192,6 +432,350 @@ BOOST_AUTO_TEST_CASE( generate_empty_blocks )
    }
 }
 
+BOOST_AUTO_TEST_CASE( replay_with_prefetch_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+      block_id_type head_id;
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis, "TEST" );
+         for( uint32_t i = 0; i < 50; ++i )
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                              database::skip_nothing);
+         head_id = db.head_block_id();
+         db.close();
+         // drop the object database so that all blocks are replayed
+         db.wipe( data_dir.path(), false );
+      }
+      for( uint32_t depth : { 1u, 7u, 1000u } )
+      {
+         database db;
+         db.set_reindex_prefetch_depth( depth );
+         db.open(data_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK( db.head_block_id() == head_id );
+         db.close();
+         db.wipe( data_dir.path(), false );
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( state_snapshot_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory snapshot_data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path snapshot_file = data_dir.path() / "state.snapshot";
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      database db1;
+      db1.open(data_dir.path(), make_genesis, "TEST" );
+      for( uint32_t i = 0; i < 30; ++i )
+         db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key,
+                            database::skip_nothing);
+      db1.save_state_snapshot( snapshot_file );
+
+      {
+         database db2;
+         db2.set_state_snapshot( snapshot_file );
+         // the genesis state must not be used
+         db2.open(snapshot_data_dir.path(), []() -> genesis_state_type { FC_THROW( "no genesis" ); }, "TEST" );
+         BOOST_CHECK( db2.head_block_id() == db1.head_block_id() );
+         BOOST_CHECK( db2.get_chain_id() == db1.get_chain_id() );
+         BOOST_CHECK_EQUAL( db2.get_index_type<account_index>().indices().size(),
+                            db1.get_index_type<account_index>().indices().size() );
+         BOOST_CHECK( db2.fetch_block_by_number( db2.head_block_num() ).valid() );
+
+         // both nodes continue the same chain
+         const signed_block b = db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1),
+                                                   init_account_priv_key, database::skip_nothing);
+         db2.push_block( b );
+         BOOST_CHECK( db2.head_block_id() == db1.head_block_id() );
+         db2.close();
+      }
+      {
+         // the state is on disk after loading the snapshot
+         database db2;
+         db2.open(snapshot_data_dir.path(), []() -> genesis_state_type { FC_THROW( "no genesis" ); }, "TEST" );
+         BOOST_CHECK( db2.head_block_id() == db1.head_block_id() );
+      }
+
+      // a damaged snapshot is rejected
+      {
+         std::fstream file( snapshot_file.generic_string(), std::ios::in | std::ios::out | std::ios::binary );
+         // inside the hash of the last chunk
+         file.seekp( fc::file_size( snapshot_file ) - 10 );
+         file.put( ~(char)file.peek() );
+      }
+      fc::temp_directory damaged_data_dir( graphene::utilities::temp_directory_path() );
+      database db3;
+      db3.set_state_snapshot( snapshot_file );
+      BOOST_CHECK_THROW( db3.open(damaged_data_dir.path(), make_genesis, "TEST" ), fc::exception );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( import_blocks_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      database db1;
+      db1.open(data_dir.path(), make_genesis, "TEST" );
+      for( uint32_t i = 0; i < 30; ++i )
+         db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key,
+                            database::skip_nothing);
+      // the blocks file keeps the replaced block of a fork
+      db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key,
+                         database::skip_nothing);
+      db1.pop_block();
+      db1.generate_block(db1.get_slot_time(2), db1.get_scheduled_witness(2), init_account_priv_key,
+                         database::skip_nothing);
+      const fc::path blocks_file = data_dir.path() / "database" / "block_num_to_block" / "blocks";
+
+      {
+         fc::temp_directory import_data_dir( graphene::utilities::temp_directory_path() );
+         database db2;
+         std::ifstream in( blocks_file.generic_string(), std::ios::in | std::ios::binary );
+         BOOST_CHECK_EQUAL( db2.import_blocks( import_data_dir.path(), in ), db1.head_block_num() );
+         db2.open(import_data_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK( db2.head_block_id() == db1.head_block_id() );
+         BOOST_CHECK( db2.get_block_id_for_num( db2.head_block_num() ) == db1.head_block_id() );
+      }
+
+      vector<signed_block> blocks;
+      for( uint32_t n = 1; n <= db1.head_block_num(); ++n )
+         blocks.push_back( *db1.fetch_block_by_number( n ) );
+      const auto import = []( const vector<signed_block>& log, const flat_map<uint32_t,block_id_type>& checkpoints ) {
+         std::stringstream stream;
+         for( const auto& block : log )
+            fc::raw::pack( stream, block );
+         fc::temp_directory import_data_dir( graphene::utilities::temp_directory_path() );
+         database db;
+         db.add_checkpoints( checkpoints );
+         db.import_blocks( import_data_dir.path(), stream );
+      };
+      import( blocks, { { 10, blocks[9].id() } } );
+
+      // a wrong checkpoint
+      BOOST_CHECK_THROW( import( blocks, { { 10, blocks[10].id() } } ), fc::exception );
+      // a gap
+      vector<signed_block> damaged = blocks;
+      damaged.erase( damaged.begin() + 9 );
+      BOOST_CHECK_THROW( import( damaged, {} ), fc::exception );
+      // a block which does not link to its predecessor
+      damaged = blocks;
+      damaged[5].timestamp += 1;
+      BOOST_CHECK_THROW( import( damaged, {} ), fc::exception );
+      // a wrong merkle root
+      damaged = blocks;
+      damaged[5].transaction_merkle_root = checksum_type::hash( string( "x" ) );
+      BOOST_CHECK_THROW( import( damaged, {} ), fc::exception );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( assume_valid_block_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      database db1;
+      db1.open(data_dir.path(), make_genesis, "TEST" );
+      vector<signed_block> blocks;
+      for( uint32_t i = 0; i < 10; ++i )
+         blocks.push_back( db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1),
+                                              init_account_priv_key, database::skip_nothing) );
+
+      // a block 1 with a signature of the wrong key
+      signed_block bad_block;
+      {
+         signed_block b = blocks[0];
+         b.sign( fc::ecc::private_key::regenerate(fc::sha256::hash(string("wrong_key")) ) );
+         const vector<char> packed = fc::raw::pack( b );
+         bad_block.unpack_from( packed.data(), packed.size() );
+      }
+
+      {
+         fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+         database db2;
+         db2.open(data_dir2.path(), make_genesis, "TEST" );
+         BOOST_CHECK_THROW( db2.push_block( bad_block, database::skip_nothing ), fc::exception );
+      }
+      {
+         // the signatures of the ancestors of the assumed block are not checked
+         fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+         database db2;
+         db2.set_assume_valid_block( blocks.back().id() );
+         db2.open(data_dir2.path(), make_genesis, "TEST" );
+         db2.push_block( bad_block, database::skip_nothing );
+         BOOST_CHECK( db2.head_block_id() == bad_block.id() );
+      }
+      {
+         // only the assumed block is accepted at its number
+         fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+         database db2;
+         db2.set_assume_valid_block( bad_block.id() );
+         db2.open(data_dir2.path(), make_genesis, "TEST" );
+         BOOST_CHECK_THROW( db2.push_block( blocks[0], database::skip_nothing ), fc::exception );
+         // later blocks are validated
+         db2.set_assume_valid_block( blocks[4].id() );
+         for( const auto& b : blocks )
+            db2.push_block( b, database::skip_nothing );
+         BOOST_CHECK( db2.head_block_id() == blocks.back().id() );
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( apply_replicated_block_test )
+{
+   try {
+      fc::temp_directory data_dir1( graphene::utilities::temp_directory_path() );
+      fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      database db1;
+      db1.open(data_dir1.path(), make_genesis, "TEST" );
+      database db2;
+      db2.open(data_dir2.path(), make_genesis, "TEST" );
+
+      // capture the changes of the blocks of db1 like the object_changes plugin
+      vector<operation_history_object> ops;
+      vector<replicated_object_change> changes;
+      const auto add_changes = [&db1,&changes]( const vector<object_id_type>& ids ) {
+         for( const auto& id : ids )
+         {
+            const object* obj = db1.find_object( id );
+            if( obj != nullptr )
+               changes.push_back( replicated_object_change{ id, obj->pack() } );
+         }
+      };
+      db1.applied_block.connect( [&db1,&ops,&changes]( const signed_block& ) {
+         ops.clear();
+         changes.clear();
+         for( const auto& op : db1.get_applied_operations() )
+         {
+            if( op.valid() )
+               ops.push_back( *op );
+         }
+      } );
+      db1.new_objects.connect( [&add_changes]( const vector<object_id_type>& ids, const flat_set<account_id_type>& ) {
+         add_changes( ids );
+      } );
+      db1.changed_objects.connect( [&add_changes]( const vector<object_id_type>& ids,
+                                                   const flat_set<account_id_type>& ) {
+         add_changes( ids );
+      } );
+      db1.removed_objects.connect( [&changes]( const vector<object_id_type>& ids, const vector<const object*>&,
+                                               const flat_set<account_id_type>& ) {
+         for( const auto& id : ids )
+            changes.push_back( replicated_object_change{ id, vector<char>() } );
+      } );
+      size_t replicated_ops = 0;
+      db2.applied_block.connect( [&db2,&replicated_ops]( const signed_block& ) {
+         replicated_ops = db2.get_applied_operations().size();
+      } );
+
+      const auto generate_and_replicate = [&]() {
+         const signed_block b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness(1),
+                                                   init_account_priv_key, database::skip_nothing );
+         db2.apply_replicated_block( b, ops, changes );
+         BOOST_CHECK( db2.head_block_id() == db1.head_block_id() );
+         BOOST_CHECK_EQUAL( replicated_ops, ops.size() );
+         return b;
+      };
+      generate_and_replicate();
+
+      const account_object& init1 = *db1.get_index_type<account_index>().indices().get<by_name>().find("init1");
+      signed_transaction trx;
+      trx.set_expiration( db1.head_block_time() + fc::minutes(1) );
+      trx.set_reference_block( db1.head_block_id() );
+      account_create_operation cop;
+      cop.registrar = init1.id;
+      cop.name = "nathan";
+      cop.owner = authority(1, init_account_priv_key.get_public_key(), 1);
+      cop.active = cop.owner;
+      trx.operations.push_back(cop);
+      PUSH_TX( db1, trx, ~0 );
+      const signed_block with_account = generate_and_replicate();
+      const auto saved_ops = ops;
+      const auto saved_changes = changes;
+
+      const auto& accounts_by_name = db2.get_index_type<account_index>().indices().get<by_name>();
+      BOOST_REQUIRE( accounts_by_name.find( "nathan" ) != accounts_by_name.end() );
+      const account_id_type nathan_id = accounts_by_name.find( "nathan" )->id;
+      BOOST_CHECK( nathan_id(db2).statistics(db2).owner == nathan_id );
+      BOOST_CHECK( db2.get_index( protocol_ids, account_object_type ).get_next_id() ==
+                   db1.get_index( protocol_ids, account_object_type ).get_next_id() );
+
+      generate_and_replicate();
+
+      BOOST_TEST_MESSAGE( "Replicating a block again pops the blocks from its number on" );
+      db2.apply_replicated_block( with_account, saved_ops, saved_changes );
+      BOOST_CHECK( db2.head_block_id() == with_account.id() );
+      BOOST_CHECK( accounts_by_name.find( "nathan" ) != accounts_by_name.end() );
+
+      BOOST_TEST_MESSAGE( "A block which does not link is rejected" );
+      const signed_block unlinked = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness(1),
+                                                        init_account_priv_key, database::skip_nothing );
+      BOOST_CHECK_THROW( db2.apply_replicated_block( unlinked, ops, changes ), fc::exception );
+      BOOST_CHECK( db2.head_block_id() == with_account.id() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( fork_db_hot_window_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+      database db;
+      db.set_fork_db_hot_window( 2 );
+      db.open(data_dir.path(), make_genesis, "TEST" );
+
+      vector<signed_block> blocks;
+      for( uint32_t i = 0; i < 20; ++i )
+         blocks.push_back( db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                                             database::skip_nothing) );
+      const auto usage = db.get_fork_database_usage();
+      // blocks older than the last irreversible block are removed from the fork database
+      BOOST_CHECK_GT( usage.item_count, 4u );
+      BOOST_CHECK_EQUAL( usage.body_count, 2u );
+      BOOST_CHECK_GT( usage.bytes, 0u );
+
+      // released blocks are read from the block database
+      const auto old_block = db.fetch_block_by_number( 17 );
+      BOOST_REQUIRE( old_block.valid() );
+      BOOST_CHECK( old_block->id() == blocks[16].id() );
+
+      // popping below the hot window restores the transactions
+      while( db.head_block_num() > 16 )
+         db.pop_block();
+      BOOST_CHECK( db.head_block_id() == blocks[15].id() );
+      for( size_t i = 16; i < blocks.size(); ++i )
+         PUSH_BLOCK( db, blocks[i] );
+      BOOST_CHECK( db.head_block_id() == blocks.back().id() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( undo_block )
 {
    try {
@@ -740,6 +1324,182 @@ BOOST_AUTO_TEST_CASE( duplicate_transactions )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( recent_transaction_storage, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice) );
+      generate_block();
+
+      const auto push_transfer = [this,alice_id]( int64_t amount ) {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = account_id_type();
+         op.to = alice_id;
+         op.amount = asset( amount );
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         PUSH_TX( db, tx, ~0 & ~database::skip_transaction_dupe_check );
+         return tx;
+      };
+
+      BOOST_TEST_MESSAGE( "Transactions are stored by default" );
+      const signed_transaction stored = push_transfer( 100 );
+      BOOST_CHECK( db.get_recent_transaction( stored.id() ).id() == stored.id() );
+
+      BOOST_TEST_MESSAGE( "Without storage only the ID is kept, duplicates are still rejected" );
+      db.enable_recent_transaction_storage( false );
+      const signed_transaction not_stored = push_transfer( 200 );
+      BOOST_CHECK( db.is_known_transaction( not_stored.id() ) );
+      GRAPHENE_REQUIRE_THROW( db.get_recent_transaction( not_stored.id() ), fc::exception );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, not_stored, ~0 & ~database::skip_transaction_dupe_check ),
+                              fc::exception );
+      BOOST_CHECK( db.get_recent_transaction( stored.id() ).id() == stored.id() );
+
+      generate_block();
+      BOOST_CHECK( db.is_known_transaction( not_stored.id() ) );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, not_stored, ~0 & ~database::skip_transaction_dupe_check ),
+                              fc::exception );
+      BOOST_CHECK_EQUAL( db.get_balance( alice_id, asset_id_type() ).amount.value, 300 );
+
+      BOOST_TEST_MESSAGE( "Expired transactions are forgotten" );
+      generate_blocks( db.head_block_time() + db.get_global_properties().parameters.maximum_time_until_expiration
+                       + db.get_global_properties().parameters.block_interval );
+      BOOST_CHECK( !db.is_known_transaction( stored.id() ) );
+      BOOST_CHECK( !db.is_known_transaction( not_stored.id() ) );
+   }
+   catch (fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( pending_transaction_limit_test, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      fund( alice );
+      fund( bob );
+      generate_block();
+
+      const auto make_transfer = [this]( account_id_type from, int64_t amount, int64_t extra_fee ) {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = from;
+         op.to = GRAPHENE_NULL_ACCOUNT;
+         op.amount = asset( amount );
+         op.fee = db.current_fee_schedule().calculate_fee( op ) + asset( extra_fee );
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         return tx;
+      };
+
+      db.set_pending_transaction_limit( 2 );
+      const signed_transaction alice_tx = make_transfer( alice_id, 1, 100 );
+      const signed_transaction bob_tx = make_transfer( bob_id, 1, 100 );
+      PUSH_TX( db, alice_tx, ~0 );
+      PUSH_TX( db, bob_tx, ~0 );
+
+      BOOST_TEST_MESSAGE( "A transaction with the same fee rate is rejected, its payer has a pending one already" );
+      const signed_transaction alice_tx2 = make_transfer( alice_id, 2, 100 );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, alice_tx2, ~0 ), pending_transaction_pool_full );
+      BOOST_CHECK( !db.is_known_transaction( alice_tx2.id() ) );
+
+      BOOST_TEST_MESSAGE( "A transaction with a higher fee rate evicts a pending one" );
+      const signed_transaction committee_tx = make_transfer( account_id_type(), 1, 10000 );
+      PUSH_TX( db, committee_tx, ~0 );
+      BOOST_CHECK( db.is_known_transaction( committee_tx.id() ) );
+      BOOST_CHECK( db.is_known_transaction( alice_tx.id() ) != db.is_known_transaction( bob_tx.id() ) );
+
+      BOOST_TEST_MESSAGE( "Without a limit, every transaction is accepted" );
+      db.set_pending_transaction_limit( 0 );
+      PUSH_TX( db, alice_tx2, ~0 );
+      BOOST_CHECK( db.is_known_transaction( alice_tx2.id() ) );
+
+      generate_block();
+      BOOST_CHECK( db.is_known_transaction( committee_tx.id() ) );
+      BOOST_CHECK( db.is_known_transaction( alice_tx2.id() ) );
+   }
+   catch (fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( prepared_block_candidate )
+{
+   try {
+      fc::temp_directory dir1( graphene::utilities::temp_directory_path() );
+      database db1;
+      db1.open(dir1.path(), make_genesis, "TEST");
+
+      auto skip_sigs = database::skip_transaction_signatures;
+
+      auto init_account_priv_key  = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+      public_key_type init_account_pub_key  = init_account_priv_key.get_public_key();
+      const graphene::db::index& account_idx = db1.get_index(protocol_ids, account_object_type);
+
+      signed_transaction trx;
+      set_expiration( db1, trx );
+      account_id_type nathan_id = account_idx.get_next_id();
+      account_create_operation cop;
+      cop.name = "nathan";
+      cop.owner = authority(1, init_account_pub_key, 1);
+      cop.active = cop.owner;
+      trx.operations.push_back(cop);
+      trx.sign( init_account_priv_key, db1.get_chain_id() );
+      PUSH_TX( db1, trx, skip_sigs );
+
+      witness_id_type next_witness = db1.get_scheduled_witness( 1 );
+      BOOST_CHECK( db1.prepare_block_candidate( next_witness, skip_sigs ) );
+      // nothing has changed
+      BOOST_CHECK( !db1.prepare_block_candidate( next_witness, skip_sigs ) );
+      // the pending state is kept
+      BOOST_CHECK( db1.find( nathan_id ) != nullptr );
+
+      auto b = db1.generate_block( db1.get_slot_time(1), next_witness, init_account_priv_key, skip_sigs );
+      BOOST_CHECK_EQUAL( b.transactions.size(), 1u );
+      BOOST_CHECK( db1.find( nathan_id ) != nullptr );
+
+      // a transaction pushed after the candidate has been prepared is included as well
+      next_witness = db1.get_scheduled_witness( 1 );
+      BOOST_CHECK( db1.prepare_block_candidate( next_witness, skip_sigs ) );
+      trx = decltype(trx)();
+      set_expiration( db1, trx );
+      transfer_operation t;
+      t.to = nathan_id;
+      t.amount = asset(500);
+      trx.operations.push_back(t);
+      trx.sign( init_account_priv_key, db1.get_chain_id() );
+      PUSH_TX( db1, trx, skip_sigs );
+
+      b = db1.generate_block( db1.get_slot_time(1), next_witness, init_account_priv_key, skip_sigs );
+      BOOST_CHECK_EQUAL( b.transactions.size(), 1u );
+      BOOST_CHECK_EQUAL( db1.get_balance(nathan_id, asset_id_type()).amount.value, 500 );
+
+      // the candidate of the previous head block is not used
+      next_witness = db1.get_scheduled_witness( 1 );
+      trx = decltype(trx)();
+      set_expiration( db1, trx );
+      trx.operations.push_back(t);
+      trx.sign( init_account_priv_key, db1.get_chain_id() );
+      PUSH_TX( db1, trx, skip_sigs );
+      BOOST_CHECK( db1.prepare_block_candidate( next_witness, skip_sigs ) );
+      b = db1.generate_block( db1.get_slot_time(1), next_witness, init_account_priv_key, skip_sigs );
+      BOOST_CHECK_EQUAL( b.transactions.size(), 1u );
+      next_witness = db1.get_scheduled_witness( 1 );
+      b = db1.generate_block( db1.get_slot_time(1), next_witness, init_account_priv_key, skip_sigs );
+      BOOST_CHECK_EQUAL( b.transactions.size(), 0u );
+      BOOST_CHECK_EQUAL( db1.get_balance(nathan_id, asset_id_type()).amount.value, 1000 );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( tapos )
 {
    try {
@@ -947,6 +1707,90 @@ BOOST_FIXTURE_TEST_CASE( limit_order_expiration, database_fixture )
    BOOST_CHECK_EQUAL( get_balance(*nathan, *core), 50000 );
 } FC_LOG_AND_RETHROW() }
 
+BOOST_FIXTURE_TEST_CASE( expiration_sweep_schedule_test, database_fixture )
+{ try {
+   generate_blocks( HARDFORK_615_TIME );
+   generate_block();
+
+   ACTOR(nathan);
+   fund( nathan );
+   const auto& test = create_bitasset( "MIATEST" );
+
+   const auto late = db.head_block_time() + fc::seconds(120);
+   const auto late_id = create_sell_order( nathan_id, asset(100), test.amount(100), late )->id;
+   generate_block();
+
+   // the schedule was recorded for the late order, an earlier order must still expire in time
+   const auto early = db.head_block_time() + fc::seconds(30);
+   const auto early_id = create_sell_order( nathan_id, asset(100), test.amount(100), early )->id;
+   generate_block();
+
+   while( db.head_block_time() < early )
+   {
+      BOOST_CHECK( db.find_object( early_id ) != nullptr );
+      generate_block();
+   }
+   BOOST_CHECK( db.find_object( early_id ) == nullptr );
+   BOOST_CHECK( db.find_object( late_id ) != nullptr );
+
+   // undoing the block brings the order back, the next block removes it again
+   db.pop_block();
+   BOOST_CHECK( db.find_object( early_id ) != nullptr );
+   generate_block();
+   BOOST_CHECK( db.find_object( early_id ) == nullptr );
+
+   while( db.head_block_time() < late )
+   {
+      BOOST_CHECK( db.find_object( late_id ) != nullptr );
+      generate_block();
+   }
+   BOOST_CHECK( db.find_object( late_id ) == nullptr );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( expiration_sweep_counters_test, database_fixture )
+{ try {
+   generate_blocks( HARDFORK_615_TIME );
+   generate_block();
+
+   ACTOR(nathan);
+   fund( nathan );
+   const auto& test = create_user_issued_asset( "UIATEST" );
+   generate_block();
+
+   const size_t limit_orders = static_cast<size_t>( expiration_sweep_type::limit_orders );
+   const auto& sweeps = db.get_expiration_sweeps();
+
+   // nothing expires, the sweep is skipped
+   uint64_t runs = sweeps[limit_orders].runs;
+   uint64_t skips = sweeps[limit_orders].skips;
+   generate_block();
+   BOOST_CHECK_EQUAL( sweeps[limit_orders].runs, runs );
+   BOOST_CHECK_EQUAL( sweeps[limit_orders].skips, skips + 1 );
+   BOOST_REQUIRE( sweeps[limit_orders].next_due.valid() );
+   BOOST_CHECK( *sweeps[limit_orders].next_due == fc::time_point_sec::maximum() );
+
+   // the block with the new order runs the sweep once to learn the expiration
+   const auto expiration = db.head_block_time() + fc::seconds(60);
+   const auto order_id = create_sell_order( nathan_id, asset(100), test.amount(100), expiration )->id;
+   runs = sweeps[limit_orders].runs;
+   generate_block();
+   BOOST_CHECK_EQUAL( sweeps[limit_orders].runs, runs + 1 );
+   BOOST_REQUIRE( sweeps[limit_orders].next_due.valid() );
+   BOOST_CHECK( *sweeps[limit_orders].next_due == expiration );
+
+   // then it is skipped until the order expires
+   runs = sweeps[limit_orders].runs;
+   skips = sweeps[limit_orders].skips;
+   generate_block();
+   BOOST_CHECK_EQUAL( sweeps[limit_orders].runs, runs );
+   BOOST_CHECK_EQUAL( sweeps[limit_orders].skips, skips + 1 );
+   BOOST_CHECK( db.find_object( order_id ) != nullptr );
+
+   generate_blocks( expiration );
+   BOOST_CHECK_EQUAL( sweeps[limit_orders].runs, runs + 1 );
+   BOOST_CHECK( db.find_object( order_id ) == nullptr );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_FIXTURE_TEST_CASE( double_sign_check, database_fixture )
 { try {
    generate_block();
@@ -1105,6 +1949,99 @@ BOOST_FIXTURE_TEST_CASE( pop_block_twice, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( head_state_test, database_fixture )
+{
+   try
+   {
+      const auto check_head_state = [this]() {
+         const auto state = db.get_head_state();
+         const dynamic_global_property_object& dgp = db.get_dynamic_global_properties();
+         BOOST_CHECK_EQUAL( state->block_num, db.head_block_num() );
+         BOOST_CHECK( state->block_id == db.head_block_id() );
+         BOOST_CHECK( state->time == db.head_block_time() );
+         BOOST_CHECK_EQUAL( state->last_irreversible_block_num, dgp.last_irreversible_block_num );
+         BOOST_CHECK( state->current_witness == dgp.current_witness );
+         BOOST_CHECK_EQUAL( state->active_witness_count, db.get_global_properties().active_witnesses.size() );
+         BOOST_CHECK_EQUAL( state->witness_participation, db.witness_participation_rate() );
+         BOOST_CHECK( state->next_maintenance_time == dgp.next_maintenance_time );
+      };
+      check_head_state();
+
+      generate_blocks( 5 );
+      check_head_state();
+
+      // a state which was read once does not change with the chain
+      const auto old_state = db.get_head_state();
+      const uint32_t old_num = old_state->block_num;
+      generate_block();
+      BOOST_CHECK_EQUAL( old_state->block_num, old_num );
+      BOOST_CHECK_EQUAL( db.get_head_state()->block_num, old_num + 1 );
+
+      db.pop_block();
+      check_head_state();
+      BOOST_CHECK( db.get_head_state()->block_id == old_state->block_id );
+   } catch(const fc::exception& e) {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( block_tracer_test, database_fixture )
+{
+   try
+   {
+      graphene::net::block_tracer tracer( 2 );
+      std::vector<block_id_type> ids;
+      for( int i = 0; i < 3; ++i )
+         ids.push_back( generate_block().id() );
+
+      const fc::time_point start = fc::time_point::now();
+      tracer.add_span( ids[0], "read_message", start, start + fc::microseconds(10) );
+      tracer.add_span( ids[1], "read_message", start, start + fc::microseconds(20) );
+      tracer.add_span( ids[0], "push_block", start + fc::microseconds(10), start + fc::microseconds(50) );
+      // a span which ended before it started is recorded with no duration
+      tracer.add_span( ids[1], "push_block", start, start - fc::microseconds(5) );
+
+      auto traces = tracer.get_traces();
+      BOOST_REQUIRE_EQUAL( traces.size(), 2u );
+      BOOST_CHECK( traces[0].block_id == ids[1] );
+      BOOST_CHECK_EQUAL( traces[0].block_num, block_header::num_from_id( ids[1] ) );
+      BOOST_REQUIRE_EQUAL( traces[1].spans.size(), 2u );
+      BOOST_CHECK_EQUAL( traces[1].spans[1].stage, "push_block" );
+      BOOST_CHECK_EQUAL( traces[1].spans[1].duration_microseconds, 40u );
+      BOOST_CHECK_EQUAL( traces[0].spans[1].duration_microseconds, 0u );
+
+      // the oldest block is dropped for a new one
+      {
+         graphene::net::block_trace_scope scope( &tracer, ids[2], "broadcast" );
+      }
+      traces = tracer.get_traces();
+      BOOST_REQUIRE_EQUAL( traces.size(), 2u );
+      BOOST_CHECK( traces[0].block_id == ids[2] );
+      BOOST_CHECK( traces[1].block_id == ids[1] );
+
+      // oldest block first, one complete event per span
+      const fc::variant_object chrome = tracer.get_chrome_trace();
+      const fc::variants events = chrome["traceEvents"].get_array();
+      BOOST_REQUIRE_EQUAL( events.size(), 3u );
+      BOOST_CHECK_EQUAL( events[0]["name"].as_string(), "read_message" );
+      BOOST_CHECK_EQUAL( events[0]["ph"].as_string(), "X" );
+      BOOST_CHECK_EQUAL( events[0]["ts"].as_int64(), start.time_since_epoch().count() );
+      BOOST_CHECK_EQUAL( events[0]["dur"].as_uint64(), 20u );
+      BOOST_CHECK_EQUAL( events[0]["tid"].as_uint64(), block_header::num_from_id( ids[1] ) );
+      BOOST_CHECK_EQUAL( events[2]["name"].as_string(), "broadcast" );
+
+      // a disabled scope does nothing
+      {
+         graphene::net::block_trace_scope scope( nullptr, ids[0], "broadcast" );
+      }
+      BOOST_CHECK( graphene::net::block_tracer( 0 ).get_traces().empty() );
+   } catch(const fc::exception& e) {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
 BOOST_FIXTURE_TEST_CASE( rsf_missed_blocks, database_fixture )
 {
    try
@@ -1822,6 +2759,45 @@ BOOST_FIXTURE_TEST_CASE( tapos_rollover, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( tapos_after_pop_block, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   transfer( committee_account, alice_id, asset(10000) );
+   generate_block();
+
+   transfer_operation xfer_op;
+   xfer_op.from = alice_id;
+   xfer_op.to = bob_id;
+   xfer_op.amount = asset(1000);
+
+   // Reference a block which will be popped
+   const block_id_type popped_id = generate_block().id();
+   signed_transaction popped_ref_tx;
+   popped_ref_tx.operations.push_back( xfer_op );
+   set_expiration( db, popped_ref_tx );
+   popped_ref_tx.set_reference_block( popped_id );
+   sign( popped_ref_tx, alice_private_key );
+
+   db.pop_block();
+   db.clear_pending();
+
+   // Produce a different block at the same height by missing a slot
+   const block_id_type replacement_id = generate_block( ~0, init_account_priv_key, 1 ).id();
+   BOOST_REQUIRE( replacement_id != popped_id );
+   BOOST_CHECK_EQUAL( block_header::num_from_id( replacement_id ), block_header::num_from_id( popped_id ) );
+
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, popped_ref_tx, 0 ), fc::exception );
+
+   signed_transaction replacement_ref_tx;
+   replacement_ref_tx.operations.push_back( xfer_op );
+   set_expiration( db, replacement_ref_tx );
+   replacement_ref_tx.set_reference_block( replacement_id );
+   sign( replacement_ref_tx, alice_private_key );
+   PUSH_TX( db, replacement_ref_tx, 0 );
+   generate_block();
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 1000 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_FIXTURE_TEST_CASE( temp_account_balance, database_fixture )
 { try {
    ACTORS( (alice) );
@@ -1949,4 +2925,88 @@ BOOST_FIXTURE_TEST_CASE( block_size_test, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( precompute_rejects_bad_merkle_root, database_fixture )
+{ try {
+   ACTORS((alice)(bob));
+   transfer(committee_account, alice_id, asset(10000000));
+   generate_block();
+
+   signed_transaction xfer_tx;
+   transfer_operation xfer_op;
+   xfer_op.from = alice_id;
+   xfer_op.to = bob_id;
+   xfer_op.amount = asset(100);
+   xfer_tx.operations.push_back( xfer_op );
+   set_expiration( db, xfer_tx );
+   sign( xfer_tx, alice_private_key );
+   auto processed_tx = PUSH_TX( db, xfer_tx, database::skip_nothing );
+   db.clear_pending();
+
+   const fc::ecc::private_key& key = generate_private_key("null_key");
+   auto make_block = [&]( const checksum_type& merkle_root ) {
+      signed_block blk;
+      blk.transactions.push_back( processed_tx );
+      blk.previous = db.head_block_id();
+      blk.timestamp = db.get_slot_time(1);
+      blk.transaction_merkle_root = merkle_root;
+      blk.witness = db.get_scheduled_witness(1);
+      blk.sign( key );
+      return blk;
+   };
+
+   // the block is rejected by the parallel stage, before the chain thread sees it
+   signed_block bad_block = make_block( checksum_type::hash( std::string("wrong") ) );
+   BOOST_CHECK_THROW( db.precompute_parallel( bad_block ).wait(), fc::exception );
+   BOOST_CHECK_EQUAL( bad_block.get_packed_size(), fc::raw::pack_size( bad_block ) );
+
+   signed_block good_block = make_block( bad_block.calculate_merkle_root() );
+   db.precompute_parallel( good_block ).wait();
+   PUSH_BLOCK( db, good_block );
+   BOOST_CHECK( db.head_block_id() == good_block.id() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( applied_operations_impacted_accounts, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice, asset( 10000 ) );
+   generate_block();
+
+   size_t operation_count = 0;
+   bool shared = true;
+   bool matches = true;
+   boost::signals2::scoped_connection connection = db.applied_block.connect( [&]( const signed_block& ) {
+      const auto& ops = db.get_applied_operations();
+      const auto& impacted = db.get_applied_operations_impacted_accounts();
+      // computed once for all callers of the block
+      shared = shared && &impacted == &db.get_applied_operations_impacted_accounts();
+      matches = matches && impacted.size() == ops.size();
+      for( size_t i = 0; matches && i < ops.size(); ++i )
+      {
+         flat_set<account_id_type> expected;
+         if( ops[i].valid() )
+         {
+            operation_get_impacted_accounts( ops[i]->op, expected,
+                                             MUST_IGNORE_CUSTOM_OP_REQD_AUTHS( db.head_block_time() ) );
+            ++operation_count;
+         }
+         matches = ( impacted[i] == expected );
+      }
+   });
+
+   transfer( alice_id, bob_id, asset( 100 ) );
+   generate_block();
+   BOOST_CHECK( shared );
+   BOOST_CHECK( matches );
+   BOOST_CHECK_GE( operation_count, 1u );
+
+   // the sets of the previous block are not reused for the operations of the next one
+   operation_count = 0;
+   generate_block();
+   BOOST_CHECK( matches );
+   transfer( bob_id, alice_id, asset( 50 ) );
+   generate_block();
+   BOOST_CHECK( matches );
+   BOOST_CHECK_GE( operation_count, 1u );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
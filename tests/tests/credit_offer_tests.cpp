@@ -1953,6 +1953,31 @@ BOOST_AUTO_TEST_CASE( credit_offer_apis_test )
 
       generate_block();
 
+      // Get the best credit offers which lend USD for EUR, the fee rates are equal
+      offers = db_api.get_best_credit_offers( "MYUSD", "MYEUR" );
+      BOOST_REQUIRE_EQUAL( offers.size(), 3u );
+      BOOST_CHECK( offers[0].id == co6_id ); // 10000 available
+      BOOST_CHECK( offers[1].id == co5_id ); // 9600 available
+      BOOST_CHECK( offers[2].id == co2_id ); // 9500 available
+
+      offers = db_api.get_best_credit_offers( "MYUSD", "MYEUR", 1 );
+      BOOST_REQUIRE_EQUAL( offers.size(), 1u );
+      BOOST_CHECK( offers[0].id == co6_id );
+
+      offers = db_api.get_best_credit_offers( "MYEUR", "1.3.0" );
+      BOOST_REQUIRE_EQUAL( offers.size(), 2u );
+      BOOST_CHECK( offers[0].id == co4_id );
+      BOOST_CHECK( offers[1].id == co3_id );
+
+      BOOST_CHECK( db_api.get_best_credit_offers( "1.3.0", "MYEUR" ).size() == 1u );
+      BOOST_CHECK( db_api.get_best_credit_offers( "MYUSD", "1.3.0" ).empty() );
+
+      // Nonexistent asset
+      BOOST_CHECK_THROW( db_api.get_best_credit_offers( "MYUSD", "NOSUCHASSET" ), fc::exception );
+
+      // Limit too large
+      BOOST_CHECK_THROW( db_api.get_best_credit_offers( "MYUSD", "MYEUR", 102 ), fc::exception );
+
       // Since all APIs are now calling the same template function,
       // no need to to test with many cases only for pagination.
       auto deals = db_api.list_credit_deals();
@@ -641,6 +641,74 @@ BOOST_AUTO_TEST_CASE(custom_auths_unsupported_operations_test) { try {
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE(custom_auths_predicate_cache_test) { try {
+   generate_blocks(HARDFORK_BSIP_40_TIME);
+   generate_blocks(5);
+   db.modify(global_property_id_type()(db), [](global_property_object& gpo) {
+      gpo.parameters.extensions.value.custom_authority_options = custom_authority_options_type();
+   });
+   set_expiration(db, trx);
+   ACTORS((alice)(bob)(charlie))
+
+   custom_authority_create_operation op;
+   op.account = alice.get_id();
+   op.auth.add_authority(bob.get_id(), 1);
+   op.auth.weight_threshold = 1;
+   op.enabled = true;
+   op.valid_to = db.head_block_time() + 1000;
+   op.operation_type = operation::tag<transfer_operation>::value;
+   auto to_index = member_index<transfer_operation>("to");
+   op.restrictions = {restriction(to_index, FUNC(eq), bob.get_id())};
+   trx.clear();
+   trx.operations = {op};
+   sign(trx, alice_private_key);
+   auto auth_id = PUSH_TX(db, trx).operation_results.front().get<object_id_type>().as<custom_authority_id_type>();
+   generate_block();
+
+   transfer_operation to_bob;
+   to_bob.from = alice.get_id();
+   to_bob.to = bob.get_id();
+   transfer_operation to_charlie = to_bob;
+   to_charlie.to = charlie.get_id();
+
+   // the predicate is compiled when the authority is created, and shared by the copies of the object
+   const restriction_predicate_function* predicate = &auth_id(db).get_predicate();
+   BOOST_CHECK(auth_id(db).get_predicate()(to_bob).success);
+   BOOST_CHECK(!auth_id(db).get_predicate()(to_charlie).success);
+   BOOST_CHECK(predicate == &custom_authority_object(auth_id(db)).get_predicate());
+
+   // updating the restrictions compiles a new predicate
+   custom_authority_update_operation uop;
+   uop.account = alice.get_id();
+   uop.authority_to_update = auth_id;
+   uop.restrictions_to_remove = {0};
+   uop.restrictions_to_add = {restriction(to_index, FUNC(eq), charlie.get_id())};
+   trx.clear();
+   trx.operations = {uop};
+   sign(trx, alice_private_key);
+   PUSH_TX(db, trx);
+   BOOST_CHECK(!auth_id(db).get_predicate()(to_bob).success);
+   BOOST_CHECK(auth_id(db).get_predicate()(to_charlie).success);
+
+   // updates which do not change the restrictions keep the predicate
+   predicate = &auth_id(db).get_predicate();
+   custom_authority_update_operation disable;
+   disable.account = alice.get_id();
+   disable.authority_to_update = auth_id;
+   disable.new_enabled = false;
+   trx.clear();
+   trx.operations = {disable};
+   sign(trx, alice_private_key);
+   PUSH_TX(db, trx);
+   BOOST_CHECK(predicate == &auth_id(db).get_predicate());
+
+   // undoing the update restores the old predicate
+   generate_block();
+   db.pop_block();
+   BOOST_CHECK(auth_id(db).get_predicate()(to_bob).success);
+   BOOST_CHECK(!auth_id(db).get_predicate()(to_charlie).success);
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE(custom_auths) { try {
    //////
    // Initialize the test
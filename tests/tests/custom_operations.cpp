@@ -329,4 +329,64 @@ catch (fc::exception &e) {
    throw;
 } }
 
+BOOST_AUTO_TEST_CASE(custom_operations_value_store_test)
+{
+try {
+   ACTORS((nathan));
+
+   app.enable_plugin("custom_operations");
+   custom_operations_api custom_operations_api(app);
+
+   generate_block();
+
+   std::string catalog = "settings";
+   flat_map<string, optional<string>> pairs;
+   pairs["language"] = fc::json::to_string("en");
+   pairs["theme"] = fc::json::to_string("dark");
+   map_operation(pairs, false, catalog, nathan_id, nathan_private_key, db);
+   generate_block();
+
+   // only the keys are kept in memory
+   const auto& index = db.get_index_type<account_storage_index>().indices().get<by_account_catalog_key>();
+   auto itr = index.find( make_tuple( nathan_id, catalog, string("language") ) );
+   BOOST_REQUIRE( itr != index.end() );
+   BOOST_CHECK( !itr->value.valid() );
+   BOOST_CHECK_GT( itr->value_size, 0u );
+
+   // values are loaded by the API
+   auto storage_results_nathan = custom_operations_api.get_storage_info("nathan", catalog);
+   BOOST_REQUIRE_EQUAL(storage_results_nathan.size(), 2 );
+   BOOST_REQUIRE(storage_results_nathan[0].value.valid());
+   BOOST_CHECK_EQUAL(storage_results_nathan[0].value->as_string(), "en");
+   BOOST_REQUIRE(storage_results_nathan[1].value.valid());
+   BOOST_CHECK_EQUAL(storage_results_nathan[1].value->as_string(), "dark");
+
+   // replace a value and clear the other one
+   pairs.clear();
+   pairs["language"] = fc::json::to_string("es");
+   pairs["theme"];
+   map_operation(pairs, false, catalog, nathan_id, nathan_private_key, db);
+   generate_block();
+
+   storage_results_nathan = custom_operations_api.get_storage_info("nathan", catalog);
+   BOOST_REQUIRE_EQUAL(storage_results_nathan.size(), 2 );
+   BOOST_REQUIRE(storage_results_nathan[0].value.valid());
+   BOOST_CHECK_EQUAL(storage_results_nathan[0].value->as_string(), "es");
+   BOOST_CHECK(!storage_results_nathan[1].value.valid());
+   BOOST_CHECK_EQUAL(storage_results_nathan[1].value_size, 0u);
+
+   // the previous values are still referenced after the block is popped
+   db.pop_block();
+   storage_results_nathan = custom_operations_api.get_storage_info("nathan", catalog);
+   BOOST_REQUIRE_EQUAL(storage_results_nathan.size(), 2 );
+   BOOST_REQUIRE(storage_results_nathan[0].value.valid());
+   BOOST_CHECK_EQUAL(storage_results_nathan[0].value->as_string(), "en");
+   BOOST_REQUIRE(storage_results_nathan[1].value.valid());
+   BOOST_CHECK_EQUAL(storage_results_nathan[1].value->as_string(), "dark");
+}
+catch (fc::exception &e) {
+   edump((e.to_detail_string()));
+   throw;
+} }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -24,11 +24,21 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/account_operation_publisher.hpp>
+#include <graphene/app/api.hpp>
+#include <graphene/app/api_response_cache.hpp>
+#include <graphene/app/block_event_bus.hpp>
+#include <graphene/app/http_get_server.hpp>
+#include <graphene/app/order_book_cache.hpp>
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/object_notification_cache.hpp>
+#include <graphene/app/order_book_delta_publisher.hpp>
 #include <graphene/chain/hardfork.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/hex.hpp>
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -80,6 +90,59 @@ BOOST_AUTO_TEST_CASE(is_registered)
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( key_references_of_shared_keys )
+{
+   try {
+      auto shared_private_key = generate_private_key("shared");
+      public_key_type shared_public = shared_private_key.get_public_key();
+      auto dan_private_key = generate_private_key("dan");
+      public_key_type dan_public = dan_private_key.get_public_key();
+      public_key_type unregistered_public = generate_private_key("unregistered").get_public_key();
+
+      const account_id_type dan_id = create_account( "dan", shared_public ).get_id();
+      const account_id_type nathan_id = create_account( "nathan", shared_public ).get_id();
+
+      graphene::app::application_options opt = app.get_options();
+      opt.has_api_helper_indexes_plugin = true;
+      graphene::app::database_api db_api( db, &opt );
+
+      // the same key may be queried several times in one call
+      auto refs = db_api.get_key_references( { shared_public, unregistered_public, shared_public } );
+      BOOST_REQUIRE_EQUAL( refs.size(), 3u );
+      BOOST_CHECK( refs[0] == flat_set<account_id_type>( { dan_id, nathan_id } ) );
+      BOOST_CHECK( refs[1].empty() );
+      BOOST_CHECK( refs[2] == refs[0] );
+
+      auto change_keys = [&]( account_id_type account, const public_key_type& key ) {
+         account_update_operation op;
+         op.account = account;
+         op.owner = authority( 1, key, 1 );
+         op.active = authority( 1, key, 1 );
+         op.new_options = account( db ).options;
+         op.new_options->memo_key = key;
+         trx.operations.push_back( op );
+         sign( trx, shared_private_key );
+         PUSH_TX( db, trx, ~0 );
+         trx.clear();
+      };
+
+      // once a key is referenced by one account only, the remaining account is still found
+      change_keys( dan_id, dan_public );
+      refs = db_api.get_key_references( { shared_public, dan_public } );
+      BOOST_REQUIRE_EQUAL( refs.size(), 2u );
+      BOOST_CHECK( refs[0] == flat_set<account_id_type>( { nathan_id } ) );
+      BOOST_CHECK( refs[1] == flat_set<account_id_type>( { dan_id } ) );
+
+      // keys which are no longer referenced are forgotten
+      change_keys( nathan_id, dan_public );
+      BOOST_CHECK( !db_api.is_public_key_registered( (string) shared_public ) );
+      BOOST_CHECK( db_api.is_public_key_registered( (string) dan_public ) );
+      refs = db_api.get_key_references( { dan_public } );
+      BOOST_CHECK( refs[0] == flat_set<account_id_type>( { dan_id, nathan_id } ) );
+
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( get_potential_signatures_owner_and_active )
 {
    try {
@@ -758,6 +821,131 @@ BOOST_AUTO_TEST_CASE( get_required_signatures_partially_signed_or_not )
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( get_signatures_batch )
+{
+   try {
+      fc::ecc::private_key morgan_key = fc::ecc::private_key::regenerate(fc::digest("morgan_key"));
+      fc::ecc::private_key nathan_key = fc::ecc::private_key::regenerate(fc::digest("nathan_key"));
+      public_key_type pub_key_morgan( morgan_key.get_public_key() );
+      public_key_type pub_key_nathan( nathan_key.get_public_key() );
+      const account_object& morgan = create_account("morgan", morgan_key.get_public_key() );
+      const account_object& nathan = create_account("nathan", nathan_key.get_public_key() );
+      const account_id_type morgan_id = morgan.id;
+      const account_id_type nathan_id = nathan.id;
+
+      // morgan's active authority is nathan's account, so that it is visited again for every reference
+      {
+         account_update_operation op;
+         op.account = morgan_id;
+         op.active = authority( 1, nathan_id, 1 );
+         trx.operations.push_back(op);
+         sign(trx, morgan_key);
+         PUSH_TX( db, trx );
+         trx.clear();
+      }
+
+      graphene::app::database_api db_api( db, &( app.get_options() ));
+
+      vector<signed_transaction> trxs;
+      for( uint32_t i = 0; i < 5; ++i )
+      {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = ( i % 2 == 0 ) ? morgan_id : nathan_id;
+         op.to = account_id_type();
+         op.amount = asset( i + 1 );
+         tx.operations.push_back(op);
+         if( i == 3 )
+            tx.operations.push_back(op);
+         tx.set_expiration( db.head_block_time() + fc::minutes(1) );
+         if( i == 4 )
+            tx.sign( nathan_key, db.get_chain_id() );
+         trxs.push_back( tx );
+      }
+
+      flat_set<public_key_type> avail_keys;
+      avail_keys.insert( pub_key_morgan );
+      avail_keys.insert( pub_key_nathan );
+
+      vector<set<public_key_type>> required = db_api.get_required_signatures_batch( trxs, avail_keys );
+      vector<set<public_key_type>> potential = db_api.get_potential_signatures_batch( trxs );
+      BOOST_REQUIRE_EQUAL( required.size(), trxs.size() );
+      BOOST_REQUIRE_EQUAL( potential.size(), trxs.size() );
+      for( size_t i = 0; i < trxs.size(); ++i )
+      {
+         BOOST_CHECK( required[i] == db_api.get_required_signatures( trxs[i], avail_keys ) );
+         BOOST_CHECK( potential[i] == db_api.get_potential_signatures( trxs[i] ) );
+      }
+      // nathan's key is needed for all but the signed transaction
+      BOOST_CHECK( required[0].size() == 1 && required[0].count( pub_key_nathan ) == 1 );
+      BOOST_CHECK( required[4].empty() );
+      BOOST_CHECK( potential[0].count( pub_key_nathan ) == 1 );
+      BOOST_CHECK( potential[0].count( pub_key_morgan ) == 1 );
+
+      BOOST_CHECK( db_api.get_required_signatures_batch( {}, avail_keys ).empty() );
+
+      const auto limit = app.get_options().api_limit_get_signatures_batch;
+      vector<signed_transaction> too_many( limit + 1, trxs.front() );
+      GRAPHENE_CHECK_THROW( db_api.get_required_signatures_batch( too_many, avail_keys ), fc::exception );
+      GRAPHENE_CHECK_THROW( db_api.get_potential_signatures_batch( too_many ), fc::exception );
+      too_many.pop_back();
+      BOOST_CHECK_EQUAL( db_api.get_potential_signatures_batch( too_many ).size(), limit );
+
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( get_objects_mixed_types_and_fields )
+{
+   try {
+      ACTORS( (alice)(bob) );
+      const asset_id_type usd_id = create_user_issued_asset( "USD" ).get_id();
+
+      graphene::app::database_api db_api( db, &( app.get_options() ));
+
+      // unsorted, mixed types, duplicates and a missing object
+      vector<object_id_type> ids = { bob_id, dynamic_global_property_id_type(), usd_id, alice_id,
+                                     account_id_type( 99999 ), asset_id_type(), bob_id };
+
+      fc::variants objects = db_api.get_objects( ids, false );
+      BOOST_REQUIRE_EQUAL( objects.size(), ids.size() );
+      for( size_t i = 0; i < ids.size(); ++i )
+      {
+         if( i == 4 )
+            BOOST_CHECK( objects[i].is_null() );
+         else
+            BOOST_CHECK( objects[i]["id"].as<object_id_type>( 1 ) == ids[i] );
+      }
+      BOOST_CHECK_EQUAL( objects[0]["name"].as_string(), "bob" );
+      BOOST_CHECK_EQUAL( objects[2]["symbol"].as_string(), "USD" );
+      BOOST_CHECK_EQUAL( objects[3]["name"].as_string(), "alice" );
+
+      fc::variants fields = db_api.get_object_fields( ids, { "id", "name" } );
+      BOOST_REQUIRE_EQUAL( fields.size(), ids.size() );
+      BOOST_CHECK( fields[4].is_null() );
+      BOOST_CHECK_EQUAL( fields[0].get_object().size(), 2u );
+      BOOST_CHECK_EQUAL( fields[0]["name"].as_string(), "bob" );
+      BOOST_CHECK( fields[0]["id"].as<account_id_type>( 1 ) == bob_id );
+      // assets and the global properties have no name
+      BOOST_CHECK_EQUAL( fields[1].get_object().size(), 1u );
+      BOOST_CHECK_EQUAL( fields[2].get_object().size(), 1u );
+
+      // no field selected returns the whole objects
+      fc::variants all_fields = db_api.get_object_fields( ids, {} );
+      for( size_t i = 0; i < ids.size(); ++i )
+         BOOST_CHECK( fc::json::to_string( all_fields[i] ) == fc::json::to_string( objects[i] ) );
+
+      // an unknown index is rejected as by get_objects
+      vector<object_id_type> bad_ids = { alice_id, object_id_type( 1, 200, 0 ) };
+      GRAPHENE_CHECK_THROW( db_api.get_objects( bad_ids, false ), fc::exception );
+      GRAPHENE_CHECK_THROW( db_api.get_object_fields( bad_ids, {} ), fc::exception );
+
+      const auto limit = app.get_options().api_limit_get_object_fields;
+      vector<object_id_type> too_many( limit + 1, alice_id );
+      GRAPHENE_CHECK_THROW( db_api.get_object_fields( too_many, {} ), fc::exception );
+
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( subscription_key_collision_test )
 {
    object_id_type uia_object_id = create_user_issued_asset( "UIATEST" ).get_id();
@@ -791,6 +979,46 @@ BOOST_AUTO_TEST_CASE( subscription_key_collision_test )
    BOOST_CHECK_EQUAL( objects_changed, 0 ); // UIATEST did not change in this block, so no notification
 }
 
+BOOST_AUTO_TEST_CASE( batched_notifications_test )
+{ try {
+   ACTORS( (alice) );
+   const asset_id_type uia_id = create_user_issued_asset( "UIATEST" ).get_id();
+   transfer( committee_account, alice_id, asset( 10000 ) );
+   const limit_order_id_type first_order_id =
+         create_sell_order( alice_id, asset( 100 ), asset( 100, uia_id ) )->get_id();
+   generate_block();
+
+   graphene::app::application_options unbatched_options = app.get_options();
+   unbatched_options.enable_subscribe_to_all = true;
+   graphene::app::application_options batched_options = unbatched_options;
+   batched_options.batch_notifications = true;
+
+   uint32_t unbatched_calls = 0;
+   uint32_t batched_calls = 0;
+   size_t unbatched_updates = 0;
+   size_t batched_updates = 0;
+   graphene::app::database_api unbatched_api( db, &unbatched_options );
+   graphene::app::database_api batched_api( db, &batched_options );
+   unbatched_api.set_subscribe_callback( [&]( const variant& v ) {
+      ++unbatched_calls;
+      unbatched_updates += v.get_array().size();
+   }, true );
+   batched_api.set_subscribe_callback( [&]( const variant& v ) {
+      ++batched_calls;
+      batched_updates += v.get_array().size();
+   }, true );
+
+   // a block which creates and removes objects
+   create_sell_order( alice_id, asset( 200 ), asset( 100, uia_id ) );
+   cancel_limit_order( first_order_id( db ) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+
+   BOOST_CHECK_GT( unbatched_calls, 1u );
+   BOOST_CHECK_EQUAL( batched_calls, 1u );
+   BOOST_CHECK_EQUAL( batched_updates, unbatched_updates );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( subscription_notification_test )
 {
    try {
@@ -1617,6 +1845,33 @@ BOOST_AUTO_TEST_CASE( get_assets_by_issuer ) {
    }
 }
 
+BOOST_AUTO_TEST_CASE( get_witness_schedule ) {
+   try {
+      graphene::app::database_api db_api(db, &(this->app.get_options()));
+
+      generate_blocks( 5 );
+
+      const auto round_size = db.get_witness_schedule_object().current_shuffled_witnesses.size();
+      auto slots = db_api.get_witness_schedule( round_size );
+
+      BOOST_REQUIRE_EQUAL( slots.size(), round_size );
+      for( uint32_t i = 0; i < slots.size(); ++i )
+      {
+         BOOST_CHECK_EQUAL( slots[i].slot_num, i + 1 );
+         BOOST_CHECK( slots[i].time == db.get_slot_time( i + 1 ) );
+         BOOST_CHECK( slots[i].witness == db.get_scheduled_witness( i + 1 ) );
+         BOOST_CHECK_EQUAL( db.get_slot_at_time( slots[i].time ), i + 1 );
+      }
+
+      BOOST_CHECK( db_api.get_witness_schedule( 0 ).empty() );
+      GRAPHENE_CHECK_THROW( db_api.get_witness_schedule( round_size + 1 ), fc::exception );
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( get_call_orders_by_account ) {
 
    try {
@@ -1662,6 +1917,70 @@ BOOST_AUTO_TEST_CASE( get_call_orders_by_account ) {
    }
 }
 
+BOOST_AUTO_TEST_CASE( get_margin_call_risk )
+{ try {
+   ACTORS( (alice)(bob)(carol)(feedproducer) );
+
+   graphene::app::application_options opt = app.get_options();
+   opt.has_api_helper_indexes_plugin = true;
+   graphene::app::database_api db_api( db, &opt );
+
+   const auto& usd = create_bitasset( "USD", feedproducer_id );
+   const auto& core = asset_id_type()( db );
+   const asset_id_type usd_id = usd.get_id();
+   for( const account_id_type& id : { alice_id, bob_id, carol_id } )
+      transfer( committee_account, id, asset( 1000000 ) );
+   update_feed_producers( usd, { feedproducer_id } );
+
+   price_feed current_feed;
+   current_feed.maintenance_collateral_ratio = 1750;
+   current_feed.maximum_short_squeeze_ratio = 1100;
+   current_feed.settlement_price = usd.amount(1) / core.amount(5);
+   publish_feed( usd, feedproducer, current_feed );
+
+   // collateral ratios 3, 2 and 1.8
+   borrow( alice, usd.amount(1000), asset(15000) );
+   const call_order_id_type bob_call = borrow( bob, usd.amount(1000), asset(10000) )->get_id();
+   const call_order_id_type carol_call = borrow( carol, usd.amount(1000), asset(9000) )->get_id();
+
+   // nothing is margin called at the current feed
+   auto risk = db_api.get_margin_call_risk( "USD", {} );
+   BOOST_CHECK( risk.settlement_price == current_feed.settlement_price );
+   BOOST_CHECK_EQUAL( risk.position_count, 0u );
+   BOOST_CHECK( risk.positions.empty() );
+
+   // at 5.5 CORE per USD the position of carol falls below the MCR
+   risk = db_api.get_margin_call_risk( "USD", price( usd.amount(2), core.amount(11) ) );
+   BOOST_CHECK_EQUAL( risk.position_count, 1u );
+   BOOST_CHECK_EQUAL( risk.total_debt.value, 1000 );
+   BOOST_CHECK_EQUAL( risk.total_collateral.value, 9000 );
+   BOOST_REQUIRE_EQUAL( risk.positions.size(), 1u );
+   BOOST_CHECK( risk.positions[0].id == carol_call );
+
+   // at 8 CORE per USD the position of bob follows, the totals are not limited
+   risk = db_api.get_margin_call_risk( std::string( object_id_type( usd_id ) ),
+                                       price( usd.amount(1), core.amount(8) ), 1 );
+   BOOST_CHECK_EQUAL( risk.position_count, 2u );
+   BOOST_CHECK_EQUAL( risk.total_debt.value, 2000 );
+   BOOST_CHECK_EQUAL( risk.total_collateral.value, 19000 );
+   BOOST_REQUIRE_EQUAL( risk.positions.size(), 1u );
+   BOOST_CHECK( risk.positions[0].id == carol_call );
+
+   // the buckets follow updates of the positions
+   borrow( carol, usd.amount(0), asset(11000) );
+   risk = db_api.get_margin_call_risk( "USD", price( usd.amount(1), core.amount(8) ) );
+   BOOST_CHECK_EQUAL( risk.position_count, 1u );
+   BOOST_CHECK_EQUAL( risk.total_collateral.value, 10000 );
+   BOOST_REQUIRE_EQUAL( risk.positions.size(), 1u );
+   BOOST_CHECK( risk.positions[0].id == bob_call );
+
+   GRAPHENE_CHECK_THROW( db_api.get_margin_call_risk( "USD", core.amount(8) / usd.amount(1) ),
+                         fc::exception );
+   GRAPHENE_CHECK_THROW( db_api.get_margin_call_risk( GRAPHENE_SYMBOL, {} ), fc::exception );
+   GRAPHENE_CHECK_THROW( db_api.get_margin_call_risk( "USD", {}, 1000000 ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( get_settle_orders_by_account ) {
    try {
       ACTORS((creator)(settler)(caller)(feedproducer));
@@ -1844,6 +2163,45 @@ BOOST_AUTO_TEST_CASE( asset_in_collateral )
 } FC_LOG_AND_RETHROW() }
 
 
+BOOST_AUTO_TEST_CASE( get_tickers )
+{ try {
+
+   app.enable_plugin("market_history");
+   graphene::app::application_options opt=app.get_options();
+   opt.has_market_history_plugin = true;
+   opt.api_limit_get_tickers = 2;
+   graphene::app::database_api db_api( db, &opt);
+
+   ACTORS((bob)(alice));
+
+   const auto& eur = create_user_issued_asset("EUR");
+   const auto& usd = create_user_issued_asset("USD");
+   create_user_issued_asset("GBP");
+
+   issue_uia( bob_id, usd.amount(1000000) );
+   issue_uia( alice_id, eur.amount(1000000) );
+
+   create_sell_order(bob, usd.amount(200), eur.amount(210));
+   create_sell_order(alice, eur.amount(210), usd.amount(200));
+
+   generate_block();
+
+   auto tickers = db_api.get_tickers( { { "EUR", "USD" }, { "USD", "GBP" } } );
+   BOOST_REQUIRE_EQUAL( 2u, tickers.size() );
+   const auto ticker = db_api.get_ticker( "EUR", "USD" );
+   BOOST_CHECK_EQUAL( ticker.latest, tickers[0].latest );
+   BOOST_CHECK_EQUAL( ticker.base_volume, tickers[0].base_volume );
+   BOOST_CHECK_EQUAL( ticker.quote_volume, tickers[0].quote_volume );
+   BOOST_CHECK_EQUAL( "USD", tickers[1].base );
+   BOOST_CHECK_EQUAL( "GBP", tickers[1].quote );
+   BOOST_CHECK_EQUAL( "0", tickers[1].base_volume );
+
+   GRAPHENE_CHECK_THROW( db_api.get_tickers( { { "EUR", "USD" }, { "USD", "GBP" }, { "EUR", "GBP" } } ),
+                         fc::exception );
+   GRAPHENE_CHECK_THROW( db_api.get_tickers( { { "EUR", "NOSUCHASSET" } } ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( get_trade_history )
 { try {
 
@@ -1910,4 +2268,834 @@ BOOST_AUTO_TEST_CASE( get_trade_history )
 } FC_LOG_AND_RETHROW() }
 
 
+BOOST_AUTO_TEST_CASE( api_read_threads_test )
+{ try {
+   ACTORS( (alice) );
+   generate_block();
+
+   const graphene::app::application_options serial_opt = app.get_options();
+   graphene::app::database_api serial_api( db, &serial_opt );
+
+   graphene::app::application_options opt = app.get_options();
+
+   opt.api_read_threads.push_back( std::make_shared<fc::thread>( "api_read_test_0" ) );
+   opt.api_read_threads.push_back( std::make_shared<fc::thread>( "api_read_test_1" ) );
+   opt.api_read_metrics = std::make_shared<graphene::app::api_call_metrics>();
+   graphene::app::database_api concurrent_api( db, &opt );
+
+   vector<string> names = { "alice", "committee-account" };
+   for( int i = 0; i < 4; ++i )
+   {
+      auto serial = serial_api.get_full_accounts( names, false );
+      auto concurrent = concurrent_api.get_full_accounts( names, false );
+      BOOST_REQUIRE_EQUAL( serial.size(), concurrent.size() );
+      BOOST_CHECK( concurrent.at( "alice" ).account.id == alice_id );
+      BOOST_CHECK( concurrent.at( "alice" ).statistics.id == serial.at( "alice" ).statistics.id );
+      BOOST_CHECK_EQUAL( concurrent_api.list_assets( "", 10 ).size(), serial_api.list_assets( "", 10 ).size() );
+
+      // the read locks are released, so blocks can still be applied
+      generate_block();
+   }
+
+   // errors are reported to the caller
+   BOOST_CHECK_THROW( concurrent_api.list_assets( "", 1000000 ), fc::exception );
+
+   const auto metrics = concurrent_api.get_api_read_metrics();
+   BOOST_REQUIRE_EQUAL( metrics.size(), 2u );
+   BOOST_CHECK_EQUAL( metrics[0].method, "get_full_accounts" );
+   BOOST_CHECK_EQUAL( metrics[0].completed, 4u );
+   BOOST_CHECK_EQUAL( metrics[1].method, "list_assets" );
+   BOOST_CHECK_EQUAL( metrics[1].completed, 5u );
+   for( const auto& m : metrics )
+   {
+      BOOST_CHECK_EQUAL( m.queued, 0u );
+      BOOST_CHECK_EQUAL( m.running, 0u );
+   }
+   BOOST_CHECK( serial_api.get_api_read_metrics().empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( api_response_cache_test )
+{ try {
+   create_user_issued_asset( "CNY" );
+
+   graphene::app::application_options opt = app.get_options();
+   opt.response_cache = std::make_shared<graphene::app::api_response_cache>( db, 2, 2 );
+   graphene::app::database_api db_api( db, &opt );
+
+   generate_block();
+   BOOST_CHECK_EQUAL( opt.response_cache->size(), 0u );
+
+   const uint32_t head_num = db.head_block_num();
+   BOOST_CHECK_EQUAL( db_api.get_dynamic_global_properties().head_block_number, head_num );
+   BOOST_CHECK_EQUAL( db_api.get_dynamic_global_properties().head_block_number, head_num );
+   BOOST_CHECK_EQUAL( opt.response_cache->size(), 1u );
+
+   // different parameters are cached separately, until the cache is full
+   BOOST_CHECK_EQUAL( db_api.get_order_book( GRAPHENE_SYMBOL, "CNY", 10 ).base, GRAPHENE_SYMBOL );
+   BOOST_CHECK_THROW( db_api.get_order_book( GRAPHENE_SYMBOL, "CNY", 1000 ), fc::exception );
+   BOOST_CHECK_EQUAL( db_api.get_config().size(), db_api.get_config().size() );
+   BOOST_CHECK_EQUAL( opt.response_cache->size(), 2u );
+
+   // a new block empties the cache
+   generate_block();
+   BOOST_CHECK_EQUAL( opt.response_cache->size(), 0u );
+   BOOST_CHECK_EQUAL( db_api.get_dynamic_global_properties().head_block_number, head_num + 1 );
+
+   // irreversible blocks are kept across blocks, reversible ones are not cached
+   const uint32_t lib_num = db.get_dynamic_global_properties().last_irreversible_block_num;
+   const auto check_lib_block = [&]() {
+      const auto cached = db_api.get_block( lib_num );
+      const auto stored = db.fetch_block_by_number( lib_num );
+      BOOST_REQUIRE_EQUAL( cached.valid(), stored.valid() );
+      if( stored.valid() )
+         BOOST_CHECK( cached->id() == stored->id() );
+   };
+   check_lib_block();
+   BOOST_CHECK( db_api.get_block( db.head_block_num() ).valid() );
+   BOOST_CHECK_EQUAL( opt.response_cache->immutable_size(), 1u );
+   generate_block();
+   check_lib_block();
+   BOOST_CHECK_EQUAL( opt.response_cache->immutable_size(), 1u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( http_get_server_test )
+{ try {
+   generate_blocks( 30 );
+   const uint32_t lib_num = db.get_dynamic_global_properties().last_irreversible_block_num;
+   BOOST_REQUIRE_GT( lib_num, 0u );
+   BOOST_REQUIRE_GT( db.head_block_num(), lib_num );
+
+   graphene::app::api_response_cache cache( db, 10, 10 );
+   graphene::app::http_get_server server( app, &cache );
+   const auto header_of = []( const graphene::app::http_get_server::response& r, const std::string& name ) {
+      for( const auto& header : r.headers )
+         if( header.first == name )
+            return header.second;
+      return std::string();
+   };
+
+   const std::string lib_path = "/block/" + std::to_string( lib_num );
+   const auto found = server.handle_get( lib_path, "" );
+   BOOST_REQUIRE_EQUAL( found.status, 200 );
+   const auto block = fc::json::from_string( found.body ).as<signed_block>( GRAPHENE_MAX_NESTED_OBJECTS );
+   BOOST_CHECK( block.id() == db.fetch_block_by_number( lib_num )->id() );
+   const std::string etag = header_of( found, "ETag" );
+   BOOST_CHECK( !etag.empty() );
+   BOOST_CHECK_EQUAL( header_of( found, "Cache-Control" ), "public, max-age=31536000, immutable" );
+   BOOST_CHECK_EQUAL( cache.immutable_size(), 1u );
+
+   // the body is served from the cache, a matching ETag gets an empty response
+   BOOST_CHECK_EQUAL( server.handle_get( lib_path + "?x=1", "" ).body, found.body );
+   const auto not_modified = server.handle_get( lib_path, "W/\"other\", " + etag );
+   BOOST_CHECK_EQUAL( not_modified.status, 304 );
+   BOOST_CHECK( not_modified.body.empty() );
+   BOOST_CHECK_EQUAL( header_of( not_modified, "ETag" ), etag );
+   BOOST_CHECK_EQUAL( server.handle_get( lib_path, "\"other\"" ).status, 200 );
+   BOOST_CHECK_EQUAL( cache.immutable_size(), 1u );
+
+   const auto header = server.handle_get( "/block_header/" + std::to_string( lib_num ), "" );
+   BOOST_REQUIRE_EQUAL( header.status, 200 );
+   BOOST_CHECK( fc::json::from_string( header.body ).as<block_header>( GRAPHENE_MAX_NESTED_OBJECTS ).previous
+                == block.previous );
+
+   // reversible blocks and unknown paths are not served, and the responses must not be cached
+   for( const std::string path : { "/block/" + std::to_string( db.head_block_num() ), std::string( "/block/0" ),
+                                   std::string( "/block/x1" ), std::string( "/blocks/1" ), std::string( "/" ) } )
+   {
+      const auto missing = server.handle_get( path, "" );
+      BOOST_CHECK_EQUAL( missing.status, 404 );
+      BOOST_CHECK_EQUAL( header_of( missing, "Cache-Control" ), "no-store" );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( search_accounts_and_assets )
+{ try {
+   ACTORS( (alice)(alicia)(malice)(bob) );
+   create_user_issued_asset( "ALICE" );
+   create_user_issued_asset( "MALICECOIN" );
+   create_user_issued_asset( "BOB" );
+   create_account( "abcxbcd" );
+   generate_block();
+
+   graphene::app::database_api db_api( db, &( app.get_options() ) );
+
+   // prefixes, ignoring case
+   auto accounts = db_api.search_accounts( "Ali", 10 );
+   BOOST_REQUIRE_EQUAL( accounts.size(), 2u );
+   BOOST_CHECK( accounts.begin()->second == alice_id );
+   BOOST_CHECK( accounts.rbegin()->second == alicia_id );
+   BOOST_CHECK_EQUAL( db_api.search_accounts( "ali", 1 ).size(), 1u );
+   BOOST_CHECK( db_api.search_accounts( "alx", 10 ).empty() );
+
+   auto assets = db_api.search_assets( "ali", 10 );
+   BOOST_REQUIRE_EQUAL( assets.size(), 1u );
+   BOOST_CHECK_EQUAL( assets[0].symbol, "ALICE" );
+
+   // substrings
+   accounts = db_api.search_accounts( "lic", 10, true );
+   BOOST_REQUIRE_EQUAL( accounts.size(), 3u );
+   BOOST_CHECK( accounts.find( "malice" ) != accounts.end() );
+   accounts = db_api.search_accounts( "lice", 10, true );
+   BOOST_REQUIRE_EQUAL( accounts.size(), 2u );
+   BOOST_CHECK( accounts.find( "alicia" ) == accounts.end() );
+   // the oldest matching accounts
+   accounts = db_api.search_accounts( "lic", 2, true );
+   BOOST_REQUIRE_EQUAL( accounts.size(), 2u );
+   BOOST_CHECK( accounts.find( "malice" ) == accounts.end() );
+   BOOST_CHECK( db_api.search_accounts( "xyz", 10, true ).empty() );
+   // the trigrams of the text are in the name, but not the text
+   BOOST_CHECK( db_api.search_accounts( "abcd", 10, true ).empty() );
+   BOOST_CHECK_EQUAL( db_api.search_accounts( "xbcd", 10, true ).size(), 1u );
+
+   assets = db_api.search_assets( "lice", 10, true );
+   BOOST_REQUIRE_EQUAL( assets.size(), 2u );
+   BOOST_CHECK_EQUAL( assets[0].symbol, "ALICE" );
+   BOOST_CHECK_EQUAL( assets[1].symbol, "MALICECOIN" );
+
+   GRAPHENE_CHECK_THROW( db_api.search_accounts( "li", 10, true ), fc::exception );
+   GRAPHENE_CHECK_THROW( db_api.search_accounts( "ali", 1001 ), fc::exception );
+   GRAPHENE_CHECK_THROW( db_api.search_assets( "ali", 102 ), fc::exception );
+
+   // created and removed accounts
+   const account_id_type carolice_id = create_account( "carolice" ).get_id();
+   BOOST_CHECK_EQUAL( db_api.search_accounts( "lice", 10, true ).size(), 3u );
+   db.clear_pending();
+   BOOST_CHECK( !db.find( carolice_id ) );
+   BOOST_CHECK_EQUAL( db_api.search_accounts( "lice", 10, true ).size(), 2u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( order_book_cache_test )
+{ try {
+   ACTORS( (seller)(buyer) );
+   const auto& cny = create_user_issued_asset( "CNY" );
+   const auto& core = asset_id_type()(db);
+   issue_uia( buyer_id, cny.amount(100000) );
+   transfer( committee_account, seller_id, asset(100000) );
+
+   graphene::app::application_options opt = app.get_options();
+   opt.order_books = std::make_shared<graphene::app::order_book_cache>( 1 );
+   graphene::app::database_api db_api( db, &opt );
+   graphene::app::application_options uncached_opt = app.get_options();
+   uncached_opt.order_books.reset();
+   graphene::app::database_api uncached_api( db, &uncached_opt );
+
+   const auto check_books = [&]( const string& base, const string& quote, unsigned limit ) {
+      const auto cached = db_api.get_order_book( base, quote, limit );
+      const auto computed = uncached_api.get_order_book( base, quote, limit );
+      BOOST_CHECK_EQUAL( cached.base, base );
+      BOOST_CHECK_EQUAL( cached.quote, quote );
+      BOOST_CHECK_EQUAL( fc::json::to_string( cached ), fc::json::to_string( computed ) );
+      return cached;
+   };
+
+   BOOST_CHECK( check_books( GRAPHENE_SYMBOL, "CNY", 10 ).bids.empty() );
+   BOOST_CHECK_EQUAL( opt.order_books->size(), 1u );
+
+   for( int i = 0; i < 5; ++i )
+   {
+      BOOST_CHECK( create_sell_order( seller_id, core.amount(100), cny.amount(250 + i) ) );
+      BOOST_CHECK( create_sell_order( buyer_id, cny.amount(200 + i), core.amount(100) ) );
+   }
+
+   // a cached book is recomputed when an order of its market changes, even without a new block
+   auto book = check_books( GRAPHENE_SYMBOL, "CNY", 10 );
+   BOOST_CHECK_EQUAL( book.bids.size(), 5u );
+   BOOST_CHECK_EQUAL( book.asks.size(), 5u );
+   // smaller limits are served from the same book
+   book = check_books( GRAPHENE_SYMBOL, "CNY", 2 );
+   BOOST_CHECK_EQUAL( book.bids.size(), 2u );
+   BOOST_CHECK_EQUAL( book.asks.size(), 2u );
+
+   const limit_order_object* order = create_sell_order( seller_id, core.amount(100), cny.amount(240) );
+   BOOST_REQUIRE( order );
+   BOOST_CHECK_EQUAL( check_books( GRAPHENE_SYMBOL, "CNY", 10 ).bids.size(), 6u );
+   cancel_limit_order( *order );
+   BOOST_CHECK_EQUAL( check_books( GRAPHENE_SYMBOL, "CNY", 10 ).bids.size(), 5u );
+
+   // the other direction of the market is cached separately, the oldest book is dropped
+   book = check_books( "CNY", GRAPHENE_SYMBOL, 10 );
+   BOOST_CHECK_EQUAL( book.bids.size(), 5u );
+   BOOST_CHECK_EQUAL( opt.order_books->size(), 1u );
+
+   // undone changes are seen as well
+   generate_block();
+   const limit_order_id_type id = create_sell_order( seller_id, core.amount(100), cny.amount(230) )->get_id();
+   BOOST_CHECK_EQUAL( check_books( "CNY", GRAPHENE_SYMBOL, 10 ).asks.size(), 6u );
+   db.clear_pending();
+   BOOST_CHECK( !db.find( id ) );
+   BOOST_CHECK_EQUAL( check_books( "CNY", GRAPHENE_SYMBOL, 10 ).asks.size(), 5u );
+
+   BOOST_CHECK_THROW( db_api.get_order_book( GRAPHENE_SYMBOL, "CNY", 1000 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( get_packed_blocks_test )
+{ try {
+   generate_blocks( 5 );
+   graphene::app::block_api block_api( db );
+
+   const uint32_t head_num = db.head_block_num();
+   const auto blocks = block_api.get_blocks( 1, head_num + 1 );
+   const auto packed = block_api.get_packed_blocks( 1, head_num + 1 );
+   BOOST_REQUIRE_EQUAL( packed.size(), blocks.size() );
+   for( size_t i = 0; i + 1 < packed.size(); ++i )
+   {
+      BOOST_REQUIRE( packed[i].valid() );
+      BOOST_CHECK( fc::raw::unpack<signed_block>( *packed[i] ).id() == blocks[i]->id() );
+   }
+   // the block after the head is unknown
+   BOOST_CHECK( !packed.back().valid() );
+   BOOST_CHECK_THROW( block_api.get_packed_blocks( 2, 1 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( stream_blocks_test )
+{ try {
+   generate_blocks( 5 );
+   auto block_api = std::make_shared<graphene::app::block_api>( db );
+   const uint32_t head_num = db.head_block_num();
+
+   vector<graphene::app::block_stream_batch> batches;
+   auto callback = [&batches]( const fc::variant& v ) {
+      batches.push_back( v.as<graphene::app::block_stream_batch>( GRAPHENE_MAX_NESTED_OBJECTS ) );
+   };
+
+   // blocks are only pushed while there is credit
+   const uint64_t id = block_api->stream_blocks( callback, 1, head_num + 10, 2 );
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+   size_t received = 0;
+   for( const auto& b : batches )
+      received += b.blocks.size();
+   BOOST_CHECK_EQUAL( received, 2u );
+   BOOST_REQUIRE( !batches.empty() );
+   BOOST_CHECK( !batches.back().done );
+
+   // the stream ends at the head block
+   block_api->add_block_stream_credit( id, 1000 );
+   fc::usleep(fc::milliseconds(200));
+   BOOST_REQUIRE( batches.back().done );
+   vector<vector<char>> blocks;
+   for( const auto& b : batches )
+   {
+      BOOST_CHECK_EQUAL( b.stream_id, id );
+      BOOST_CHECK_EQUAL( b.first_block_num, blocks.size() + 1 );
+      blocks.insert( blocks.end(), b.blocks.begin(), b.blocks.end() );
+   }
+   BOOST_REQUIRE_EQUAL( blocks.size(), head_num );
+   for( uint32_t i = 0; i < head_num; ++i )
+      BOOST_CHECK( fc::raw::unpack<signed_block>( blocks[i] ).id() == db.fetch_block_by_number( i + 1 )->id() );
+   BOOST_CHECK_THROW( block_api->add_block_stream_credit( id, 1 ), fc::exception );
+
+   // a canceled stream pushes nothing
+   batches.clear();
+   const uint64_t id2 = block_api->stream_blocks( callback, 1, head_num, 100 );
+   block_api->cancel_block_stream( id2 );
+   fc::usleep(fc::milliseconds(200));
+   BOOST_CHECK( batches.empty() );
+
+   BOOST_CHECK_THROW( block_api->stream_blocks( callback, 2, 1, 1 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( api_call_statistics_test )
+{ try {
+   generate_blocks( 2 );
+
+   auto stats = std::make_shared<graphene::app::api_call_statistics>( fc::microseconds() );
+   fc::api<graphene::app::block_api> api( std::make_shared<graphene::app::block_api>( db ) );
+   graphene::app::instrument_api( api, "block_api", stats );
+
+   const auto blocks = api->get_blocks( 1, 2 );
+   BOOST_CHECK_EQUAL( blocks.size(), 2u );
+   BOOST_CHECK_THROW( api->get_blocks( 2, 1 ), fc::exception );
+
+   const auto statistics = stats->get_statistics();
+   BOOST_REQUIRE_EQUAL( statistics.size(), 1u );
+   const auto& s = statistics.front();
+   BOOST_CHECK_EQUAL( s.method, "block_api.get_blocks" );
+   BOOST_CHECK_EQUAL( s.calls, 2u );
+   BOOST_CHECK_EQUAL( s.failures, 1u );
+   BOOST_CHECK_EQUAL( s.total_response_bytes, fc::raw::pack_size( blocks ) );
+   BOOST_CHECK_EQUAL( s.max_response_bytes, s.total_response_bytes );
+   BOOST_CHECK_LE( s.p50_microseconds, s.p99_microseconds );
+   BOOST_CHECK_LE( s.p99_microseconds, s.max_microseconds );
+   BOOST_CHECK_LE( s.max_microseconds, s.total_microseconds );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( object_notification_cache_test )
+{ try {
+   ACTORS( (alice) );
+   generate_block();
+
+   graphene::app::object_notification_cache cache( db );
+   vector<string> reported;
+   boost::signals2::scoped_connection connection = db.changed_objects.connect(
+         [&]( const vector<object_id_type>& ids, const flat_set<account_id_type>& ) {
+      for( const auto& id : ids )
+      {
+         if( id != alice_id )
+            continue;
+         // all handlers of one emission share one variant
+         const fc::variant& v = cache.get( alice_id(db) );
+         BOOST_CHECK( &v == &cache.get( alice_id(db) ) );
+         reported.push_back( fc::json::to_string( v ) );
+      }
+   });
+
+   upgrade_to_lifetime_member( alice_id );
+   generate_block();
+   BOOST_REQUIRE_EQUAL( reported.size(), 1u );
+   BOOST_CHECK_EQUAL( reported.back(), fc::json::to_string( alice_id(db).to_variant() ) );
+
+   // the next emission serializes the object again
+   account_update_operation op;
+   op.account = alice_id;
+   op.new_options = alice_id(db).options;
+   op.new_options->memo_key = generate_private_key( "alice_memo" ).get_public_key();
+   trx.clear();
+   trx.operations.push_back( op );
+   PUSH_TX( db, trx, ~0 );
+   generate_block();
+   BOOST_REQUIRE_EQUAL( reported.size(), 2u );
+   BOOST_CHECK( reported[0] != reported[1] );
+   BOOST_CHECK_EQUAL( reported.back(), fc::json::to_string( alice_id(db).to_variant() ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( impacted_account_subscription_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   generate_block();
+
+   flat_set<account_id_type> impacted;
+   boost::signals2::scoped_connection connection = db.changed_objects.connect(
+         [&]( const vector<object_id_type>&, const flat_set<account_id_type>& accounts ) {
+      impacted.insert( accounts.begin(), accounts.end() );
+   });
+
+   // nobody is subscribed to an account, the impacted accounts are not computed
+   transfer( committee_account, alice_id, asset(1) );
+   transfer( committee_account, bob_id, asset(1) );
+   generate_block();
+   BOOST_CHECK( impacted.empty() );
+
+   {
+      graphene::app::database_api db_api1( db, &( app.get_options() ) );
+      graphene::app::database_api db_api2( db, &( app.get_options() ) );
+      db_api1.set_subscribe_callback( []( const variant& ) {}, false );
+      db_api2.set_subscribe_callback( []( const variant& ) {}, false );
+      db_api1.get_full_accounts( { "alice" }, true );
+      db_api2.get_full_accounts( { "alice" }, true );
+
+      // only the subscribed accounts are reported
+      transfer( committee_account, alice_id, asset(1) );
+      transfer( committee_account, bob_id, asset(1) );
+      generate_block();
+      BOOST_CHECK( impacted == flat_set<account_id_type>({ alice_id }) );
+
+      // the subscription is counted
+      db_api1.cancel_all_subscriptions();
+      impacted.clear();
+      transfer( committee_account, alice_id, asset(1) );
+      generate_block();
+      BOOST_CHECK( impacted == flat_set<account_id_type>({ alice_id }) );
+   }
+
+   // the sessions are gone
+   impacted.clear();
+   transfer( committee_account, alice_id, asset(1) );
+   generate_block();
+   BOOST_CHECK( impacted.empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( order_book_deltas_test )
+{ try {
+   ACTORS( (seller)(buyer) );
+
+   const auto& bitcny = create_user_issued_asset( "CNY" );
+   const auto& core   = asset_id_type()(db);
+   transfer( committee_account, seller_id, asset(10000000) );
+   issue_uia( buyer_id, bitcny.amount(10000000) );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   opt.order_book_deltas = std::make_shared<graphene::app::order_book_delta_publisher>( db );
+   graphene::app::database_api db_api1( db, &opt );
+   graphene::app::database_api db_api2( db, &opt );
+
+   vector<fc::variant> deltas1;
+   vector<fc::variant> deltas2;
+   BOOST_CHECK_THROW( db_api1.subscribe_to_order_book_deltas( [&]( const fc::variant& d ) { deltas1.push_back( d ); },
+                      "CNY", "BTS", opt.api_limit_get_order_book + 1 ), fc::exception );
+   db_api1.subscribe_to_order_book_deltas( [&]( const fc::variant& d ) { deltas1.push_back( d ); }, "CNY", "BTS", 10 );
+   db_api2.subscribe_to_order_book_deltas( [&]( const fc::variant& d ) { deltas2.push_back( d ); }, "CNY", "BTS", 10 );
+   // both sessions share the market
+   BOOST_CHECK_EQUAL( opt.order_book_deltas->market_count(), 1u );
+
+   auto last_delta = [&deltas1]() {
+      return deltas1.back().as<graphene::app::order_book_delta>( GRAPHENE_MAX_NESTED_OBJECTS );
+   };
+
+   // an ask sells BTS for CNY, a bid sells CNY for BTS
+   create_sell_order( seller_id, core.amount(100), bitcny.amount(250) );
+   const limit_order_id_type bid_id = create_sell_order( buyer_id, bitcny.amount(150), core.amount(100) )->get_id();
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+
+   // the first delta is a snapshot
+   BOOST_REQUIRE_EQUAL( deltas1.size(), 1u );
+   BOOST_REQUIRE_EQUAL( deltas2.size(), 1u );
+   BOOST_CHECK_EQUAL( fc::json::to_string( deltas1.back() ), fc::json::to_string( deltas2.back() ) );
+   auto delta = last_delta();
+   BOOST_CHECK( delta.is_snapshot );
+   BOOST_CHECK_EQUAL( delta.block_num, db.head_block_num() );
+   BOOST_CHECK_EQUAL( delta.base, "CNY" );
+   BOOST_REQUIRE_EQUAL( delta.asks.size(), 1u );
+   BOOST_CHECK_EQUAL( delta.asks[0].quote, core.amount_to_string( 100 ) );
+   BOOST_CHECK_EQUAL( delta.asks[0].base, bitcny.amount_to_string( 250 ) );
+   BOOST_REQUIRE_EQUAL( delta.bids.size(), 1u );
+   BOOST_CHECK_EQUAL( delta.bids[0].base, bitcny.amount_to_string( 150 ) );
+
+   // nothing is sent if the book did not change
+   generate_block();
+   fc::usleep(fc::milliseconds(200));
+   BOOST_CHECK_EQUAL( deltas1.size(), 1u );
+
+   // only the changed level is sent
+   create_sell_order( seller_id, core.amount(100), bitcny.amount(250) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200));
+   BOOST_REQUIRE_EQUAL( deltas1.size(), 2u );
+   delta = last_delta();
+   BOOST_CHECK( !delta.is_snapshot );
+   BOOST_CHECK( delta.bids.empty() );
+   BOOST_REQUIRE_EQUAL( delta.asks.size(), 1u );
+   BOOST_CHECK_EQUAL( delta.asks[0].quote, core.amount_to_string( 200 ) );
+
+   // fills are sent with the levels
+   BOOST_CHECK( !create_sell_order( buyer_id, bitcny.amount(250), core.amount(100) ) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200));
+   BOOST_REQUIRE_EQUAL( deltas1.size(), 3u );
+   delta = last_delta();
+   BOOST_CHECK_EQUAL( delta.fills.size(), 2u );
+   BOOST_REQUIRE_EQUAL( delta.asks.size(), 1u );
+   BOOST_CHECK_EQUAL( delta.asks[0].quote, core.amount_to_string( 100 ) );
+
+   // a level which is gone has zero amounts
+   db_api2.unsubscribe_from_order_book_deltas( "CNY", "BTS" );
+   cancel_limit_order( bid_id(db) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200));
+   BOOST_REQUIRE_EQUAL( deltas1.size(), 4u );
+   BOOST_CHECK_EQUAL( deltas2.size(), 3u );
+   delta = last_delta();
+   BOOST_REQUIRE_EQUAL( delta.bids.size(), 1u );
+   BOOST_CHECK_EQUAL( delta.bids[0].base, bitcny.amount_to_string( 0 ) );
+   BOOST_CHECK( delta.asks.empty() );
+
+   db_api1.cancel_all_subscriptions();
+   BOOST_CHECK_EQUAL( opt.order_book_deltas->market_count(), 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( account_operations_subscription_test )
+{ try {
+   ACTORS( (alice)(bob)(carol) );
+   transfer( committee_account, alice_id, asset(1000000) );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   opt.account_operations = std::make_shared<graphene::app::account_operation_publisher>( db );
+   opt.api_limit_subscribe_to_account_operations = 2;
+   graphene::app::database_api db_api1( db, &opt );
+   graphene::app::database_api db_api2( db, &opt );
+
+   vector<fc::variant> notes1;
+   vector<fc::variant> notes2;
+   auto callback1 = [&]( const fc::variant& v ) { notes1.push_back( v ); };
+   auto callback2 = [&]( const fc::variant& v ) { notes2.push_back( v ); };
+   BOOST_CHECK_THROW( db_api1.subscribe_to_account_operations( callback1, {} ), fc::exception );
+   BOOST_CHECK_THROW( db_api1.subscribe_to_account_operations( callback1, { "alice", "bob", "carol" } ),
+                      fc::exception );
+   db_api1.subscribe_to_account_operations( callback1, { "alice", "bob" } );
+   db_api2.subscribe_to_account_operations( callback2, { std::string( object_id_type( carol_id ) ) } );
+   BOOST_CHECK_EQUAL( opt.account_operations->account_count(), 3u );
+
+   auto last_ops = [&notes1]() {
+      return notes1.back().as< vector<operation_history_object> >( GRAPHENE_MAX_NESTED_OBJECTS );
+   };
+
+   // an operation which impacts both accounts of a subscription is sent once
+   transfer( alice_id, bob_id, asset(1) );
+   transfer( committee_account, carol_id, asset(1) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+
+   BOOST_REQUIRE_EQUAL( notes1.size(), 1u );
+   BOOST_REQUIRE_EQUAL( notes2.size(), 1u );
+   auto ops = last_ops();
+   BOOST_REQUIRE_EQUAL( ops.size(), 1u );
+   BOOST_CHECK( ops[0].op.is_type<transfer_operation>() );
+   BOOST_CHECK_EQUAL( ops[0].block_num, db.head_block_num() );
+   BOOST_CHECK( ops[0].op.get<transfer_operation>().to == bob_id );
+
+   // nothing is sent for blocks without operations of the accounts
+   generate_block();
+   fc::usleep(fc::milliseconds(200));
+   BOOST_CHECK_EQUAL( notes1.size(), 1u );
+
+   // subscribing again replaces the accounts
+   db_api1.subscribe_to_account_operations( callback1, { "carol" } );
+   BOOST_CHECK_EQUAL( opt.account_operations->account_count(), 1u );
+   transfer( alice_id, bob_id, asset(1) );
+   transfer( committee_account, carol_id, asset(1) );
+   transfer( committee_account, carol_id, asset(2) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200));
+   BOOST_REQUIRE_EQUAL( notes1.size(), 2u );
+   BOOST_REQUIRE_EQUAL( notes2.size(), 2u );
+   BOOST_CHECK_EQUAL( fc::json::to_string( notes1.back() ), fc::json::to_string( notes2.back() ) );
+   ops = last_ops();
+   BOOST_REQUIRE_EQUAL( ops.size(), 2u );
+   BOOST_CHECK( ops[0].op.get<transfer_operation>().amount == asset(1) );
+   BOOST_CHECK( ops[1].op.get<transfer_operation>().amount == asset(2) );
+
+   db_api2.unsubscribe_from_account_operations();
+   transfer( committee_account, carol_id, asset(1) );
+   generate_block();
+   fc::usleep(fc::milliseconds(200));
+   BOOST_CHECK_EQUAL( notes1.size(), 3u );
+   BOOST_CHECK_EQUAL( notes2.size(), 2u );
+
+   db_api1.cancel_all_subscriptions();
+   BOOST_CHECK_EQUAL( opt.account_operations->account_count(), 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( get_full_account_page_test )
+{ try {
+   ACTORS( (alice) );
+   graphene::app::database_api db_api( db, &( app.get_options() ) );
+
+   const auto& usd = create_user_issued_asset( "USDTEST" );
+   const auto& eur = create_user_issued_asset( "EURTEST" );
+   transfer( committee_account, alice_id, asset(10000000) );
+   issue_uia( alice_id, usd.amount(1000) );
+   issue_uia( alice_id, eur.amount(1000) );
+   for( int i = 0; i < 5; ++i )
+      create_sell_order( alice_id, asset(100), usd.amount(1000 + i) );
+   generate_block();
+
+   graphene::app::full_account_query query;
+   query.limit = 2;
+   query.sections["balances"];
+   query.sections["limit_orders"];
+
+   auto page = db_api.get_full_account_page( "alice", query );
+   BOOST_CHECK( page.account.account.id == alice_id );
+   BOOST_CHECK_EQUAL( page.account.balances.size(), 2u );
+   BOOST_CHECK_EQUAL( page.account.limit_orders.size(), 2u );
+   // sections which are not selected are left out
+   BOOST_CHECK( page.account.vesting_balances.empty() );
+   BOOST_CHECK( page.account.assets.empty() );
+
+   // continue every list until it is complete
+   vector<limit_order_id_type> orders;
+   vector<asset_id_type> balance_assets;
+   while( true )
+   {
+      for( const auto& o : page.account.limit_orders )
+         orders.push_back( o.get_id() );
+      for( const auto& b : page.account.balances )
+         balance_assets.push_back( b.asset_type );
+      if( page.next_start.empty() )
+         break;
+      query.sections.clear();
+      for( const auto& next : page.next_start )
+         query.sections[next.first] = next.second;
+      page = db_api.get_full_account_page( "alice", query );
+   }
+   BOOST_CHECK_EQUAL( orders.size(), 5u );
+   BOOST_CHECK( std::is_sorted( orders.begin(), orders.end() ) );
+   BOOST_CHECK_EQUAL( balance_assets.size(), 3u );
+   BOOST_CHECK( std::is_sorted( balance_assets.begin(), balance_assets.end() ) );
+
+   query.sections.clear();
+   query.sections["no_such_section"];
+   BOOST_CHECK_THROW( db_api.get_full_account_page( "alice", query ), fc::exception );
+   query.sections.clear();
+   query.limit = app.get_options().api_limit_get_full_accounts_lists + 1;
+   BOOST_CHECK_THROW( db_api.get_full_account_page( "alice", query ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( get_vesting_balance_withdrawals_test )
+{ try {
+   ACTORS( (alice) );
+   graphene::app::database_api db_api( db, &( app.get_options() ) );
+   transfer( committee_account, alice_id, asset(10000000) );
+
+   vector<vesting_balance_id_type> ids;
+   const vector<vesting_policy_initializer> policies = { cdd_vesting_policy_initializer( 86400 ),
+                                                         instant_vesting_policy_initializer() };
+   for( const vesting_policy_initializer& policy : policies )
+   {
+      vesting_balance_create_operation op;
+      op.creator = alice_id;
+      op.owner = alice_id;
+      op.amount = asset( 1000 );
+      op.policy = policy;
+      trx.operations.clear();
+      trx.operations.push_back( op );
+      const processed_transaction ptx = PUSH_TX( db, trx, ~0 );
+      ids.push_back( ptx.operation_results[0].get<object_id_type>() );
+   }
+   ids.push_back( vesting_balance_id_type( ids.back().instance.value + 100 ) );
+   generate_blocks( db.head_block_time() + 43200 );
+
+   const auto withdrawals = db_api.get_vesting_balance_withdrawals( ids );
+   BOOST_REQUIRE_EQUAL( withdrawals.size(), 3u );
+   BOOST_REQUIRE( withdrawals[0].valid() );
+   BOOST_CHECK( *withdrawals[0] == ids[0](db).get_allowed_withdraw( db.head_block_time() ) );
+   BOOST_CHECK_GT( withdrawals[0]->amount.value, 0 );
+   BOOST_CHECK_LT( withdrawals[0]->amount.value, 1000 );
+   BOOST_REQUIRE( withdrawals[1].valid() );
+   BOOST_CHECK( *withdrawals[1] == asset( 1000 ) );
+   BOOST_CHECK( !withdrawals[2].valid() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( api_helper_account_lookups_test )
+{ try {
+   ACTORS( (alice)(bob)(carol) );
+   graphene::app::database_api db_api( db, &( app.get_options() ) );
+   transfer( committee_account, alice_id, asset(10000000) );
+   transfer( committee_account, carol_id, asset(10000000) );
+
+   // vesting balances of carol, their total is tracked
+   for( int64_t amount : { 100, 200 } )
+   {
+      vesting_balance_create_operation vb_op;
+      vb_op.creator = alice_id;
+      vb_op.owner = carol_id;
+      vb_op.amount = asset( amount );
+      vb_op.policy = cdd_vesting_policy_initializer( 86400 );
+      trx.operations.push_back( vb_op );
+   }
+   // withdraw permissions of alice, which expire in the reverse order of creation
+   for( uint32_t periods : { 3, 2 } )
+   {
+      withdraw_permission_create_operation wp_op;
+      wp_op.withdraw_from_account = alice_id;
+      wp_op.authorized_account = ( periods == 3 ? bob_id : carol_id );
+      wp_op.withdrawal_limit = asset( 100 );
+      wp_op.withdrawal_period_sec = 86400;
+      wp_op.periods_until_expiration = periods;
+      wp_op.period_start_time = db.head_block_time() + 10;
+      trx.operations.push_back( wp_op );
+   }
+   set_expiration( db, trx );
+   sign( trx, alice_private_key );
+   PUSH_TX( db, trx );
+   trx.clear();
+
+   // bob controls the active authority of alice
+   {
+      account_update_operation op;
+      op.account = alice_id;
+      op.active = authority( 1, bob_id, 1 );
+      trx.operations.push_back( op );
+      sign( trx, alice_private_key );
+      PUSH_TX( db, trx );
+      trx.clear();
+   }
+
+   // a proposal which needs the approval of alice
+   transfer_operation top;
+   top.from = alice_id;
+   top.to = carol_id;
+   top.amount = asset( 1000 );
+   proposal_create_operation pop;
+   pop.proposed_ops.push_back( { op_wrapper(top) } );
+   pop.expiration_time = db.head_block_time() + fc::days(1);
+   pop.fee_paying_account = carol_id;
+   trx.operations.push_back( pop );
+   sign( trx, carol_private_key );
+   processed_transaction processed = PUSH_TX( db, trx );
+   const proposal_id_type proposal_id { processed.operation_results.front().get<object_id_type>() };
+   trx.clear();
+   generate_block();
+
+   // bob can approve it through the authority of alice, carol can not
+   auto proposals = db_api.get_proposed_transactions( "bob" );
+   BOOST_REQUIRE_EQUAL( proposals.size(), 1u );
+   BOOST_CHECK( proposals.front().id == proposal_id );
+   BOOST_CHECK_EQUAL( db_api.get_proposed_transactions( "alice" ).size(), 1u );
+   BOOST_CHECK( db_api.get_proposed_transactions( "carol" ).empty() );
+   auto accounts = db_api.get_full_accounts( { "bob", "carol" }, false );
+   BOOST_CHECK_EQUAL( accounts["bob"].proposals.size(), 1u );
+   BOOST_CHECK( accounts["carol"].proposals.empty() );
+
+   BOOST_REQUIRE_EQUAL( accounts["carol"].vesting_balances.size(), 2u );
+   BOOST_REQUIRE_EQUAL( accounts["carol"].vesting_balance_totals.size(), 1u );
+   BOOST_CHECK( accounts["carol"].vesting_balance_totals.front() == asset( 300 ) );
+   BOOST_CHECK( accounts["bob"].vesting_balance_totals.empty() );
+
+   auto permissions = db_api.get_withdraw_permissions_by_expiration( "alice", time_point_sec(), 10 );
+   BOOST_REQUIRE_EQUAL( permissions.size(), 2u );
+   BOOST_CHECK( permissions[0].authorized_account == carol_id );
+   BOOST_CHECK( permissions[1].authorized_account == bob_id );
+   BOOST_CHECK( permissions[0].expiration < permissions[1].expiration );
+   permissions = db_api.get_withdraw_permissions_by_expiration( "bob", time_point_sec(), 10 );
+   BOOST_REQUIRE_EQUAL( permissions.size(), 1u );
+   BOOST_CHECK( permissions[0].withdraw_from_account == alice_id );
+   permissions = db_api.get_withdraw_permissions_by_expiration( "alice", permissions[0].expiration, 10 );
+   BOOST_CHECK_EQUAL( permissions.size(), 1u );
+   BOOST_CHECK( db_api.get_htlcs_by_expiration( "alice", time_point_sec(), 10 ).empty() );
+} FC_LOG_AND_RETHROW() }
+
+
+BOOST_AUTO_TEST_CASE( block_event_bus_test )
+{ try {
+   ACTORS( (alice) );
+   generate_block();
+
+   graphene::app::block_event_bus bus( db );
+   std::mutex events_mutex;
+   vector<uint32_t> block_nums;
+   size_t operations = 0;
+   bool alice_changed = false;
+   auto with_objects = bus.add_consumer( "with objects", [&]( const graphene::app::block_event& e ) {
+      std::lock_guard<std::mutex> guard( events_mutex );
+      block_nums.push_back( e.block.block_num() );
+      operations += e.operations.size();
+      for( const auto& obj : e.changed_objects )
+         alice_changed = alice_changed || obj->id == alice_id;
+   }, 1, true );
+   uint32_t without_objects_events = 0;
+   auto without_objects = bus.add_consumer( "without objects", [&]( const graphene::app::block_event& e ) {
+      if( e.changed_objects.empty() )
+         ++without_objects_events;
+      FC_THROW( "failed consumers do not stop the bus" );
+   }, 10, false );
+
+   upgrade_to_lifetime_member( alice_id );
+   generate_block();
+   generate_block();
+
+   auto metrics = bus.get_metrics();
+   BOOST_REQUIRE_EQUAL( metrics.size(), 2u );
+   BOOST_CHECK_EQUAL( metrics[0].name, "with objects" );
+   BOOST_CHECK_EQUAL( metrics[0].max_queue_size, 1u );
+
+   bus.remove_consumer( with_objects );
+   bus.remove_consumer( without_objects );
+   BOOST_CHECK( bus.get_metrics().empty() );
+
+   uint32_t head = db.head_block_num();
+   BOOST_REQUIRE_EQUAL( block_nums.size(), 2u );
+   BOOST_CHECK_EQUAL( block_nums[0], head - 1 );
+   BOOST_CHECK_EQUAL( block_nums[1], head );
+   BOOST_CHECK_GE( operations, 1u );
+   BOOST_CHECK( alice_changed );
+   BOOST_CHECK_EQUAL( without_objects_events, 2u );
+
+   // removed consumers receive nothing
+   generate_block();
+   BOOST_CHECK_EQUAL( block_nums.size(), 2u );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,11 @@
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
+#include <graphene/chain/witness_object.hpp>
+
+#include <graphene/db/background_populated_index.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
 
@@ -35,6 +40,37 @@
 
 using namespace graphene::chain;
 
+namespace {
+
+   /** sums up the balances it is told about, and counts the notifications */
+   class balance_sum_index : public secondary_index
+   {
+      public:
+         void object_inserted( const object& obj ) override { ++calls; sum += balance_of( obj ); }
+         void object_removed( const object& obj ) override  { ++calls; sum -= balance_of( obj ); }
+         void about_to_modify( const object& before ) override { ++calls; sum -= balance_of( before ); }
+         void object_modified( const object& after ) override  { ++calls; sum += balance_of( after ); }
+         bool is_deferrable()const override { return true; }
+
+         uint32_t calls = 0;
+         int64_t  sum = 0;
+
+      private:
+         static int64_t balance_of( const object& obj )
+         { return static_cast<const account_balance_object&>( obj ).balance.value; }
+   };
+
+   /** counts the modifications of every object */
+   class modification_counter_index : public secondary_index
+   {
+      public:
+         void about_to_modify( const object& before ) override { ++modifications[ before.id ]; }
+
+         std::map< object_id_type, uint32_t > modifications;
+   };
+
+}
+
 BOOST_FIXTURE_TEST_SUITE( database_tests, database_fixture )
 
 BOOST_AUTO_TEST_CASE( undo_test )
@@ -138,6 +174,690 @@ BOOST_AUTO_TEST_CASE( merge_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( reserve_next_id_test )
+{
+   try {
+      database db;
+      typedef primary_index< account_balance_index > balance_index_type;
+      auto& idx = const_cast< balance_index_type& >( db.get_index_type< balance_index_type >() );
+      const object_id_type first_id = idx.get_next_id();
+      const size_t size_before = idx.object_count();
+      {
+         auto ses = db._undo_db.start_undo_session();
+         BOOST_CHECK( first_id == idx.reserve_next_id() );
+         idx.reserve_next_id();
+         const auto& obj = db.create<account_balance_object>( []( account_balance_object& obj ){ obj.balance = 1; } );
+         BOOST_CHECK_EQUAL( first_id.instance() + 2, obj.id.instance() );
+         ses.undo();
+      }
+      BOOST_CHECK( first_id == idx.get_next_id() );
+      BOOST_CHECK_EQUAL( size_before, idx.object_count() );
+
+      // nested sessions which reserve ids are merged into their parent
+      {
+         auto outer = db._undo_db.start_undo_session();
+         {
+            auto inner = db._undo_db.start_undo_session();
+            idx.reserve_next_id();
+            inner.merge();
+         }
+         BOOST_CHECK_EQUAL( first_id.instance() + 1, idx.get_next_id().instance() );
+         outer.undo();
+      }
+      BOOST_CHECK( first_id == idx.get_next_id() );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( packed_undo_test )
+{
+   try {
+      database db;
+      db._undo_db.set_packed_mode( true );
+      const auto& bal_obj = db.create<account_balance_object>( [&]( account_balance_object& obj ){
+          obj.owner = account_id_type(5);
+          obj.balance = 42;
+      });
+      const account_balance_id_type bal_id = bal_obj.id;
+
+      // modify and undo
+      {
+         auto ses = db._undo_db.start_undo_session();
+         db.modify( bal_obj, []( account_balance_object& obj ){ obj.balance = 43; } );
+         db.modify( bal_obj, []( account_balance_object& obj ){ obj.balance = 44; } );
+         BOOST_CHECK_EQUAL( 1u, db._undo_db.head().old_packed_values.size() );
+         BOOST_CHECK( db._undo_db.head().old_values.empty() );
+         ses.undo();
+      }
+      BOOST_CHECK_EQUAL( 42, bal_id(db).balance.value );
+
+      // modify and remove, then undo
+      {
+         auto ses = db._undo_db.start_undo_session();
+         db.modify( bal_id(db), []( account_balance_object& obj ){ obj.balance = 45; } );
+         db.remove( bal_id(db) );
+         BOOST_CHECK( db._undo_db.head().old_packed_values.empty() );
+         BOOST_CHECK_EQUAL( 1u, db._undo_db.head().removed.size() );
+         ses.undo();
+      }
+      BOOST_REQUIRE( db.find( bal_id ) != nullptr );
+      BOOST_CHECK_EQUAL( 42, bal_id(db).balance.value );
+      BOOST_CHECK( bal_id(db).owner == account_id_type(5) );
+
+      // modify in an outer session, modify and remove in a merged inner session, then undo the outer one
+      {
+         auto outer = db._undo_db.start_undo_session();
+         db.modify( bal_id(db), []( account_balance_object& obj ){ obj.balance = 46; } );
+         {
+            auto inner = db._undo_db.start_undo_session();
+            db.modify( bal_id(db), []( account_balance_object& obj ){ obj.balance = 47; } );
+            db.remove( bal_id(db) );
+            inner.merge();
+         }
+         BOOST_CHECK( db._undo_db.head().old_packed_values.empty() );
+         BOOST_CHECK_EQUAL( 1u, db._undo_db.head().removed.size() );
+         outer.undo();
+      }
+      BOOST_REQUIRE( db.find( bal_id ) != nullptr );
+      BOOST_CHECK_EQUAL( 42, bal_id(db).balance.value );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( undo_memory_limit_test )
+{
+   try {
+      database db;
+      vector<account_balance_id_type> ids;
+      db._undo_db.disable();
+      for( int64_t i = 0; i < 100; ++i )
+         ids.push_back( db.create<account_balance_object>( [i]( account_balance_object& obj ){
+            obj.owner = account_id_type(i);
+            obj.balance = i;
+         }).id );
+      db._undo_db.enable();
+
+      const auto apply_block = [&db,&ids]() {
+         auto ses = db._undo_db.start_undo_session();
+         for( const auto& id : ids )
+            db.modify( id(db), []( account_balance_object& obj ){ obj.balance += 1; } );
+         ses.commit();
+      };
+      for( int i = 0; i < 4; ++i )
+         apply_block();
+
+      // the state of the latest block is measured when the next session starts
+      auto usage = db._undo_db.get_usage();
+      BOOST_CHECK_EQUAL( 3u, usage.states );
+      BOOST_CHECK_EQUAL( 0u, usage.compacted_states );
+      BOOST_CHECK_GT( usage.last_state_bytes, 0u );
+      BOOST_CHECK_EQUAL( usage.last_state_bytes, usage.largest_state_bytes );
+      const uint64_t unlimited_bytes = usage.bytes;
+
+      // the oldest states are packed to get below the limit, none is dropped
+      db._undo_db.set_max_bytes( usage.last_state_bytes * 2 );
+      usage = db._undo_db.get_usage();
+      BOOST_CHECK_EQUAL( 3u, usage.states );
+      BOOST_CHECK_GT( usage.compacted_states, 0u );
+      BOOST_CHECK_LT( usage.bytes, unlimited_bytes );
+      BOOST_CHECK_EQUAL( 4u, db._undo_db.size() );
+
+      // packed states are undone like the others
+      while( db._undo_db.size() > 0 )
+         db._undo_db.pop_commit();
+      for( int64_t i = 0; i < 100; ++i )
+         BOOST_CHECK_EQUAL( i, ids[i](db).balance.value );
+      BOOST_CHECK_EQUAL( 0u, db._undo_db.get_usage().bytes );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( undo_node_pool_test )
+{
+   try {
+      database db;
+      const auto& pool = db._undo_db.get_node_pool();
+      size_t reserved = 0;
+      {
+         auto ses = db._undo_db.start_undo_session();
+         for( int i = 0; i < 100; ++i )
+            db.create<account_balance_object>( []( account_balance_object& obj ){ obj.balance = 1; } );
+         BOOST_CHECK_GT( pool.used_bytes(), 0u );
+         reserved = pool.reserved_bytes();
+         ses.undo();
+      }
+      BOOST_CHECK_EQUAL( 0u, pool.used_bytes() );
+      // nodes are recycled by the next session
+      {
+         auto ses = db._undo_db.start_undo_session();
+         for( int i = 0; i < 100; ++i )
+            db.create<account_balance_object>( []( account_balance_object& obj ){ obj.balance = 1; } );
+         BOOST_CHECK_EQUAL( reserved, pool.reserved_bytes() );
+         ses.undo();
+      }
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( pooled_object_nodes_test )
+{
+   try {
+      database db;
+      const auto& balances = db.get_index_type<account_balance_index>();
+      std::vector<const account_balance_object*> objects;
+      for( int i = 0; i < 1000; ++i )
+         objects.push_back( &db.create<account_balance_object>( [i]( account_balance_object& obj ){
+            obj.owner = account_id_type(i);
+            obj.balance = i;
+         }) );
+      const size_t node_size = balances.object_node_size();
+      BOOST_CHECK_GE( node_size, sizeof(account_balance_object) );
+      const size_t reserved = balances.object_pool_reserved_bytes();
+      BOOST_CHECK_GE( reserved, objects.size() * node_size );
+
+      // the nodes are packed together: objects created one after the other are neighbours
+      size_t neighbours = 0;
+      for( size_t i = 1; i < objects.size(); ++i )
+         if( reinterpret_cast<const char*>( objects[i] ) - reinterpret_cast<const char*>( objects[i-1] )
+               == static_cast<ptrdiff_t>( node_size ) )
+            ++neighbours;
+      BOOST_CHECK_GT( neighbours, objects.size() / 2 );
+
+      // freed nodes are reused
+      for( size_t i = 0; i < objects.size(); i += 2 )
+         db.remove( *objects[i] );
+      for( int i = 0; i < 500; ++i )
+         db.create<account_balance_object>( [i]( account_balance_object& obj ){
+            obj.owner = account_id_type(1000 + i);
+            obj.balance = 1;
+         });
+      BOOST_CHECK_EQUAL( reserved, balances.object_pool_reserved_bytes() );
+      BOOST_CHECK_EQUAL( 1000u, balances.indices().size() );
+
+      // indexes which are not pooled report no pool
+      BOOST_CHECK_EQUAL( 0u, db.get_index_type<proposal_index>().object_pool_reserved_bytes() );
+      for( const auto& usage : db.get_memory_usage() )
+         if( usage.space_id == account_balance_object::space_id && usage.type_id == account_balance_object::type_id )
+            BOOST_CHECK_EQUAL( usage.pool_reserved_bytes, reserved );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( secondary_index_batch_test )
+{
+   try {
+      database db;
+      const auto& sums = *db.add_secondary_index< primary_index<account_balance_index>, balance_sum_index >();
+      const auto& bal1 = db.create<account_balance_object>( []( account_balance_object& obj ){
+          obj.owner = account_id_type(1);
+          obj.balance = 10;
+      });
+      const account_balance_id_type bal1_id = bal1.id;
+      BOOST_CHECK_EQUAL( 1u, sums.calls );
+      BOOST_CHECK_EQUAL( 10, sums.sum );
+
+      // repeated modifications are coalesced, created-and-removed objects are not reported at all
+      account_balance_id_type bal2_id;
+      {
+         secondary_index_batch batch( db );
+         for( int64_t b = 11; b <= 13; ++b )
+            db.modify( bal1_id(db), [b]( account_balance_object& obj ){ obj.balance = b; } );
+         const auto& bal2 = db.create<account_balance_object>( []( account_balance_object& obj ){
+             obj.owner = account_id_type(2);
+             obj.balance = 5;
+         });
+         bal2_id = bal2.id;
+         db.modify( bal2, []( account_balance_object& obj ){ obj.balance = 6; } );
+         const auto& bal3 = db.create<account_balance_object>( []( account_balance_object& obj ){
+             obj.owner = account_id_type(3);
+             obj.balance = 7;
+         });
+         db.remove( bal3 );
+         BOOST_CHECK_EQUAL( 1u, sums.calls );
+         BOOST_CHECK_EQUAL( 10, sums.sum );
+      }
+      BOOST_CHECK_EQUAL( 4u, sums.calls );
+      BOOST_CHECK_EQUAL( 19, sums.sum );
+
+      // removing a modified object reports the state before the batch
+      {
+         secondary_index_batch batch( db );
+         db.modify( bal1_id(db), []( account_balance_object& obj ){ obj.balance = 20; } );
+         db.remove( bal1_id(db) );
+         BOOST_CHECK_EQUAL( 5u, sums.calls );
+         BOOST_CHECK_EQUAL( 6, sums.sum );
+      }
+      BOOST_CHECK_EQUAL( 5u, sums.calls );
+      BOOST_CHECK_EQUAL( 6, sums.sum );
+
+      // nested batches are flushed by the outermost one only
+      {
+         secondary_index_batch outer( db );
+         {
+            secondary_index_batch inner( db );
+            db.modify( bal2_id(db), []( account_balance_object& obj ){ obj.balance = 8; } );
+         }
+         BOOST_CHECK_EQUAL( 6, sums.sum );
+      }
+      BOOST_CHECK_EQUAL( 7u, sums.calls );
+      BOOST_CHECK_EQUAL( 8, sums.sum );
+
+      // without a batch, notifications are delivered immediately
+      db.modify( bal2_id(db), []( account_balance_object& obj ){ obj.balance = 9; } );
+      BOOST_CHECK_EQUAL( 9u, sums.calls );
+      BOOST_CHECK_EQUAL( 9, sums.sum );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( background_populated_index_test )
+{
+   try {
+      database db;
+      vector<account_balance_id_type> ids;
+      for( int64_t b = 1; b <= 5; ++b )
+         ids.push_back( db.create<account_balance_object>( [b]( account_balance_object& obj ){
+            obj.owner = account_id_type(b);
+            obj.balance = b;
+         }).id );
+
+      using populated_sum_index = background_populated_index< account_balance_index, balance_sum_index >;
+      auto& sums = *db.add_secondary_index< primary_index<account_balance_index>, populated_sum_index >(
+                        &db.get_index_type<account_balance_index>() );
+      BOOST_CHECK( !sums.is_populated() );
+      BOOST_CHECK_EQUAL( 0, sums.sum );
+
+      BOOST_CHECK( !sums.populate( 2 ) );
+      BOOST_CHECK_EQUAL( 3, sums.sum );
+
+      // changes of the added objects are tracked, the other objects are added in their current state later
+      db.modify( ids[0](db), []( account_balance_object& obj ){ obj.balance = 10; } );
+      db.modify( ids[3](db), []( account_balance_object& obj ){ obj.balance = 40; } );
+      db.remove( ids[4](db) );
+      const auto& created = db.create<account_balance_object>( []( account_balance_object& obj ){
+         obj.owner = account_id_type(6);
+         obj.balance = 100;
+      });
+      BOOST_CHECK_EQUAL( 12, sums.sum );
+
+      BOOST_CHECK( sums.populate( 100 ) );
+      BOOST_CHECK( sums.is_populated() );
+      BOOST_CHECK_EQUAL( 155, sums.sum );
+
+      // once populated, every change is tracked
+      db.remove( created );
+      BOOST_CHECK_EQUAL( 55, sums.sum );
+      BOOST_CHECK( sums.populate( 1 ) );
+      BOOST_CHECK_EQUAL( 55, sums.sum );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( static_modify_test )
+{
+   try {
+      static_assert( std::is_same< primary_index_of<account_balance_object>::type,
+                                   primary_index<account_balance_index> >::value, "unexpected index type" );
+      static_assert( std::is_void< primary_index_of<proposal_object>::type >::value, "unexpected index type" );
+
+      database db;
+      const auto& bal_obj = db.create<account_balance_object>( []( account_balance_object& obj ){
+          obj.owner = account_id_type(3);
+          obj.asset_type = asset_id_type(1);
+          obj.balance = 1;
+      });
+      const auto& by_account = db.get_index_type< primary_index<account_balance_index> >()
+                                 .get_secondary_index< balances_by_account_index >();
+      {
+         auto ses = db._undo_db.start_undo_session();
+         db.modify( bal_obj, []( account_balance_object& obj ){ obj.balance = 2; } );
+         BOOST_CHECK_EQUAL( 2, bal_obj.balance.value );
+         BOOST_CHECK( by_account.get_account_balance( account_id_type(3), asset_id_type(1) ) == &bal_obj );
+         BOOST_CHECK_EQUAL( 1u, db._undo_db.head().old_values.size() );
+         ses.undo();
+      }
+      BOOST_CHECK_EQUAL( 1, bal_obj.balance.value );
+
+      // exceptions thrown by the lambda are propagated
+      BOOST_CHECK_THROW( db.modify( bal_obj, []( account_balance_object& obj ){ FC_ASSERT( false ); } ),
+                         fc::assert_exception );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( incremental_flush_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const auto delta_dir = data_dir.path() / "object_database" / "delta";
+      account_balance_id_type bal1_id;
+      account_balance_id_type bal2_id;
+      account_balance_id_type bal3_id;
+      {
+         database db1;
+         db1.enable_incremental_flush( true );
+         db1.object_database::open( data_dir.path() );
+         bal1_id = db1.create<account_balance_object>( []( account_balance_object& obj ){
+             obj.owner = account_id_type(1);
+             obj.balance = 10;
+         }).id;
+         bal2_id = db1.create<account_balance_object>( []( account_balance_object& obj ){
+             obj.owner = account_id_type(2);
+             obj.balance = 20;
+         }).id;
+         // nothing on disk yet, so this is a full flush
+         db1.flush();
+         BOOST_CHECK( !fc::exists( delta_dir ) );
+
+         db1.modify( bal1_id(db1), []( account_balance_object& obj ){ obj.balance = 11; } );
+         db1.remove( bal2_id(db1) );
+         bal3_id = db1.create<account_balance_object>( []( account_balance_object& obj ){
+             obj.owner = account_id_type(3);
+             obj.balance = 30;
+         }).id;
+         db1.flush();
+         BOOST_CHECK( fc::exists( delta_dir / "1" ) );
+      }
+      {
+         database db2;
+         db2.object_database::open( data_dir.path() );
+         BOOST_CHECK_EQUAL( 11, bal1_id(db2).balance.value );
+         BOOST_CHECK( db2.find( bal2_id ) == nullptr );
+         BOOST_REQUIRE( db2.find( bal3_id ) != nullptr );
+         BOOST_CHECK_EQUAL( 30, bal3_id(db2).balance.value );
+         BOOST_CHECK( db2.get_index_type< account_balance_index >().get_next_id() == object_id_type( bal3_id ) + 1 );
+         const auto& by_account = db2.get_index_type< primary_index<account_balance_index> >()
+                                     .get_secondary_index< balances_by_account_index >();
+         BOOST_CHECK( by_account.get_account_balance( account_id_type(2), asset_id_type() ) == nullptr );
+         BOOST_CHECK( by_account.get_account_balance( account_id_type(3), asset_id_type() ) == &bal3_id(db2) );
+
+         // without incremental mode, the deltas are compacted into a new full copy
+         db2.flush();
+         BOOST_CHECK( !fc::exists( delta_dir ) );
+      }
+      {
+         database db3;
+         db3.object_database::open( data_dir.path() );
+         BOOST_CHECK_EQUAL( 11, bal1_id(db3).balance.value );
+         BOOST_CHECK( db3.find( bal2_id ) == nullptr );
+         BOOST_CHECK_EQUAL( 30, bal3_id(db3).balance.value );
+      }
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( object_version_test )
+{
+   try {
+      typedef primary_index< account_balance_index > balance_index_type;
+      const auto& balances = db.get_index_type< balance_index_type >();
+      const auto version = balances.get_object_version();
+      BOOST_CHECK( version == balances.get_object_version() );
+      BOOST_CHECK( version != db.get_index_type< primary_index< account_index > >().get_object_version() );
+      BOOST_CHECK( version != db.get_index_type< primary_index< account_statistics_index > >().get_object_version() );
+
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const auto index_file = data_dir.path() / "object_database" / fc::to_string( account_balance_object::space_id )
+                                              / fc::to_string( account_balance_object::type_id );
+      const fc::sha256 old_version = fc::sha256::hash( std::string( "old account balance format" ) );
+      account_balance_object bal;
+      bal.id = account_balance_id_type(0);
+      bal.owner = account_id_type(1);
+      bal.balance = 10;
+      {
+         fc::create_directories( index_file.parent_path() );
+         std::ofstream out( index_file.generic_string(), std::ofstream::binary );
+         fc::raw::pack( out, object_id_type( account_balance_id_type(1) ) );
+         fc::raw::pack( out, old_version );
+         fc::raw::pack( out, fc::raw::pack( bal ) );
+      }
+
+      {
+         database db1;
+         GRAPHENE_REQUIRE_THROW( db1.object_database::open( data_dir.path() ), fc::exception );
+      }
+      {
+         database db2;
+         auto& idx = const_cast< balance_index_type& >( db2.get_index_type< balance_index_type >() );
+         idx.add_migration( old_version, []( fc::datastream<const char*>& ds, account_balance_object& obj ) {
+            fc::raw::unpack( ds, obj );
+            obj.balance *= 2;
+         });
+         db2.object_database::open( data_dir.path() );
+         BOOST_REQUIRE( db2.find( bal.id ) != nullptr );
+         BOOST_CHECK_EQUAL( 20, bal.id(db2).balance.value );
+         BOOST_CHECK( bal.id(db2).owner == account_id_type(1) );
+         BOOST_CHECK( idx.get_next_id() == object_id_type( account_balance_id_type(1) ) );
+      }
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( index_memory_usage_test )
+{
+   try {
+      database db1;
+      const auto balance_usage = [&db1]() {
+         for( const auto& usage : db1.get_memory_usage() )
+            if( usage.space_id == account_balance_object::space_id && usage.type_id == account_balance_object::type_id )
+               return usage;
+         BOOST_FAIL( "no memory usage reported for account balances" );
+         return index_memory_usage();
+      };
+
+      const auto empty = balance_usage();
+      BOOST_CHECK_EQUAL( 0u, empty.object_count );
+      BOOST_CHECK_EQUAL( 0u, empty.object_bytes );
+      BOOST_CHECK_EQUAL( 0u, empty.undo_bytes );
+
+      const auto& bal = db1.create<account_balance_object>( []( account_balance_object& obj ){
+          obj.owner = account_id_type(1);
+          obj.balance = 10;
+      });
+      const auto filled = balance_usage();
+      BOOST_CHECK_EQUAL( 1u, filled.object_count );
+      BOOST_CHECK_GE( filled.object_bytes, sizeof(account_balance_object) );
+      BOOST_CHECK_GT( filled.secondary_index_bytes, empty.secondary_index_bytes );
+      BOOST_CHECK_EQUAL( 0u, filled.undo_bytes );
+
+      {
+         auto session = db1._undo_db.start_undo_session( true );
+         db1.modify( bal, []( account_balance_object& obj ){ obj.balance = 11; } );
+         BOOST_CHECK_GE( balance_usage().undo_bytes, filled.object_bytes );
+      }
+      BOOST_CHECK_EQUAL( 0u, balance_usage().undo_bytes );
+      BOOST_CHECK_EQUAL( 10, bal.balance.value );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( maintenance_profile_test )
+{
+   try {
+      db.set_maintenance_profile_history( 2 );
+      for( int i = 0; i < 3; ++i )
+      {
+         generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+         generate_block();
+      }
+
+      const auto& profiles = db.get_maintenance_profiles();
+      BOOST_REQUIRE_EQUAL( 2u, profiles.size() );
+      BOOST_CHECK_LT( profiles[0].block_num, profiles[1].block_num );
+
+      const maintenance_profile& latest = profiles.back();
+      BOOST_CHECK( latest.timestamp <= db.head_block_time() );
+      uint64_t phase_microseconds = 0;
+      const maintenance_phase_profile* witnesses = nullptr;
+      const maintenance_phase_profile* tally = nullptr;
+      for( const auto& phase : latest.phases )
+      {
+         phase_microseconds += phase.microseconds;
+         if( phase.name == "update_active_witnesses" )
+            witnesses = &phase;
+         else if( phase.name == "vote_tally" )
+            tally = &phase;
+      }
+      BOOST_CHECK_GE( latest.microseconds, phase_microseconds );
+      BOOST_REQUIRE( witnesses != nullptr );
+      BOOST_CHECK_EQUAL( witnesses->objects_visited, db.get_index<witness_object>().object_count() );
+      // the global properties are modified with the new active witnesses
+      BOOST_CHECK_GT( witnesses->objects_modified, 0u );
+      BOOST_REQUIRE( tally != nullptr );
+
+      db.set_maintenance_profile_history( 1 );
+      BOOST_CHECK_EQUAL( 1u, db.get_maintenance_profiles().size() );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( balances_by_account_index_test )
+{
+   try {
+      database db;
+      const auto& by_account = db.get_index_type< primary_index<account_balance_index> >()
+                                 .get_secondary_index< balances_by_account_index >();
+      const auto create_balance = [&db]( account_id_type owner, asset_id_type type ) -> const account_balance_object& {
+         return db.create<account_balance_object>( [owner,type]( account_balance_object& obj ){
+            obj.owner = owner;
+            obj.asset_type = type;
+            obj.balance = 1;
+         });
+      };
+      const account_id_type far_away( 3000000 );
+      const auto& uia = create_balance( far_away, asset_id_type(5) );
+      const auto& other_uia = create_balance( far_away, asset_id_type(2) );
+      const auto& core = create_balance( far_away, asset_id_type() );
+      create_balance( account_id_type(7), asset_id_type(2) );
+
+      BOOST_CHECK( by_account.get_account_balance( far_away, asset_id_type() ) == &core );
+      BOOST_CHECK( by_account.get_account_balance( far_away, asset_id_type(2) ) == &other_uia );
+      BOOST_CHECK( by_account.get_account_balance( far_away, asset_id_type(3) ) == nullptr );
+      BOOST_CHECK( by_account.get_account_balance( account_id_type(7), asset_id_type() ) == nullptr );
+      BOOST_CHECK( by_account.get_account_balance( account_id_type(4000000), asset_id_type() ) == nullptr );
+      BOOST_CHECK( by_account.get_account_balance( account_id_type(4000000), asset_id_type(2) ) == nullptr );
+
+      // sorted by asset, CORE first
+      auto balances = by_account.get_account_balances( far_away );
+      BOOST_REQUIRE_EQUAL( 3u, balances.size() );
+      BOOST_CHECK( balances.begin()->second == &core );
+      BOOST_CHECK( ( balances.begin() + 1 )->second == &other_uia );
+      BOOST_CHECK( ( balances.begin() + 2 )->second == &uia );
+      BOOST_CHECK( by_account.get_account_balances( account_id_type(8) ).empty() );
+
+      db.remove( core );
+      db.remove( uia );
+      BOOST_CHECK( by_account.get_account_balance( far_away, asset_id_type() ) == nullptr );
+      balances = by_account.get_account_balances( far_away );
+      BOOST_REQUIRE_EQUAL( 1u, balances.size() );
+      BOOST_CHECK( balances.begin()->second == &other_uia );
+      BOOST_CHECK_GE( by_account.memory_usage(), 3000001u * sizeof(void*) );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( resolved_asset_test )
+{
+   try {
+      database db;
+      auto ses = db._undo_db.start_undo_session();
+      const auto& dyn = db.create<asset_dynamic_data_object>( []( asset_dynamic_data_object& ){} );
+      const auto& bad = db.create<asset_bitasset_data_object>( []( asset_bitasset_data_object& ){} );
+      const auto& mia = db.create<asset_object>( [&dyn,&bad]( asset_object& a ){
+         a.symbol = "RESOLVED";
+         a.dynamic_asset_data_id = dyn.id;
+         a.bitasset_data_id = asset_bitasset_data_id_type( bad.id );
+      });
+      const asset_id_type mia_id = mia.get_id();
+
+      resolved_asset resolved = db.get_resolved_asset( mia_id );
+      BOOST_CHECK( resolved.asset == &mia );
+      BOOST_CHECK( resolved.dynamic_data == &dyn );
+      BOOST_CHECK( resolved.bitasset_data == &bad );
+
+      // a UIA has no bitasset data
+      const auto& uia_dyn = db.create<asset_dynamic_data_object>( []( asset_dynamic_data_object& ){} );
+      const auto& uia = db.create<asset_object>( [&uia_dyn]( asset_object& a ){
+         a.symbol = "RESOLVEDUIA";
+         a.dynamic_asset_data_id = uia_dyn.id;
+      });
+      resolved = db.get_resolved_asset( uia.get_id() );
+      BOOST_CHECK( resolved.asset == &uia );
+      BOOST_CHECK( resolved.dynamic_data == &uia_dyn );
+      BOOST_CHECK( resolved.bitasset_data == nullptr );
+
+      // the entries follow the assets when changes are undone
+      ses.undo();
+      BOOST_CHECK_THROW( db.get_resolved_asset( mia_id ), fc::exception );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( buffered_balance_deltas_test )
+{
+   try {
+      ACTORS( (maker1)(maker2)(maker3)(taker) );
+      const asset_id_type uia_id = create_user_issued_asset( "BUFFER" ).get_id();
+      for( const account_object* maker : { &maker1, &maker2, &maker3 } )
+      {
+         issue_uia( *maker, asset( 100, uia_id ) );
+         fund( *maker, asset( 1 ) );
+         BOOST_REQUIRE( create_sell_order( *maker, asset( 100, uia_id ), asset( 100 ) ) );
+      }
+      fund( taker, asset( 1000 ) );
+
+      // the taker is paid by three fills, but every balance is written once
+      auto& counter = *db.add_secondary_index< primary_index<account_balance_index>, modification_counter_index >();
+      BOOST_CHECK( !create_sell_order( taker, asset( 300 ), asset( 300, uia_id ) ) );
+      for( const auto& item : counter.modifications )
+         BOOST_CHECK_EQUAL( 1u, item.second );
+      // the core balances of the taker and the makers, and the new balance of the taker after it was created
+      BOOST_CHECK_EQUAL( 5u, counter.modifications.size() );
+
+      BOOST_CHECK_EQUAL( 700, get_balance( taker_id, asset_id_type() ) );
+      BOOST_CHECK_EQUAL( 300, get_balance( taker_id, uia_id ) );
+      for( const account_id_type maker_id : { maker1_id, maker2_id, maker3_id } )
+      {
+         BOOST_CHECK_EQUAL( 101, get_balance( maker_id, asset_id_type() ) );
+         BOOST_CHECK_EQUAL( 0, get_balance( maker_id, uia_id ) );
+      }
+
+      // the checks of sufficient balances include the changes of the operation
+      GRAPHENE_REQUIRE_THROW( create_sell_order( taker, asset( 701 ), asset( 701, uia_id ) ), fc::exception );
+      BOOST_CHECK_EQUAL( 700, get_balance( taker_id, asset_id_type() ) );
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( direct_index_test )
 { try {
    try {
@@ -223,6 +943,56 @@ BOOST_AUTO_TEST_CASE( direct_index_test )
    // but the secondary has not updated its representation
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( flat_direct_index_test )
+{ try {
+   graphene::db::object_database local_db; // keep the undo history of the fixture clean
+   graphene::db::primary_index< account_index, 4, graphene::db::flat_direct_index > my_accounts( local_db );
+   const auto& direct = my_accounts.get_secondary_index<graphene::db::flat_direct_index< account_object, 4 >>();
+   BOOST_CHECK_EQUAL( 0u, direct.size() );
+   BOOST_CHECK( nullptr == direct.find( account_id_type( 1 ) ) );
+   BOOST_CHECK_THROW( direct.find( object_id_type( asset_id_type( 1 ) ) ), fc::assert_exception );
+   BOOST_CHECK_THROW( direct.get( account_id_type( 1 ) ), fc::assert_exception );
+
+   account_object test_account;
+   test_account.id = account_id_type(1);
+   test_account.name = "account1";
+   my_accounts.load( fc::raw::pack( test_account ) );
+
+   // large holes are fine
+   test_account.id = account_id_type(1000);
+   test_account.name = "account1000";
+   my_accounts.load( fc::raw::pack( test_account ) );
+
+   BOOST_CHECK_EQUAL( 2u, direct.size() );
+   BOOST_CHECK( nullptr == direct.find( account_id_type( 0 ) ) );
+   BOOST_CHECK( nullptr == direct.find( account_id_type( 999 ) ) );
+   BOOST_CHECK( nullptr == direct.find( account_id_type( 5000 ) ) );
+   BOOST_CHECK_EQUAL( "account1", direct.get( account_id_type(1) ).name );
+   BOOST_CHECK_EQUAL( "account1000", direct.get( account_id_type(1000) ).name );
+   BOOST_CHECK( my_accounts.find( account_id_type(1000) ) == &direct.get( account_id_type(1000) ) );
+
+   // handles are invalidated by removal, and stay invalid if the id is reused
+   const auto handle1 = direct.get_handle( account_id_type(1) );
+   BOOST_CHECK( direct.find( handle1 ) == &direct.get( account_id_type(1) ) );
+   my_accounts.remove( direct.get( account_id_type(1) ) );
+   BOOST_CHECK_EQUAL( 1u, direct.size() );
+   BOOST_CHECK( nullptr == direct.find( handle1 ) );
+   BOOST_CHECK( nullptr == direct.find( account_id_type( 1 ) ) );
+
+   test_account.id = account_id_type(1);
+   test_account.name = "account1";
+   my_accounts.load( fc::raw::pack( test_account ) );
+   BOOST_CHECK( nullptr == direct.find( handle1 ) );
+   const auto handle2 = direct.get_handle( account_id_type(1) );
+   BOOST_CHECK( direct.find( handle2 ) == &direct.get( account_id_type(1) ) );
+   BOOST_CHECK_THROW( direct.get_handle( account_id_type(2) ), fc::assert_exception );
+
+   GRAPHENE_REQUIRE_THROW( my_accounts.modify( direct.get( account_id_type( 1 ) ), [] ( object& acct ) {
+      acct.id = account_id_type(2);
+   }), fc::assert_exception );
+   // This is actually undefined behaviour, see direct_index_test
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( required_approval_index_test ) // see https://github.com/bitshares/bitshares-core/issues/1719
 { try {
    ACTORS( (alice)(bob)(charlie)(agnetha)(benny)(carlos) );
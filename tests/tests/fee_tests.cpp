@@ -684,6 +684,53 @@ REG : net' ltm' ref'
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( batched_cashback_test )
+{ try {
+   // After the hard fork the fee payouts of the maintenance interval are batched
+   generate_blocks( HARDFORK_CORE_2262_TIME );
+   generate_block();
+   set_expiration( db, trx );
+
+   ACTORS((reg));
+   fund( reg, asset(100000000) );
+   upgrade_to_lifetime_member( reg_id );
+
+   const auto alice_key = generate_private_key( "alice" );
+   const auto bob_key = generate_private_key( "bob" );
+   account_id_type alice_id = create_account( "alice", alice_key, reg_id, reg_id ).id;
+   account_id_type bob_id = create_account( "bob", bob_key, reg_id, reg_id ).id;
+   transfer( reg_id, alice_id, asset(1000000) );
+   transfer( reg_id, bob_id, asset(1000000) );
+   transfer( alice_id, bob_id, asset(1000) );
+   transfer( bob_id, alice_id, asset(2000) );
+   transfer( alice_id, reg_id, asset(3000) );
+   generate_block();
+
+   // All fees go to reg, except for the network cut
+   BOOST_REQUIRE( reg_id(db).cashback_vb.valid() );
+   const vesting_balance_id_type reg_vb_id = *reg_id(db).cashback_vb;
+   int64_t expected_cashback = GET_CASHBACK_BALANCE( reg_id(db) );
+   for( const account_id_type id : { reg_id, alice_id, bob_id } )
+   {
+      const account_object& acct = id(db);
+      const account_statistics_object& stats = acct.statistics(db);
+      BOOST_CHECK( stats.has_pending_fees() );
+      for( const share_type fee : { stats.pending_fees, stats.pending_vested_fees } )
+         expected_cashback += fee.value - pct( acct.network_fee_percentage, fee.value );
+   }
+
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+
+   BOOST_REQUIRE( reg_id(db).cashback_vb.valid() );
+   BOOST_CHECK( *reg_id(db).cashback_vb == reg_vb_id );
+   BOOST_CHECK_EQUAL( GET_CASHBACK_BALANCE( reg_id(db) ), expected_cashback );
+   BOOST_CHECK( !alice_id(db).cashback_vb.valid() );
+   BOOST_CHECK( !bob_id(db).cashback_vb.valid() );
+   for( const account_id_type id : { reg_id, alice_id, bob_id } )
+      BOOST_CHECK( !id(db).statistics(db).has_pending_fees() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( account_create_fee_scaling )
 { try {
    auto accounts_per_scale = db.get_global_properties().parameters.accounts_per_fee_scale;
@@ -3660,6 +3707,32 @@ BOOST_AUTO_TEST_CASE( defaults_test )
   }
 }
 
+BOOST_AUTO_TEST_CASE( fee_index_test )
+{ try {
+   fee_schedule schedule = fee_schedule::get_default();
+   const transfer_operation::fee_parameters_type default_transfer_fee {};
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( transfer_operation() ).amount.value, (int64_t)default_transfer_fee.fee );
+   BOOST_CHECK( schedule.exists<transfer_operation>() );
+   BOOST_CHECK( schedule.find( operation::tag<transfer_operation>::value )
+                == &*schedule.parameters.find( transfer_operation::fee_parameters_type() ) );
+
+   // entries which are moved without updating the index are still found
+   schedule.parameters.erase( schedule.parameters.begin() );
+   BOOST_CHECK( !schedule.exists<transfer_operation>() );
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( limit_order_create_operation() ).amount.value,
+                      (int64_t)limit_order_create_operation::fee_parameters_type().fee );
+   transfer_operation::fee_parameters_type new_transfer_fee;
+   new_transfer_fee.fee = 123;
+   schedule.parameters.insert( new_transfer_fee );
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( transfer_operation() ).amount.value, 123 );
+
+   schedule.update_index();
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( transfer_operation() ).amount.value, 123 );
+   schedule.parameters.clear();
+   BOOST_CHECK( schedule.find( operation::tag<transfer_operation>::value ) == nullptr );
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( transfer_operation() ).amount.value, (int64_t)default_transfer_fee.fee );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( sub_asset_creation_fee_test )
 { try {
    fee_schedule schedule;
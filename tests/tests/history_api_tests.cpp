@@ -93,6 +93,338 @@ BOOST_AUTO_TEST_CASE(get_account_history) {
    }
 }
 
+BOOST_AUTO_TEST_CASE(get_packed_account_history) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      create_bitasset("USD", account_id_type());
+      create_account( "dan", account_id_type()(db), GRAPHENE_WITNESS_ACCOUNT(db) );
+
+      generate_block();
+      fc::usleep(fc::milliseconds(2000));
+
+      vector<operation_history_object> histories = hist_api.get_account_history("1.2.0", operation_history_id_type(),
+                                                      100, operation_history_id_type());
+      vector<vector<char>> packed = hist_api.get_packed_account_history("1.2.0", operation_history_id_type(),
+                                                      100, operation_history_id_type());
+
+      BOOST_REQUIRE_EQUAL(packed.size(), histories.size());
+      BOOST_REQUIRE_EQUAL(packed.size(), 2u);
+      for( size_t i = 0; i < packed.size(); ++i )
+      {
+         const auto unpacked = fc::raw::unpack<operation_history_object>( packed[i] );
+         BOOST_CHECK( unpacked.id == histories[i].id );
+         BOOST_CHECK_EQUAL( unpacked.op.which(), histories[i].op.which() );
+         BOOST_CHECK_EQUAL( unpacked.block_num, histories[i].block_num );
+      }
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(get_account_history_batch) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      ACTORS( (alice)(bob)(carol) );
+      transfer( account_id_type(), alice_id, asset(10000000) );
+      transfer( alice_id, bob_id, asset(100) );
+      transfer( account_id_type(), carol_id, asset(10000000) );
+      transfer( alice_id, bob_id, asset(100) );
+
+      generate_block();
+      fc::usleep(fc::milliseconds(2000));
+
+      using cursors_type = vector< std::pair<std::string,uint64_t> >;
+      // an operation of several accounts is listed once
+      auto batch = hist_api.get_account_history_batch( cursors_type{ { "alice", 0 }, { "bob", 0 }, { "nobody", 0 } } );
+      BOOST_REQUIRE_EQUAL( batch.accounts.size(), 2u );
+      const auto alice_ops = hist_api.get_relative_account_history( "alice", 0, 100, 0 );
+      BOOST_REQUIRE_EQUAL( batch.accounts[0].operations.size(), alice_ops.size() );
+      BOOST_CHECK_EQUAL( batch.accounts[0].sequence, alice_ops.size() );
+      BOOST_CHECK( batch.accounts[0].complete );
+      BOOST_CHECK_EQUAL( batch.accounts[1].operations.size(), 3u ); // account creation and two transfers
+      BOOST_CHECK_EQUAL( batch.operations.size(), alice_ops.size() + 1 );
+      for( size_t i = 1; i < batch.operations.size(); ++i )
+         BOOST_CHECK( batch.operations[i-1].id < batch.operations[i].id );
+
+      // continue from the cursors with a small limit
+      cursors_type cursors{ { "alice", 0 }, { "bob", 0 }, { "carol", 0 } };
+      std::set<operation_history_id_type> seen;
+      size_t calls = 0;
+      while( true )
+      {
+         batch = hist_api.get_account_history_batch( cursors, 2 );
+         BOOST_REQUIRE_EQUAL( batch.accounts.size(), 3u );
+         BOOST_CHECK_LE( batch.operations.size(), 2u );
+         for( const auto& op : batch.operations )
+            BOOST_CHECK( seen.insert( op.id ).second );
+         bool complete = true;
+         for( size_t i = 0; i < cursors.size(); ++i )
+         {
+            cursors[i].second = batch.accounts[i].sequence;
+            complete = complete && batch.accounts[i].complete;
+         }
+         ++calls;
+         if( complete )
+            break;
+         BOOST_REQUIRE_LT( calls, 20u );
+      }
+      BOOST_CHECK_GT( calls, 1u );
+      BOOST_CHECK_EQUAL( cursors[0].second, alice_ops.size() );
+      BOOST_CHECK_EQUAL( cursors[1].second, 3u );
+
+      // nothing is new
+      batch = hist_api.get_account_history_batch( cursors );
+      BOOST_CHECK( batch.operations.empty() );
+
+      GRAPHENE_CHECK_THROW( hist_api.get_account_history_batch( cursors, 101 ), fc::exception );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(get_block_operations) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      ACTORS( (alice)(bob) );
+      const auto& uia = create_user_issued_asset( "UIA" );
+      issue_uia( bob_id, uia.amount(1000) );
+      transfer( account_id_type(), alice_id, asset(10000) );
+      generate_block();
+
+      create_sell_order( alice_id, asset(100), uia.amount(100) );
+      create_sell_order( bob_id, uia.amount(100), asset(100) );
+      transfer( alice_id, bob_id, asset(10) );
+      generate_block();
+
+      const auto ops = hist_api.get_block_operations( db.head_block_num() );
+      // two order creations, two fills and a transfer
+      BOOST_REQUIRE_EQUAL( ops.size(), 5u );
+      size_t fills = 0;
+      for( const auto& o : ops )
+      {
+         BOOST_CHECK_EQUAL( o.block_num, db.head_block_num() );
+         if( o.op.is_type<fill_order_operation>() )
+         {
+            BOOST_CHECK_GT( o.virtual_op, 0u );
+            ++fills;
+         }
+      }
+      BOOST_CHECK_EQUAL( fills, 2u );
+      BOOST_REQUIRE( ops[0].op.is_type<limit_order_create_operation>() );
+      BOOST_REQUIRE( ops[0].result.is_type<object_id_type>() );
+      BOOST_CHECK( ops.back().op.is_type<transfer_operation>() );
+
+      // an earlier block
+      const auto earlier_ops = hist_api.get_block_operations( db.head_block_num() - 1 );
+      BOOST_CHECK( !earlier_ops.empty() );
+      BOOST_CHECK( earlier_ops.back().op.is_type<transfer_operation>() );
+
+      // a block which does not exist yet
+      GRAPHENE_CHECK_THROW( hist_api.get_block_operations( db.head_block_num() + 1 ), fc::exception );
+
+      // a block which was popped and replaced by another one
+      const uint32_t num = db.head_block_num();
+      const block_id_type popped_id = db.head_block_id();
+      db.pop_block();
+      generate_block( ~0, init_account_priv_key, 1 );
+      BOOST_REQUIRE_EQUAL( db.head_block_num(), num );
+      BOOST_CHECK( db.head_block_id() != popped_id );
+      const auto replaced_ops = hist_api.get_block_operations( num );
+      const auto replacement = db.fetch_block_by_number( num );
+      BOOST_REQUIRE( replacement.valid() );
+      size_t real_ops = 0;
+      for( const auto& trx : replacement->transactions )
+         real_ops += trx.operations.size();
+      size_t stored_real_ops = 0;
+      for( const auto& o : replaced_ops )
+      {
+         BOOST_CHECK_EQUAL( o.block_num, num );
+         if( o.virtual_op == 0 )
+            ++stored_real_ops;
+      }
+      BOOST_CHECK_EQUAL( stored_real_ops, real_ops );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(account_history_store) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      ACTORS( (alice)(bob) );
+      transfer( account_id_type(), alice_id, asset(100000) );
+      generate_block();
+      for( int i = 0; i < 30; ++i )
+      {
+         transfer( alice_id, bob_id, asset(10 + i) );
+         if( i % 7 == 0 )
+            generate_block();
+      }
+      generate_block();
+
+      // only 5 entries are in memory, the others are served from the store
+      const auto& stats = alice_id(db).statistics(db);
+      BOOST_REQUIRE_GT( stats.removed_ops, 0u );
+      BOOST_CHECK_EQUAL( stats.total_ops - stats.removed_ops, 5u );
+
+      vector<operation_history_object> histories = hist_api.get_account_history("alice", operation_history_id_type(),
+                                                      100, operation_history_id_type());
+      BOOST_REQUIRE_EQUAL( histories.size(), stats.total_ops );
+      for( size_t i = 1; i < histories.size(); ++i )
+         BOOST_CHECK( histories[i].id.instance() < histories[i-1].id.instance() );
+      BOOST_CHECK( histories.back().op.is_type<account_create_operation>() );
+      BOOST_REQUIRE( histories[10].op.is_type<transfer_operation>() );
+      BOOST_CHECK_EQUAL( histories[10].op.get<transfer_operation>().amount.amount.value, 10 + 30 - 11 );
+
+      // pages which start in the store and stop in it
+      vector<operation_history_object> page = hist_api.get_account_history("alice",
+                                                      operation_history_id_type(histories[20].id.instance()), 5,
+                                                      operation_history_id_type(histories[12].id.instance()));
+      BOOST_REQUIRE_EQUAL( page.size(), 5u );
+      for( size_t i = 0; i < page.size(); ++i )
+         BOOST_CHECK( page[i].id == histories[12 + i].id );
+      page = hist_api.get_account_history("alice", operation_history_id_type(histories[20].id.instance()), 100,
+                                          operation_history_id_type(histories[12].id.instance()));
+      BOOST_CHECK_EQUAL( page.size(), 8u );
+
+      // sequence numbers in memory and in the store
+      page = hist_api.get_relative_account_history("alice", 1, 100, 0);
+      BOOST_REQUIRE_EQUAL( page.size(), histories.size() );
+      for( size_t i = 0; i < page.size(); ++i )
+         BOOST_CHECK( page[i].id == histories[i].id );
+      page = hist_api.get_relative_account_history("alice", 3, 4, stats.removed_ops + 2);
+      BOOST_REQUIRE_EQUAL( page.size(), 4u );
+      BOOST_CHECK( page[0].id == histories[stats.total_ops - stats.removed_ops - 2].id );
+
+      // a removed entry which is brought back by popping a block is served from memory again
+      const uint64_t removed_before = stats.removed_ops;
+      transfer( alice_id, bob_id, asset(1) );
+      generate_block();
+      BOOST_CHECK_EQUAL( alice_id(db).statistics(db).removed_ops, removed_before + 1 );
+      db.pop_block();
+      BOOST_CHECK_EQUAL( alice_id(db).statistics(db).removed_ops, removed_before );
+      transfer( alice_id, bob_id, asset(2) );
+      transfer( alice_id, bob_id, asset(3) );
+      generate_block();
+      histories = hist_api.get_account_history("alice", operation_history_id_type(), 100,
+                                               operation_history_id_type());
+      BOOST_REQUIRE_EQUAL( histories.size(), alice_id(db).statistics(db).total_ops );
+      for( size_t i = 1; i < histories.size(); ++i )
+         BOOST_CHECK( histories[i].id.instance() < histories[i-1].id.instance() );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(deferred_account_history_trimming) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      ACTORS( (alice)(bob) );
+      transfer( account_id_type(), alice_id, asset(100000) );
+      generate_block();
+      for( int i = 0; i < 10; ++i )
+         transfer( alice_id, bob_id, asset(10 + i) );
+      generate_block();
+
+      // the excess is removed in batches of 2 per block, over all accounts
+      auto metrics = hist_api.get_account_history_trim_metrics();
+      BOOST_CHECK_GT( metrics.backlog_accounts, 0u );
+      BOOST_CHECK_GT( metrics.backlog_entries, 0u );
+      const auto& alice_stats = alice_id(db).statistics(db);
+      BOOST_CHECK_GT( alice_stats.total_ops - alice_stats.removed_ops, 3u );
+
+      // the history is complete as far as it is in memory
+      vector<operation_history_object> histories = hist_api.get_account_history("alice", operation_history_id_type(),
+                                                      100, operation_history_id_type());
+      BOOST_CHECK_EQUAL( histories.size(), alice_stats.total_ops - alice_stats.removed_ops );
+
+      const uint64_t trimmed_before = metrics.trimmed_entries;
+      generate_block();
+      metrics = hist_api.get_account_history_trim_metrics();
+      BOOST_CHECK_EQUAL( metrics.trimmed_entries, trimmed_before + 2 );
+
+      // the maintenance block removes the whole backlog
+      generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+      metrics = hist_api.get_account_history_trim_metrics();
+      BOOST_CHECK_EQUAL( metrics.backlog_accounts, 0u );
+      BOOST_CHECK_EQUAL( metrics.backlog_entries, 0u );
+      BOOST_CHECK_EQUAL( alice_id(db).statistics(db).total_ops - alice_id(db).statistics(db).removed_ops, 3u );
+      BOOST_CHECK_EQUAL( bob_id(db).statistics(db).total_ops - bob_id(db).statistics(db).removed_ops, 3u );
+
+      histories = hist_api.get_account_history("alice", operation_history_id_type(), 100,
+                                               operation_history_id_type());
+      BOOST_REQUIRE_EQUAL( histories.size(), 3u );
+      BOOST_CHECK_EQUAL( histories[0].op.get<transfer_operation>().amount.amount.value, 19 );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(market_history_store) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      ACTORS( (buyer)(seller) );
+      const auto& core = asset_id_type()(db);
+      const asset_id_type test_id = create_user_issued_asset( "MYTEST" ).get_id();
+      issue_uia( seller, test_id(db).amount(1000) );
+      transfer( committee_account, buyer_id, asset(10000) );
+      generate_block();
+
+      // one trade in each of 5 buckets of 15 seconds, of which only the last ones are kept in memory
+      for( int i = 0; i < 5; ++i )
+      {
+         BOOST_REQUIRE( create_sell_order( seller, test_id(db).amount(10), core.amount(10 + i) ) );
+         create_sell_order( buyer, core.amount(10 + i), test_id(db).amount(10) );
+         generate_block();
+         generate_blocks( db.head_block_time() + 15 );
+      }
+
+      using namespace graphene::market_history;
+      const auto& bucket_idx = db.get_index_type<bucket_index>().indices().get<by_key>();
+      size_t in_memory = 0;
+      for( auto itr = bucket_idx.lower_bound( bucket_key( asset_id_type(), test_id, 15, fc::time_point_sec() ) );
+           itr != bucket_idx.end() && itr->key.quote == test_id && itr->key.seconds == 15; ++itr )
+         ++in_memory;
+      BOOST_CHECK_LT( in_memory, 5u );
+
+      vector<bucket_object> buckets = hist_api.get_market_history( "1.3.0", std::string( object_id_type( test_id ) ),
+                                                                   15, fc::time_point_sec(), db.head_block_time() );
+      BOOST_REQUIRE_EQUAL( buckets.size(), 5u );
+      for( int i = 0; i < 5; ++i )
+      {
+         BOOST_CHECK_EQUAL( buckets[i].base_volume.value, 10 + i );
+         BOOST_CHECK_EQUAL( buckets[i].quote_volume.value, 10 );
+         if( i > 0 )
+            BOOST_CHECK( buckets[i - 1].key.open < buckets[i].key.open );
+      }
+
+      // a range which ends before the buckets in memory is served from the store alone
+      buckets = hist_api.get_market_history( "1.3.0", std::string( object_id_type( test_id ) ), 15,
+                                             buckets[0].key.open, buckets[1].key.open );
+      BOOST_CHECK_EQUAL( buckets.size(), 2u );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE(get_account_history_notify_all_on_creation) {
    try {
       // Pass hard fork time
@@ -954,6 +954,39 @@ BOOST_AUTO_TEST_CASE( fee_calculations )
    }
 }
 
+BOOST_AUTO_TEST_CASE( preimage_digests )
+{
+   std::vector<char> preimage( 64 );
+   generate_random_preimage( 64, preimage );
+   const std::vector<char> other_preimage( 64, 'x' );
+
+   const vector<htlc_hash> hashes {
+      htlc_algo_ripemd160::hash( preimage.data(), preimage.size() ),
+      htlc_algo_sha1::hash( preimage.data(), preimage.size() ),
+      htlc_algo_sha256::hash( preimage.data(), preimage.size() ),
+      htlc_algo_hash160::hash( preimage.data(), preimage.size() )
+   };
+
+   htlc_redeem_operation redeem;
+   htlc_redeem_operation other_redeem;
+   redeem.preimage = preimage;
+   other_redeem.preimage = other_preimage;
+   for( int precomputed = 0; precomputed < 2; ++precomputed )
+   {
+      if( precomputed )
+      {
+         redeem.precompute_preimage_digests();
+         other_redeem.precompute_preimage_digests();
+         BOOST_REQUIRE( redeem._preimage_digests );
+      }
+      for( const auto& hash : hashes )
+      {
+         BOOST_CHECK( redeem.preimage_matches( hash ) );
+         BOOST_CHECK( !other_redeem.preimage_matches( hash ) );
+      }
+   }
+}
+
 BOOST_AUTO_TEST_CASE( htlc_blacklist )
 {
 try {
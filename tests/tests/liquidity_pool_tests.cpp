@@ -872,6 +872,22 @@ BOOST_AUTO_TEST_CASE( liquidity_pool_exchange_test )
       BOOST_CHECK_THROW( exchange_with_liquidity_pool( ted_id, lp_id, asset( 1000, eur_id ), asset( 585, usd_id ) ),
                          fc::exception );
 
+      // The quotes match the calculations
+      {
+         graphene::app::database_api db_api( db, &( app.get_options() ) );
+         auto quotes = db_api.get_liquidity_pool_exchange_quotes( lp_id, { asset( 1000, eur_id ) } );
+         BOOST_REQUIRE_EQUAL( quotes.size(), 1u );
+         BOOST_CHECK( quotes.front().maker_market_fee == asset( maker_fee, eur_id ) );
+         BOOST_CHECK( quotes.front().pool_receives == asset( delta_a, eur_id ) );
+         BOOST_CHECK( quotes.front().pool_pays == asset( -delta_b, usd_id ) );
+         BOOST_CHECK( quotes.front().pool_taker_fee == asset( pool_taker_fee, usd_id ) );
+         BOOST_CHECK( quotes.front().taker_market_fee == asset( taker_fee, usd_id ) );
+         BOOST_CHECK( quotes.front().account_receives == asset( ted_receives, usd_id ) );
+
+         BOOST_CHECK_THROW( db_api.get_liquidity_pool_exchange_quotes( lp_id, { asset( 100, core_id ) } ),
+                            fc::exception );
+      }
+
       // Setup market blacklists and whitelists
       {
          asset_update_operation auop;
@@ -1347,6 +1363,91 @@ BOOST_AUTO_TEST_CASE( liquidity_pool_exchange_test )
 
 } FC_CAPTURE_LOG_AND_RETHROW( (0) ) }
 
+BOOST_AUTO_TEST_CASE( liquidity_pool_history_compaction_test )
+{ try {
+
+      // Pass the hard fork time and start at the beginning of an hour
+      generate_blocks( HARDFORK_LIQUIDITY_POOL_TIME );
+      const uint32_t hour = 3600;
+      const fc::time_point_sec h0( ( db.head_block_time().sec_since_epoch() / hour + 1 ) * hour );
+      generate_blocks( h0 );
+      set_expiration( db, trx );
+
+      ACTORS((sam));
+
+      const asset_object& eur = create_user_issued_asset( "MYEUR", sam, charge_market_fee );
+      const asset_object& usd = create_user_issued_asset( "MYUSD", sam, charge_market_fee );
+      const asset_object& lpa = create_user_issued_asset( "LPATEST", sam, charge_market_fee );
+      const asset_id_type eur_id = eur.id;
+      const asset_id_type usd_id = usd.id;
+      issue_uia( sam, eur.amount(1000000) );
+      issue_uia( sam, usd.amount(1000000) );
+
+      // 1:create, 2:deposit in the 1st block, 3:exchange, 4:exchange in the 2nd block
+      const liquidity_pool_id_type lp_id = create_liquidity_pool( sam_id, eur_id, usd_id, lpa.id, 0, 0 ).id;
+      deposit_to_liquidity_pool( sam_id, lp_id, asset( 1000, eur_id ), asset( 1200, usd_id ) );
+      generate_block();
+      exchange_with_liquidity_pool( sam_id, lp_id, asset( 100, eur_id ), asset( 1, usd_id ) );
+      exchange_with_liquidity_pool( sam_id, lp_id, asset( 100, eur_id ), asset( 1, usd_id ) );
+      generate_block();
+
+      graphene::app::history_api hist_api(app);
+      BOOST_CHECK( hist_api.get_liquidity_pool_history_intervals( lp_id ).empty() );
+
+      // 5 is kept in detail with 4, the others are rolled into the interval of the 1st hour
+      generate_blocks( h0 + hour );
+      set_expiration( db, trx );
+      deposit_to_liquidity_pool( sam_id, lp_id, asset( 100, eur_id ), asset( 1000, usd_id ) );
+      generate_block();
+
+      BOOST_CHECK_EQUAL( hist_api.get_liquidity_pool_history( lp_id ).size(), 2u );
+      auto intervals = hist_api.get_liquidity_pool_history_intervals( lp_id );
+      BOOST_REQUIRE_EQUAL( intervals.size(), 1u );
+      BOOST_CHECK( intervals[0].open == h0 );
+      BOOST_CHECK_EQUAL( intervals[0].seconds, hour );
+      BOOST_CHECK_EQUAL( intervals[0].min_sequence, 1u );
+      BOOST_CHECK_EQUAL( intervals[0].max_sequence, 3u );
+      BOOST_CHECK_EQUAL( intervals[0].other_count, 1u );
+      BOOST_CHECK_EQUAL( intervals[0].deposit_count, 1u );
+      BOOST_CHECK( intervals[0].deposit_amount_a == 1000u );
+      BOOST_CHECK( intervals[0].deposit_amount_b == 1200u );
+      BOOST_CHECK_EQUAL( intervals[0].exchange_a2b_count, 1u );
+      BOOST_CHECK( intervals[0].exchange_a2b_amount_a == 100u );
+      BOOST_CHECK_EQUAL( intervals[0].exchange_b2a_count, 0u );
+
+      // 4 is added to the interval of the 1st hour, 5 gets an interval of the 2nd hour
+      generate_blocks( h0 + 3 * hour );
+      set_expiration( db, trx );
+      deposit_to_liquidity_pool( sam_id, lp_id, asset( 100, eur_id ), asset( 1000, usd_id ) );
+      deposit_to_liquidity_pool( sam_id, lp_id, asset( 100, eur_id ), asset( 1000, usd_id ) );
+      generate_block();
+
+      intervals = hist_api.get_liquidity_pool_history_intervals( lp_id );
+      BOOST_REQUIRE_EQUAL( intervals.size(), 2u );
+      BOOST_CHECK( intervals[0].open == h0 + hour );
+      BOOST_CHECK_EQUAL( intervals[0].min_sequence, 5u );
+      BOOST_CHECK_EQUAL( intervals[0].deposit_count, 1u );
+      BOOST_CHECK( intervals[1].open == h0 );
+      BOOST_CHECK_EQUAL( intervals[1].max_sequence, 4u );
+      BOOST_CHECK_EQUAL( intervals[1].exchange_a2b_count, 2u );
+      // the range is (stop, start]
+      BOOST_CHECK_EQUAL( hist_api.get_liquidity_pool_history_intervals( lp_id, h0 ).size(), 1u );
+      BOOST_CHECK_EQUAL( hist_api.get_liquidity_pool_history_intervals( lp_id, {}, h0 ).size(), 1u );
+      BOOST_CHECK_EQUAL( hist_api.get_liquidity_pool_history_intervals( lp_id, {}, {}, 1 ).size(), 1u );
+
+      // only the 2 most recent intervals are kept
+      generate_blocks( h0 + 5 * hour );
+      set_expiration( db, trx );
+      deposit_to_liquidity_pool( sam_id, lp_id, asset( 100, eur_id ), asset( 1000, usd_id ) );
+      generate_block();
+
+      intervals = hist_api.get_liquidity_pool_history_intervals( lp_id );
+      BOOST_REQUIRE_EQUAL( intervals.size(), 1u );
+      BOOST_CHECK( intervals[0].open == h0 + 3 * hour );
+      BOOST_CHECK_EQUAL( intervals[0].min_sequence, 6u );
+
+} FC_CAPTURE_LOG_AND_RETHROW( (0) ) }
+
 BOOST_AUTO_TEST_CASE( liquidity_pool_apis_test )
 { try {
 
@@ -29,6 +29,8 @@
 #include <graphene/protocol/market.hpp>
 #include <graphene/chain/market_object.hpp>
 
+#include <graphene/market_history/market_history_plugin.hpp>
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -2459,4 +2461,52 @@ BOOST_AUTO_TEST_CASE(mcfr_rounding_test_after2481)
 
 } FC_LOG_AND_RETHROW() }
 
+/***
+ * Several maker fills of a market in one block are aggregated into the bucket
+ */
+BOOST_AUTO_TEST_CASE(market_history_bucket_of_fills_in_one_block)
+{ try {
+   ACTORS((buyer)(seller));
+
+   const auto& core = asset_id_type()(db);
+   const auto& test = create_user_issued_asset( "MYTEST" );
+   const asset_id_type test_id = test.get_id();
+   issue_uia( seller, test.amount(1000) );
+   transfer( committee_account, buyer_id, asset(10000) );
+   generate_block();
+
+   BOOST_REQUIRE( create_sell_order( seller, test.amount(100), core.amount(100) ) );
+   BOOST_REQUIRE( create_sell_order( seller, test.amount(100), core.amount(200) ) );
+   BOOST_REQUIRE( create_sell_order( seller, test.amount(100), core.amount(150) ) );
+   // fills the three orders of the seller, cheapest first, and stays on the book
+   BOOST_REQUIRE( create_sell_order( buyer, core.amount(600), test.amount(300) ) );
+
+   generate_block();
+
+   using namespace graphene::market_history;
+   const auto& bucket_idx = db.get_index_type<bucket_index>().indices().get<by_key>();
+   bucket_key key;
+   key.base = asset_id_type();
+   key.quote = test_id;
+   key.seconds = 15;
+   auto itr = bucket_idx.lower_bound( key );
+   BOOST_REQUIRE( itr != bucket_idx.end() );
+   BOOST_CHECK( itr->key.base == key.base );
+   BOOST_CHECK( itr->key.quote == key.quote );
+   BOOST_CHECK_EQUAL( itr->key.seconds, 15u );
+   BOOST_CHECK_EQUAL( itr->base_volume.value, 450 );
+   BOOST_CHECK_EQUAL( itr->quote_volume.value, 300 );
+   BOOST_CHECK_EQUAL( itr->open_base.value, 100 );
+   BOOST_CHECK_EQUAL( itr->open_quote.value, 100 );
+   BOOST_CHECK_EQUAL( itr->close_base.value, 200 );
+   BOOST_CHECK_EQUAL( itr->close_quote.value, 100 );
+   BOOST_CHECK_EQUAL( itr->high_base.value, 200 );
+   BOOST_CHECK_EQUAL( itr->high_quote.value, 100 );
+   BOOST_CHECK_EQUAL( itr->low_base.value, 100 );
+   BOOST_CHECK_EQUAL( itr->low_quote.value, 100 );
+   ++itr;
+   BOOST_CHECK( itr == bucket_idx.end() || itr->key.quote != test_id || itr->key.seconds != 15 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -25,6 +25,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/app/api.hpp>
+#include <graphene/app/transaction_submission_queue.hpp>
 #include <graphene/chain/hardfork.hpp>
 
 #include <fc/crypto/digest.hpp>
@@ -130,4 +131,66 @@ BOOST_AUTO_TEST_CASE( broadcast_transaction_too_large ) {
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( transaction_submission_queue_test ) {
+   try {
+
+      fc::ecc::private_key cid_key = fc::ecc::private_key::regenerate( fc::digest("key") );
+      const account_id_type cid_id = create_account( "cid", cid_key.get_public_key() ).id;
+      fund( cid_id(db) );
+
+      auto queue = std::make_shared< graphene::app::transaction_submission_queue >( db, 1, 10 );
+      generate_block();
+
+      transfer_operation trans;
+      trans.from = cid_id;
+      trans.to   = account_id_type();
+      trans.amount = asset(1);
+      auto make_trx = [&]( uint64_t amount ) {
+         signed_transaction t;
+         trans.amount = asset(amount);
+         t.operations.push_back( trans );
+         set_expiration( db, t );
+         return t;
+      };
+
+      // a valid transaction is pushed to the database after it was queued
+      signed_transaction trx1 = make_trx( 1 );
+      sign( trx1, cid_key );
+      auto pushed = queue->submit( trx1 );
+      // the queue is full until the first transaction is pushed
+      signed_transaction trx2 = make_trx( 2 );
+      sign( trx2, cid_key );
+      GRAPHENE_CHECK_THROW( queue->submit( trx2 ), fc::exception );
+      pushed.wait();
+      BOOST_CHECK( db.is_known_transaction( trx1.id() ) );
+
+      // an expired transaction
+      signed_transaction expired = make_trx( 3 );
+      expired.expiration = db.head_block_time() - 1;
+      sign( expired, cid_key );
+      GRAPHENE_CHECK_THROW( queue->submit( expired ), fc::exception );
+
+      // a transaction which references another block with the number of the head block
+      signed_transaction other_fork = make_trx( 4 );
+      other_fork.ref_block_num = db.head_block_num() & 0xffff;
+      other_fork.ref_block_prefix = db.head_block_id()._hash[1].value() + 1;
+      sign( other_fork, cid_key );
+      GRAPHENE_CHECK_THROW( queue->submit( other_fork ), fc::exception );
+
+      // a transaction which passes the checks but is rejected by the database
+      auto duplicate = queue->submit( trx1 );
+      GRAPHENE_CHECK_THROW( duplicate.wait(), fc::exception );
+
+      const auto metrics = queue->get_metrics();
+      BOOST_CHECK_EQUAL( metrics.queued, 0u );
+      BOOST_CHECK_EQUAL( metrics.max_queue_size, 1u );
+      BOOST_CHECK_EQUAL( metrics.accepted, 1u );
+      BOOST_CHECK_EQUAL( metrics.rejected_queue_full, 1u );
+      BOOST_CHECK_EQUAL( metrics.rejected_invalid, 2u );
+      BOOST_CHECK_EQUAL( metrics.rejected_by_chain, 1u );
+      BOOST_CHECK_EQUAL( metrics.batches, 2u );
+
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2842,6 +2842,66 @@ BOOST_AUTO_TEST_CASE( limit_order_fill_or_kill )
    PUSH_TX( db, trx, ~0 );
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( limit_order_price_levels )
+{ try {
+   generate_blocks( HARDFORK_CORE_625_TIME );
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   set_expiration( db, trx );
+
+   ACTORS( (seller)(buyer) );
+   const asset_object& test = create_user_issued_asset( "LEVELS" );
+   issue_uia( seller, test.amount(100000) );
+   fund( buyer, asset(100000) );
+
+   const auto& levels = db.get_index_type< primary_index< limit_order_index > >()
+                          .get_secondary_index< limit_order_price_level_index >().get_levels();
+   BOOST_CHECK( levels.empty() );
+
+   // two orders at 1 CORE per LEVELS, one at 2
+   limit_order_id_type first_id = create_sell_order( seller, test.amount(1000), asset(1000) )->id;
+   create_sell_order( seller, test.amount(2000), asset(2000) );
+   create_sell_order( seller, test.amount(1000), asset(2000) );
+   const price cheap( test.amount(1), asset(1) );
+   const price expensive( test.amount(1), asset(2) );
+   BOOST_REQUIRE_EQUAL( levels.size(), 2u );
+   BOOST_CHECK( levels.begin()->first == cheap );
+   BOOST_CHECK_EQUAL( levels.at( cheap ).for_sale.value, 3000 );
+   BOOST_CHECK_EQUAL( levels.at( cheap ).order_count, 2u );
+   BOOST_CHECK_EQUAL( levels.at( expensive ).for_sale.value, 1000 );
+   BOOST_CHECK_EQUAL( levels.at( expensive ).order_count, 1u );
+
+   // a partial fill of the oldest order reduces its level
+   BOOST_CHECK( !create_sell_order( buyer, asset(500), test.amount(500) ) );
+   BOOST_CHECK_EQUAL( first_id(db).for_sale.value, 500 );
+   BOOST_CHECK_EQUAL( levels.at( cheap ).for_sale.value, 2500 );
+   BOOST_CHECK_EQUAL( levels.at( cheap ).order_count, 2u );
+
+   // the book can take 4500 CORE, so a fill-or-kill order selling 5000 is rejected
+   limit_order_create_operation op;
+   op.seller = buyer_id;
+   op.amount_to_sell = asset(5000);
+   op.min_to_receive = test.amount(2500);
+   op.fill_or_kill = true;
+   trx.operations.clear();
+   trx.operations.push_back( op );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, trx, ~0 ), fc::exception );
+   BOOST_CHECK_EQUAL( levels.size(), 2u );
+
+   // one selling 4500 takes the whole book
+   op.amount_to_sell = asset(4500);
+   op.min_to_receive = test.amount(2250);
+   trx.operations.back() = op;
+   PUSH_TX( db, trx, ~0 );
+   trx.operations.clear();
+   BOOST_CHECK( levels.empty() );
+
+   const limit_order_object* order = create_sell_order( seller, test.amount(1000), asset(3000) );
+   BOOST_REQUIRE( order );
+   BOOST_CHECK_EQUAL( levels.size(), 1u );
+   cancel_limit_order( *order );
+   BOOST_CHECK( levels.empty() );
+} FC_LOG_AND_RETHROW() }
+
 /// Shameless code coverage plugging. Otherwise, these calls never happen.
 BOOST_AUTO_TEST_CASE( fill_order )
 { try {
@@ -370,6 +370,48 @@ BOOST_AUTO_TEST_CASE( one_lock_180_ticket )
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( tickets_of_several_accounts_updated_together )
+{ try {
+
+      // Pass the hard fork time
+      generate_blocks( HARDFORK_CORE_2103_TIME );
+      set_expiration( db, trx );
+
+      ACTORS((sam)(ted));
+
+      auto init_amount = 10000000 * GRAPHENE_BLOCKCHAIN_PRECISION;
+      fund( sam, asset(init_amount) );
+      fund( ted, asset(init_amount) );
+
+      // create tickets in the same block, so that they are updated in the same block too
+      const ticket_id_type tick_1_id = create_ticket( sam_id, lock_180_days, asset(100) ).id;
+      const ticket_id_type tick_2_id = create_ticket( sam_id, lock_180_days, asset(200) ).id;
+      const ticket_id_type tick_3_id = create_ticket( ted_id, lock_180_days, asset(300) ).id;
+
+      BOOST_CHECK_EQUAL( sam_id(db).statistics(db).total_core_pol.value, 300 );
+      BOOST_CHECK_EQUAL( sam_id(db).statistics(db).total_pol_value.value, 300 );
+      BOOST_CHECK_EQUAL( ted_id(db).statistics(db).total_core_pol.value, 300 );
+      BOOST_CHECK_EQUAL( ted_id(db).statistics(db).total_pol_value.value, 300 );
+
+      // 15 days passed
+      generate_blocks( db.head_block_time() + fc::days(15) );
+      set_expiration( db, trx );
+
+      // all tickets are stable now, and the totals of the accounts include the values of all their tickets
+      for( const ticket_id_type& id : { tick_1_id, tick_2_id, tick_3_id } )
+      {
+         BOOST_CHECK( id(db).current_type == lock_180_days );
+         BOOST_CHECK( id(db).status == stable );
+         BOOST_CHECK_EQUAL( id(db).value.value, id(db).amount.amount.value * 2 );
+      }
+      BOOST_CHECK_EQUAL( sam_id(db).statistics(db).total_core_pol.value, 300 );
+      BOOST_CHECK_EQUAL( sam_id(db).statistics(db).total_pol_value.value, 600 );
+      BOOST_CHECK_EQUAL( ted_id(db).statistics(db).total_core_pol.value, 300 );
+      BOOST_CHECK_EQUAL( ted_id(db).statistics(db).total_pol_value.value, 600 );
+
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( one_lock_360_ticket )
 { try {
 
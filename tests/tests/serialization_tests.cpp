@@ -25,6 +25,11 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/genesis_state.hpp>
+
+#include <graphene/net/message.hpp>
+#include <graphene/protocol/json_writer.hpp>
+#include <graphene/net/core_messages.hpp>
 
 
 #include <fc/crypto/digest.hpp>
@@ -55,6 +60,126 @@ BOOST_AUTO_TEST_CASE( serialization_raw_test )
       throw;
    }
 }
+BOOST_AUTO_TEST_CASE( trx_message_id_test )
+{ try {
+   transfer_operation op;
+   op.from = account_id_type(1);
+   op.to = account_id_type(2);
+   op.amount = asset(100);
+   trx.operations.push_back( op );
+   trx.signatures.push_back( signature_type() );
+   processed_transaction ptrx( trx );
+   ptrx.operation_results.push_back( void_result() );
+
+   // the id of the message which carries the transaction, without building the message
+   const auto expected = graphene::net::message( graphene::net::trx_message( ptrx ) ).id();
+   BOOST_CHECK( graphene::net::trx_message::message_id( ptrx ) == expected );
+   BOOST_CHECK( graphene::net::trx_message::message_id( trx ) == expected );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( packed_block_message_test )
+{ try {
+   transfer_operation op;
+   op.from = account_id_type(1);
+   op.to = account_id_type(2);
+   op.amount = asset(100);
+   signed_block block;
+   block.timestamp = fc::time_point_sec( 1000 );
+   processed_transaction ptrx;
+   ptrx.operations.push_back( op );
+   block.transactions.push_back( ptrx );
+
+   // a message built from the serialized block is the one built from the unpacked block
+   const graphene::net::message expected{ graphene::net::block_message( block ) };
+   const graphene::net::message packed = graphene::net::block_message::pack_message( fc::raw::pack( block ),
+                                                                                      block.id() );
+   BOOST_CHECK_EQUAL( packed.msg_type.value(), expected.msg_type.value() );
+   BOOST_CHECK_EQUAL( packed.size.value(), expected.size.value() );
+   BOOST_CHECK( packed.data == expected.data );
+   BOOST_CHECK( packed.id() == expected.id() );
+
+   BOOST_CHECK( graphene::net::block_message::block_id_of( packed ) == block.id() );
+   BOOST_CHECK_THROW( graphene::net::block_message::block_id_of(
+                            graphene::net::message( graphene::net::trx_message( trx ) ) ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( precomputable_transaction_packing_test )
+{ try {
+   transfer_operation op;
+   op.from = account_id_type(1);
+   op.to = account_id_type(2);
+   op.amount = asset(100);
+   trx.operations.push_back( op );
+   trx.signatures.push_back( signature_type() );
+   processed_transaction ptrx( trx );
+   ptrx.operation_results.push_back( void_result() );
+
+   // everything derived from the cached serialization matches a fresh serialization
+   const signed_transaction& plain = trx;
+   BOOST_CHECK( ptrx.get_packed_transaction() == fc::raw::pack( static_cast<const transaction&>( trx ) ) );
+   BOOST_CHECK( ptrx.get_packed_with_signatures() == fc::raw::pack( plain ) );
+   BOOST_CHECK( ptrx.id() == plain.id() );
+   BOOST_CHECK_EQUAL( ptrx.get_packed_size(), plain.get_packed_size() );
+   BOOST_CHECK( ptrx.merkle_digest() == digest_type::hash( fc::raw::pack( ptrx ) ) );
+   BOOST_CHECK( graphene::net::message( graphene::net::trx_message( ptrx ) ).data == fc::raw::pack( plain ) );
+
+   // signing does not invalidate the cached serialization
+   const auto key = fc::ecc::private_key::regenerate( fc::sha256::hash( string( "key" ) ) );
+   precomputable_transaction signed_copy( ptrx );
+   signed_transaction expected( trx );
+   signed_copy.sign( key, db.get_chain_id() );
+   expected.sign( key, db.get_chain_id() );
+   BOOST_CHECK( signed_copy.signatures == expected.signatures );
+   BOOST_CHECK( signed_copy.get_packed_with_signatures() == fc::raw::pack( expected ) );
+
+   // copies share the serialization
+   processed_transaction copy( ptrx );
+   BOOST_CHECK( &copy.get_packed_transaction() == &ptrx.get_packed_transaction() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( signed_block_unpack_from_test )
+{ try {
+   transfer_operation op;
+   op.from = account_id_type(1);
+   op.to = account_id_type(2);
+   op.amount = asset(100);
+
+   signed_block first;
+   first.timestamp = fc::time_point_sec( 1000 );
+   for( int i = 0; i < 3; ++i )
+   {
+      op.amount = asset( 100 + i );
+      processed_transaction ptrx;
+      ptrx.operations.push_back( op );
+      first.transactions.push_back( ptrx );
+   }
+   signed_block second;
+   second.timestamp = fc::time_point_sec( 2000 );
+   op.amount = asset( 500 );
+   processed_transaction ptrx;
+   ptrx.operations.push_back( op );
+   second.transactions.push_back( ptrx );
+
+   // fill the caches of the reused block, they must not survive the unpacking
+   signed_block reused;
+   const auto packed_first = fc::raw::pack( first );
+   reused.unpack_from( packed_first.data(), packed_first.size() );
+   BOOST_CHECK( reused.id() == first.id() );
+   BOOST_CHECK( reused.calculate_merkle_root() == first.calculate_merkle_root() );
+   BOOST_CHECK( reused.transactions[0].id() == first.transactions[0].id() );
+   reused.get_packed_size();
+
+   const auto packed_second = fc::raw::pack( second );
+   reused.unpack_from( packed_second.data(), packed_second.size() );
+   BOOST_REQUIRE_EQUAL( reused.transactions.size(), 1u );
+   BOOST_CHECK( reused.id() == second.id() );
+   BOOST_CHECK( reused.calculate_merkle_root() == second.calculate_merkle_root() );
+   BOOST_CHECK( reused.transactions[0].id() == second.transactions[0].id() );
+   BOOST_CHECK( reused.transactions[0].get_packed_transaction() == second.transactions[0].get_packed_transaction() );
+   BOOST_CHECK_EQUAL( reused.get_packed_size(), packed_second.size() );
+   BOOST_CHECK( fc::raw::pack( reused ) == packed_second );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( serialization_json_test )
 {
    try {
@@ -74,6 +199,91 @@ BOOST_AUTO_TEST_CASE( serialization_json_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( genesis_from_variant_in_parallel_test )
+{
+   try {
+      genesis_state_type genesis;
+      genesis.initial_timestamp = fc::time_point_sec( 1431700000 );
+      genesis.initial_active_witnesses = 1;
+      const public_key_type key = fc::ecc::private_key::regenerate( fc::sha256::hash( string("genesis") ) )
+                                     .get_public_key();
+      // enough elements to be converted in several chunks
+      for( uint32_t i = 0; i < 25000; ++i )
+      {
+         const string name = "init" + std::to_string( i );
+         genesis.initial_accounts.emplace_back( name, key, key, i % 2 == 0 );
+         genesis_state_type::initial_balance_type balance;
+         balance.owner = address( key );
+         balance.asset_symbol = GRAPHENE_SYMBOL;
+         balance.amount = i + 1;
+         genesis.initial_balances.push_back( balance );
+      }
+      genesis_state_type::initial_vesting_balance_type vesting;
+      vesting.owner = address( key );
+      vesting.asset_symbol = GRAPHENE_SYMBOL;
+      vesting.amount = 1000;
+      genesis.initial_vesting_balances.push_back( vesting );
+      genesis.initial_witness_candidates.push_back( { "init0", key } );
+
+      const fc::variant var( genesis, GRAPHENE_MAX_NESTED_OBJECTS );
+      const genesis_state_type expected = var.as<genesis_state_type>( 20 );
+      const genesis_state_type converted = genesis_state_type::from_variant_in_parallel( var, 20 );
+      BOOST_CHECK( fc::raw::pack( converted ) == fc::raw::pack( expected ) );
+      BOOST_CHECK_EQUAL( converted.initial_accounts.size(), 25000u );
+      BOOST_CHECK_EQUAL( converted.initial_balances.back().amount.value, 25000 );
+
+      // a malformed element is reported
+      fc::mutable_variant_object broken( var.get_object() );
+      fc::variants accounts = broken["initial_accounts"].get_array();
+      accounts[20000] = fc::variant( "not an account" );
+      broken( "initial_accounts", fc::variant( accounts ) );
+      BOOST_CHECK_THROW( genesis_state_type::from_variant_in_parallel( fc::variant( broken ), 20 ), fc::exception );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( json_writer_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice_id(db), asset(1000000) );
+   create_user_issued_asset( "JSONTEST", alice_id(db), 0 );
+   transfer( alice_id(db), bob_id(db), asset(12345) );
+
+   // the writer must produce exactly the output of the variant conversion
+   const auto check_object = [this]( const object_id_type& id ) {
+      const graphene::db::object& obj = db.get_object( id );
+      BOOST_CHECK_EQUAL( obj.to_json(), fc::json::to_string( obj.to_variant() ) );
+   };
+   check_object( alice_id );
+   check_object( bob_id );
+   check_object( alice_id(db).statistics );
+   check_object( asset_id_type() );
+   check_object( asset_id_type()(db).dynamic_asset_data_id );
+   check_object( global_property_id_type() );
+   check_object( dynamic_global_property_id_type() );
+   check_object( witness_id_type(1) );
+   check_object( committee_member_id_type(1) );
+
+   account_create_operation create_op = make_account( "carol" );
+   create_op.extensions.value.owner_special_authority = top_holders_special_authority();
+   trx.operations.push_back( create_op );
+   transfer_operation xfer;
+   xfer.from = alice_id;
+   xfer.to = bob_id;
+   xfer.amount = asset( int64_t(1) << 40 );
+   trx.operations.push_back( xfer );
+   trx.set_expiration( db.head_block_time() + fc::minutes(1) );
+   sign( trx, alice_private_key );
+   BOOST_CHECK_EQUAL( graphene::protocol::to_json( trx ),
+                      fc::json::to_string( fc::variant( trx, GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+
+   const signed_block& head = *db.fetch_block_by_number( db.head_block_num() );
+   BOOST_CHECK_EQUAL( graphene::protocol::to_json( head ),
+                      fc::json::to_string( fc::variant( head, GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+
+   // the nesting limit is enforced like in the variant conversion
+   GRAPHENE_REQUIRE_THROW( graphene::protocol::to_json( trx, 2 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( json_tests )
 {
    try {
@@ -578,6 +578,92 @@ BOOST_AUTO_TEST_CASE(last_voting_date_proxy)
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( incremental_vote_tally )
+{
+   try
+   {
+      generate_blocks( HARDFORK_CORE_2262_TIME );
+      generate_block();
+      set_expiration( db, trx );
+
+      ACTORS( (alice)(bob)(proxy) );
+      transfer( committee_account, alice_id, asset(1000000) );
+      transfer( committee_account, bob_id, asset(2000000) );
+      transfer( committee_account, proxy_id, asset(3000000) );
+
+      db.enable_standby_votes_tracking( true );
+      db.enable_incremental_vote_tally( true );
+
+      const witness_id_type witness1_id(1);
+      const witness_id_type witness2_id(2);
+      const witness_id_type witness3_id(3);
+      const vote_id_type witness1 = witness1_id(db).vote_id;
+      const vote_id_type witness2 = witness2_id(db).vote_id;
+      const vote_id_type witness3 = witness3_id(db).vote_id;
+
+      auto update_votes = [this]( account_id_type account, const fc::ecc::private_key& key,
+                                  account_id_type voting_account, const flat_set<vote_id_type>& votes ) {
+         account_update_operation op;
+         op.account = account;
+         op.new_options = account(db).options;
+         op.new_options->voting_account = voting_account;
+         op.new_options->votes = votes;
+         trx.operations.push_back( op );
+         sign( trx, key );
+         PUSH_TX( db, trx, ~0 );
+         trx.clear();
+      };
+      auto witness_votes = [this]() {
+         vector<uint64_t> result;
+         for( const witness_object& wit : db.get_index_type<witness_index>().indices() )
+            result.push_back( wit.total_votes );
+         return result;
+      };
+      auto next_maintenance = [this]() {
+         generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+         generate_block();
+         set_expiration( db, trx );
+      };
+
+      update_votes( alice_id, alice_private_key, GRAPHENE_PROXY_TO_SELF_ACCOUNT, { witness1 } );
+      update_votes( bob_id, bob_private_key, GRAPHENE_PROXY_TO_SELF_ACCOUNT, { witness2 } );
+      update_votes( proxy_id, proxy_private_key, GRAPHENE_PROXY_TO_SELF_ACCOUNT, { witness1, witness3 } );
+      next_maintenance();
+      BOOST_CHECK_EQUAL( witness1_id(db).total_votes, 4000000u );
+      BOOST_CHECK_EQUAL( witness2_id(db).total_votes, 2000000u );
+
+      // a balance change and a new proxy
+      transfer( alice_id, bob_id, asset(500000) );
+      update_votes( bob_id, bob_private_key, proxy_id, {} );
+      next_maintenance();
+      BOOST_CHECK_EQUAL( witness1_id(db).total_votes, 6000000u );
+      BOOST_CHECK_EQUAL( witness2_id(db).total_votes, 0u );
+      BOOST_CHECK_EQUAL( witness3_id(db).total_votes, 5500000u );
+
+      // the opinion account changes its votes, which affects the delegated stake
+      update_votes( proxy_id, proxy_private_key, GRAPHENE_PROXY_TO_SELF_ACCOUNT, { witness2 } );
+      next_maintenance();
+      BOOST_CHECK_EQUAL( witness1_id(db).total_votes, 500000u );
+      BOOST_CHECK_EQUAL( witness2_id(db).total_votes, 5500000u );
+      BOOST_CHECK_EQUAL( witness3_id(db).total_votes, 0u );
+
+      // alice stops voting
+      update_votes( alice_id, alice_private_key, GRAPHENE_PROXY_TO_SELF_ACCOUNT, {} );
+      next_maintenance();
+
+      // a tally from scratch finds the same
+      const vector<uint64_t> incremental_votes = witness_votes();
+      const uint64_t incremental_vp = db.get_account_stats_by_owner( proxy_id ).vp_all;
+      db.enable_incremental_vote_tally( false );
+      next_maintenance();
+      BOOST_CHECK( witness_votes() == incremental_votes );
+      BOOST_CHECK_EQUAL( db.get_account_stats_by_owner( proxy_id ).vp_all, incremental_vp );
+      BOOST_CHECK_EQUAL( witness1_id(db).total_votes, 0u );
+      BOOST_CHECK_EQUAL( witness2_id(db).total_votes, 5500000u );
+
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( witness_votes_calculation )
 {
    try